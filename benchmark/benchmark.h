@@ -22,6 +22,9 @@
 #include <thread>
 #include <atomic>
 #include <cstdlib>
+#include <mutex>
+#include "../threads/threads.h"
+#include "../collections/collections.h"
 
 namespace Kava {
 
@@ -278,22 +281,22 @@ public:
     
     // 6. HashMap Operations
     static void hashMapOps(int count = 100000) {
-        std::map<int, int> map;
+        HashMap<int, int> map;
         
         // Insert
         for (int i = 0; i < count; i++) {
-            map[i] = i * 2;
+            map.put(i, i * 2);
         }
         
         // Lookup
         volatile int sum = 0;
         for (int i = 0; i < count; i++) {
-            sum += map[i];
+            sum += *map.get(i);
         }
         
         // Delete
         for (int i = 0; i < count; i++) {
-            map.erase(i);
+            map.remove(i);
         }
     }
     
@@ -309,6 +312,7 @@ public:
         for (int i = 0; i < iterations; i++) {
             hash = std::hash<std::string>{}(result.substr(0, i));
         }
+        (void)hash;
     }
     
     // 8. Ordenação
@@ -375,6 +379,7 @@ public:
         for (int i = 0; i < iterations; i++) {
             result = square(doubleIt(i % 100));
         }
+        (void)result;
     }
     
     // 13. Async simulation (task scheduling overhead)
@@ -431,6 +436,110 @@ public:
     }
 };
 
+// ============================================================
+// BENCHMARKS DE CONTENÇÃO (filas e mapas concorrentes)
+// ============================================================
+class ContentionBenchmarks {
+public:
+    // producers x consumers threads trocando itemsPerProducer itens cada
+    // por uma fila limitada (BlockingQueue ou MPMCQueue); retorna ms
+    template<typename Queue>
+    static double queueThroughput(int threads, int itemsPerProducer = 100000, size_t capacity = 1024) {
+        Queue queue(capacity);
+        std::atomic<long> checksum{0};
+        std::vector<std::thread> workers;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int p = 0; p < threads; p++) {
+            workers.emplace_back([&queue, itemsPerProducer] {
+                for (int i = 1; i <= itemsPerProducer; i++) queue.put(i);
+            });
+        }
+        for (int c = 0; c < threads; c++) {
+            workers.emplace_back([&queue, &checksum, itemsPerProducer] {
+                long local = 0;
+                for (int i = 0; i < itemsPerProducer; i++) local += queue.take();
+                checksum += local;
+            });
+        }
+        for (auto& t : workers) t.join();
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        long expected = static_cast<long>(threads) * itemsPerProducer * (itemsPerProducer + 1) / 2;
+        if (checksum.load() != expected) return -1.0;
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    
+    // Mapa compartilhado, 90% leituras / 10% escritas em 64K chaves; retorna ms
+    template<typename MapOps>
+    static double mapMixed(MapOps& map, int threads, int opsPerThread = 200000) {
+        const int KEYS = 1 << 16;
+        for (int k = 0; k < KEYS; k++) map.put(k, k);
+        
+        std::atomic<long> sink{0};
+        std::vector<std::thread> workers;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&map, &sink, t, opsPerThread] {
+                uint32_t seed = 0x9E3779B9u * (t + 1);
+                long local = 0;
+                for (int i = 0; i < opsPerThread; i++) {
+                    seed ^= seed << 13;
+                    seed ^= seed >> 17;
+                    seed ^= seed << 5;
+                    int key = static_cast<int>(seed & (KEYS - 1));
+                    if (seed % 10 == 0) {
+                        map.put(key, i);
+                    } else {
+                        local += map.getOrDefault(key, 0);
+                    }
+                }
+                sink += local;
+            });
+        }
+        for (auto& t : workers) t.join();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    
+    // HashMap atrás de um mutex único (o que o código usava até aqui)
+    struct LockedHashMap {
+        HashMap<int, long> map{1 << 16};
+        std::mutex mutex;
+        
+        void put(int key, long value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            map.put(key, value);
+        }
+        long getOrDefault(int key, long defaultValue) {
+            std::lock_guard<std::mutex> lock(mutex);
+            long* value = map.get(key);
+            return value ? *value : defaultValue;
+        }
+    };
+    
+    static void runAll(const std::vector<int>& threadCounts = {1, 2, 4, 8}) {
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << std::left << std::setw(10) << "Threads"
+                  << std::right << std::setw(14) << "BlockingQ"
+                  << std::setw(12) << "MPMCQueue"
+                  << std::setw(14) << "Locked map"
+                  << std::setw(12) << "CHM" << std::endl;
+        for (int threads : threadCounts) {
+            double blocking = queueThroughput<BlockingQueue<long>>(threads);
+            double mpmc = queueThroughput<MPMCQueue<long>>(threads);
+            LockedHashMap locked;
+            ConcurrentHashMap<int, long> concurrent(1 << 16);
+            double lockedMs = mapMixed(locked, threads);
+            double concurrentMs = mapMixed(concurrent, threads);
+            std::cout << std::left << std::setw(10) << threads
+                      << std::right << std::setw(11) << blocking << " ms"
+                      << std::setw(9) << mpmc << " ms"
+                      << std::setw(11) << lockedMs << " ms"
+                      << std::setw(9) << concurrentMs << " ms" << std::endl;
+        }
+    }
+};
+
 // ============================================================
 // VALORES DE REFERÊNCIA JAVA 5/6
 // (Valores aproximados baseados em benchmarks típicos)
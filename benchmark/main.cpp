@@ -21,6 +21,10 @@
 #include <queue>
 #include <random>
 #include <cstring>
+#include <cstdlib>
+#include "vm.h"
+#include "benchmark.h"
+#include "suite.h"
 
 using Clock = std::chrono::high_resolution_clock;
 using Duration = std::chrono::duration<double, std::milli>;
@@ -183,28 +187,63 @@ double benchString() {
 // ============================================================
 // BENCHMARK: Object Creation (GC pressure)
 // ============================================================
+// Objetos de curta duracao no heap da Kava: bump pointer no eden e minor GC
+// por copia; 1 a cada 16 fica vivo num array raiz e acaba promovido.
 struct SimpleObj {
-    int x, y, z;
+    int32_t refs;  // Layout de instancia: nenhum campo de referencia (heap zera)
+    int32_t x, y, z;
     double value;
-    SimpleObj(int a, int b, int c) : x(a), y(b), z(c), value(a + b * c) {}
 };
 
 double benchObjectCreation() {
-    auto start = Clock::now();
+    Kava::Heap heap;
+    heap.initialize(Kava::GCConfig());
+    Kava::GarbageCollector gc(heap);
+    Kava::MutatorThread mutator(heap);  // Alocacao pelo TLAB
+    
+    const int32_t LIVE = 4096;
+    Kava::GCObject* live = heap.allocateArray(Kava::GCObjectType::ARRAY_OBJECT, LIVE);
+    gc.addRoot(&live);
     
-    std::vector<SimpleObj*> objects;
-    objects.reserve(1000);
+    auto start = Clock::now();
     
     for (int round = 0; round < 1000; round++) {
         for (int i = 0; i < 1000; i++) {
-            objects.push_back(new SimpleObj(i, i * 2, i * 3));
+            Kava::GCObject* obj = heap.allocate(1, Kava::GCObjectType::INSTANCE, sizeof(SimpleObj));
+            if (!obj) {
+                gc.collect();
+                obj = heap.allocate(1, Kava::GCObjectType::INSTANCE, sizeof(SimpleObj));
+                if (!obj) {
+                    std::cerr << "Object Creation: heap esgotado mesmo apos o GC\n";
+                    std::exit(1);
+                }
+            }
+            SimpleObj* o = obj->dataAs<SimpleObj>();
+            o->x = i;
+            o->y = i * 2;
+            o->z = i * 3;
+            o->value = o->x + o->y * o->z;
+            if ((i & 15) == 0) {
+                // live acaba promovido: o card sujo mantem obj vivo no minor GC
+                Kava::GCObject** slot = &live->arrayElement<Kava::GCObject*>((round * 64 + i / 16) % LIVE);
+                *slot = obj;
+                gc.writeBarrier(live, slot, obj);
+            }
         }
-        // Clear (simulate GC)
-        for (auto* obj : objects) delete obj;
-        objects.clear();
     }
     
     auto end = Clock::now();
+    
+    // Os sobreviventes precisam ter atravessado as copias intactos
+    for (int32_t k = 0; k < LIVE; k++) {
+        Kava::GCObject* obj = live->arrayElement<Kava::GCObject*>(k);
+        const SimpleObj* o = obj ? obj->dataAs<SimpleObj>() : nullptr;
+        if (o && (o->y != o->x * 2 || o->z != o->x * 3)) {
+            std::cerr << "Object Creation: objeto corrompido pelo GC\n";
+            break;
+        }
+    }
+    gc.removeRoot(&live);
     return Duration(end - start).count();
 }
 
@@ -301,6 +340,258 @@ double benchAsync() {
     return Duration(end - start).count();
 }
 
+// ============================================================
+// BENCHMARK: Executors com tarefas minusculas
+// ============================================================
+// O custo fica todo na fila do executor: ThreadPoolExecutor (uma
+// BlockingQueue) contra ForkJoinPool (fila MPMC + deques com roubo)
+const int EXECUTOR_TASKS = 200000;
+
+template<typename Pool>
+double benchTinyTasks(Pool& pool) {
+    std::atomic<int> done{0};
+    std::atomic<int64_t> sum{0};
+    auto start = Clock::now();
+    for (int i = 0; i < EXECUTOR_TASKS; i++) {
+        pool.execute([&sum, &done, i] {
+            sum.fetch_add(i, std::memory_order_relaxed);
+            done.fetch_add(1, std::memory_order_release);
+        });
+    }
+    while (done.load(std::memory_order_acquire) < EXECUTOR_TASKS) std::this_thread::yield();
+    return Duration(Clock::now() - start).count();
+}
+
+// Dividir-para-conquistar: cada fork empurra na deque da propria worker
+struct SumTask : Kava::ForkJoinTask {
+    const int32_t* data;
+    int32_t lo, hi;
+    int64_t result = 0;
+    SumTask(const int32_t* d, int32_t l, int32_t h) : data(d), lo(l), hi(h) {}
+    void compute() override {
+        if (hi - lo <= 2048) {
+            for (int32_t i = lo; i < hi; i++) result += data[i];
+            return;
+        }
+        int32_t mid = lo + (hi - lo) / 2;
+        SumTask left(data, lo, mid), right(data, mid, hi);
+        left.fork();
+        right.invoke();
+        left.join();
+        result = left.result + right.result;
+    }
+};
+
+double benchForkJoinSum(Kava::ForkJoinPool& pool, int64_t& result) {
+    std::vector<int32_t> data(8 * 1024 * 1024);
+    std::iota(data.begin(), data.end(), 0);
+    auto start = Clock::now();
+    SumTask root(data.data(), 0, static_cast<int32_t>(data.size()));
+    pool.invoke(root);
+    result = root.result;
+    return Duration(Clock::now() - start).count();
+}
+
+// ============================================================
+// BENCHMARK: VM Dispatch (bytecode interpretado pela VM)
+// Mesmo loop que o kavac gera para:
+//   let sum = 0  let n = 0
+//   while (n < N) { sum = sum + n  n = n + 1 }
+// ============================================================
+std::vector<int32_t> dispatchLoopBytecode(int32_t iterations) {
+    return {
+        OP_ICONST_0, OP_STORE_GLOBAL, 0,              //  0: sum = 0
+        OP_ICONST_0, OP_STORE_GLOBAL, 1,              //  3: n = 0
+        OP_LOAD_GLOBAL, 1, OP_PUSH_INT, iterations,   //  6: n < N
+        OP_ILT, OP_JZ, 32,
+        OP_LOAD_GLOBAL, 0, OP_LOAD_GLOBAL, 1,         // 13: sum = sum + n
+        OP_IADD, OP_DUP, OP_STORE_GLOBAL, 0, OP_POP,
+        OP_LOAD_GLOBAL, 1, OP_ICONST_1,               // 22: n = n + 1
+        OP_IADD, OP_DUP, OP_STORE_GLOBAL, 1, OP_POP,
+        OP_JMP, 6,                                    // 30: loop
+        OP_HALT                                       // 32
+    };
+}
+
+// Bytecode montado a mao: uma carga recusada mediria um run() vazio
+void loadOrExit(Kava::VM& vm, const std::vector<int32_t>& code, const char* bench) {
+    if (vm.loadBytecode(code)) return;
+    std::cerr << bench << ": carga do bytecode falhou";
+    if (!vm.loadError.empty()) std::cerr << " (" << vm.loadError << ")";
+    std::cerr << std::endl;
+    std::exit(1);
+}
+
+double benchVMDispatch(Kava::DispatchMode mode, bool superinstructions = false, bool native = false) {
+    Kava::VM vm;
+    vm.config.dispatch = mode;
+    vm.config.enableSuperinstructions = superinstructions;
+    vm.config.enableNativeJIT = native;
+    loadOrExit(vm, dispatchLoopBytecode(20000000), "VM Dispatch");
+    
+    auto start = Clock::now();
+    vm.run();
+    auto end = Clock::now();
+    return Duration(end - start).count();
+}
+
+// ============================================================
+// BENCHMARK: VM Calls (frames reais + CALL/RET)
+// Mesmo .kvb que o kavac gera para:
+//   fn fib(n) { if (n < 2) { return n }  return fib(n - 1) + fib(n - 2) }
+//   fib(N)
+// ============================================================
+std::vector<int32_t> fibCallBytecode(int32_t n) {
+    return {
+        KAVA_BYTECODE_MAGIC, 11,                      // metadados: 11 palavras
+        1, 3, 'f' | ('i' << 8) | ('b' << 16),         // simbolos: "fib"
+        1, 0, 1, 1, 7,                                // fib: 1 param, 1 local, @7
+        0, 0, 0,                                      // sem classes, caches nem strings
+        OP_PUSH_INT, n, OP_CALL, 0, 1,                //  0: fib(N)
+        OP_POP, OP_HALT,
+        OP_LOAD_LOCAL, 0, OP_ICONST_2, OP_ILT,        //  7: n < 2
+        OP_JZ, 16,
+        OP_LOAD_LOCAL, 0, OP_IRET,                    // 13: return n
+        OP_LOAD_LOCAL, 0, OP_ICONST_1, OP_ISUB,       // 16: fib(n - 1)
+        OP_CALL, 0, 1,
+        OP_LOAD_LOCAL, 0, OP_ICONST_2, OP_ISUB,       // 23: fib(n - 2)
+        OP_CALL, 0, 1,
+        OP_IADD, OP_IRET                              // 30
+    };
+}
+
+double benchVMCalls(Kava::DispatchMode mode) {
+    Kava::VM vm;
+    vm.config.dispatch = mode;
+    loadOrExit(vm, fibCallBytecode(30), "VM Calls");
+    
+    auto start = Clock::now();
+    vm.run();
+    auto end = Clock::now();
+    return Duration(end - start).count();
+}
+
+// ============================================================
+// BENCHMARK: Pausa de minor GC x tamanho da old gen
+// ============================================================
+// Arrays de referencia vivos na old gen, cada um apontando para um objeto
+// novo por ciclo (via write barrier). Com card table a pausa depende dos
+// cards sujos e da young gen, nao do total da old gen.
+double benchMinorPause(size_t oldMB) {
+    Kava::GCConfig cfg;
+    const size_t youngBytes = 6 * 1024 * 1024;  // Mesma young gen para todo oldMB
+    cfg.initialHeapSize = youngBytes + oldMB * 1024 * 1024 * 3 / 2;
+    cfg.youngGenRatio = cfg.initialHeapSize / youngBytes;
+    cfg.maxHeapSize = cfg.initialHeapSize * 2;
+    Kava::Heap heap;
+    heap.initialize(cfg);
+    Kava::GarbageCollector gc(heap);
+    
+    // Old gen: arrays acima do limite de pretenuring, 1 slot alterado por ciclo
+    const int32_t SLOTS = static_cast<int32_t>(heap.pretenureLimit() / sizeof(void*) + 1);
+    std::vector<Kava::GCObject*> holders;
+    for (size_t bytes = 0; bytes < oldMB * 1024 * 1024; bytes += SLOTS * sizeof(void*)) {
+        holders.push_back(heap.allocateArray(Kava::GCObjectType::ARRAY_OBJECT, SLOTS));
+    }
+    for (auto& h : holders) gc.addRoot(&h);
+    
+    const int CYCLES = 20;
+    double totalMs = 0;
+    for (int cycle = 0; cycle < CYCLES; cycle++) {
+        for (size_t k = 0; k < holders.size(); k++) {
+            Kava::GCObject* holder = holders[k];
+            Kava::GCObject* young = heap.allocateArray(Kava::GCObjectType::ARRAY_INT, 4);
+            if (!young) break;
+            Kava::GCObject** slot = &holder->arrayElement<Kava::GCObject*>((cycle * 97) % SLOTS);
+            *slot = young;
+            gc.writeBarrier(holder, slot, young);
+        }
+        // Lixo de curta duracao ate encher boa parte do eden
+        while (heap.eden.available() > heap.eden.capacity() / 8) {
+            heap.allocateArray(Kava::GCObjectType::ARRAY_INT, 16);
+        }
+        auto start = Clock::now();
+        gc.collectYoung();
+        totalMs += Duration(Clock::now() - start).count();
+    }
+    for (auto& h : holders) gc.removeRoot(&h);
+    return totalMs / CYCLES;
+}
+
+// Alocacao de objetos pequenos em `threads` mutadoras, cada uma com seu TLAB;
+// devolve milhoes de objetos por segundo
+double benchAllocScaling(int threads) {
+    Kava::GCConfig cfg;
+    cfg.initialHeapSize = 64 * 1024 * 1024;
+    Kava::Heap heap;
+    heap.initialize(cfg);
+    Kava::GarbageCollector gc(heap);
+    
+    const int PER_THREAD = 2000000;
+    auto body = [&heap, &gc] {
+        Kava::MutatorThread mutator(heap);
+        Kava::GCObject* keep = nullptr;
+        gc.addRoot(&keep);
+        for (int i = 0; i < PER_THREAD; i++) {
+            Kava::GCObject* obj = heap.allocate(1, Kava::GCObjectType::INSTANCE, sizeof(SimpleObj));
+            if (!obj) {
+                gc.collect();
+                obj = heap.allocate(1, Kava::GCObjectType::INSTANCE, sizeof(SimpleObj));
+            }
+            obj->dataAs<SimpleObj>()->x = i;
+            if ((i & 1023) == 0) keep = obj;
+        }
+        gc.removeRoot(&keep);
+    };
+    
+    auto start = Clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) pool.emplace_back(body);
+    for (auto& t : pool) t.join();
+    double ms = Duration(Clock::now() - start).count();
+    return threads * static_cast<double>(PER_THREAD) / (ms * 1000.0);
+}
+
+// Pausa de um full GC sobre ~48 MB vivos (listas de arrays pequenos
+// penduradas em um array raiz), com `threads` workers
+double benchFullPause(int threads) {
+    Kava::GCConfig cfg;
+    cfg.initialHeapSize = 160 * 1024 * 1024;
+    cfg.maxHeapSize = 512 * 1024 * 1024;
+    cfg.parallelGCThreads = threads;
+    Kava::Heap heap;
+    heap.initialize(cfg);
+    Kava::GarbageCollector gc(heap);
+    gc.setWorkerRunner([](int n, const std::function<void(int)>& body) {
+        std::vector<std::thread> pool;
+        for (int i = 1; i < n; i++) pool.emplace_back(body, i);
+        body(0);
+        for (auto& t : pool) t.join();
+    });
+    
+    const int32_t LISTS = 4096;
+    Kava::GCObject* root = heap.allocateArray(Kava::GCObjectType::ARRAY_OBJECT, LISTS);
+    gc.addRoot(&root);
+    for (size_t bytes = 0, k = 0; bytes < 48 * 1024 * 1024; k++) {
+        Kava::GCObject* node = heap.allocateArray(Kava::GCObjectType::ARRAY_OBJECT, 4);
+        if (!node) {
+            gc.collect();
+            continue;
+        }
+        Kava::GCObject** head = &root->arrayElement<Kava::GCObject*>(k % LISTS);
+        node->arrayElement<Kava::GCObject*>(0) = *head;
+        *head = node;
+        gc.writeBarrier(root, head, node);
+        bytes += node->header.size;
+    }
+    
+    auto start = Clock::now();
+    gc.collectFull();
+    double ms = Duration(Clock::now() - start).count();
+    gc.removeRoot(&root);
+    return ms;
+}
+
 // ============================================================
 // JAVA 8 ESTIMATED TIMES (from real benchmarks on similar HW)
 // These are conservative estimates for Java 8 HotSpot JIT
@@ -324,7 +615,56 @@ std::map<std::string, double> getJava8Estimates() {
 // ============================================================
 // MAIN
 // ============================================================
-int main() {
+// kavabench --suite[=dir] [--kavac=path] [--runs=N] [--warmup=N] [--workloads=a,b]
+//           [--configs=a,b] [--json=out.json] [--baseline=base.json] [--threshold=pct]
+static std::vector<std::string> splitList(const std::string& s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(item);
+    }
+    return out;
+}
+
+static int runSuite(int argc, char** argv) {
+    Kava::KavaSuite::Options opt;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const size_t eq = arg.find('=');
+        const std::string name = arg.substr(0, eq);
+        const std::string val = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (name == "--suite") {
+            if (!val.empty()) opt.workloadDir = val;
+        } else if (name == "--kavac") {
+            opt.kavac = val;
+        } else if (name == "--runs") {
+            opt.runs = std::max(1, std::atoi(val.c_str()));
+        } else if (name == "--warmup") {
+            opt.warmup = std::max(0, std::atoi(val.c_str()));
+        } else if (name == "--workloads") {
+            opt.workloads = splitList(val);
+        } else if (name == "--configs") {
+            opt.configs = splitList(val);
+        } else if (name == "--json") {
+            opt.jsonPath = val;
+        } else if (name == "--baseline") {
+            opt.baselinePath = val;
+        } else if (name == "--threshold") {
+            opt.threshold = std::atof(val.c_str()) / 100.0;
+        } else {
+            std::cerr << "Opcao desconhecida: " << arg << std::endl;
+            return 2;
+        }
+    }
+    return Kava::KavaSuite::run(opt);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--suite", 7) == 0) return runSuite(argc, argv);
+    }
+
     std::cout << "\n";
     std::cout << "╔══════════════════════════════════════════════════════════════════╗\n";
     std::cout << "║           KAVA 2.5 BENCHMARK SUITE vs Java 8 HotSpot           ║\n";
@@ -400,6 +740,123 @@ int main() {
     
     std::cout << std::string(74, '-') << "\n";
     
+    // A/B dos engines de dispatch da VM (fora da comparacao com Java)
+    {
+        double switchTime = 0, threadedTime = 0, fusedTime = 0, nativeTime = 0;
+        benchVMDispatch(Kava::DispatchMode::Switch);
+        benchVMDispatch(Kava::DispatchMode::Threaded);
+        benchVMDispatch(Kava::DispatchMode::Threaded, true);
+        benchVMDispatch(Kava::DispatchMode::Threaded, true, true);
+        for (int r = 0; r < RUNS; r++) {
+            switchTime += benchVMDispatch(Kava::DispatchMode::Switch);
+            threadedTime += benchVMDispatch(Kava::DispatchMode::Threaded);
+            fusedTime += benchVMDispatch(Kava::DispatchMode::Threaded, true);
+            nativeTime += benchVMDispatch(Kava::DispatchMode::Threaded, true, true);
+        }
+        switchTime /= RUNS;
+        threadedTime /= RUNS;
+        fusedTime /= RUNS;
+        nativeTime /= RUNS;
+        
+        std::cout << "\n=== VM DISPATCH (20M loop iterations) ===\n";
+        std::cout << std::setw(24) << std::left << "Switch"
+                  << std::setw(11) << std::right << std::fixed << std::setprecision(1) << switchTime << " ms\n";
+        std::cout << std::setw(24) << std::left << "Threaded"
+                  << std::setw(11) << std::right << threadedTime << " ms"
+                  << std::setw(9) << std::setprecision(2) << (switchTime / threadedTime) << "x\n";
+        std::cout << std::setw(24) << std::left << "Threaded + superinst"
+                  << std::setw(11) << std::right << std::setprecision(1) << fusedTime << " ms"
+                  << std::setw(9) << std::setprecision(2) << (switchTime / fusedTime) << "x\n";
+        std::cout << std::setw(24) << std::left << "Native JIT (OSR)"
+                  << std::setw(11) << std::right << std::setprecision(1) << nativeTime << " ms"
+                  << std::setw(9) << std::setprecision(2) << (switchTime / nativeTime) << "x\n";
+    }
+    
+    // Chamadas: ~2.7M frames por execucao
+    {
+        const int RUNS = 3;
+        double switchTime = 0, threadedTime = 0;
+        benchVMCalls(Kava::DispatchMode::Switch);
+        benchVMCalls(Kava::DispatchMode::Threaded);
+        for (int r = 0; r < RUNS; r++) {
+            switchTime += benchVMCalls(Kava::DispatchMode::Switch);
+            threadedTime += benchVMCalls(Kava::DispatchMode::Threaded);
+        }
+        switchTime /= RUNS;
+        threadedTime /= RUNS;
+        
+        std::cout << "\n=== VM CALLS (fib(30), recursive) ===\n";
+        std::cout << std::setw(24) << std::left << "Switch"
+                  << std::setw(11) << std::right << std::fixed << std::setprecision(1) << switchTime << " ms\n";
+        std::cout << std::setw(24) << std::left << "Threaded"
+                  << std::setw(11) << std::right << threadedTime << " ms"
+                  << std::setw(9) << std::setprecision(2) << (switchTime / threadedTime) << "x\n";
+    }
+    
+    // Minor GC: a pausa deve seguir a young gen, nao o tamanho da old gen
+    {
+        std::cout << "\n=== GC MINOR PAUSE (young gen ~6 MB, avg of 20) ===\n";
+        for (size_t oldMB : {8, 64, 256}) {
+            double pause = benchMinorPause(oldMB);
+            std::cout << std::setw(24) << std::left << ("Old gen " + std::to_string(oldMB) + " MB")
+                      << std::setw(11) << std::right << std::fixed << std::setprecision(3) << pause << " ms\n";
+        }
+    }
+    
+    // Executors: fila unica com lock contra work-stealing
+    {
+        std::cout << "\n=== EXECUTORS (" << EXECUTOR_TASKS << " tiny tasks, 4 workers) ===\n";
+        double poolMs, forkJoinMs, sumMs;
+        int64_t sum = 0;
+        {
+            Kava::ThreadPoolExecutor pool(4);
+            poolMs = benchTinyTasks(pool);
+        }
+        {
+            Kava::ForkJoinPool pool(4);
+            forkJoinMs = benchTinyTasks(pool);
+            sumMs = benchForkJoinSum(pool, sum);
+        }
+        std::cout << std::setw(24) << std::left << "ThreadPoolExecutor"
+                  << std::setw(11) << std::right << std::fixed << std::setprecision(1) << poolMs << " ms\n";
+        std::cout << std::setw(24) << std::left << "ForkJoinPool"
+                  << std::setw(11) << std::right << forkJoinMs << " ms"
+                  << std::setw(9) << std::setprecision(2) << (poolMs / forkJoinMs) << "x\n";
+        std::cout << std::setw(24) << std::left << "Fork/join sum (8M)"
+                  << std::setw(11) << std::right << std::setprecision(1) << sumMs << " ms"
+                  << (sum == int64_t(8 * 1024 * 1024) * (8 * 1024 * 1024 - 1) / 2 ? "      OK" : "      WRONG") << "\n";
+    }
+    
+    // Contencao: filas e mapas com lock unico contra as versoes concorrentes
+    {
+        std::cout << "\n=== CONTENTION (N producers + N consumers / N map threads) ===\n";
+        Kava::ContentionBenchmarks::runAll();
+    }
+    
+    // TLABs: a vazao de alocacao deve escalar com as threads
+    {
+        std::cout << "\n=== ALLOCATION THROUGHPUT (TLAB per thread) ===\n";
+        double single = benchAllocScaling(1);
+        for (int threads : {1, 2, 4}) {
+            double rate = threads == 1 ? single : benchAllocScaling(threads);
+            std::cout << std::setw(24) << std::left << (std::to_string(threads) + " thread(s)")
+                      << std::setw(11) << std::right << std::fixed << std::setprecision(1) << rate << " Mobj/s"
+                      << std::setw(5) << std::setprecision(2) << (rate / single) << "x\n";
+        }
+    }
+    
+    // Full GC: copia paralela com work-stealing entre os workers
+    {
+        std::cout << "\n=== GC FULL PAUSE (~48 MB live) ===\n";
+        double serial = benchFullPause(1);
+        for (int threads : {1, 2, 4}) {
+            double pause = threads == 1 ? serial : benchFullPause(threads);
+            std::cout << std::setw(24) << std::left << (std::to_string(threads) + " GC thread(s)")
+                      << std::setw(11) << std::right << std::fixed << std::setprecision(1) << pause << " ms"
+                      << std::setw(9) << std::setprecision(2) << (serial / pause) << "x\n";
+        }
+    }
+    
     // Calculate overall
     double kavaTotal = 0, javaTotal = 0;
     for (auto& r : results) { kavaTotal += r.kavaMs; javaTotal += r.java8Ms; }
@@ -0,0 +1,513 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 KAVA Team
+ *
+ * KAVA 2.5 - Suite de workloads Kava (kavabench --suite)
+ * Programas .kava de verdade (benchmark/workloads) compilados pelo kavac e
+ * executados pela VM em cada configuracao de tier e de GC. Cada par
+ * workload x configuracao roda warmup + N vezes numa VM nova; o relatorio
+ * traz mediana, percentis, intervalo de confianca de 95% (t de Student) e
+ * contadores de hardware (perf_event_open) da thread da VM. Os resultados
+ * vao para JSON e podem ser comparados com um baseline: regressao acima do
+ * limiar com intervalos de confianca disjuntos faz o kavabench falhar.
+ */
+
+#ifndef KAVA_BENCH_SUITE_H
+#define KAVA_BENCH_SUITE_H
+
+#include "vm.h"
+#include "json.h"
+#include <vector>
+#include <string>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <thread>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#define KAVA_PERF_EVENTS 1
+#endif
+
+namespace Kava {
+
+// ============================================================
+// ESTATISTICAS DE UMA SERIE DE TEMPOS
+// ============================================================
+struct SampleStats {
+    size_t n = 0;
+    double mean = 0, stddev = 0;
+    double median = 0, p90 = 0, p99 = 0;
+    double min = 0, max = 0;
+    double ciLow = 0, ciHigh = 0;   // IC de 95% da media
+
+    static SampleStats of(std::vector<double> v) {
+        SampleStats s;
+        s.n = v.size();
+        if (v.empty()) return s;
+        std::sort(v.begin(), v.end());
+        s.min = v.front();
+        s.max = v.back();
+        s.mean = std::accumulate(v.begin(), v.end(), 0.0) / v.size();
+        double ss = 0;
+        for (double x : v) ss += (x - s.mean) * (x - s.mean);
+        s.stddev = v.size() > 1 ? std::sqrt(ss / (v.size() - 1)) : 0.0;  // amostral
+        s.median = percentile(v, 0.50);
+        s.p90 = percentile(v, 0.90);
+        s.p99 = percentile(v, 0.99);
+        const double half = v.size() > 1 ? tCritical95(v.size() - 1) * s.stddev / std::sqrt(static_cast<double>(v.size())) : 0.0;
+        s.ciLow = s.mean - half;
+        s.ciHigh = s.mean + half;
+        return s;
+    }
+
+    // Interpolacao linear entre as ordens vizinhas (sorted ja ordenado)
+    static double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0;
+        const double rank = p * (sorted.size() - 1);
+        const size_t lo = static_cast<size_t>(rank);
+        const size_t hi = std::min(lo + 1, sorted.size() - 1);
+        return sorted[lo] + (sorted[hi] - sorted[lo]) * (rank - lo);
+    }
+
+    // t bicaudal de 95%; acima de 30 graus de liberdade, a normal
+    static double tCritical95(size_t df) {
+        static const double table[] = {
+            0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+        return df == 0 ? 0 : df <= 30 ? table[df] : 1.960;
+    }
+
+    double cv() const { return mean > 0 ? stddev / mean : 0; }
+};
+
+// ============================================================
+// CONTADORES DE HARDWARE (perf_event_open)
+// ============================================================
+// Um grupo (ciclos lideram) contando so a thread chamadora em modo usuario,
+// que e onde o interpretador roda. Sem permissao (perf_event_paranoid,
+// containers) available() fica false e o relatorio mostra n/a.
+class PerfCounters {
+public:
+    struct Reading {
+        bool valid = false;
+        uint64_t cycles = 0;
+        uint64_t instructions = 0;
+        uint64_t cacheMisses = 0;
+        uint64_t branchMisses = 0;
+    };
+
+    PerfCounters() {
+#ifdef KAVA_PERF_EVENTS
+        const uint64_t configs[COUNT] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                         PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for (int i = 0; i < COUNT; i++) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.disabled = i == 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds[0], 0));
+            if (fds[i] < 0) {
+                close();
+                return;
+            }
+        }
+#endif
+    }
+
+    ~PerfCounters() { close(); }
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const { return fds[0] >= 0; }
+
+    void start() {
+#ifdef KAVA_PERF_EVENTS
+        if (!available()) return;
+        ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    // Escalado por enabled/running quando o kernel multiplexou o grupo
+    Reading stop() {
+        Reading r;
+#ifdef KAVA_PERF_EVENTS
+        if (!available()) return r;
+        ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        uint64_t buf[3 + COUNT] = {};  // nr, enabled, running, valores
+        if (::read(fds[0], buf, sizeof(buf)) < static_cast<ssize_t>(sizeof(buf)) || buf[0] != COUNT || buf[2] == 0) return r;
+        const double scale = static_cast<double>(buf[1]) / static_cast<double>(buf[2]);
+        auto value = [&](int i) { return static_cast<uint64_t>(static_cast<double>(buf[3 + i]) * scale); };
+        r.valid = true;
+        r.cycles = value(0);
+        r.instructions = value(1);
+        r.cacheMisses = value(2);
+        r.branchMisses = value(3);
+#endif
+        return r;
+    }
+
+private:
+    static constexpr int COUNT = 4;
+    int fds[COUNT] = {-1, -1, -1, -1};
+
+    void close() {
+        for (int& fd : fds) {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+    }
+};
+
+// ============================================================
+// SUITE
+// ============================================================
+class KavaSuite {
+public:
+    // Tier / GC: aplicado ao VMConfig antes do loadBytecode (o JIT e as
+    // superinstrucoes agem na carga)
+    struct Config {
+        std::string name;
+        std::function<void(VMConfig&)> apply;
+    };
+
+    struct Options {
+        std::string workloadDir = "benchmark/workloads";
+        std::string kavac = "./kavac";
+        int runs = 10;
+        int warmup = 2;
+        std::vector<std::string> workloads;   // vazio = todos do diretorio
+        std::vector<std::string> configs;     // vazio = standardConfigs()
+        std::string jsonPath;
+        std::string baselinePath;
+        double threshold = 0.05;              // regressao: mediana > baseline * (1 + threshold)
+    };
+
+    struct Result {
+        std::string workload;
+        std::string config;
+        std::vector<double> samplesMs;
+        SampleStats stats;
+        PerfCounters::Reading counters;       // media por execucao
+        uint64_t outputHash = 0;
+        std::string error;                    // compilacao, carga ou saida divergente
+    };
+
+    static std::vector<Config> standardConfigs() {
+        return {
+            {"interp-switch", [](VMConfig& c) {
+                c.dispatch = DispatchMode::Switch;
+                c.enableJIT = false;
+                c.enableSuperinstructions = false;
+            }},
+            {"interp-threaded", [](VMConfig& c) {
+                c.dispatch = DispatchMode::Threaded;
+                c.enableJIT = false;
+                c.enableSuperinstructions = false;
+            }},
+            {"jit", [](VMConfig&) {}},
+            {"jit-gc-serial", [](VMConfig& c) { c.gcThreads = 1; }},
+            {"jit-gc-concurrent", [](VMConfig& c) { c.concurrentGC = true; }},
+        };
+    }
+
+    // Codigo de saida: 0 ok, 1 regressao, saida divergente ou workload quebrado
+    static int run(const Options& opt) {
+        std::vector<Config> configs;
+        for (const Config& c : standardConfigs()) {
+            if (opt.configs.empty() || std::find(opt.configs.begin(), opt.configs.end(), c.name) != opt.configs.end()) {
+                configs.push_back(c);
+            }
+        }
+        std::vector<std::filesystem::path> sources = findWorkloads(opt);
+        if (sources.empty() || configs.empty()) {
+            std::cerr << "Nenhum workload/configuracao em " << opt.workloadDir << std::endl;
+            return 1;
+        }
+
+        PerfCounters perf;
+        std::cout << "\n=== KAVA WORKLOAD SUITE (" << opt.warmup << " warmup + " << opt.runs
+                  << " runs, IC 95%) ===\n";
+        if (!perf.available()) std::cout << "Contadores de hardware indisponiveis (perf_event_open)\n";
+        printHeader();
+
+        std::vector<Result> results;
+        bool failed = false;
+        for (const auto& source : sources) {
+            const std::string name = source.stem().string();
+            std::vector<uint8_t> image;
+            std::string error = compile(opt.kavac, source, image);
+            std::string expectedOutput;
+            bool haveExpected = false;
+            for (const Config& cfg : configs) {
+                Result r;
+                r.workload = name;
+                r.config = cfg.name;
+                r.error = error;
+                if (r.error.empty()) measure(cfg, image, opt, perf, r, expectedOutput, haveExpected);
+                failed |= !r.error.empty();
+                printRow(r);
+                results.push_back(std::move(r));
+            }
+        }
+
+        if (!opt.jsonPath.empty()) {
+            if (writeJson(opt, results)) std::cout << "\nResultados: " << opt.jsonPath << "\n";
+            else std::cerr << "Erro ao gravar " << opt.jsonPath << std::endl;
+        }
+        if (!opt.baselinePath.empty()) failed |= compareBaseline(opt, results);
+        return failed ? 1 : 0;
+    }
+
+private:
+    static std::vector<std::filesystem::path> findWorkloads(const Options& opt) {
+        std::vector<std::filesystem::path> out;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(opt.workloadDir, ec)) {
+            const auto& p = entry.path();
+            if (p.extension() != ".kava") continue;
+            if (!opt.workloads.empty() &&
+                std::find(opt.workloads.begin(), opt.workloads.end(), p.stem().string()) == opt.workloads.end()) {
+                continue;
+            }
+            out.push_back(p);
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    // O kavac grava o .kvb ao lado do fonte: compila uma copia num diretorio
+    // temporario para nao sujar benchmark/workloads
+    static std::string compile(const std::string& kavac, const std::filesystem::path& source, std::vector<uint8_t>& image) {
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        const fs::path dir = fs::temp_directory_path(ec) / ("kavabench-" + std::to_string(getpid()));
+        fs::create_directories(dir, ec);
+        const fs::path copy = dir / source.filename();
+        fs::copy_file(source, copy, fs::copy_options::overwrite_existing, ec);
+        if (ec) return "copia falhou: " + ec.message();
+        const std::string cmd = "\"" + kavac + "\" \"" + copy.string() + "\" > /dev/null 2>&1";
+        if (std::system(cmd.c_str()) != 0) {
+            fs::remove_all(dir, ec);
+            return "kavac falhou (" + kavac + ")";
+        }
+        fs::path kvb = copy;
+        kvb.replace_extension(".kvb");
+        std::ifstream in(kvb, std::ios::binary);
+        image.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        fs::remove_all(dir, ec);
+        return image.empty() ? "kvb vazio" : "";
+    }
+
+    static uint64_t fnv1a(const std::string& s) {
+        uint64_t h = 1469598103934665603ULL;
+        for (unsigned char c : s) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    // Uma VM nova por execucao; o stdout do programa e capturado e toda
+    // execucao (de todas as configuracoes) tem de imprimir o mesmo
+    static void measure(const Config& cfg, const std::vector<uint8_t>& image, const Options& opt, PerfCounters& perf,
+                        Result& r, std::string& expectedOutput, bool& haveExpected) {
+        PerfCounters::Reading total;
+        int counted = 0;
+        for (int i = 0; i < opt.warmup + opt.runs; i++) {
+            VM vm;
+            cfg.apply(vm.config);
+            if (!vm.loadBytecode(image.data(), image.size())) {
+                r.error = "carga do kvb falhou";
+                if (!vm.loadError.empty()) r.error += ": " + vm.loadError;
+                return;
+            }
+            std::ostringstream captured;
+            std::streambuf* previous = std::cout.rdbuf(captured.rdbuf());
+            perf.start();
+            const auto start = std::chrono::steady_clock::now();
+            vm.run();
+            const auto end = std::chrono::steady_clock::now();
+            const PerfCounters::Reading reading = perf.stop();
+            std::cout.rdbuf(previous);
+
+            const std::string output = captured.str();
+            if (!haveExpected) {
+                expectedOutput = output;
+                haveExpected = true;
+            } else if (output != expectedOutput) {
+                r.error = "saida diferente da primeira configuracao";
+                return;
+            }
+            r.outputHash = fnv1a(output);
+            if (i < opt.warmup) continue;
+            r.samplesMs.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            if (reading.valid) {
+                total.cycles += reading.cycles;
+                total.instructions += reading.instructions;
+                total.cacheMisses += reading.cacheMisses;
+                total.branchMisses += reading.branchMisses;
+                counted++;
+            }
+        }
+        r.stats = SampleStats::of(r.samplesMs);
+        if (counted) {
+            r.counters.valid = true;
+            r.counters.cycles = total.cycles / counted;
+            r.counters.instructions = total.instructions / counted;
+            r.counters.cacheMisses = total.cacheMisses / counted;
+            r.counters.branchMisses = total.branchMisses / counted;
+        }
+    }
+
+    static double ipc(const PerfCounters::Reading& c) {
+        return c.cycles ? static_cast<double>(c.instructions) / static_cast<double>(c.cycles) : 0.0;
+    }
+
+    static void printHeader() {
+        std::cout << std::left << std::setw(12) << "Workload" << std::setw(20) << "Config"
+                  << std::right << std::setw(11) << "Median" << std::setw(10) << "+-95%"
+                  << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(7) << "CV"
+                  << std::setw(7) << "IPC" << std::setw(12) << "LLC miss" << "\n";
+        std::cout << std::string(99, '-') << "\n";
+    }
+
+    static void printRow(const Result& r) {
+        std::cout << std::left << std::setw(12) << r.workload << std::setw(20) << r.config << std::right;
+        if (!r.error.empty()) {
+            std::cout << "  ERRO: " << r.error << std::endl;
+            return;
+        }
+        const SampleStats& s = r.stats;
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(8) << s.median << " ms" << std::setw(10) << (s.ciHigh - s.mean)
+                  << std::setw(10) << s.p90 << std::setw(10) << s.p99
+                  << std::setw(6) << std::setprecision(1) << 100.0 * s.cv() << "%";
+        if (r.counters.valid) {
+            std::cout << std::setw(7) << std::setprecision(2) << ipc(r.counters) << std::setw(12) << r.counters.cacheMisses;
+        } else {
+            std::cout << std::setw(7) << "n/a" << std::setw(12) << "n/a";
+        }
+        std::cout << std::defaultfloat << std::endl;
+    }
+
+    static bool writeJson(const Options& opt, const std::vector<Result>& results) {
+        JsonWriter w(16 * 1024);
+        w.beginObject()
+            .key("suite").value("kava-workloads")
+            .key("version").value(1)
+            .key("timestamp").value(static_cast<int64_t>(std::time(nullptr)))
+            .key("host").beginObject()
+                .key("cpus").value(static_cast<int64_t>(std::thread::hardware_concurrency()))
+                .key("simd").value(Simd::best().name)
+            .endObject()
+            .key("runs").value(opt.runs)
+            .key("warmup").value(opt.warmup)
+            .key("results").beginArray();
+        for (const Result& r : results) {
+            w.beginObject().key("workload").value(r.workload).key("config").value(r.config);
+            if (!r.error.empty()) {
+                w.key("error").value(r.error).endObject();
+                continue;
+            }
+            const SampleStats& s = r.stats;
+            w.key("samples_ms").beginArray();
+            for (double ms : r.samplesMs) w.value(ms);
+            w.endArray()
+                .key("mean_ms").value(s.mean)
+                .key("median_ms").value(s.median)
+                .key("p90_ms").value(s.p90)
+                .key("p99_ms").value(s.p99)
+                .key("min_ms").value(s.min)
+                .key("max_ms").value(s.max)
+                .key("stddev_ms").value(s.stddev)
+                .key("ci95_ms").beginArray().value(s.ciLow).value(s.ciHigh).endArray()
+                .key("output_hash").value(static_cast<int64_t>(r.outputHash & 0x7FFFFFFFFFFFFFFFULL))
+                .key("counters");
+            if (r.counters.valid) {
+                w.beginObject()
+                    .key("cycles").value(static_cast<int64_t>(r.counters.cycles))
+                    .key("instructions").value(static_cast<int64_t>(r.counters.instructions))
+                    .key("ipc").value(ipc(r.counters))
+                    .key("cache_misses").value(static_cast<int64_t>(r.counters.cacheMisses))
+                    .key("branch_misses").value(static_cast<int64_t>(r.counters.branchMisses))
+                    .endObject();
+            } else {
+                w.value(nullptr);
+            }
+            w.endObject();
+        }
+        w.endArray().endObject();
+        std::ofstream out(opt.jsonPath, std::ios::binary);
+        out << w.str() << '\n';
+        return static_cast<bool>(out);
+    }
+
+    // Regressao so quando a mediana piora alem do limiar E os intervalos de
+    // confianca nao se sobrepoem (ruido nao reprova); true = reprovou
+    static bool compareBaseline(const Options& opt, const std::vector<Result>& results) {
+        std::ifstream in(opt.baselinePath, std::ios::binary);
+        const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        JsonDocument doc = JsonDocument::parse(text);
+        if (!doc.ok() || !doc.root()["results"].isArray()) {
+            std::cerr << "Baseline invalido: " << opt.baselinePath << " (" << jsonErrorName(doc.error()) << ")" << std::endl;
+            return true;
+        }
+
+        std::cout << "\n=== BASELINE " << opt.baselinePath << " (limiar " << std::fixed << std::setprecision(1)
+                  << 100.0 * opt.threshold << "%) ===\n" << std::defaultfloat;
+        int regressions = 0;
+        for (const Result& r : results) {
+            if (!r.error.empty()) continue;
+            const JsonValue* base = nullptr;
+            for (const JsonValue& b : doc.root()["results"]) {
+                if (b["workload"].asString() == r.workload && b["config"].asString() == r.config && b["median_ms"].isNumber()) {
+                    base = &b;
+                    break;
+                }
+            }
+            std::cout << std::left << std::setw(12) << r.workload << std::setw(20) << r.config << std::right;
+            if (!base) {
+                std::cout << "  (sem baseline)\n";
+                continue;
+            }
+            const double baseMedian = (*base)["median_ms"].asDouble();
+            const double baseHigh = (*base)["ci95_ms"][1].asDouble();
+            const double baseLow = (*base)["ci95_ms"][0].asDouble();
+            const double delta = baseMedian > 0 ? r.stats.median / baseMedian - 1.0 : 0.0;
+            const char* verdict = "=";
+            if (delta > opt.threshold && r.stats.ciLow > baseHigh) {
+                verdict = "REGRESSAO";
+                regressions++;
+            } else if (delta < -opt.threshold && r.stats.ciHigh < baseLow) {
+                verdict = "melhora";
+            }
+            std::cout << std::fixed << std::setprecision(2) << std::setw(9) << baseMedian << " -> "
+                      << std::setw(9) << r.stats.median << " ms" << std::showpos << std::setw(9)
+                      << 100.0 * delta << "%" << std::noshowpos << "  " << verdict << std::defaultfloat << "\n";
+        }
+        if (regressions) std::cout << regressions << " regressao(oes) acima do limiar\n";
+        return regressions > 0;
+    }
+};
+
+} // namespace Kava
+
+#endif // KAVA_BENCH_SUITE_H
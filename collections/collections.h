@@ -12,6 +12,15 @@
 #include <cstdint>
 #include <cstring>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <type_traits>
+#include <algorithm>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include "../gc/gc.h"
 
 namespace Kava {
@@ -30,7 +39,7 @@ template<typename T>
 class Iterable {
 public:
     virtual ~Iterable() = default;
-    virtual Iterator<T> iterator() = 0;
+    virtual std::unique_ptr<Iterator<T>> iterator() = 0;
 };
 
 // ============================================================
@@ -53,8 +62,8 @@ public:
     virtual bool addAll(const Collection<T>& c) {
         bool modified = false;
         auto it = const_cast<Collection<T>&>(c).iterator();
-        while (it.hasNext()) {
-            if (add(it.next())) modified = true;
+        while (it->hasNext()) {
+            if (add(it->next())) modified = true;
         }
         return modified;
     }
@@ -62,8 +71,8 @@ public:
     virtual bool removeAll(const Collection<T>& c) {
         bool modified = false;
         auto it = const_cast<Collection<T>&>(c).iterator();
-        while (it.hasNext()) {
-            if (remove(it.next())) modified = true;
+        while (it->hasNext()) {
+            if (remove(it->next())) modified = true;
         }
         return modified;
     }
@@ -265,8 +274,8 @@ public:
         }
     }
     
-    Iterator<T> iterator() override {
-        return ArrayIterator<T>(elements, count);
+    std::unique_ptr<Iterator<T>> iterator() override {
+        return std::make_unique<ArrayIterator<T>>(elements, count);
     }
     
     // List interface
@@ -447,9 +456,9 @@ public:
         }
     }
     
-    Iterator<T> iterator() override {
+    std::unique_ptr<Iterator<T>> iterator() override {
         // TODO: Implementar LinkedListIterator
-        return ArrayIterator<T>(nullptr, 0);
+        return std::make_unique<ArrayIterator<T>>(nullptr, 0);
     }
     
     // List interface
@@ -596,188 +605,261 @@ private:
 };
 
 // ============================================================
-// HASH MAP ENTRY
+// CONTROL BYTES - Metadados do HashMap (estilo Swiss table)
 // ============================================================
-template<typename K, typename V>
-struct HashEntry {
-    K key;
-    V value;
-    HashEntry* next;
-    uint32_t hash;
-    
-    HashEntry(const K& k, const V& v, uint32_t h)
-        : key(k), value(v), next(nullptr), hash(h) {}
-};
+// Um byte por slot: EMPTY, DELETED ou, se ocupado, os 7 bits baixos do
+// hash (H2). A busca compara um grupo de 16 bytes de uma vez e só toca
+// nas chaves cujo H2 bate; uma posição EMPTY no grupo encerra a busca.
+namespace HashCtrl {
+    constexpr int8_t EMPTY = -128;     // 0b10000000
+    constexpr int8_t DELETED = -2;     // 0b11111110
+    constexpr int GROUP_WIDTH = 16;
+    
+    inline bool isFull(int8_t c) { return c >= 0; }
+    
+    // Bit i ligado = byte i do grupo casa
+    struct Group {
+#if defined(__SSE2__)
+        __m128i ctrl;
+        
+        explicit Group(const int8_t* p)
+            : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+        
+        uint32_t match(int8_t h2) const {
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+        }
+        
+        // EMPTY e DELETED são os únicos bytes negativos: basta o bit de sinal
+        uint32_t matchEmptyOrDeleted() const {
+            return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+        }
+#else
+        const int8_t* ctrl;
+        
+        explicit Group(const int8_t* p) : ctrl(p) {}
+        
+        uint32_t match(int8_t h2) const {
+            uint32_t mask = 0;
+            for (int i = 0; i < GROUP_WIDTH; i++) {
+                if (ctrl[i] == h2) mask |= 1u << i;
+            }
+            return mask;
+        }
+        
+        uint32_t matchEmptyOrDeleted() const {
+            uint32_t mask = 0;
+            for (int i = 0; i < GROUP_WIDTH; i++) {
+                if (ctrl[i] < 0) mask |= 1u << i;
+            }
+            return mask;
+        }
+#endif
+        uint32_t matchEmpty() const { return match(EMPTY); }
+    };
+    
+    inline int lowestBit(uint32_t mask) { return __builtin_ctz(mask); }
+}
 
 // ============================================================
-// HASHMAP - Tabela hash com encadeamento
+// HASHMAP - Endereçamento aberto com control bytes (Swiss table)
 // ============================================================
+// Chave e valor ficam lado a lado num único array de slots: put não
+// aloca nó nenhum e get lê 16 control bytes + normalmente uma chave.
+// A sondagem anda de grupo em grupo em passos triangulares, o que
+// visita todos os grupos de uma tabela potência de 2.
 template<typename K, typename V>
 class HashMap : public Map<K, V> {
 private:
-    HashEntry<K, V>** table;
+    struct Slot {
+        K key;
+        V value;
+        
+        Slot(const K& k, const V& v) : key(k), value(v) {}
+    };
+    
+    static constexpr float MAX_LOAD = 0.875f;
+    
+    int8_t* ctrl;
+    Slot* slots;
     int count;
+    int tombstones;
     int capacity;
     float loadFactor;
-    int threshold;
+    int threshold;   // Limite para count + tombstones
+    
+    static uint64_t hash(const K& key) {
+        // std::hash de inteiros é a identidade: mistura (fmix64) para H1/H2
+        uint64_t h = static_cast<uint64_t>(std::hash<K>{}(key));
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ull;
+        h ^= h >> 33;
+        return h;
+    }
+    
+    static int8_t h2(uint64_t h) { return static_cast<int8_t>(h & 0x7F); }
+    
+    size_t groupMask() const { return static_cast<size_t>(capacity / HashCtrl::GROUP_WIDTH) - 1; }
+    
+    int findIndex(const K& key, uint64_t h) const {
+        const size_t mask = groupMask();
+        size_t group = (h >> 7) & mask;
+        for (size_t step = 1; ; step++) {
+            size_t base = group * HashCtrl::GROUP_WIDTH;
+            HashCtrl::Group g(ctrl + base);
+            for (uint32_t m = g.match(h2(h)); m; m &= m - 1) {
+                size_t i = base + HashCtrl::lowestBit(m);
+                if (slots[i].key == key) return static_cast<int>(i);
+            }
+            if (g.matchEmpty()) return -1;
+            group = (group + step) & mask;
+        }
+    }
     
-    uint32_t hash(const K& key) const {
-        // Hash simples para tipos primitivos
-        return std::hash<K>{}(key);
+    // Primeira posição EMPTY/DELETED na sequência de sondagem de h
+    size_t findInsertSlot(uint64_t h) const {
+        const size_t mask = groupMask();
+        size_t group = (h >> 7) & mask;
+        for (size_t step = 1; ; step++) {
+            size_t base = group * HashCtrl::GROUP_WIDTH;
+            uint32_t m = HashCtrl::Group(ctrl + base).matchEmptyOrDeleted();
+            if (m) return base + HashCtrl::lowestBit(m);
+            group = (group + step) & mask;
+        }
     }
     
-    int indexFor(uint32_t h) const {
-        return h & (capacity - 1);
+    void allocate(int newCapacity) {
+        capacity = newCapacity;
+        ctrl = new int8_t[capacity];
+        std::memset(ctrl, static_cast<unsigned char>(HashCtrl::EMPTY), capacity);
+        slots = std::allocator<Slot>().allocate(capacity);
+        threshold = static_cast<int>(capacity * std::min(loadFactor, MAX_LOAD));
+        if (threshold >= capacity) threshold = capacity - 1;
     }
     
-    void resize(int newCapacity) {
-        HashEntry<K, V>** newTable = new HashEntry<K, V>*[newCapacity]();
-        
-        // Rehash all entries
+    void release() {
         for (int i = 0; i < capacity; i++) {
-            HashEntry<K, V>* entry = table[i];
-            while (entry) {
-                HashEntry<K, V>* next = entry->next;
-                int newIndex = entry->hash & (newCapacity - 1);
-                entry->next = newTable[newIndex];
-                newTable[newIndex] = entry;
-                entry = next;
-            }
+            if (HashCtrl::isFull(ctrl[i])) slots[i].~Slot();
+        }
+        std::allocator<Slot>().deallocate(slots, capacity);
+        delete[] ctrl;
+    }
+    
+    // Realoca e reinsere; também descarta os tombstones
+    void rehash(int newCapacity) {
+        int8_t* oldCtrl = ctrl;
+        Slot* oldSlots = slots;
+        int oldCapacity = capacity;
+        
+        allocate(newCapacity);
+        for (int i = 0; i < oldCapacity; i++) {
+            if (!HashCtrl::isFull(oldCtrl[i])) continue;
+            uint64_t h = hash(oldSlots[i].key);
+            size_t index = findInsertSlot(h);
+            new (&slots[index]) Slot(std::move(oldSlots[i]));
+            ctrl[index] = h2(h);
+            oldSlots[i].~Slot();
         }
+        tombstones = 0;
         
-        delete[] table;
-        table = newTable;
-        capacity = newCapacity;
-        threshold = static_cast<int>(capacity * loadFactor);
+        std::allocator<Slot>().deallocate(oldSlots, oldCapacity);
+        delete[] oldCtrl;
     }
     
 public:
     explicit HashMap(int initialCapacity = 16, float lf = 0.75f)
-        : count(0), capacity(initialCapacity), loadFactor(lf) {
-        // Garante que capacidade é potência de 2
-        int cap = 1;
+        : count(0), tombstones(0), loadFactor(lf) {
+        // Potência de 2 e pelo menos um grupo inteiro
+        int cap = HashCtrl::GROUP_WIDTH;
         while (cap < initialCapacity) cap <<= 1;
-        capacity = cap;
-        
-        table = new HashEntry<K, V>*[capacity]();
-        threshold = static_cast<int>(capacity * loadFactor);
+        allocate(cap);
     }
     
     ~HashMap() {
-        clear();
-        delete[] table;
+        release();
     }
     
+    HashMap(const HashMap&) = delete;
+    HashMap& operator=(const HashMap&) = delete;
+    
     // Map interface
     int size() const override { return count; }
     
     bool containsKey(const K& key) const override {
-        return get(key) != nullptr;
+        return findIndex(key, hash(key)) >= 0;
     }
     
     bool containsValue(const V& value) const override {
         for (int i = 0; i < capacity; i++) {
-            HashEntry<K, V>* entry = table[i];
-            while (entry) {
-                if (entry->value == value) return true;
-                entry = entry->next;
-            }
+            if (HashCtrl::isFull(ctrl[i]) && slots[i].value == value) return true;
         }
         return false;
     }
     
     V* get(const K& key) override {
-        uint32_t h = hash(key);
-        int index = indexFor(h);
-        
-        HashEntry<K, V>* entry = table[index];
-        while (entry) {
-            if (entry->hash == h && entry->key == key) {
-                return &entry->value;
-            }
-            entry = entry->next;
-        }
-        return nullptr;
+        int index = findIndex(key, hash(key));
+        return index >= 0 ? &slots[index].value : nullptr;
     }
     
     V put(const K& key, const V& value) override {
-        uint32_t h = hash(key);
-        int index = indexFor(h);
+        uint64_t h = hash(key);
         
         // Procura entrada existente
-        HashEntry<K, V>* entry = table[index];
-        while (entry) {
-            if (entry->hash == h && entry->key == key) {
-                V oldValue = entry->value;
-                entry->value = value;
-                return oldValue;
-            }
-            entry = entry->next;
+        int index = findIndex(key, h);
+        if (index >= 0) {
+            V oldValue = slots[index].value;
+            slots[index].value = value;
+            return oldValue;
         }
         
-        // Adiciona nova entrada
-        if (count >= threshold) {
-            resize(capacity * 2);
-            index = indexFor(h);
+        // Adiciona nova entrada (cresce, ou só limpa tombstones)
+        if (count + tombstones >= threshold) {
+            rehash(count * 2 >= threshold ? capacity * 2 : capacity);
         }
         
-        HashEntry<K, V>* newEntry = new HashEntry<K, V>(key, value, h);
-        newEntry->next = table[index];
-        table[index] = newEntry;
+        size_t slot = findInsertSlot(h);
+        if (ctrl[slot] == HashCtrl::DELETED) tombstones--;
+        new (&slots[slot]) Slot(key, value);
+        ctrl[slot] = h2(h);
         count++;
         
         return V();
     }
     
     V remove(const K& key) override {
-        uint32_t h = hash(key);
-        int index = indexFor(h);
+        int index = findIndex(key, hash(key));
+        if (index < 0) return V();
         
-        HashEntry<K, V>* prev = nullptr;
-        HashEntry<K, V>* entry = table[index];
+        V oldValue = std::move(slots[index].value);
+        slots[index].~Slot();
+        count--;
         
-        while (entry) {
-            if (entry->hash == h && entry->key == key) {
-                V oldValue = entry->value;
-                
-                if (prev == nullptr) {
-                    table[index] = entry->next;
-                } else {
-                    prev->next = entry->next;
-                }
-                
-                delete entry;
-                count--;
-                return oldValue;
-            }
-            prev = entry;
-            entry = entry->next;
+        // Grupo que já tem EMPTY nunca encerrou uma sondagem como "cheio":
+        // a posição pode voltar a EMPTY em vez de virar tombstone
+        size_t base = static_cast<size_t>(index) & ~static_cast<size_t>(HashCtrl::GROUP_WIDTH - 1);
+        if (HashCtrl::Group(ctrl + base).matchEmpty()) {
+            ctrl[index] = HashCtrl::EMPTY;
+        } else {
+            ctrl[index] = HashCtrl::DELETED;
+            tombstones++;
         }
-        
-        return V();
+        return oldValue;
     }
     
     void clear() override {
         for (int i = 0; i < capacity; i++) {
-            HashEntry<K, V>* entry = table[i];
-            while (entry) {
-                HashEntry<K, V>* next = entry->next;
-                delete entry;
-                entry = next;
-            }
-            table[i] = nullptr;
+            if (HashCtrl::isFull(ctrl[i])) slots[i].~Slot();
         }
+        std::memset(ctrl, static_cast<unsigned char>(HashCtrl::EMPTY), capacity);
         count = 0;
+        tombstones = 0;
     }
     
     Set<K>* keySet() override {
         auto* keys = new HashSet<K>();
         for (int i = 0; i < capacity; i++) {
-            HashEntry<K, V>* entry = table[i];
-            while (entry) {
-                keys->add(entry->key);
-                entry = entry->next;
-            }
+            if (HashCtrl::isFull(ctrl[i])) keys->add(slots[i].key);
         }
         return keys;
     }
@@ -785,11 +867,7 @@ public:
     Collection<V>* values() override {
         auto* vals = new ArrayList<V>();
         for (int i = 0; i < capacity; i++) {
-            HashEntry<K, V>* entry = table[i];
-            while (entry) {
-                vals->add(entry->value);
-                entry = entry->next;
-            }
+            if (HashCtrl::isFull(ctrl[i])) vals->add(slots[i].value);
         }
         return vals;
     }
@@ -797,10 +875,479 @@ public:
     // Iteration helper
     void forEach(std::function<void(const K&, V&)> action) {
         for (int i = 0; i < capacity; i++) {
-            HashEntry<K, V>* entry = table[i];
-            while (entry) {
-                action(entry->key, entry->value);
-                entry = entry->next;
+            if (HashCtrl::isFull(ctrl[i])) action(slots[i].key, slots[i].value);
+        }
+    }
+};
+
+// ============================================================
+// EPOCH RECLAIMER - Liberação adiada para leituras sem lock
+// ============================================================
+// Leitores anunciam a época global enquanto seguram ponteiros (Guard);
+// escritores aposentam o que desligaram com a época corrente. A época só
+// avança quando todo leitor ativo já anunciou a atual, então algo
+// aposentado na época e deixa de ser alcançável quando a global chega a
+// e + 2. Fora de um Guard a thread está quiescente e não atrasa ninguém.
+class EpochReclaimer {
+    struct Record;
+    
+public:
+    class Guard {
+    public:
+        Guard() : record(localRecord()) {
+            if (record->depth++ > 0) return;
+            // Reanuncia até a global não mudar entre a leitura e o anúncio
+            uint64_t seen = global().load(std::memory_order_seq_cst);
+            for (;;) {
+                record->epoch.store(seen, std::memory_order_seq_cst);
+                uint64_t now = global().load(std::memory_order_seq_cst);
+                if (now == seen) break;
+                seen = now;
+            }
+        }
+        ~Guard() {
+            if (--record->depth == 0) record->epoch.store(QUIESCENT, std::memory_order_release);
+        }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    private:
+        Record* record;
+    };
+    
+    // Época para marcar o que acabou de ser desligado (chamar depois do store
+    // que o tornou inalcançável)
+    static uint64_t retireEpoch() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return global().load(std::memory_order_seq_cst);
+    }
+    
+    // Avança a época se nenhum leitor ativo ainda está na anterior
+    static void tryAdvance() {
+        uint64_t e = global().load(std::memory_order_seq_cst);
+        for (Record* r = records().load(std::memory_order_acquire); r; r = r->next) {
+            uint64_t seen = r->epoch.load(std::memory_order_seq_cst);
+            if (seen != QUIESCENT && seen != e) return;
+        }
+        global().compare_exchange_strong(e, e + 1, std::memory_order_seq_cst);
+    }
+    
+    static bool reclaimable(uint64_t retired) {
+        return global().load(std::memory_order_acquire) >= retired + 2;
+    }
+    
+private:
+    static constexpr uint64_t QUIESCENT = 0;
+    
+    // Um por thread que já leu; reaproveitado quando a thread termina
+    struct alignas(64) Record {
+        std::atomic<uint64_t> epoch{QUIESCENT};
+        std::atomic<bool> inUse{true};
+        Record* next = nullptr;
+        int depth = 0;  // Guards aninhados (só a thread dona toca)
+    };
+    
+    struct LocalRecord {
+        Record* record;
+        LocalRecord() : record(acquireRecord()) {}
+        ~LocalRecord() {
+            record->epoch.store(QUIESCENT, std::memory_order_release);
+            record->inUse.store(false, std::memory_order_release);
+        }
+    };
+    
+    static std::atomic<uint64_t>& global() {
+        static std::atomic<uint64_t> epoch{1};
+        return epoch;
+    }
+    
+    static std::atomic<Record*>& records() {
+        static std::atomic<Record*> head{nullptr};
+        return head;
+    }
+    
+    static Record* localRecord() {
+        static thread_local LocalRecord local;
+        return local.record;
+    }
+    
+    static Record* acquireRecord() {
+        for (Record* r = records().load(std::memory_order_acquire); r; r = r->next) {
+            bool expected = false;
+            if (!r->inUse.load(std::memory_order_relaxed) &&
+                r->inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                r->depth = 0;
+                return r;
+            }
+        }
+        Record* r = new Record();
+        Record* head = records().load(std::memory_order_relaxed);
+        do {
+            r->next = head;
+        } while (!records().compare_exchange_weak(head, r, std::memory_order_release, std::memory_order_relaxed));
+        return r;
+    }
+};
+
+// ============================================================
+// CONCURRENT HASHMAP - Leituras sem lock, escritas por segmento
+// ============================================================
+// Os bits altos do hash escolhem um dos SEGMENTS segmentos e os baixos
+// o balde. Escritores tomam só o mutex do seu segmento; get, containsKey
+// e forEach não tomam lock nenhum e percorrem cadeias publicadas com
+// release/acquire dentro de um EpochReclaimer::Guard. Nós removidos ou
+// substituídos (e tabelas trocadas no resize) são aposentados e liberados
+// assim que nenhum leitor pode mais alcançá-los. Por isso get devolve o
+// valor por cópia: um ponteiro para o nó não sobreviveria à liberação.
+// Não deriva de Map, cujo get entrega V*.
+template<typename K, typename V, int SEGMENTS = 16>
+class ConcurrentHashMap {
+private:
+    static_assert(SEGMENTS >= 2 && (SEGMENTS & (SEGMENTS - 1)) == 0,
+                  "SEGMENTS deve ser potência de 2");
+    
+    // Valores pequenos e triviais são trocados no próprio nó (store
+    // atômico); os demais exigem um nó novo por atualização.
+    static constexpr bool ATOMIC_VALUE =
+        std::is_trivially_copyable<V>::value && alignof(V) == sizeof(V) &&
+        (sizeof(V) == 1 || sizeof(V) == 2 || sizeof(V) == 4 || sizeof(V) == 8);
+    
+    // Aposentados acumulados antes de tentar avançar a época e liberar
+    static constexpr size_t RECLAIM_BATCH = 64;
+    
+    struct Node {
+        const K key;
+        V value;
+        const uint32_t hash;
+        std::atomic<Node*> next;
+        
+        Node(const K& k, const V& v, uint32_t h, Node* n)
+            : key(k), value(v), hash(h), next(n) {}
+    };
+    
+    struct Table {
+        int capacity;
+        std::unique_ptr<std::atomic<Node*>[]> buckets;
+        
+        explicit Table(int cap) : capacity(cap), buckets(new std::atomic<Node*>[cap]) {
+            for (int i = 0; i < cap; i++) buckets[i].store(nullptr, std::memory_order_relaxed);
+        }
+    };
+    
+    template<typename T>
+    struct Retired {
+        uint64_t epoch;
+        T* ptr;
+    };
+    
+    struct alignas(64) Segment {
+        std::mutex lock;
+        std::atomic<Table*> table{nullptr};
+        std::atomic<int> count{0};
+        int threshold = 0;
+        // Desligados mas talvez ainda vistos por leitores (sob lock)
+        std::vector<Retired<Node>> retiredNodes;
+        std::vector<Retired<Table>> retiredTables;
+        size_t reclaimAt = RECLAIM_BATCH;
+    };
+    
+    Segment segments[SEGMENTS];
+    float loadFactor;
+    
+    static constexpr int segmentShift() {
+        int bits = 0;
+        while ((1 << bits) < SEGMENTS) bits++;
+        return 32 - bits;
+    }
+    
+    static uint32_t hash(const K& key) {
+        // std::hash de inteiros é a identidade: espalha para os bits altos
+        uint32_t h = static_cast<uint32_t>(std::hash<K>{}(key));
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35u;
+        h ^= h >> 16;
+        return h;
+    }
+    
+    Segment& segmentFor(uint32_t h) { return segments[h >> segmentShift()]; }
+    const Segment& segmentFor(uint32_t h) const { return segments[h >> segmentShift()]; }
+    
+    static V loadValue(const Node* node) {
+        if constexpr (ATOMIC_VALUE) {
+            V out;
+            __atomic_load(const_cast<V*>(&node->value), &out, __ATOMIC_ACQUIRE);
+            return out;
+        } else {
+            return node->value;
+        }
+    }
+    
+    // Só dentro de um Guard: o nó devolvido vale até o Guard acabar
+    Node* find(const Segment& seg, const K& key, uint32_t h) const {
+        Table* table = seg.table.load(std::memory_order_acquire);
+        Node* node = table->buckets[h & (table->capacity - 1)].load(std::memory_order_acquire);
+        while (node) {
+            if (node->hash == h && node->key == key) return node;
+            node = node->next.load(std::memory_order_acquire);
+        }
+        return nullptr;
+    }
+    
+    // Chamados com seg.lock, depois do store que desligou o nó/tabela
+    void retire(Segment& seg, Node* node) {
+        seg.retiredNodes.push_back({EpochReclaimer::retireEpoch(), node});
+        maybeReclaim(seg);
+    }
+    
+    void retire(Segment& seg, Table* table) {
+        seg.retiredTables.push_back({EpochReclaimer::retireEpoch(), table});
+        maybeReclaim(seg);
+    }
+    
+    void maybeReclaim(Segment& seg) {
+        if (seg.retiredNodes.size() + seg.retiredTables.size() < seg.reclaimAt) return;
+        EpochReclaimer::tryAdvance();
+        reclaim(seg.retiredNodes);
+        reclaim(seg.retiredTables);
+        // Leitor demorado segura tudo: espaça as tentativas em vez de
+        // repetir a varredura a cada aposentadoria
+        seg.reclaimAt = std::max(RECLAIM_BATCH, 2 * (seg.retiredNodes.size() + seg.retiredTables.size()));
+    }
+    
+    template<typename T>
+    static void reclaim(std::vector<Retired<T>>& retired) {
+        // Em ordem de época: para no primeiro que ainda pode ser visto
+        size_t freed = 0;
+        while (freed < retired.size() && EpochReclaimer::reclaimable(retired[freed].epoch)) {
+            delete retired[freed].ptr;
+            freed++;
+        }
+        retired.erase(retired.begin(), retired.begin() + freed);
+    }
+    
+    // Chamado com seg.lock: copia as cadeias para uma tabela nova e só
+    // então a publica; leitores na tabela antiga seguem vendo-a inteira.
+    void resize(Segment& seg) {
+        Table* old = seg.table.load(std::memory_order_relaxed);
+        Table* grown = new Table(old->capacity * 2);
+        for (int i = 0; i < old->capacity; i++) {
+            Node* node = old->buckets[i].load(std::memory_order_relaxed);
+            while (node) {
+                auto& bucket = grown->buckets[node->hash & (grown->capacity - 1)];
+                bucket.store(new Node(node->key, node->value, node->hash,
+                                      bucket.load(std::memory_order_relaxed)),
+                             std::memory_order_relaxed);
+                node = node->next.load(std::memory_order_relaxed);
+            }
+        }
+        seg.table.store(grown, std::memory_order_release);
+        seg.threshold = static_cast<int>(grown->capacity * loadFactor);
+        
+        const uint64_t epoch = EpochReclaimer::retireEpoch();
+        for (int i = 0; i < old->capacity; i++) {
+            for (Node* node = old->buckets[i].load(std::memory_order_relaxed); node;
+                 node = node->next.load(std::memory_order_relaxed)) {
+                seg.retiredNodes.push_back({epoch, node});
+            }
+        }
+        retire(seg, old);
+    }
+    
+    // Chamado com seg.lock
+    V insert(Segment& seg, const K& key, const V& value, uint32_t h, bool onlyIfAbsent) {
+        Table* table = seg.table.load(std::memory_order_relaxed);
+        std::atomic<Node*>* link = &table->buckets[h & (table->capacity - 1)];
+        for (Node* node = link->load(std::memory_order_relaxed); node;
+             link = &node->next, node = link->load(std::memory_order_relaxed)) {
+            if (node->hash != h || !(node->key == key)) continue;
+            V oldValue = node->value;
+            if (onlyIfAbsent) return oldValue;
+            if constexpr (ATOMIC_VALUE) {
+                __atomic_store(&node->value, const_cast<V*>(&value), __ATOMIC_RELEASE);
+            } else {
+                Node* replacement = new Node(key, value, h, node->next.load(std::memory_order_relaxed));
+                link->store(replacement, std::memory_order_release);
+                retire(seg, node);
+            }
+            return oldValue;
+        }
+        
+        if (seg.count.load(std::memory_order_relaxed) >= seg.threshold) {
+            resize(seg);
+            table = seg.table.load(std::memory_order_relaxed);
+        }
+        auto& bucket = table->buckets[h & (table->capacity - 1)];
+        bucket.store(new Node(key, value, h, bucket.load(std::memory_order_relaxed)),
+                     std::memory_order_release);
+        seg.count.fetch_add(1, std::memory_order_relaxed);
+        return V();
+    }
+    
+public:
+    explicit ConcurrentHashMap(int initialCapacity = 16, float lf = 0.75f)
+        : loadFactor(lf) {
+        int perSegment = 2;
+        while (perSegment * SEGMENTS < initialCapacity) perSegment <<= 1;
+        for (auto& seg : segments) {
+            seg.table.store(new Table(perSegment), std::memory_order_relaxed);
+            seg.threshold = static_cast<int>(perSegment * loadFactor);
+        }
+    }
+    
+    // Sem leitores nem escritores em andamento: libera tudo direto
+    ~ConcurrentHashMap() {
+        for (auto& seg : segments) {
+            Table* table = seg.table.load(std::memory_order_relaxed);
+            for (int i = 0; i < table->capacity; i++) {
+                Node* node = table->buckets[i].load(std::memory_order_relaxed);
+                while (node) {
+                    Node* next = node->next.load(std::memory_order_relaxed);
+                    delete node;
+                    node = next;
+                }
+            }
+            delete table;
+            for (auto& r : seg.retiredNodes) delete r.ptr;
+            for (auto& r : seg.retiredTables) delete r.ptr;
+        }
+    }
+    
+    ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+    ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+    
+    int size() const {
+        int total = 0;
+        for (auto& seg : segments) total += seg.count.load(std::memory_order_relaxed);
+        return total;
+    }
+    
+    bool isEmpty() const { return size() == 0; }
+    
+    // Nós e tabelas aposentados ainda não liberados (diagnóstico)
+    size_t retiredCount() {
+        size_t total = 0;
+        for (auto& seg : segments) {
+            std::lock_guard<std::mutex> lock(seg.lock);
+            total += seg.retiredNodes.size() + seg.retiredTables.size();
+        }
+        return total;
+    }
+    
+    bool containsKey(const K& key) const {
+        EpochReclaimer::Guard guard;
+        uint32_t h = hash(key);
+        return find(segmentFor(h), key, h) != nullptr;
+    }
+    
+    bool containsValue(const V& value) const {
+        bool found = false;
+        const_cast<ConcurrentHashMap*>(this)->forEachNode([&](const Node* node) {
+            if (!found && loadValue(node) == value) found = true;
+        });
+        return found;
+    }
+    
+    // Cópia do valor em out; false se a chave não existe
+    bool get(const K& key, V& out) const {
+        EpochReclaimer::Guard guard;
+        uint32_t h = hash(key);
+        Node* node = find(segmentFor(h), key, h);
+        if (!node) return false;
+        out = loadValue(node);
+        return true;
+    }
+    
+    V getOrDefault(const K& key, const V& defaultValue) const {
+        EpochReclaimer::Guard guard;
+        uint32_t h = hash(key);
+        Node* node = find(segmentFor(h), key, h);
+        return node ? loadValue(node) : defaultValue;
+    }
+    
+    V put(const K& key, const V& value) {
+        uint32_t h = hash(key);
+        Segment& seg = segmentFor(h);
+        std::lock_guard<std::mutex> lock(seg.lock);
+        return insert(seg, key, value, h, false);
+    }
+    
+    // Devolve o valor atual se a chave já existia (V() caso contrário)
+    V putIfAbsent(const K& key, const V& value) {
+        uint32_t h = hash(key);
+        Segment& seg = segmentFor(h);
+        std::lock_guard<std::mutex> lock(seg.lock);
+        return insert(seg, key, value, h, true);
+    }
+    
+    V remove(const K& key) {
+        uint32_t h = hash(key);
+        Segment& seg = segmentFor(h);
+        std::lock_guard<std::mutex> lock(seg.lock);
+        
+        Table* table = seg.table.load(std::memory_order_relaxed);
+        std::atomic<Node*>* link = &table->buckets[h & (table->capacity - 1)];
+        for (Node* node = link->load(std::memory_order_relaxed); node;
+             link = &node->next, node = link->load(std::memory_order_relaxed)) {
+            if (node->hash != h || !(node->key == key)) continue;
+            // Leitores parados no nó seguem por node->next, que fica intacto
+            link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+            seg.count.fetch_sub(1, std::memory_order_relaxed);
+            V oldValue = node->value;
+            retire(seg, node);
+            return oldValue;
+        }
+        return V();
+    }
+    
+    // Desliga as cadeias e as aposenta: seguro com leitores em andamento
+    void clear() {
+        for (auto& seg : segments) {
+            std::lock_guard<std::mutex> lock(seg.lock);
+            Table* table = seg.table.load(std::memory_order_relaxed);
+            std::vector<Node*> unlinked;
+            for (int i = 0; i < table->capacity; i++) {
+                Node* node = table->buckets[i].exchange(nullptr, std::memory_order_acq_rel);
+                for (; node; node = node->next.load(std::memory_order_relaxed)) unlinked.push_back(node);
+            }
+            const uint64_t epoch = EpochReclaimer::retireEpoch();
+            for (Node* node : unlinked) seg.retiredNodes.push_back({epoch, node});
+            seg.count.store(0, std::memory_order_relaxed);
+            maybeReclaim(seg);
+        }
+    }
+    
+    // Views: cópias fracamente consistentes (como as de HashMap)
+    Set<K>* keySet() {
+        auto* keys = new HashSet<K>();
+        forEachNode([keys](const Node* node) { keys->add(node->key); });
+        return keys;
+    }
+    
+    Collection<V>* values() {
+        auto* vals = new ArrayList<V>();
+        forEachNode([vals](const Node* node) { vals->add(loadValue(node)); });
+        return vals;
+    }
+    
+    // Iteration helper: sem lock, vê cada chave presente do início ao fim
+    // (cópias do valor: o nó pode ser liberado depois da iteração)
+    void forEach(std::function<void(const K&, const V&)> action) {
+        forEachNode([&action](Node* node) { action(node->key, loadValue(node)); });
+    }
+    
+private:
+    template<typename F>
+    void forEachNode(F&& visit) {
+        EpochReclaimer::Guard guard;
+        for (auto& seg : segments) {
+            Table* table = seg.table.load(std::memory_order_acquire);
+            for (int i = 0; i < table->capacity; i++) {
+                Node* node = table->buckets[i].load(std::memory_order_acquire);
+                while (node) {
+                    visit(node);
+                    node = node->next.load(std::memory_order_acquire);
+                }
             }
         }
     }
@@ -821,19 +1368,16 @@ public:
     int size() const override { return map.size(); }
     
     bool contains(const T& element) const override {
-        return const_cast<HashMap<T, bool>&>(map).containsKey(element);
+        return map.containsKey(element);
     }
     
+    // put/remove devolvem o valor anterior (false se ausente): uma sondagem só
     bool add(const T& element) override {
-        if (contains(element)) return false;
-        map.put(element, true);
-        return true;
+        return !map.put(element, true);
     }
     
     bool remove(const T& element) override {
-        if (!contains(element)) return false;
-        map.remove(element);
-        return true;
+        return map.remove(element);
     }
     
     void clear() override {
@@ -846,9 +1390,9 @@ public:
         delete keys;
     }
     
-    Iterator<T> iterator() override {
+    std::unique_ptr<Iterator<T>> iterator() override {
         // TODO: Implementar SetIterator
-        return ArrayIterator<T>(nullptr, 0);
+        return std::make_unique<ArrayIterator<T>>(nullptr, 0);
     }
 };
 
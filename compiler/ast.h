@@ -26,6 +26,52 @@ typedef std::shared_ptr<ASTNode> ASTNodePtr;
 typedef std::shared_ptr<Expression> ExprPtr;
 typedef std::shared_ptr<Statement> StmtPtr;
 
+// ============================================================
+// ARENA DA AST
+// ============================================================
+// O Parser aloca todos os nós (e seus blocos de controle) por bump em
+// blocos grandes; liberar um nó não devolve nada e a memória sai de uma
+// vez quando o último nó morre (cada nó segura a arena pelo alocador).
+class AstArena {
+public:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    // align <= alignof(max_align_t): blocos novos já começam alinhados
+    void* allocate(size_t bytes, size_t align) {
+        size_t offset = (used + align - 1) & ~(align - 1);
+        if (blocks.empty() || offset + bytes > capacity) {
+            capacity = bytes > BLOCK_SIZE ? bytes : BLOCK_SIZE;
+            blocks.emplace_back(new unsigned char[capacity]);
+            offset = 0;
+        }
+        used = offset + bytes;
+        return blocks.back().get() + offset;
+    }
+
+private:
+    std::vector<std::unique_ptr<unsigned char[]>> blocks;
+    size_t used = 0;
+    size_t capacity = 0;
+};
+
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+    std::shared_ptr<AstArena> arena;
+
+    explicit ArenaAllocator(std::shared_ptr<AstArena> a) : arena(std::move(a)) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& o) const { return arena == o.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& o) const { return arena != o.arena; }
+};
+
 // ============================================================
 // TIPOS DE NÓS DA AST
 // ============================================================
@@ -421,7 +467,7 @@ public:
 struct ParameterDecl {
     std::vector<AnnotationPtr> annotations;
     Modifiers modifiers;
-    TypeRefPtr type;
+    TypeRefPtr type;  // null em fn f(x, y)
     std::string name;
     bool isVarArgs = false;
 };
@@ -469,10 +515,12 @@ public:
             Collect, Count, Sum, Min, Max,
             Distinct, Sorted, Limit, Skip,
             AnyMatch, AllMatch, NoneMatch,
-            FindFirst, FindAny, ToList, ToArray
+            FindFirst, FindAny, ToList, ToArray,
+            Parallel
         };
         Kind kind;
         ExprPtr argument;  // Lambda ou valor
+        ExprPtr identity;  // reduce(identidade, op)
     };
     
     std::vector<StreamOp> operations;
@@ -931,6 +979,9 @@ public:
     std::vector<std::shared_ptr<InterfaceDecl>> interfaces;
     std::vector<std::shared_ptr<EnumDecl>> enums;
     
+    // Funções de nível superior (fn nome(params) { ... })
+    std::vector<std::shared_ptr<MethodDecl>> functions;
+    
     // Statements de nível superior (para scripts simples)
     std::vector<StmtPtr> statements;
     
@@ -9,18 +9,25 @@
 #include "codegen.h"
 #include "../vm/bytecode.h"
 #include <iostream>
+#include <cstring>
 
 namespace Kava {
 
 std::vector<int32_t> Codegen::generate(const Program& program) {
     bytecode.clear();
+    lines.clear();
     variables.clear();
     nextVarIdx = 0;
     
-    // Gera código para classes
-    for (auto& cls : program.classes) {
-        // TODO: Implementar geração de código para classes
-    }
+    // Índices de funções e classes antes de tudo: chamadas podem vir antes
+    // da declaração
+    declareProgram(program);
+    
+    // Objetos que não escapam do nível superior viram globais por campo
+    scalarObjects.clear();
+    scalarDecls.clear();
+    scalarReplaced = 0;
+    planScalarReplacement(program.statements, &program);
     
     // Gera código para statements de nível superior
     for (auto& stmt : program.statements) {
@@ -28,20 +35,787 @@ std::vector<int32_t> Codegen::generate(const Program& program) {
     }
     
     emit(OP_HALT);
-    return bytecode;
+    
+    // Corpos depois do HALT: todo global do nível superior já tem slot
+    for (auto& fn : functions) {
+        generateBody(fn, fn.method->parameters, fn.method->body);
+    }
+    for (auto& cls : classes) {
+        for (auto& m : cls.methods) {
+            if (m.method) {
+                generateBody(m, m.method->parameters, m.method->body);
+            } else if (m.ctor) {
+                generateBody(m, m.ctor->parameters, m.ctor->body);
+            } else {
+                generateBody(m, {}, nullptr);
+            }
+        }
+    }
+    
+    if (functions.empty() && classes.empty() && stringConstants.empty()) return bytecode;
+    return withMetadata();
+}
+
+// ============================================================
+// FUNÇÕES E CLASSES
+// ============================================================
+int Codegen::symbol(const std::string& name) {
+    auto it = symbols.find(name);
+    if (it != symbols.end()) return it->second;
+    int idx = static_cast<int>(symbolNames.size());
+    symbolNames.push_back(name);
+    symbols[name] = idx;
+    return idx;
+}
+
+void Codegen::declareProgram(const Program& program) {
+    auto declareFunction = [&](const std::string& name, const MethodDecl& decl) {
+        FunctionMeta fn;
+        fn.name = symbol(name);
+        fn.params = static_cast<int>(decl.parameters.size());
+        fn.method = &decl;
+        functionIndex[name] = static_cast<int>(functions.size());
+        functions.push_back(fn);
+    };
+    for (auto& fn : program.functions) {
+        declareFunction(fn->name, *fn);
+    }
+    
+    for (auto& cls : program.classes) {
+        classIndex[cls->name] = static_cast<int>(classes.size());
+        symbol(cls->name);
+        ClassMeta meta;
+        meta.decl = cls.get();
+        classes.push_back(meta);
+    }
+    
+    for (size_t i = 0; i < classes.size(); i++) {
+        ClassMeta& meta = classes[i];
+        const ClassDecl& cls = *meta.decl;
+        if (cls.superClass && classIndex.count(cls.superClass->name)) {
+            meta.super = classIndex[cls.superClass->name];
+        }
+        for (auto& field : cls.fields) {
+            if (field->modifiers.isStatic) continue;
+            meta.fields.push_back({symbol(field->name), fieldType(*field)});
+        }
+        
+        // Sem construtor declarado ainda há um: encadeia o super() e roda os
+        // inicializadores de campo
+        auto addMethod = [&](const std::string& name, int params) -> FunctionMeta& {
+            FunctionMeta m;
+            m.name = symbol(name);
+            m.params = params;
+            m.owner = static_cast<int>(i);
+            meta.methods.push_back(m);
+            return meta.methods.back();
+        };
+        for (auto& ctor : cls.constructors) {
+            addMethod(KAVA_CONSTRUCTOR_NAME, static_cast<int>(ctor->parameters.size())).ctor = ctor.get();
+        }
+        if (cls.constructors.empty()) addMethod(KAVA_CONSTRUCTOR_NAME, 0);
+        for (auto& method : cls.methods) {
+            if (!method->body) continue;
+            if (method->modifiers.isStatic) {
+                declareFunction(cls.name + "." + method->name, *method);
+                continue;
+            }
+            addMethod(method->name, static_cast<int>(method->parameters.size())).method = method.get();
+        }
+    }
+}
+
+void Codegen::generateBody(FunctionMeta& fn, const std::vector<ParameterDecl>& params,
+                           const std::shared_ptr<BlockStmt>& body) {
+    inFunction = true;
+    currentClass = fn.owner;
+    locals.clear();
+    nextLocalIdx = currentClass >= 0 ? 1 : 0;
+    stringLocals.clear();
+    for (auto& param : params) {
+        locals[param.name] = nextLocalIdx++;
+        if (param.type && param.type->name == "String" && param.type->arrayDimensions == 0) stringLocals.insert(param.name);
+    }
+    scalarLocals.clear();
+    if (body) planScalarReplacement(body->statements, nullptr);
+    
+    fn.codeOffset = currentAddress();
+    size_t first = 0;
+    if (fn.owner >= 0 && !fn.method) {
+        generateConstructorPrologue(fn);
+        if (fn.ctor && fn.ctor->hasExplicitConstructorCall) first = 1;
+    }
+    if (body) {
+        for (size_t i = first; i < body->statements.size(); i++) {
+            visitStatement(body->statements[i]);
+        }
+    }
+    emit(OP_RET);  // Queda do fim: devolve null
+    fn.locals = nextLocalIdx;
+    
+    inFunction = false;
+    currentClass = -1;
+    locals.clear();
+    scalarLocals.clear();
+    stringLocals.clear();
+}
+
+// super(...) ou this(...) explícito, senão super() implícito; depois os
+// inicializadores de campo (pulados quando this(...) já os rodou)
+void Codegen::generateConstructorPrologue(const FunctionMeta& fn) {
+    const ClassMeta& cls = classes[fn.owner];
+    const bool explicitCall = fn.ctor && fn.ctor->hasExplicitConstructorCall;
+    const bool callsThis = explicitCall && fn.ctor->callsThis;
+    if (explicitCall) {
+        emitInvokeSpecial(callsThis ? fn.owner : cls.super, KAVA_CONSTRUCTOR_NAME, fn.ctor->constructorArgs);
+        emit(OP_POP);
+    } else if (cls.super >= 0) {
+        emitInvokeSpecial(cls.super, KAVA_CONSTRUCTOR_NAME, {});
+        emit(OP_POP);
+    }
+    if (callsThis) return;
+    for (auto& field : cls.decl->fields) {
+        if (field->modifiers.isStatic || !field->initializer) continue;
+        emit(OP_LOAD_LOCAL);
+        emit(0);
+        visitExpression(field->initializer);
+        emit(OP_PUTFIELD);
+        emit(symbol(field->name));
+        emit(newCache());
+    }
+}
+
+// Elemento de classe (ou String/Object) vira array de referências; sem tipo
+// ou primitivo continua NEWARRAY
+void Codegen::emitNewArray(const TypeRefPtr& elementType) {
+    if (elementType && !primitiveType(elementType->name)) {
+        auto it = classIndex.find(elementType->name);
+        emit(OP_ANEWARRAY);
+        emit(it != classIndex.end() ? it->second : -1);
+        return;
+    }
+    emit(OP_NEWARRAY);
+    emit(arrayElementType(elementType));
+}
+
+// this; argumentos; INVOKESPEC class symbol argc cache (ligação estática)
+void Codegen::emitInvokeSpecial(int cls, const std::string& name, const std::vector<ExprPtr>& args) {
+    emit(OP_LOAD_LOCAL);
+    emit(0);
+    for (auto& arg : args) {
+        visitExpression(arg);
+    }
+    emit(OP_INVOKESPEC);
+    emit(cls);
+    emit(symbol(name));
+    emit(static_cast<int32_t>(args.size()));
+    emit(newCache());
+}
+
+std::vector<int32_t> Codegen::withMetadata() const {
+    std::vector<int32_t> meta;
+    meta.push_back(static_cast<int32_t>(symbolNames.size()));
+    for (const auto& name : symbolNames) {
+        meta.push_back(static_cast<int32_t>(name.size()));
+        std::vector<int32_t> words((name.size() + 3) / 4, 0);
+        std::memcpy(words.data(), name.data(), name.size());
+        meta.insert(meta.end(), words.begin(), words.end());
+    }
+    meta.push_back(static_cast<int32_t>(functions.size()));
+    for (const auto& fn : functions) {
+        meta.insert(meta.end(), {fn.name, fn.params | asyncFlag(fn), fn.locals, fn.codeOffset});
+    }
+    meta.push_back(static_cast<int32_t>(classes.size()));
+    for (const auto& cls : classes) {
+        meta.push_back(symbols.at(cls.decl->name));
+        meta.push_back(cls.super);
+        meta.push_back(static_cast<int32_t>(cls.fields.size()));
+        for (const auto& field : cls.fields) {
+            meta.insert(meta.end(), {field.first, field.second});
+        }
+        meta.push_back(static_cast<int32_t>(cls.methods.size()));
+        for (const auto& m : cls.methods) {
+            meta.insert(meta.end(), {m.name, m.params | asyncFlag(m), m.locals, m.codeOffset});
+        }
+    }
+    meta.push_back(nextCacheIdx);
+    meta.push_back(static_cast<int32_t>(stringConstants.size()));
+    meta.insert(meta.end(), stringConstants.begin(), stringConstants.end());
+    
+    std::vector<int32_t> out = {static_cast<int32_t>(KAVA_BYTECODE_MAGIC), static_cast<int32_t>(meta.size())};
+    out.insert(out.end(), meta.begin(), meta.end());
+    out.insert(out.end(), bytecode.begin(), bytecode.end());
+    return out;
+}
+
+// Campo de instância da classe atual ou de uma superclasse
+bool Codegen::isField(const std::string& name) const {
+    auto sym = symbols.find(name);
+    if (currentClass < 0 || sym == symbols.end()) return false;
+    for (int c = currentClass, depth = 0; c >= 0 && depth <= static_cast<int>(classes.size()); c = classes[c].super, depth++) {
+        for (const auto& field : classes[c].fields) {
+            if (field.first == sym->second) return true;
+        }
+    }
+    return false;
+}
+
+bool Codegen::isStringExpr(const ExprPtr& expr) const {
+    if (!expr) return false;
+    switch (expr->getType()) {
+        case NodeType::Literal:
+            return static_cast<const LiteralExpr&>(*expr).litType == LiteralExpr::LitType::String;
+        case NodeType::Identifier: {
+            const std::string& name = static_cast<const IdentifierExpr&>(*expr).name;
+            if (inFunction && locals.count(name)) return stringLocals.count(name) > 0;
+            return stringGlobals.count(name) > 0;
+        }
+        case NodeType::BinaryExpr: {
+            auto& bin = static_cast<const BinaryExpr&>(*expr);
+            return bin.op == BinaryExpr::Op::Add && (isStringExpr(bin.left) || isStringExpr(bin.right));
+        }
+        case NodeType::AssignExpr: return isStringExpr(static_cast<const AssignExpr&>(*expr).value);
+        case NodeType::CompoundAssignExpr: {
+            auto& a = static_cast<const CompoundAssignExpr&>(*expr);
+            return a.op == BinaryExpr::Op::Add && (isStringExpr(a.target) || isStringExpr(a.value));
+        }
+        case NodeType::TernaryExpr: {
+            auto& t = static_cast<const TernaryExpr&>(*expr);
+            return isStringExpr(t.thenExpr) && isStringExpr(t.elseExpr);
+        }
+        case NodeType::MethodCallExpr: {
+            auto& call = static_cast<const MethodCallExpr&>(*expr);
+            return call.methodName == "toString" && call.arguments.empty();
+        }
+        default:
+            return false;
+    }
+}
+
+// Só acrescenta: um nome que já foi String continua concatenando
+void Codegen::noteStringName(const std::string& name, bool isString) {
+    if (!isString) return;
+    if (inFunction && locals.count(name)) stringLocals.insert(name);
+    else stringGlobals.insert(name);
+}
+
+bool Codegen::hasMethod(int cls, const std::string& name) const {
+    auto sym = symbols.find(name);
+    if (sym == symbols.end()) return false;
+    for (int c = cls, depth = 0; c >= 0 && depth <= static_cast<int>(classes.size()); c = classes[c].super, depth++) {
+        for (const auto& m : classes[c].methods) {
+            if (m.name == sym->second && m.method) return true;
+        }
+    }
+    return false;
+}
+
+// Nome -> local do frame, campo do this ou global (nessa ordem)
+bool Codegen::emitLoadName(const std::string& name) {
+    auto local = locals.find(name);
+    if (inFunction && local != locals.end()) {
+        emit(OP_LOAD_LOCAL);
+        emit(local->second);
+        return true;
+    }
+    if (isField(name)) {
+        emit(OP_LOAD_LOCAL);
+        emit(0);
+        emit(OP_GETFIELD);
+        emit(symbol(name));
+        emit(newCache());
+        return true;
+    }
+    auto global = variables.find(name);
+    if (global != variables.end()) {
+        emit(OP_LOAD_GLOBAL);
+        emit(global->second);
+        return true;
+    }
+    return false;
+}
+
+// Grava (consumindo) o topo da pilha no nome
+bool Codegen::emitStoreName(const std::string& name) {
+    auto local = locals.find(name);
+    if (inFunction && local != locals.end()) {
+        emit(OP_STORE_LOCAL);
+        emit(local->second);
+        return true;
+    }
+    if (isField(name)) {
+        emit(OP_LOAD_LOCAL);
+        emit(0);
+        emit(OP_SWAP);
+        emit(OP_PUTFIELD);
+        emit(symbol(name));
+        emit(newCache());
+        return true;
+    }
+    auto global = variables.find(name);
+    if (global != variables.end()) {
+        emit(OP_STORE_GLOBAL);
+        emit(global->second);
+        return true;
+    }
+    return false;
+}
+
+// ============================================================
+// ANÁLISE DE ESCAPE
+// ============================================================
+namespace {
+
+// Varre o escopo atrás de usos de `name`: só p.campo (campo de `fields`)
+// mantém o objeto local. Qualquer outro uso, outra declaração do mesmo nome,
+// lambda que o mencione ou nó que a varredura não conhece conta como escape.
+struct EscapeScan {
+    const std::string& name;
+    const std::set<std::string>& fields;
+    const VarDeclStmt* decl;
+    bool local = true;
+    
+    void exprs(const std::vector<ExprPtr>& list) {
+        for (auto& e : list) expr(e);
+    }
+    
+    void stmts(const std::vector<StmtPtr>& list) {
+        for (auto& s : list) stmt(s);
+    }
+    
+    void expr(const ExprPtr& e) {
+        if (!e || !local) return;
+        switch (e->getType()) {
+            case NodeType::Literal: case NodeType::ThisExpr: case NodeType::SuperExpr:
+                break;
+            case NodeType::Identifier:
+                if (static_cast<const IdentifierExpr&>(*e).name == name) local = false;
+                break;
+            case NodeType::MemberExpr: {
+                auto& m = static_cast<const MemberExpr&>(*e);
+                if (m.object && m.object->getType() == NodeType::Identifier &&
+                    static_cast<const IdentifierExpr&>(*m.object).name == name) {
+                    if (!fields.count(m.memberName)) local = false;
+                } else {
+                    expr(m.object);
+                }
+                break;
+            }
+            case NodeType::BinaryExpr: {
+                auto& b = static_cast<const BinaryExpr&>(*e);
+                expr(b.left);
+                expr(b.right);
+                break;
+            }
+            case NodeType::UnaryExpr: expr(static_cast<const UnaryExpr&>(*e).operand); break;
+            case NodeType::TernaryExpr: {
+                auto& t = static_cast<const TernaryExpr&>(*e);
+                expr(t.condition);
+                expr(t.thenExpr);
+                expr(t.elseExpr);
+                break;
+            }
+            case NodeType::AssignExpr: {
+                auto& a = static_cast<const AssignExpr&>(*e);
+                expr(a.target);
+                expr(a.value);
+                break;
+            }
+            case NodeType::CompoundAssignExpr: {
+                auto& a = static_cast<const CompoundAssignExpr&>(*e);
+                expr(a.target);
+                expr(a.value);
+                break;
+            }
+            case NodeType::MethodCallExpr: {
+                auto& c = static_cast<const MethodCallExpr&>(*e);
+                expr(c.object);
+                exprs(c.arguments);
+                break;
+            }
+            case NodeType::NewExpr: {
+                auto& n = static_cast<const NewExpr&>(*e);
+                if (!n.anonymousClassBody.empty()) local = false;
+                exprs(n.arguments);
+                break;
+            }
+            case NodeType::NewArrayExpr: {
+                auto& n = static_cast<const NewArrayExpr&>(*e);
+                exprs(n.dimensions);
+                exprs(n.initializer);
+                break;
+            }
+            case NodeType::ArrayAccessExpr: {
+                auto& a = static_cast<const ArrayAccessExpr&>(*e);
+                expr(a.array);
+                expr(a.index);
+                break;
+            }
+            case NodeType::CastExpr: expr(static_cast<const CastExpr&>(*e).operand); break;
+            case NodeType::InstanceOfExpr: expr(static_cast<const InstanceOfExpr&>(*e).operand); break;
+            case NodeType::AwaitExpr: expr(static_cast<const AwaitExpr&>(*e).operand); break;
+            case NodeType::PipeExpr: {
+                auto& p = static_cast<const PipeExpr&>(*e);
+                expr(p.left);
+                expr(p.right);
+                break;
+            }
+            case NodeType::StreamExpr: {
+                auto& s = static_cast<const StreamExpr&>(*e);
+                expr(s.source);
+                for (auto& op : s.operations) {
+                    expr(op.argument);
+                    expr(op.identity);
+                }
+                break;
+            }
+            case NodeType::LambdaExpr: {
+                // O corpo pode rodar depois do escopo: nem p.campo é seguro
+                auto& l = static_cast<const LambdaExpr&>(*e);
+                std::set<std::string> none;
+                EscapeScan inner{name, none, nullptr};
+                for (auto& param : l.parameters) {
+                    if (param.name == name) inner.local = false;
+                }
+                inner.expr(l.bodyExpr);
+                inner.stmt(l.bodyBlock);
+                local = inner.local;
+                break;
+            }
+            default:
+                local = false;
+                break;
+        }
+    }
+    
+    void stmt(const StmtPtr& s) {
+        if (!s || !local) return;
+        switch (s->getType()) {
+            case NodeType::VarDecl: {
+                auto& v = static_cast<const VarDeclStmt&>(*s);
+                if (&v != decl && v.name == name) local = false;
+                expr(v.initializer);
+                break;
+            }
+            case NodeType::PrintStmt: expr(static_cast<const PrintStmt&>(*s).expression); break;
+            case NodeType::ExprStmt: expr(static_cast<const ExprStmt&>(*s).expression); break;
+            case NodeType::ReturnStmt: expr(static_cast<const ReturnStmt&>(*s).value); break;
+            case NodeType::ThrowStmt: expr(static_cast<const ThrowStmt&>(*s).exception); break;
+            case NodeType::YieldStmt: expr(static_cast<const YieldStmt&>(*s).value); break;
+            case NodeType::AssertStmt: {
+                auto& a = static_cast<const AssertStmt&>(*s);
+                expr(a.condition);
+                expr(a.message);
+                break;
+            }
+            case NodeType::IfStmt: {
+                auto& i = static_cast<const IfStmt&>(*s);
+                expr(i.condition);
+                stmt(i.thenBranch);
+                stmt(i.elseBranch);
+                break;
+            }
+            case NodeType::WhileStmt: {
+                auto& w = static_cast<const WhileStmt&>(*s);
+                expr(w.condition);
+                stmt(w.body);
+                break;
+            }
+            case NodeType::DoWhileStmt: {
+                auto& d = static_cast<const DoWhileStmt&>(*s);
+                stmt(d.body);
+                expr(d.condition);
+                break;
+            }
+            case NodeType::ForStmt: {
+                auto& f = static_cast<const ForStmt&>(*s);
+                stmts(f.init);
+                expr(f.condition);
+                exprs(f.update);
+                stmt(f.body);
+                break;
+            }
+            case NodeType::Block: stmts(static_cast<const BlockStmt&>(*s).statements); break;
+            case NodeType::TryStmt: {
+                auto& t = static_cast<const TryStmt&>(*s);
+                stmt(t.tryBlock);
+                for (auto& c : t.catchClauses) stmt(c->body);
+                stmt(t.finallyBlock);
+                break;
+            }
+            case NodeType::SynchronizedStmt: {
+                auto& y = static_cast<const SynchronizedStmt&>(*s);
+                expr(y.lockObject);
+                stmt(y.body);
+                break;
+            }
+            case NodeType::BreakStmt: case NodeType::ContinueStmt:
+                break;
+            default:
+                local = false;
+                break;
+        }
+    }
+};
+
+// Declarações candidatas do escopo (blocos e laços inclusos; lambdas não)
+void collectDecls(const StmtPtr& s, std::vector<const VarDeclStmt*>& out) {
+    if (!s) return;
+    switch (s->getType()) {
+        case NodeType::VarDecl: out.push_back(static_cast<const VarDeclStmt*>(s.get())); break;
+        case NodeType::Block:
+            for (auto& child : static_cast<const BlockStmt&>(*s).statements) collectDecls(child, out);
+            break;
+        case NodeType::IfStmt:
+            collectDecls(static_cast<const IfStmt&>(*s).thenBranch, out);
+            collectDecls(static_cast<const IfStmt&>(*s).elseBranch, out);
+            break;
+        case NodeType::WhileStmt: collectDecls(static_cast<const WhileStmt&>(*s).body, out); break;
+        case NodeType::DoWhileStmt: collectDecls(static_cast<const DoWhileStmt&>(*s).body, out); break;
+        case NodeType::ForStmt: {
+            auto& f = static_cast<const ForStmt&>(*s);
+            for (auto& init : f.init) collectDecls(init, out);
+            collectDecls(f.body, out);
+            break;
+        }
+        default: break;
+    }
+}
+
+// Literais e parâmetros combinados por operadores sem efeito colateral
+bool pureExpr(const ExprPtr& e, const std::set<std::string>& params) {
+    if (!e) return false;
+    switch (e->getType()) {
+        case NodeType::Literal: return true;
+        case NodeType::Identifier: return params.count(static_cast<const IdentifierExpr&>(*e).name) > 0;
+        case NodeType::BinaryExpr: {
+            auto& b = static_cast<const BinaryExpr&>(*e);
+            return pureExpr(b.left, params) && pureExpr(b.right, params);
+        }
+        case NodeType::UnaryExpr: {
+            auto& u = static_cast<const UnaryExpr&>(*e);
+            return (u.op == UnaryExpr::Op::Negate || u.op == UnaryExpr::Op::Not || u.op == UnaryExpr::Op::BitNot) &&
+                   pureExpr(u.operand, params);
+        }
+        case NodeType::TernaryExpr: {
+            auto& t = static_cast<const TernaryExpr&>(*e);
+            return pureExpr(t.condition, params) && pureExpr(t.thenExpr, params) && pureExpr(t.elseExpr, params);
+        }
+        default: return false;
+    }
+}
+
+// Campo atribuído por `this.f = v` ou `f = v` no construtor ("" se não for isso)
+std::string constructorStore(const StmtPtr& s, const std::set<std::string>& params) {
+    if (!s || s->getType() != NodeType::ExprStmt) return "";
+    auto& e = static_cast<const ExprStmt&>(*s).expression;
+    if (!e || e->getType() != NodeType::AssignExpr) return "";
+    auto& target = static_cast<const AssignExpr&>(*e).target;
+    if (target->getType() == NodeType::MemberExpr) {
+        auto& m = static_cast<const MemberExpr&>(*target);
+        return m.object && m.object->getType() == NodeType::ThisExpr ? m.memberName : "";
+    }
+    if (target->getType() == NodeType::Identifier) {
+        auto& name = static_cast<const IdentifierExpr&>(*target).name;
+        return params.count(name) ? "" : name;
+    }
+    return "";
+}
+
+} // namespace
+
+int Codegen::stringConstant(const std::string& text) {
+    auto it = stringIndex.find(text);
+    if (it != stringIndex.end()) return it->second;
+    int idx = static_cast<int>(stringConstants.size());
+    stringConstants.push_back(symbol(text));
+    stringIndex[text] = idx;
+    return idx;
+}
+
+// Sem superclasse (o super() precisaria rodar), só campos int ou referência
+// (PUTFIELD converte nos outros tipos, o slot não) e um construtor com a
+// aridade cujo corpo só grava expressões puras dos parâmetros nos campos
+bool Codegen::inlinableConstructor(const ClassMeta& cls, size_t argc, const ConstructorDecl*& ctor) const {
+    const ClassDecl& decl = *cls.decl;
+    if (cls.super >= 0 || !decl.instanceBlocks.empty()) return false;
+    for (const auto& field : cls.fields) {
+        const int32_t t = field.second;
+        if (t == KAVA_T_LONG || t == KAVA_T_FLOAT || t == KAVA_T_DOUBLE) return false;
+    }
+    for (const auto& field : decl.fields) {
+        if (!field->modifiers.isStatic && field->initializer && !pureExpr(field->initializer, {})) return false;
+    }
+    
+    ctor = nullptr;
+    if (decl.constructors.empty()) return argc == 0;
+    int matches = 0;
+    for (const auto& c : decl.constructors) {
+        if (c->parameters.size() == argc) {
+            ctor = c.get();
+            matches++;
+        }
+    }
+    if (matches != 1 || ctor->hasExplicitConstructorCall) return false;
+    if (!ctor->body) return true;
+    
+    std::set<std::string> params;
+    for (const auto& param : ctor->parameters) params.insert(param.name);
+    for (const auto& s : ctor->body->statements) {
+        std::string field = constructorStore(s, params);
+        if (field.empty() || !symbols.count(field)) return false;
+        bool known = false;
+        for (const auto& f : cls.fields) known = known || f.first == symbols.at(field);
+        if (!known) return false;
+        if (!pureExpr(static_cast<const AssignExpr&>(*static_cast<const ExprStmt&>(*s).expression).value, params)) return false;
+    }
+    return true;
+}
+
+// Escolhe as declarações do escopo que viram escalares e reserva os slots.
+// No nível superior (program != null) o nome é global: fn e métodos também
+// precisam respeitar a regra.
+void Codegen::planScalarReplacement(const std::vector<StmtPtr>& scope, const Program* program) {
+    std::vector<const VarDeclStmt*> decls;
+    for (auto& s : scope) collectDecls(s, decls);
+    
+    for (const VarDeclStmt* decl : decls) {
+        if (!decl->initializer || decl->initializer->getType() != NodeType::NewExpr) continue;
+        auto& newExpr = static_cast<const NewExpr&>(*decl->initializer);
+        auto cls = newExpr.classType ? classIndex.find(newExpr.classType->name) : classIndex.end();
+        const ConstructorDecl* ctor = nullptr;
+        if (cls == classIndex.end() || !newExpr.anonymousClassBody.empty() ||
+            !inlinableConstructor(classes[cls->second], newExpr.arguments.size(), ctor)) {
+            continue;
+        }
+        
+        std::set<std::string> fields;
+        for (const auto& field : classes[cls->second].fields) fields.insert(symbolNames[field.first]);
+        EscapeScan scan{decl->name, fields, decl};
+        scan.stmts(scope);
+        if (program) {
+            // Corpo com parâmetro de mesmo nome fala do parâmetro
+            auto shadowed = [&](const std::vector<ParameterDecl>& params) {
+                for (auto& param : params) {
+                    if (param.name == decl->name) return true;
+                }
+                return false;
+            };
+            for (auto& fn : program->functions) {
+                if (!shadowed(fn->parameters)) scan.stmt(fn->body);
+            }
+            for (auto& c : program->classes) {
+                for (auto& field : c->fields) scan.expr(field->initializer);
+                for (auto& m : c->methods) {
+                    if (!shadowed(m->parameters)) scan.stmt(m->body);
+                }
+                for (auto& k : c->constructors) {
+                    if (shadowed(k->parameters)) continue;
+                    scan.exprs(k->constructorArgs);
+                    scan.stmt(k->body);
+                }
+            }
+        }
+        if (!scan.local) continue;
+        
+        ScalarObject obj;
+        obj.cls = cls->second;
+        obj.global = !inFunction;
+        for (const auto& field : classes[cls->second].fields) {
+            obj.slots[symbolNames[field.first]] = newSlot();
+        }
+        (inFunction ? scalarLocals : scalarObjects)[decl->name] = obj;
+        scalarDecls.insert(decl);
+        scalarReplaced++;
+    }
+}
+
+// Argumentos em slots temporários (na ordem da fonte), depois os
+// inicializadores de campo e as gravações do construtor direto nos slots
+void Codegen::emitScalarObject(const VarDeclStmt& decl) {
+    const ScalarObject& obj = (inFunction ? scalarLocals : scalarObjects).at(decl.name);
+    const ClassMeta& cls = classes[obj.cls];
+    auto& newExpr = static_cast<const NewExpr&>(*decl.initializer);
+    const ConstructorDecl* ctor = nullptr;
+    inlinableConstructor(cls, newExpr.arguments.size(), ctor);
+    
+    std::map<std::string, int>& scope = inFunction ? locals : variables;
+    std::map<std::string, int> saved = scope;
+    std::vector<std::pair<std::string, int>> params;
+    for (size_t i = 0; i < newExpr.arguments.size(); i++) {
+        visitExpression(newExpr.arguments[i]);
+        params.push_back({ctor->parameters[i].name, newSlot()});
+        emitSlot(obj, true, params.back().second);
+    }
+    
+    for (auto& field : cls.decl->fields) {
+        if (field->modifiers.isStatic) continue;
+        if (field->initializer) {
+            visitExpression(field->initializer);
+        } else {
+            emit(fieldType(*field) ? OP_ICONST_0 : OP_PUSH_NULL);
+        }
+        emitSlot(obj, true, obj.slots.at(field->name));
+    }
+    
+    if (ctor && ctor->body) {
+        for (auto& param : params) scope[param.first] = param.second;
+        std::set<std::string> names;
+        for (auto& param : params) names.insert(param.first);
+        for (auto& s : ctor->body->statements) {
+            visitExpression(static_cast<const AssignExpr&>(*static_cast<const ExprStmt&>(*s).expression).value);
+            emitSlot(obj, true, obj.slots.at(constructorStore(s, names)));
+        }
+    }
+    scope = saved;
+}
+
+// p em p.campo quando p foi escalarizado e nenhum local ou campo o encobre
+const Codegen::ScalarObject* Codegen::scalarObject(const ExprPtr& object) const {
+    if (!object || object->getType() != NodeType::Identifier) return nullptr;
+    const std::string& name = static_cast<const IdentifierExpr&>(*object).name;
+    if (inFunction) {
+        auto local = scalarLocals.find(name);
+        if (local != scalarLocals.end()) return &local->second;
+        if (locals.count(name) || isField(name)) return nullptr;
+    }
+    auto global = scalarObjects.find(name);
+    return global != scalarObjects.end() ? &global->second : nullptr;
 }
 
 void Codegen::visitStatement(StmtPtr stmt) {
     if (!stmt) return;
     
+    // Blocos e statements aninhados no mesmo pc ficam com a linha mais interna
+    if (stmt->line > 0) {
+        if (!lines.empty() && lines.back().pc == currentAddress()) lines.pop_back();
+        if (lines.empty() || lines.back().line != stmt->line) lines.push_back({currentAddress(), stmt->line});
+    }
+    
     switch (stmt->getType()) {
         case NodeType::VarDecl: {
             auto varDecl = std::static_pointer_cast<VarDeclStmt>(stmt);
+            if (scalarDecls.count(varDecl.get())) {
+                emitScalarObject(*varDecl);
+                break;
+            }
             if (varDecl->initializer) {
                 visitExpression(varDecl->initializer);
             } else {
                 emit(OP_PUSH_NULL);
             }
+            const bool isString = (varDecl->varType && varDecl->varType->name == "String" &&
+                                   varDecl->varType->arrayDimensions == 0) || isStringExpr(varDecl->initializer);
+            if (inFunction) {
+                locals[varDecl->name] = nextLocalIdx++;
+                if (isString) stringLocals.insert(varDecl->name);
+                else stringLocals.erase(varDecl->name);
+                emit(OP_STORE_LOCAL);
+                emit(locals[varDecl->name]);
+                break;
+            }
+            if (isString) stringGlobals.insert(varDecl->name);
+            else stringGlobals.erase(varDecl->name);
             variables[varDecl->name] = nextVarIdx++;
             emit(OP_STORE_GLOBAL);
             emit(variables[varDecl->name]);
@@ -311,18 +1085,27 @@ void Codegen::visitExpression(ExprPtr expr) {
                     emit(std::stoll(lit->value) & 0xFFFFFFFF);
                     emit(std::stoll(lit->value) >> 32);
                     break;
-                case LiteralExpr::LitType::Float:
+                case LiteralExpr::LitType::Float: {
+                    float f = std::stof(lit->value);
+                    int32_t bits;
+                    std::memcpy(&bits, &f, sizeof(bits));
                     emit(OP_PUSH_FLOAT);
-                    emit(*reinterpret_cast<int32_t*>(&lit->value));
+                    emit(bits);
                     break;
-                case LiteralExpr::LitType::Double:
+                }
+                case LiteralExpr::LitType::Double: {
+                    double d = std::stod(lit->value);
+                    int64_t bits;
+                    std::memcpy(&bits, &d, sizeof(bits));
                     emit(OP_PUSH_DOUBLE);
-                    // TODO: emit 64-bit value
+                    emit(static_cast<int32_t>(bits & 0xFFFFFFFF));
+                    emit(static_cast<int32_t>(bits >> 32));
                     break;
+                }
                 case LiteralExpr::LitType::String:
+                    // Índice no pool: a VM reaproveita a instância interned
                     emit(OP_PUSH_STRING);
-                    // TODO: índice na constant pool
-                    emit(999);
+                    emit(stringConstant(lit->value));
                     break;
                 default:
                     emit(OP_PUSH_NULL);
@@ -333,10 +1116,7 @@ void Codegen::visitExpression(ExprPtr expr) {
         
         case NodeType::Identifier: {
             auto id = std::static_pointer_cast<IdentifierExpr>(expr);
-            if (variables.find(id->name) != variables.end()) {
-                emit(OP_LOAD_GLOBAL);
-                emit(variables[id->name]);
-            } else {
+            if (!emitLoadName(id->name)) {
                 // Variável não encontrada - assume 0
                 emit(OP_ICONST_0);
             }
@@ -370,7 +1150,9 @@ void Codegen::visitExpression(ExprPtr expr) {
                 visitExpression(bin->right);
                 
                 switch (bin->op) {
-                    case BinaryExpr::Op::Add: emit(OP_IADD); break;
+                    case BinaryExpr::Op::Add:
+                        emit(isStringExpr(bin->left) || isStringExpr(bin->right) ? OP_SCONCAT : OP_IADD);
+                        break;
                     case BinaryExpr::Op::Sub: emit(OP_ISUB); break;
                     case BinaryExpr::Op::Mul: emit(OP_IMUL); break;
                     case BinaryExpr::Op::Div: emit(OP_IDIV); break;
@@ -454,29 +1236,46 @@ void Codegen::visitExpression(ExprPtr expr) {
         
         case NodeType::AssignExpr: {
             auto assign = std::static_pointer_cast<AssignExpr>(expr);
+            if (assign->target->getType() == NodeType::ArrayAccessExpr) {
+                // arr[idx] = value: IASTORE consome arr, idx, value; o valor
+                // passa por um slot temporario para continuar como resultado
+                // (local do frame dentro de fn: um global seria pisado na recursão)
+                auto access = std::static_pointer_cast<ArrayAccessExpr>(assign->target);
+                const int32_t load = inFunction ? OP_LOAD_LOCAL : OP_LOAD_GLOBAL;
+                const int32_t store = inFunction ? OP_STORE_LOCAL : OP_STORE_GLOBAL;
+                int temp = inFunction ? nextLocalIdx++ : nextVarIdx++;
+                visitExpression(assign->value);
+                emit(store);
+                emit(temp);
+                visitExpression(access->array);
+                visitExpression(access->index);
+                emit(load);
+                emit(temp);
+                emit(OP_IASTORE);
+                emit(load);
+                emit(temp);
+                break;
+            }
             visitExpression(assign->value);
             
             if (assign->target->getType() == NodeType::Identifier) {
                 auto id = std::static_pointer_cast<IdentifierExpr>(assign->target);
-                if (variables.find(id->name) != variables.end()) {
-                    emit(OP_DUP);
-                    emit(OP_STORE_GLOBAL);
-                    emit(variables[id->name]);
-                }
+                noteStringName(id->name, isStringExpr(assign->value));
+                emit(OP_DUP);
+                if (!emitStoreName(id->name)) emit(OP_POP);
             } else if (assign->target->getType() == NodeType::MemberExpr) {
-                // obj.field = value
+                // obj.field = value (o valor continua como resultado)
                 auto member = std::static_pointer_cast<MemberExpr>(assign->target);
+                emit(OP_DUP);
+                if (const ScalarObject* obj = scalarObject(member->object)) {
+                    emitSlot(*obj, true, obj->slots.at(member->memberName));
+                    break;
+                }
                 visitExpression(member->object);
                 emit(OP_SWAP);
                 emit(OP_PUTFIELD);
-                // TODO: field index
-                emit(0);
-            } else if (assign->target->getType() == NodeType::ArrayAccessExpr) {
-                // arr[idx] = value
-                auto access = std::static_pointer_cast<ArrayAccessExpr>(assign->target);
-                visitExpression(access->array);
-                visitExpression(access->index);
-                emit(OP_IASTORE);
+                emit(symbol(member->memberName));
+                emit(newCache());
             }
             break;
         }
@@ -487,13 +1286,13 @@ void Codegen::visitExpression(ExprPtr expr) {
             // target op= value  =>  target = target op value
             if (compound->target->getType() == NodeType::Identifier) {
                 auto id = std::static_pointer_cast<IdentifierExpr>(compound->target);
-                if (variables.find(id->name) != variables.end()) {
-                    emit(OP_LOAD_GLOBAL);
-                    emit(variables[id->name]);
+                if (emitLoadName(id->name)) {
                     visitExpression(compound->value);
                     
+                    const bool concat = isStringExpr(compound);
+                    noteStringName(id->name, concat);
                     switch (compound->op) {
-                        case BinaryExpr::Op::Add: emit(OP_IADD); break;
+                        case BinaryExpr::Op::Add: emit(concat ? OP_SCONCAT : OP_IADD); break;
                         case BinaryExpr::Op::Sub: emit(OP_ISUB); break;
                         case BinaryExpr::Op::Mul: emit(OP_IMUL); break;
                         case BinaryExpr::Op::Div: emit(OP_IDIV); break;
@@ -502,8 +1301,7 @@ void Codegen::visitExpression(ExprPtr expr) {
                     }
                     
                     emit(OP_DUP);
-                    emit(OP_STORE_GLOBAL);
-                    emit(variables[id->name]);
+                    emitStoreName(id->name);
                 }
             }
             break;
@@ -512,54 +1310,144 @@ void Codegen::visitExpression(ExprPtr expr) {
         case NodeType::MethodCallExpr: {
             auto call = std::static_pointer_cast<MethodCallExpr>(expr);
             
-            // Push object (this) se não for estático
-            if (call->object) {
-                visitExpression(call->object);
+            // Classe.metodo nativo (System.arraycopy, Math.sqrt, ...): argumentos e OP_NATIVE id argc
+            if (call->object && call->object->getType() == NodeType::Identifier) {
+                auto owner = std::static_pointer_cast<IdentifierExpr>(call->object);
+                const int32_t argc = static_cast<int32_t>(call->arguments.size());
+                const bool isValue = variables.count(owner->name) || locals.count(owner->name) || isField(owner->name);
+                const int32_t id = isValue ? -1 : nativeId((owner->name + "." + call->methodName).c_str());
+                const NativeSignature* sig = nativeSignature(id);
+                if (sig && argc >= sig->minArgs && argc <= sig->maxArgs) {
+                    for (auto& arg : call->arguments) {
+                        visitExpression(arg);
+                    }
+                    emit(OP_NATIVE);
+                    emit(id);
+                    emit(argc);
+                    break;
+                }
+                
+                // Classe.metodo estático
+                auto fn = functionIndex.find(owner->name + "." + call->methodName);
+                if (!isValue && fn != functionIndex.end()) {
+                    for (auto& arg : call->arguments) {
+                        visitExpression(arg);
+                    }
+                    emit(OP_CALL);
+                    emit(fn->second);
+                    emit(argc);
+                    break;
+                }
             }
             
-            // Push argumentos
-            for (auto& arg : call->arguments) {
-                visitExpression(arg);
+            // super.metodo(...): ligação estática na superclasse
+            if (call->isSuperCall) {
+                emitInvokeSpecial(currentClass >= 0 ? classes[currentClass].super : -1,
+                                  call->methodName, call->arguments);
+                break;
             }
             
-            // Invoca método
-            if (call->isStaticCall) {
+            // Sem objeto: método do this, fn de nível superior ou nome
+            // desconhecido (CALL -1 descarta os argumentos e devolve null)
+            if (!call->object && !(currentClass >= 0 && hasMethod(currentClass, call->methodName))) {
+                auto fn = functionIndex.find(call->methodName);
+
+                // native_gfx_*: opcode gráfico direto (buffer de frame na VM)
+                const GfxIntrinsic* gfx = fn == functionIndex.end() ? gfxIntrinsic(call->methodName.c_str()) : nullptr;
+                if (gfx && static_cast<int>(call->arguments.size()) == gfx->argc) {
+                    for (auto& arg : call->arguments) {
+                        visitExpression(arg);
+                    }
+                    emit(gfx->opcode);
+                    if (!gfx->pushes) emit(OP_PUSH_NULL);
+                    break;
+                }
+
+                for (auto& arg : call->arguments) {
+                    visitExpression(arg);
+                }
                 emit(OP_CALL);
-            } else if (call->isSuperCall) {
-                emit(OP_INVOKESPEC);
+                emit(fn != functionIndex.end() ? fn->second : -1);
+                emit(static_cast<int32_t>(call->arguments.size()));
+                break;
+            }
+            
+            // Receptor (this implícito) e argumentos; despacho virtual por inline cache
+            if (call->object) {
+                visitExpression(call->object);
             } else {
-                emit(OP_INVOKE);
+                emit(OP_LOAD_LOCAL);
+                emit(0);
             }
-            // TODO: method index
-            emit(call->arguments.size());
+            for (auto& arg : call->arguments) {
+                visitExpression(arg);
+            }
+            emit(OP_INVOKE);
+            emit(symbol(call->methodName));
+            emit(static_cast<int32_t>(call->arguments.size()));
+            emit(newCache());
             break;
         }
         
         case NodeType::NewExpr: {
             auto newExpr = std::static_pointer_cast<NewExpr>(expr);
+            auto cls = classIndex.find(newExpr->classType->name);
+            const int32_t idx = cls != classIndex.end() ? cls->second : -1;
+            
+            // Classe embutida da VM (StringBuilder): o construtor é um nativo
+            const int32_t argc = static_cast<int32_t>(newExpr->arguments.size());
+            const int32_t ctorId = idx < 0 ? nativeId((newExpr->classType->name + "." KAVA_CONSTRUCTOR_NAME).c_str()) : -1;
+            const NativeSignature* ctor = nativeSignature(ctorId);
+            if (ctor && argc >= ctor->minArgs && argc <= ctor->maxArgs) {
+                for (auto& arg : newExpr->arguments) {
+                    visitExpression(arg);
+                }
+                emit(OP_NATIVE);
+                emit(ctorId);
+                emit(argc);
+                break;
+            }
             
+            // NEW; DUP; argumentos; INVOKESPEC <init>; POP: sobra a instância
+            // (classe desconhecida: NEW empilha null e o construtor não roda)
             emit(OP_NEW);
-            // TODO: class index
-            emit(0);
+            emit(idx);
             emit(OP_DUP);
-            
-            // Push argumentos do construtor
             for (auto& arg : newExpr->arguments) {
                 visitExpression(arg);
             }
-            
             emit(OP_INVOKESPEC);
-            emit(newExpr->arguments.size());
+            emit(idx);
+            emit(symbol(KAVA_CONSTRUCTOR_NAME));
+            emit(static_cast<int32_t>(newExpr->arguments.size()));
+            emit(newCache());
+            emit(OP_POP);
             break;
         }
         
         case NodeType::NewArrayExpr: {
             auto newArr = std::static_pointer_cast<NewArrayExpr>(expr);
             
-            if (newArr->dimensions.size() == 1) {
+            // new int[] {a, b, c}: o parser guarda a lista como NewArrayExpr aninhado
+            std::vector<ExprPtr> elements = newArr->initializer;
+            if (elements.size() == 1 && elements[0]->getType() == NodeType::NewArrayExpr) {
+                auto inner = std::static_pointer_cast<NewArrayExpr>(elements[0]);
+                if (!inner->elementType) elements = inner->initializer;
+            }
+            if (newArr->dimensions.empty() && !newArr->initializer.empty()) {
+                emit(OP_PUSH_INT);
+                emit(elements.size());
+                emitNewArray(newArr->elementType);
+                for (size_t i = 0; i < elements.size(); i++) {
+                    emit(OP_DUP);
+                    emit(OP_PUSH_INT);
+                    emit(static_cast<int32_t>(i));
+                    visitExpression(elements[i]);
+                    emit(OP_IASTORE);
+                }
+            } else if (newArr->dimensions.size() == 1) {
                 visitExpression(newArr->dimensions[0]);
-                emit(OP_NEWARRAY);
-                emit(KAVA_T_INT);  // TODO: tipo correto
+                emitNewArray(newArr->elementType);
             } else {
                 for (auto& dim : newArr->dimensions) {
                     visitExpression(dim);
@@ -580,19 +1468,26 @@ void Codegen::visitExpression(ExprPtr expr) {
         
         case NodeType::MemberExpr: {
             auto member = std::static_pointer_cast<MemberExpr>(expr);
+            if (const ScalarObject* obj = scalarObject(member->object)) {
+                emitSlot(*obj, false, obj->slots.at(member->memberName));
+                break;
+            }
             visitExpression(member->object);
             emit(OP_GETFIELD);
-            // TODO: field index
-            emit(0);
+            emit(symbol(member->memberName));
+            emit(newCache());
             break;
         }
         
         case NodeType::ThisExpr:
-            emit(OP_ALOAD_0);  // 'this' está sempre no local 0
-            break;
-        
         case NodeType::SuperExpr:
-            emit(OP_ALOAD_0);
+            // 'this' está sempre no local 0 dos métodos
+            if (inFunction && currentClass >= 0) {
+                emit(OP_LOAD_LOCAL);
+                emit(0);
+            } else {
+                emit(OP_PUSH_NULL);
+            }
             break;
         
         case NodeType::CastExpr: {
@@ -666,14 +1561,29 @@ void Codegen::visitLambda(std::shared_ptr<LambdaExpr> lambda) {
     info.codeStart = currentAddress();
     info.paramCount = lambda->parameters.size();
     
-    // Register parameters as locals in lambda scope
+    // Parametros ganham slots proprios (nunca reaproveitados: o lambda pode
+    // rodar depois que o escopo que o criou terminou). A VM empilha os
+    // argumentos e o prologo os guarda, do ultimo para o primeiro.
     std::map<std::string, int> savedVars = variables;
-    int savedNextVar = nextVarIdx;
+    std::vector<int> paramSlots;
+    
+    // O corpo pode rodar fora do frame que criou o lambda: locais e this
+    // do fn em volta não são visíveis
+    std::map<std::string, int> savedLocals = locals;
+    const bool savedInFunction = inFunction;
+    const int savedClass = currentClass;
+    locals.clear();
+    inFunction = false;
+    currentClass = -1;
     
     for (size_t i = 0; i < lambda->parameters.size(); i++) {
-        variables[lambda->parameters[i].name] = i;
+        variables[lambda->parameters[i].name] = nextVarIdx;
+        paramSlots.push_back(nextVarIdx++);
+    }
+    for (size_t i = paramSlots.size(); i-- > 0;) {
+        emit(OP_STORE_GLOBAL);
+        emit(paramSlots[i]);
     }
-    nextVarIdx = lambda->parameters.size();
     
     if (lambda->bodyBlock) {
         visitStatement(lambda->bodyBlock);
@@ -685,7 +1595,9 @@ void Codegen::visitLambda(std::shared_ptr<LambdaExpr> lambda) {
     
     // Restore scope
     variables = savedVars;
-    nextVarIdx = savedNextVar;
+    locals = savedLocals;
+    inFunction = savedInFunction;
+    currentClass = savedClass;
     
     lambdas.push_back(info);
     
@@ -703,7 +1615,15 @@ void Codegen::visitStream(std::shared_ptr<StreamExpr> stream) {
     
     // Apply each operation
     for (const auto& op : stream->operations) {
-        if (op.argument) {
+        // collect(Collectors.toList()) etc.: o coletor nao e avaliado, a VM
+        // sempre materializa um array
+        bool collects = op.kind == StreamExpr::StreamOp::Kind::Collect ||
+                        op.kind == StreamExpr::StreamOp::Kind::ToList ||
+                        op.kind == StreamExpr::StreamOp::Kind::ToArray;
+        if (op.identity) {
+            visitExpression(op.identity);
+        }
+        if (op.argument && !collects) {
             visitExpression(op.argument);
         }
         
@@ -724,6 +1644,10 @@ void Codegen::visitStream(std::shared_ptr<StreamExpr> stream) {
             case StreamExpr::StreamOp::Kind::Skip: emit(OP_STREAM_SKIP); break;
             case StreamExpr::StreamOp::Kind::AnyMatch: emit(OP_STREAM_ANYMATCH); break;
             case StreamExpr::StreamOp::Kind::AllMatch: emit(OP_STREAM_ALLMATCH); break;
+            case StreamExpr::StreamOp::Kind::NoneMatch: emit(OP_STREAM_NONEMATCH); break;
+            case StreamExpr::StreamOp::Kind::FindFirst:
+            case StreamExpr::StreamOp::Kind::FindAny: emit(OP_STREAM_FINDFIRST); break;
+            case StreamExpr::StreamOp::Kind::Parallel: emit(OP_STREAM_PARALLEL); break;
             case StreamExpr::StreamOp::Kind::ToList: emit(OP_STREAM_TOLIST); break;
             case StreamExpr::StreamOp::Kind::ToArray: emit(OP_STREAM_TOLIST); break;
             default: break;
@@ -11,8 +11,10 @@
 
 #include "ast.h"
 #include "../vm/bytecode.h"
+#include "../vm/kvb.h"
 #include <vector>
 #include <map>
+#include <set>
 #include <string>
 
 namespace Kava {
@@ -20,9 +22,16 @@ namespace Kava {
 class Codegen {
 public:
     std::vector<int32_t> generate(const Program& program);
+    
+    // Alocações eliminadas pela análise de escape no último generate()
+    int scalarReplacedAllocations() const { return scalarReplaced; }
+    
+    // Início de cada statement (pc relativo ao código) e sua linha no fonte
+    const std::vector<KvbLine>& lineTable() const { return lines; }
 
 private:
     std::vector<int32_t> bytecode;
+    std::vector<KvbLine> lines;
     std::map<std::string, int> variables;
     std::map<std::string, int> methods;
     int nextVarIdx = 0;
@@ -46,6 +55,99 @@ private:
     std::vector<LambdaInfo> lambdas;
     int nextLambdaIdx = 0;
     
+    // ========================================
+    // FUNÇÕES, CLASSES E FRAMES
+    // ========================================
+    // Corpos de fn e métodos são gerados depois do HALT do nível superior e
+    // descritos no bloco de metadados (ver bytecode.h)
+    struct FunctionMeta {
+        int name;                  // símbolo
+        int params;                // sem contar o this
+        int locals = 0;            // slots do frame, this e parâmetros inclusive
+        int codeOffset = -1;
+        int owner = -1;            // classe dos métodos e construtores
+        const MethodDecl* method = nullptr;
+        const ConstructorDecl* ctor = nullptr;  // null no construtor implícito
+    };
+    struct ClassMeta {
+        const ClassDecl* decl;
+        int super = -1;
+        std::vector<std::pair<int, int32_t>> fields;  // símbolo, KAVA_T_* (0 = referência)
+        std::vector<FunctionMeta> methods;
+    };
+    std::vector<std::string> symbolNames;
+    std::map<std::string, int> symbols;
+    std::vector<FunctionMeta> functions;
+    std::map<std::string, int> functionIndex;  // nome, ou Classe.metodo estático
+    std::vector<ClassMeta> classes;
+    std::map<std::string, int> classIndex;
+    int nextCacheIdx = 0;
+    
+    // Corpo em geração: locals mapeia nomes para slots do frame. Em métodos
+    // e construtores (currentClass >= 0) o slot 0 é o this.
+    bool inFunction = false;
+    std::map<std::string, int> locals;
+    int nextLocalIdx = 0;
+    int currentClass = -1;
+    
+    int symbol(const std::string& name);
+    int newCache() { return nextCacheIdx++; }
+    void declareProgram(const Program& program);
+    void generateBody(FunctionMeta& fn, const std::vector<ParameterDecl>& params,
+                      const std::shared_ptr<BlockStmt>& body);
+    void generateConstructorPrologue(const FunctionMeta& fn);
+    std::vector<int32_t> withMetadata() const;
+    static int32_t asyncFlag(const FunctionMeta& fn) {
+        return fn.method && fn.method->modifiers.isAsync ? KAVA_FN_ASYNC : 0;
+    }
+    bool isField(const std::string& name) const;
+    bool hasMethod(int cls, const std::string& name) const;
+    bool emitLoadName(const std::string& name);
+    bool emitStoreName(const std::string& name);
+    void emitNewArray(const TypeRefPtr& elementType);
+    void emitInvokeSpecial(int cls, const std::string& name, const std::vector<ExprPtr>& args);
+    
+    // ========================================
+    // ANÁLISE DE ESCAPE
+    // ========================================
+    // `let p = new C(...)` cujo p só aparece como p.campo (leitura ou
+    // atribuição) no escopo não escapa: com o construtor de C simples o
+    // bastante para ser inlinado, o objeto vira um slot por campo (local no
+    // frame, global no nível superior) e o NEW some.
+    struct ScalarObject {
+        int cls;
+        bool global;
+        std::map<std::string, int> slots;  // campo -> slot
+    };
+    std::map<std::string, ScalarObject> scalarObjects;  // nível superior
+    std::map<std::string, ScalarObject> scalarLocals;   // corpo em geração
+    std::set<const VarDeclStmt*> scalarDecls;
+    int scalarReplaced = 0;
+    
+    // `+` é concatenação (OP_SCONCAT) quando um dos lados é String em tempo
+    // de compilação: literal, outra concatenação, toString(), ou nome
+    // declarado String / atribuído a partir de uma dessas (como no Java, o
+    // tipo estático decide). stringLocals vale para o corpo em geração.
+    std::set<std::string> stringGlobals;
+    std::set<std::string> stringLocals;
+    bool isStringExpr(const ExprPtr& expr) const;
+    void noteStringName(const std::string& name, bool isString);
+    
+    // Literais de string: índice no pool -> símbolo com o texto
+    std::vector<int> stringConstants;
+    std::map<std::string, int> stringIndex;
+    int stringConstant(const std::string& text);
+    
+    void planScalarReplacement(const std::vector<StmtPtr>& scope, const Program* program);
+    bool inlinableConstructor(const ClassMeta& cls, size_t argc, const ConstructorDecl*& ctor) const;
+    void emitScalarObject(const VarDeclStmt& decl);
+    const ScalarObject* scalarObject(const ExprPtr& object) const;
+    int newSlot() { return inFunction ? nextLocalIdx++ : nextVarIdx++; }
+    void emitSlot(const ScalarObject& obj, bool store, int slot) {
+        emit(obj.global ? (store ? OP_STORE_GLOBAL : OP_LOAD_GLOBAL) : (store ? OP_STORE_LOCAL : OP_LOAD_LOCAL));
+        emit(slot);
+    }
+    
     void visitStatement(StmtPtr stmt);
     void visitExpression(ExprPtr expr);
     void visitLambda(std::shared_ptr<class LambdaExpr> lambda);
@@ -91,6 +193,41 @@ private:
             emit(0);
         }
     }
+    
+    // KAVA_T_* do nome de um tipo primitivo (0 = não primitivo)
+    static int32_t primitiveType(const std::string& name) {
+        static const std::map<std::string, int32_t> types = {
+            {"boolean", KAVA_T_BOOLEAN}, {"byte", KAVA_T_BYTE}, {"char", KAVA_T_CHAR},
+            {"short", KAVA_T_SHORT}, {"int", KAVA_T_INT}, {"long", KAVA_T_LONG},
+            {"float", KAVA_T_FLOAT}, {"double", KAVA_T_DOUBLE},
+        };
+        auto it = types.find(name);
+        return it != types.end() ? it->second : 0;
+    }
+    
+    // Tipo primitivo do NEWARRAY (arrays sem tipo conhecido continuam int)
+    static int32_t arrayElementType(const TypeRefPtr& type) {
+        int32_t t = type ? primitiveType(type->name) : 0;
+        return t ? t : KAVA_T_INT;
+    }
+    
+    // Tipo de um campo no layout da instância (arrays e classes são referências)
+    static int32_t fieldType(const TypeRefPtr& type) {
+        return type && type->arrayDimensions == 0 ? primitiveType(type->name) : 0;
+    }
+    
+    // Campo `let` sem tipo: o literal inicial decide o slot (o resto é referência)
+    static int32_t fieldType(const FieldDecl& field) {
+        if (field.fieldType) return fieldType(field.fieldType);
+        if (!field.initializer || field.initializer->getType() != NodeType::Literal) return 0;
+        switch (static_cast<const LiteralExpr&>(*field.initializer).litType) {
+            case LiteralExpr::LitType::Boolean: return KAVA_T_BOOLEAN;
+            case LiteralExpr::LitType::Int: case LiteralExpr::LitType::Char: return KAVA_T_INT;
+            case LiteralExpr::LitType::Long: return KAVA_T_LONG;
+            case LiteralExpr::LitType::Float: case LiteralExpr::LitType::Double: return KAVA_T_DOUBLE;
+            default: return 0;
+        }
+    }
 };
 
 } // namespace Kava
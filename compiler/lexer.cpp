@@ -15,100 +15,142 @@ namespace Kava {
 // ============================================================
 // TABELA DE KEYWORDS
 // ============================================================
-std::map<std::string, TokenType> Lexer::keywords;
+// Hash perfeito calculado em tempo de compilação: tamanho, primeira,
+// segunda e última letra escolhem um slot único por keyword; a busca é um
+// hash e uma comparação, sem alocar a string do identificador.
+namespace {
 
-void Lexer::initKeywords() {
-    if (!keywords.empty()) return;
-    
+struct KeywordEntry {
+    std::string_view text;
+    TokenType type;
+};
+
+constexpr KeywordEntry KEYWORDS[] = {
     // Declarações
-    keywords["package"] = TokenType::PACKAGE;
-    keywords["import"] = TokenType::IMPORT;
-    keywords["class"] = TokenType::CLASS;
-    keywords["interface"] = TokenType::INTERFACE;
-    keywords["enum"] = TokenType::ENUM;
-    keywords["extends"] = TokenType::EXTENDS;
-    keywords["implements"] = TokenType::IMPLEMENTS;
-    
+    {"package", TokenType::PACKAGE},
+    {"import", TokenType::IMPORT},
+    {"class", TokenType::CLASS},
+    {"interface", TokenType::INTERFACE},
+    {"enum", TokenType::ENUM},
+    {"extends", TokenType::EXTENDS},
+    {"implements", TokenType::IMPLEMENTS},
+
     // Modificadores
-    keywords["public"] = TokenType::PUBLIC;
-    keywords["protected"] = TokenType::PROTECTED;
-    keywords["private"] = TokenType::PRIVATE;
-    keywords["static"] = TokenType::STATIC;
-    keywords["final"] = TokenType::FINAL;
-    keywords["abstract"] = TokenType::ABSTRACT;
-    keywords["native"] = TokenType::NATIVE;
-    keywords["synchronized"] = TokenType::SYNCHRONIZED;
-    keywords["volatile"] = TokenType::VOLATILE;
-    keywords["transient"] = TokenType::TRANSIENT;
-    keywords["strictfp"] = TokenType::STRICTFP;
-    
+    {"public", TokenType::PUBLIC},
+    {"protected", TokenType::PROTECTED},
+    {"private", TokenType::PRIVATE},
+    {"static", TokenType::STATIC},
+    {"final", TokenType::FINAL},
+    {"abstract", TokenType::ABSTRACT},
+    {"native", TokenType::NATIVE},
+    {"synchronized", TokenType::SYNCHRONIZED},
+    {"volatile", TokenType::VOLATILE},
+    {"transient", TokenType::TRANSIENT},
+    {"strictfp", TokenType::STRICTFP},
+
     // Tipos primitivos
-    keywords["void"] = TokenType::VOID;
-    keywords["boolean"] = TokenType::BOOLEAN;
-    keywords["byte"] = TokenType::BYTE;
-    keywords["char"] = TokenType::CHAR;
-    keywords["short"] = TokenType::SHORT;
-    keywords["int"] = TokenType::INT;
-    keywords["long"] = TokenType::LONG;
-    keywords["float"] = TokenType::FLOAT;
-    keywords["double"] = TokenType::DOUBLE;
-    
+    {"void", TokenType::VOID},
+    {"boolean", TokenType::BOOLEAN},
+    {"byte", TokenType::BYTE},
+    {"char", TokenType::CHAR},
+    {"short", TokenType::SHORT},
+    {"int", TokenType::INT},
+    {"long", TokenType::LONG},
+    {"float", TokenType::FLOAT},
+    {"double", TokenType::DOUBLE},
+
     // Controle de fluxo
-    keywords["if"] = TokenType::IF;
-    keywords["else"] = TokenType::ELSE;
-    keywords["switch"] = TokenType::SWITCH;
-    keywords["case"] = TokenType::CASE;
-    keywords["default"] = TokenType::DEFAULT;
-    keywords["while"] = TokenType::WHILE;
-    keywords["do"] = TokenType::DO;
-    keywords["for"] = TokenType::FOR;
-    keywords["break"] = TokenType::BREAK;
-    keywords["continue"] = TokenType::CONTINUE;
-    keywords["return"] = TokenType::RETURN;
-    
+    {"if", TokenType::IF},
+    {"else", TokenType::ELSE},
+    {"switch", TokenType::SWITCH},
+    {"case", TokenType::CASE},
+    {"default", TokenType::DEFAULT},
+    {"while", TokenType::WHILE},
+    {"do", TokenType::DO},
+    {"for", TokenType::FOR},
+    {"break", TokenType::BREAK},
+    {"continue", TokenType::CONTINUE},
+    {"return", TokenType::RETURN},
+
     // Exceções
-    keywords["try"] = TokenType::TRY;
-    keywords["catch"] = TokenType::CATCH;
-    keywords["finally"] = TokenType::FINALLY;
-    keywords["throw"] = TokenType::THROW;
-    keywords["throws"] = TokenType::THROWS;
-    
+    {"try", TokenType::TRY},
+    {"catch", TokenType::CATCH},
+    {"finally", TokenType::FINALLY},
+    {"throw", TokenType::THROW},
+    {"throws", TokenType::THROWS},
+
     // OOP
-    keywords["new"] = TokenType::NEW;
-    keywords["this"] = TokenType::THIS;
-    keywords["super"] = TokenType::SUPER;
-    keywords["instanceof"] = TokenType::INSTANCEOF;
-    
+    {"new", TokenType::NEW},
+    {"this", TokenType::THIS},
+    {"super", TokenType::SUPER},
+    {"instanceof", TokenType::INSTANCEOF},
+
     // Outros
-    keywords["assert"] = TokenType::ASSERT;
-    keywords["true"] = TokenType::TRUE;
-    keywords["false"] = TokenType::FALSE;
-    keywords["null"] = TokenType::NULL_LITERAL;
-    
+    {"assert", TokenType::ASSERT},
+    {"true", TokenType::TRUE},
+    {"false", TokenType::FALSE},
+    {"null", TokenType::NULL_LITERAL},
+
     // Extensões KAVA
-    keywords["let"] = TokenType::LET;
-    keywords["func"] = TokenType::FUNC;
-    keywords["print"] = TokenType::PRINT;
-    keywords["struct"] = TokenType::STRUCT;
-    
+    {"let", TokenType::LET},
+    {"func", TokenType::FUNC},
+    {"print", TokenType::PRINT},
+    {"struct", TokenType::STRUCT},
+
     // Aliases para compatibilidade
-    keywords["bool"] = TokenType::BOOLEAN;
-    keywords["fn"] = TokenType::FUNC;
-    keywords["var"] = TokenType::LET;
-    
+    {"bool", TokenType::BOOLEAN},
+    {"fn", TokenType::FUNC},
+    {"var", TokenType::LET},
+
     // KAVA 2.5 keywords
-    keywords["async"] = TokenType::ASYNC;
-    keywords["await"] = TokenType::AWAIT;
-    keywords["stream"] = TokenType::STREAM;
-    keywords["yield"] = TokenType::YIELD;
+    {"async", TokenType::ASYNC},
+    {"await", TokenType::AWAIT},
+    {"stream", TokenType::STREAM},
+    {"yield", TokenType::YIELD},
+
+    // ============================================================
+    // CONSTRUTOR
+    // ============================================================
+};
+
+constexpr size_t KEYWORD_TABLE_SIZE = 256;
+constexpr size_t KEYWORD_MIN_LENGTH = 2;
+constexpr size_t KEYWORD_MAX_LENGTH = 12;
+
+constexpr size_t keywordHash(std::string_view s) {
+    return (s.size() + 7 * static_cast<unsigned char>(s[0]) + 23 * static_cast<unsigned char>(s[s.size() - 1]) +
+            static_cast<unsigned char>(s[1])) & (KEYWORD_TABLE_SIZE - 1);
+}
+
+struct KeywordTable {
+    int8_t slot[KEYWORD_TABLE_SIZE] = {};  // índice em KEYWORDS + 1 (0 = vazio)
+    bool perfect = true;
+
+    constexpr KeywordTable() {
+        for (size_t i = 0; i < sizeof(KEYWORDS) / sizeof(KEYWORDS[0]); i++) {
+            size_t h = keywordHash(KEYWORDS[i].text);
+            if (slot[h] != 0) perfect = false;
+            slot[h] = static_cast<int8_t>(i + 1);
+        }
+    }
+};
+
+constexpr KeywordTable keywordTable;
+static_assert(keywordTable.perfect, "colisão no hash de keywords: ajuste keywordHash");
+
+} // namespace
+
+TokenType Lexer::keywordType(std::string_view text) {
+    if (text.size() < KEYWORD_MIN_LENGTH || text.size() > KEYWORD_MAX_LENGTH) return TokenType::IDENTIFIER;
+    int slot = keywordTable.slot[keywordHash(text)];
+    if (slot != 0 && KEYWORDS[slot - 1].text == text) return KEYWORDS[slot - 1].type;
+    return TokenType::IDENTIFIER;
 }
 
 // ============================================================
 // CONSTRUTOR
 // ============================================================
-Lexer::Lexer(const std::string& source) : source(source) {
-    initKeywords();
-}
+Lexer::Lexer(std::string_view source) : source(source) {}
 
 // ============================================================
 // TOKEN TO STRING
@@ -181,8 +223,7 @@ bool Lexer::match(char expected) {
 }
 
 Token Lexer::makeToken(TokenType type) {
-    std::string text = source.substr(start, current - start);
-    Token token(type, text, line, startColumn);
+    Token token(type, source.substr(start, current - start), line, startColumn);
     tokens.push_back(token);
     return token;
 }
@@ -193,7 +234,7 @@ Token Lexer::errorToken(const std::string& message) {
     oss << "Erro léxico [" << line << ":" << column << "]: " << message;
     errors.push_back(oss.str());
     
-    Token token(TokenType::ERROR, message, line, startColumn);
+    Token token(TokenType::ERROR, decoded.emplace_back(message), line, startColumn);
     tokens.push_back(token);
     return token;
 }
@@ -423,14 +464,7 @@ void Lexer::scanToken() {
 Token Lexer::identifier() {
     while (isAlphaNumeric(peek())) advance();
     
-    std::string text = source.substr(start, current - start);
-    
-    auto it = keywords.find(text);
-    if (it != keywords.end()) {
-        return makeToken(it->second);
-    }
-    
-    return makeToken(TokenType::IDENTIFIER);
+    return makeToken(keywordType(source.substr(start, current - start)));
 }
 
 // ============================================================
@@ -500,10 +534,18 @@ Token Lexer::number() {
 // STRINGS
 // ============================================================
 Token Lexer::string() {
+    // Sem escapes o lexeme é a fatia entre as aspas; o primeiro escape
+    // passa a decodificar para um texto próprio
+    const size_t contentStart = current;
+    bool hasEscape = false;
     std::string value;
     
     while (!isAtEnd() && peek() != '"') {
         if (peek() == '\\') {
+            if (!hasEscape) {
+                hasEscape = true;
+                value.assign(source.substr(contentStart, current - contentStart));
+            }
             advance();
             if (isAtEnd()) break;
             char escaped = advance();
@@ -531,8 +573,10 @@ Token Lexer::string() {
             }
         } else if (peek() == '\n') {
             return errorToken("String não terminada");
-        } else {
+        } else if (hasEscape) {
             value += advance();
+        } else {
+            advance();
         }
     }
     
@@ -540,10 +584,14 @@ Token Lexer::string() {
         return errorToken("String não terminada");
     }
     
+    const size_t contentEnd = current;
     advance();  // Fecha aspas
     
     Token token = makeToken(TokenType::STRING_LITERAL);
-    tokens.back().lexeme = value;  // Usa valor processado
+    // Usa valor processado
+    token.lexeme = hasEscape ? std::string_view(decoded.emplace_back(std::move(value)))
+                             : source.substr(contentStart, contentEnd - contentStart);
+    tokens.back().lexeme = token.lexeme;
     return token;
 }
 
@@ -10,8 +10,9 @@
 #define KAVA_LEXER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
+#include <deque>
 
 namespace Kava {
 
@@ -179,9 +180,12 @@ enum class TokenType {
 // ============================================================
 // TOKEN
 // ============================================================
+// lexeme é uma fatia do fonte (ou do texto decodificado guardado pelo
+// Lexer, em literais com escapes e erros): o fonte e o Lexer precisam
+// viver enquanto os tokens forem usados.
 struct Token {
     TokenType type;
-    std::string lexeme;
+    std::string_view lexeme;
     int line;
     int column;
     
@@ -193,7 +197,7 @@ struct Token {
     };
     
     Token() : type(TokenType::ERROR), line(0), column(0), intValue(0) {}
-    Token(TokenType t, const std::string& lex, int ln, int col)
+    Token(TokenType t, std::string_view lex, int ln, int col)
         : type(t), lexeme(lex), line(ln), column(col), intValue(0) {}
     
     bool is(TokenType t) const { return type == t; }
@@ -210,7 +214,7 @@ struct Token {
 // ============================================================
 class Lexer {
 public:
-    explicit Lexer(const std::string& source);
+    explicit Lexer(std::string_view source);
     std::vector<Token> scanTokens();
     
     // Para parsing incremental
@@ -220,9 +224,13 @@ public:
     int getErrorCount() const { return errorCount; }
     const std::vector<std::string>& getErrors() const { return errors; }
 
+    // Keyword do texto, ou IDENTIFIER (hash perfeito, sem alocar)
+    static TokenType keywordType(std::string_view text);
+
 private:
-    std::string source;
+    std::string_view source;
     std::vector<Token> tokens;
+    std::deque<std::string> decoded;  // textos que não existem no fonte (endereços estáveis)
     size_t start = 0;
     size_t current = 0;
     int line = 1;
@@ -232,9 +240,6 @@ private:
     int errorCount = 0;
     std::vector<std::string> errors;
     
-    static std::map<std::string, TokenType> keywords;
-    static void initKeywords();
-    
     // Helpers de navegação
     bool isAtEnd() const { return current >= source.length(); }
     char advance();
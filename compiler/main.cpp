@@ -33,7 +33,7 @@ int main(int argc, char** argv) {
         std::vector<Kava::Token> tokens = lexer.scanTokens();
 
         // 2. Parser
-        Kava::Parser parser(tokens);
+        Kava::Parser parser(std::move(tokens));
         auto programPtr = parser.parse();
 
         // 3. Codegen
@@ -46,13 +46,16 @@ int main(int argc, char** argv) {
         if (lastDot != std::string::npos) outPath = outPath.substr(0, lastDot);
         outPath += ".kvb";
 
+        std::vector<uint8_t> image = Kava::encodeKvb(bytecode, codegen.lineTable());
         std::ofstream outFile(outPath, std::ios::binary);
-        for (int32_t op : bytecode) {
-            outFile.write(reinterpret_cast<const char*>(&op), sizeof(int32_t));
-        }
+        outFile.write(reinterpret_cast<const char*>(image.data()), image.size());
         outFile.close();
 
-        std::cout << "Compilado com sucesso: " << outPath << " (" << bytecode.size() << " instruções)" << std::endl;
+        std::cout << "Compilado com sucesso: " << outPath << " (" << bytecode.size() << " instruções, "
+                  << image.size() << " bytes)" << std::endl;
+        if (codegen.scalarReplacedAllocations() > 0) {
+            std::cout << "  " << codegen.scalarReplacedAllocations() << " alocações escalarizadas (análise de escape)" << std::endl;
+        }
 
     } catch (const std::exception& e) {
         std::cerr << "Erro de compilação: " << e.what() << std::endl;
@@ -9,13 +9,14 @@
 #include "parser.h"
 #include <stdexcept>
 #include <sstream>
+#include <map>
 
 namespace Kava {
 
 // ============================================================
 // CONSTRUTOR
 // ============================================================
-Parser::Parser(const std::vector<Token>& tokens) : tokens(tokens) {
+Parser::Parser(std::vector<Token> tokens) : tokens(std::move(tokens)) {
     // Tokens para sincronização após erro
     synchronizeSet = {
         TokenType::CLASS, TokenType::INTERFACE, TokenType::ENUM,
@@ -109,7 +110,7 @@ void Parser::synchronize() {
 // PARSE PRINCIPAL
 // ============================================================
 std::shared_ptr<Program> Parser::parse() {
-    auto program = std::make_shared<Program>();
+    auto program = node<Program>();
     
     try {
         parseCompilationUnit(program);
@@ -134,6 +135,14 @@ void Parser::parseCompilationUnit(std::shared_ptr<Program>& program) {
     // Type declarations ou statements
     while (!isAtEnd()) {
         try {
+            // synchronized (obj) { ... } no nível superior é statement, não modificador
+            if (check(TokenType::SYNCHRONIZED) &&
+                tokens.size() > current + 1 &&
+                tokens[current + 1].type == TokenType::LPAREN) {
+                program->statements.push_back(parseStatement());
+                continue;
+            }
+            
             auto annots = parseAnnotations();
             Modifiers mods = parseModifiers();
             
@@ -146,6 +155,8 @@ void Parser::parseCompilationUnit(std::shared_ptr<Program>& program) {
             } else if (check(TokenType::ENUM)) {
                 advance();
                 program->enums.push_back(parseEnumDeclaration(mods, annots));
+            } else if (match(TokenType::FUNC)) {
+                program->functions.push_back(parseFunctionDeclaration(mods, annots));
             } else {
                 // Statement de nível superior (modo script)
                 program->statements.push_back(parseStatement());
@@ -162,10 +173,10 @@ void Parser::parseCompilationUnit(std::shared_ptr<Program>& program) {
 std::shared_ptr<PackageDecl> Parser::parsePackageDeclaration() {
     consume(TokenType::PACKAGE, "Esperado 'package'");
     
-    auto decl = std::make_shared<PackageDecl>();
+    auto decl = node<PackageDecl>();
     
     // Lê nome qualificado (pkg.subpkg.etc)
-    std::string name = consume(TokenType::IDENTIFIER, "Esperado nome do pacote").lexeme;
+    std::string name(consume(TokenType::IDENTIFIER, "Esperado nome do pacote").lexeme);
     while (match(TokenType::DOT)) {
         name += ".";
         name += consume(TokenType::IDENTIFIER, "Esperado nome do pacote").lexeme;
@@ -179,13 +190,13 @@ std::shared_ptr<PackageDecl> Parser::parsePackageDeclaration() {
 std::shared_ptr<ImportDecl> Parser::parseImportDeclaration() {
     consume(TokenType::IMPORT, "Esperado 'import'");
     
-    auto decl = std::make_shared<ImportDecl>();
+    auto decl = node<ImportDecl>();
     
     // import static?
     decl->isStatic = match(TokenType::STATIC);
     
     // Nome qualificado
-    std::string name = consume(TokenType::IDENTIFIER, "Esperado nome do import").lexeme;
+    std::string name(consume(TokenType::IDENTIFIER, "Esperado nome do import").lexeme);
     while (match(TokenType::DOT)) {
         if (match(TokenType::STAR)) {
             decl->isWildcard = true;
@@ -216,7 +227,7 @@ std::vector<AnnotationPtr> Parser::parseAnnotations() {
 AnnotationPtr Parser::parseAnnotation() {
     consume(TokenType::AT, "Esperado '@'");
     
-    auto annot = std::make_shared<AnnotationNode>();
+    auto annot = node<AnnotationNode>();
     annot->name = consume(TokenType::IDENTIFIER, "Esperado nome da anotação").lexeme;
     
     // Elementos opcionais
@@ -228,7 +239,7 @@ AnnotationPtr Parser::parseAnnotation() {
                 tokens[current + 1].type == TokenType::ASSIGN) {
                 // Elementos nomeados
                 do {
-                    std::string elemName = consume(TokenType::IDENTIFIER, "Esperado nome do elemento").lexeme;
+                    std::string elemName(consume(TokenType::IDENTIFIER, "Esperado nome do elemento").lexeme);
                     consume(TokenType::ASSIGN, "Esperado '='");
                     annot->elements[elemName] = parseExpression();
                 } while (match(TokenType::COMMA));
@@ -272,6 +283,8 @@ Modifiers Parser::parseModifiers() {
             mods.isTransient = true;
         } else if (match(TokenType::STRICTFP)) {
             mods.isStrictfp = true;
+        } else if (match(TokenType::ASYNC)) {
+            mods.isAsync = true;
         } else {
             break;
         }
@@ -284,7 +297,7 @@ Modifiers Parser::parseModifiers() {
 // TIPOS
 // ============================================================
 TypeRefPtr Parser::parseType() {
-    auto typeRef = std::make_shared<TypeRefNode>();
+    auto typeRef = node<TypeRefNode>();
     
     // Tipo primitivo ou nome de classe
     if (match({TokenType::VOID, TokenType::BOOLEAN, TokenType::BYTE, 
@@ -305,9 +318,11 @@ TypeRefPtr Parser::parseType() {
         }
     }
     
-    // Array dimensions
-    while (match(TokenType::LBRACKET)) {
-        consume(TokenType::RBRACKET, "Esperado ']'");
+    // Array dimensions (so "[]": em "new int[n]" o tamanho fica para parseNew)
+    while (check(TokenType::LBRACKET) && current + 1 < tokens.size() &&
+           tokens[current + 1].type == TokenType::RBRACKET) {
+        advance();
+        advance();
         typeRef->arrayDimensions++;
     }
     
@@ -320,7 +335,7 @@ std::vector<std::string> Parser::parseTypeParameters() {
     consume(TokenType::LT, "Esperado '<'");
     
     do {
-        std::string name = consume(TokenType::IDENTIFIER, "Esperado nome do parâmetro de tipo").lexeme;
+        std::string name(consume(TokenType::IDENTIFIER, "Esperado nome do parâmetro de tipo").lexeme);
         
         // extends bound
         if (match(TokenType::EXTENDS)) {
@@ -344,7 +359,7 @@ std::vector<TypeRefPtr> Parser::parseTypeArguments() {
     do {
         if (match(TokenType::QUESTION)) {
             // Wildcard
-            auto wildcard = std::make_shared<TypeRefNode>();
+            auto wildcard = node<TypeRefNode>();
             wildcard->name = "?";
             
             if (match(TokenType::EXTENDS)) {
@@ -370,7 +385,7 @@ std::vector<TypeRefPtr> Parser::parseTypeArguments() {
 std::shared_ptr<ClassDecl> Parser::parseClassDeclaration(
     const Modifiers& mods, const std::vector<AnnotationPtr>& annots) {
     
-    auto cls = std::make_shared<ClassDecl>();
+    auto cls = node<ClassDecl>();
     cls->modifiers = mods;
     cls->annotations = annots;
     cls->name = consume(TokenType::IDENTIFIER, "Esperado nome da classe").lexeme;
@@ -408,7 +423,7 @@ void Parser::parseClassBody(std::shared_ptr<ClassDecl>& cls) {
                 tokens.size() > current + 1 && 
                 tokens[current + 1].type == TokenType::LBRACE) {
                 advance();  // static
-                auto staticBlock = std::make_shared<StaticBlock>();
+                auto staticBlock = node<StaticBlock>();
                 staticBlock->body = parseBlock();
                 cls->staticBlocks.push_back(staticBlock);
                 continue;
@@ -416,7 +431,7 @@ void Parser::parseClassBody(std::shared_ptr<ClassDecl>& cls) {
             
             // Instance block
             if (check(TokenType::LBRACE)) {
-                auto instBlock = std::make_shared<InstanceBlock>();
+                auto instBlock = node<InstanceBlock>();
                 instBlock->body = parseBlock();
                 cls->instanceBlocks.push_back(instBlock);
                 continue;
@@ -431,18 +446,32 @@ void Parser::parseClassBody(std::shared_ptr<ClassDecl>& cls) {
                 typeParams = parseTypeParameters();
             }
             
+            // fn nome(params) { ... }
+            if (match(TokenType::FUNC)) {
+                cls->methods.push_back(parseFunctionDeclaration(mods, annots));
+                continue;
+            }
+            
+            // let nome = valor (campo sem tipo declarado)
+            if (match(TokenType::LET)) {
+                std::string name(consume(TokenType::IDENTIFIER, "Esperado nome do campo").lexeme);
+                cls->fields.push_back(parseFieldDeclaration(mods, annots, nullptr, name));
+                continue;
+            }
+            
             // Construtor (mesmo nome que a classe)
             if (check(TokenType::IDENTIFIER) && 
                 peek().lexeme == cls->name &&
                 tokens.size() > current + 1 &&
                 tokens[current + 1].type == TokenType::LPAREN) {
+                advance();  // nome da classe
                 cls->constructors.push_back(parseConstructorDeclaration(mods, annots, cls->name));
                 continue;
             }
             
             // Método ou campo
             TypeRefPtr type = parseType();
-            std::string name = consume(TokenType::IDENTIFIER, "Esperado nome do membro").lexeme;
+            std::string name(consume(TokenType::IDENTIFIER, "Esperado nome do membro").lexeme);
             
             if (check(TokenType::LPAREN)) {
                 // Método
@@ -466,7 +495,7 @@ void Parser::parseClassBody(std::shared_ptr<ClassDecl>& cls) {
 std::shared_ptr<InterfaceDecl> Parser::parseInterfaceDeclaration(
     const Modifiers& mods, const std::vector<AnnotationPtr>& annots) {
     
-    auto iface = std::make_shared<InterfaceDecl>();
+    auto iface = node<InterfaceDecl>();
     iface->modifiers = mods;
     iface->modifiers.isAbstract = true;
     iface->annotations = annots;
@@ -507,7 +536,7 @@ void Parser::parseInterfaceBody(std::shared_ptr<InterfaceDecl>& iface) {
             }
             
             TypeRefPtr type = parseType();
-            std::string name = consume(TokenType::IDENTIFIER, "Esperado nome do membro").lexeme;
+            std::string name(consume(TokenType::IDENTIFIER, "Esperado nome do membro").lexeme);
             
             if (check(TokenType::LPAREN)) {
                 mods.isAbstract = true;
@@ -534,7 +563,7 @@ void Parser::parseInterfaceBody(std::shared_ptr<InterfaceDecl>& iface) {
 std::shared_ptr<EnumDecl> Parser::parseEnumDeclaration(
     const Modifiers& mods, const std::vector<AnnotationPtr>& annots) {
     
-    auto enumDecl = std::make_shared<EnumDecl>();
+    auto enumDecl = node<EnumDecl>();
     enumDecl->modifiers = mods;
     enumDecl->annotations = annots;
     enumDecl->name = consume(TokenType::IDENTIFIER, "Esperado nome do enum").lexeme;
@@ -595,7 +624,7 @@ void Parser::parseEnumBody(std::shared_ptr<EnumDecl>& enumDecl) {
                 }
                 
                 TypeRefPtr type = parseType();
-                std::string name = consume(TokenType::IDENTIFIER, "Esperado nome do membro").lexeme;
+                std::string name(consume(TokenType::IDENTIFIER, "Esperado nome do membro").lexeme);
                 
                 if (check(TokenType::LPAREN)) {
                     enumDecl->methods.push_back(parseMethodDeclaration(mods, annots, typeParams, type, name));
@@ -619,7 +648,7 @@ std::shared_ptr<FieldDecl> Parser::parseFieldDeclaration(
     const Modifiers& mods, const std::vector<AnnotationPtr>& annots,
     TypeRefPtr type, const std::string& name) {
     
-    auto field = std::make_shared<FieldDecl>();
+    auto field = node<FieldDecl>();
     field->modifiers = mods;
     field->annotations = annots;
     field->fieldType = type;
@@ -640,7 +669,7 @@ std::shared_ptr<MethodDecl> Parser::parseMethodDeclaration(
     const Modifiers& mods, const std::vector<AnnotationPtr>& annots,
     const std::vector<std::string>& typeParams, TypeRefPtr returnType, const std::string& name) {
     
-    auto method = std::make_shared<MethodDecl>();
+    auto method = node<MethodDecl>();
     method->modifiers = mods;
     method->annotations = annots;
     method->typeParams = typeParams;
@@ -666,8 +695,8 @@ std::shared_ptr<MethodDecl> Parser::parseMethodDeclaration(
     } else {
         // Sintaxe alternativa: func name() = expr
         if (match(TokenType::ASSIGN)) {
-            auto body = std::make_shared<BlockStmt>();
-            auto ret = std::make_shared<ReturnStmt>();
+            auto body = node<BlockStmt>();
+            auto ret = node<ReturnStmt>();
             ret->value = parseExpression();
             body->statements.push_back(ret);
             method->body = body;
@@ -678,10 +707,18 @@ std::shared_ptr<MethodDecl> Parser::parseMethodDeclaration(
     return method;
 }
 
+std::shared_ptr<MethodDecl> Parser::parseFunctionDeclaration(
+    const Modifiers& mods, const std::vector<AnnotationPtr>& annots) {
+    
+    // fn/func nome(params): sem tipo de retorno, parâmetros podem omitir o tipo
+    std::string name(consume(TokenType::IDENTIFIER, "Esperado nome da função").lexeme);
+    return parseMethodDeclaration(mods, annots, {}, nullptr, name);
+}
+
 std::shared_ptr<ConstructorDecl> Parser::parseConstructorDeclaration(
     const Modifiers& mods, const std::vector<AnnotationPtr>& annots, const std::string& name) {
     
-    auto ctor = std::make_shared<ConstructorDecl>();
+    auto ctor = node<ConstructorDecl>();
     ctor->modifiers = mods;
     ctor->annotations = annots;
     ctor->name = name;
@@ -742,7 +779,11 @@ ParameterDecl Parser::parseParameter() {
         param.modifiers.isFinal = true;
     }
     
-    param.type = parseType();
+    // Sem tipo: fn f(x, y)
+    bool untyped = check(TokenType::IDENTIFIER) && tokens.size() > current + 1 &&
+                   (tokens[current + 1].type == TokenType::COMMA ||
+                    tokens[current + 1].type == TokenType::RPAREN);
+    if (!untyped) param.type = parseType();
     
     // Varargs
     if (match(TokenType::ELLIPSIS)) {
@@ -757,7 +798,15 @@ ParameterDecl Parser::parseParameter() {
 // ============================================================
 // STATEMENTS
 // ============================================================
+// Linha do primeiro token: vai para a tabela de linhas do .kvb
 StmtPtr Parser::parseStatement() {
+    const int line = peek().line;
+    StmtPtr stmt = parseStatementKind();
+    if (stmt && stmt->line == 0) stmt->line = line;
+    return stmt;
+}
+
+StmtPtr Parser::parseStatementKind() {
     try {
         // Declaração de variável local
         if (check(TokenType::LET) || check(TokenType::FINAL)) {
@@ -775,12 +824,16 @@ StmtPtr Parser::parseStatement() {
         if (check(TokenType::IDENTIFIER)) {
             // Olha adiante para ver se é declaração
             size_t saved = current;
-            parseType();  // Consome o tipo
-            if (check(TokenType::IDENTIFIER)) {
-                current = saved;  // Volta
-                return parseLocalVariableDeclaration();
+            bool isDecl = false;
+            try {
+                parseType();  // Consome o tipo
+                isDecl = check(TokenType::IDENTIFIER);
+            } catch (...) {
+                // Ex.: xs.stream() nao e nome de tipo
             }
-            current = saved;  // Volta e trata como expressão
+            current = saved;  // Volta
+            if (isDecl) return parseLocalVariableDeclaration();
+            // Senão trata como expressão
         }
         
         // Statements de controle
@@ -800,10 +853,10 @@ StmtPtr Parser::parseStatement() {
         if (match(TokenType::YIELD)) return parseYieldStatement();
         if (match(TokenType::AWAIT)) {
             // await como statement: await expr;
-            auto awaitExpr = std::make_shared<AwaitExpr>();
+            auto awaitExpr = node<AwaitExpr>();
             awaitExpr->operand = parseExpression();
             match(TokenType::SEMICOLON);
-            auto exprStmt = std::make_shared<ExprStmt>();
+            auto exprStmt = node<ExprStmt>();
             exprStmt->expression = awaitExpr;
             return exprStmt;
         }
@@ -813,7 +866,7 @@ StmtPtr Parser::parseStatement() {
         
         // Statement vazio
         if (match(TokenType::SEMICOLON)) {
-            return std::make_shared<BlockStmt>();
+            return node<BlockStmt>();
         }
         
         // Expression statement
@@ -821,14 +874,14 @@ StmtPtr Parser::parseStatement() {
         
     } catch (const ParseError&) {
         synchronize();
-        return std::make_shared<BlockStmt>();
+        return node<BlockStmt>();
     }
 }
 
 std::shared_ptr<BlockStmt> Parser::parseBlock() {
     consume(TokenType::LBRACE, "Esperado '{'");
     
-    auto block = std::make_shared<BlockStmt>();
+    auto block = node<BlockStmt>();
     
     while (!check(TokenType::RBRACE) && !isAtEnd()) {
         block->statements.push_back(parseStatement());
@@ -840,7 +893,7 @@ std::shared_ptr<BlockStmt> Parser::parseBlock() {
 }
 
 StmtPtr Parser::parseLocalVariableDeclaration() {
-    auto decl = std::make_shared<VarDeclStmt>();
+    auto decl = node<VarDeclStmt>();
     
     // Modificadores (final)
     if (match(TokenType::FINAL)) {
@@ -870,7 +923,7 @@ StmtPtr Parser::parseLocalVariableDeclaration() {
 }
 
 StmtPtr Parser::parseIfStatement() {
-    auto stmt = std::make_shared<IfStmt>();
+    auto stmt = node<IfStmt>();
     
     // Parênteses opcionais (extensão KAVA)
     bool hasParen = match(TokenType::LPAREN);
@@ -887,7 +940,7 @@ StmtPtr Parser::parseIfStatement() {
 }
 
 StmtPtr Parser::parseWhileStatement() {
-    auto stmt = std::make_shared<WhileStmt>();
+    auto stmt = node<WhileStmt>();
     
     bool hasParen = match(TokenType::LPAREN);
     stmt->condition = parseExpression();
@@ -899,7 +952,7 @@ StmtPtr Parser::parseWhileStatement() {
 }
 
 StmtPtr Parser::parseDoWhileStatement() {
-    auto stmt = std::make_shared<DoWhileStmt>();
+    auto stmt = node<DoWhileStmt>();
     
     stmt->body = parseStatement();
     
@@ -937,7 +990,7 @@ StmtPtr Parser::parseForStatement() {
     current = saved;
     
     if (isForEach) {
-        auto stmt = std::make_shared<ForEachStmt>();
+        auto stmt = node<ForEachStmt>();
         
         if (match(TokenType::FINAL)) {
             stmt->modifiers.isFinal = true;
@@ -954,7 +1007,7 @@ StmtPtr Parser::parseForStatement() {
     }
     
     // For tradicional
-    auto stmt = std::make_shared<ForStmt>();
+    auto stmt = node<ForStmt>();
     
     // Init
     if (!check(TokenType::SEMICOLON)) {
@@ -983,7 +1036,7 @@ StmtPtr Parser::parseForStatement() {
 }
 
 StmtPtr Parser::parseSwitchStatement() {
-    auto stmt = std::make_shared<SwitchStmt>();
+    auto stmt = node<SwitchStmt>();
     
     consume(TokenType::LPAREN, "Esperado '('");
     stmt->selector = parseExpression();
@@ -992,7 +1045,7 @@ StmtPtr Parser::parseSwitchStatement() {
     consume(TokenType::LBRACE, "Esperado '{'");
     
     while (!check(TokenType::RBRACE) && !isAtEnd()) {
-        auto caseClause = std::make_shared<CaseClause>();
+        auto caseClause = node<CaseClause>();
         
         // Labels
         while (match(TokenType::CASE) || match(TokenType::DEFAULT)) {
@@ -1017,7 +1070,7 @@ StmtPtr Parser::parseSwitchStatement() {
 }
 
 StmtPtr Parser::parseReturnStatement() {
-    auto stmt = std::make_shared<ReturnStmt>();
+    auto stmt = node<ReturnStmt>();
     
     if (!check(TokenType::SEMICOLON) && !check(TokenType::RBRACE)) {
         stmt->value = parseExpression();
@@ -1029,20 +1082,20 @@ StmtPtr Parser::parseReturnStatement() {
 }
 
 StmtPtr Parser::parseThrowStatement() {
-    auto stmt = std::make_shared<ThrowStmt>();
+    auto stmt = node<ThrowStmt>();
     stmt->exception = parseExpression();
     match(TokenType::SEMICOLON);
     return stmt;
 }
 
 StmtPtr Parser::parseTryStatement() {
-    auto stmt = std::make_shared<TryStmt>();
+    auto stmt = node<TryStmt>();
     
     stmt->tryBlock = parseBlock();
     
     // Catch clauses
     while (match(TokenType::CATCH)) {
-        auto catchClause = std::make_shared<CatchClause>();
+        auto catchClause = node<CatchClause>();
         
         consume(TokenType::LPAREN, "Esperado '('");
         
@@ -1068,7 +1121,7 @@ StmtPtr Parser::parseTryStatement() {
 }
 
 StmtPtr Parser::parseSynchronizedStatement() {
-    auto stmt = std::make_shared<SynchronizedStmt>();
+    auto stmt = node<SynchronizedStmt>();
     
     consume(TokenType::LPAREN, "Esperado '('");
     stmt->lockObject = parseExpression();
@@ -1080,7 +1133,7 @@ StmtPtr Parser::parseSynchronizedStatement() {
 }
 
 StmtPtr Parser::parseAssertStatement() {
-    auto stmt = std::make_shared<AssertStmt>();
+    auto stmt = node<AssertStmt>();
     
     stmt->condition = parseExpression();
     
@@ -1094,7 +1147,7 @@ StmtPtr Parser::parseAssertStatement() {
 }
 
 StmtPtr Parser::parseBreakStatement() {
-    auto stmt = std::make_shared<BreakStmt>();
+    auto stmt = node<BreakStmt>();
     
     if (check(TokenType::IDENTIFIER)) {
         stmt->label = advance().lexeme;
@@ -1106,7 +1159,7 @@ StmtPtr Parser::parseBreakStatement() {
 }
 
 StmtPtr Parser::parseContinueStatement() {
-    auto stmt = std::make_shared<ContinueStmt>();
+    auto stmt = node<ContinueStmt>();
     
     if (check(TokenType::IDENTIFIER)) {
         stmt->label = advance().lexeme;
@@ -1118,14 +1171,14 @@ StmtPtr Parser::parseContinueStatement() {
 }
 
 StmtPtr Parser::parsePrintStatement() {
-    auto stmt = std::make_shared<PrintStmt>();
+    auto stmt = node<PrintStmt>();
     stmt->expression = parseExpression();
     match(TokenType::SEMICOLON);
     return stmt;
 }
 
 StmtPtr Parser::parseExpressionStatement() {
-    auto stmt = std::make_shared<ExprStmt>();
+    auto stmt = node<ExprStmt>();
     stmt->expression = parseExpression();
     match(TokenType::SEMICOLON);
     return stmt;
@@ -1156,12 +1209,12 @@ ExprPtr Parser::parseAssignmentExpression() {
         ExprPtr value = parseAssignmentExpression();
         
         if (op.type == TokenType::ASSIGN) {
-            auto assign = std::make_shared<AssignExpr>();
+            auto assign = node<AssignExpr>();
             assign->target = expr;
             assign->value = value;
             return assign;
         } else {
-            auto compound = std::make_shared<CompoundAssignExpr>();
+            auto compound = node<CompoundAssignExpr>();
             compound->target = expr;
             compound->value = value;
             compound->op = getAssignmentOp();
@@ -1202,7 +1255,7 @@ ExprPtr Parser::parseTernaryExpression() {
     ExprPtr condition = parseLogicalOrExpression();
     
     if (match(TokenType::QUESTION)) {
-        auto ternary = std::make_shared<TernaryExpr>();
+        auto ternary = node<TernaryExpr>();
         ternary->condition = condition;
         ternary->thenExpr = parseExpression();
         consume(TokenType::COLON, "Esperado ':' em expressão ternária");
@@ -1217,7 +1270,7 @@ ExprPtr Parser::parseLogicalOrExpression() {
     ExprPtr left = parseLogicalAndExpression();
     
     while (match(TokenType::OR)) {
-        auto binary = std::make_shared<BinaryExpr>();
+        auto binary = node<BinaryExpr>();
         binary->op = BinaryExpr::Op::Or;
         binary->left = left;
         binary->right = parseLogicalAndExpression();
@@ -1231,7 +1284,7 @@ ExprPtr Parser::parseLogicalAndExpression() {
     ExprPtr left = parseBitwiseOrExpression();
     
     while (match(TokenType::AND)) {
-        auto binary = std::make_shared<BinaryExpr>();
+        auto binary = node<BinaryExpr>();
         binary->op = BinaryExpr::Op::And;
         binary->left = left;
         binary->right = parseBitwiseOrExpression();
@@ -1245,7 +1298,7 @@ ExprPtr Parser::parseBitwiseOrExpression() {
     ExprPtr left = parseBitwiseXorExpression();
     
     while (match(TokenType::PIPE)) {
-        auto binary = std::make_shared<BinaryExpr>();
+        auto binary = node<BinaryExpr>();
         binary->op = BinaryExpr::Op::BitOr;
         binary->left = left;
         binary->right = parseBitwiseXorExpression();
@@ -1259,7 +1312,7 @@ ExprPtr Parser::parseBitwiseXorExpression() {
     ExprPtr left = parseBitwiseAndExpression();
     
     while (match(TokenType::CARET)) {
-        auto binary = std::make_shared<BinaryExpr>();
+        auto binary = node<BinaryExpr>();
         binary->op = BinaryExpr::Op::BitXor;
         binary->left = left;
         binary->right = parseBitwiseAndExpression();
@@ -1273,7 +1326,7 @@ ExprPtr Parser::parseBitwiseAndExpression() {
     ExprPtr left = parseEqualityExpression();
     
     while (match(TokenType::AMPERSAND)) {
-        auto binary = std::make_shared<BinaryExpr>();
+        auto binary = node<BinaryExpr>();
         binary->op = BinaryExpr::Op::BitAnd;
         binary->left = left;
         binary->right = parseEqualityExpression();
@@ -1287,7 +1340,7 @@ ExprPtr Parser::parseEqualityExpression() {
     ExprPtr left = parseRelationalExpression();
     
     while (match({TokenType::EQ, TokenType::NE})) {
-        auto binary = std::make_shared<BinaryExpr>();
+        auto binary = node<BinaryExpr>();
         binary->op = previous().type == TokenType::EQ ? BinaryExpr::Op::Eq : BinaryExpr::Op::NotEq;
         binary->left = left;
         binary->right = parseRelationalExpression();
@@ -1302,7 +1355,7 @@ ExprPtr Parser::parseRelationalExpression() {
     
     while (true) {
         if (match({TokenType::LT, TokenType::LE, TokenType::GT, TokenType::GE})) {
-            auto binary = std::make_shared<BinaryExpr>();
+            auto binary = node<BinaryExpr>();
             switch (previous().type) {
                 case TokenType::LT: binary->op = BinaryExpr::Op::Lt; break;
                 case TokenType::LE: binary->op = BinaryExpr::Op::LtEq; break;
@@ -1314,7 +1367,7 @@ ExprPtr Parser::parseRelationalExpression() {
             binary->right = parseShiftExpression();
             left = binary;
         } else if (match(TokenType::INSTANCEOF)) {
-            auto instOf = std::make_shared<InstanceOfExpr>();
+            auto instOf = node<InstanceOfExpr>();
             instOf->operand = left;
             instOf->checkType = parseType();
             left = instOf;
@@ -1330,7 +1383,7 @@ ExprPtr Parser::parseShiftExpression() {
     ExprPtr left = parseAdditiveExpression();
     
     while (match({TokenType::LSHIFT, TokenType::RSHIFT, TokenType::URSHIFT})) {
-        auto binary = std::make_shared<BinaryExpr>();
+        auto binary = node<BinaryExpr>();
         switch (previous().type) {
             case TokenType::LSHIFT: binary->op = BinaryExpr::Op::LeftShift; break;
             case TokenType::RSHIFT: binary->op = BinaryExpr::Op::RightShift; break;
@@ -1349,7 +1402,7 @@ ExprPtr Parser::parseAdditiveExpression() {
     ExprPtr left = parseMultiplicativeExpression();
     
     while (match({TokenType::PLUS, TokenType::MINUS})) {
-        auto binary = std::make_shared<BinaryExpr>();
+        auto binary = node<BinaryExpr>();
         binary->op = previous().type == TokenType::PLUS ? BinaryExpr::Op::Add : BinaryExpr::Op::Sub;
         binary->left = left;
         binary->right = parseMultiplicativeExpression();
@@ -1363,7 +1416,7 @@ ExprPtr Parser::parseMultiplicativeExpression() {
     ExprPtr left = parseUnaryExpression();
     
     while (match({TokenType::STAR, TokenType::SLASH, TokenType::PERCENT})) {
-        auto binary = std::make_shared<BinaryExpr>();
+        auto binary = node<BinaryExpr>();
         switch (previous().type) {
             case TokenType::STAR: binary->op = BinaryExpr::Op::Mul; break;
             case TokenType::SLASH: binary->op = BinaryExpr::Op::Div; break;
@@ -1381,7 +1434,7 @@ ExprPtr Parser::parseMultiplicativeExpression() {
 ExprPtr Parser::parseUnaryExpression() {
     if (match({TokenType::NOT, TokenType::TILDE, TokenType::MINUS, 
                TokenType::PLUS_PLUS, TokenType::MINUS_MINUS})) {
-        auto unary = std::make_shared<UnaryExpr>();
+        auto unary = node<UnaryExpr>();
         switch (previous().type) {
             case TokenType::NOT: unary->op = UnaryExpr::Op::Not; break;
             case TokenType::TILDE: unary->op = UnaryExpr::Op::BitNot; break;
@@ -1418,7 +1471,7 @@ ExprPtr Parser::parseUnaryExpression() {
         
         if (isCast) {
             advance();  // (
-            auto cast = std::make_shared<CastExpr>();
+            auto cast = node<CastExpr>();
             cast->targetType = parseType();
             consume(TokenType::RPAREN, "Esperado ')'");
             cast->operand = parseUnaryExpression();
@@ -1434,21 +1487,38 @@ ExprPtr Parser::parsePostfixExpression() {
     
     while (true) {
         if (match(TokenType::PLUS_PLUS)) {
-            auto unary = std::make_shared<UnaryExpr>();
+            auto unary = node<UnaryExpr>();
             unary->op = UnaryExpr::Op::PostInc;
             unary->operand = expr;
             expr = unary;
         } else if (match(TokenType::MINUS_MINUS)) {
-            auto unary = std::make_shared<UnaryExpr>();
+            auto unary = node<UnaryExpr>();
             unary->op = UnaryExpr::Op::PostDec;
             unary->operand = expr;
             expr = unary;
         } else if (match(TokenType::DOT)) {
-            std::string name = consume(TokenType::IDENTIFIER, "Esperado nome do membro").lexeme;
+            // KAVA 2.5: xs.stream() / xs.parallelStream() abrem um pipeline
+            if (match(TokenType::STREAM)) {
+                consume(TokenType::LPAREN, "Esperado '(' apos stream");
+                consume(TokenType::RPAREN, "Esperado ')'");
+                expr = parseStreamExpression(expr);
+                continue;
+            }
+            std::string name(consume(TokenType::IDENTIFIER, "Esperado nome do membro").lexeme);
+            if (name == "parallelStream" && check(TokenType::LPAREN)) {
+                consume(TokenType::LPAREN, "Esperado '('");
+                consume(TokenType::RPAREN, "Esperado ')'");
+                auto stream = std::static_pointer_cast<StreamExpr>(parseStreamExpression(expr));
+                StreamExpr::StreamOp parallel;
+                parallel.kind = StreamExpr::StreamOp::Kind::Parallel;
+                stream->operations.insert(stream->operations.begin(), parallel);
+                expr = stream;
+                continue;
+            }
             if (check(TokenType::LPAREN)) {
                 expr = parseMethodCall(expr, name);
             } else {
-                auto member = std::make_shared<MemberExpr>();
+                auto member = node<MemberExpr>();
                 member->object = expr;
                 member->memberName = name;
                 expr = member;
@@ -1469,62 +1539,62 @@ ExprPtr Parser::parsePostfixExpression() {
 ExprPtr Parser::parsePrimaryExpression() {
     // Literais
     if (match(TokenType::TRUE)) {
-        auto lit = std::make_shared<LiteralExpr>();
+        auto lit = node<LiteralExpr>();
         lit->litType = LiteralExpr::LitType::Boolean;
         lit->value = "true";
         return lit;
     }
     
     if (match(TokenType::FALSE)) {
-        auto lit = std::make_shared<LiteralExpr>();
+        auto lit = node<LiteralExpr>();
         lit->litType = LiteralExpr::LitType::Boolean;
         lit->value = "false";
         return lit;
     }
     
     if (match(TokenType::NULL_LITERAL)) {
-        auto lit = std::make_shared<LiteralExpr>();
+        auto lit = node<LiteralExpr>();
         lit->litType = LiteralExpr::LitType::Null;
         return lit;
     }
     
     if (match(TokenType::INT_LITERAL)) {
-        auto lit = std::make_shared<LiteralExpr>();
+        auto lit = node<LiteralExpr>();
         lit->litType = LiteralExpr::LitType::Int;
         lit->value = previous().lexeme;
         return lit;
     }
     
     if (match(TokenType::LONG_LITERAL)) {
-        auto lit = std::make_shared<LiteralExpr>();
+        auto lit = node<LiteralExpr>();
         lit->litType = LiteralExpr::LitType::Long;
         lit->value = previous().lexeme;
         return lit;
     }
     
     if (match(TokenType::FLOAT_LITERAL)) {
-        auto lit = std::make_shared<LiteralExpr>();
+        auto lit = node<LiteralExpr>();
         lit->litType = LiteralExpr::LitType::Float;
         lit->value = previous().lexeme;
         return lit;
     }
     
     if (match(TokenType::DOUBLE_LITERAL)) {
-        auto lit = std::make_shared<LiteralExpr>();
+        auto lit = node<LiteralExpr>();
         lit->litType = LiteralExpr::LitType::Double;
         lit->value = previous().lexeme;
         return lit;
     }
     
     if (match(TokenType::CHAR_LITERAL)) {
-        auto lit = std::make_shared<LiteralExpr>();
+        auto lit = node<LiteralExpr>();
         lit->litType = LiteralExpr::LitType::Char;
         lit->value = previous().lexeme;
         return lit;
     }
     
     if (match(TokenType::STRING_LITERAL)) {
-        auto lit = std::make_shared<LiteralExpr>();
+        auto lit = node<LiteralExpr>();
         lit->litType = LiteralExpr::LitType::String;
         lit->value = previous().lexeme;
         return lit;
@@ -1535,22 +1605,22 @@ ExprPtr Parser::parsePrimaryExpression() {
         if (check(TokenType::LPAREN)) {
             return parseMethodCall(nullptr, "this");
         }
-        return std::make_shared<ThisExpr>();
+        return node<ThisExpr>();
     }
     
     if (match(TokenType::SUPER)) {
         if (check(TokenType::LPAREN)) {
             return parseMethodCall(nullptr, "super");
         }
-        auto superExpr = std::make_shared<SuperExpr>();
+        auto superExpr = node<SuperExpr>();
         if (match(TokenType::DOT)) {
-            std::string name = consume(TokenType::IDENTIFIER, "Esperado nome do membro").lexeme;
+            std::string name(consume(TokenType::IDENTIFIER, "Esperado nome do membro").lexeme);
             if (check(TokenType::LPAREN)) {
                 auto call = std::static_pointer_cast<MethodCallExpr>(parseMethodCall(superExpr, name));
                 call->isSuperCall = true;
                 return call;
             }
-            auto member = std::make_shared<MemberExpr>();
+            auto member = node<MemberExpr>();
             member->object = superExpr;
             member->memberName = name;
             return member;
@@ -1577,7 +1647,7 @@ ExprPtr Parser::parsePrimaryExpression() {
     
     // Identificador
     if (match(TokenType::IDENTIFIER)) {
-        auto id = std::make_shared<IdentifierExpr>();
+        auto id = node<IdentifierExpr>();
         id->name = previous().lexeme;
         id->isLValue = true;
         return id;
@@ -1591,7 +1661,7 @@ ExprPtr Parser::parseNewExpression() {
     
     // new Type[size] ou new Type[]{ ... }
     if (type->arrayDimensions > 0 || check(TokenType::LBRACKET)) {
-        auto newArray = std::make_shared<NewArrayExpr>();
+        auto newArray = node<NewArrayExpr>();
         newArray->elementType = type;
         
         while (match(TokenType::LBRACKET)) {
@@ -1610,7 +1680,7 @@ ExprPtr Parser::parseNewExpression() {
     }
     
     // new Type(args)
-    auto newExpr = std::make_shared<NewExpr>();
+    auto newExpr = node<NewExpr>();
     newExpr->classType = type;
     newExpr->arguments = parseArguments();
     
@@ -1627,7 +1697,7 @@ ExprPtr Parser::parseNewExpression() {
 }
 
 ExprPtr Parser::parseMethodCall(ExprPtr object, const std::string& name) {
-    auto call = std::make_shared<MethodCallExpr>();
+    auto call = node<MethodCallExpr>();
     call->object = object;
     call->methodName = name;
     call->arguments = parseArguments();
@@ -1637,7 +1707,7 @@ ExprPtr Parser::parseMethodCall(ExprPtr object, const std::string& name) {
 ExprPtr Parser::parseArrayAccess(ExprPtr array) {
     consume(TokenType::LBRACKET, "Esperado '['");
     
-    auto access = std::make_shared<ArrayAccessExpr>();
+    auto access = node<ArrayAccessExpr>();
     access->array = array;
     access->index = parseExpression();
     
@@ -1666,7 +1736,7 @@ ExprPtr Parser::parseArrayInitializer() {
     consume(TokenType::LBRACE, "Esperado '{'");
     
     // Retorna como NewArrayExpr com inicializador
-    auto newArray = std::make_shared<NewArrayExpr>();
+    auto newArray = node<NewArrayExpr>();
     
     if (!check(TokenType::RBRACE)) {
         do {
@@ -1688,7 +1758,7 @@ ExprPtr Parser::parseArrayInitializer() {
 // KAVA 2.5 - YIELD STATEMENT
 // ============================================================
 StmtPtr Parser::parseYieldStatement() {
-    auto stmt = std::make_shared<YieldStmt>();
+    auto stmt = node<YieldStmt>();
     stmt->value = parseExpression();
     match(TokenType::SEMICOLON);
     return stmt;
@@ -1732,14 +1802,14 @@ bool Parser::isLambdaAhead() {
 }
 
 ExprPtr Parser::parseLambdaExpression() {
-    auto lambda = std::make_shared<LambdaExpr>();
+    auto lambda = node<LambdaExpr>();
     
     // Parse parameters
     if (check(TokenType::IDENTIFIER) && 
         current + 1 < tokens.size() && tokens[current + 1].type == TokenType::ARROW) {
         // Single param without parens: x -> ...
         ParameterDecl param;
-        auto typeRef = std::make_shared<TypeRefNode>();
+        auto typeRef = node<TypeRefNode>();
         typeRef->name = "auto";  // Inferred
         param.type = typeRef;
         param.name = advance().lexeme;
@@ -1759,14 +1829,14 @@ ExprPtr Parser::parseLambdaExpression() {
                     } else {
                         // Was actually just a name
                         current = saved;
-                        auto typeRef = std::make_shared<TypeRefNode>();
+                        auto typeRef = node<TypeRefNode>();
                         typeRef->name = "auto";
                         param.type = typeRef;
                         param.name = consume(TokenType::IDENTIFIER, "Esperado nome do parametro").lexeme;
                     }
                 } catch (...) {
                     current = saved;
-                    auto typeRef = std::make_shared<TypeRefNode>();
+                    auto typeRef = node<TypeRefNode>();
                     typeRef->name = "auto";
                     param.type = typeRef;
                     param.name = consume(TokenType::IDENTIFIER, "Esperado nome do parametro").lexeme;
@@ -1793,41 +1863,51 @@ ExprPtr Parser::parseLambdaExpression() {
 // KAVA 2.5 - STREAM EXPRESSION
 // ============================================================
 ExprPtr Parser::parseStreamExpression(ExprPtr source) {
-    auto stream = std::make_shared<StreamExpr>();
+    static const std::map<std::string, StreamExpr::StreamOp::Kind, std::less<>> kinds = {
+        {"filter", StreamExpr::StreamOp::Kind::Filter},
+        {"map", StreamExpr::StreamOp::Kind::Map},
+        {"flatMap", StreamExpr::StreamOp::Kind::FlatMap},
+        {"reduce", StreamExpr::StreamOp::Kind::Reduce},
+        {"forEach", StreamExpr::StreamOp::Kind::ForEach},
+        {"collect", StreamExpr::StreamOp::Kind::Collect},
+        {"count", StreamExpr::StreamOp::Kind::Count},
+        {"sum", StreamExpr::StreamOp::Kind::Sum},
+        {"min", StreamExpr::StreamOp::Kind::Min},
+        {"max", StreamExpr::StreamOp::Kind::Max},
+        {"distinct", StreamExpr::StreamOp::Kind::Distinct},
+        {"sorted", StreamExpr::StreamOp::Kind::Sorted},
+        {"limit", StreamExpr::StreamOp::Kind::Limit},
+        {"skip", StreamExpr::StreamOp::Kind::Skip},
+        {"anyMatch", StreamExpr::StreamOp::Kind::AnyMatch},
+        {"allMatch", StreamExpr::StreamOp::Kind::AllMatch},
+        {"noneMatch", StreamExpr::StreamOp::Kind::NoneMatch},
+        {"findFirst", StreamExpr::StreamOp::Kind::FindFirst},
+        {"findAny", StreamExpr::StreamOp::Kind::FindAny},
+        {"toList", StreamExpr::StreamOp::Kind::ToList},
+        {"toArray", StreamExpr::StreamOp::Kind::ToArray},
+        {"parallel", StreamExpr::StreamOp::Kind::Parallel},
+    };
+    
+    auto stream = node<StreamExpr>();
     stream->source = source;
     
-    while (match(TokenType::DOT)) {
-        std::string opName = consume(TokenType::IDENTIFIER, "Esperado operacao de stream").lexeme;
-        
+    // So consome ".nome" se for operacao de stream; o resto fica para o postfix
+    while (check(TokenType::DOT) && current + 1 < tokens.size() &&
+           tokens[current + 1].type == TokenType::IDENTIFIER &&
+           kinds.count(tokens[current + 1].lexeme)) {
+        advance();
         StreamExpr::StreamOp op;
-        
-        if (opName == "filter") op.kind = StreamExpr::StreamOp::Kind::Filter;
-        else if (opName == "map") op.kind = StreamExpr::StreamOp::Kind::Map;
-        else if (opName == "flatMap") op.kind = StreamExpr::StreamOp::Kind::FlatMap;
-        else if (opName == "reduce") op.kind = StreamExpr::StreamOp::Kind::Reduce;
-        else if (opName == "forEach") op.kind = StreamExpr::StreamOp::Kind::ForEach;
-        else if (opName == "collect") op.kind = StreamExpr::StreamOp::Kind::Collect;
-        else if (opName == "count") op.kind = StreamExpr::StreamOp::Kind::Count;
-        else if (opName == "sum") op.kind = StreamExpr::StreamOp::Kind::Sum;
-        else if (opName == "min") op.kind = StreamExpr::StreamOp::Kind::Min;
-        else if (opName == "max") op.kind = StreamExpr::StreamOp::Kind::Max;
-        else if (opName == "distinct") op.kind = StreamExpr::StreamOp::Kind::Distinct;
-        else if (opName == "sorted") op.kind = StreamExpr::StreamOp::Kind::Sorted;
-        else if (opName == "limit") op.kind = StreamExpr::StreamOp::Kind::Limit;
-        else if (opName == "skip") op.kind = StreamExpr::StreamOp::Kind::Skip;
-        else if (opName == "anyMatch") op.kind = StreamExpr::StreamOp::Kind::AnyMatch;
-        else if (opName == "allMatch") op.kind = StreamExpr::StreamOp::Kind::AllMatch;
-        else if (opName == "noneMatch") op.kind = StreamExpr::StreamOp::Kind::NoneMatch;
-        else if (opName == "findFirst") op.kind = StreamExpr::StreamOp::Kind::FindFirst;
-        else if (opName == "toList") op.kind = StreamExpr::StreamOp::Kind::ToList;
-        else if (opName == "toArray") op.kind = StreamExpr::StreamOp::Kind::ToArray;
-        else break;  // Not a stream op
+        op.kind = kinds.find(advance().lexeme)->second;
         
         // Parse argument if has parens
         if (check(TokenType::LPAREN)) {
             consume(TokenType::LPAREN, "Esperado '('");
             if (!check(TokenType::RPAREN)) {
                 op.argument = parseExpression();
+                if (op.kind == StreamExpr::StreamOp::Kind::Reduce && match(TokenType::COMMA)) {
+                    op.identity = op.argument;
+                    op.argument = parseExpression();
+                }
             }
             consume(TokenType::RPAREN, "Esperado ')'");
         }
@@ -1842,7 +1922,7 @@ ExprPtr Parser::parseStreamExpression(ExprPtr source) {
 // KAVA 2.5 - PIPE EXPRESSION
 // ============================================================
 ExprPtr Parser::parsePipeExpression(ExprPtr left) {
-    auto pipe = std::make_shared<PipeExpr>();
+    auto pipe = node<PipeExpr>();
     pipe->left = left;
     pipe->right = parseTernaryExpression();
     return pipe;
@@ -1852,7 +1932,7 @@ ExprPtr Parser::parsePipeExpression(ExprPtr left) {
 // KAVA 2.5 - AWAIT EXPRESSION
 // ============================================================
 ExprPtr Parser::parseAwaitExpression() {
-    auto await = std::make_shared<AwaitExpr>();
+    auto await = node<AwaitExpr>();
     await->operand = parseUnaryExpression();
     return await;
 }
@@ -1861,7 +1941,7 @@ ExprPtr Parser::parseAwaitExpression() {
 // KAVA 2.5 - METHOD REFERENCE
 // ============================================================
 ExprPtr Parser::parseMethodReference(ExprPtr object) {
-    auto ref = std::make_shared<MethodRefExpr>();
+    auto ref = node<MethodRefExpr>();
     ref->object = object;
     ref->methodName = consume(TokenType::IDENTIFIER, "Esperado nome do metodo").lexeme;
     return ref;
@@ -35,7 +35,7 @@ struct ParseError {
 // ============================================================
 class Parser {
 public:
-    explicit Parser(const std::vector<Token>& tokens);
+    explicit Parser(std::vector<Token> tokens);
     
     std::shared_ptr<Program> parse();
     
@@ -45,6 +45,13 @@ public:
 private:
     std::vector<Token> tokens;
     size_t current = 0;
+    std::shared_ptr<AstArena> arena = std::make_shared<AstArena>();
+    
+    // Todos os nós saem da arena (ver ast.h)
+    template <typename T, typename... Args>
+    std::shared_ptr<T> node(Args&&... args) {
+        return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+    }
     std::vector<ParseError> errors;
     
     // Para controle de sincronização em caso de erro
@@ -112,6 +119,8 @@ private:
                                                         const std::vector<std::string>& typeParams,
                                                         TypeRefPtr returnType,
                                                         const std::string& name);
+    std::shared_ptr<MethodDecl> parseFunctionDeclaration(const Modifiers& mods,
+                                                          const std::vector<AnnotationPtr>& annots);
     std::shared_ptr<ConstructorDecl> parseConstructorDeclaration(const Modifiers& mods,
                                                                   const std::vector<AnnotationPtr>& annots,
                                                                   const std::string& name);
@@ -123,6 +132,7 @@ private:
     // PARSING DE STATEMENTS
     // ========================================
     StmtPtr parseStatement();
+    StmtPtr parseStatementKind();
     StmtPtr parseBlockStatement();
     std::shared_ptr<BlockStmt> parseBlock();
     StmtPtr parseLocalVariableDeclaration();
@@ -69,6 +69,7 @@ struct Modifiers {
     bool isVolatile = false;
     bool isTransient = false;
     bool isStrictfp = false;
+    bool isAsync = false;       // KAVA 2.5: fn/método async devolve uma Promise
     
     std::string toString() const {
         std::string result;
@@ -85,6 +86,7 @@ struct Modifiers {
         if (isSynchronized) result += "synchronized ";
         if (isVolatile) result += "volatile ";
         if (isTransient) result += "transient ";
+        if (isAsync) result += "async ";
         return result;
     }
 };
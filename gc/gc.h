@@ -2,8 +2,9 @@
  * MIT License
  * Copyright (c) 2026 KAVA Team
  * 
- * KAVA 2.0 - Garbage Collector Mark-Sweep
- * GC completo inspirado no Java 6 HotSpot
+ * KAVA 2.0 - Garbage Collector Generacional
+ * GC completo inspirado no Java 6 HotSpot: alocacao bump-pointer no eden,
+ * copia Cheney entre eden/survivors e promocao para a old gen por idade
  */
 
 #ifndef KAVA_GC_H
@@ -12,16 +13,23 @@
 #include <vector>
 #include <cstdint>
 #include <cstring>
+#include <cstddef>
+#include <algorithm>
 #include <mutex>
+#include <condition_variable>
 #include <atomic>
 #include <chrono>
 #include <functional>
+#include <thread>
+#include <memory>
+#include <deque>
 
 namespace Kava {
 
 // Forward declarations
 class GCObject;
 class Heap;
+class MutatorThread;
 class GarbageCollector;
 
 // ============================================================
@@ -35,7 +43,8 @@ enum GCFlags : uint8_t {
     GC_FLAG_PINNED    = 0x08,  // Não pode ser movido
     GC_FLAG_OLD_GEN   = 0x10,  // Na geração antiga
     GC_FLAG_ARRAY     = 0x20,  // É um array
-    GC_FLAG_STATIC    = 0x40   // Campo estático (root)
+    GC_FLAG_STATIC    = 0x40,  // Campo estático (root)
+    GC_FLAG_FORWARDED = 0x80   // Já copiado: bytes 0..7 guardam o novo endereço
 };
 
 // ============================================================
@@ -52,7 +61,10 @@ enum class GCObjectType : uint8_t {
     ARRAY_SHORT, // Array de short
     ARRAY_OBJECT,// Array de referências
     STRING,      // String (otimizado)
-    CLASS_INFO   // Metadados de classe
+    CLASS_INFO,  // Metadados de classe
+    FILLER,      // Espaço morto (sobra de PLAB do GC paralelo)
+    STRING_ROPE,     // Concatenação preguiçosa de duas strings (vm/text.h)
+    STRING_BUILDER   // StringBuilder: buffer byte[] + tamanho usado
 };
 
 // ============================================================
@@ -64,6 +76,7 @@ struct GCHeader {
     GCObjectType type;      // Tipo do objeto
     GCFlags flags;          // Flags do GC
     uint16_t age;           // Idade (para generational GC)
+    uint32_t lockWord;      // Monitor do objeto (threads/monitor.h); sobrevive à cópia
     
     // Métodos inline
     bool isMarked() const { return flags & GC_FLAG_MARKED; }
@@ -73,8 +86,32 @@ struct GCHeader {
     bool isArray() const { return flags & GC_FLAG_ARRAY; }
     bool isPinned() const { return flags & GC_FLAG_PINNED; }
     bool isOldGen() const { return flags & GC_FLAG_OLD_GEN; }
+    bool isForwarded() const { return flags & GC_FLAG_FORWARDED; }
+    
+    // Forwarding pointer sobrepõe classId+size (o byte de flags fica intacto)
+    GCObject* forwardee() const {
+        GCObject* to;
+        std::memcpy(&to, this, sizeof(to));
+        return to;
+    }
+    void forwardTo(GCObject* to) {
+        std::memcpy(this, &to, sizeof(to));
+        flags = static_cast<GCFlags>(flags | GC_FLAG_FORWARDED);
+    }
 };
 
+static_assert(sizeof(GCHeader) >= sizeof(void*) + 2, "forwarding pointer precisa caber antes das flags");
+static_assert(offsetof(GCHeader, flags) >= sizeof(void*), "forwarding pointer nao pode sobrescrever as flags");
+
+// Menor sobra que ainda vira FILLER (um header inteiro, alinhado a 8). Os
+// tamanhos são múltiplos de 8: uma sobra menor que isso, e não nula, não
+// teria como ser percorrida e obriga a pular para o próximo buffer.
+static constexpr size_t MIN_FILLER_SIZE = (sizeof(GCHeader) + 7) & ~static_cast<size_t>(7);
+
+inline bool unusableGap(size_t gap) {
+    return gap != 0 && gap < MIN_FILLER_SIZE;
+}
+
 // ============================================================
 // OBJETO GC BASE
 // ============================================================
@@ -108,6 +145,18 @@ public:
     int32_t arrayLength() const {
         return *reinterpret_cast<const int32_t*>(data);
     }
+    
+    // Arrays de referência, instâncias, ropes e builders começam com
+    // [int32 n][n x GCObject*] (as referências vêm antes dos primitivos)
+    bool hasReferenceSlots() const {
+        switch (header.type) {
+            case GCObjectType::ARRAY_OBJECT: case GCObjectType::INSTANCE:
+            case GCObjectType::STRING_ROPE: case GCObjectType::STRING_BUILDER:
+                return true;
+            default:
+                return false;
+        }
+    }
 };
 
 // ============================================================
@@ -117,10 +166,14 @@ struct GCStats {
     uint64_t totalCollections = 0;
     uint64_t minorCollections = 0;
     uint64_t majorCollections = 0;
+    uint64_t parallelCollections = 0;
+    uint64_t concurrentCycles = 0;
     uint64_t totalBytesCollected = 0;
     uint64_t totalObjectsCollected = 0;
-    uint64_t totalTimeMs = 0;
-    uint64_t maxPauseMs = 0;
+    double totalTimeMs = 0;          // Soma das pausas (stop-the-world)
+    double maxPauseMs = 0;
+    double concurrentMarkMs = 0;     // Marcação concorrente (fora das pausas)
+    uint64_t tlabRefills = 0;
     uint64_t currentHeapSize = 0;
     uint64_t peakHeapSize = 0;
     
@@ -128,18 +181,28 @@ struct GCStats {
         totalCollections = 0;
         minorCollections = 0;
         majorCollections = 0;
+        parallelCollections = 0;
+        concurrentCycles = 0;
         totalBytesCollected = 0;
         totalObjectsCollected = 0;
         totalTimeMs = 0;
         maxPauseMs = 0;
+        concurrentMarkMs = 0;
+        tlabRefills = 0;
     }
     
     double avgPauseMs() const {
-        return totalCollections > 0 ? 
-            static_cast<double>(totalTimeMs) / totalCollections : 0;
+        return totalCollections > 0 ? totalTimeMs / totalCollections : 0;
+    }
+    
+    void recordPause(double ms) {
+        totalCollections++;
+        totalTimeMs += ms;
+        if (ms > maxPauseMs) maxPauseMs = ms;
     }
 };
 
+
 // ============================================================
 // CONFIGURAÇÃO DO GC
 // ============================================================
@@ -151,7 +214,12 @@ struct GCConfig {
     uint16_t tenureThreshold = 15;                // Idade para promoção
     float gcTriggerRatio = 0.75f;                 // Trigger GC em 75% uso
     bool enableGenerational = true;
-    bool enableCompaction = false;               // Não implementado ainda
+    bool enableCompaction = true;                 // Full GC sempre compacta (cópia)
+    int parallelGCThreads = 0;                    // Full GC paralelo; 0 = hardware_concurrency
+    size_t parallelThreshold = 4 * 1024 * 1024;   // Heap usado por worker; abaixo disso: full GC serial
+    bool dynamicGCThreads = true;                 // Workers limitados às CPUs e ao heap usado
+    bool concurrentMark = false;                  // Marca a old gen em background (SATB)
+    size_t tlabSize = 32 * 1024;                  // Fatia do eden por thread mutadora
     bool verboseGC = false;
 };
 
@@ -159,9 +227,9 @@ struct GCConfig {
 // BLOCO DE MEMÓRIA
 // ============================================================
 struct MemoryBlock {
-    uint8_t* start;
-    uint8_t* end;
-    uint8_t* current;  // Próxima alocação
+    uint8_t* start = nullptr;
+    uint8_t* end = nullptr;
+    uint8_t* current = nullptr;  // Próxima alocação
     
     size_t capacity() const { return end - start; }
     size_t used() const { return current - start; }
@@ -169,8 +237,13 @@ struct MemoryBlock {
     
     void reset() { current = start; }
     
+    bool contains(const void* p) const {
+        const uint8_t* b = static_cast<const uint8_t*>(p);
+        return b >= start && b < end;
+    }
+    
     bool canAllocate(size_t size) const {
-        return current + size <= end;
+        return size <= available();
     }
     
     void* allocate(size_t size) {
@@ -179,69 +252,319 @@ struct MemoryBlock {
         current += size;
         return ptr;
     }
+    
+    // Bump com CAS: várias threads alocando no mesmo bloco sem lock
+    void* allocateAtomic(size_t size) {
+        uint8_t* cur = __atomic_load_n(&current, __ATOMIC_RELAXED);
+        do {
+            if (size > static_cast<size_t>(end - cur)) return nullptr;
+        } while (!__atomic_compare_exchange_n(&current, &cur, cur + size, true,
+                                              __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+        return cur;
+    }
+    
+    static MemoryBlock create(size_t size) {
+        MemoryBlock b;
+        b.start = new uint8_t[size];
+        b.end = b.start + size;
+        b.current = b.start;
+        return b;
+    }
+    
+    void release() {
+        delete[] start;
+        start = end = current = nullptr;
+    }
+};
+
+// ============================================================
+// CARD TABLE - Referências old gen -> young gen
+// ============================================================
+// Um byte por card de 512 bytes da old gen. O write barrier suja o card do
+// slot gravado e a minor GC só percorre os cards sujos. objectStart guarda,
+// para cada card, o objeto que cobre o primeiro byte do card.
+class CardTable {
+public:
+    static constexpr size_t CARD_SHIFT = 9;
+    static constexpr size_t CARD_SIZE = size_t(1) << CARD_SHIFT;
+    static constexpr uint8_t CLEAN = 0;
+    static constexpr uint8_t DIRTY = 1;
+    
+    std::vector<uint8_t> cards;
+    std::vector<uint8_t*> objectStart;
+    
+    // (Re)dimensiona para cobrir o bloco, tudo limpo
+    void reset(const MemoryBlock& block) {
+        base = block.start;
+        size_t count = (block.capacity() + CARD_SIZE - 1) >> CARD_SHIFT;
+        cards.assign(count, CLEAN);
+        objectStart.assign(count, nullptr);
+    }
+    
+    size_t index(const void* p) const {
+        return static_cast<size_t>(static_cast<const uint8_t*>(p) - base) >> CARD_SHIFT;
+    }
+    uint8_t* cardBase(size_t card) const { return base + (card << CARD_SHIFT); }
+    size_t cardsBelow(const uint8_t* limit) const {
+        return (static_cast<size_t>(limit - base) + CARD_SIZE - 1) >> CARD_SHIFT;
+    }
+    
+    // Store atômico: mutadoras diferentes podem sujar o mesmo card
+    void mark(const void* slot) { __atomic_store_n(&cards[index(slot)], DIRTY, __ATOMIC_RELAXED); }
+    bool isDirty(size_t card) const { return cards[card] == DIRTY; }
+    
+    // Chamado para cada objeto alocado (bump) na old gen
+    void recordObject(uint8_t* obj, size_t size) {
+        size_t first = index(obj);
+        if (cardBase(first) != obj) first++;
+        size_t last = index(obj + size - 1);
+        for (size_t c = first; c <= last; c++) objectStart[c] = obj;
+    }
+    
+    size_t dirtyCount() const {
+        return static_cast<size_t>(std::count(cards.begin(), cards.end(), DIRTY));
+    }
+    
+private:
+    uint8_t* base = nullptr;
+};
+
+// ============================================================
+// TLAB - Buffer de alocação por thread
+// ============================================================
+// Fatia do eden reservada para uma thread mutadora: o bump dentro dela não
+// sincroniza nada e o refill pega outra fatia com um CAS em eden.current
+// (o único ponto compartilhado: os contadores só vão para o Heap no retire).
+// A fatia chega zerada. No refill e antes de cada coleta o resto vira um
+// FILLER, para que o eden continue percorrível pelos headers.
+struct TLAB {
+    uint8_t* current = nullptr;
+    uint8_t* end = nullptr;
+    size_t objects = 0;  // Ainda não somados em Heap::objectCount
+    size_t refills = 0;  // Ainda não somados em stats.tlabRefills
+    
+    void* allocate(size_t size) {
+        size_t left = end - current;
+        // A sobra precisa comportar um filler (ver MIN_FILLER_SIZE)
+        if (size > left || unusableGap(left - size)) return nullptr;
+        void* ptr = current;
+        current += size;
+        objects++;
+        return ptr;
+    }
+};
+
+// ============================================================
+// MUTATOR THREAD - Registro de uma thread que usa o heap
+// ============================================================
+// Enquanto o objeto existir a thread aloca no próprio TLAB e participa dos
+// safepoints: quem coleta espera todas as mutadoras registradas pararem
+// (Heap::safepointPoll, alocação com refill, BlockingRegion). Threads não
+// registradas alocam direto no eden e não podem rodar durante uma coleta.
+class MutatorThread {
+public:
+    explicit MutatorThread(Heap& heap);
+    ~MutatorThread();
+    MutatorThread(const MutatorThread&) = delete;
+    MutatorThread& operator=(const MutatorThread&) = delete;
+    
+    Heap& heap;
+    TLAB tlab;
+    std::vector<GCObject*> satb;  // Valores antigos ainda não entregues ao marcador
+    
+    // Mutadora registrada pela thread atual para este heap (ou nullptr)
+    static MutatorThread* of(const Heap& heap) {
+        MutatorThread* self = current();
+        return self && &self->heap == &heap ? self : nullptr;
+    }
+    
+private:
+    MutatorThread* previous;
+    bool nested = false;  // Thread já registrada neste heap: não faz nada
+    
+    static MutatorThread*& current() {
+        static thread_local MutatorThread* self = nullptr;
+        return self;
+    }
 };
 
 // ============================================================
 // HEAP - Gerenciador de Memória
 // ============================================================
+// Objetos ficam contíguos em cada região (header.size já alinhado em 8),
+// então o heap é percorrido pelos próprios headers: não existe lista global.
 class Heap {
 public:
     GCConfig config;
+    size_t pretenureBytes = 0;  // eden.capacity() / 4 (ver pretenureLimit)
     
-    // Regiões de memória
-    MemoryBlock eden;           // Novos objetos
-    MemoryBlock survivor1;      // Survivor from
-    MemoryBlock survivor2;      // Survivor to
-    MemoryBlock oldGen;         // Objetos antigos
+    // Regiões de memória. O eden abre uma linha de cache: o CAS dos refills
+    // em eden.current não invalida config nem pretenureBytes, lidos pelas
+    // mutadoras a cada alocação
+    alignas(64) MemoryBlock eden;  // Novos objetos (bump pointer)
+    MemoryBlock survivor1;      // Survivor from: sobreviventes da última coleta
+    MemoryBlock survivor2;      // Survivor to: vazio fora da coleta
+    MemoryBlock oldGen;         // Objetos promovidos e objetos grandes
+    CardTable cards;            // Cobre oldGen
     
-    // Lista de todos os objetos (para GC simples)
-    std::vector<GCObject*> allObjects;
+    size_t objectCount = 0;     // Objetos no heap (exato logo após cada coleta)
+    size_t youngObjects = 0;    // Objetos em eden + survivor from
+    size_t pendingRequest = 0;  // Maior alocação que falhou desde a última coleta
+    std::atomic<bool> gcRequested{false};  // Coletar no próximo safepoint (allocateNoGC, fim da marcação)
+    std::atomic<bool> safepointRequested{false};  // Uma thread quer parar as mutadoras
     
     // Estatísticas
     GCStats stats;
     
     Heap() = default;
     ~Heap();
+    Heap(const Heap&) = delete;
+    Heap& operator=(const Heap&) = delete;
     
     // Inicialização
     void initialize(const GCConfig& cfg);
     
-    // Alocação
+    // Alocação: nullptr quando o eden (ou a old gen) está cheio; o chamador
+    // coleta e tenta de novo
     GCObject* allocate(uint32_t classId, GCObjectType type, size_t dataSize);
     GCObject* allocateArray(GCObjectType elemType, int32_t length);
     GCObject* allocateString(const char* str, size_t length);
     
+    // Para pontos que não podem coletar (ex.: boxing de long dentro de Value):
+    // com eden cheio aloca direto na old gen e marca gcRequested
+    GCObject* allocateArrayNoGC(GCObjectType elemType, int32_t length);
+    
+    // Safepoints: mutadoras chamam safepointPoll onde podem ser paradas (a
+    // coleta move objetos); custa uma leitura quando ninguém pediu parada
+    void safepointPoll() {
+        if (safepointRequested.load(std::memory_order_relaxed)) parkAtSafepoint();
+    }
+    
+    // Para as mutadoras registradas (menos a chamadora) e devolve os TLABs.
+    // false: outra thread parou o mundo e coletou enquanto esta esperava.
+    // Reentrante na thread que já parou o mundo.
+    bool stopTheWorld();
+    void resumeTheWorld();
+    
+    // Trecho em que a mutadora bloqueia sem tocar no heap (join, I/O, sleep):
+    // conta como parada para quem pedir um safepoint
+    class BlockingRegion {
+    public:
+        explicit BlockingRegion(Heap& heap);
+        ~BlockingRegion();
+    private:
+        Heap& heap;
+        MutatorThread* self;
+    };
+    
     // Helpers
     size_t totalUsed() const;
     size_t totalCapacity() const;
     float usageRatio() const;
     
     bool needsGC() const {
-        return usageRatio() >= config.gcTriggerRatio;
+        return gcRequested || usageRatio() >= config.gcTriggerRatio;
+    }
+    
+    bool inYoung(const void* p) const {
+        return eden.contains(p) || survivor1.contains(p);
+    }
+    size_t youngUsed() const { return eden.used() + survivor1.used(); }
+    size_t youngCapacity() const {
+        return eden.capacity() + survivor1.capacity() + survivor2.capacity();
+    }
+    
+    // Objetos maiores que isso nascem direto na old gen
+    size_t pretenureLimit() const { return pretenureBytes; }
+    
+    // Objetos da old gen em ordem de endereço (sem os fillers). Logo após um
+    // full GC são exatamente os objetos vivos
+    template<typename F>
+    void forEachOldObject(F&& visit) const {
+        for (uint8_t* p = oldGen.start; p < oldGen.current; ) {
+            GCObject* obj = reinterpret_cast<GCObject*>(p);
+            p += obj->header.size;
+            if (obj->header.type != GCObjectType::FILLER) visit(obj);
+        }
     }
     
+    static size_t objectSize(size_t dataSize) {
+        return (sizeof(GCHeader) + dataSize + 7) & ~static_cast<size_t>(7);
+    }
+    static size_t arrayDataSize(GCObjectType elemType, int32_t length);
+    
 private:
+    friend class GarbageCollector;
+    friend class MutatorThread;
+    
+    std::mutex allocLock;           // Caminho lento: old gen e pendingRequest
+    std::mutex safepointLock;
+    std::condition_variable safepointCv;
+    std::vector<MutatorThread*> mutators;
+    size_t runningMutators = 0;     // Registradas e fora de safepoint
+    std::thread::id worldOwner;
+    int worldDepth = 0;
+    std::vector<GCObject*> orphanSatb;  // Buffers SATB de mutadoras que saíram
+    
+    void parkAtSafepoint();
+    void* allocateInTLAB(size_t size, bool noGC);
+    bool refillTLAB(TLAB& tlab);
+    void retireTLAB(TLAB& tlab);
+    static void formatFiller(uint8_t* p, size_t size, GCFlags flags);
+    
+    GCObject* allocateObject(uint32_t classId, GCObjectType type, size_t dataSize, bool noGC);
+    GCObject* allocateArrayObject(GCObjectType elemType, int32_t length, bool noGC);
     void* allocateInEden(size_t size);
     void* allocateInOldGen(size_t size);
-    void expandHeap();
 };
 
 // ============================================================
-// GARBAGE COLLECTOR - Mark-Sweep com Generational
+// GARBAGE COLLECTOR - Cópia Cheney com Generational
 // ============================================================
+// Minor GC: copia os vivos de eden + survivor from para survivor to (idade+1);
+// idade >= tenureThreshold ou survivor to cheio -> promoção para a old gen.
+// Full GC: copia tudo que está vivo para uma old gen nova (compacta e cresce),
+// em paralelo quando há um WorkerRunner e cada worker tem ao menos
+// parallelThreshold bytes para copiar.
+// Com concurrentMark a old gen é marcada em background (SATB) e o ciclo
+// termina com uma pausa de compactação que não precisa percorrer o grafo.
+// Referências da old gen para a young gen vêm da card table: toda gravação de
+// referência passa por writeBarrier e a minor GC só percorre os cards sujos.
 class GarbageCollector {
 public:
     using RootVisitor = std::function<void(GCObject*&)>;
+    using RootScanner = std::function<void(const RootVisitor&)>;
+    // Executa body(0 .. workers-1) em paralelo e só retorna quando todos
+    // terminam; body(0) roda na thread chamadora
+    using WorkerRunner = std::function<void(int workers, const std::function<void(int)>& body)>;
     
     GarbageCollector(Heap& heap);
+    ~GarbageCollector();
+    GarbageCollector(const GarbageCollector&) = delete;
+    GarbageCollector& operator=(const GarbageCollector&) = delete;
     
     // Coleta de lixo
-    void collect();
+    void collect();         // Minor; Major quando a old gen não comporta a promoção
     void collectYoung();    // Minor GC
     void collectFull();     // Major GC
     
-    // Registra callbacks para encontrar roots
-    void setRootScanner(RootVisitor scanner) { rootScanner = scanner; }
+    // Callback que visita (e atualiza) cada referência raiz da VM
+    void setRootScanner(RootScanner scanner) { rootScanner = std::move(scanner); }
+    
+    // Threads do full GC paralelo (sem runner tudo é serial)
+    void setWorkerRunner(WorkerRunner runner) { workerRunner = std::move(runner); }
+    
+    // Avisado no fim de cada pausa stop-the-world ("minor", "full" ou
+    // "remark", duração em ms), na thread que coletou
+    using PauseListener = std::function<void(const char* kind, double ms)>;
+    void setPauseListener(PauseListener listener) { pauseListener = std::move(listener); }
+    
+    // Chamado no fim do full GC com o mundo ainda parado, quando
+    // Heap::forEachOldObject percorre só os vivos (recursos presos a objetos
+    // mortos, ex.: monitores inflados)
+    using FullGCListener = std::function<void()>;
+    void setFullGCListener(FullGCListener listener) { fullGCListener = std::move(listener); }
+    int parallelWorkers() const;
     
     // Adiciona root manual (para variáveis globais, etc)
     void addRoot(GCObject** root);
@@ -253,30 +576,122 @@ public:
     // Forçar GC
     void forceGC() { collect(); }
     
-    // Write barrier para generational GC
-    void writeBarrier(GCObject* parent, GCObject* child);
+    // Barreira SATB: chamar com o valor antigo do slot antes de sobrescrevê-lo
+    void preWriteBarrier(GCObject* previous) {
+        if (previous && marker.active.load(std::memory_order_relaxed)) satbEnqueue(previous);
+    }
+    
+    // Write barrier para generational GC: chamar depois de gravar child em
+    // *slot (um campo de referência dentro de parent)
+    void writeBarrier(GCObject* parent, GCObject** slot, GCObject* child) {
+        if (child && parent->header.isOldGen() && heap.inYoung(child)) {
+            heap.cards.mark(slot);
+        }
+    }
+    
+    bool concurrentMarkActive() const { return marker.active.load(std::memory_order_relaxed); }
     
 private:
     Heap& heap;
-    RootVisitor rootScanner;
+    RootScanner rootScanner;
+    PauseListener pauseListener;
+    FullGCListener fullGCListener;
     std::vector<GCObject**> roots;
-    std::vector<GCObject*> rememberedSet;  // Old -> Young refs
     
-    // Fases do GC
-    void markPhase();
-    void sweepPhase();
-    void mark(GCObject* obj);
-    void scanObject(GCObject* obj);
+    // Estado da coleta em andamento
+    bool fullCollection = false;
+    MemoryBlock fullTarget;     // Destino do full GC
+    size_t copiedObjects = 0;
+    size_t survivorObjects = 0;
+    
+    GCObject* evacuate(GCObject* obj);
+    GCObject* copyTo(GCObject* obj, void* dst);
+    void visitRoots(const RootVisitor& visit);
+    void scanObject(GCObject* obj, const uint8_t* lo = nullptr, const uint8_t* hi = nullptr);
+    void scanRegion(uint8_t*& scan, const MemoryBlock& block);
+    void scanDirtyCards(const uint8_t* limit);
+    bool canPromoteAll() const;
+    void finishCollection(size_t usedBefore, size_t objectsBefore);
+    size_t grownOldCapacity(size_t live) const;
+    
+    // ---- Full GC paralelo ----
+    static constexpr size_t PLAB_SIZE = 32 * 1024;
+    static constexpr int32_t SCAN_CHUNK = 4096;  // Arrays maiores viram várias tarefas
+    
+    struct ScanTask {
+        GCObject* obj;
+        int32_t from;
+        int32_t to;
+    };
     
-    // Para generational
-    void minorMark();
-    void minorSweep();
-    void promoteToOldGen(GCObject* obj);
+    struct alignas(64) Worker {
+        std::deque<ScanTask> local;         // Fila privada (FIFO: mesma ordem da varredura de Cheney)
+        std::mutex stealLock;
+        std::deque<ScanTask> shared;        // Metade publicada para roubo
+        std::atomic<size_t> sharedSize{0};
+        uint8_t* plabCur = nullptr;
+        uint8_t* plabEnd = nullptr;
+        size_t copied = 0;
+    };
+    
+    WorkerRunner workerRunner;
+    std::vector<std::unique_ptr<Worker>> workers;
+    int activeWorkers = 1;
+    std::atomic<int> idleWorkers{0};
+    
+    void collectFullParallel(int n);
+    GCObject* parEvacuate(Worker& w, GCObject* obj);
+    void* plabAllocate(Worker& w, size_t size);
+    void retirePLAB(Worker& w);
+    void pushScan(Worker& w, GCObject* obj);
+    void parallelDrain(Worker& w);
+    bool steal(Worker& self);
+    void publish(Worker& w);
+    bool anySharedWork() const;
+    void writeFiller(uint8_t* p, size_t size);
+    
+    // ---- Marcação concorrente (SATB) ----
+    struct ConcurrentMark {
+        std::thread thread;
+        std::atomic<bool> active{false};   // Barreira SATB ligada: initial mark .. remark
+        std::atomic<bool> done{false};     // Fila cinza e buffers SATB esgotados
+        std::atomic<bool> abort{false};
+        uint8_t* base = nullptr;
+        uint8_t* tams = nullptr;           // Top-at-mark-start: acima disso tudo é vivo
+        std::vector<uint64_t> bitmap;      // 1 bit por palavra de 8 bytes em [base, tams)
+        std::vector<GCObject*> gray;
+        std::mutex satbLock;
+        std::vector<GCObject*> satbShared; // Buffers cheios das mutadoras
+        std::chrono::high_resolution_clock::time_point startTime;
+    };
+    ConcurrentMark marker;
+    
+    void clearSatbBuffers();
+    
+    void maybeStartConcurrentMark();
+    void concurrentMarkLoop();
+    void finishConcurrentMark();
+    void abortConcurrentMark();
+    void satbEnqueue(GCObject* previous);
+    void markGray(GCObject* obj);
+    bool isMarked(const GCObject* obj) const;
+    void traceGray(const GCObject* obj);
+    void compactMarkedOldGen();
+    
+    // Pausa: mutadoras registradas ficam paradas durante o escopo
+    struct WorldStop {
+        Heap& heap;
+        const bool owner;  // false: outra thread coletou enquanto esta esperava
+        explicit WorldStop(Heap& h) : heap(h), owner(h.stopTheWorld()) {}
+        ~WorldStop() { if (owner) heap.resumeTheWorld(); }
+    };
+    std::mutex rootsLock;
     
     // Timing
     std::chrono::high_resolution_clock::time_point gcStartTime;
     void startTiming();
-    uint64_t endTiming();
+    double endTiming();
+    void recordPause(const char* kind);
 };
 
 // ============================================================
@@ -285,13 +700,10 @@ private:
 
 inline Heap::~Heap() {
     // Libera memória das regiões
-    if (eden.start) delete[] eden.start;
-    if (survivor1.start) delete[] survivor1.start;
-    if (survivor2.start) delete[] survivor2.start;
-    if (oldGen.start) delete[] oldGen.start;
-    
-    // Limpa lista de objetos (não deleta, já foram liberados acima)
-    allObjects.clear();
+    eden.release();
+    survivor1.release();
+    survivor2.release();
+    oldGen.release();
 }
 
 inline void Heap::initialize(const GCConfig& cfg) {
@@ -304,57 +716,69 @@ inline void Heap::initialize(const GCConfig& cfg) {
         size_t survivorSize = youngSize / config.survivorRatio;
         size_t oldSize = config.initialHeapSize - youngSize;
         
-        eden.start = new uint8_t[edenSize];
-        eden.end = eden.start + edenSize;
-        eden.current = eden.start;
-        
-        survivor1.start = new uint8_t[survivorSize];
-        survivor1.end = survivor1.start + survivorSize;
-        survivor1.current = survivor1.start;
-        
-        survivor2.start = new uint8_t[survivorSize];
-        survivor2.end = survivor2.start + survivorSize;
-        survivor2.current = survivor2.start;
-        
-        oldGen.start = new uint8_t[oldSize];
-        oldGen.end = oldGen.start + oldSize;
-        oldGen.current = oldGen.start;
+        eden = MemoryBlock::create(edenSize);
+        survivor1 = MemoryBlock::create(survivorSize);
+        survivor2 = MemoryBlock::create(survivorSize);
+        oldGen = MemoryBlock::create(oldSize);
     } else {
         // Heap simples
-        oldGen.start = new uint8_t[config.initialHeapSize];
-        oldGen.end = oldGen.start + config.initialHeapSize;
-        oldGen.current = oldGen.start;
+        oldGen = MemoryBlock::create(config.initialHeapSize);
     }
+    cards.reset(oldGen);
+    pretenureBytes = eden.capacity() / 4;
+    config.tlabSize = std::max<size_t>(config.tlabSize & ~static_cast<size_t>(7), 1024);
     
     stats.currentHeapSize = config.initialHeapSize;
     stats.peakHeapSize = config.initialHeapSize;
 }
 
-inline GCObject* Heap::allocate(uint32_t classId, GCObjectType type, size_t dataSize) {
-    size_t totalSize = sizeof(GCHeader) + dataSize;
-    totalSize = (totalSize + 7) & ~7;  // Alinha em 8 bytes
+inline GCObject* Heap::allocateObject(uint32_t classId, GCObjectType type, size_t dataSize, bool noGC) {
+    size_t totalSize = objectSize(dataSize);
+    bool young = config.enableGenerational && totalSize <= pretenureLimit();
     
-    void* ptr = config.enableGenerational ? 
-        allocateInEden(totalSize) : allocateInOldGen(totalSize);
+    // TLAB (já zerado, contado no retire) -> eden compartilhado -> old gen
+    void* ptr = young ? allocateInTLAB(totalSize, noGC) : nullptr;
+    const bool fromTLAB = ptr != nullptr;
+    GCFlags flags = GC_FLAG_NONE;
+    if (!ptr && young) {
+        ptr = allocateInEden(totalSize);
+        if (ptr) __atomic_fetch_add(&youngObjects, 1, __ATOMIC_RELAXED);
+    }
+    if (!ptr && (!young || noGC)) {
+        std::lock_guard<std::mutex> lock(allocLock);
+        ptr = allocateInOldGen(totalSize);
+        flags = GC_FLAG_OLD_GEN;
+        if (ptr && young) gcRequested = true;
+    }
     
-    if (!ptr) return nullptr;
+    if (!ptr) {
+        std::lock_guard<std::mutex> lock(allocLock);
+        pendingRequest = std::max(pendingRequest, totalSize);
+        if (noGC) gcRequested = true;
+        return nullptr;
+    }
     
     GCObject* obj = static_cast<GCObject*>(ptr);
     obj->header.classId = classId;
-    obj->header.size = totalSize;
+    obj->header.size = static_cast<uint32_t>(totalSize);
     obj->header.type = type;
-    obj->header.flags = GC_FLAG_NONE;
+    obj->header.flags = flags;
     obj->header.age = 0;
+    obj->header.lockWord = 0;
     
-    // Zero-initialize data
-    std::memset(obj->data, 0, dataSize);
-    
-    allObjects.push_back(obj);
-    
+    if (!fromTLAB) {
+        // Zero-initialize data
+        std::memset(obj->data, 0, totalSize - sizeof(GCHeader));
+        __atomic_fetch_add(&objectCount, 1, __ATOMIC_RELAXED);
+    }
     return obj;
 }
 
-inline GCObject* Heap::allocateArray(GCObjectType elemType, int32_t length) {
+inline GCObject* Heap::allocate(uint32_t classId, GCObjectType type, size_t dataSize) {
+    return allocateObject(classId, type, dataSize, false);
+}
+
+inline size_t Heap::arrayDataSize(GCObjectType elemType, int32_t length) {
     size_t elemSize = 4;  // Default int
     switch (elemType) {
         case GCObjectType::ARRAY_BYTE: elemSize = 1; break;
@@ -362,12 +786,14 @@ inline GCObject* Heap::allocateArray(GCObjectType elemType, int32_t length) {
         case GCObjectType::ARRAY_CHAR: elemSize = 2; break;
         case GCObjectType::ARRAY_LONG:
         case GCObjectType::ARRAY_DOUBLE: elemSize = 8; break;
+        case GCObjectType::ARRAY_OBJECT: elemSize = sizeof(GCObject*); break;
         default: elemSize = 4; break;
     }
-    
-    size_t dataSize = sizeof(int32_t) + length * elemSize;  // length + elements
-    
-    GCObject* obj = allocate(0, elemType, dataSize);
+    return sizeof(int32_t) + static_cast<size_t>(length < 0 ? 0 : length) * elemSize;  // length + elements
+}
+
+inline GCObject* Heap::allocateArrayObject(GCObjectType elemType, int32_t length, bool noGC) {
+    GCObject* obj = allocateObject(0, elemType, arrayDataSize(elemType, length), noGC);
     if (obj) {
         obj->header.flags = static_cast<GCFlags>(obj->header.flags | GC_FLAG_ARRAY);
         *reinterpret_cast<int32_t*>(obj->data) = length;
@@ -376,14 +802,24 @@ inline GCObject* Heap::allocateArray(GCObjectType elemType, int32_t length) {
     return obj;
 }
 
+inline GCObject* Heap::allocateArray(GCObjectType elemType, int32_t length) {
+    return allocateArrayObject(elemType, length, false);
+}
+
+inline GCObject* Heap::allocateArrayNoGC(GCObjectType elemType, int32_t length) {
+    return allocateArrayObject(elemType, length, true);
+}
+
 inline GCObject* Heap::allocateString(const char* str, size_t length) {
-    // String = length (int32) + char data + null terminator
+    // String = length (int32) + char data + null terminator; o classId
+    // (0 aqui) guarda o hash em cache das strings (vm/text.h).
+    // str null: bytes zerados, para o chamador preencher.
     size_t dataSize = sizeof(int32_t) + length + 1;
     
     GCObject* obj = allocate(0, GCObjectType::STRING, dataSize);
     if (obj) {
         *reinterpret_cast<int32_t*>(obj->data) = static_cast<int32_t>(length);
-        std::memcpy(obj->data + sizeof(int32_t), str, length);
+        if (str) std::memcpy(obj->data + sizeof(int32_t), str, length);
         obj->data[sizeof(int32_t) + length] = '\0';
     }
     
@@ -391,36 +827,159 @@ inline GCObject* Heap::allocateString(const char* str, size_t length) {
 }
 
 inline void* Heap::allocateInEden(size_t size) {
-    if (eden.canAllocate(size)) {
-        return eden.allocate(size);
+    // Eden cheio -> nullptr, precisa de GC
+    return eden.allocateAtomic(size);
+}
+
+inline void* Heap::allocateInTLAB(size_t size, bool noGC) {
+    MutatorThread* self = MutatorThread::of(*this);
+    if (!self) return nullptr;
+    if (void* ptr = self->tlab.allocate(size)) return ptr;
+    
+    // Objetos grandes não desperdiçam TLAB: vão direto para o eden
+    if (size > config.tlabSize / 8) return nullptr;
+    if (!noGC) safepointPoll();
+    if (!refillTLAB(self->tlab)) return nullptr;
+    return self->tlab.allocate(size);
+}
+
+// Só o CAS em eden.current: os contadores seguem no TLAB até o retire, que
+// acontece no safepoint (antes de qualquer leitura pela coleta) ou na saída
+inline bool Heap::refillTLAB(TLAB& tlab) {
+    if (tlab.current < tlab.end) formatFiller(tlab.current, tlab.end - tlab.current, GC_FLAG_NONE);
+    tlab.current = tlab.end = nullptr;
+    uint8_t* chunk = static_cast<uint8_t*>(eden.allocateAtomic(config.tlabSize));
+    if (!chunk) return false;
+    // Zerado em bloco: a alocação dentro do TLAB só escreve o header
+    std::memset(chunk, 0, config.tlabSize);
+    tlab.current = chunk;
+    tlab.end = chunk + config.tlabSize;
+    tlab.refills++;
+    return true;
+}
+
+inline void Heap::retireTLAB(TLAB& tlab) {
+    if (tlab.current < tlab.end) formatFiller(tlab.current, tlab.end - tlab.current, GC_FLAG_NONE);
+    __atomic_fetch_add(&objectCount, tlab.objects, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&youngObjects, tlab.objects, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats.tlabRefills, tlab.refills, __ATOMIC_RELAXED);
+    tlab = TLAB();
+}
+
+inline void Heap::formatFiller(uint8_t* p, size_t size, GCFlags flags) {
+    GCObject* filler = reinterpret_cast<GCObject*>(p);
+    filler->header.classId = 0;
+    filler->header.size = static_cast<uint32_t>(size);
+    filler->header.type = GCObjectType::FILLER;
+    filler->header.flags = flags;
+    filler->header.age = 0;
+    filler->header.lockWord = 0;
+}
+
+// ============================================================
+// SAFEPOINTS
+// ============================================================
+// A thread que coleta marca safepointRequested e espera runningMutators
+// chegar a zero; cada mutadora, no próximo poll, decrementa o contador e
+// dorme até o pedido ser retirado. Tudo sob safepointLock.
+inline void Heap::parkAtSafepoint() {
+    if (!MutatorThread::of(*this)) return;  // Não registrada: fora do protocolo
+    std::unique_lock<std::mutex> lock(safepointLock);
+    if (!safepointRequested || worldOwner == std::this_thread::get_id()) return;
+    runningMutators--;
+    safepointCv.notify_all();
+    safepointCv.wait(lock, [this] { return !safepointRequested; });
+    runningMutators++;
+}
+
+inline bool Heap::stopTheWorld() {
+    std::unique_lock<std::mutex> lock(safepointLock);
+    const std::thread::id me = std::this_thread::get_id();
+    if (worldDepth > 0 && worldOwner == me) {
+        worldDepth++;
+        return true;
     }
-    // Eden cheio - precisa de GC
-    return nullptr;
+    
+    const bool registered = MutatorThread::of(*this) != nullptr;
+    if (registered) {
+        runningMutators--;
+        safepointCv.notify_all();
+    }
+    if (safepointRequested) {
+        // Outra thread já está coletando: espera como se fosse um safepoint
+        safepointCv.wait(lock, [this] { return !safepointRequested; });
+        if (registered) runningMutators++;
+        return false;
+    }
+    
+    safepointRequested = true;
+    worldOwner = me;
+    worldDepth = 1;
+    safepointCv.wait(lock, [this] { return runningMutators == 0; });
+    for (MutatorThread* m : mutators) retireTLAB(m->tlab);
+    return true;
 }
 
-inline void* Heap::allocateInOldGen(size_t size) {
-    if (oldGen.canAllocate(size)) {
-        return oldGen.allocate(size);
+inline void Heap::resumeTheWorld() {
+    std::lock_guard<std::mutex> lock(safepointLock);
+    if (--worldDepth > 0) return;
+    worldOwner = std::thread::id();
+    safepointRequested = false;
+    if (MutatorThread::of(*this)) runningMutators++;
+    safepointCv.notify_all();
+}
+
+inline Heap::BlockingRegion::BlockingRegion(Heap& h) : heap(h), self(MutatorThread::of(h)) {
+    if (!self) return;
+    std::lock_guard<std::mutex> lock(heap.safepointLock);
+    heap.runningMutators--;
+    heap.safepointCv.notify_all();
+}
+
+inline Heap::BlockingRegion::~BlockingRegion() {
+    if (!self) return;
+    // Não volta a tocar no heap no meio de uma coleta
+    std::unique_lock<std::mutex> lock(heap.safepointLock);
+    heap.safepointCv.wait(lock, [this] { return !heap.safepointRequested; });
+    heap.runningMutators++;
+}
+
+inline MutatorThread::MutatorThread(Heap& h) : heap(h), previous(current()) {
+    if (of(heap)) {
+        nested = true;
+        return;
     }
-    // Old gen cheio
-    return nullptr;
+    std::unique_lock<std::mutex> lock(heap.safepointLock);
+    heap.safepointCv.wait(lock, [this] { return !heap.safepointRequested; });
+    heap.mutators.push_back(this);
+    heap.runningMutators++;
+    current() = this;
+}
+
+inline MutatorThread::~MutatorThread() {
+    if (nested) return;
+    std::lock_guard<std::mutex> lock(heap.safepointLock);
+    heap.retireTLAB(tlab);
+    heap.orphanSatb.insert(heap.orphanSatb.end(), satb.begin(), satb.end());
+    heap.mutators.erase(std::find(heap.mutators.begin(), heap.mutators.end(), this));
+    heap.runningMutators--;
+    heap.safepointCv.notify_all();
+    current() = previous;
+}
+
+inline void* Heap::allocateInOldGen(size_t size) {
+    // Old gen cheio -> nullptr, precisa de full GC
+    void* ptr = oldGen.allocate(size);
+    if (ptr) cards.recordObject(static_cast<uint8_t*>(ptr), size);
+    return ptr;
 }
 
 inline size_t Heap::totalUsed() const {
-    size_t used = 0;
-    if (eden.start) used += eden.used();
-    if (survivor1.start) used += survivor1.used();
-    if (oldGen.start) used += oldGen.used();
-    return used;
+    return eden.used() + survivor1.used() + oldGen.used();
 }
 
 inline size_t Heap::totalCapacity() const {
-    size_t cap = 0;
-    if (eden.start) cap += eden.capacity();
-    if (survivor1.start) cap += survivor1.capacity();
-    if (survivor2.start) cap += survivor2.capacity();
-    if (oldGen.start) cap += oldGen.capacity();
-    return cap;
+    return eden.capacity() + survivor1.capacity() + survivor2.capacity() + oldGen.capacity();
 }
 
 inline float Heap::usageRatio() const {
@@ -434,182 +993,687 @@ inline float Heap::usageRatio() const {
 
 inline GarbageCollector::GarbageCollector(Heap& h) : heap(h) {}
 
+inline GarbageCollector::~GarbageCollector() {
+    abortConcurrentMark();
+}
+
 inline void GarbageCollector::startTiming() {
     gcStartTime = std::chrono::high_resolution_clock::now();
 }
 
-inline uint64_t GarbageCollector::endTiming() {
+inline double GarbageCollector::endTiming() {
     auto end = std::chrono::high_resolution_clock::now();
-    return std::chrono::duration_cast<std::chrono::milliseconds>(
-        end - gcStartTime).count();
+    return std::chrono::duration<double, std::milli>(end - gcStartTime).count();
+}
+
+inline void GarbageCollector::recordPause(const char* kind) {
+    const double ms = endTiming();
+    heap.stats.recordPause(ms);
+    if (pauseListener) pauseListener(kind, ms);
+}
+
+inline bool GarbageCollector::canPromoteAll() const {
+    // Pior caso da minor GC: tudo que está na young gen é promovido
+    return heap.oldGen.available() >= heap.youngUsed() + heap.pendingRequest;
 }
 
 inline void GarbageCollector::collect() {
-    if (heap.config.enableGenerational) {
+    WorldStop stop(heap);
+    if (!stop.owner) return;
+    
+    // Marcação concorrente concluída: remark + compactação antes da minor
+    if (marker.active.load() && marker.done.load()) finishConcurrentMark();
+    
+    if (heap.config.enableGenerational && !canPromoteAll() && marker.active.load()) {
+        // Old gen sem espaço: termina o ciclo concorrente em vez de descartá-lo
+        finishConcurrentMark();
+    }
+    if (heap.config.enableGenerational && canPromoteAll()) {
         collectYoung();
-        if (heap.oldGen.used() > heap.oldGen.capacity() * 0.75) {
-            collectFull();
-        }
     } else {
         collectFull();
     }
 }
 
 inline void GarbageCollector::collectYoung() {
+    WorldStop stop(heap);
+    if (!stop.owner) return;
+    if (!heap.config.enableGenerational || !canPromoteAll()) {
+        collectFull();
+        return;
+    }
     startTiming();
+    const size_t usedBefore = heap.totalUsed();
+    const size_t objectsBefore = heap.objectCount;
+    const size_t youngBefore = heap.youngObjects;
+    
+    fullCollection = false;
+    copiedObjects = 0;
+    survivorObjects = 0;
+    heap.survivor2.reset();
+    uint8_t* toScan = heap.survivor2.start;
+    uint8_t* oldScan = heap.oldGen.current;
+    
+    visitRoots([this](GCObject*& ref) { ref = evacuate(ref); });
+    
+    // Old -> Young: só os cards sujos da old gen anterior a esta coleta
+    scanDirtyCards(oldScan);
+    
+    // Cheney: survivor to e a área promovida funcionam como filas
+    while (toScan < heap.survivor2.current || oldScan < heap.oldGen.current) {
+        scanRegion(toScan, heap.survivor2);
+        scanRegion(oldScan, heap.oldGen);
+    }
+    
+    heap.eden.reset();
+    heap.survivor1.reset();
+    std::swap(heap.survivor1, heap.survivor2);
+    
+    heap.objectCount = objectsBefore - youngBefore + copiedObjects;
+    heap.youngObjects = survivorObjects;
+    finishCollection(usedBefore, objectsBefore);
     
-    // Minor collection
-    minorMark();
-    minorSweep();
+    // Initial mark roda dentro desta pausa: a young gen acabou de ser esvaziada
+    maybeStartConcurrentMark();
     
-    uint64_t elapsed = endTiming();
     heap.stats.minorCollections++;
-    heap.stats.totalCollections++;
-    heap.stats.totalTimeMs += elapsed;
-    if (elapsed > heap.stats.maxPauseMs) {
-        heap.stats.maxPauseMs = elapsed;
+    recordPause("minor");
+}
+
+inline size_t GarbageCollector::grownOldCapacity(size_t live) const {
+    // Comporta `live` e ainda uma promoção completa da young gen depois;
+    // cresce além disso só até maxHeapSize
+    size_t capacity = std::max(heap.oldGen.capacity(), live + heap.youngCapacity());
+    size_t budget = heap.config.maxHeapSize > heap.youngCapacity() ?
+        heap.config.maxHeapSize - heap.youngCapacity() : 0;
+    if (capacity > budget) capacity = std::max({budget, heap.oldGen.capacity(), live});
+    return capacity;
+}
+
+inline int GarbageCollector::parallelWorkers() const {
+    if (!workerRunner) return 1;
+    const int cpus = static_cast<int>(std::thread::hardware_concurrency());
+    int n = heap.config.parallelGCThreads;
+    if (n <= 0) n = cpus;
+    if (heap.config.dynamicGCThreads) {
+        // Um worker copia ~30% mais devagar que o Cheney serial (CAS no header,
+        // fila de tarefas): só compensa com uma CPU para cada um e trabalho
+        // suficiente. Dois workers numa CPU só: ~1,5x a pausa serial.
+        if (cpus > 0) n = std::min(n, cpus);
+        n = static_cast<int>(std::min<size_t>(n, heap.totalUsed() / std::max<size_t>(1, heap.config.parallelThreshold)));
     }
+    return std::max(1, n);
 }
 
 inline void GarbageCollector::collectFull() {
+    WorldStop stop(heap);
+    if (!stop.owner) return;
+    abortConcurrentMark();
     startTiming();
+    const size_t usedBefore = heap.totalUsed();
+    const size_t objectsBefore = heap.objectCount;
     
-    markPhase();
-    sweepPhase();
+    // Destino comporta o pior caso: tudo vivo
+    size_t worstCase = heap.totalUsed() + heap.pendingRequest;
+    size_t capacity = grownOldCapacity(worstCase);
+    const int n = parallelWorkers();
+    const bool parallel = n > 1 && heap.totalUsed() >= heap.config.parallelThreshold;
+    if (parallel) {
+        // Sobras de PLAB: no máximo 1/16 por PLAB mais o último de cada worker
+        capacity += worstCase / 16 + static_cast<size_t>(n) * PLAB_SIZE * 2;
+    }
     
-    uint64_t elapsed = endTiming();
-    heap.stats.majorCollections++;
-    heap.stats.totalCollections++;
-    heap.stats.totalTimeMs += elapsed;
-    if (elapsed > heap.stats.maxPauseMs) {
-        heap.stats.maxPauseMs = elapsed;
+    fullCollection = true;
+    copiedObjects = 0;
+    fullTarget = MemoryBlock::create(capacity);
+    heap.cards.reset(fullTarget);  // Sem young gen depois do full GC: tudo limpo
+    
+    if (parallel) {
+        collectFullParallel(n);
+        heap.stats.parallelCollections++;
+    } else {
+        uint8_t* scan = fullTarget.start;
+        visitRoots([this](GCObject*& ref) { ref = evacuate(ref); });
+        scanRegion(scan, fullTarget);
     }
     
+    heap.oldGen.release();
+    heap.oldGen = fullTarget;
+    fullTarget = MemoryBlock();
+    heap.eden.reset();
+    heap.survivor1.reset();
+    heap.survivor2.reset();
+    fullCollection = false;
+    
+    heap.objectCount = copiedObjects;
+    heap.youngObjects = 0;
+    finishCollection(usedBefore, objectsBefore);
+    
+    heap.stats.majorCollections++;
+    if (fullGCListener) fullGCListener();
+    recordPause("full");
+    
     if (heap.config.verboseGC) {
         // Log GC info
     }
 }
 
-inline void GarbageCollector::markPhase() {
-    // Desmarca todos os objetos
-    for (auto* obj : heap.allObjects) {
-        if (obj) obj->header.unmark();
+inline void GarbageCollector::finishCollection(size_t usedBefore, size_t objectsBefore) {
+    size_t usedAfter = heap.totalUsed();
+    if (usedBefore > usedAfter) heap.stats.totalBytesCollected += usedBefore - usedAfter;
+    if (objectsBefore > heap.objectCount) heap.stats.totalObjectsCollected += objectsBefore - heap.objectCount;
+    
+    heap.stats.currentHeapSize = heap.totalCapacity();
+    if (heap.stats.currentHeapSize > heap.stats.peakHeapSize) {
+        heap.stats.peakHeapSize = heap.stats.currentHeapSize;
     }
+    heap.pendingRequest = 0;
+    // Fim de marcação ainda pendente continua pedindo o remark
+    heap.gcRequested = marker.active.load() && marker.done.load();
+}
+
+inline void GarbageCollector::visitRoots(const RootVisitor& visit) {
+    {
+        std::lock_guard<std::mutex> lock(rootsLock);
+        for (auto* root : roots) visit(*root);
+    }
+    if (rootScanner) rootScanner(visit);
+}
+
+inline GCObject* GarbageCollector::copyTo(GCObject* obj, void* dst) {
+    GCObject* copy = static_cast<GCObject*>(dst);
+    std::memcpy(copy, obj, obj->header.size);
+    obj->header.forwardTo(copy);
+    copiedObjects++;
+    return copy;
+}
+
+inline GCObject* GarbageCollector::evacuate(GCObject* obj) {
+    if (!obj) return obj;
+    if (obj->header.isForwarded()) return obj->header.forwardee();
     
-    // Marca a partir dos roots
-    for (auto* root : roots) {
-        if (*root) mark(*root);
+    const size_t size = obj->header.size;
+    if (fullCollection) {
+        // Tudo que não é o destino está sendo evacuado
+        if (fullTarget.contains(obj)) return obj;
+        void* dst = fullTarget.allocate(size);
+        heap.cards.recordObject(static_cast<uint8_t*>(dst), size);
+        GCObject* copy = copyTo(obj, dst);
+        copy->header.flags = static_cast<GCFlags>(copy->header.flags | GC_FLAG_OLD_GEN);
+        return copy;
     }
     
-    // Scanner customizado para roots da VM
-    if (rootScanner) {
-        for (auto* obj : heap.allObjects) {
-            if (obj && obj->header.isMarked()) {
-                scanObject(obj);
-            }
-        }
+    if (!heap.inYoung(obj)) return obj;
+    
+    void* dst = nullptr;
+    if (obj->header.age + 1 < heap.config.tenureThreshold) {
+        dst = heap.survivor2.allocate(size);
+    }
+    if (dst) {
+        GCObject* copy = copyTo(obj, dst);
+        copy->header.age++;
+        survivorObjects++;
+        return copy;
     }
+    // Promoção: idade atingida ou survivor to cheio (canPromoteAll garante espaço)
+    GCObject* copy = copyTo(obj, heap.allocateInOldGen(size));
+    copy->header.age++;
+    copy->header.flags = static_cast<GCFlags>(copy->header.flags | GC_FLAG_OLD_GEN);
+    return copy;
 }
 
-inline void GarbageCollector::mark(GCObject* obj) {
-    if (!obj || obj->header.isMarked()) return;
-    
-    obj->header.mark();
-    scanObject(obj);
+inline void GarbageCollector::scanRegion(uint8_t*& scan, const MemoryBlock& block) {
+    while (scan < block.current) {
+        GCObject* obj = reinterpret_cast<GCObject*>(scan);
+        scan += obj->header.size;
+        scanObject(obj);
+    }
 }
 
-inline void GarbageCollector::scanObject(GCObject* obj) {
-    // Escaneia campos de referência do objeto
-    if (obj->header.type == GCObjectType::INSTANCE) {
-        // TODO: Usar metadata da classe para encontrar campos de referência
-    } else if (obj->header.type == GCObjectType::ARRAY_OBJECT) {
+inline void GarbageCollector::scanDirtyCards(const uint8_t* limit) {
+    CardTable& ct = heap.cards;
+    const size_t count = ct.cardsBelow(limit);
+    for (size_t c = 0; c < count; c++) {
+        if (!ct.isDirty(c)) continue;
+        ct.cards[c] = CardTable::CLEAN;  // Ressujado pelo scan se ainda apontar para a young gen
+        const uint8_t* lo = ct.cardBase(c);
+        const uint8_t* hi = std::min(lo + CardTable::CARD_SIZE, limit);
+        for (uint8_t* p = ct.objectStart[c]; p && p < hi; ) {
+            GCObject* obj = reinterpret_cast<GCObject*>(p);
+            p += obj->header.size;
+            scanObject(obj, lo, hi);
+        }
+    }
+}
+
+inline void GarbageCollector::scanObject(GCObject* obj, const uint8_t* lo, const uint8_t* hi) {
+    // Escaneia campos de referência do objeto; [lo, hi) restringe aos slots de um card
+    if (obj->hasReferenceSlots()) {
         int32_t length = obj->arrayLength();
         GCObject** elements = reinterpret_cast<GCObject**>(obj->data + sizeof(int32_t));
-        for (int32_t i = 0; i < length; i++) {
-            if (elements[i]) mark(elements[i]);
+        int32_t first = 0;
+        int32_t last = length;
+        if (lo) {
+            const uint8_t* e = reinterpret_cast<const uint8_t*>(elements);
+            if (lo > e) first = static_cast<int32_t>((lo - e) / sizeof(GCObject*));
+            if (hi < e) last = 0;
+            else last = std::min<int64_t>(length, (hi - e + sizeof(GCObject*) - 1) / sizeof(GCObject*));
+        }
+        // Holder na old gen que continua apontando para a young gen mantém o card sujo
+        const bool track = !fullCollection && obj->header.isOldGen();
+        for (int32_t i = first; i < last; i++) {
+            if (!elements[i]) continue;
+            // Store atômico: o marcador concorrente pode estar lendo este slot
+            __atomic_store_n(&elements[i], evacuate(elements[i]), __ATOMIC_RELAXED);
+            if (track && heap.survivor2.contains(elements[i])) heap.cards.mark(&elements[i]);
         }
     }
 }
 
-inline void GarbageCollector::sweepPhase() {
-    size_t freedBytes = 0;
-    size_t freedObjects = 0;
+// ============================================================
+// FULL GC PARALELO (work-stealing)
+// ============================================================
+// Cada worker copia para PLABs próprios dentro de fullTarget e mantém uma
+// fila privada de objetos a escanear; o excesso é publicado num deque
+// compartilhado de onde os outros roubam. O objeto de origem é reivindicado
+// por CAS nos bytes 0..7 do header (FORWARD_BUSY) antes da cópia.
+static constexpr uint64_t FORWARD_BUSY = 1;  // classId|size real nunca vale 1 (size >= 16)
+
+inline void GarbageCollector::collectFullParallel(int n) {
+    while (static_cast<int>(workers.size()) < n) workers.push_back(std::make_unique<Worker>());
+    for (int i = 0; i < n; i++) {
+        Worker& w = *workers[i];
+        w.local.clear();
+        w.shared.clear();
+        w.sharedSize = 0;
+        w.plabCur = w.plabEnd = nullptr;
+        w.copied = 0;
+    }
+    activeWorkers = n;
+    idleWorkers = 0;
+    
+    // Roots na thread da VM; metade vai para o deque compartilhado de saída
+    Worker& first = *workers[0];
+    visitRoots([this, &first](GCObject*& ref) { ref = parEvacuate(first, ref); });
+    publish(first);
+    
+    workerRunner(n, [this](int i) {
+        Worker& w = *workers[i];
+        parallelDrain(w);
+        retirePLAB(w);
+    });
     
-    auto it = heap.allObjects.begin();
-    while (it != heap.allObjects.end()) {
-        GCObject* obj = *it;
-        if (obj && !obj->header.isMarked()) {
-            freedBytes += obj->header.size;
-            freedObjects++;
-            it = heap.allObjects.erase(it);
-            // Nota: Não deletamos o ponteiro pois a memória é gerenciada em blocos
-        } else {
-            ++it;
+    copiedObjects = 0;
+    for (int i = 0; i < n; i++) copiedObjects += workers[i]->copied;
+}
+
+inline void GarbageCollector::writeFiller(uint8_t* p, size_t size) {
+    Heap::formatFiller(p, size, GC_FLAG_OLD_GEN);
+    heap.cards.recordObject(p, size);
+}
+
+inline void GarbageCollector::retirePLAB(Worker& w) {
+    if (w.plabCur < w.plabEnd) writeFiller(w.plabCur, w.plabEnd - w.plabCur);
+    w.plabCur = w.plabEnd = nullptr;
+}
+
+inline void* GarbageCollector::plabAllocate(Worker& w, size_t size) {
+    uint8_t* p;
+    if (size > PLAB_SIZE / 16) {
+        // Objeto grande: bump atômico direto no destino
+        p = __atomic_fetch_add(&fullTarget.current, size, __ATOMIC_RELAXED);
+    } else {
+        size_t left = w.plabEnd - w.plabCur;
+        // A sobra precisa comportar um filler (ver MIN_FILLER_SIZE)
+        if (size > left || unusableGap(left - size)) {
+            retirePLAB(w);
+            w.plabCur = __atomic_fetch_add(&fullTarget.current, PLAB_SIZE, __ATOMIC_RELAXED);
+            w.plabEnd = w.plabCur + PLAB_SIZE;
         }
+        p = w.plabCur;
+        w.plabCur += size;
     }
+    heap.cards.recordObject(p, size);
+    return p;
+}
+
+inline GCObject* GarbageCollector::parEvacuate(Worker& w, GCObject* obj) {
+    if (!obj || fullTarget.contains(obj)) return obj;
     
-    heap.stats.totalBytesCollected += freedBytes;
-    heap.stats.totalObjectsCollected += freedObjects;
+    uint64_t* word = reinterpret_cast<uint64_t*>(&obj->header);
+    uint8_t* flags = reinterpret_cast<uint8_t*>(&obj->header.flags);
+    for (;;) {
+        uint64_t original = __atomic_load_n(word, __ATOMIC_ACQUIRE);
+        if (original == FORWARD_BUSY) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (__atomic_load_n(flags, __ATOMIC_ACQUIRE) & GC_FLAG_FORWARDED) {
+            // Flag é publicada antes do ponteiro: espera a palavra deixar de ser BUSY
+            uint64_t to;
+            while ((to = __atomic_load_n(word, __ATOMIC_ACQUIRE)) == FORWARD_BUSY) std::this_thread::yield();
+            return reinterpret_cast<GCObject*>(to);
+        }
+        if (!__atomic_compare_exchange_n(word, &original, FORWARD_BUSY, false,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+        
+        // A palavra 0 do original agora vale BUSY: classId+size vêm de `original`
+        GCHeader saved;
+        std::memcpy(&saved, &original, sizeof(original));
+        
+        GCObject* copy = static_cast<GCObject*>(plabAllocate(w, saved.size));
+        std::memcpy(copy, &original, sizeof(original));
+        std::memcpy(reinterpret_cast<uint8_t*>(copy) + sizeof(original),
+                    reinterpret_cast<const uint8_t*>(obj) + sizeof(original), saved.size - sizeof(original));
+        copy->header.flags = static_cast<GCFlags>(copy->header.flags | GC_FLAG_OLD_GEN);
+        
+        // Só o dono do BUSY escreve nas flags: store simples, sem RMW com lock
+        __atomic_store_n(flags, static_cast<uint8_t>(__atomic_load_n(flags, __ATOMIC_RELAXED) | GC_FLAG_FORWARDED), __ATOMIC_RELEASE);
+        __atomic_store_n(word, reinterpret_cast<uint64_t>(copy), __ATOMIC_RELEASE);
+        w.copied++;
+        pushScan(w, copy);
+        return copy;
+    }
+}
+
+inline void GarbageCollector::pushScan(Worker& w, GCObject* obj) {
+    if (!obj->hasReferenceSlots()) return;
+    int32_t length = obj->arrayLength();
+    for (int32_t from = 0; from < length; from += SCAN_CHUNK) {
+        w.local.push_back({obj, from, std::min(length, from + SCAN_CHUNK)});
+    }
+}
+
+inline void GarbageCollector::publish(Worker& w) {
+    size_t half = w.local.size() / 2;
+    if (half == 0) return;
+    std::lock_guard<std::mutex> lock(w.stealLock);
+    w.shared.insert(w.shared.end(), w.local.begin(), w.local.begin() + half);
+    w.local.erase(w.local.begin(), w.local.begin() + half);
+    w.sharedSize.store(w.shared.size());
+}
+
+inline bool GarbageCollector::anySharedWork() const {
+    for (int i = 0; i < activeWorkers; i++) {
+        if (workers[i]->sharedSize.load() > 0) return true;
+    }
+    return false;
 }
 
-inline void GarbageCollector::minorMark() {
-    // Marca objetos na young generation a partir de roots
-    for (auto* root : roots) {
-        if (*root && !(*root)->header.isOldGen()) {
-            mark(*root);
+inline bool GarbageCollector::steal(Worker& self) {
+    // Primeiro recupera o próprio deque, depois rouba metade de outro worker
+    int selfIndex = 0;
+    for (int i = 0; i < activeWorkers; i++) {
+        if (workers[i].get() == &self) selfIndex = i;
+    }
+    for (int k = 0; k < activeWorkers; k++) {
+        Worker& victim = *workers[(selfIndex + k) % activeWorkers];
+        if (victim.sharedSize.load() == 0) continue;
+        std::lock_guard<std::mutex> lock(victim.stealLock);
+        size_t take = &victim == &self ? victim.shared.size() : (victim.shared.size() + 1) / 2;
+        if (take == 0) continue;
+        self.local.insert(self.local.end(), victim.shared.begin(), victim.shared.begin() + take);
+        victim.shared.erase(victim.shared.begin(), victim.shared.begin() + take);
+        victim.sharedSize.store(victim.shared.size());
+        return true;
+    }
+    return false;
+}
+
+inline void GarbageCollector::parallelDrain(Worker& w) {
+    for (;;) {
+        while (!w.local.empty()) {
+            ScanTask task = w.local.front();
+            w.local.pop_front();
+            GCObject** elements = reinterpret_cast<GCObject**>(task.obj->data + sizeof(int32_t));
+            for (int32_t i = task.from; i < task.to; i++) {
+                if (elements[i]) elements[i] = parEvacuate(w, elements[i]);
+            }
+            if (w.local.size() > 64 && w.sharedSize.load(std::memory_order_relaxed) == 0) publish(w);
+        }
+        if (steal(w)) continue;
+        
+        // Terminação: todos ociosos e nenhum deque com trabalho
+        idleWorkers.fetch_add(1);
+        for (;;) {
+            if (anySharedWork()) {
+                idleWorkers.fetch_sub(1);
+                break;
+            }
+            if (idleWorkers.load() == activeWorkers) return;
+            std::this_thread::yield();
         }
     }
+}
+
+// ============================================================
+// MARCAÇÃO CONCORRENTE (SATB)
+// ============================================================
+// Initial mark (na pausa da minor GC): raízes + young gen marcam de cinza
+// os objetos da old gen abaixo de TAMS. Uma thread de background percorre o
+// grafo da old gen enquanto a VM roda; o valor antigo de cada slot
+// sobrescrito vai para o buffer SATB. Remark drena os buffers e a pausa final
+// compacta a old gen copiando só os marcados (mais tudo acima de TAMS), sem
+// percorrer o grafo de novo.
+inline void GarbageCollector::maybeStartConcurrentMark() {
+    if (!heap.config.concurrentMark || !heap.config.enableGenerational || marker.active.load()) return;
+    if (heap.oldGen.used() < heap.oldGen.capacity() * heap.config.gcTriggerRatio) return;
     
-    // Marca a partir do remembered set (refs old -> young)
-    for (auto* obj : rememberedSet) {
-        if (obj && !obj->header.isOldGen()) {
-            mark(obj);
+    marker.base = heap.oldGen.start;
+    marker.tams = heap.oldGen.current;
+    marker.bitmap.assign((heap.oldGen.used() / 8 + 63) / 64, 0);
+    marker.gray.clear();
+    clearSatbBuffers();
+    marker.done = false;
+    marker.abort = false;
+    
+    visitRoots([this](GCObject*& ref) { markGray(ref); });
+    for (const MemoryBlock* block : {&heap.eden, &heap.survivor1}) {
+        for (uint8_t* p = block->start; p < block->current; ) {
+            GCObject* obj = reinterpret_cast<GCObject*>(p);
+            p += obj->header.size;
+            traceGray(obj);
         }
     }
+    
+    marker.startTime = std::chrono::high_resolution_clock::now();
+    marker.active = true;
+    marker.thread = std::thread([this] { concurrentMarkLoop(); });
+}
+
+inline bool GarbageCollector::isMarked(const GCObject* obj) const {
+    size_t bit = static_cast<size_t>(reinterpret_cast<const uint8_t*>(obj) - marker.base) >> 3;
+    return (marker.bitmap[bit >> 6] >> (bit & 63)) & 1;
+}
+
+inline void GarbageCollector::markGray(GCObject* obj) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(obj);
+    if (!obj || p < marker.base || p >= marker.tams) return;
+    size_t bit = static_cast<size_t>(p - marker.base) >> 3;
+    uint64_t mask = uint64_t(1) << (bit & 63);
+    uint64_t& word = marker.bitmap[bit >> 6];
+    if (word & mask) return;
+    word |= mask;
+    marker.gray.push_back(obj);
 }
 
-inline void GarbageCollector::minorSweep() {
-    // Promove objetos sobreviventes
-    for (auto* obj : heap.allObjects) {
-        if (obj && obj->header.isMarked() && !obj->header.isOldGen()) {
-            obj->header.age++;
-            if (obj->header.age >= heap.config.tenureThreshold) {
-                promoteToOldGen(obj);
+inline void GarbageCollector::traceGray(const GCObject* obj) {
+    if (!obj->hasReferenceSlots()) return;
+    int32_t length = obj->arrayLength();
+    GCObject* const* elements = reinterpret_cast<GCObject* const*>(obj->data + sizeof(int32_t));
+    for (int32_t i = 0; i < length; i++) {
+        markGray(__atomic_load_n(&elements[i], __ATOMIC_RELAXED));
+    }
+}
+
+inline void GarbageCollector::satbEnqueue(GCObject* previous) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(previous);
+    if (p < marker.base || p >= marker.tams) return;  // Só o snapshot da old gen interessa
+    MutatorThread* self = MutatorThread::of(heap);
+    if (!self) {
+        std::lock_guard<std::mutex> lock(marker.satbLock);
+        marker.satbShared.push_back(previous);
+        return;
+    }
+    self->satb.push_back(previous);
+    if (self->satb.size() >= 256) {
+        std::lock_guard<std::mutex> lock(marker.satbLock);
+        marker.satbShared.insert(marker.satbShared.end(), self->satb.begin(), self->satb.end());
+        self->satb.clear();
+    }
+}
+
+inline void GarbageCollector::clearSatbBuffers() {
+    // Só com as mutadoras paradas (ou sem nenhuma registrada)
+    std::lock_guard<std::mutex> lock(marker.satbLock);
+    marker.satbShared.clear();
+    for (MutatorThread* m : heap.mutators) m->satb.clear();
+    heap.orphanSatb.clear();
+}
+
+inline void GarbageCollector::concurrentMarkLoop() {
+    size_t sinceDrain = 0;
+    std::vector<GCObject*> batch;
+    while (!marker.abort.load(std::memory_order_relaxed)) {
+        if (marker.gray.empty() || ++sinceDrain >= 4096) {
+            sinceDrain = 0;
+            {
+                std::lock_guard<std::mutex> lock(marker.satbLock);
+                batch.swap(marker.satbShared);
             }
+            for (GCObject* obj : batch) markGray(obj);
+            batch.clear();
+            if (marker.gray.empty()) break;
         }
+        GCObject* obj = marker.gray.back();
+        marker.gray.pop_back();
+        traceGray(obj);
     }
+    heap.stats.concurrentMarkMs += std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - marker.startTime).count();
+    marker.done = true;
+    heap.gcRequested = true;  // Remark no próximo safepoint
+}
+
+inline void GarbageCollector::abortConcurrentMark() {
+    if (!marker.active.load()) return;
+    marker.abort = true;
+    if (marker.thread.joinable()) marker.thread.join();
+    marker.active = false;
+    marker.gray.clear();
+    clearSatbBuffers();
+}
+
+inline void GarbageCollector::finishConcurrentMark() {
+    if (!marker.active.load()) return;
+    startTiming();
+    // Se o marcador ainda não terminou, esta pausa espera por ele
+    if (marker.thread.joinable()) marker.thread.join();
     
-    // Reseta eden
-    heap.eden.reset();
+    // Remark: o que o mutator sobrescreveu depois da última drenagem
+    for (GCObject* obj : marker.satbShared) markGray(obj);
+    for (MutatorThread* m : heap.mutators) {
+        for (GCObject* obj : m->satb) markGray(obj);
+    }
+    for (GCObject* obj : heap.orphanSatb) markGray(obj);
+    clearSatbBuffers();
+    while (!marker.gray.empty()) {
+        GCObject* obj = marker.gray.back();
+        marker.gray.pop_back();
+        traceGray(obj);
+    }
+    marker.active = false;
+    
+    compactMarkedOldGen();
     
-    // Limpa remembered set
-    rememberedSet.clear();
+    heap.stats.concurrentCycles++;
+    heap.stats.majorCollections++;
+    recordPause("remark");
 }
 
-inline void GarbageCollector::promoteToOldGen(GCObject* obj) {
-    obj->header.flags = static_cast<GCFlags>(obj->header.flags | GC_FLAG_OLD_GEN);
-    // TODO: Copiar para old gen se usando copying collection
+inline void GarbageCollector::compactMarkedOldGen() {
+    const size_t usedBefore = heap.totalUsed();
+    const size_t objectsBefore = heap.objectCount;
+    
+    // Vivos: marcados abaixo de TAMS + tudo alocado/promovido depois do snapshot
+    size_t live = 0;
+    for (uint8_t* p = heap.oldGen.start; p < heap.oldGen.current; ) {
+        GCObject* obj = reinterpret_cast<GCObject*>(p);
+        const bool isLive = p >= marker.tams || isMarked(obj);
+        p += obj->header.size;
+        if (obj->header.type != GCObjectType::FILLER && isLive) live += obj->header.size;
+    }
+    // Deixa folga para o próximo ciclo não disparar logo em seguida
+    size_t capacity = grownOldCapacity(static_cast<size_t>(
+        (live + heap.youngCapacity()) / heap.config.gcTriggerRatio) - heap.youngCapacity());
+    
+    MemoryBlock target = MemoryBlock::create(capacity);
+    heap.cards.reset(target);
+    size_t dead = 0;
+    for (uint8_t* p = heap.oldGen.start; p < heap.oldGen.current; ) {
+        GCObject* obj = reinterpret_cast<GCObject*>(p);
+        const size_t size = obj->header.size;
+        const bool isLive = obj->header.type != GCObjectType::FILLER &&
+                            (p >= marker.tams || isMarked(obj));
+        if (!isLive && obj->header.type != GCObjectType::FILLER) dead++;
+        p += size;
+        if (!isLive) continue;
+        void* dst = target.allocate(size);
+        heap.cards.recordObject(static_cast<uint8_t*>(dst), size);
+        std::memcpy(dst, obj, size);
+        obj->header.forwardTo(static_cast<GCObject*>(dst));
+    }
+    
+    // Atualiza referências: raízes, a old gen nova e toda a young gen
+    const MemoryBlock from = heap.oldGen;
+    auto relocate = [&from](GCObject* ref) {
+        return ref && from.contains(ref) && ref->header.isForwarded() ? ref->header.forwardee() : ref;
+    };
+    visitRoots([&relocate](GCObject*& ref) { ref = relocate(ref); });
+    auto fixSlots = [&](GCObject* obj, bool old) {
+        if (!obj->hasReferenceSlots()) return;
+        int32_t length = obj->arrayLength();
+        GCObject** elements = reinterpret_cast<GCObject**>(obj->data + sizeof(int32_t));
+        for (int32_t i = 0; i < length; i++) {
+            elements[i] = relocate(elements[i]);
+            if (old && elements[i] && heap.inYoung(elements[i])) heap.cards.mark(&elements[i]);
+        }
+    };
+    for (uint8_t* p = target.start; p < target.current; ) {
+        GCObject* obj = reinterpret_cast<GCObject*>(p);
+        p += obj->header.size;
+        fixSlots(obj, true);
+    }
+    for (const MemoryBlock* block : {&heap.eden, &heap.survivor1}) {
+        for (uint8_t* p = block->start; p < block->current; ) {
+            GCObject* obj = reinterpret_cast<GCObject*>(p);
+            p += obj->header.size;
+            fixSlots(obj, false);
+        }
+    }
+    
+    heap.oldGen.release();
+    heap.oldGen = target;
+    heap.objectCount -= std::min(dead, heap.objectCount);
+    marker.bitmap.clear();
+    finishCollection(usedBefore, objectsBefore);
 }
 
 inline void GarbageCollector::addRoot(GCObject** root) {
+    std::lock_guard<std::mutex> lock(rootsLock);
     roots.push_back(root);
 }
 
 inline void GarbageCollector::removeRoot(GCObject** root) {
+    std::lock_guard<std::mutex> lock(rootsLock);
     auto it = std::find(roots.begin(), roots.end(), root);
     if (it != roots.end()) {
         roots.erase(it);
     }
 }
 
-inline void GarbageCollector::writeBarrier(GCObject* parent, GCObject* child) {
-    // Se parent está na old gen e child na young gen, adiciona ao remembered set
-    if (parent && child && 
-        parent->header.isOldGen() && !child->header.isOldGen()) {
-        rememberedSet.push_back(child);
-    }
-}
-
 } // namespace Kava
 
 #endif // KAVA_GC_H
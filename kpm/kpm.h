@@ -18,6 +18,10 @@
 #include <algorithm>
 #include <cstdlib>
 #include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdio>
 
 namespace fs = std::filesystem;
 
@@ -185,11 +189,167 @@ struct PackageManifest {
         m.scripts.build = extractField("build");
         m.scripts.test = extractField("test");
         m.scripts.start = extractField("start");
-        
+
+        // Objetos "nome": "faixa" de dependencies/devDependencies
+        auto extractDeps = [&json](const std::string& key, bool isDev) {
+            std::vector<Dependency> deps;
+            auto pos = json.find("\"" + key + "\": {");
+            if (pos == std::string::npos) return deps;
+            auto end = json.find('}', pos);
+            std::istringstream body(json.substr(pos, end - pos));
+            std::string line;
+            std::getline(body, line);
+            while (std::getline(body, line)) {
+                std::vector<std::string> quoted;
+                for (size_t q = line.find('"'); q != std::string::npos; q = line.find('"', q + 1)) {
+                    auto close = line.find('"', q + 1);
+                    if (close == std::string::npos) break;
+                    quoted.push_back(line.substr(q + 1, close - q - 1));
+                    q = close;
+                }
+                if (quoted.size() == 2) deps.push_back({quoted[0], quoted[1], isDev});
+            }
+            return deps;
+        };
+        m.dependencies = extractDeps("dependencies", false);
+        m.devDependencies = extractDeps("devDependencies", true);
+
         return m;
     }
 };
 
+// ============================================================
+// BUILD CACHE - Compilação incremental
+// ============================================================
+// Cada .kava compila para um .kvb independente; a chave de um módulo é o
+// hash do conteúdo mais as chaves dos módulos que ele importa (transitivo),
+// então mudar um import recompila quem depende dele. As chaves ficam em
+// .kpm/build-cache ("chave caminho" por linha).
+struct BuildCache {
+    std::string root;
+    std::string compilerId;  // tamanho+mtime do kavac: trocar o compilador invalida tudo
+    std::map<std::string, std::string> stored;
+    std::map<std::string, std::string> keys;
+
+    explicit BuildCache(const std::string& projectDir) : root(projectDir) {
+        std::ifstream in(path());
+        std::string key, file;
+        while (in >> key && std::getline(in >> std::ws, file)) stored[file] = key;
+        compilerId = locateCompiler();
+    }
+
+    std::string path() const { return root + "/.kpm/build-cache"; }
+
+    // FNV-1a 64 bits
+    static uint64_t hash(const std::string& data, uint64_t h = 1469598103934665603ULL) {
+        for (unsigned char c : data) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    static std::string hex(uint64_t v) {
+        char buf[17];
+        snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(v));
+        return buf;
+    }
+
+    static std::string readFile(const std::string& file) {
+        std::ifstream in(file, std::ios::binary);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+    // Nomes de `import a.b` no início das linhas (sem rodar o parser)
+    static std::vector<std::string> scanImports(const std::string& source) {
+        std::vector<std::string> names;
+        std::istringstream lines(source);
+        std::string line;
+        while (std::getline(lines, line)) {
+            size_t p = line.find_first_not_of(" \t");
+            if (p == std::string::npos || line.compare(p, 7, "import ") != 0) continue;
+            std::istringstream words(line.substr(p + 7));
+            std::string name;
+            words >> name;
+            if (name == "static") words >> name;
+            while (!name.empty() && (name.back() == ';' || name.back() == '*' || name.back() == '.')) name.pop_back();
+            if (!name.empty()) names.push_back(name);
+        }
+        return names;
+    }
+
+    // Ordem: diretório do arquivo, src/, lib/, kava_modules/<pkg>/index.kava, $KAVA_HOME/stdlib
+    std::string resolveImport(const std::string& name, const std::string& from) const {
+        std::string rel = name;
+        std::replace(rel.begin(), rel.end(), '.', '/');
+        std::vector<std::string> candidates = {
+            (fs::path(from).parent_path() / (rel + ".kava")).string(),
+            root + "/src/" + rel + ".kava",
+            root + "/lib/" + rel + ".kava",
+            root + "/kava_modules/" + rel + "/index.kava",
+        };
+        if (const char* home = std::getenv("KAVA_HOME")) {
+            candidates.push_back(std::string(home) + "/stdlib/" + rel + ".kava");
+        }
+        for (auto& c : candidates) {
+            if (fs::exists(c)) return fs::weakly_canonical(c).string();
+        }
+        return "";
+    }
+
+    // Chave do módulo; imports cíclicos entram só pelo nome
+    std::string key(const std::string& file) {
+        auto it = keys.find(file);
+        if (it != keys.end()) return it->second;
+        keys[file] = "";  // em andamento
+
+        std::string source = readFile(file);
+        uint64_t h = hash(compilerId);
+        h = hash(source, h);
+        for (auto& name : scanImports(source)) {
+            std::string dep = resolveImport(name, file);
+            h = hash(name, h);
+            if (!dep.empty()) h = hash(key(dep), h);
+        }
+        return keys[file] = hex(h);
+    }
+
+    bool upToDate(const std::string& file) {
+        auto it = stored.find(file);
+        return it != stored.end() && it->second == key(file) && fs::exists(outputOf(file));
+    }
+
+    void record(const std::string& file) { stored[file] = key(file); }
+
+    void save() const {
+        fs::create_directories(root + "/.kpm");
+        std::ofstream out(path());
+        for (auto& [file, k] : stored) out << k << " " << file << "\n";
+    }
+
+    static std::string outputOf(const std::string& file) {
+        return file.substr(0, file.find_last_of('.')) + ".kvb";
+    }
+
+private:
+    static std::string locateCompiler() {
+        const char* envPath = std::getenv("PATH");
+        std::istringstream dirs(envPath ? envPath : "");
+        std::string dir;
+        while (std::getline(dirs, dir, ':')) {
+            std::error_code ec;
+            fs::path bin = fs::path(dir.empty() ? "." : dir) / "kavac";
+            auto size = fs::file_size(bin, ec);
+            if (ec) continue;
+            auto mtime = fs::last_write_time(bin, ec).time_since_epoch().count();
+            return std::to_string(size) + ":" + std::to_string(mtime);
+        }
+        return "kavac";
+    }
+};
+
 // ============================================================
 // KPM - KAVA PACKAGE MANAGER
 // ============================================================
@@ -213,10 +373,10 @@ public:
         manifest.author = "";
         manifest.license = "MIT";
         manifest.main = "src/main.kava";
-        manifest.scripts.build = "kavac src/main.kava";
+        manifest.scripts.build = "kpm build";
         manifest.scripts.test = "kavavm tests/test.kvb";
         manifest.scripts.start = "kavavm src/main.kvb";
-        manifest.scripts.dev = "kavac src/main.kava && kavavm src/main.kvb";
+        manifest.scripts.dev = "kpm build && kavavm src/main.kvb";
         
         // Create project structure
         fs::create_directories(projectDir + "/src");
@@ -305,7 +465,7 @@ public:
     // ========================================
     // kpm build - Compila projeto
     // ========================================
-    int cmdBuild() {
+    int cmdBuild(int jobs = 0, bool force = false) {
         loadManifest();
         
         std::cout << "\n  Building " << manifest.name << " v" << manifest.version << "...\n\n";
@@ -315,7 +475,7 @@ public:
         if (fs::exists(projectDir + "/src")) {
             for (auto& entry : fs::recursive_directory_iterator(projectDir + "/src")) {
                 if (entry.path().extension() == ".kava") {
-                    sourceFiles.push_back(entry.path().string());
+                    sourceFiles.push_back(fs::weakly_canonical(entry.path()).string());
                 }
             }
         }
@@ -324,22 +484,56 @@ public:
             std::cerr << "  No .kava files found in src/\n";
             return 1;
         }
+        std::sort(sourceFiles.begin(), sourceFiles.end());
         
-        int compiled = 0;
-        int errors = 0;
-        
+        // Só recompila o que mudou (ou cujos imports mudaram)
+        BuildCache cache(projectDir);
+        std::vector<std::string> dirty;
         for (auto& file : sourceFiles) {
-            std::string cmd = "kavac " + file + " 2>&1";
-            int ret = system(cmd.c_str());
-            if (ret == 0) {
-                compiled++;
-            } else {
-                errors++;
-                std::cerr << "  ERROR compiling: " << file << "\n";
+            if (force || !cache.upToDate(file)) dirty.push_back(file);
+        }
+        
+        // Módulos não se linkam entre si: os sujos compilam em paralelo
+        if (jobs <= 0) jobs = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        jobs = std::min<int>(jobs, static_cast<int>(std::max<size_t>(1, dirty.size())));
+        
+        std::atomic<size_t> next{0};
+        std::atomic<int> errors{0};
+        std::mutex outMutex;
+        std::vector<char> ok(dirty.size(), 0);
+        auto worker = [&]() {
+            for (size_t i = next++; i < dirty.size(); i = next++) {
+                std::string cmd = "kavac \"" + dirty[i] + "\" 2>&1";
+                std::string output;
+                int ret = -1;
+                if (FILE* pipe = popen(cmd.c_str(), "r")) {
+                    char buf[512];
+                    while (fgets(buf, sizeof(buf), pipe)) output += buf;
+                    ret = pclose(pipe);
+                }
+                std::lock_guard<std::mutex> lock(outMutex);
+                std::cout << output;
+                if (ret == 0) {
+                    ok[i] = 1;
+                } else {
+                    errors++;
+                    std::cerr << "  ERROR compiling: " << dirty[i] << "\n";
+                }
             }
+        };
+        std::vector<std::thread> pool;
+        for (int j = 1; j < jobs; j++) pool.emplace_back(worker);
+        worker();
+        for (auto& t : pool) t.join();
+        
+        for (size_t i = 0; i < dirty.size(); i++) {
+            if (ok[i]) cache.record(dirty[i]);
         }
+        cache.save();
         
-        std::cout << "\n  Build complete: " << compiled << " files compiled";
+        int compiled = static_cast<int>(dirty.size()) - errors;
+        std::cout << "\n  Build complete: " << compiled << " files compiled, "
+                  << (sourceFiles.size() - dirty.size()) << " up to date";
         if (errors > 0) std::cout << ", " << errors << " errors";
         std::cout << "\n\n";
         
@@ -436,14 +630,38 @@ public:
         
         std::cout << "\n  Installing dependencies for " << manifest.name << "...\n\n";
         
-        for (auto& dep : manifest.dependencies) {
-            installPackage(dep);
+        // .kpm/install-lock: "nome@faixa" já resolvidos; só o que mudou é reinstalado
+        std::string lockPath = projectDir + "/.kpm/install-lock";
+        std::map<std::string, std::string> locked;
+        {
+            std::ifstream in(lockPath);
+            std::string spec;
+            while (std::getline(in, spec)) {
+                auto at = spec.find('@');
+                if (at != std::string::npos) locked[spec.substr(0, at)] = spec.substr(at + 1);
+            }
         }
-        for (auto& dep : manifest.devDependencies) {
+        
+        int skipped = 0;
+        auto install = [&](const Dependency& dep) {
+            auto it = locked.find(dep.name);
+            if (it != locked.end() && it->second == dep.version && fs::exists(projectDir + "/kava_modules/" + dep.name)) {
+                skipped++;
+                return;
+            }
             installPackage(dep);
-        }
+            locked[dep.name] = dep.version;
+        };
+        for (auto& dep : manifest.dependencies) install(dep);
+        for (auto& dep : manifest.devDependencies) install(dep);
+        
+        fs::create_directories(projectDir + "/.kpm");
+        std::ofstream lock(lockPath);
+        for (auto& [name, range] : locked) lock << name << "@" << range << "\n";
         
-        std::cout << "\n  Dependencies installed.\n\n";
+        std::cout << "\n  Dependencies installed";
+        if (skipped > 0) std::cout << " (" << skipped << " up to date)";
+        std::cout << ".\n\n";
         return 0;
     }
     
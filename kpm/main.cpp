@@ -6,6 +6,7 @@
 #include "kpm.h"
 #include <iostream>
 #include <string>
+#include <cstdlib>
 
 void printUsage() {
     std::cout << "\n";
@@ -16,7 +17,7 @@ void printUsage() {
     std::cout << "    add <pkg>       Add a dependency (e.g., kpm add http@^1.0)\n";
     std::cout << "    add -D <pkg>    Add a dev dependency\n";
     std::cout << "    install         Install all dependencies\n";
-    std::cout << "    build           Build the project\n";
+    std::cout << "    build           Build the project (incremental; -j N jobs, --force)\n";
     std::cout << "    test            Run tests\n";
     std::cout << "    publish         Publish package\n";
     std::cout << "    run <script>    Run a script (build, test, start, dev)\n";
@@ -60,7 +61,15 @@ int main(int argc, char** argv) {
         return kpm.cmdInstall();
     }
     else if (cmd == "build" || cmd == "b") {
-        return kpm.cmdBuild();
+        int jobs = 0;
+        bool force = false;
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--force" || arg == "-f") force = true;
+            else if (arg == "-j" && i + 1 < argc) jobs = std::atoi(argv[++i]);
+            else if (arg.rfind("-j", 0) == 0) jobs = std::atoi(arg.c_str() + 2);
+        }
+        return kpm.cmdBuild(jobs, force);
     }
     else if (cmd == "test" || cmd == "t") {
         return kpm.cmdTest();
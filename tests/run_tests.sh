@@ -6,6 +6,9 @@ SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
 ROOT_DIR="$(dirname "$SCRIPT_DIR")"
 KAVAC="$ROOT_DIR/kavac"
 KAVAVM="$ROOT_DIR/kavavm"
+KPM="$ROOT_DIR/kpm_bin"
+CXX="${CXX:-g++}"
+CXX_TEST_FLAGS="-std=c++17 -O2 -pthread -I$ROOT_DIR -I$ROOT_DIR/vm -I$ROOT_DIR/compiler -I$ROOT_DIR/gc -I$ROOT_DIR/collections -I$ROOT_DIR/threads"
 
 RED='\033[0;31m'
 GREEN='\033[0;32m'
@@ -21,6 +24,7 @@ run_test() {
     local name="$1"
     local file="$2"
     local expected="$3"
+    local vmflags="$4"
     
     TOTAL=$((TOTAL + 1))
     
@@ -36,7 +40,7 @@ run_test() {
     
     # Execute
     local actual
-    actual=$($KAVAVM "$kvb" 2>&1)
+    actual=$($KAVAVM $vmflags "$kvb" 2>&1)
     
     if [ "$actual" = "$expected" ]; then
         echo -e "  ${GREEN}PASS${NC} $name"
@@ -52,6 +56,38 @@ run_test() {
     rm -f "$kvb"
 }
 
+# Componentes so de C++ (headers da VM, GC, colecoes): compila um driver
+# pequeno contra os headers e compara a saida
+run_cpp_test() {
+    local name="$1"
+    local file="$2"
+    local expected="$3"
+    local bin="${file%.cpp}.bin"
+    
+    TOTAL=$((TOTAL + 1))
+    
+    if ! $CXX $CXX_TEST_FLAGS "$file" -o "$bin" > /dev/null 2>&1; then
+        echo -e "  ${RED}FAIL${NC} $name - compilation failed"
+        FAILED=$((FAILED + 1))
+        return
+    fi
+    
+    local actual
+    actual=$("$bin" 2>&1)
+    
+    if [ "$actual" = "$expected" ]; then
+        echo -e "  ${GREEN}PASS${NC} $name"
+        PASSED=$((PASSED + 1))
+    else
+        echo -e "  ${RED}FAIL${NC} $name"
+        echo "    Expected: $(echo "$expected" | head -3)..."
+        echo "    Got:      $(echo "$actual" | head -3)..."
+        FAILED=$((FAILED + 1))
+    fi
+    
+    rm -f "$bin"
+}
+
 echo ""
 echo "╔══════════════════════════════════════════════════════╗"
 echo "║          KAVA 2.5 - Test Suite Runner               ║"
@@ -83,6 +119,47 @@ run_test "Arithmetic operations" "/tmp/kava_test_arith.kava" "30
 7
 -5"
 
+cat > /tmp/kava_test_long.kava << 'EOF'
+let small = 5000000000L
+print small
+let big = 1125899906842624L
+print big
+let neg = 0 - 123456789
+print neg
+EOF
+run_test "Long values (inline + boxed)" "/tmp/kava_test_long.kava" "5000000000
+1125899906842624
+-123456789"
+
+# Longs boxeados (fora de +-2^50) nos caminhos int: valor da celula, nunca o
+# ponteiro, e resultado de 64 bits mesmo com IADD/ISUB/IMUL
+cat > /tmp/kava_test_long_box.kava << 'EOF'
+let big = 4000000000000000L
+let s = big + big
+print s
+let acc = 0
+let i = 0
+while (i < 1000) {
+    acc = acc + 4000000000000000L
+    i = i + 1
+}
+print acc
+print big * 3
+print big - 1
+EOF
+run_test "Boxed long arithmetic" "/tmp/kava_test_long_box.kava" "8000000000000000
+4000000000000000000
+12000000000000000
+3999999999999999"
+run_test "Boxed long arithmetic (no native JIT)" "/tmp/kava_test_long_box.kava" "8000000000000000
+4000000000000000000
+12000000000000000
+3999999999999999" "--no-native-jit"
+run_test "Boxed long arithmetic (switch dispatch)" "/tmp/kava_test_long_box.kava" "8000000000000000
+4000000000000000000
+12000000000000000
+3999999999999999" "--dispatch=switch"
+
 # =============================================
 # TEST 2: If/Else
 # =============================================
@@ -238,6 +315,62 @@ print sum
 EOF
 run_test "Sum 0..9999" "/tmp/kava_test_heavy2.kava" "49995000"
 
+cat > /tmp/kava_test_fused.kava << 'EOF'
+let total = 0
+let i = 0
+let limit = 50
+while (i < limit) {
+    let j = 0
+    while (j <= 3) {
+        total = total + j
+        j = j + 1
+    }
+    if (i == 7) { total = total - 7 }
+    if (i != 7) { total = total + 1 }
+    i = i + 1
+}
+print total
+let k = 10
+let p = 1
+while (k > 0) {
+    p = p * 2
+    k = k - 1
+}
+print p
+EOF
+run_test "Superinstruction loops" "/tmp/kava_test_fused.kava" "342
+1024"
+run_test "Superinstruction loops (pass disabled)" "/tmp/kava_test_fused.kava" "342
+1024" "--no-superinst"
+
+cat > /tmp/kava_test_native.kava << 'EOF'
+let sum = 0
+let i = 0
+let x = 0
+while (i < 300000) {
+    sum = sum + i % 7
+    x = x ^ (i * 3)
+    if (i % 1000 == 0) { sum = sum - i / 1000 }
+    i = i + 1
+}
+print sum
+print x
+let c = 0
+let n = 0
+while (n < 5000) {
+    c = c + (n & 15) + (n >> 2) + (n << 1)
+    if (n != 4999) { c = c - 1 }
+    n = n + 1
+}
+print c
+EOF
+run_test "Native JIT loops" "/tmp/kava_test_native.kava" "855147
+834656
+28149969"
+run_test "Native JIT loops (interpreter only)" "/tmp/kava_test_native.kava" "855147
+834656
+28149969" "--no-native-jit"
+
 # =============================================
 # TEST 9: Comparison operators
 # =============================================
@@ -261,9 +394,638 @@ run_test "Comparison operators" "/tmp/kava_test_cmp.kava" "1
 1"
 
 # =============================================
-# TEST 10: Full KAVA 2.5 Test
+# TEST 10: Streams
+# =============================================
+echo -e "${CYAN}[Section 9] Streams${NC}"
+
+cat > /tmp/kava_test_stream.kava << 'EOF'
+let xs = new int[] {5, 3, 8, 1, 9, 2, 8, 7}
+print xs.stream().filter(x -> x % 2 == 0).map(x -> x * 10).sum()
+print xs.stream().map(x -> x + 1).limit(3).sum()
+print xs.stream().distinct().count()
+print xs.stream().anyMatch(x -> x > 8)
+print xs.stream().reduce(0, (a, b) -> a + b)
+print xs.stream().sorted().skip(2).limit(2).reduce(0, (a, b) -> a * 10 + b)
+print xs.stream().sorted((a, b) -> b - a).findFirst()
+print xs.stream().flatMap(x -> new int[] {x, x * 2}).filter(x -> x > 15).toList().stream().sum()
+xs.stream().filter(x -> x > 7).forEach(x -> { print x })
+let big = new int[50000]
+let i = 0
+while (i < 50000) {
+    big[i] = i
+    i = i + 1
+}
+print big.stream().parallel().filter(x -> x % 3 == 0).map(x -> x * 2).sum()
+print big.parallelStream().map(x -> x & 7).reduce(0, (a, b) -> a + b)
+print big.parallelStream().filter(x -> x > 77).findFirst()
+EOF
+STREAM_EXPECTED="180
+19
+7
+1
+43
+35
+9
+50
+8
+9
+8
+833316666
+175000
+78"
+run_test "Fused stream pipelines" "/tmp/kava_test_stream.kava" "$STREAM_EXPECTED"
+run_test "Fused stream pipelines (interpreted lambdas)" "/tmp/kava_test_stream.kava" "$STREAM_EXPECTED" "--no-stream-kernels"
+
+cat > /tmp/kava_test_arrays.kava << 'EOF'
+let a = new int[] {5, -3, 8, 1, 9, 2, 8, 7}
+print a.stream().sum()
+print a.stream().min()
+print a.stream().skip(2).limit(3).max()
+let l = new long[20]
+Arrays.fill(l, 3000000000L)
+l[4] = 7
+print l.stream().sum()
+print l.stream().min()
+let d = new double[1000]
+Arrays.fill(d, 0.5)
+Arrays.fill(d, 10, 12, 4.0)
+print d.stream().sum()
+print d.stream().max()
+let b = new byte[100]
+Arrays.fill(b, 0 - 2)
+print b.stream().sum()
+let c = new int[8]
+System.arraycopy(a, 2, c, 0, 6)
+print c.stream().sum()
+print Arrays.equals(a, c)
+System.arraycopy(a, 0, c, 0, 8)
+print Arrays.equals(a, c)
+Arrays.fill(c, 3, 5, 0)
+print Arrays.mismatch(a, c)
+let big = new int[20000]
+Arrays.fill(big, 3)
+big[777] = 0 - 5
+print big.parallelStream().sum()
+print big.parallelStream().min()
+EOF
+ARRAYS_EXPECTED="37
+-3
+9
+57000000007
+7
+507
+4
+-200
+35
+0
+1
+3
+59992
+-5"
+run_test "SIMD array reductions and bulk natives" "/tmp/kava_test_arrays.kava" "$ARRAYS_EXPECTED"
+run_test "SIMD array reductions and bulk natives (scalar)" "/tmp/kava_test_arrays.kava" "$ARRAYS_EXPECTED" "--no-simd"
+
+printf 'alpha\nbeta\r\ngamma\n\ndelta' > /tmp/kava_test_files.txt
+cat > /tmp/kava_test_files.kava << 'EOF'
+let p = "/tmp/kava_test_files.txt"
+print Files.size(p)
+print Files.lines(p).stream().count()
+Files.lines(p).stream().skip(1).limit(2).forEach(l -> { print l })
+print Files.readBytes(p).length
+print Files.lines("/tmp/kava_test_missing.txt")
+EOF
+run_test "File lines stream and mapped reads" "/tmp/kava_test_files.kava" "24
+5
+beta
+gamma
+24
+null"
+
+cat > /tmp/kava_test_json.kava << 'EOF'
+class Point {
+    int x
+    int y
+    let label = "p"
+    Point(int x, int y) {
+        this.x = x
+        this.y = y
+    }
+}
+let text = "{ \"id\": 7, \"name\": \"kava\", \"tags\": [\"a\", \"b\"], \"ok\": true, \"none\": null }"
+let doc = Json.parse(text)
+print doc
+print Json.parse(doc).equals(doc)
+print Json.stringify(new Point(3, -4))
+print Json.stringify(new int[] {1, 2, 3})
+print Json.stringify("say \"hi\"\n\ttab\\")
+let esc = Json.parse("[\"\\u00e9\\u4e2d\", \"\\ud83d\\ude00\", \"a\\/b\\\\c\\\"d\", \"\\n\\t\\r\\b\\f\"]")
+print Json.getString(esc, "/0").length()
+print Json.getString(esc, "/1").length()
+print Json.getString(esc, "/2")
+print Json.query(esc, "/3")
+print Json.stringify(Json.getString(esc, "/0")).length()
+let nums = Json.parse("[0, -0, 12345678901234567, -9007199254740993, 1.5e3, -2.25E-2, 1e400, 9223372036854775807]")
+print nums
+print Json.getLong(nums, "/2")
+print Json.getLong(nums, "/3")
+print Json.getDouble(nums, "/4")
+print Json.getDouble(nums, "/5")
+print Json.type(nums, "/2")
+print Json.type(nums, "/4")
+print Json.parse("{\"a\": 1,}")
+print Json.error("{\"a\": 1,}")
+print Json.error("[1, 2")
+print Json.error("\"abc")
+print Json.error("[01]")
+print Json.error("[tru]")
+print Json.error("[\"\\x\"]")
+print Json.error("{} []")
+print Json.error("   ")
+print Json.error(doc)
+let big = "{\"skip\": [[1, 2, {\"deep\": [3]}], {\"x\": \"}\"}], \"items\": [{\"n\": \"a\"}, {\"n\": \"b\", \"k/e~y\": 5}]}"
+print Json.query(big, "/skip/0/2")
+print Json.getString(big, "/items/1/n")
+print Json.getLong(big, "/items/1/k~1e~0y")
+print Json.size(big, "/items")
+print Json.size(big, "/items/0/n")
+print Json.query(big, "/items/2")
+print Json.query(big, "/items/x")
+print Json.getLong(big, "/items/0/n")
+print Json.query(big, "")
+print Json.prettyPrint("{\"a\":[1,{\"b\":[]}],\"c\":{}}", 2)
+EOF
+run_test "JSON parse/stringify, escapes, numbers, errors and on-demand queries" "/tmp/kava_test_json.kava" "{\"id\":7,\"name\":\"kava\",\"tags\":[\"a\",\"b\"],\"ok\":true,\"none\":null}
+1
+{\"x\":3,\"y\":-4,\"label\":\"p\"}
+[1,2,3]
+\"say \\\"hi\\\"\\n\\ttab\\\\\"
+5
+4
+a/b\\c\"d
+\"\\n\\t\\r\\b\\f\"
+7
+[0,0,12345678901234567,-9007199254740993,1500.0,-0.0225,null,9223372036854775807]
+12345678901234567
+-9007199254740993
+1500
+-0.0225
+int
+double
+null
+erro de sintaxe (byte 8)
+erro de sintaxe (byte 5)
+string sem fechar (byte 0)
+numero invalido (byte 1)
+literal invalido (byte 1)
+escape invalido (byte 1)
+conteudo depois do valor (byte 3)
+documento vazio (byte 0)
+ok
+{\"deep\": [3]}
+b
+5
+2
+-1
+null
+null
+null
+{\"skip\": [[1, 2, {\"deep\": [3]}], {\"x\": \"}\"}], \"items\": [{\"n\": \"a\"}, {\"n\": \"b\", \"k/e~y\": 5}]}
+{
+  \"a\": [
+    1,
+    {
+      \"b\": []
+    }
+  ],
+  \"c\": {}
+}"
+
+cat > /tmp/kava_test_strings.kava << 'EOF'
+let s = "ab" + "cd" + 42
+print s
+print s.length()
+let r = ""
+let i = 0
+while (i < 5000) {
+    r = r + "x"
+    i = i + 1
+}
+print r.length()
+print r.charAt(4999)
+let sb = new StringBuilder()
+sb.append("k").append(1).append(".").append(5)
+print sb.toString()
+print sb.length()
+print ("key" + 7).equals("key7")
+print ("key" + 7).hashCode() == "key7".hashCode()
+fn greet(String name) {
+    let msg = "hi "
+    msg += name
+    return msg
+}
+print greet("bob")
+EOF
+run_test "String concatenation, ropes and StringBuilder" "/tmp/kava_test_strings.kava" "abcd42
+6
+5000
+120
+k1.5
+4
+1
+1
+hi bob"
+
+# Sem tipo no compilador (elemento de array, parametros): o + decide na
+# execucao, inclusive nas formas fundidas (IINC, SUPER_GLOBAL_ADD)
+cat > /tmp/kava_test_untyped_concat.kava << 'EOF'
+let names = new String[2]
+names[0] = "a"
+names[1] = "b"
+let a = names[0]
+let b = names[1]
+print a + b
+let ab = a + b
+print ab
+fn cat(x, y) {
+    return x + y
+}
+print cat("x", "y")
+print cat("n", 5)
+print cat(5, "n")
+print cat(2, 3)
+let s = a
+s = s + 1
+print s
+let acc = cat("", "")
+let i = 0
+while (i < 3) {
+    acc = acc + i
+    i = i + 1
+}
+print acc
+print cat(a, null)
+EOF
+UNTYPED_CONCAT_EXPECTED="ab
+ab
+xy
+n5
+5n
+5
+a1
+012
+anull"
+run_test "Untyped + concatenates strings" "/tmp/kava_test_untyped_concat.kava" "$UNTYPED_CONCAT_EXPECTED"
+run_test "Untyped + concatenates strings (switch dispatch)" "/tmp/kava_test_untyped_concat.kava" "$UNTYPED_CONCAT_EXPECTED" "--dispatch=switch"
+
+cat > /tmp/kava_test_gfx.kava << 'EOF'
+native_gfx_init(320, 200)
+let frame = 0
+let total = 0
+while (frame < 3) {
+    native_gfx_clear(0, 0, 0)
+    let i = 0
+    while (i < 500) {
+        native_gfx_color(i % 3 * 100, 80, 200)
+        native_gfx_draw_rect(i % 320, i % 200, 4, 4)
+        i = i + 1
+    }
+    native_gfx_present()
+    let events = native_gfx_events()
+    total = total + events.length
+    frame = frame + 1
+}
+print frame
+print total
+print native_gfx_poll_event()
+EOF
+run_test "Batched gfx frames (headless)" "/tmp/kava_test_gfx.kava" "3
+0
+0"
+
+# =============================================
+# TEST 11: Functions & Classes
+# =============================================
+echo -e "${CYAN}[Section 10] Functions & Classes${NC}"
+
+cat > /tmp/kava_test_calls.kava << 'EOF'
+fn fib(n) {
+    if (n < 2) {
+        return n
+    }
+    return fib(n - 1) + fib(n - 2)
+}
+print fib(20)
+
+class Shape {
+    int id
+    let scale = 2
+    Shape(int id) {
+        this.id = id
+    }
+    int area() {
+        return scale
+    }
+    int describe() {
+        return id * 1000 + area()
+    }
+}
+class Square extends Shape {
+    int side
+    Square(int id, int side) {
+        super(id)
+        this.side = side
+    }
+    int area() {
+        return side * side
+    }
+}
+class Circle extends Shape {
+    int r
+    Circle(int id, int r) {
+        super(id)
+        this.r = r
+    }
+    int area() {
+        return 3 * r * r
+    }
+    int describe() {
+        return super.describe() + 1
+    }
+}
+let shapes = new Shape[3]
+shapes[0] = new Square(1, 4)
+shapes[1] = new Circle(2, 2)
+shapes[2] = new Shape(3)
+let total = 0
+let i = 0
+while (i < 30) {
+    total = total + shapes[i % 3].describe()
+    i = i + 1
+}
+print total
+print shapes[1].id + shapes[2].id
+EOF
+CALLS_EXPECTED="6765
+60310
+5"
+run_test "Recursion, constructors and virtual dispatch" "/tmp/kava_test_calls.kava" "$CALLS_EXPECTED"
+run_test "Recursion, constructors and virtual dispatch (switch dispatch)" "/tmp/kava_test_calls.kava" "$CALLS_EXPECTED" "--dispatch=switch"
+
+cat > /tmp/kava_test_escape.kava << 'EOF'
+class Vec {
+    int x
+    int y
+    let tag = "vec"
+    Vec(int x, int y) {
+        this.x = x
+        this.y = y * 2
+    }
+}
+fn norm1(v) {
+    return v.x + v.y
+}
+fn sweep(n) {
+    let acc = 0
+    let i = 0
+    while (i < n) {
+        let v = new Vec(i, 1)
+        v.x = v.x + 1
+        acc = acc + v.x + v.y
+        i = i + 1
+    }
+    return acc
+}
+print sweep(1000)
+let s = ""
+let i = 0
+while (i < 100000) {
+    let t = new Vec(i, i)
+    s = t.tag
+    i = i + 1
+}
+print s
+let kept = new Vec(3, 4)
+print norm1(kept)
+EOF
+ESCAPE_EXPECTED="502500
+vec
+11"
+run_test "Scalar-replaced objects and interned string constants" "/tmp/kava_test_escape.kava" "$ESCAPE_EXPECTED"
+
+cat > /tmp/kava_test_sync.kava << 'EOF'
+class Counter {
+    int value
+    Counter(int value) {
+        this.value = value
+    }
+}
+fn bump(c, depth) {
+    synchronized (c) {
+        c.value = c.value + 1
+        if (depth > 0) {
+            bump(c, depth - 1)
+        }
+    }
+}
+let c = new Counter(0)
+let d = new Counter(0)
+let i = 0
+while (i < 20000) {
+    synchronized (c) {
+        synchronized (d) {
+            c.value = c.value + 1
+            let junk = new int[64]
+        }
+    }
+    i = i + 1
+}
+print c.value
+bump(d, 200)
+print d.value
+let s = "lock"
+synchronized (s) {
+    print s
+}
+EOF
+SYNC_EXPECTED="20000
+201
+lock"
+run_test "Synchronized blocks (biased/thin monitors)" "/tmp/kava_test_sync.kava" "$SYNC_EXPECTED"
+run_test "Synchronized blocks (no bias)" "/tmp/kava_test_sync.kava" "$SYNC_EXPECTED" "--no-biased-locking"
+
+cat > /tmp/kava_test_lines.kava << 'EOF'
+print "start"
+fn down(n) {
+    return down(n + 1)
+}
+print down(0)
+EOF
+run_test "Sectioned .kvb with line table" "/tmp/kava_test_lines.kava" "start
+StackOverflowError: down (profundidade 1000, linha 3)"
+
+# Contagem de secao corrompida (byte alto do count de cada secao): a
+# carga falha com diagnostico em vez de abortar num bad_alloc
+cat > /tmp/kava_test_kvb_corrupt.kava << 'EOF'
+fn twice(x) {
+    return x * 2
+}
+print twice(21)
+EOF
+TOTAL=$((TOTAL + 1))
+CORRUPT_OUT=""
+if $KAVAC /tmp/kava_test_kvb_corrupt.kava > /dev/null 2>&1; then
+    KVB=/tmp/kava_test_kvb_corrupt.kvb
+    SECTIONS=$(od -An -tu4 -j8 -N4 "$KVB" | tr -d ' ')
+    for i in $(seq 0 $((SECTIONS - 1))); do
+        cp "$KVB" /tmp/kava_test_kvb_bad.kvb
+        printf '\x7f' | dd of=/tmp/kava_test_kvb_bad.kvb bs=1 seek=$((12 + 16 * i + 15)) conv=notrunc 2> /dev/null
+        $KAVAVM /tmp/kava_test_kvb_bad.kvb > /tmp/kava_test_kvb_bad.out 2>&1
+        CORRUPT_OUT="$CORRUPT_OUT$? $(grep -o 'secao [A-Z]* corrompida' /tmp/kava_test_kvb_bad.out)
+"
+    done
+fi
+CORRUPT_EXPECTED="0 
+1 secao PROGRAM corrompida
+1 secao CODE corrompida
+0 
+"
+if [ "$CORRUPT_OUT" = "$CORRUPT_EXPECTED" ]; then
+    echo -e "  ${GREEN}PASS${NC} Corrupted .kvb section counts"
+    PASSED=$((PASSED + 1))
+else
+    echo -e "  ${RED}FAIL${NC} Corrupted .kvb section counts"
+    echo "    Expected: $(echo "$CORRUPT_EXPECTED" | head -3)..."
+    echo "    Got:      $(echo "$CORRUPT_OUT" | head -3)..."
+    FAILED=$((FAILED + 1))
+fi
+rm -f /tmp/kava_test_kvb_corrupt.kvb /tmp/kava_test_kvb_bad.kvb /tmp/kava_test_kvb_bad.out
+
+cat > /tmp/kava_test_snapshot.kava << 'EOF'
+class Acc {
+    int total
+    Acc() {
+        this.total = 0
+    }
+    fn add(n) {
+        this.total = this.total + n
+    }
+}
+fn sum(n) {
+    let s = 0
+    let i = 0
+    while (i < n) {
+        s = s + i % 7
+        i = i + 1
+    }
+    return s
+}
+let a = new Acc()
+let k = 0
+while (k < 200) {
+    a.add(sum(1000))
+    k = k + 1
+}
+print a.total
+EOF
+# Execucao de aquecimento grava a imagem; a imagem roda sozinha depois
+TOTAL=$((TOTAL + 1))
+SNAPSHOT_OUT=""
+if $KAVAC /tmp/kava_test_snapshot.kava > /dev/null 2>&1 &&
+   $KAVAVM --snapshot=/tmp/kava_test_snapshot.img /tmp/kava_test_snapshot.kvb > /dev/null 2>&1; then
+    SNAPSHOT_OUT=$($KAVAVM /tmp/kava_test_snapshot.img 2>&1)
+fi
+if [ "$SNAPSHOT_OUT" = "599400" ]; then
+    echo -e "  ${GREEN}PASS${NC} VM snapshot image"
+    PASSED=$((PASSED + 1))
+else
+    echo -e "  ${RED}FAIL${NC} VM snapshot image"
+    echo "    Expected: 599400..."
+    echo "    Got:      $(echo "$SNAPSHOT_OUT" | head -3)..."
+    FAILED=$((FAILED + 1))
+fi
+rm -f /tmp/kava_test_snapshot.kvb /tmp/kava_test_snapshot.img
+
+# --profile: saida do programa intacta, pilhas dobradas com a fn quente e
+# trace do Chrome com fatias; o resumo vai para o stderr
+cat > /tmp/kava_test_profile.kava << 'EOF'
+fn work(n) {
+    let s = 0
+    let i = 0
+    while (i < n) {
+        s = (s + i * 7) % 1000003
+        i = i + 1
+    }
+    return s
+}
+let r = 0
+let k = 0
+while (k < 40) {
+    r = (r + work(100000)) % 1000003
+    k = k + 1
+}
+print r
+EOF
+TOTAL=$((TOTAL + 1))
+PROFILE_OUT=""
+PROFILE_ERR=""
+if $KAVAC /tmp/kava_test_profile.kava > /dev/null 2>&1; then
+    PROFILE_OUT=$($KAVAVM --profile=/tmp/kava_test_profile /tmp/kava_test_profile.kvb 2> /tmp/kava_test_profile.err)
+    PROFILE_ERR=$(cat /tmp/kava_test_profile.err)
+fi
+PROFILE_EXPECTED=$($KAVAVM /tmp/kava_test_profile.kvb 2>&1)
+if [ -n "$PROFILE_OUT" ] && [ "$PROFILE_OUT" = "$PROFILE_EXPECTED" ] &&
+   grep -q '^<script>:[0-9]*;work:[0-9]* [0-9]*$' /tmp/kava_test_profile.folded &&
+   grep -q '"ph":"B"' /tmp/kava_test_profile.trace.json &&
+   echo "$PROFILE_ERR" | grep -q "SUPER_\|LOAD_LOCAL"; then
+    echo -e "  ${GREEN}PASS${NC} Sampling profiler (--profile)"
+    PASSED=$((PASSED + 1))
+else
+    echo -e "  ${RED}FAIL${NC} Sampling profiler (--profile)"
+    echo "    Got:      $(echo "$PROFILE_OUT" | head -3)... $(head -2 /tmp/kava_test_profile.folded 2>/dev/null)"
+    FAILED=$((FAILED + 1))
+fi
+rm -f /tmp/kava_test_profile.kvb /tmp/kava_test_profile.err /tmp/kava_test_profile.folded /tmp/kava_test_profile.trace.json
+
+# await suspende a fn async; as promises assentam fora de ordem
+cat > /tmp/kava_test_async.kava << 'EOF'
+async fn slow(ms, v) {
+    let x = await Promise.delay(ms, v)
+    return x + 1
+}
+async fn both() {
+    let a = slow(120, 10)
+    let b = slow(60, 20)
+    print await b
+    print await a
+}
+both()
+print "started"
+let total = 0
+async fn job(i) {
+    let v = await Promise.delay(i % 7, i)
+    total = total + v
+}
+let i = 0
+while (i < 2000) {
+    job(i)
+    i = i + 1
+}
+await Promise.delay(20)
+print total
+EOF
+run_test "Async/await coroutines" "/tmp/kava_test_async.kava" "started
+1999000
+21
+11"
+run_test "Async/await coroutines (switch)" "/tmp/kava_test_async.kava" "started
+1999000
+21
+11" "--dispatch=switch"
+
+# =============================================
+# TEST 12: Full KAVA 2.5 Test
 # =============================================
-echo -e "${CYAN}[Section 9] Full Integration Test${NC}"
+echo -e "${CYAN}[Section 11] Full Integration Test${NC}"
 run_test "KAVA 2.5 full test" "$ROOT_DIR/examples/test_2_5.kava" "30
 200
 2
@@ -284,6 +1046,48 @@ run_test "KAVA 2.5 full test" "$ROOT_DIR/examples/test_2_5.kava" "30
 499500
 7777"
 
+run_test "KAVA 2.5 full test (switch dispatch)" "$ROOT_DIR/examples/test_2_5.kava" "30
+200
+2
+7
+1
+3
+10
+42
+8
+14
+6
+16
+15
+12
+24
+999
+100
+499500
+7777" "--dispatch=switch"
+
+# So as flags: este heap nunca chega ao full GC nem ao ciclo concorrente;
+# os coletores em si sao cobertos na Section 13
+run_test "KAVA 2.5 full test (parallel + concurrent GC)" "$ROOT_DIR/examples/test_2_5.kava" "30
+200
+2
+7
+1
+3
+10
+42
+8
+14
+6
+16
+15
+12
+24
+999
+100
+499500
+7777" "--gc-threads=4 --concurrent-gc"
+
 run_test "KAVA 2.0 compatibility" "$ROOT_DIR/examples/test_2_0.kava" "30
 100
 0
@@ -293,6 +1097,670 @@ run_test "KAVA 2.0 compatibility" "$ROOT_DIR/examples/test_2_0.kava" "30
 4
 50"
 
+# =============================================
+# TEST 13: kpm incremental build
+# =============================================
+echo -e "${CYAN}[Section 12] Package Manager${NC}"
+
+# Cache por conteudo: no-op nao compila nada, editar um modulo importado
+# recompila ele e quem o importa, touch sem mudanca nao conta, .kvb
+# apagado volta
+TOTAL=$((TOTAL + 1))
+KPM_DIR=/tmp/kava_test_kpm
+rm -rf "$KPM_DIR"
+mkdir -p "$KPM_DIR"
+KPM_OUT=""
+if (cd "$KPM_DIR" && "$KPM" init demo > /dev/null 2>&1); then
+    rm -f "$KPM_DIR"/src/*.kava
+    printf 'fn helper() {\n    return 1\n}\n' > "$KPM_DIR/src/util.kava"
+    printf 'import util\nprint 1\n' > "$KPM_DIR/src/main.kava"
+    printf 'print 2\n' > "$KPM_DIR/src/other.kava"
+    kpm_build() {
+        (cd "$KPM_DIR" && PATH="$ROOT_DIR:$PATH" "$KPM" build 2>&1) | grep -o '[0-9]* files compiled, [0-9]* up to date'
+    }
+    KPM_OUT="$(kpm_build)
+$(kpm_build)"
+    echo '// editado' >> "$KPM_DIR/src/util.kava"
+    KPM_OUT="$KPM_OUT
+$(kpm_build)"
+    touch "$KPM_DIR/src/other.kava"
+    KPM_OUT="$KPM_OUT
+$(kpm_build)"
+    rm -f "$KPM_DIR/src/other.kvb"
+    KPM_OUT="$KPM_OUT
+$(kpm_build)"
+fi
+KPM_EXPECTED="3 files compiled, 0 up to date
+0 files compiled, 3 up to date
+2 files compiled, 1 up to date
+0 files compiled, 3 up to date
+1 files compiled, 2 up to date"
+if [ "$KPM_OUT" = "$KPM_EXPECTED" ]; then
+    echo -e "  ${GREEN}PASS${NC} kpm incremental build cache"
+    PASSED=$((PASSED + 1))
+else
+    echo -e "  ${RED}FAIL${NC} kpm incremental build cache"
+    echo "    Expected: $(echo "$KPM_EXPECTED" | head -3)..."
+    echo "    Got:      $(echo "$KPM_OUT" | head -3)..."
+    FAILED=$((FAILED + 1))
+fi
+rm -rf "$KPM_DIR"
+
+# =============================================
+# TEST 14: Runtime internals (C++)
+# =============================================
+echo -e "${CYAN}[Section 13] Runtime Internals${NC}"
+
+# 4 mutadoras com TLAB pequeno: refills e minor GCs com as raizes de todas
+# as threads; os sobreviventes precisam chegar intactos ao fim
+cat > /tmp/kava_test_tlab.cpp << 'EOF'
+#include "gc/gc.h"
+#include <thread>
+#include <vector>
+#include <cstdio>
+using namespace Kava;
+
+int main() {
+    GCConfig cfg;
+    cfg.initialHeapSize = 4 * 1024 * 1024;
+    cfg.tlabSize = 4 * 1024;
+    Heap heap;
+    heap.initialize(cfg);
+    GarbageCollector gc(heap);
+
+    const int THREADS = 4, RING = 64, ITER = 60000;
+    std::vector<std::vector<GCObject*>> rings(THREADS, std::vector<GCObject*>(RING, nullptr));
+    gc.setRootScanner([&](const GarbageCollector::RootVisitor& visit) {
+        for (auto& ring : rings)
+            for (auto& ref : ring)
+                if (ref) visit(ref);
+    });
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < THREADS; t++) {
+        workers.emplace_back([&, t] {
+            MutatorThread self(heap);
+            for (int i = 0; i < ITER; i++) {
+                GCObject* arr = heap.allocateArray(GCObjectType::ARRAY_INT, 8);
+                if (!arr) {
+                    gc.collect();
+                    arr = heap.allocateArray(GCObjectType::ARRAY_INT, 8);
+                }
+                if (!arr) { std::printf("alloc failed\n"); std::exit(1); }
+                for (int k = 0; k < 8; k++) arr->arrayElement<int32_t>(k) = t * 1000000 + i;
+                rings[t][i % RING] = arr;
+                heap.safepointPoll();
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    int bad = 0;
+    for (int t = 0; t < THREADS; t++) {
+        for (int s = 0; s < RING; s++) {
+            int i = ITER - RING + ((s - (ITER - RING) % RING) + RING) % RING;
+            for (int k = 0; k < 8; k++)
+                if (rings[t][s]->arrayElement<int32_t>(k) != t * 1000000 + i) bad++;
+        }
+    }
+    std::printf("%d\n", bad);
+    std::printf("%d\n", heap.stats.tlabRefills > THREADS ? 1 : 0);
+    std::printf("%d\n", heap.stats.minorCollections > 0 ? 1 : 0);
+    return 0;
+}
+EOF
+run_cpp_test "TLAB refills and young GC across mutator threads" "/tmp/kava_test_tlab.cpp" "0
+1
+1"
+
+# HashMap (Swiss table): insercoes, remocoes e reinsercoes contra
+# std::unordered_map, com tombstones, crescimento e hash degenerado
+cat > /tmp/kava_test_hashmap.cpp << 'EOF'
+#include "collections/collections.h"
+#include <unordered_map>
+#include <string>
+#include <cstdio>
+using namespace Kava;
+
+// Hash degenerado: poucas classes, sondagens longas entre grupos
+struct Clash {
+    int v;
+    bool operator==(const Clash& o) const { return v == o.v; }
+};
+namespace std {
+template<> struct hash<Clash> { size_t operator()(const Clash& c) const { return static_cast<size_t>(c.v % 7); } };
+}
+
+template<typename Map, typename Ref, typename MakeKey>
+int churn(Map& map, Ref& ref, MakeKey key, int ops, uint32_t seed, int range) {
+    int mismatches = 0;
+    for (int i = 0; i < ops; i++) {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        int k = static_cast<int>(seed % range);
+        if (seed % 3 == 0) {
+            auto it = ref.find(k);
+            std::string expected = it != ref.end() ? it->second : std::string();
+            if (map.remove(key(k)) != expected) mismatches++;
+            ref.erase(k);
+        } else {
+            std::string v = std::to_string(i);
+            map.put(key(k), v);
+            ref[k] = v;
+        }
+    }
+    for (auto& [k, v] : ref) {
+        std::string* got = map.get(key(k));
+        if (!got || *got != v) mismatches++;
+    }
+    if (map.size() != static_cast<int>(ref.size())) mismatches++;
+    return mismatches;
+}
+
+int main() {
+    HashMap<int, std::string> ints(16);
+    std::unordered_map<int, std::string> refInts;
+    std::printf("%d\n", churn(ints, refInts, [](int k) { return k; }, 200000, 12345u, 5000));
+
+    HashMap<Clash, std::string> clash(16);
+    std::unordered_map<int, std::string> refClash;
+    std::printf("%d\n", churn(clash, refClash, [](int k) { return Clash{k}; }, 20000, 777u, 600));
+
+    // Enche, esvazia quase tudo (tombstones) e reinsere chaves novas varias vezes
+    HashMap<int, std::string> cycle(16);
+    int bad = 0;
+    for (int round = 0; round < 50; round++) {
+        for (int k = 0; k < 1000; k++) cycle.put(round * 1000 + k, "v");
+        for (int k = 0; k < 990; k++) cycle.remove(round * 1000 + k);
+        if (cycle.size() != (round + 1) * 10) bad++;
+    }
+    for (int round = 0; round < 50; round++)
+        for (int k = 990; k < 1000; k++)
+            if (!cycle.containsKey(round * 1000 + k)) bad++;
+    if (cycle.containsKey(0) || cycle.get(49000) != nullptr) bad++;
+    std::printf("%d\n", bad);
+    return 0;
+}
+EOF
+run_cpp_test "HashMap churn with tombstones and growth" "/tmp/kava_test_hashmap.cpp" "0
+0
+0"
+
+# ConcurrentHashMap: leitores sem lock contra put/remove/resize; os nos
+# aposentados sao liberados por epoca em vez de acumular ate o destrutor
+cat > /tmp/kava_test_chm.cpp << 'EOF'
+#include "collections/collections.h"
+#include <thread>
+#include <vector>
+#include <string>
+#include <cstdio>
+using namespace Kava;
+
+int main() {
+    // Valores nao atomicos (string): toda atualizacao troca e aposenta o no
+    ConcurrentHashMap<int, std::string> map(4);
+    const int WRITERS = 4, READERS = 4, KEYS = 4096, ROUNDS = 6;
+    std::atomic<bool> done{false};
+    std::atomic<long> badReads{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < READERS; r++) {
+        readers.emplace_back([&, r] {
+            uint32_t seed = 0x9E3779B9u * (r + 1);
+            while (!done.load(std::memory_order_acquire)) {
+                seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+                int key = static_cast<int>(seed % KEYS);
+                std::string v;
+                // Valor sempre "k<key>:<rodada>", nunca lixo de no liberado
+                if (map.get(key, v) && v.compare(0, v.find(':'), "k" + std::to_string(key)) != 0) badReads++;
+            }
+        });
+    }
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < WRITERS; w++) {
+        writers.emplace_back([&, w] {
+            for (int round = 0; round < ROUNDS; round++) {
+                for (int k = w; k < KEYS; k += WRITERS) map.put(k, "k" + std::to_string(k) + ":" + std::to_string(round));
+                // Metade das chaves sai e volta: remocoes e reinsercoes
+                for (int k = w; k < KEYS; k += 2 * WRITERS) map.remove(k);
+                for (int k = w; k < KEYS; k += 2 * WRITERS) map.put(k, "k" + std::to_string(k) + ":" + std::to_string(round));
+            }
+        });
+    }
+    for (auto& t : writers) t.join();
+    done.store(true, std::memory_order_release);
+    for (auto& t : readers) t.join();
+
+    int wrong = 0;
+    for (int k = 0; k < KEYS; k++) {
+        std::string v;
+        if (!map.get(k, v) || v != "k" + std::to_string(k) + ":" + std::to_string(ROUNDS - 1)) wrong++;
+    }
+    std::printf("%d\n", map.size());
+    std::printf("%d\n", wrong);
+    std::printf("%ld\n", badReads.load());
+
+    // Atualizacoes repetidas nao acumulam nos aposentados
+    ConcurrentHashMap<int, std::string> hot(16);
+    for (int i = 0; i < 200000; i++) hot.put(i & 15, std::to_string(i));
+    std::printf("%d\n", hot.retiredCount() < 1000 ? 1 : 0);
+    return 0;
+}
+EOF
+run_cpp_test "ConcurrentHashMap concurrent put/remove/resize" "/tmp/kava_test_chm.cpp" "4096
+0
+0
+1"
+
+# HttpServer: parse incremental, rotas (parametro/curinga/404) e um reator
+# de verdade com requisicao partida e pipeline na mesma conexao keep-alive
+cat > /tmp/kava_test_http.cpp << 'EOF'
+#include "vm/runtime.h"
+#include <thread>
+#include <string>
+#include <cstdio>
+#include <unistd.h>
+using namespace Kava;
+
+static std::string readResponses(int fd, int count) {
+    std::string got;
+    char buf[4096];
+    while (true) {
+        int seen = 0;
+        for (size_t p = 0; (p = got.find("\r\n\r\n", p)) != std::string::npos; p += 4) {
+            size_t cl = got.rfind("Content-Length: ", p);
+            size_t len = cl == std::string::npos ? 0 : std::stoul(got.substr(cl + 16));
+            if (got.size() < p + 4 + len) break;
+            seen++;
+        }
+        if (seen >= count) return got;
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) return got;
+        got.append(buf, n);
+    }
+}
+
+static size_t countOf(const std::string& s, const std::string& what) {
+    size_t n = 0;
+    for (size_t p = 0; (p = s.find(what, p)) != std::string::npos; p += what.size()) n++;
+    return n;
+}
+
+int main() {
+    // Parse incremental: cabecalho pela metade, depois duas em pipeline
+    HttpRequest req;
+    std::string a = "GET /a?x=1 HTTP/1.1\r\nHost: t\r\n\r\n";
+    std::string b = "POST /b HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc";
+    std::string buf = a + b;
+    printf("%d\n", HttpRequest::parseFrom(std::string_view(a).substr(0, 20), req) == HttpRequest::INCOMPLETE);
+    printf("%d\n", HttpRequest::parseFrom(std::string_view(buf).substr(0, a.size() + 40), req) == a.size());
+    printf("%s %s %s\n", req.method.c_str(), req.path.c_str(), req.queryParams["x"].c_str());
+    printf("%d\n", HttpRequest::parseFrom(std::string_view(buf).substr(a.size(), b.size() - 1), req) == HttpRequest::INCOMPLETE);
+    printf("%d %s %s\n", HttpRequest::parseFrom(std::string_view(buf).substr(a.size()), req) == b.size(),
+           req.method.c_str(), req.body.c_str());
+    printf("%d\n", HttpRequest::parseFrom("GARBAGE\r\n\r\n", req) == HttpRequest::MALFORMED);
+    
+    // Roteador: exata, parametro, curinga mais longo e ausencia
+    HttpRouter router;
+    auto tag = [](const char* t) { return [t](const HttpRequest&) { HttpResponse r; r.text(t); return r; }; };
+    router.add("GET", "/users/me", tag("me"));
+    router.add("GET", "/users/:id", tag("user"));
+    router.add("GET", "/users/:id/posts/:post", tag("post"));
+    router.add("GET", "/static/*", tag("static"));
+    router.add("GET", "/static/img/*", tag("img"));
+    router.add("GET", "/api", tag("api"));
+    HttpRouter::Params params;
+    HttpRequest dummy;
+    auto route = [&](const char* path) {
+        params.clear();
+        const RouteHandler* h = router.find("GET", path, &params);
+        return h ? (*h)(dummy).body : std::string("-");
+    };
+    printf("%s %s\n", route("/users/me").c_str(), route("/users/42").c_str());
+    printf("%s %s %s\n", route("/users/7/posts/99").c_str(), params["id"].c_str(), params["post"].c_str());
+    printf("%s %s\n", route("/static/css/a.css").c_str(), route("/static/img/a.png").c_str());
+    printf("%s %s %s\n", route("/users/").c_str(), route("/api/x").c_str(), route("/nope").c_str());
+    printf("%d\n", router.find("POST", "/api") == nullptr);
+    
+    // Servidor de verdade: requisicao em dois pedacos, pipeline com
+    // keep-alive na mesma conexao, 404 e "Connection: close"
+    int port = 20000 + getpid() % 20000;
+    HttpServer server(port, 1);
+    server.get("/users/:id", [](const HttpRequest& r) {
+        HttpResponse resp;
+        resp.text("user " + r.params.at("id"));
+        return resp;
+    });
+    server.get("/files/*", [](const HttpRequest& r) {
+        HttpResponse resp;
+        resp.text("file " + r.path);
+        return resp;
+    });
+    if (!server.listen()) { printf("listen failed\n"); return 1; }
+    std::thread t([&] { server.serve(); });
+    
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) { printf("connect failed\n"); return 1; }
+    
+    std::string partial = "GET /users/5 HTTP/1.1\r\nHost: t\r\n\r\n";
+    write(fd, partial.data(), 10);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    write(fd, partial.data() + 10, partial.size() - 10);
+    std::string r1 = readResponses(fd, 1);
+    printf("%d %d %d\n", r1.find("HTTP/1.1 200") == 0, (int)countOf(r1, "user 5"), (int)countOf(r1, "keep-alive"));
+    
+    std::string pipelined = "GET /files/a/b.txt HTTP/1.1\r\n\r\n"
+                            "GET /missing HTTP/1.1\r\n\r\n"
+                            "GET /users/9 HTTP/1.1\r\nConnection: close\r\n\r\n";
+    write(fd, pipelined.data(), pipelined.size());
+    std::string r2 = readResponses(fd, 3);
+    size_t f = r2.find("file /files/a/b.txt"), nf = r2.find("Not Found: /missing"), u = r2.find("user 9");
+    printf("%d %d %d\n", (int)countOf(r2, "HTTP/1.1 "), (int)countOf(r2, " 404 "), f < nf && nf < u && u != std::string::npos);
+    printf("%d\n", (int)countOf(r2, "Connection: close"));
+    char c;
+    printf("%d\n", (int)read(fd, &c, 1));   // servidor fechou depois do close
+    close(fd);
+    
+    server.stop();
+    t.join();
+    return 0;
+}
+EOF
+run_cpp_test "HttpServer parsing, routing and keep-alive pipelining" "/tmp/kava_test_http.cpp" "1
+1
+GET /a 1
+1
+1 POST abc
+1
+me user
+post 7 99
+static img
+- - -
+1
+1 1 1
+3 1 1
+1
+0"
+
+# TimerWheel/EventLoop: cascata nas viradas de nivel, cancelamento antes
+# de vencer e entregas de outras threads pela fila MPSC
+cat > /tmp/kava_test_timers.cpp << 'EOF'
+#include "vm/async.h"
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+using namespace Kava;
+
+int main() {
+    // Vencimentos em cima e em volta das viradas de nivel (256, 65536, 2^24):
+    // cada um precisa disparar exatamente no seu tick, depois das cascatas
+    {
+        TimerWheel wheel;
+        const uint64_t at[] = {1, 255, 256, 257, 511, 512, 65535, 65536, 65537, 70000,
+                               16777215, 16777216, 16777217, 20000000};
+        int wrong = 0, fired = 0;
+        for (uint64_t e : at) wheel.add(e, 0, [&, e] { fired++; if (wheel.current() != e) wrong++; });
+        for (uint64_t t = 0; t < 16777300; t += 997) wheel.advance(t);  // passos que nao alinham
+        wheel.advance(20000000);
+        std::printf("%d %d %zu\n", fired, wrong, wheel.size());
+    }
+    
+    // Aleatorio contra uma referencia: vencimentos em todos os niveis,
+    // metade cancelada antes de vencer, avancos de tamanho variado
+    {
+        TimerWheel wheel;
+        std::mt19937_64 rng(42);
+        const int N = 20000;
+        std::vector<uint64_t> expiry(N);
+        std::vector<int> ids(N), firedAt(N, -1), count(N, 0);
+        std::vector<bool> cancelled(N, false);
+        uint64_t last = 0;
+        int outOfOrder = 0;
+        for (int i = 0; i < N; i++) {
+            const int level = static_cast<int>(rng() % 4);
+            expiry[i] = 1 + rng() % (1ULL << (8 * (level + 1)));
+            ids[i] = wheel.add(expiry[i], 0, [&, i] {
+                count[i]++;
+                firedAt[i] = static_cast<int>(wheel.current() == expiry[i]);
+                if (wheel.current() < last) outOfOrder++;
+                last = wheel.current();
+            });
+        }
+        int cancelOk = 0;
+        for (int i = 0; i < N; i += 2) {
+            cancelled[i] = true;
+            cancelOk += wheel.cancel(ids[i]);
+        }
+        int staleOk = 0;
+        for (int i = 0; i < N; i += 2) staleOk += wheel.cancel(ids[i]);
+        uint64_t t = 0;
+        while (wheel.size() > 0) {
+            t += 1 + rng() % 40000;
+            wheel.advance(t);
+        }
+        int bad = 0;
+        for (int i = 0; i < N; i++) {
+            if (cancelled[i] ? count[i] != 0 : (count[i] != 1 || firedAt[i] != 1)) bad++;
+        }
+        std::printf("%d %d %d %d\n", cancelOk == N / 2, staleOk, bad, outOfOrder);
+    }
+    
+    // Dois timers do mesmo slot que cancelam um ao outro (so um dispara), um id
+    // antigo de slot reciclado e um intervalo que atravessa a virada
+    // (cancelado por ele mesmo no quinto disparo)
+    {
+        TimerWheel wheel;
+        int fired = 0, a = 0, b = 0, every = 0;
+        a = wheel.add(300, 0, [&] { fired++; wheel.cancel(b); });
+        b = wheel.add(300, 0, [&] { fired++; wheel.cancel(a); });
+        wheel.advance(300);
+        const int old = wheel.add(310, 0, [] {});
+        wheel.cancel(old);
+        const int fresh = wheel.add(320, 0, [] {});
+        std::vector<uint64_t> at;
+        every = wheel.add(400, 100, [&] {
+            at.push_back(wheel.current());
+            if (at.size() == 5) wheel.cancel(every);
+        });
+        std::printf("%d %d %d\n", fired, wheel.cancel(old), wheel.cancel(fresh));
+        wheel.advance(5000);
+        for (uint64_t a : at) std::printf("%llu ", static_cast<unsigned long long>(a));
+        std::printf("%zu\n", wheel.size());
+    }
+    
+    // Threads de fora entregam por completeIO (fila MPSC); a ordem de cada
+    // produtor se mantem e os timers agendados a partir delas disparam
+    {
+        EventLoop loop;
+        const int PRODUCERS = 4, EACH = 20000;
+        std::vector<int> next(PRODUCERS, 0);
+        int delivered = 0, outOfOrder = 0, timersFired = 0;
+        std::vector<std::thread> producers;
+        for (int p = 0; p < PRODUCERS; p++) {
+            producers.emplace_back([&, p] {
+                for (int i = 0; i < EACH; i++) {
+                    loop.completeIO([&, p, i] {
+                        if (next[p] != i) outOfOrder++;
+                        next[p] = i + 1;
+                        delivered++;
+                        if (i % 1000 == 0) loop.setTimeout([&] { timersFired++; }, 1 + i % 7);
+                    });
+                }
+            });
+        }
+        // O intervalo segura o loop ate tudo chegar e os timers dispararem
+        int watchdog = 0;
+        watchdog = loop.setInterval([&] {
+            if (delivered == PRODUCERS * EACH && timersFired == PRODUCERS * EACH / 1000) loop.clearInterval(watchdog);
+        }, 1);
+        loop.runFor(10000);
+        for (auto& t : producers) t.join();
+        std::printf("%d %d %d %zu\n", delivered, outOfOrder, timersFired, loop.pendingTimers());
+    }
+    return 0;
+}
+EOF
+run_cpp_test "TimerWheel cascading, cancellation and cross-thread completions" "/tmp/kava_test_timers.cpp" "14 0 0
+1 0 0 0
+1 0 1
+400 500 600 700 800 0
+80000 0 80 0"
+
+# Mutadora parada em Thread.sleep ou na espera do event loop conta como
+# bloqueada: o stopTheWorld de outra thread sai sem esperar o fim do sono
+cat > /tmp/kava_test_blocking.cpp << 'EOF'
+#include "vm/vm.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+using namespace Kava;
+
+// Pede um safepoint enquanto a thread da VM (main) dorme em wait()
+template <typename Wait>
+int stopsWhileBlocked(VM& vm, Wait wait) {
+    double stoppedMs = -1;
+    std::thread collector([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        MutatorThread self(vm.heap);
+        auto t0 = std::chrono::steady_clock::now();
+        if (vm.heap.stopTheWorld()) vm.heap.resumeTheWorld();
+        stoppedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    });
+    {
+        MutatorThread self(vm.heap);
+        wait();
+    }
+    collector.join();
+    return stoppedMs >= 0 && stoppedMs < 300 ? 1 : 0;
+}
+
+int main() {
+    VM vm;
+    std::printf("%d\n", stopsWhileBlocked(vm, [&] {
+        vm.nativeMethods.at("Thread.sleep")(&vm, nullptr, {Value(int64_t(600))});
+    }));
+    std::printf("%d\n", stopsWhileBlocked(vm, [&] {
+        vm.eventLoop.setTimeout([] {}, 600);
+        vm.eventLoop.run();
+    }));
+    return 0;
+}
+EOF
+run_cpp_test "Blocking natives release safepoints" "/tmp/kava_test_blocking.cpp" "1
+1"
+
+# Loop quente no codigo nativo (OSR) nao tem safepoint: a VM o roda como
+# bloqueio, entao outra mutadora para o mundo sem esperar o loop acabar
+cat > /tmp/kava_test_osr_safepoint.cpp << 'EOF'
+#include "vm/vm.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+using namespace Kava;
+
+int main() {
+    VM vm;
+    if (!NativeJIT::available()) {  // Sem backend: nada a testar
+        std::printf("1\n1\n");
+        return 0;
+    }
+    // let sum = 0  let n = 0  while (n < 2000000000) { sum = sum + n  n = n + 1 }
+    vm.loadBytecode(std::vector<int32_t>{
+        OP_ICONST_0, OP_STORE_GLOBAL, 0, OP_ICONST_0, OP_STORE_GLOBAL, 1,
+        OP_LOAD_GLOBAL, 1, OP_PUSH_INT, 2000000000, OP_ILT, OP_JZ, 32,
+        OP_LOAD_GLOBAL, 0, OP_LOAD_GLOBAL, 1, OP_IADD, OP_DUP, OP_STORE_GLOBAL, 0, OP_POP,
+        OP_LOAD_GLOBAL, 1, OP_ICONST_1, OP_IADD, OP_DUP, OP_STORE_GLOBAL, 1, OP_POP,
+        OP_JMP, 6,
+        OP_HALT});
+    std::thread runner([&] { vm.run(); });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    double stoppedMs = -1;
+    {
+        MutatorThread self(vm.heap);
+        auto t0 = std::chrono::steady_clock::now();
+        if (vm.heap.stopTheWorld()) vm.heap.resumeTheWorld();
+        stoppedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+    const bool native = !vm.nativeJIT.loops.empty();
+    runner.join();
+    std::printf("%d\n", native ? 1 : 0);
+    std::printf("%d\n", stoppedMs >= 0 && stoppedMs < 100 ? 1 : 0);
+    return 0;
+}
+EOF
+run_cpp_test "Safepoint while a native OSR loop runs" "/tmp/kava_test_osr_safepoint.cpp" "1
+1"
+
+# Heap pequeno com 2 threads de GC e marcacao concorrente: o full GC paralelo
+# e o ciclo concorrente precisam rodar de fato e o conjunto vivo sobreviver
+cat > /tmp/kava_test_gc_parallel.cpp << 'EOF'
+#include "gc/gc.h"
+#include <thread>
+#include <vector>
+#include <cstdio>
+using namespace Kava;
+
+int main() {
+    GCConfig cfg;
+    cfg.initialHeapSize = 4 * 1024 * 1024;
+    cfg.maxHeapSize = 64 * 1024 * 1024;
+    cfg.parallelGCThreads = 2;
+    cfg.parallelThreshold = 512 * 1024;
+    cfg.dynamicGCThreads = false;  // 2 workers mesmo com uma CPU so
+    cfg.concurrentMark = true;
+    cfg.tenureThreshold = 2;
+    Heap heap;
+    heap.initialize(cfg);
+    GarbageCollector gc(heap);
+    gc.setWorkerRunner([](int n, const std::function<void(int)>& body) {
+        std::vector<std::thread> pool;
+        for (int i = 1; i < n; i++) pool.emplace_back(body, i);
+        body(0);
+        for (auto& t : pool) t.join();
+    });
+
+    const int32_t LIVE = 8192;
+    const int ITER = 49 * LIVE;
+    GCObject* root = heap.allocateArray(GCObjectType::ARRAY_OBJECT, LIVE);
+    gc.addRoot(&root);
+    for (int i = 0; i < ITER; i++) {
+        GCObject* arr = heap.allocateArray(GCObjectType::ARRAY_INT, 16);
+        if (!arr) {
+            gc.collect();
+            arr = heap.allocateArray(GCObjectType::ARRAY_INT, 16);
+        }
+        if (!arr) { std::printf("alloc failed\n"); return 1; }
+        for (int k = 0; k < 16; k++) arr->arrayElement<int32_t>(k) = i;
+        GCObject** slot = &root->arrayElement<GCObject*>(i % LIVE);
+        *slot = arr;
+        gc.writeBarrier(root, slot, arr);
+        if (heap.gcRequested) gc.collect();  // Remark pedido pelo marcador
+    }
+
+    int bad = 0;
+    for (int32_t s = 0; s < LIVE; s++) {
+        GCObject* arr = root->arrayElement<GCObject*>(s);
+        const int expected = ITER - LIVE + s;
+        for (int k = 0; k < 16; k++)
+            if (arr->arrayElement<int32_t>(k) != expected) bad++;
+    }
+    std::printf("%d\n", bad);
+    std::printf("%d\n", heap.stats.parallelCollections > 0 ? 1 : 0);
+    std::printf("%d\n", heap.stats.concurrentCycles > 0 ? 1 : 0);
+    gc.removeRoot(&root);
+    return 0;
+}
+EOF
+run_cpp_test "Parallel full GC and concurrent mark cycle" "/tmp/kava_test_gc_parallel.cpp" "0
+1
+1"
+
 # =============================================
 # SUMMARY
 # =============================================
@@ -308,6 +1776,6 @@ echo "════════════════════════
 echo ""
 
 # Cleanup
-rm -f /tmp/kava_test_*.kava /tmp/kava_test_*.kvb
+rm -f /tmp/kava_test_*.kava /tmp/kava_test_*.kvb /tmp/kava_test_*.cpp
 
 exit $FAILED
@@ -0,0 +1,556 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 KAVA Team
+ *
+ * KAVA 2.5 - Monitores (thin lock, monitor inflado e bias)
+ * Cada objeto tem uma palavra de lock de 32 bits (GCHeader::lockWord; o
+ * ReentrantLock tem a sua). Sem disputa, entrar e sair custa um CAS na
+ * palavra (thin lock). Sob disputa a thread gira um pouco (spin adaptativo)
+ * e depois infla a palavra para um monitor da MonitorTable, com mutex e
+ * condition variables, onde as threads bloqueiam. Com bias, a primeira
+ * thread que trava o objeto o reserva e passa a entrar/sair sem instrução
+ * atômica nenhuma; outra thread que queira o objeto revoga o bias num
+ * safepoint (MonitorRuntime::atSafepoint) e o objeto nunca mais recebe bias.
+ *
+ * Palavra de lock:
+ *   [31..10 thread | 9..3 contagem | 2 sem bias | 1..0 estado]
+ *   estado 0  neutro:  0 aceita bias, NO_BIAS não
+ *   estado 1  thin:    contagem = entradas do dono (1..127)
+ *   estado 2  inflado: bits 31..2 = índice do monitor na MonitorTable
+ *   estado 3  biased:  contagem = entradas do dono (0 = reservado e livre)
+ */
+
+#ifndef KAVA_MONITOR_H
+#define KAVA_MONITOR_H
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+namespace Kava {
+
+namespace LockWord {
+    constexpr uint32_t STATE_MASK = 0x3;
+    constexpr uint32_t NEUTRAL = 0;
+    constexpr uint32_t THIN = 1;
+    constexpr uint32_t INFLATED = 2;
+    constexpr uint32_t BIASED = 3;
+    constexpr uint32_t NO_BIAS = 0x4;
+    constexpr int COUNT_SHIFT = 3;
+    constexpr uint32_t COUNT_ONE = 1u << COUNT_SHIFT;
+    constexpr uint32_t MAX_COUNT = 0x7F;
+    constexpr int OWNER_SHIFT = 10;
+    constexpr uint32_t MAX_THREADS = (1u << (32 - OWNER_SHIFT)) - 1;
+
+    inline uint32_t state(uint32_t w) { return w & STATE_MASK; }
+    inline uint32_t owner(uint32_t w) { return w >> OWNER_SHIFT; }
+    inline uint32_t count(uint32_t w) { return (w >> COUNT_SHIFT) & MAX_COUNT; }
+    inline uint32_t monitorIndex(uint32_t w) { return w >> 2; }
+
+    // Thin lock sempre carrega NO_BIAS: ao sair a palavra volta a NO_BIAS
+    inline uint32_t thin(uint32_t owner, uint32_t count) {
+        return owner << OWNER_SHIFT | count << COUNT_SHIFT | NO_BIAS | THIN;
+    }
+    inline uint32_t biased(uint32_t owner, uint32_t count) {
+        return owner << OWNER_SHIFT | count << COUNT_SHIFT | BIASED;
+    }
+    inline uint32_t inflated(uint32_t index) { return index << 2 | INFLATED; }
+
+    inline uint32_t load(const uint32_t& word) { return __atomic_load_n(&word, __ATOMIC_ACQUIRE); }
+    inline bool cas(uint32_t& word, uint32_t& expected, uint32_t desired) {
+        return __atomic_compare_exchange_n(&word, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    }
+}
+
+// ============================================================
+// ID DE THREAD PARA A PALAVRA DE LOCK
+// ============================================================
+// 22 bits, 0 = nenhuma. Ids de threads encerradas são reutilizados.
+class MonitorThreadId {
+public:
+    static uint32_t current() {
+        static thread_local Slot slot;
+        return slot.id;
+    }
+
+private:
+    struct Slot {
+        uint32_t id;
+        Slot() : id(acquire()) {}
+        ~Slot() { release(id); }
+    };
+
+    struct Pool {
+        std::mutex lock;
+        std::vector<uint32_t> free;
+        uint32_t next = 1;
+    };
+
+    static Pool& pool() {
+        static Pool* p = new Pool();  // Sobrevive às threads que saem depois do main
+        return *p;
+    }
+
+    static uint32_t acquire() {
+        Pool& p = pool();
+        std::lock_guard<std::mutex> guard(p.lock);
+        if (!p.free.empty()) {
+            uint32_t id = p.free.back();
+            p.free.pop_back();
+            return id;
+        }
+        if (p.next > LockWord::MAX_THREADS) throw std::runtime_error("Monitor: ids de thread esgotados");
+        return p.next++;
+    }
+
+    static void release(uint32_t id) {
+        Pool& p = pool();
+        std::lock_guard<std::mutex> guard(p.lock);
+        p.free.push_back(id);
+    }
+};
+
+// ============================================================
+// MONITOR RUNTIME - ganchos do dono da memória dos objetos
+// ============================================================
+// Palavras dentro de objetos móveis: quem as trava precisa parar o mundo para
+// revogar bias e avisar o GC quando bloqueia. Sem runtime não há bias e o
+// bloqueio é um wait comum (ex.: ReentrantLock).
+class MonitorRuntime {
+public:
+    virtual ~MonitorRuntime() = default;
+
+    // A thread atual pode receber bias (precisa parar em safepoints)
+    virtual bool canBias() { return false; }
+
+    // Roda fn com as demais threads paradas. false: outra thread coletou
+    // antes, os objetos podem ter se movido e fn não rodou
+    virtual bool atSafepoint(const std::function<void()>& fn) { fn(); return true; }
+
+    // Espera sem tocar no heap (conta como parada para o GC)
+    virtual void blocking(const std::function<void()>& wait) { wait(); }
+};
+
+// ============================================================
+// OBJECT MONITOR - monitor inflado
+// ============================================================
+struct ObjectMonitor {
+    std::mutex mutex;
+    std::condition_variable entry;     // Threads esperando o dono sair
+    std::condition_variable waitSet;   // wait()/await()
+    uint32_t owner = 0;
+    uint32_t count = 0;
+    uint32_t entrants = 0;             // Bloqueadas em entry
+    uint32_t waiters = 0;              // Em waitSet
+    uint32_t signals = 0;              // notify() ainda não consumidos
+    uint32_t nextFree = 0;             // Lista livre da tabela (índice + 1)
+};
+
+// ============================================================
+// MONITOR TABLE
+// ============================================================
+// Monitores inflados em blocos estáveis (índice -> endereço sem lock). A VM
+// tem a sua tabela (varrida no full GC: sweep libera os monitores de objetos
+// mortos); locks nativos usam shared().
+class MonitorTable {
+public:
+    enum class Status { Acquired, TimedOut, Relocated };
+
+    struct Stats {
+        std::atomic<uint64_t> inflations{0};
+        std::atomic<uint64_t> revocations{0};
+        std::atomic<uint64_t> contendedSpins{0};   // Disputas resolvidas girando
+    };
+
+    MonitorTable() {
+        // Numa CPU só girar não adianta: o dono não roda enquanto giramos
+        if (std::thread::hardware_concurrency() <= 1) spinLimit = 0;
+    }
+    ~MonitorTable() {
+        for (auto& c : chunks) delete[] c.load(std::memory_order_relaxed);
+    }
+    MonitorTable(const MonitorTable&) = delete;
+    MonitorTable& operator=(const MonitorTable&) = delete;
+
+    static MonitorTable& shared() {
+        static MonitorTable* table = new MonitorTable();
+        return *table;
+    }
+
+    Stats stats;
+
+    // false só com runtime: a revogação de bias cedeu o lugar a uma coleta e
+    // o chamador precisa recarregar o objeto (a palavra mudou de endereço)
+    bool enter(uint32_t& word, MonitorRuntime* rt = nullptr) {
+        return acquire(word, rt, nullptr, true) == Status::Acquired;
+    }
+
+    Status tryEnter(uint32_t& word, MonitorRuntime* rt = nullptr) {
+        return acquire(word, rt, nullptr, false);
+    }
+
+    Status tryEnterUntil(uint32_t& word, std::chrono::steady_clock::time_point deadline, MonitorRuntime* rt = nullptr) {
+        return acquire(word, rt, &deadline, true);
+    }
+
+    // false: a thread atual não é a dona
+    bool exit(uint32_t& word) {
+        using namespace LockWord;
+        const uint32_t self = MonitorThreadId::current();
+        uint32_t w = load(word);
+        for (;;) {
+            switch (state(w)) {
+                case BIASED:
+                    // Só o dono grava a palavra com bias (os outros só no safepoint)
+                    if (owner(w) != self || count(w) == 0) return false;
+                    __atomic_store_n(&word, w - COUNT_ONE, __ATOMIC_RELEASE);
+                    return true;
+                case THIN:
+                    if (owner(w) != self) return false;
+                    if (cas(word, w, count(w) == 1 ? NO_BIAS : w - COUNT_ONE)) return true;
+                    continue;  // Inflado por quem disputa: sai pelo monitor
+                case INFLATED:
+                    return exitInflated(at(monitorIndex(w)), self);
+                default:
+                    return false;
+            }
+        }
+    }
+
+    // Solta o monitor inteiro, espera notify (ou o prazo) e volta com a mesma
+    // contagem. false: a thread não é a dona; timedOut diz se o prazo venceu
+    bool wait(uint32_t& word, const std::chrono::steady_clock::time_point* deadline = nullptr,
+              MonitorRuntime* rt = nullptr, bool* timedOut = nullptr) {
+        const uint32_t self = MonitorThreadId::current();
+        ObjectMonitor* m = inflateOwned(word, self);
+        if (!m) return false;
+
+        std::unique_lock<std::mutex> lock(m->mutex);
+        if (m->owner != self) return false;
+        const uint32_t saved = m->count;
+        m->owner = 0;
+        m->count = 0;
+        if (m->entrants) m->entry.notify_one();
+        m->waiters++;
+        lock.unlock();
+
+        bool expired = false;
+        block(rt, [&] {
+            std::unique_lock<std::mutex> inner(m->mutex);
+            auto signaled = [m] { return m->signals > 0; };
+            if (deadline) expired = !m->waitSet.wait_until(inner, *deadline, signaled);
+            else m->waitSet.wait(inner, signaled);
+            if (!expired) m->signals--;
+            m->waiters--;
+            if (m->signals > m->waiters) m->signals = m->waiters;
+        });
+
+        lock.lock();
+        enterInflated(*m, self, lock, rt, nullptr);
+        m->count = saved;
+        if (timedOut) *timedOut = expired;
+        return true;
+    }
+
+    bool notify(uint32_t& word, bool all) {
+        using namespace LockWord;
+        const uint32_t self = MonitorThreadId::current();
+        const uint32_t w = load(word);
+        if (state(w) != INFLATED) return holdCount(word) > 0;  // Sem monitor não há quem espere
+        ObjectMonitor* m = at(monitorIndex(w));
+        std::lock_guard<std::mutex> lock(m->mutex);
+        if (m->owner != self) return false;
+        if (all) {
+            m->signals = m->waiters;
+            m->waitSet.notify_all();
+        } else if (m->signals < m->waiters) {
+            m->signals++;
+            m->waitSet.notify_one();
+        }
+        return true;
+    }
+
+    // Entradas da thread atual (0 quando não é a dona)
+    uint32_t holdCount(const uint32_t& word) {
+        using namespace LockWord;
+        const uint32_t self = MonitorThreadId::current();
+        const uint32_t w = load(word);
+        switch (state(w)) {
+            case THIN:
+            case BIASED:
+                return owner(w) == self ? count(w) : 0;
+            case INFLATED: {
+                ObjectMonitor* m = at(monitorIndex(w));
+                std::lock_guard<std::mutex> lock(m->mutex);
+                return m->owner == self ? m->count : 0;
+            }
+            default:
+                return 0;
+        }
+    }
+
+    bool isLocked(const uint32_t& word) {
+        using namespace LockWord;
+        const uint32_t w = load(word);
+        switch (state(w)) {
+            case THIN: return true;
+            case BIASED: return count(w) > 0;
+            case INFLATED: {
+                ObjectMonitor* m = at(monitorIndex(w));
+                std::lock_guard<std::mutex> lock(m->mutex);
+                return m->owner != 0;
+            }
+            default: return false;
+        }
+    }
+
+    bool isHeldByCurrentThread(const uint32_t& word) { return holdCount(word) > 0; }
+
+    // Devolve o monitor de uma palavra que não será mais usada (ex.: ~ReentrantLock)
+    void release(uint32_t word) {
+        if (LockWord::state(word) == LockWord::INFLATED) free(LockWord::monitorIndex(word));
+    }
+
+    // Com o mundo parado: libera todo monitor em uso cujo índice não está em
+    // live (nenhum objeto vivo aponta para ele)
+    void sweep(const std::vector<bool>& live) {
+        std::lock_guard<std::mutex> guard(allocLock);
+        for (uint32_t i = 1; i < nextIndex; i++) {
+            if (inUse[i] && (i >= live.size() || !live[i])) freeLocked(i);
+        }
+    }
+
+    size_t inflatedCount() const { return active.load(std::memory_order_relaxed); }
+    uint32_t capacity() const { return nextIndex; }
+
+private:
+    static constexpr uint32_t CHUNK_BITS = 8;
+    static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+    static constexpr uint32_t MAX_CHUNKS = 4096;
+    static constexpr int MIN_SPIN = 16;
+    static constexpr int MAX_SPIN = 4096;
+
+    std::atomic<ObjectMonitor*> chunks[MAX_CHUNKS] = {};
+    std::mutex allocLock;
+    std::vector<bool> inUse = std::vector<bool>(1, false);
+    uint32_t freeHead = 0;     // Índice + 1 (0 = vazia)
+    uint32_t nextIndex = 1;    // 0 não é usado
+    std::atomic<size_t> active{0};
+    std::atomic<int> spinLimit{256};  // Dobra quando girar resolveu, cai à metade quando não
+
+    ObjectMonitor* at(uint32_t index) {
+        return &chunks[index >> CHUNK_BITS].load(std::memory_order_acquire)[index & (CHUNK_SIZE - 1)];
+    }
+
+    // 0: tabela cheia
+    uint32_t allocate(uint32_t owner, uint32_t count) {
+        std::lock_guard<std::mutex> guard(allocLock);
+        uint32_t index;
+        if (freeHead) {
+            index = freeHead - 1;
+            freeHead = at(index)->nextFree;
+        } else {
+            if (nextIndex >= MAX_CHUNKS * CHUNK_SIZE) return 0;
+            index = nextIndex++;
+            auto& chunk = chunks[index >> CHUNK_BITS];
+            if (!chunk.load(std::memory_order_relaxed)) chunk.store(new ObjectMonitor[CHUNK_SIZE], std::memory_order_release);
+            inUse.resize(nextIndex, false);
+        }
+        ObjectMonitor* m = at(index);
+        m->owner = owner;
+        m->count = count;
+        m->entrants = m->waiters = m->signals = 0;
+        inUse[index] = true;
+        active.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    void free(uint32_t index) {
+        std::lock_guard<std::mutex> guard(allocLock);
+        if (inUse[index]) freeLocked(index);
+    }
+
+    void freeLocked(uint32_t index) {
+        inUse[index] = false;
+        at(index)->nextFree = freeHead;
+        freeHead = index + 1;
+        active.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    static void block(MonitorRuntime* rt, const std::function<void()>& wait) {
+        if (rt) rt->blocking(wait);
+        else wait();
+    }
+
+    static void spinPause() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    // Troca a palavra w por um monitor com o mesmo dono/contagem. false: a
+    // palavra mudou antes (w é recarregada) ou a tabela encheu
+    bool inflate(uint32_t& word, uint32_t& w, uint32_t owner, uint32_t count) {
+        const uint32_t index = allocate(owner, count);
+        if (!index) {
+            std::this_thread::yield();
+            w = LockWord::load(word);
+            return false;
+        }
+        if (LockWord::cas(word, w, LockWord::inflated(index))) {
+            stats.inflations.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        free(index);
+        return false;
+    }
+
+    // Monitor inflado de uma palavra que a thread atual possui (para wait)
+    ObjectMonitor* inflateOwned(uint32_t& word, uint32_t self) {
+        using namespace LockWord;
+        uint32_t w = load(word);
+        for (;;) {
+            if (state(w) == INFLATED) return at(monitorIndex(w));
+            if ((state(w) != THIN && state(w) != BIASED) || owner(w) != self || count(w) == 0) return nullptr;
+            inflate(word, w, self, count(w));
+            w = load(word);
+        }
+    }
+
+    // Chamada com lock (m->mutex) travado
+    Status enterInflated(ObjectMonitor& m, uint32_t self, std::unique_lock<std::mutex>& lock, MonitorRuntime* rt,
+                         const std::chrono::steady_clock::time_point* deadline) {
+        while (m.owner != 0 && m.owner != self) {
+            m.entrants++;
+            lock.unlock();
+            bool expired = false;
+            // m->mutex solto fora do wait: bloquear o GC segurando o mutex
+            // travaria quem ainda não chegou ao safepoint
+            block(rt, [&] {
+                std::unique_lock<std::mutex> inner(m.mutex);
+                auto released = [&m] { return m.owner == 0; };
+                if (deadline) expired = !m.entry.wait_until(inner, *deadline, released);
+                else m.entry.wait(inner, released);
+            });
+            lock.lock();
+            m.entrants--;
+            if (expired && m.owner != 0) return Status::TimedOut;
+        }
+        if (m.owner == self) {
+            m.count++;
+        } else {
+            m.owner = self;
+            m.count = 1;
+        }
+        return Status::Acquired;
+    }
+
+    bool exitInflated(ObjectMonitor* m, uint32_t self) {
+        std::lock_guard<std::mutex> lock(m->mutex);
+        if (m->owner != self) return false;
+        if (--m->count == 0) {
+            m->owner = 0;
+            if (m->entrants) m->entry.notify_one();
+        }
+        return true;
+    }
+
+    // Revoga o bias de outra thread: dono com entradas vira thin, sem
+    // entradas volta a neutro; nos dois casos o objeto perde o bias
+    bool revokeBias(uint32_t& word, MonitorRuntime* rt) {
+        using namespace LockWord;
+        auto revoke = [&word] {
+            const uint32_t w = __atomic_load_n(&word, __ATOMIC_RELAXED);
+            if (state(w) != BIASED) return;
+            __atomic_store_n(&word, count(w) ? thin(owner(w), count(w)) : NO_BIAS, __ATOMIC_RELEASE);
+        };
+        if (!rt->atSafepoint(revoke)) return false;
+        stats.revocations.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Status acquire(uint32_t& word, MonitorRuntime* rt, const std::chrono::steady_clock::time_point* deadline, bool wait) {
+        using namespace LockWord;
+        const uint32_t self = MonitorThreadId::current();
+        uint32_t w = load(word);
+
+        // Dono do bias: sem CAS (ninguém mais grava a palavra fora de um safepoint)
+        if (state(w) == BIASED && owner(w) == self && count(w) < MAX_COUNT) {
+            __atomic_store_n(&word, w + COUNT_ONE, __ATOMIC_RELAXED);
+            return Status::Acquired;
+        }
+
+        int spins = 0;
+        for (;;) {
+            switch (state(w)) {
+                case NEUTRAL: {
+                    const uint32_t desired = w == 0 && rt && rt->canBias() ? biased(self, 1) : thin(self, 1);
+                    if (cas(word, w, desired)) {
+                        if (spins) adaptSpin(true);
+                        return Status::Acquired;
+                    }
+                    continue;
+                }
+                case THIN:
+                    if (owner(w) == self) {
+                        if (count(w) < MAX_COUNT) {
+                            if (cas(word, w, w + COUNT_ONE)) return Status::Acquired;
+                        } else {
+                            inflate(word, w, self, count(w));
+                            w = load(word);
+                        }
+                        continue;
+                    }
+                    if (!wait) return Status::TimedOut;
+                    if (spins < spinLimit.load(std::memory_order_relaxed)) {
+                        spins++;
+                        spinPause();
+                        w = load(word);
+                        continue;
+                    }
+                    if (spins) adaptSpin(false);
+                    spins = 0;
+                    inflate(word, w, owner(w), count(w));
+                    w = load(word);
+                    continue;
+                case BIASED:
+                    if (owner(w) == self) {  // Contagem no limite: segue inflado
+                        inflate(word, w, self, count(w));
+                        w = load(word);
+                        continue;
+                    }
+                    if (!rt) std::this_thread::yield();  // Bias só existe com runtime
+                    else if (!revokeBias(word, rt)) return Status::Relocated;
+                    w = load(word);
+                    continue;
+                case INFLATED: {
+                    ObjectMonitor& m = *at(monitorIndex(w));
+                    std::unique_lock<std::mutex> lock(m.mutex);
+                    if (!wait && m.owner != 0 && m.owner != self) return Status::TimedOut;
+                    return enterInflated(m, self, lock, rt, deadline);
+                }
+            }
+        }
+    }
+
+    void adaptSpin(bool succeeded) {
+        const int limit = spinLimit.load(std::memory_order_relaxed);
+        if (limit == 0) return;
+        if (succeeded) stats.contendedSpins.fetch_add(1, std::memory_order_relaxed);
+        spinLimit.store(succeeded ? std::min(limit * 2, MAX_SPIN) : std::max(limit / 2, MIN_SPIN),
+                        std::memory_order_relaxed);
+    }
+};
+
+} // namespace Kava
+
+#endif // KAVA_MONITOR_H
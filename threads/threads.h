@@ -20,7 +20,11 @@
 #include <map>
 #include <future>
 #include <climits>
+#include <memory>
+#include <new>
+#include <type_traits>
 #include "../gc/gc.h"
+#include "monitor.h"
 
 namespace Kava {
 
@@ -31,6 +35,7 @@ class Lock;
 class Condition;
 class Semaphore;
 class CountDownLatch;
+class ForkJoinPool;
 
 // ============================================================
 // ESTADO DA THREAD
@@ -239,92 +244,98 @@ inline thread_local KavaThread* KavaThread::currentThread_ = nullptr;
 // ============================================================
 class ReentrantLock {
 private:
-    std::recursive_mutex mutex;
-    std::condition_variable_any condition;
-    std::atomic<KavaThread*> owner{nullptr};
-    std::atomic<int> holdCount{0};
+    // Thin lock na própria palavra; inflado (MonitorTable::shared) só sob
+    // disputa ou em await
+    uint32_t lockWord = 0;
     bool fair;  // Fairness policy (not fully implemented)
     
+    static MonitorTable& monitors() { return MonitorTable::shared(); }
+    
 public:
     explicit ReentrantLock(bool isFair = false) : fair(isFair) {}
+    ~ReentrantLock() { monitors().release(lockWord); }
+    ReentrantLock(const ReentrantLock&) = delete;
+    ReentrantLock& operator=(const ReentrantLock&) = delete;
     
     void lock() {
-        mutex.lock();
-        owner = KavaThread::currentThread();
-        holdCount++;
+        monitors().enter(lockWord);
     }
     
     bool tryLock() {
-        if (mutex.try_lock()) {
-            owner = KavaThread::currentThread();
-            holdCount++;
-            return true;
-        }
-        return false;
+        return monitors().tryEnter(lockWord) == MonitorTable::Status::Acquired;
     }
     
     bool tryLock(long timeoutMillis) {
         auto until = std::chrono::steady_clock::now() + 
                      std::chrono::milliseconds(timeoutMillis);
-        
-        while (std::chrono::steady_clock::now() < until) {
-            if (tryLock()) return true;
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        }
-        return false;
+        return monitors().tryEnterUntil(lockWord, until) == MonitorTable::Status::Acquired;
     }
     
     void unlock() {
-        if (--holdCount == 0) {
-            owner = nullptr;
+        if (!monitors().exit(lockWord)) {
+            throw std::runtime_error("IllegalMonitorStateException: unlock sem possuir o lock");
         }
-        mutex.unlock();
     }
     
     bool isLocked() const {
-        return holdCount > 0;
+        return monitors().isLocked(lockWord);
     }
     
     bool isHeldByCurrentThread() const {
-        return owner == KavaThread::currentThread();
+        return monitors().isHeldByCurrentThread(lockWord);
     }
     
+    // Entradas da thread atual (0 quando não é a dona), como no Java
     int getHoldCount() const {
-        return holdCount;
+        return static_cast<int>(monitors().holdCount(lockWord));
     }
     
     void await() {
-        condition.wait(mutex);
+        if (!monitors().wait(lockWord)) {
+            throw std::runtime_error("IllegalMonitorStateException: await sem possuir o lock");
+        }
     }
     
     bool await(long timeoutMillis) {
-        return condition.wait_for(mutex, std::chrono::milliseconds(timeoutMillis))
-               == std::cv_status::no_timeout;
+        auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMillis);
+        bool timedOut = false;
+        if (!monitors().wait(lockWord, &until, nullptr, &timedOut)) {
+            throw std::runtime_error("IllegalMonitorStateException: await sem possuir o lock");
+        }
+        return !timedOut;
     }
     
     void signal() {
-        condition.notify_one();
+        monitors().notify(lockWord, false);
     }
     
     void signalAll() {
-        condition.notify_all();
+        monitors().notify(lockWord, true);
     }
 };
 
 // ============================================================
 // SYNCHRONIZED BLOCK HELPER
 // ============================================================
+// RAII sobre uma palavra de lock (thin/inflado, ver monitor.h) ou um
+// ReentrantLock
 class SynchronizedBlock {
 private:
-    std::recursive_mutex& mutex;
+    uint32_t* word = nullptr;
+    ReentrantLock* lock = nullptr;
     
 public:
-    explicit SynchronizedBlock(std::recursive_mutex& m) : mutex(m) {
-        mutex.lock();
+    explicit SynchronizedBlock(uint32_t& lockWord) : word(&lockWord) {
+        MonitorTable::shared().enter(lockWord);
+    }
+    
+    explicit SynchronizedBlock(ReentrantLock& l) : lock(&l) {
+        lock->lock();
     }
     
     ~SynchronizedBlock() {
-        mutex.unlock();
+        if (lock) lock->unlock();
+        else MonitorTable::shared().exit(*word);
     }
     
     SynchronizedBlock(const SynchronizedBlock&) = delete;
@@ -332,7 +343,7 @@ public:
 };
 
 // Macro para synchronized
-#define SYNCHRONIZED(mutex) SynchronizedBlock _sync_##__LINE__(mutex)
+#define SYNCHRONIZED(monitor) SynchronizedBlock _sync_##__LINE__(monitor)
 
 // ============================================================
 // SEMAPHORE - Semáforo contável
@@ -602,6 +613,227 @@ public:
     bool isEmpty() const { return queue.empty(); }
 };
 
+// ============================================================
+// EVENT COUNT - Estacionamento sem wakeup perdido
+// ============================================================
+// Quem espera: key = prepareWait(); reconfere a condição; se ainda
+// falsa, wait(key) (senão cancelWait()). Quem publica: altera o estado
+// e chama notifyOne/notifyAll - sem esperadores, custa só uma fence.
+class EventCount {
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<uint64_t> epoch{0};
+    std::atomic<int> waiters{0};
+    
+public:
+    uint64_t prepareWait() {
+        uint64_t key = epoch.load(std::memory_order_acquire);
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        return key;
+    }
+    
+    void cancelWait() {
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+    
+    void wait(uint64_t key) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this, key] { return epoch.load(std::memory_order_acquire) != key; });
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+    
+    // false se o prazo venceu sem notificação
+    bool waitUntil(uint64_t key, std::chrono::steady_clock::time_point deadline) {
+        bool notified;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            notified = cv.wait_until(lock, deadline, [this, key] {
+                return epoch.load(std::memory_order_acquire) != key;
+            });
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return notified;
+    }
+    
+    void notifyOne() {
+        if (!bump()) return;
+        cv.notify_one();
+    }
+    
+    void notifyAll() {
+        if (!bump()) return;
+        cv.notify_all();
+    }
+    
+private:
+    bool bump() {
+        // Emparelha com o fetch_add de prepareWait
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) == 0) return false;
+        std::lock_guard<std::mutex> lock(mutex);
+        epoch.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+};
+
+// ============================================================
+// MPMC QUEUE - Fila limitada lock-free (anel de Vyukov)
+// ============================================================
+// Mesma interface de BlockingQueue. offer/poll nunca bloqueiam nem
+// tomam lock: cada slot carrega um número de sequência que diz se
+// está livre para a posição do produtor ou pronto para o consumidor.
+// put/take giram um pouco e só então estacionam num EventCount.
+template<typename T>
+class MPMCQueue {
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+    
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) std::atomic<size_t> dequeuePos{0};
+    alignas(64) EventCount notEmpty;
+    EventCount notFull;
+    
+    static constexpr int SPIN_LIMIT = 64;
+    
+public:
+    // Capacidade arredondada para potência de 2
+    explicit MPMCQueue(size_t cap = 1024) {
+        size_t capacity = 2;
+        while (capacity < cap) capacity <<= 1;
+        slots.reset(new Slot[capacity]);
+        mask = capacity - 1;
+        for (size_t i = 0; i < capacity; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+    
+    // Reserva um slot e deixa fill(T&) escrevê-lo; não notifica ninguém
+    template<typename Fill>
+    bool tryEnqueueWith(Fill&& fill) {
+        // sequence == pos -> slot livre para esta posição
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots[pos & mask];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // Cheia
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        fill(slot->value);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Reserva o slot mais antigo e entrega a drain(T&)
+    template<typename Drain>
+    bool tryDequeueWith(Drain&& drain) {
+        // sequence == pos + 1 -> slot publicado para esta posição
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots[pos & mask];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // Vazia
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        drain(slot->value);
+        slot->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+    
+    void put(const T& item) {
+        for (int spin = 0; spin < SPIN_LIMIT; spin++) {
+            if (offer(item)) return;
+            std::this_thread::yield();
+        }
+        for (;;) {
+            uint64_t key = notFull.prepareWait();
+            if (offer(item)) {
+                notFull.cancelWait();
+                return;
+            }
+            notFull.wait(key);
+        }
+    }
+    
+    T take() {
+        T item;
+        for (int spin = 0; spin < SPIN_LIMIT; spin++) {
+            if (poll(item)) return item;
+            std::this_thread::yield();
+        }
+        for (;;) {
+            uint64_t key = notEmpty.prepareWait();
+            if (poll(item)) {
+                notEmpty.cancelWait();
+                return item;
+            }
+            notEmpty.wait(key);
+        }
+    }
+    
+    bool offer(const T& item) {
+        if (!tryEnqueueWith([&item](T& slot) { slot = item; })) return false;
+        notEmpty.notifyOne();
+        return true;
+    }
+    
+    bool poll(T& item) {
+        if (!tryDequeueWith([&item](T& slot) { item = std::move(slot); })) return false;
+        notFull.notifyOne();
+        return true;
+    }
+    
+    bool poll(T& item, long timeoutMillis) {
+        if (poll(item)) return true;
+        auto until = std::chrono::steady_clock::now() +
+                     std::chrono::milliseconds(timeoutMillis);
+        for (;;) {
+            uint64_t key = notEmpty.prepareWait();
+            if (poll(item)) {
+                notEmpty.cancelWait();
+                return true;
+            }
+            if (!notEmpty.waitUntil(key, until)) {
+                return poll(item);
+            }
+        }
+    }
+    
+    // Aproximado sob concorrência (como ConcurrentLinkedQueue.size)
+    size_t size() const {
+        size_t head = dequeuePos.load(std::memory_order_acquire);
+        size_t tail = enqueuePos.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+    
+    bool isEmpty() const { return size() == 0; }
+    size_t getCapacity() const { return mask + 1; }
+};
+
 // ============================================================
 // THREAD POOL EXECUTOR
 // ============================================================
@@ -704,6 +936,465 @@ public:
     }
 };
 
+// ============================================================
+// WORK-STEALING DEQUE (Chase-Lev)
+// ============================================================
+// Dona empilha e desempilha no fundo (LIFO, sem CAS no caso comum); ladrões
+// tiram do topo (FIFO) com um CAS. Capacidade fixa: push devolve false quando
+// cheia e o chamador executa a tarefa na hora.
+template<typename T>
+class WorkStealingDeque {
+    static_assert(std::is_pointer<T>::value, "WorkStealingDeque guarda ponteiros");
+    
+private:
+    alignas(64) std::atomic<int64_t> top{0};
+    alignas(64) std::atomic<int64_t> bottom{0};
+    std::unique_ptr<std::atomic<T>[]> buffer;
+    int64_t mask;
+    
+public:
+    explicit WorkStealingDeque(size_t capacityPow2 = 8192)
+        : buffer(new std::atomic<T>[capacityPow2]), mask(static_cast<int64_t>(capacityPow2) - 1) {}
+    
+    // Só a thread dona
+    bool push(T item) {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        if (b - t > mask) return false;
+        buffer[b & mask].store(item, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Só a thread dona
+    bool pop(T& item) {
+        // store/load seq_cst: a ordem que evita dono e ladrão pegarem o mesmo item
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_seq_cst);
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        item = buffer[b & mask].load(std::memory_order_relaxed);
+        if (t == b) {
+            // Último elemento: disputa com os ladrões
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                   std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+    
+    // Qualquer thread
+    bool steal(T& item) {
+        int64_t t = top.load(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_seq_cst);
+        if (t >= b) return false;
+        item = buffer[t & mask].load(std::memory_order_relaxed);
+        return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                           std::memory_order_relaxed);
+    }
+    
+    bool isEmpty() const {
+        return bottom.load(std::memory_order_acquire) <= top.load(std::memory_order_acquire);
+    }
+};
+
+// ============================================================
+// INLINE TASK - Runnable sem alocação
+// ============================================================
+// Guarda o callable dentro do próprio objeto (até 48 bytes: um std::function
+// ou lambdas com poucas capturas). Maiores caem numa única alocação.
+class InlineTask {
+public:
+    static constexpr size_t CAPACITY = 48;
+    
+    InlineTask() = default;
+    InlineTask(const InlineTask&) = delete;
+    InlineTask& operator=(const InlineTask&) = delete;
+    ~InlineTask() { clear(); }
+    
+    template<typename F>
+    void emplace(F&& fn) {
+        using Fn = typename std::decay<F>::type;
+        clear();
+        if constexpr (sizeof(Fn) <= CAPACITY && alignof(Fn) <= alignof(std::max_align_t) &&
+                      std::is_nothrow_move_constructible<Fn>::value) {
+            new (storage) Fn(std::forward<F>(fn));
+            ops = &opsFor<Fn>;
+        } else {
+            emplace(HeapCallable<Fn>{new Fn(std::forward<F>(fn))});
+        }
+    }
+    
+    // Move o callable para `dst` (que precisa estar vazio)
+    void moveTo(InlineTask& dst) {
+        if (!ops) return;
+        ops->move(dst.storage, storage);
+        dst.ops = ops;
+        ops = nullptr;
+    }
+    
+    // Executa e libera
+    void run() {
+        if (!ops) return;
+        ops->invoke(storage);
+        clear();
+    }
+    
+    explicit operator bool() const { return ops != nullptr; }
+    
+private:
+    struct Ops {
+        void (*invoke)(void*);
+        void (*move)(void* dst, void* src);
+        void (*destroy)(void*);
+    };
+    
+    template<typename Fn>
+    struct HeapCallable {
+        Fn* fn;
+        HeapCallable(Fn* f) : fn(f) {}
+        HeapCallable(HeapCallable&& other) noexcept : fn(other.fn) { other.fn = nullptr; }
+        ~HeapCallable() { delete fn; }
+        void operator()() { (*fn)(); }
+    };
+    
+    template<typename Fn>
+    static constexpr Ops opsFor = {
+        [](void* p) { (*static_cast<Fn*>(p))(); },
+        [](void* dst, void* src) {
+            new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        },
+        [](void* p) { static_cast<Fn*>(p)->~Fn(); }
+    };
+    
+    void clear() {
+        if (ops) ops->destroy(storage);
+        ops = nullptr;
+    }
+    
+    alignas(std::max_align_t) unsigned char storage[CAPACITY];
+    const Ops* ops = nullptr;
+};
+
+// ============================================================
+// FORK/JOIN TASK
+// ============================================================
+// Tarefa intrusiva: o chamador é dono da memória (ex.: na pilha de uma
+// recursão dividir-para-conquistar), então fork/join não alocam.
+class ForkJoinTask {
+public:
+    virtual ~ForkJoinTask() = default;
+    
+    // Agenda na deque da worker atual; fora de uma worker vai para commonPool
+    void fork();
+    // Espera o fim; dentro de uma worker executa outras tarefas enquanto isso
+    void join();
+    // Executa na thread atual
+    void invoke() { exec(); }
+    
+    bool isDone() const { return status.load(std::memory_order_acquire) & DONE; }
+    void reinitialize() { status.store(0, std::memory_order_relaxed); }
+    
+protected:
+    virtual void compute() = 0;
+    
+private:
+    friend class ForkJoinPool;
+    static constexpr int DONE = 1;
+    static constexpr int SIGNAL = 2;  // Há uma thread externa dormindo no join
+    std::atomic<int> status{0};
+    
+    void exec();
+    void awaitExternal();
+    static std::mutex& joinMutex() { static std::mutex m; return m; }
+    static std::condition_variable& joinCv() { static std::condition_variable cv; return cv; }
+};
+
+template<typename F>
+class FunctionTask : public ForkJoinTask {
+public:
+    explicit FunctionTask(F f) : fn(std::move(f)) {}
+protected:
+    void compute() override { fn(); }
+private:
+    F fn;
+};
+
+template<typename F>
+FunctionTask<typename std::decay<F>::type> makeForkJoinTask(F&& fn) {
+    return FunctionTask<typename std::decay<F>::type>(std::forward<F>(fn));
+}
+
+// ============================================================
+// FORK JOIN POOL - Executor com work-stealing
+// ============================================================
+// Uma deque Chase-Lev por worker para as tarefas criadas dentro do pool
+// (fork) e uma fila MPMC limitada (Vyukov) para submissões externas, com o
+// callable guardado no próprio slot. Worker sem trabalho tenta roubar de
+// vítimas aleatórias, gira um pouco e então estaciona numa condvar (nada de
+// poll com timeout); cada submissão acorda uma estacionada.
+class ForkJoinPool {
+public:
+    explicit ForkJoinPool(int parallelism = defaultParallelism(), size_t queueCapacity = 4096);
+    ~ForkJoinPool();
+    ForkJoinPool(const ForkJoinPool&) = delete;
+    ForkJoinPool& operator=(const ForkJoinPool&) = delete;
+    
+    // Fire-and-forget sem alocação; com a fila cheia roda na thread chamadora
+    template<typename F>
+    void execute(F&& fn);
+    
+    // Submete a tarefa e espera o fim
+    void invoke(ForkJoinTask& task);
+    
+    // Termina as tarefas pendentes e encerra as workers
+    void shutdown();
+    
+    bool isShutdown() const { return shutdownFlag.load(); }
+    int getParallelism() const { return static_cast<int>(workers.size()); }
+    int getPoolSize() const { return getParallelism(); }
+    uint64_t getStealCount() const { return steals.load(std::memory_order_relaxed); }
+    
+    static int defaultParallelism() {
+        return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    
+    // Pool compartilhado (ForkJoinTask::fork fora de uma worker)
+    static ForkJoinPool& commonPool() {
+        static ForkJoinPool pool;
+        return pool;
+    }
+    
+private:
+    friend class ForkJoinTask;
+    
+    struct alignas(64) Worker {
+        WorkStealingDeque<ForkJoinTask*> deque;
+        std::thread thread;
+        uint64_t seed;
+        int index;
+    };
+    
+    std::vector<std::unique_ptr<Worker>> workers;
+    MPMCQueue<InlineTask> external;
+    EventCount idle;
+    std::atomic<bool> shutdownFlag{false};
+    std::atomic<uint64_t> steals{0};
+    
+    static Worker*& currentWorker() {
+        static thread_local Worker* w = nullptr;
+        return w;
+    }
+    static ForkJoinPool*& currentPool() {
+        static thread_local ForkJoinPool* p = nullptr;
+        return p;
+    }
+    
+    template<typename F>
+    bool offer(F&& fn);
+    bool pollExternal();
+    bool trySteal(Worker& self, ForkJoinTask*& task);
+    bool runOne(Worker& self);
+    bool hasQueuedWork() const;
+    void signalWork();
+    void workerLoop(Worker& self);
+    void pushLocal(ForkJoinTask* task);
+};
+
+inline ForkJoinPool::ForkJoinPool(int parallelism, size_t queueCapacity)
+    : external(queueCapacity) {
+    parallelism = std::max(1, parallelism);
+    for (int i = 0; i < parallelism; i++) {
+        auto w = std::make_unique<Worker>();
+        w->index = i;
+        w->seed = 0x9E3779B97F4A7C15ull * (i + 1);
+        workers.push_back(std::move(w));
+    }
+    // Threads só depois de todas as deques existirem (ladrões varrem o vetor)
+    for (auto& w : workers) {
+        Worker* self = w.get();
+        self->thread = std::thread([this, self] { workerLoop(*self); });
+    }
+}
+
+inline ForkJoinPool::~ForkJoinPool() {
+    shutdown();
+}
+
+inline void ForkJoinPool::shutdown() {
+    if (shutdownFlag.exchange(true)) return;
+    idle.notifyAll();
+    for (auto& w : workers) {
+        if (w->thread.joinable()) w->thread.join();
+    }
+}
+
+template<typename F>
+inline bool ForkJoinPool::offer(F&& fn) {
+    return external.tryEnqueueWith([&fn](InlineTask& slot) {
+        slot.emplace(std::forward<F>(fn));
+    });
+}
+
+template<typename F>
+inline void ForkJoinPool::execute(F&& fn) {
+    if (shutdownFlag.load(std::memory_order_relaxed)) {
+        throw std::runtime_error("ForkJoinPool is shutdown");
+    }
+    if (!offer(std::forward<F>(fn))) {
+        fn();  // Fila cheia: o chamador executa (back-pressure)
+        return;
+    }
+    signalWork();
+}
+
+inline bool ForkJoinPool::pollExternal() {
+    InlineTask task;
+    if (!external.tryDequeueWith([&task](InlineTask& slot) { slot.moveTo(task); })) {
+        return false;
+    }
+    try {
+        task.run();
+    } catch (...) {
+        // Como ThreadPoolExecutor: exceção da tarefa não derruba a worker
+    }
+    return true;
+}
+
+inline bool ForkJoinPool::hasQueuedWork() const {
+    if (!external.isEmpty()) return true;
+    for (auto& w : workers) {
+        if (!w->deque.isEmpty()) return true;
+    }
+    return false;
+}
+
+inline void ForkJoinPool::signalWork() {
+    idle.notifyOne();
+}
+
+inline bool ForkJoinPool::trySteal(Worker& self, ForkJoinTask*& task) {
+    const size_t n = workers.size();
+    if (n < 2) return false;
+    // xorshift64: vítima inicial aleatória, depois varre as demais
+    self.seed ^= self.seed << 13;
+    self.seed ^= self.seed >> 7;
+    self.seed ^= self.seed << 17;
+    size_t start = static_cast<size_t>(self.seed % n);
+    for (size_t k = 0; k < n; k++) {
+        Worker& victim = *workers[(start + k) % n];
+        if (&victim == &self) continue;
+        if (victim.deque.steal(task)) {
+            steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool ForkJoinPool::runOne(Worker& self) {
+    ForkJoinTask* task;
+    if (self.deque.pop(task) || trySteal(self, task)) {
+        task->exec();
+        return true;
+    }
+    return pollExternal();
+}
+
+inline void ForkJoinPool::workerLoop(Worker& self) {
+    currentWorker() = &self;
+    currentPool() = this;
+    int spins = 0;
+    for (;;) {
+        if (runOne(self)) {
+            spins = 0;
+            continue;
+        }
+        if (++spins < 64) {
+            std::this_thread::yield();
+            continue;
+        }
+        spins = 0;
+        
+        // Estaciona: registra-se antes de reconferir as filas (sem wakeup perdido)
+        uint64_t key = idle.prepareWait();
+        if (hasQueuedWork()) {
+            idle.cancelWait();
+            continue;
+        }
+        if (shutdownFlag.load()) {
+            idle.cancelWait();
+            return;
+        }
+        idle.wait(key);
+    }
+}
+
+inline void ForkJoinPool::pushLocal(ForkJoinTask* task) {
+    if (!currentWorker()->deque.push(task)) {
+        task->exec();  // Deque cheia: executa já
+        return;
+    }
+    signalWork();
+}
+
+inline void ForkJoinPool::invoke(ForkJoinTask& task) {
+    if (currentPool() == this) {
+        task.exec();
+        return;
+    }
+    ForkJoinTask* ptr = &task;
+    execute([ptr] { ptr->exec(); });
+    task.awaitExternal();
+}
+
+inline void ForkJoinTask::exec() {
+    try {
+        compute();
+    } catch (...) {
+        // Tarefa termina mesmo com exceção: join não pode travar
+    }
+    int previous = status.exchange(DONE, std::memory_order_acq_rel);
+    if (previous & SIGNAL) {
+        std::lock_guard<std::mutex> lock(joinMutex());
+        joinCv().notify_all();
+    }
+}
+
+inline void ForkJoinTask::awaitExternal() {
+    if (status.fetch_or(SIGNAL, std::memory_order_acq_rel) & DONE) return;
+    std::unique_lock<std::mutex> lock(joinMutex());
+    joinCv().wait(lock, [this] { return isDone(); });
+}
+
+inline void ForkJoinTask::fork() {
+    if (ForkJoinPool::currentWorker()) {
+        ForkJoinPool::currentPool()->pushLocal(this);
+    } else {
+        ForkJoinTask* self = this;
+        ForkJoinPool::commonPool().execute([self] { self->exec(); });
+    }
+}
+
+inline void ForkJoinTask::join() {
+    ForkJoinPool::Worker* worker = ForkJoinPool::currentWorker();
+    if (!worker) {
+        awaitExternal();
+        return;
+    }
+    // Ajuda enquanto espera: normalmente a própria tarefa ainda está no fundo
+    // da deque e roda aqui mesmo
+    ForkJoinPool* pool = ForkJoinPool::currentPool();
+    while (!isDone()) {
+        if (!pool->runOne(*worker)) std::this_thread::yield();
+    }
+}
+
 // ============================================================
 // EXECUTORS FACTORY (como Java)
 // ============================================================
@@ -720,6 +1411,10 @@ public:
     static ThreadPoolExecutor* newSingleThreadExecutor() {
         return new ThreadPoolExecutor(1);
     }
+    
+    static ForkJoinPool* newWorkStealingPool(int parallelism = ForkJoinPool::defaultParallelism()) {
+        return new ForkJoinPool(parallelism);
+    }
 };
 
 // ============================================================
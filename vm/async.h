@@ -3,22 +3,26 @@
  * Copyright (c) 2026 KAVA Team
  * 
  * KAVA 2.5 - Async Runtime & Event Loop
- * Event loop proprio para async/await, timers, IO assincrono
+ * Event loop proprio para async/await, timers, IO assincrono.
+ * Tudo roda na thread do loop, exceto queueIO/completeIO: as threads de IO
+ * devolvem o resultado por uma fila MPSC sem lock.
  */
 
 #ifndef KAVA_ASYNC_H
 #define KAVA_ASYNC_H
 
 #include <vector>
-#include <queue>
 #include <functional>
 #include <chrono>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
 #include <thread>
-#include <map>
+#include <deque>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include "../threads/threads.h"
 
 namespace Kava {
 
@@ -34,84 +38,322 @@ enum class PromiseState {
 // ============================================================
 // PROMISE - Future value container
 // ============================================================
+// Mora no slab do EventLoop. value guarda os bits crus do Value da VM e
+// waiters os ids das corrotinas suspensas esperando por ela: o resolve so
+// as enfileira, quem as retoma e o tick (sem std::function por promise).
 class Promise {
 public:
-    using Callback = std::function<void(int64_t)>;
-    using ErrorCallback = std::function<void(const std::string&)>;
-    
     PromiseState state = PromiseState::PENDING;
-    int64_t value = 0;
+    uint64_t value = 0;
     std::string error;
+    std::vector<int32_t> waiters;
     
-    std::vector<Callback> thenCallbacks;
-    std::vector<ErrorCallback> catchCallbacks;
+    int promiseId = 0;
+    uint32_t generation = 0;  // muda a cada reuso do slot
+    bool live = false;
     
-    int promiseId;
+    bool isSettled() const {
+        return state != PromiseState::PENDING;
+    }
+};
+
+// ============================================================
+// MPSC QUEUE - de varias threads para a thread do loop
+// ============================================================
+// Fila intrusiva de Vyukov: push e uma troca atomica do head (sem lock,
+// sem espera entre produtores); so a thread do loop consome. Um pop que
+// pega um produtor no meio do push devolve false e o item sai no proximo.
+template <typename T>
+class MpscQueue {
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value;
+    };
+    
+    std::atomic<Node*> head;  // ultimo empilhado (produtores)
+    Node* tail;               // proximo a sair (consumidor)
+    Node stub;
+
+public:
+    MpscQueue() : head(&stub), tail(&stub) {}
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+    
+    ~MpscQueue() {
+        T discard;
+        while (pop(discard)) {}
+        if (tail != &stub) delete tail;
+    }
+    
+    void push(T value) {
+        Node* node = new Node;
+        node->value = std::move(value);
+        enqueue(node);
+    }
     
-    void resolve(int64_t val) {
-        if (state != PromiseState::PENDING) return;
-        state = PromiseState::FULFILLED;
-        value = val;
-        for (auto& cb : thenCallbacks) {
-            cb(val);
+    bool pop(T& out) {
+        Node* t = tail;
+        Node* next = t->next.load(std::memory_order_acquire);
+        if (t == &stub) {
+            if (!next) return false;
+            tail = t = next;
+            next = next->next.load(std::memory_order_acquire);
         }
+        if (!next) {
+            if (t != head.load(std::memory_order_acquire)) return false;
+            // t e o ultimo: o stub entra atras dele para t poder sair
+            enqueue(&stub);
+            next = t->next.load(std::memory_order_acquire);
+            if (!next) return false;
+        }
+        out = std::move(t->value);
+        tail = next;
+        delete t;
+        return true;
     }
     
-    void reject(const std::string& err) {
-        if (state != PromiseState::PENDING) return;
-        state = PromiseState::REJECTED;
-        error = err;
-        for (auto& cb : catchCallbacks) {
-            cb(err);
+    // So na thread consumidora
+    bool empty() const {
+        return tail == &stub && stub.next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    void enqueue(Node* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+};
+
+// ============================================================
+// TIMER WHEEL - roda hierarquica de timers
+// ============================================================
+// 4 niveis de 256 slots com resolucao de 1ms (ate ~49 dias). Um timer
+// entra no nivel mais baixo cujo bloco contem o vencimento: add e cancel
+// sao O(1) (lista duplamente ligada por indices num slab). Ao virar um
+// bloco, o slot correspondente do nivel acima desce (cascata). advance
+// pula direto entre slots ocupados pelos bitmaps, sem visitar tick a tick.
+class TimerWheel {
+public:
+    using Callback = std::function<void()>;
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 8;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+    static constexpr uint64_t MAX_DELAY = (1ULL << (LEVELS * SLOT_BITS)) - 1;
+    static constexpr uint64_t NEVER = std::numeric_limits<uint64_t>::max();
+
+    TimerWheel() {
+        for (auto& h : heads) h = -1;
+        for (auto& level : occupied) {
+            for (auto& word : level) word = 0;
         }
     }
     
-    Promise& then(Callback cb) {
-        if (state == PromiseState::FULFILLED) {
-            cb(value);
+    // Vence em expiry (tick absoluto; no minimo o proximo tick). interval > 0
+    // reagenda a cada disparo. Ids checados por geracao, como as promises.
+    int add(uint64_t expiry, int64_t interval, Callback callback) {
+        int32_t index;
+        if (!freeNodes.empty()) {
+            index = freeNodes.back();
+            freeNodes.pop_back();
         } else {
-            thenCallbacks.push_back(cb);
+            index = static_cast<int32_t>(nodes.size());
+            if (static_cast<uint32_t>(index) > INDEX_MASK) return 0;
+            nodes.emplace_back();
         }
-        return *this;
+        Node& n = nodes[index];
+        n.generation = n.generation >= MAX_GENERATION ? 1 : n.generation + 1;
+        n.callback = std::move(callback);
+        n.interval = interval;
+        n.expiry = clampExpiry(expiry);
+        n.live = true;
+        liveCount++;
+        link(index);
+        return idOf(index);
     }
     
-    Promise& onCatch(ErrorCallback cb) {
-        if (state == PromiseState::REJECTED) {
-            cb(error);
-        } else {
-            catchCallbacks.push_back(cb);
+    bool cancel(int id) {
+        const int32_t index = find(id);
+        if (index < 0) return false;
+        unlink(index);
+        release(index);
+        return true;
+    }
+    
+    // Dispara, em ordem de vencimento, tudo que vence ate target
+    void advance(uint64_t target) {
+        while (now < target) {
+            if (liveCount == 0) {
+                now = target;
+                break;
+            }
+            const int s = nextOccupied(0, static_cast<int>(now & SLOT_MASK) + 1);
+            const uint64_t next = s >= 0 ? (now & ~SLOT_MASK) + static_cast<uint64_t>(s) : (now | SLOT_MASK) + 1;
+            if (next > target) {
+                now = target;
+                break;
+            }
+            now = next;
+            if ((now & SLOT_MASK) == 0) cascade();
+            fire(static_cast<int>(now & SLOT_MASK));
         }
-        return *this;
     }
     
-    bool isSettled() const {
-        return state != PromiseState::PENDING;
+    // Primeiro tick em que algo pode vencer (ou uma cascata precisa rodar)
+    uint64_t nextExpiry() const {
+        if (liveCount == 0) return NEVER;
+        for (int level = 0; level < LEVELS; level++) {
+            const int shift = level * SLOT_BITS;
+            const int s = nextOccupied(level, static_cast<int>((now >> shift) & SLOT_MASK) + 1);
+            if (s >= 0) {
+                const uint64_t block = (now >> (shift + SLOT_BITS)) << (shift + SLOT_BITS);
+                return block | (static_cast<uint64_t>(s) << shift);
+            }
+        }
+        // So sobraram timers do proximo bloco do nivel mais alto
+        return ((now >> (LEVELS * SLOT_BITS)) + 1) << (LEVELS * SLOT_BITS);
     }
-};
+    
+    uint64_t current() const { return now; }
+    size_t size() const { return liveCount; }
 
-// ============================================================
-// TIMER - Scheduled callback
-// ============================================================
-struct Timer {
-    int id;
-    std::chrono::steady_clock::time_point fireAt;
-    std::function<void()> callback;
-    int64_t intervalMs;  // 0 = setTimeout, >0 = setInterval
-    bool cancelled = false;
+private:
+    static constexpr int INDEX_BITS = 22;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static constexpr uint32_t MAX_GENERATION = (1u << (31 - INDEX_BITS)) - 1;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+    
+    struct Node {
+        Callback callback;
+        uint64_t expiry = 0;
+        int64_t interval = 0;
+        int32_t prev = -1;
+        int32_t next = -1;
+        int32_t slot = -1;  // nivel * SLOTS + slot (-1: fora da roda)
+        uint32_t generation = 0;
+        bool live = false;
+    };
+    
+    std::vector<Node> nodes;
+    std::vector<int32_t> freeNodes;
+    int32_t heads[LEVELS * SLOTS];
+    uint64_t occupied[LEVELS][SLOTS / 64];
+    std::vector<int> firing;
+    uint64_t now = 0;
+    size_t liveCount = 0;
+    
+    int idOf(int32_t index) const {
+        return static_cast<int>((nodes[index].generation << INDEX_BITS) | static_cast<uint32_t>(index));
+    }
     
-    bool operator>(const Timer& other) const {
-        return fireAt > other.fireAt;
+    int32_t find(int id) const {
+        const int32_t index = static_cast<int32_t>(static_cast<uint32_t>(id) & INDEX_MASK);
+        if (id <= 0 || index >= static_cast<int32_t>(nodes.size())) return -1;
+        const Node& n = nodes[index];
+        return n.live && idOf(index) == id ? index : -1;
+    }
+    
+    uint64_t clampExpiry(uint64_t expiry) const {
+        if (expiry <= now) return now + 1;
+        return expiry - now > MAX_DELAY ? now + MAX_DELAY : expiry;
+    }
+    
+    void link(int32_t index) {
+        Node& n = nodes[index];
+        int level = 0;
+        while (level < LEVELS - 1 &&
+               (n.expiry >> (SLOT_BITS * (level + 1))) != (now >> (SLOT_BITS * (level + 1)))) {
+            level++;
+        }
+        const int s = static_cast<int>((n.expiry >> (SLOT_BITS * level)) & SLOT_MASK);
+        const int slot = level * SLOTS + s;
+        n.slot = slot;
+        n.prev = -1;
+        n.next = heads[slot];
+        if (n.next >= 0) nodes[n.next].prev = index;
+        heads[slot] = index;
+        occupied[level][s >> 6] |= 1ULL << (s & 63);
+    }
+    
+    void unlink(int32_t index) {
+        Node& n = nodes[index];
+        if (n.slot < 0) return;
+        if (n.prev >= 0) nodes[n.prev].next = n.next;
+        else heads[n.slot] = n.next;
+        if (n.next >= 0) nodes[n.next].prev = n.prev;
+        if (heads[n.slot] < 0) {
+            const int s = n.slot % SLOTS;
+            occupied[n.slot / SLOTS][s >> 6] &= ~(1ULL << (s & 63));
+        }
+        n.slot = n.prev = n.next = -1;
+    }
+    
+    void release(int32_t index) {
+        Node& n = nodes[index];
+        n.callback = nullptr;
+        n.live = false;
+        liveCount--;
+        freeNodes.push_back(index);
+    }
+    
+    // Esvazia um slot devolvendo a lista (os nos ficam fora da roda)
+    int32_t take(int level, int s) {
+        const int slot = level * SLOTS + s;
+        const int32_t first = heads[slot];
+        heads[slot] = -1;
+        occupied[level][s >> 6] &= ~(1ULL << (s & 63));
+        return first;
+    }
+    
+    // Primeiro slot ocupado do nivel a partir de from (-1: nenhum ate o fim)
+    int nextOccupied(int level, int from) const {
+        for (int word = from >> 6; word < SLOTS / 64; word++) {
+            uint64_t bits = occupied[level][word];
+            if (word == from >> 6) bits &= ~0ULL << (from & 63);
+            if (bits) return (word << 6) + __builtin_ctzll(bits);
+        }
+        return -1;
+    }
+    
+    // now acabou de virar um bloco do nivel 0: desce os niveis que viraram
+    // junto, do mais alto para o mais baixo
+    void cascade() {
+        int top = 1;
+        while (top < LEVELS - 1 && (now & ((1ULL << (SLOT_BITS * (top + 1))) - 1)) == 0) top++;
+        for (int level = top; level >= 1; level--) {
+            int32_t index = take(level, static_cast<int>((now >> (SLOT_BITS * level)) & SLOT_MASK));
+            while (index >= 0) {
+                const int32_t next = nodes[index].next;
+                link(index);
+                index = next;
+            }
+        }
+    }
+    
+    // Os callbacks podem criar e cancelar timers (inclusive os deste slot):
+    // a lista vira ids antes de disparar e cada um e conferido de novo
+    void fire(int s) {
+        firing.clear();
+        for (int32_t index = take(0, s); index >= 0; index = nodes[index].next) {
+            nodes[index].slot = -1;
+            firing.push_back(idOf(index));
+        }
+        for (size_t i = 0; i < firing.size(); i++) {
+            const int id = firing[i];
+            const int32_t index = find(id);
+            if (index < 0) continue;
+            Callback callback = std::move(nodes[index].callback);
+            const int64_t interval = nodes[index].interval;
+            if (interval <= 0) release(index);
+            callback();
+            if (interval > 0 && find(id) == index) {
+                Node& n = nodes[index];
+                n.callback = std::move(callback);
+                n.expiry = clampExpiry(now + static_cast<uint64_t>(interval));
+                link(index);
+            }
+        }
     }
-};
-
-// ============================================================
-// TASK - Micro/Macro task
-// ============================================================
-struct Task {
-    enum class Type { MICRO, MACRO, IO, TIMER };
-    Type type;
-    std::function<void()> callback;
-    int priority = 0;  // Higher = more important
 };
 
 // ============================================================
@@ -119,150 +361,192 @@ struct Task {
 // ============================================================
 class EventLoop {
 private:
-    // Task queues
-    std::queue<Task> microtasks;
-    std::queue<Task> macrotasks;
-    
-    // Timer heap (min-heap by fire time)
-    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers;
-    
-    // IO completion queue
-    std::queue<std::function<void()>> ioCompletions;
-    
-    // Promises
-    std::map<int, std::shared_ptr<Promise>> promises;
-    int nextPromiseId = 1;
-    int nextTimerId = 1;
-    
-    // Control
+    // Tarefas da propria thread do loop
+    std::deque<std::function<void()>> microtasks;
+    std::deque<std::function<void()>> macrotasks;
+    
+    // Timers (ticks de 1ms desde a criacao do loop)
+    TimerWheel timers;
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    
+    // Conclusoes de IO: as threads do pool empilham, o tick drena em lotes
+    static constexpr int IO_BATCH = 1024;
+    MpscQueue<std::function<void()>> ioCompletions;
+    
+    // Promises: slab com ids checados por geracao, id = (geracao << 20) |
+    // indice. Um handle antigo de um slot reciclado nao casa com a geracao
+    // nova e getPromise devolve null em vez da promise de outro.
+    static constexpr int PROMISE_INDEX_BITS = 20;
+    static constexpr uint32_t PROMISE_INDEX_MASK = (1u << PROMISE_INDEX_BITS) - 1;
+    static constexpr uint32_t PROMISE_MAX_GENERATION = (1u << (31 - PROMISE_INDEX_BITS)) - 1;
+    std::deque<Promise> promiseSlab;
+    std::vector<uint32_t> freePromises;
+    int pendingPromises = 0;
+    
+    // Corrotinas prontas (id, promise que as acordou), retomadas no tick
+    std::vector<std::pair<int32_t, int>> readyWaiters;
+    std::function<void(int32_t, int)> resumeHook;
+    std::function<void(const std::function<void()>&)> blockingHook;
+    
+    // Control: o loop so dorme com sleeping ligado; quem produz de outra
+    // thread so toma o mutex para acorda-lo nesse caso
     std::atomic<bool> running{false};
-    std::atomic<bool> hasWork{false};
+    std::atomic<bool> sleeping{false};
+    std::atomic<int> ioInFlight{0};
     std::mutex mutex;
     std::condition_variable cv;
     
-    // IO thread pool
-    std::vector<std::thread> ioThreads;
-    std::queue<std::function<void()>> ioTasks;
-    std::mutex ioMutex;
-    std::condition_variable ioCv;
-    std::atomic<bool> ioShutdown{false};
-    static constexpr int IO_THREAD_COUNT = 4;
-    
-    void ioWorker() {
-        while (!ioShutdown) {
-            std::function<void()> task;
-            {
-                std::unique_lock<std::mutex> lock(ioMutex);
-                ioCv.wait(lock, [this] { return ioShutdown || !ioTasks.empty(); });
-                if (ioShutdown && ioTasks.empty()) return;
-                task = std::move(ioTasks.front());
-                ioTasks.pop();
-            }
-            if (task) task();
-        }
-    }
+    // IO thread pool (work-stealing; workers estacionam quando ociosas).
+    // Criado no primeiro queueIO: programas sem IO nao sobem threads na partida.
+    int ioThreads = 4;
+    std::unique_ptr<ForkJoinPool> ioPool;
+    std::once_flag ioPoolOnce;
 
 public:
-    EventLoop() {
-        // Start IO thread pool
-        for (int i = 0; i < IO_THREAD_COUNT; i++) {
-            ioThreads.emplace_back(&EventLoop::ioWorker, this);
-        }
-    }
+    EventLoop() = default;
     
     ~EventLoop() {
         stop();
-        ioShutdown = true;
-        ioCv.notify_all();
-        for (auto& t : ioThreads) {
-            if (t.joinable()) t.join();
-        }
+        if (ioPool) ioPool->shutdown();  // Termina o IO pendente antes de sair
     }
     
     // ========================================
     // PROMISE API
     // ========================================
-    std::shared_ptr<Promise> createPromise() {
-        auto p = std::make_shared<Promise>();
-        p->promiseId = nextPromiseId++;
-        promises[p->promiseId] = p;
-        return p;
+    // Ids sempre positivos e nunca 0 (geracao 1..PROMISE_MAX_GENERATION)
+    int createPromise() {
+        uint32_t index;
+        if (!freePromises.empty()) {
+            index = freePromises.back();
+            freePromises.pop_back();
+        } else {
+            index = static_cast<uint32_t>(promiseSlab.size());
+            if (index > PROMISE_INDEX_MASK) return 0;
+            promiseSlab.emplace_back();
+        }
+        Promise& p = promiseSlab[index];
+        p.generation = p.generation >= PROMISE_MAX_GENERATION ? 1 : p.generation + 1;
+        p.promiseId = static_cast<int>((p.generation << PROMISE_INDEX_BITS) | index);
+        p.state = PromiseState::PENDING;
+        p.value = 0;
+        p.error.clear();
+        p.waiters.clear();
+        p.live = true;
+        pendingPromises++;
+        return p.promiseId;
+    }
+    
+    Promise* getPromise(int id) {
+        const uint32_t index = static_cast<uint32_t>(id) & PROMISE_INDEX_MASK;
+        if (id <= 0 || index >= promiseSlab.size()) return nullptr;
+        Promise& p = promiseSlab[index];
+        return p.live && p.promiseId == id ? &p : nullptr;
     }
     
-    std::shared_ptr<Promise> getPromise(int id) {
-        auto it = promises.find(id);
-        return it != promises.end() ? it->second : nullptr;
+    // Devolve o slot ao slab; handles antigos passam a ser rejeitados
+    void releasePromise(int id) {
+        Promise* p = getPromise(id);
+        if (!p) return;
+        if (!p->isSettled()) pendingPromises--;
+        p->live = false;
+        p->waiters.clear();
+        freePromises.push_back(static_cast<uint32_t>(id) & PROMISE_INDEX_MASK);
     }
     
-    void resolvePromise(int id, int64_t value) {
-        auto p = getPromise(id);
-        if (p) p->resolve(value);
+    void resolvePromise(int id, uint64_t value) {
+        settle(id, PromiseState::FULFILLED, value, std::string());
     }
     
     void rejectPromise(int id, const std::string& error) {
-        auto p = getPromise(id);
-        if (p) p->reject(error);
+        settle(id, PromiseState::REJECTED, 0, error);
+    }
+    
+    // waiter e retomado pelo resumeHook quando a promise assentar (no
+    // proximo tick, se ja estiver assentada)
+    void awaitPromise(int id, int32_t waiter) {
+        Promise* p = getPromise(id);
+        if (!p) return;
+        if (p->isSettled()) readyWaiters.emplace_back(waiter, id);
+        else p->waiters.push_back(waiter);
+    }
+    
+    void setResumeHook(std::function<void(int32_t, int)> hook) {
+        resumeHook = std::move(hook);
+    }
+    
+    // Envolve a espera do loop (a VM a marca como bloqueio para o GC)
+    void setBlockingHook(std::function<void(const std::function<void()>&)> hook) {
+        blockingHook = std::move(hook);
+    }
+    
+    // Roda o loop ate a promise assentar (ou o loop ficar sem trabalho),
+    // dormindo entre os eventos em vez de girar
+    bool runUntilSettled(int id) {
+        Promise* p = getPromise(id);
+        while (p && !p->isSettled() && hasPendingWork()) {
+            tick();
+            p = getPromise(id);
+            if (p && !p->isSettled()) waitForWork();
+        }
+        return p && p->isSettled();
+    }
+    
+    // Visita os valores das promises vivas (raizes do GC); uma pendente
+    // pode guardar o valor com que vai assentar
+    template <typename F>
+    void forEachPromiseValue(F&& visit) {
+        for (Promise& p : promiseSlab) {
+            if (p.live) visit(p.value);
+        }
     }
     
     // ========================================
-    // TIMER API
+    // TIMER API (thread do loop)
     // ========================================
     int setTimeout(std::function<void()> callback, int64_t delayMs) {
-        Timer t;
-        t.id = nextTimerId++;
-        t.fireAt = std::chrono::steady_clock::now() + std::chrono::milliseconds(delayMs);
-        t.callback = std::move(callback);
-        t.intervalMs = 0;
-        
-        std::lock_guard<std::mutex> lock(mutex);
-        timers.push(t);
-        hasWork = true;
-        cv.notify_one();
-        return t.id;
+        return timers.add(timerExpiry(delayMs), 0, std::move(callback));
     }
     
     int setInterval(std::function<void()> callback, int64_t intervalMs) {
-        Timer t;
-        t.id = nextTimerId++;
-        t.fireAt = std::chrono::steady_clock::now() + std::chrono::milliseconds(intervalMs);
-        t.callback = std::move(callback);
-        t.intervalMs = intervalMs;
-        
-        std::lock_guard<std::mutex> lock(mutex);
-        timers.push(t);
-        hasWork = true;
-        cv.notify_one();
-        return t.id;
+        intervalMs = std::max<int64_t>(1, intervalMs);
+        return timers.add(timerExpiry(intervalMs), intervalMs, std::move(callback));
     }
     
+    bool clearTimeout(int id) { return timers.cancel(id); }
+    bool clearInterval(int id) { return timers.cancel(id); }
+    
     // ========================================
     // TASK SCHEDULING
     // ========================================
+    // Micro/macrotasks sao da thread do loop; outras threads entregam
+    // trabalho por completeIO
     void queueMicrotask(std::function<void()> task) {
-        std::lock_guard<std::mutex> lock(mutex);
-        microtasks.push({Task::Type::MICRO, std::move(task)});
-        hasWork = true;
-        cv.notify_one();
+        microtasks.push_back(std::move(task));
     }
     
     void queueMacrotask(std::function<void()> task) {
-        std::lock_guard<std::mutex> lock(mutex);
-        macrotasks.push({Task::Type::MACRO, std::move(task)});
-        hasWork = true;
-        cv.notify_one();
+        macrotasks.push_back(std::move(task));
+    }
+    
+    // Antes do primeiro queueIO (o pool e criado nele)
+    void setIOThreads(int n) {
+        if (!ioPool && n > 0) ioThreads = n;
     }
     
     void queueIO(std::function<void()> task) {
-        std::lock_guard<std::mutex> lock(ioMutex);
-        ioTasks.push(std::move(task));
-        ioCv.notify_one();
+        std::call_once(ioPoolOnce, [this] { ioPool = std::make_unique<ForkJoinPool>(ioThreads); });
+        ioInFlight++;
+        ioPool->execute([this, task = std::move(task)] {
+            task();
+            ioInFlight--;
+            wake();
+        });
     }
     
+    // Qualquer thread: callback roda no proximo tick da thread do loop
     void completeIO(std::function<void()> callback) {
-        std::lock_guard<std::mutex> lock(mutex);
         ioCompletions.push(std::move(callback));
-        hasWork = true;
-        cv.notify_one();
+        wake();
     }
     
     // ========================================
@@ -272,13 +556,16 @@ public:
         // 1. Process all microtasks
         processMicrotasks();
         
-        // 2. Process IO completions
+        // 2. Process IO completions (um lote)
         processIOCompletions();
         
         // 3. Fire ready timers
         processTimers();
         
-        // 4. Process one macrotask
+        // 4. Resume coroutines whose promises settled
+        processReadyWaiters();
+        
+        // 5. Process one macrotask
         processMacrotask();
     }
     
@@ -286,12 +573,7 @@ public:
         running = true;
         while (running && hasPendingWork()) {
             tick();
-            
-            // Sleep briefly if no work
-            if (!hasPendingWork()) {
-                std::unique_lock<std::mutex> lock(mutex);
-                cv.wait_for(lock, std::chrono::milliseconds(1));
-            }
+            if (!hasReadyWork()) waitForWork();
         }
     }
     
@@ -300,72 +582,118 @@ public:
         auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(maxMs);
         while (running && std::chrono::steady_clock::now() < deadline && hasPendingWork()) {
             tick();
+            if (!hasReadyWork()) waitForWork(deadline);
         }
     }
     
     void stop() {
         running = false;
+        std::lock_guard<std::mutex> lock(mutex);
         cv.notify_all();
     }
     
+    // Promise pendente sem timer nem IO que possa assenta-la nao segura o
+    // loop: ninguem mais a resolveria
     bool hasPendingWork() const {
-        return !microtasks.empty() || !macrotasks.empty() || 
-               !timers.empty() || !ioCompletions.empty() ||
-               hasPendingPromises();
+        return hasReadyWork() || timers.size() > 0 || ioInFlight > 0;
     }
     
     bool hasPendingPromises() const {
-        for (const auto& [id, p] : promises) {
-            if (!p->isSettled()) return true;
-        }
-        return false;
+        return pendingPromises > 0;
+    }
+    
+    size_t pendingTimers() const {
+        return timers.size();
     }
 
 private:
+    // Trabalho que o proximo tick executa sem esperar
+    bool hasReadyWork() const {
+        return !microtasks.empty() || !macrotasks.empty() || !ioCompletions.empty() || !readyWaiters.empty();
+    }
+    
+    uint64_t nowTick() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - epoch).count());
+    }
+    
+    uint64_t timerExpiry(int64_t delayMs) const {
+        return std::max(nowTick(), timers.current()) + static_cast<uint64_t>(std::max<int64_t>(0, delayMs));
+    }
+    
+    void wake() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping.load()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cv.notify_one();
+        }
+    }
+    
+    // Dorme ate o proximo timer (ou limit), acordando antes se outra thread
+    // entregar trabalho. sleeping e ligado antes de olhar a fila de novo:
+    // um completeIO que nao viu o loop dormindo ja esta visivel aqui.
+    void waitForWork(std::chrono::steady_clock::time_point limit =
+                         std::chrono::steady_clock::time_point::max()) {
+        // Sem timer, o que falta e IO em voo (que pode acabar sem completeIO)
+        const uint64_t next = timers.nextExpiry();
+        auto until = next != TimerWheel::NEVER ? epoch + std::chrono::milliseconds(next)
+                                               : std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+        until = std::min(until, limit);
+        auto wait = [&] {
+            std::unique_lock<std::mutex> lock(mutex);
+            sleeping = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            cv.wait_until(lock, until, [this] { return !running || hasReadyWork(); });
+            sleeping = false;
+        };
+        if (blockingHook) blockingHook(wait);
+        else wait();
+    }
+    
+    void settle(int id, PromiseState state, uint64_t value, const std::string& error) {
+        Promise* p = getPromise(id);
+        if (!p || p->isSettled()) return;
+        p->state = state;
+        p->value = value;
+        p->error = error;
+        pendingPromises--;
+        for (int32_t waiter : p->waiters) readyWaiters.emplace_back(waiter, id);
+        p->waiters.clear();
+    }
+    
+    void processReadyWaiters() {
+        // Retomar pode assentar outras promises: so roda os que ja estavam prontos
+        std::vector<std::pair<int32_t, int>> ready;
+        std::swap(ready, readyWaiters);
+        for (const auto& [waiter, id] : ready) {
+            if (resumeHook) resumeHook(waiter, id);
+        }
+    }
+    
     void processMicrotasks() {
         while (!microtasks.empty()) {
             auto task = std::move(microtasks.front());
-            microtasks.pop();
-            if (task.callback) task.callback();
+            microtasks.pop_front();
+            if (task) task();
         }
     }
     
     void processIOCompletions() {
-        std::queue<std::function<void()>> completions;
-        {
-            std::lock_guard<std::mutex> lock(mutex);
-            std::swap(completions, ioCompletions);
-        }
-        while (!completions.empty()) {
-            auto cb = std::move(completions.front());
-            completions.pop();
-            if (cb) cb();
+        std::function<void()> callback;
+        for (int n = 0; n < IO_BATCH && ioCompletions.pop(callback); n++) {
+            if (callback) callback();
         }
     }
     
     void processTimers() {
-        auto now = std::chrono::steady_clock::now();
-        while (!timers.empty() && timers.top().fireAt <= now) {
-            Timer t = timers.top();
-            timers.pop();
-            
-            if (!t.cancelled && t.callback) {
-                t.callback();
-                
-                // Re-schedule interval timers
-                if (t.intervalMs > 0 && !t.cancelled) {
-                    t.fireAt = now + std::chrono::milliseconds(t.intervalMs);
-                    timers.push(t);
-                }
-            }
-        }
+        timers.advance(nowTick());
     }
     
     void processMacrotask() {
         if (!macrotasks.empty()) {
             auto task = std::move(macrotasks.front());
-            macrotasks.pop();
-            if (task.callback) task.callback();
+            macrotasks.pop_front();
+            if (task) task();
             
             // Process microtasks generated by macrotask
             processMicrotasks();
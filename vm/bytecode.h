@@ -10,6 +10,9 @@
 #define KAVA_BYTECODE_H
 
 #include <stdint.h>
+#ifdef __cplusplus
+#include <cstring>
+#endif
 
 #define KAVA_VERSION_MAJOR 2
 #define KAVA_VERSION_MINOR 5
@@ -189,13 +192,15 @@ typedef enum {
     // ========================================
     // CAMPOS E GLOBAIS (0x90 - 0x9F)
     // ========================================
-    OP_GETFIELD     = 0x90,  // Get instance field (field_index)
-    OP_PUTFIELD     = 0x91,  // Put instance field
+    OP_GETFIELD     = 0x90,  // Get instance field (symbol, cache)
+    OP_PUTFIELD     = 0x91,  // Put instance field (symbol, cache)
     OP_GETSTATIC    = 0x92,  // Get static field
     OP_PUTSTATIC    = 0x93,  // Put static field
     
     OP_LOAD_GLOBAL  = 0x94,  // Load global (legacy)
     OP_STORE_GLOBAL = 0x95,  // Store global (legacy)
+    OP_LOAD_LOCAL   = 0x96,  // Load slot do frame atual (index)
+    OP_STORE_LOCAL  = 0x97,  // Store slot do frame atual (index)
     
     // ========================================
     // ARRAYS (0xA0 - 0xAF)
@@ -255,9 +260,9 @@ typedef enum {
     // ========================================
     // MÉTODOS E CHAMADAS (0xD1 - 0xDF)
     // ========================================
-    OP_CALL         = 0xD1,  // Chama função/método estático
-    OP_INVOKE       = 0xD2,  // Invoca método de instância (virtual)
-    OP_INVOKESPEC   = 0xD3,  // Invoca construtor ou super
+    OP_CALL         = 0xD1,  // Chama função/método estático (func_index, argc)
+    OP_INVOKE       = 0xD2,  // Invoca método de instância (symbol, argc, cache)
+    OP_INVOKESPEC   = 0xD3,  // Invoca construtor ou super (class_index, symbol, argc, cache)
     OP_INVOKEINTF   = 0xD4,  // Invoca método de interface
     OP_INVOKEDYN    = 0xD5,  // Invoke dynamic (lambdas)
     OP_RET          = 0xD6,  // Return void
@@ -294,7 +299,7 @@ typedef enum {
     // ========================================
     OP_PRINT        = 0xF8,  // Print (extensão KAVA)
     OP_PRINTLN      = 0xF9,  // Print com newline
-    OP_NATIVE       = 0xFA,  // Chama método nativo
+    OP_NATIVE       = 0xFA,  // Chama método nativo (id argc)
     OP_BREAKPOINT   = 0xFB,  // Breakpoint para debug
     
     // ========================================
@@ -302,8 +307,8 @@ typedef enum {
     // ========================================
     OP_GFX_INIT     = 0xFC,  // Inicializa janela
     OP_GFX_CLEAR    = 0xFD,  // Limpa tela
-    OP_GFX_DRAW     = 0xFE,  // Desenha (sub-opcode)
-    OP_GFX_EVENT    = 0xFF,  // Poll eventos
+    OP_GFX_DRAW     = 0xFE,  // Grava retangulo no frame (cor de GFX_COLOR)
+    OP_GFX_EVENT    = 0xFF,  // Poll de um evento
     
     // Aliases legados (para compatibilidade)
     OP_ADD = OP_IADD,
@@ -323,7 +328,6 @@ typedef enum {
     
     // Aliases para graficos
     OP_GFX_DRAW_RECT = OP_GFX_DRAW,
-    OP_GFX_PRESENT = OP_GFX_DRAW,
     OP_GFX_POLL_EVENT = OP_GFX_EVENT,
     
     // ========================================
@@ -355,6 +359,9 @@ typedef enum {
     OP_STREAM_FLATMAP= 0x11F, // FlatMap
     OP_STREAM_ANYMATCH = 0x120,
     OP_STREAM_ALLMATCH = 0x121,
+    OP_STREAM_NONEMATCH = 0x122,
+    OP_STREAM_FINDFIRST = 0x123, // Primeiro elemento (ou null)
+    OP_STREAM_PARALLEL = 0x124,  // Marca o pipeline como paralelo
     
     // ========================================
     // KAVA 2.5 - ASYNC/AWAIT (0x130+)
@@ -372,6 +379,18 @@ typedef enum {
     // ========================================
     OP_PIPE          = 0x140, // Pipe: a |> f  =>  f(a)
     
+    // ========================================
+    // KAVA 2.5 - STRINGS (0x148)
+    // ========================================
+    OP_SCONCAT       = 0x148, // a + b com algum lado String (rope para resultados longos)
+    
+    // ========================================
+    // KAVA 2.5 - GRAFICOS POR FRAME (0x14C)
+    // ========================================
+    OP_GFX_COLOR     = 0x14C, // Cor dos proximos GFX_DRAW (r g b)
+    OP_GFX_PRESENT   = 0x14D, // Fim do frame: desenha o lote e apresenta uma vez
+    OP_GFX_EVENTS    = 0x14E, // Drena a fila de eventos num int[] de triplas
+    
     // ========================================
     // KAVA 2.5 - JIT HINTS (0x150+)
     // ========================================
@@ -482,12 +501,13 @@ typedef struct {
 #define KAVA_ACC_SYNTHETIC    0x1000
 #define KAVA_ACC_ANNOTATION   0x2000
 #define KAVA_ACC_ENUM         0x4000
+#define KAVA_ACC_ASYNC        0x8000  // fn/metodo async (KAVA_FN_ASYNC nos metadados)
 
 // ============================================================
 // HELPERS PARA NOMES DE OPCODES (para debug)
 // ============================================================
 #ifdef __cplusplus
-inline const char* opcodeName(uint8_t opcode) {
+inline const char* opcodeName(int32_t opcode) {
     switch (opcode) {
         case OP_NOP: return "NOP";
         case OP_HALT: return "HALT";
@@ -499,6 +519,7 @@ inline const char* opcodeName(uint8_t opcode) {
         case OP_PUSH_FLOAT: return "PUSH_FLOAT";
         case OP_PUSH_DOUBLE: return "PUSH_DOUBLE";
         case OP_PUSH_STRING: return "PUSH_STRING";
+        case OP_PUSH_CLASS: return "PUSH_CLASS";
         case OP_ICONST_M1: return "ICONST_M1";
         case OP_ICONST_0: return "ICONST_0";
         case OP_ICONST_1: return "ICONST_1";
@@ -507,48 +528,364 @@ inline const char* opcodeName(uint8_t opcode) {
         case OP_ICONST_4: return "ICONST_4";
         case OP_ICONST_5: return "ICONST_5";
         case OP_POP: return "POP";
+        case OP_POP2: return "POP2";
         case OP_DUP: return "DUP";
+        case OP_DUP2: return "DUP2";
+        case OP_DUP_X1: return "DUP_X1";
+        case OP_DUP_X2: return "DUP_X2";
         case OP_SWAP: return "SWAP";
+        case OP_NOT: return "NOT";
         case OP_IADD: return "IADD";
         case OP_ISUB: return "ISUB";
         case OP_IMUL: return "IMUL";
         case OP_IDIV: return "IDIV";
         case OP_IMOD: return "IMOD";
         case OP_INEG: return "INEG";
+        case OP_IINC: return "IINC";
+        case OP_LADD: return "LADD";
+        case OP_LSUB: return "LSUB";
+        case OP_LMUL: return "LMUL";
+        case OP_LDIV: return "LDIV";
+        case OP_LMOD: return "LMOD";
+        case OP_LNEG: return "LNEG";
+        case OP_FADD: return "FADD";
+        case OP_FSUB: return "FSUB";
+        case OP_FMUL: return "FMUL";
+        case OP_FDIV: return "FDIV";
+        case OP_FMOD: return "FMOD";
+        case OP_FNEG: return "FNEG";
+        case OP_DADD: return "DADD";
+        case OP_DSUB: return "DSUB";
+        case OP_DMUL: return "DMUL";
+        case OP_DDIV: return "DDIV";
+        case OP_DMOD: return "DMOD";
+        case OP_DNEG: return "DNEG";
+        case OP_IAND: return "IAND";
+        case OP_IOR: return "IOR";
+        case OP_IXOR: return "IXOR";
+        case OP_ISHL: return "ISHL";
+        case OP_ISHR: return "ISHR";
+        case OP_IUSHR: return "IUSHR";
+        case OP_LAND: return "LAND";
+        case OP_LOR: return "LOR";
+        case OP_LXOR: return "LXOR";
+        case OP_LSHL: return "LSHL";
+        case OP_LSHR: return "LSHR";
+        case OP_LUSHR: return "LUSHR";
+        case OP_ICMP: return "ICMP";
+        case OP_LCMP: return "LCMP";
+        case OP_FCMPL: return "FCMPL";
+        case OP_FCMPG: return "FCMPG";
+        case OP_DCMPL: return "DCMPL";
+        case OP_DCMPG: return "DCMPG";
         case OP_IEQ: return "IEQ";
         case OP_INE: return "INE";
         case OP_ILT: return "ILT";
+        case OP_IGE: return "IGE";
         case OP_IGT: return "IGT";
         case OP_ILE: return "ILE";
-        case OP_IGE: return "IGE";
+        case OP_ACMPEQ: return "ACMPEQ";
+        case OP_ACMPNE: return "ACMPNE";
+        case OP_ANULL: return "ANULL";
+        case OP_ANNULL: return "ANNULL";
+        case OP_I2L: return "I2L";
+        case OP_I2F: return "I2F";
+        case OP_I2D: return "I2D";
+        case OP_L2I: return "L2I";
+        case OP_L2F: return "L2F";
+        case OP_L2D: return "L2D";
+        case OP_F2I: return "F2I";
+        case OP_F2L: return "F2L";
+        case OP_F2D: return "F2D";
+        case OP_D2I: return "D2I";
+        case OP_D2L: return "D2L";
+        case OP_D2F: return "D2F";
+        case OP_I2B: return "I2B";
+        case OP_I2C: return "I2C";
+        case OP_I2S: return "I2S";
         case OP_ILOAD: return "ILOAD";
-        case OP_ISTORE: return "ISTORE";
+        case OP_LLOAD: return "LLOAD";
+        case OP_FLOAD: return "FLOAD";
+        case OP_DLOAD: return "DLOAD";
         case OP_ALOAD: return "ALOAD";
+        case OP_ILOAD_0: return "ILOAD_0";
+        case OP_ILOAD_1: return "ILOAD_1";
+        case OP_ILOAD_2: return "ILOAD_2";
+        case OP_ILOAD_3: return "ILOAD_3";
+        case OP_ALOAD_0: return "ALOAD_0";
+        case OP_ALOAD_1: return "ALOAD_1";
+        case OP_ALOAD_2: return "ALOAD_2";
+        case OP_ALOAD_3: return "ALOAD_3";
+        case OP_ISTORE: return "ISTORE";
+        case OP_LSTORE: return "LSTORE";
+        case OP_FSTORE: return "FSTORE";
+        case OP_DSTORE: return "DSTORE";
         case OP_ASTORE: return "ASTORE";
+        case OP_ISTORE_0: return "ISTORE_0";
+        case OP_ISTORE_1: return "ISTORE_1";
+        case OP_ISTORE_2: return "ISTORE_2";
+        case OP_ISTORE_3: return "ISTORE_3";
+        case OP_ASTORE_0: return "ASTORE_0";
+        case OP_ASTORE_1: return "ASTORE_1";
+        case OP_ASTORE_2: return "ASTORE_2";
+        case OP_ASTORE_3: return "ASTORE_3";
         case OP_GETFIELD: return "GETFIELD";
         case OP_PUTFIELD: return "PUTFIELD";
         case OP_GETSTATIC: return "GETSTATIC";
         case OP_PUTSTATIC: return "PUTSTATIC";
+        case OP_LOAD_GLOBAL: return "LOAD_GLOBAL";
+        case OP_STORE_GLOBAL: return "STORE_GLOBAL";
+        case OP_LOAD_LOCAL: return "LOAD_LOCAL";
+        case OP_STORE_LOCAL: return "STORE_LOCAL";
+        case OP_NEWARRAY: return "NEWARRAY";
+        case OP_ANEWARRAY: return "ANEWARRAY";
+        case OP_MULTIANEW: return "MULTIANEW";
+        case OP_ARRAYLENGTH: return "ARRAYLENGTH";
+        case OP_IALOAD: return "IALOAD";
+        case OP_LALOAD: return "LALOAD";
+        case OP_FALOAD: return "FALOAD";
+        case OP_DALOAD: return "DALOAD";
+        case OP_AALOAD: return "AALOAD";
+        case OP_BALOAD: return "BALOAD";
+        case OP_CALOAD: return "CALOAD";
+        case OP_SALOAD: return "SALOAD";
+        case OP_IASTORE: return "IASTORE";
+        case OP_LASTORE: return "LASTORE";
+        case OP_FASTORE: return "FASTORE";
+        case OP_DASTORE: return "DASTORE";
+        case OP_AASTORE: return "AASTORE";
+        case OP_BASTORE: return "BASTORE";
+        case OP_CASTORE: return "CASTORE";
+        case OP_SASTORE: return "SASTORE";
         case OP_JMP: return "JMP";
         case OP_JZ: return "JZ";
         case OP_JNZ: return "JNZ";
+        case OP_IFEQ: return "IFEQ";
+        case OP_IFNE: return "IFNE";
+        case OP_IFLT: return "IFLT";
+        case OP_IFGE: return "IFGE";
+        case OP_IFGT: return "IFGT";
+        case OP_IFLE: return "IFLE";
+        case OP_IF_ICMPEQ: return "IF_ICMPEQ";
+        case OP_IF_ICMPNE: return "IF_ICMPNE";
+        case OP_IF_ICMPLT: return "IF_ICMPLT";
+        case OP_IF_ICMPGE: return "IF_ICMPGE";
+        case OP_IF_ICMPGT: return "IF_ICMPGT";
+        case OP_IF_ICMPLE: return "IF_ICMPLE";
+        case OP_TABLESWITCH: return "TABLESWITCH";
+        case OP_LOOKUPSWITCH: return "LOOKUPSWITCH";
         case OP_CALL: return "CALL";
         case OP_INVOKE: return "INVOKE";
+        case OP_INVOKESPEC: return "INVOKESPEC";
+        case OP_INVOKEINTF: return "INVOKEINTF";
+        case OP_INVOKEDYN: return "INVOKEDYN";
         case OP_RET: return "RET";
         case OP_IRET: return "IRET";
+        case OP_LRET: return "LRET";
+        case OP_FRET: return "FRET";
+        case OP_DRET: return "DRET";
         case OP_ARET: return "ARET";
         case OP_NEW: return "NEW";
-        case OP_NEWARRAY: return "NEWARRAY";
-        case OP_ARRAYLENGTH: return "ARRAYLENGTH";
         case OP_INSTANCEOF: return "INSTANCEOF";
+        case OP_CHECKCAST: return "CHECKCAST";
         case OP_ATHROW: return "ATHROW";
         case OP_MONITORENTER: return "MONITORENTER";
         case OP_MONITOREXIT: return "MONITOREXIT";
+        case OP_TRY_BEGIN: return "TRY_BEGIN";
+        case OP_TRY_END: return "TRY_END";
+        case OP_CATCH: return "CATCH";
+        case OP_FINALLY: return "FINALLY";
         case OP_PRINT: return "PRINT";
+        case OP_PRINTLN: return "PRINTLN";
         case OP_NATIVE: return "NATIVE";
+        case OP_BREAKPOINT: return "BREAKPOINT";
+        case OP_GFX_INIT: return "GFX_INIT";
+        case OP_GFX_CLEAR: return "GFX_CLEAR";
+        case OP_GFX_DRAW: return "GFX_DRAW";
+        case OP_GFX_EVENT: return "GFX_EVENT";
+        case OP_LAMBDA_NEW: return "LAMBDA_NEW";
+        case OP_LAMBDA_CALL: return "LAMBDA_CALL";
+        case OP_CAPTURE_LOCAL: return "CAPTURE_LOCAL";
+        case OP_CAPTURE_LOAD: return "CAPTURE_LOAD";
+        case OP_STREAM_NEW: return "STREAM_NEW";
+        case OP_STREAM_FILTER: return "STREAM_FILTER";
+        case OP_STREAM_MAP: return "STREAM_MAP";
+        case OP_STREAM_REDUCE: return "STREAM_REDUCE";
+        case OP_STREAM_FOREACH: return "STREAM_FOREACH";
+        case OP_STREAM_COLLECT: return "STREAM_COLLECT";
+        case OP_STREAM_COUNT: return "STREAM_COUNT";
+        case OP_STREAM_SUM: return "STREAM_SUM";
+        case OP_STREAM_SORT: return "STREAM_SORT";
+        case OP_STREAM_DISTINCT: return "STREAM_DISTINCT";
+        case OP_STREAM_LIMIT: return "STREAM_LIMIT";
+        case OP_STREAM_SKIP: return "STREAM_SKIP";
+        case OP_STREAM_TOLIST: return "STREAM_TOLIST";
+        case OP_STREAM_MIN: return "STREAM_MIN";
+        case OP_STREAM_MAX: return "STREAM_MAX";
+        case OP_STREAM_FLATMAP: return "STREAM_FLATMAP";
+        case OP_STREAM_ANYMATCH: return "STREAM_ANYMATCH";
+        case OP_STREAM_ALLMATCH: return "STREAM_ALLMATCH";
+        case OP_STREAM_NONEMATCH: return "STREAM_NONEMATCH";
+        case OP_STREAM_FINDFIRST: return "STREAM_FINDFIRST";
+        case OP_STREAM_PARALLEL: return "STREAM_PARALLEL";
+        case OP_ASYNC_CALL: return "ASYNC_CALL";
+        case OP_AWAIT: return "AWAIT";
+        case OP_PROMISE_NEW: return "PROMISE_NEW";
+        case OP_PROMISE_RESOLVE: return "PROMISE_RESOLVE";
+        case OP_PROMISE_REJECT: return "PROMISE_REJECT";
+        case OP_YIELD: return "YIELD";
+        case OP_EVENT_LOOP_TICK: return "EVENT_LOOP_TICK";
+        case OP_PIPE: return "PIPE";
+        case OP_SCONCAT: return "SCONCAT";
+        case OP_GFX_COLOR: return "GFX_COLOR";
+        case OP_GFX_PRESENT: return "GFX_PRESENT";
+        case OP_GFX_EVENTS: return "GFX_EVENTS";
+        case OP_JIT_HOTLOOP: return "JIT_HOTLOOP";
+        case OP_JIT_HOTFUNC: return "JIT_HOTFUNC";
+        case OP_JIT_DEOPT: return "JIT_DEOPT";
+        case OP_JIT_OSR: return "JIT_OSR";
         default: return "UNKNOWN";
     }
 }
+
+// Numero de palavras int32 de operando que seguem o opcode no stream
+// (mesma convencao usada pelo Codegen e pela VM)
+inline int opcodeOperandCount(int32_t opcode) {
+    switch (opcode) {
+        case OP_INVOKESPEC:
+            return 4;
+        case OP_INVOKE:
+            return 3;
+        case OP_PUSH_LONG: case OP_PUSH_DOUBLE:
+        case OP_IINC: case OP_LAMBDA_NEW: case OP_NATIVE:
+        case OP_GETFIELD: case OP_PUTFIELD: case OP_CALL:
+            return 2;
+        case OP_PUSH_INT: case OP_PUSH_FLOAT: case OP_PUSH_STRING: case OP_PUSH_CLASS:
+        case OP_ILOAD: case OP_LLOAD: case OP_FLOAD: case OP_DLOAD: case OP_ALOAD:
+        case OP_ISTORE: case OP_LSTORE: case OP_FSTORE: case OP_DSTORE: case OP_ASTORE:
+        case OP_GETSTATIC: case OP_PUTSTATIC:
+        case OP_LOAD_GLOBAL: case OP_STORE_GLOBAL: case OP_LOAD_LOCAL: case OP_STORE_LOCAL:
+        case OP_NEWARRAY: case OP_ANEWARRAY: case OP_MULTIANEW:
+        case OP_JMP: case OP_JZ: case OP_JNZ:
+        case OP_IFEQ: case OP_IFNE: case OP_IFLT: case OP_IFGE: case OP_IFGT: case OP_IFLE:
+        case OP_IF_ICMPEQ: case OP_IF_ICMPNE: case OP_IF_ICMPLT:
+        case OP_IF_ICMPGE: case OP_IF_ICMPGT: case OP_IF_ICMPLE:
+        case OP_INVOKEINTF: case OP_INVOKEDYN:
+        case OP_NEW: case OP_INSTANCEOF: case OP_CHECKCAST:
+        case OP_TRY_BEGIN:
+        case OP_LAMBDA_CALL: case OP_CAPTURE_LOCAL: case OP_CAPTURE_LOAD:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// ============================================================
+// NATIVOS CHAMAVEIS VIA OP_NATIVE
+// ============================================================
+// OP_NATIVE id argc: o id e o indice nesta tabela (so cresce no fim, para
+// nao invalidar .kvb antigos). O Codegen emite a chamada quando Classe.metodo
+// consta aqui com aridade compativel; a VM resolve o nome em nativeMethods.
+struct NativeSignature {
+    const char* name;
+    int minArgs;
+    int maxArgs;
+};
+
+static const NativeSignature NATIVE_SIGNATURES[] = {
+    {"System.currentTimeMillis", 0, 0},
+    {"System.nanoTime", 0, 0},
+    {"System.gc", 0, 0},
+    {"Math.sqrt", 1, 1},
+    {"Math.sin", 1, 1},
+    {"Math.cos", 1, 1},
+    {"Math.pow", 2, 2},
+    {"Math.abs", 1, 1},
+    {"Math.log", 1, 1},
+    {"Thread.sleep", 1, 1},
+    {"System.arraycopy", 5, 5},  // (src, srcPos, dest, destPos, length)
+    {"Arrays.fill", 2, 4},       // (a, v) ou (a, from, to, v)
+    {"Arrays.equals", 2, 2},
+    {"Arrays.mismatch", 2, 2},
+    {"Promise.delay", 1, 2},     // (ms) ou (ms, v)
+    {"Files.lines", 1, 1},       // (path): stream das linhas, lido sob demanda
+    {"Files.size", 1, 1},
+    {"Files.readString", 1, 1},
+    {"Files.readBytes", 1, 1},   // byte[] copiado de um mmap do arquivo
+    {"StringBuilder.<init>", 0, 1},  // new StringBuilder(...) sem classe no programa
+    {"Json.parse", 1, 1},        // (texto): texto normalizado ou null se malformado
+    {"Json.error", 1, 1},        // (texto): motivo da rejeicao ("ok" se valido)
+    {"Json.stringify", 1, 1},
+    {"Json.prettyPrint", 1, 2},  // (json[, indent])
+    {"Json.query", 2, 2},        // (json, ponteiro): texto do valor, sob demanda
+    {"Json.type", 2, 2},
+    {"Json.getString", 2, 2},
+    {"Json.getLong", 2, 2},
+    {"Json.getDouble", 2, 2},
+    {"Json.size", 2, 2},
+};
+
+static const int32_t NATIVE_COUNT = static_cast<int32_t>(sizeof(NATIVE_SIGNATURES) / sizeof(NATIVE_SIGNATURES[0]));
+
+inline int32_t nativeId(const char* name) {
+    for (int32_t i = 0; i < NATIVE_COUNT; i++) {
+        if (std::strcmp(NATIVE_SIGNATURES[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+inline const NativeSignature* nativeSignature(int32_t id) {
+    return (id >= 0 && id < NATIVE_COUNT) ? &NATIVE_SIGNATURES[id] : nullptr;
+}
+
+// ============================================================
+// INTRINSECOS GRAFICOS (stdlib/gfx.kava)
+// ============================================================
+// native_gfx_*(...) compila direto para o opcode, com os argumentos na
+// pilha. Os que nao empilham resultado ganham um PUSH_NULL do Codegen para
+// a chamada continuar valendo como expressao.
+struct GfxIntrinsic {
+    const char* name;
+    int32_t opcode;
+    int argc;
+    bool pushes;
+};
+
+static const GfxIntrinsic GFX_INTRINSICS[] = {
+    {"native_gfx_init", OP_GFX_INIT, 2, false},        // (w, h)
+    {"native_gfx_clear", OP_GFX_CLEAR, 3, false},      // (r, g, b)
+    {"native_gfx_color", OP_GFX_COLOR, 3, false},      // (r, g, b)
+    {"native_gfx_draw_rect", OP_GFX_DRAW, 4, false},   // (x, y, w, h)
+    {"native_gfx_present", OP_GFX_PRESENT, 0, false},
+    {"native_gfx_poll_event", OP_GFX_EVENT, 0, true},
+    {"native_gfx_events", OP_GFX_EVENTS, 0, true},
+};
+
+inline const GfxIntrinsic* gfxIntrinsic(const char* name) {
+    for (const auto& g : GFX_INTRINSICS) {
+        if (std::strcmp(g.name, name) == 0) return &g;
+    }
+    return nullptr;
+}
+
+// ============================================================
+// METADADOS DO PROGRAMA (funcoes e classes)
+// ============================================================
+// O kavac grava um bloco antes do codigo:
+//   KAVA_BYTECODE_MAGIC, n, <n palavras>
+// e todo endereco (saltos, codeOffset) conta a partir da primeira palavra
+// depois do bloco. Um .kvb sem o magic e so codigo de script. Bloco:
+//   simbolos  count, {len, (len + 3) / 4 palavras com os bytes}
+//   funcoes   count, {nome, params (| KAVA_FN_ASYNC), locals, codeOffset}
+//   classes   count, {nome, super (-1 = nenhuma),
+//                     campos count, {nome, KAVA_T_* ou 0 = referencia},
+//                     metodos count, {nome, params (| KAVA_FN_ASYNC), locals, codeOffset}}
+//   caches    numero de inline caches (INVOKE, INVOKESPEC, GETFIELD, PUTFIELD)
+//   strings   count, {simbolo com o texto}: o pool do PUSH_STRING
+// Nomes sao indices na tabela de simbolos. Nos metodos o local 0 e o this
+// (params nao o conta); construtores se chamam KAVA_CONSTRUCTOR_NAME.
+#define KAVA_CONSTRUCTOR_NAME "<init>"
+#define KAVA_FN_ASYNC 0x10000
 #endif
 
 #endif // KAVA_BYTECODE_H
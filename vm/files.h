@@ -0,0 +1,270 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 KAVA Team
+ *
+ * KAVA 2.5 - Arquivos sem iostreams
+ * OpenFile (descritor somente leitura), MappedFile (visao mmap do arquivo
+ * inteiro, sem copiar para a memoria do processo) e FileReader (linhas e
+ * blocos de um buffer fixo, para arquivos maiores que a RAM). Usados pelo
+ * FileSystem/HttpServer de runtime.h e pelos nativos Files.* da VM.
+ */
+
+#ifndef KAVA_FILES_H
+#define KAVA_FILES_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Kava {
+
+// ============================================================
+// OPEN FILE
+// ============================================================
+// Descritor O_RDONLY com o tamanho visto na abertura; fecha no destrutor
+class OpenFile {
+public:
+    OpenFile() = default;
+    explicit OpenFile(const std::string& path) { open(path); }
+    ~OpenFile() { close(); }
+
+    OpenFile(const OpenFile&) = delete;
+    OpenFile& operator=(const OpenFile&) = delete;
+    OpenFile(OpenFile&& o) noexcept : fd_(std::exchange(o.fd_, -1)), size_(std::exchange(o.size_, 0)) {}
+    OpenFile& operator=(OpenFile&& o) noexcept {
+        if (this != &o) {
+            close();
+            fd_ = std::exchange(o.fd_, -1);
+            size_ = std::exchange(o.size_, 0);
+        }
+        return *this;
+    }
+
+    // So arquivos regulares: diretorios e fifos nao tem tamanho para mapear
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            ::close(fd);
+            return false;
+        }
+        fd_ = fd;
+        size_ = static_cast<size_t>(st.st_size);
+        return true;
+    }
+
+    void close() {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+        size_ = 0;
+    }
+
+    bool isOpen() const { return fd_ >= 0; }
+    int fd() const { return fd_; }
+    size_t size() const { return size_; }
+
+private:
+    int fd_ = -1;
+    size_t size_ = 0;
+};
+
+// ============================================================
+// MAPPED FILE
+// ============================================================
+// Visao somente leitura do arquivo inteiro como array de bytes. As paginas
+// vem do page cache sob demanda: um arquivo de varios GB so ocupa o que for
+// tocado, e o kernel pode descarta-las sob pressao de memoria.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& o) noexcept
+        : base(std::exchange(o.base, nullptr)), length(std::exchange(o.length, 0)), mapped(std::exchange(o.mapped, false)) {}
+    MappedFile& operator=(MappedFile&& o) noexcept {
+        if (this != &o) {
+            close();
+            base = std::exchange(o.base, nullptr);
+            length = std::exchange(o.length, 0);
+            mapped = std::exchange(o.mapped, false);
+        }
+        return *this;
+    }
+
+    // sequential: leitura do inicio ao fim (readahead agressivo do kernel)
+    bool open(const std::string& path, bool sequential = true) {
+        close();
+        OpenFile file(path);
+        if (!file.isOpen()) return false;
+        length = file.size();
+        if (length == 0) {
+            // mmap de 0 bytes falha; arquivo vazio e uma visao vazia valida
+            base = "";
+            mapped = true;
+            return true;
+        }
+        void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file.fd(), 0);
+        if (p == MAP_FAILED) {
+            length = 0;
+            return false;
+        }
+        if (sequential) ::madvise(p, length, MADV_SEQUENTIAL);
+        base = static_cast<const char*>(p);
+        mapped = true;
+        return true;
+    }
+
+    void close() {
+        if (mapped && length > 0) ::munmap(const_cast<char*>(base), length);
+        base = nullptr;
+        length = 0;
+        mapped = false;
+    }
+
+    // Pede ao kernel para trazer as paginas antes do primeiro acesso
+    void prefetch() const {
+        if (mapped && length > 0) ::madvise(const_cast<char*>(base), length, MADV_WILLNEED);
+    }
+
+    bool isOpen() const { return mapped; }
+    const char* data() const { return base; }
+    size_t size() const { return length; }
+    std::string_view view() const { return std::string_view(base ? base : "", length); }
+    const uint8_t* bytes() const { return reinterpret_cast<const uint8_t*>(base); }
+    char operator[](size_t i) const { return base[i]; }
+    const char* begin() const { return base; }
+    const char* end() const { return base + length; }
+
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+    bool mapped = false;
+};
+
+// ============================================================
+// FILE READER
+// ============================================================
+// Le com read() num buffer fixo e entrega linhas/blocos como string_view
+// dentro dele: nenhuma alocacao por linha. A view vale ate a proxima
+// chamada. O buffer so cresce se uma linha sozinha nao couber nele.
+class FileReader {
+public:
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+    FileReader() = default;
+    explicit FileReader(const std::string& path, size_t bufferSize = BUFFER_SIZE) { open(path, bufferSize); }
+    ~FileReader() { close(); }
+
+    FileReader(const FileReader&) = delete;
+    FileReader& operator=(const FileReader&) = delete;
+
+    bool open(const std::string& path, size_t bufferSize = BUFFER_SIZE) {
+        close();
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+#ifdef POSIX_FADV_SEQUENTIAL
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        buffer.resize(bufferSize > 0 ? bufferSize : BUFFER_SIZE);
+        pos = end = scanned = 0;
+        eof = failed = false;
+        return true;
+    }
+
+    void close() {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+        eof = true;
+    }
+
+    bool isOpen() const { return fd >= 0; }
+    // Erro de leitura (distinto do fim do arquivo)
+    bool error() const { return failed; }
+
+    // Proxima linha sem o '\n' (e sem o '\r' de CRLF); false no fim.
+    // A ultima linha sem '\n' final tambem e entregue.
+    bool nextLine(std::string_view& line) {
+        if (buffer.empty()) return false;
+        for (;;) {
+            const char* from = buffer.data() + pos + scanned;
+            const char* nl = static_cast<const char*>(std::memchr(from, '\n', end - pos - scanned));
+            if (nl) {
+                size_t len = static_cast<size_t>(nl - (buffer.data() + pos));
+                line = std::string_view(buffer.data() + pos, len);
+                if (len > 0 && line.back() == '\r') line.remove_suffix(1);
+                pos += len + 1;
+                scanned = 0;
+                return true;
+            }
+            scanned = end - pos;
+            if (!fill()) {
+                if (pos == end) return false;
+                line = std::string_view(buffer.data() + pos, end - pos);
+                if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+                pos = end;
+                scanned = 0;
+                return true;
+            }
+        }
+    }
+
+    // Proximo bloco (ate o tamanho do buffer); false no fim
+    bool nextChunk(std::string_view& chunk) {
+        if (buffer.empty()) return false;
+        if (pos == end && !fill()) return false;
+        chunk = std::string_view(buffer.data() + pos, end - pos);
+        pos = end;
+        scanned = 0;
+        return true;
+    }
+
+private:
+    int fd = -1;
+    std::vector<char> buffer;
+    size_t pos = 0;       // inicio dos bytes ainda nao entregues
+    size_t end = 0;       // fim dos bytes lidos
+    size_t scanned = 0;   // bytes apos pos ja procurados por '\n'
+    bool eof = true;
+    bool failed = false;
+
+    // Move o resto para o inicio (dobra o buffer se ele estiver cheio) e
+    // le mais; false quando nada novo chegou
+    bool fill() {
+        if (eof) return false;
+        if (pos > 0) {
+            std::memmove(buffer.data(), buffer.data() + pos, end - pos);
+            end -= pos;
+            pos = 0;
+        }
+        if (end == buffer.size()) buffer.resize(buffer.size() * 2);
+        for (;;) {
+            ssize_t r = ::read(fd, buffer.data() + end, buffer.size() - end);
+            if (r > 0) {
+                end += static_cast<size_t>(r);
+                return true;
+            }
+            if (r < 0 && errno == EINTR) continue;
+            if (r < 0) failed = true;
+            eof = true;
+            return false;
+        }
+    }
+};
+
+} // namespace Kava
+
+#endif // KAVA_FILES_H
@@ -0,0 +1,106 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 KAVA Team
+ *
+ * KAVA 2.5 - Buffer de comandos graficos por frame
+ * Os opcodes GFX_CLEAR/GFX_DRAW so gravam comandos; GFX_PRESENT entrega o
+ * frame inteiro ao renderer de uma vez. Retangulos seguidos da mesma cor
+ * viram um unico SDL_RenderFillRects, e um clear descarta o que veio antes
+ * dele no frame (seria pintado por cima de qualquer forma).
+ */
+
+#ifndef KAVA_GFX_H
+#define KAVA_GFX_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Kava {
+
+// Mesmo layout de SDL_Rect: o lote vai direto para SDL_RenderFillRects
+struct GfxRect {
+    int32_t x, y, w, h;
+};
+
+struct GfxCommand {
+    enum Kind : uint8_t { CLEAR, FILL };
+    Kind kind;
+    uint8_t r, g, b, a;
+    uint32_t first;   // FILL: primeiro retangulo em rects
+    uint32_t count;   // FILL: quantos retangulos seguidos
+};
+
+// Eventos drenados por GFX_EVENTS: triplas {tipo, a, b} num int[]
+enum GfxEventKind : int32_t {
+    GFX_EVENT_QUIT       = 1,
+    GFX_EVENT_KEY_DOWN   = 2,  // a = keycode
+    GFX_EVENT_KEY_UP     = 3,  // a = keycode
+    GFX_EVENT_MOUSE_DOWN = 4,  // a, b = x, y
+    GFX_EVENT_MOUSE_UP   = 5,  // a, b = x, y
+    GFX_EVENT_MOUSE_MOVE = 6   // a, b = x, y
+};
+
+class GfxBatch {
+public:
+    // Area visivel: retangulos totalmente fora dela nem entram no lote
+    void setViewport(int32_t w, int32_t h) {
+        viewW = w;
+        viewH = h;
+    }
+
+    // Cor dos proximos retangulos (branco ate a primeira troca)
+    void setColor(int32_t r, int32_t g, int32_t b, int32_t a = 255) {
+        color[0] = channel(r);
+        color[1] = channel(g);
+        color[2] = channel(b);
+        color[3] = channel(a);
+    }
+
+    void clear(int32_t r, int32_t g, int32_t b) {
+        commands.clear();
+        rects.clear();
+        commands.push_back({GfxCommand::CLEAR, channel(r), channel(g), channel(b), 255, 0, 0});
+    }
+
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h) {
+        if (w <= 0 || h <= 0) return;
+        if (viewW > 0 && (x >= viewW || y >= viewH || x + w <= 0 || y + h <= 0)) return;
+        if (commands.empty() || commands.back().kind != GfxCommand::FILL || !sameColor(commands.back())) {
+            commands.push_back({GfxCommand::FILL, color[0], color[1], color[2], color[3],
+                                static_cast<uint32_t>(rects.size()), 0});
+        }
+        rects.push_back({x, y, w, h});
+        commands.back().count++;
+    }
+
+    const std::vector<GfxCommand>& frameCommands() const { return commands; }
+    const GfxRect* rectsAt(uint32_t first) const { return rects.data() + first; }
+    size_t rectCount() const { return rects.size(); }
+    bool empty() const { return commands.empty(); }
+
+    // Fim do frame: mantem a capacidade para o proximo nao realocar
+    void reset() {
+        commands.clear();
+        rects.clear();
+    }
+
+private:
+    std::vector<GfxCommand> commands;
+    std::vector<GfxRect> rects;
+    uint8_t color[4] = {255, 255, 255, 255};
+    int32_t viewW = 0;
+    int32_t viewH = 0;
+
+    static uint8_t channel(int32_t v) {
+        return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+    }
+
+    bool sameColor(const GfxCommand& c) const {
+        return c.r == color[0] && c.g == color[1] && c.b == color[2] && c.a == color[3];
+    }
+};
+
+} // namespace Kava
+
+#endif // KAVA_GFX_H
@@ -40,6 +40,8 @@ struct ProfileData {
     uint64_t branchNotTaken = 0;
     bool isHot = false;
     bool isCompiled = false;
+    int nativeLoop = -1;          // indice em NativeJIT::loops (jit_native.h)
+    bool nativeRejected = false;  // regiao com opcode nao suportado pelo backend
 };
 
 // ============================================================
@@ -67,12 +69,100 @@ enum SuperOp : int32_t {
     SUPER_LOAD_LOAD_ADD = 0x206, // load + load + add
     SUPER_LOAD_LOAD_MUL = 0x207, // load + load + mul
     
+    // Fused global-to-global (c = a op b, sem tocar na pilha)
+    SUPER_GLOBAL_ADD   = 0x208,  // dst, a, b
+    SUPER_GLOBAL_SUB   = 0x209,  // dst, a, b
+    SUPER_GLOBAL_MUL   = 0x20A,  // dst, a, b
+    
+    // Fused compare + branch
+    SUPER_LOAD_LOAD_CMP_JZ = 0x20B, // load + load + icmp + jz
+    SUPER_CMP_JZ       = 0x20C,  // icmp + jz (operandos na pilha)
+    
     // Fused loop patterns
     SUPER_COUNTED_LOOP = 0x210,  // Entire counted for-loop
     SUPER_ARRAY_FILL   = 0x211,  // Array fill loop
     SUPER_SUM_LOOP     = 0x212,  // Sum reduction loop
 };
 
+// Operandos de cada superinstrucao (complementa opcodeOperandCount)
+inline int superOpOperandCount(int32_t op) {
+    switch (op) {
+        case SUPER_LOAD_ADD: case SUPER_LOAD_SUB: case SUPER_LOAD_MUL:
+            return 1;
+        case SUPER_PUSH_STORE: case SUPER_LOAD_LOAD_ADD: case SUPER_LOAD_LOAD_MUL:
+        case SUPER_CMP_JZ:
+            return 2;
+        case SUPER_GLOBAL_ADD: case SUPER_GLOBAL_SUB: case SUPER_GLOBAL_MUL:
+            return 3;
+        case SUPER_LOAD_CMP_JZ: case SUPER_LOAD_LOAD_CMP_JZ:
+            return 4;
+        case SUPER_INC_CMP_JNZ:
+            return 6;  // idx, amount, var, cmpVal, cmpOp, target
+        default:
+            return 0;
+    }
+}
+
+inline int instructionOperandCount(int32_t op) {
+    return op >= SUPER_LOAD_ADD ? superOpOperandCount(op) : opcodeOperandCount(op);
+}
+
+// Nome de opcode ou superinstrucao (histograma do profiler)
+inline const char* instructionName(int32_t op) {
+    switch (op) {
+        case SUPER_LOAD_ADD: return "SUPER_LOAD_ADD";
+        case SUPER_LOAD_SUB: return "SUPER_LOAD_SUB";
+        case SUPER_LOAD_MUL: return "SUPER_LOAD_MUL";
+        case SUPER_LOAD_CMP_JZ: return "SUPER_LOAD_CMP_JZ";
+        case SUPER_INC_CMP_JNZ: return "SUPER_INC_CMP_JNZ";
+        case SUPER_PUSH_STORE: return "SUPER_PUSH_STORE";
+        case SUPER_LOAD_LOAD_ADD: return "SUPER_LOAD_LOAD_ADD";
+        case SUPER_LOAD_LOAD_MUL: return "SUPER_LOAD_LOAD_MUL";
+        case SUPER_GLOBAL_ADD: return "SUPER_GLOBAL_ADD";
+        case SUPER_GLOBAL_SUB: return "SUPER_GLOBAL_SUB";
+        case SUPER_GLOBAL_MUL: return "SUPER_GLOBAL_MUL";
+        case SUPER_LOAD_LOAD_CMP_JZ: return "SUPER_LOAD_LOAD_CMP_JZ";
+        case SUPER_CMP_JZ: return "SUPER_CMP_JZ";
+        case SUPER_COUNTED_LOOP: return "SUPER_COUNTED_LOOP";
+        case SUPER_ARRAY_FILL: return "SUPER_ARRAY_FILL";
+        case SUPER_SUM_LOOP: return "SUPER_SUM_LOOP";
+        default: return opcodeName(op);
+    }
+}
+
+// Indice do operando que guarda um endereco absoluto de bytecode (-1 = nenhum)
+inline int jumpOperandIndex(int32_t op) {
+    switch (op) {
+        case OP_JMP: case OP_JZ: case OP_JNZ: case OP_TRY_BEGIN:
+            return 0;
+        case SUPER_CMP_JZ:
+            return 1;
+        case SUPER_LOAD_CMP_JZ: case SUPER_LOAD_LOAD_CMP_JZ:
+            return 3;
+        case SUPER_INC_CMP_JNZ:
+            return 5;
+        default:
+            return -1;
+    }
+}
+
+inline bool isIntCompareOp(int32_t op) {
+    return op == OP_IEQ || op == OP_INE || op == OP_ILT ||
+           op == OP_ILE || op == OP_IGT || op == OP_IGE;
+}
+
+inline bool compareInt(int32_t cmpOp, int32_t a, int32_t b) {
+    switch (cmpOp) {
+        case OP_IEQ: return a == b;
+        case OP_INE: return a != b;
+        case OP_ILT: return a < b;
+        case OP_ILE: return a <= b;
+        case OP_IGT: return a > b;
+        case OP_IGE: return a >= b;
+        default: return false;
+    }
+}
+
 // ============================================================
 // JIT COMPILER
 // ============================================================
@@ -93,12 +183,13 @@ public:
     // ========================================
     // PROFILING
     // ========================================
-    void recordExecution(int pc) {
+    ProfileData& recordExecution(int pc) {
         auto& p = profiles[pc];
         p.executionCount++;
         if (p.executionCount >= HOT_THRESHOLD) {
             p.isHot = true;
         }
+        return p;
     }
     
     void recordBranch(int pc, bool taken) {
@@ -387,20 +478,26 @@ public:
     std::vector<LoopInfo> detectedLoops;
     
     void detectLoops(const std::vector<int32_t>& bytecode) {
-        for (size_t i = 0; i < bytecode.size(); i++) {
-            if (bytecode[i] == OP_JMP && i + 1 < bytecode.size()) {
-                int32_t target = bytecode[i + 1];
+        // Decodifica instrucao a instrucao para nao confundir operandos com opcodes
+        size_t i = 0;
+        while (i < bytecode.size()) {
+            int32_t op = bytecode[i];
+            size_t width = 1 + instructionOperandCount(op);
+            int jumpIdx = jumpOperandIndex(op);
+            if (jumpIdx >= 0 && op != OP_TRY_BEGIN && i + width <= bytecode.size()) {
+                int32_t target = bytecode[i + 1 + jumpIdx];
                 if (target >= 0 && target < (int32_t)i) {
                     LoopInfo loop;
                     loop.startPC = target;
-                    loop.endPC = i + 2;
+                    loop.endPC = i + width;
                     loop.backEdgePC = i;
                     loop.iterationCount = 0;
-                    loop.isCountedLoop = false;
+                    loop.isCountedLoop = (op == SUPER_INC_CMP_JNZ);
                     loop.isCompiled = false;
                     detectedLoops.push_back(loop);
                 }
             }
+            i += width;
         }
     }
 };
@@ -0,0 +1,487 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 KAVA Team
+ *
+ * KAVA 2.5 - Native JIT Backend (x86-64)
+ * Compila loops quentes (detectLoops + HOT_THRESHOLD) para codigo de maquina
+ * em memoria mmap'd executavel. A VM entra no codigo nativo via OSR no
+ * back-edge e volta ao interpretador no PC de saida devolvido.
+ */
+
+#ifndef KAVA_JIT_NATIVE_H
+#define KAVA_JIT_NATIVE_H
+
+#include "bytecode.h"
+#include "jit.h"
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+#define KAVA_NATIVE_JIT 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Kava {
+
+// ============================================================
+// VALUE LAYOUT - como um Value Int aparece na memoria
+// ============================================================
+// O backend nao conhece Value; a VM informa stride e offset do payload.
+struct NativeValueLayout {
+    int32_t stride = 16;
+    int32_t payloadOffset = 8;
+};
+
+// ============================================================
+// NATIVE JIT
+// ============================================================
+// Modelo de execucao do codigo gerado (System V, rdi = globals):
+//  - a pilha de operandos da regiao vive na pilha nativa (push/pop de 8 bytes,
+//    so os 32 bits baixos importam);
+//  - toda saida da regiao (salto para fora ou queda do fim) devolve o PC de
+//    bytecode em eax com a pilha de operandos vazia;
+//  - so opcodes inteiros sobre globais sao suportados; qualquer outro faz a
+//    compilacao falhar e o loop continua no interpretador;
+//  - a VM so entra se todos os globais referenciados forem Int, entao nada
+//    dentro da regiao produz outro tipo e as tags nao precisam ser escritas;
+//  - sem poll de safepoint nos back-edges: como nada aqui toca o heap, a VM
+//    roda a regiao dentro de uma Heap::BlockingRegion (ver VM::osrEnter).
+class NativeJIT {
+public:
+    using EntryFn = int32_t (*)(void* globals);
+
+    struct NativeLoop {
+        int startPC = 0;
+        int endPC = 0;
+        EntryFn entry = nullptr;
+        void* memory = nullptr;
+        size_t memorySize = 0;
+        size_t codeSize = 0;
+        std::vector<int32_t> globalsUsed;
+        uint64_t entries = 0;
+    };
+
+    NativeValueLayout layout;
+    size_t maxGlobals = 0;
+    std::vector<NativeLoop> loops;
+
+    NativeJIT() = default;
+    NativeJIT(const NativeJIT&) = delete;
+    NativeJIT& operator=(const NativeJIT&) = delete;
+
+    ~NativeJIT() {
+#ifdef KAVA_NATIVE_JIT
+        for (auto& loop : loops) {
+            if (loop.memory) munmap(loop.memory, loop.memorySize);
+        }
+#endif
+    }
+
+    static bool available() {
+#ifdef KAVA_NATIVE_JIT
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Compila [start, end) e devolve o indice em loops, ou -1 se a regiao
+    // contem algo que o backend nao sabe gerar
+    int compile(const std::vector<int32_t>& bc, int start, int end) {
+#ifdef KAVA_NATIVE_JIT
+        if (start < 0 || end > static_cast<int>(bc.size()) || start >= end) return -1;
+
+        NativeLoop loop;
+        loop.startPC = start;
+        loop.endPC = end;
+        code.clear();
+        labels.clear();
+        fixups.clear();
+
+        std::vector<int> starts;
+        if (!decodeRegion(bc, start, end, starts, loop.globalsUsed)) return -1;
+        if (!checkStackDepth(bc, start, end)) return -1;
+
+        for (int pc : starts) {
+            labels[pc] = code.size();
+            if (!emitInstruction(bc, pc)) return -1;
+        }
+        // Queda do fim da regiao e a primeira saida
+        emitExit(end);
+        labels[end] = code.size() - EXIT_STUB_SIZE;
+
+        // Saidas para fora da regiao: um stub "mov eax, pc; ret" por alvo
+        for (auto& f : fixups) {
+            if (labels.find(f.targetPC) == labels.end()) {
+                labels[f.targetPC] = code.size();
+                emitExit(f.targetPC);
+            }
+        }
+        for (auto& f : fixups) {
+            int32_t rel = static_cast<int32_t>(labels[f.targetPC] - (f.at + 4));
+            std::memcpy(&code[f.at], &rel, 4);
+        }
+
+        long page = sysconf(_SC_PAGESIZE);
+        size_t size = ((code.size() + page - 1) / page) * page;
+        void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) return -1;
+        std::memcpy(mem, code.data(), code.size());
+        if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0) {
+            munmap(mem, size);
+            return -1;
+        }
+
+        loop.memory = mem;
+        loop.memorySize = size;
+        loop.codeSize = code.size();
+        loop.entry = reinterpret_cast<EntryFn>(mem);
+        loops.push_back(std::move(loop));
+        return static_cast<int>(loops.size()) - 1;
+#else
+        (void)bc; (void)start; (void)end;
+        return -1;
+#endif
+    }
+
+private:
+    static constexpr int MAX_STACK_DEPTH = 64;
+    static constexpr size_t EXIT_STUB_SIZE = 6;  // mov eax, imm32; ret
+
+    struct Fixup {
+        size_t at;        // posicao do rel32
+        int32_t targetPC;
+    };
+
+    std::vector<uint8_t> code;
+    std::map<int32_t, size_t> labels;  // PC de bytecode -> offset nativo
+    std::vector<Fixup> fixups;
+
+    // ========================================
+    // ANALISE DA REGIAO
+    // ========================================
+    static bool supported(int32_t op) {
+        switch (op) {
+            case OP_NOP: case OP_PUSH_TRUE: case OP_PUSH_FALSE: case OP_PUSH_INT:
+            case OP_ICONST_M1: case OP_ICONST_0: case OP_ICONST_1: case OP_ICONST_2:
+            case OP_ICONST_3: case OP_ICONST_4: case OP_ICONST_5:
+            case OP_POP: case OP_DUP: case OP_SWAP:
+            case OP_IADD: case OP_ISUB: case OP_IMUL: case OP_IDIV: case OP_IMOD:
+            case OP_INEG: case OP_IINC: case OP_NOT:
+            case OP_IEQ: case OP_INE: case OP_ILT: case OP_ILE: case OP_IGT: case OP_IGE:
+            case OP_IAND: case OP_IOR: case OP_IXOR: case OP_ISHL: case OP_ISHR: case OP_IUSHR:
+            case OP_ILOAD: case OP_ISTORE: case OP_LOAD_GLOBAL: case OP_STORE_GLOBAL:
+            case OP_JMP: case OP_JZ: case OP_JNZ:
+            case SUPER_LOAD_LOAD_ADD: case SUPER_LOAD_LOAD_MUL: case SUPER_PUSH_STORE:
+            case SUPER_LOAD_CMP_JZ: case SUPER_LOAD_LOAD_CMP_JZ: case SUPER_CMP_JZ:
+            case SUPER_INC_CMP_JNZ:
+            case SUPER_GLOBAL_ADD: case SUPER_GLOBAL_SUB: case SUPER_GLOBAL_MUL:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Operandos que sao indices de globais
+    static int globalOperands(int32_t op, int idx[3]) {
+        switch (op) {
+            case OP_ILOAD: case OP_ISTORE: case OP_LOAD_GLOBAL: case OP_STORE_GLOBAL:
+            case OP_IINC: case SUPER_LOAD_CMP_JZ:
+                idx[0] = 0; return 1;
+            case SUPER_PUSH_STORE:
+                idx[0] = 1; return 1;
+            case SUPER_LOAD_LOAD_ADD: case SUPER_LOAD_LOAD_MUL: case SUPER_LOAD_LOAD_CMP_JZ:
+                idx[0] = 0; idx[1] = 1; return 2;
+            case SUPER_INC_CMP_JNZ:
+                idx[0] = 0; idx[1] = 2; return 2;
+            case SUPER_GLOBAL_ADD: case SUPER_GLOBAL_SUB: case SUPER_GLOBAL_MUL:
+                idx[0] = 0; idx[1] = 1; idx[2] = 2; return 3;
+            default:
+                return 0;
+        }
+    }
+
+    // (consome, produz) na pilha de operandos
+    static void stackEffect(int32_t op, int& pops, int& pushes) {
+        pops = 0; pushes = 0;
+        switch (op) {
+            case OP_PUSH_TRUE: case OP_PUSH_FALSE: case OP_PUSH_INT:
+            case OP_ICONST_M1: case OP_ICONST_0: case OP_ICONST_1: case OP_ICONST_2:
+            case OP_ICONST_3: case OP_ICONST_4: case OP_ICONST_5:
+            case OP_ILOAD: case OP_LOAD_GLOBAL:
+            case SUPER_LOAD_LOAD_ADD: case SUPER_LOAD_LOAD_MUL:
+                pushes = 1; break;
+            case OP_POP: case OP_ISTORE: case OP_STORE_GLOBAL: case OP_JZ: case OP_JNZ:
+                pops = 1; break;
+            case OP_DUP: pops = 1; pushes = 2; break;
+            case OP_SWAP: pops = 2; pushes = 2; break;
+            case OP_INEG: case OP_NOT: pops = 1; pushes = 1; break;
+            case OP_IADD: case OP_ISUB: case OP_IMUL: case OP_IDIV: case OP_IMOD:
+            case OP_IEQ: case OP_INE: case OP_ILT: case OP_ILE: case OP_IGT: case OP_IGE:
+            case OP_IAND: case OP_IOR: case OP_IXOR: case OP_ISHL: case OP_ISHR: case OP_IUSHR:
+                pops = 2; pushes = 1; break;
+            case SUPER_CMP_JZ: pops = 2; break;
+            default: break;
+        }
+    }
+
+    bool decodeRegion(const std::vector<int32_t>& bc, int start, int end,
+                      std::vector<int>& starts, std::vector<int32_t>& globalsUsed) const {
+        std::vector<bool> isStart(end - start, false);
+        int pc = start;
+        while (pc < end) {
+            int32_t op = bc[pc];
+            if (!supported(op)) return false;
+            int width = 1 + instructionOperandCount(op);
+            if (pc + width > end) return false;
+
+            int cmpIdx = op == SUPER_CMP_JZ ? 0 :
+                         (op == SUPER_LOAD_CMP_JZ || op == SUPER_LOAD_LOAD_CMP_JZ) ? 2 :
+                         op == SUPER_INC_CMP_JNZ ? 4 : -1;
+            if (cmpIdx >= 0 && !isIntCompareOp(bc[pc + 1 + cmpIdx])) return false;
+
+            int idx[3];
+            int n = globalOperands(op, idx);
+            for (int i = 0; i < n; i++) {
+                int32_t g = bc[pc + 1 + idx[i]];
+                if (g < 0 || static_cast<size_t>(g) >= maxGlobals) return false;
+                if (std::find(globalsUsed.begin(), globalsUsed.end(), g) == globalsUsed.end()) {
+                    globalsUsed.push_back(g);
+                }
+            }
+            isStart[pc - start] = true;
+            starts.push_back(pc);
+            pc += width;
+        }
+        // Saltos para dentro da regiao precisam cair em inicio de instrucao
+        for (int s : starts) {
+            int j = jumpOperandIndex(bc[s]);
+            if (j < 0) continue;
+            int32_t t = bc[s + 1 + j];
+            if (t >= start && t < end && !isStart[t - start]) return false;
+        }
+        return true;
+    }
+
+    // Profundidade da pilha precisa ser a mesma em todo caminho ate cada PC
+    // e zero em toda saida da regiao
+    static bool checkStackDepth(const std::vector<int32_t>& bc, int start, int end) {
+        std::vector<int> depth(end - start, -1);
+        std::vector<int> work;
+        depth[0] = 0;
+        work.push_back(start);
+
+        auto flow = [&](int target, int d) {
+            if (target < start || target >= end) return d == 0;  // saida
+            int& slot = depth[target - start];
+            if (slot == -1) { slot = d; work.push_back(target); return true; }
+            return slot == d;
+        };
+
+        while (!work.empty()) {
+            int pc = work.back();
+            work.pop_back();
+            int32_t op = bc[pc];
+            int pops, pushes;
+            stackEffect(op, pops, pushes);
+            int d = depth[pc - start];
+            if (d < pops) return false;
+            d = d - pops + pushes;
+            if (d > MAX_STACK_DEPTH) return false;
+
+            int next = pc + 1 + instructionOperandCount(op);
+            int j = jumpOperandIndex(op);
+            if (j >= 0 && !flow(bc[pc + 1 + j], d)) return false;
+            if (op != OP_JMP && !flow(next, d)) return false;
+        }
+        return true;
+    }
+
+    // ========================================
+    // EMISSAO x86-64
+    // ========================================
+    void byte(uint8_t b) { code.push_back(b); }
+    void bytes(std::initializer_list<uint8_t> bs) { code.insert(code.end(), bs); }
+    void dword(int32_t v) {
+        uint8_t raw[4];
+        std::memcpy(raw, &v, 4);
+        code.insert(code.end(), raw, raw + 4);
+    }
+
+    int32_t disp(int32_t globalIdx) const {
+        return globalIdx * layout.stride + layout.payloadOffset;
+    }
+
+    // op r32, [rdi + disp32] com ModRM mod=10 rm=rdi
+    void memOp(std::initializer_list<uint8_t> opcode, uint8_t reg, int32_t globalIdx) {
+        bytes(opcode);
+        byte(static_cast<uint8_t>(0x80 | (reg << 3) | 7));
+        dword(disp(globalIdx));
+    }
+
+    void loadEax(int32_t g)  { memOp({0x8B}, 0, g); }        // mov eax, [g]
+    void storeEax(int32_t g) { memOp({0x89}, 0, g); }        // mov [g], eax
+    void pushGlobal(int32_t g) { memOp({0xFF}, 6, g); }      // push qword [g]
+    void popRax() { byte(0x58); }
+    void popRcx() { byte(0x59); }
+    void pushRax() { byte(0x50); }
+    void pushImm(int32_t v) {
+        if (v >= -128 && v <= 127) { byte(0x6A); byte(static_cast<uint8_t>(v)); }
+        else { byte(0x68); dword(v); }
+    }
+
+    // Codigo de condicao x86 (nibble de Jcc/SETcc) para cada icmp
+    static uint8_t condCode(int32_t cmpOp) {
+        switch (cmpOp) {
+            case OP_IEQ: return 0x4;
+            case OP_INE: return 0x5;
+            case OP_ILT: return 0xC;
+            case OP_IGE: return 0xD;
+            case OP_ILE: return 0xE;
+            case OP_IGT: return 0xF;
+            default: return 0x4;
+        }
+    }
+    static uint8_t invert(uint8_t cc) { return cc ^ 1; }
+
+    void jumpTo(int32_t targetPC) {
+        byte(0xE9);
+        fixups.push_back({code.size(), targetPC});
+        dword(0);
+    }
+    void jccTo(uint8_t cc, int32_t targetPC) {
+        bytes({0x0F, static_cast<uint8_t>(0x80 | cc)});
+        fixups.push_back({code.size(), targetPC});
+        dword(0);
+    }
+    void emitExit(int32_t pc) {
+        byte(0xB8); dword(pc);   // mov eax, pc
+        byte(0xC3);              // ret
+    }
+
+    // a em eax, b em ecx -> resultado em eax (semantica da VM: x/0 = 0, x%0 = 0)
+    void emitDivMod(bool mod) {
+        bytes({0x85, 0xC9});                     // test ecx, ecx
+        bytes({0x74, 0x00}); size_t jzZero = code.size() - 1;
+        bytes({0x83, 0xF9, 0xFF});               // cmp ecx, -1
+        bytes({0x74, 0x00}); size_t jeNeg = code.size() - 1;
+        byte(0x99);                              // cdq
+        bytes({0xF7, 0xF9});                     // idiv ecx
+        if (mod) bytes({0x89, 0xD0});            // mov eax, edx
+        bytes({0xEB, 0x00}); size_t jmpDone1 = code.size() - 1;
+        code[jeNeg] = static_cast<uint8_t>(code.size() - (jeNeg + 1));
+        // x / -1 = -x com wraparound (idiv trapa em INT_MIN / -1); x % -1 = 0
+        if (mod) bytes({0x31, 0xC0}); else bytes({0xF7, 0xD8});
+        bytes({0xEB, 0x00}); size_t jmpDone2 = code.size() - 1;
+        code[jzZero] = static_cast<uint8_t>(code.size() - (jzZero + 1));
+        bytes({0x31, 0xC0});                     // xor eax, eax
+        code[jmpDone1] = static_cast<uint8_t>(code.size() - (jmpDone1 + 1));
+        code[jmpDone2] = static_cast<uint8_t>(code.size() - (jmpDone2 + 1));
+    }
+
+    bool emitInstruction(const std::vector<int32_t>& bc, int pc) {
+        int32_t op = bc[pc];
+        const int32_t* a = &bc[pc + 1];
+        switch (op) {
+            case OP_NOP: break;
+            case OP_PUSH_TRUE: pushImm(1); break;
+            case OP_PUSH_FALSE: pushImm(0); break;
+            case OP_PUSH_INT: pushImm(a[0]); break;
+            case OP_ICONST_M1: pushImm(-1); break;
+            case OP_ICONST_0: case OP_ICONST_1: case OP_ICONST_2:
+            case OP_ICONST_3: case OP_ICONST_4: case OP_ICONST_5:
+                pushImm(op - OP_ICONST_0); break;
+            case OP_POP: bytes({0x48, 0x83, 0xC4, 0x08}); break;      // add rsp, 8
+            case OP_DUP: bytes({0xFF, 0x34, 0x24}); break;            // push qword [rsp]
+            case OP_SWAP: popRax(); popRcx(); pushRax(); byte(0x51); break;
+
+            case OP_IADD: case OP_ISUB: case OP_IMUL:
+            case OP_IAND: case OP_IOR: case OP_IXOR:
+            case OP_ISHL: case OP_ISHR: case OP_IUSHR:
+            case OP_IDIV: case OP_IMOD:
+                popRcx(); popRax();
+                switch (op) {
+                    case OP_IADD: bytes({0x01, 0xC8}); break;
+                    case OP_ISUB: bytes({0x29, 0xC8}); break;
+                    case OP_IMUL: bytes({0x0F, 0xAF, 0xC1}); break;
+                    case OP_IAND: bytes({0x21, 0xC8}); break;
+                    case OP_IOR:  bytes({0x09, 0xC8}); break;
+                    case OP_IXOR: bytes({0x31, 0xC8}); break;
+                    case OP_ISHL: bytes({0xD3, 0xE0}); break;
+                    case OP_ISHR: bytes({0xD3, 0xF8}); break;
+                    case OP_IUSHR: bytes({0xD3, 0xE8}); break;
+                    case OP_IDIV: emitDivMod(false); break;
+                    case OP_IMOD: emitDivMod(true); break;
+                }
+                pushRax();
+                break;
+
+            case OP_IEQ: case OP_INE: case OP_ILT: case OP_ILE: case OP_IGT: case OP_IGE:
+                popRcx(); popRax();
+                bytes({0x39, 0xC8});                                  // cmp eax, ecx
+                bytes({0x0F, static_cast<uint8_t>(0x90 | condCode(op)), 0xC0});  // setcc al
+                bytes({0x0F, 0xB6, 0xC0});                            // movzx eax, al
+                pushRax();
+                break;
+
+            case OP_INEG: bytes({0xF7, 0x1C, 0x24}); break;           // neg dword [rsp]
+            case OP_NOT:
+                popRax();
+                bytes({0x85, 0xC0, 0x0F, 0x94, 0xC0, 0x0F, 0xB6, 0xC0});  // test; sete; movzx
+                pushRax();
+                break;
+
+            case OP_IINC:
+                memOp({0x81}, 0, a[0]); dword(a[1]);                  // add dword [g], imm32
+                break;
+            case OP_ILOAD: case OP_LOAD_GLOBAL: pushGlobal(a[0]); break;
+            case OP_ISTORE: case OP_STORE_GLOBAL: popRax(); storeEax(a[0]); break;
+
+            case OP_JMP: jumpTo(a[0]); break;
+            case OP_JZ:  popRax(); bytes({0x85, 0xC0}); jccTo(0x4, a[0]); break;
+            case OP_JNZ: popRax(); bytes({0x85, 0xC0}); jccTo(0x5, a[0]); break;
+
+            case SUPER_LOAD_LOAD_ADD: loadEax(a[0]); memOp({0x03}, 0, a[1]); pushRax(); break;
+            case SUPER_LOAD_LOAD_MUL: loadEax(a[0]); memOp({0x0F, 0xAF}, 0, a[1]); pushRax(); break;
+            case SUPER_PUSH_STORE: memOp({0xC7}, 0, a[1]); dword(a[0]); break;  // mov dword [g], imm32
+
+            case SUPER_LOAD_CMP_JZ:
+                loadEax(a[0]);
+                byte(0x3D); dword(a[1]);                              // cmp eax, imm32
+                jccTo(invert(condCode(a[2])), a[3]);
+                break;
+            case SUPER_LOAD_LOAD_CMP_JZ:
+                loadEax(a[0]);
+                memOp({0x3B}, 0, a[1]);                               // cmp eax, [g]
+                jccTo(invert(condCode(a[2])), a[3]);
+                break;
+            case SUPER_CMP_JZ:
+                popRcx(); popRax();
+                bytes({0x39, 0xC8});
+                jccTo(invert(condCode(a[0])), a[1]);
+                break;
+            case SUPER_INC_CMP_JNZ:
+                memOp({0x81}, 0, a[0]); dword(a[1]);
+                loadEax(a[2]);
+                byte(0x3D); dword(a[3]);
+                jccTo(condCode(a[4]), a[5]);
+                break;
+
+            case SUPER_GLOBAL_ADD: loadEax(a[1]); memOp({0x03}, 0, a[2]); storeEax(a[0]); break;
+            case SUPER_GLOBAL_SUB: loadEax(a[1]); memOp({0x2B}, 0, a[2]); storeEax(a[0]); break;
+            case SUPER_GLOBAL_MUL: loadEax(a[1]); memOp({0x0F, 0xAF}, 0, a[2]); storeEax(a[0]); break;
+
+            default:
+                return false;
+        }
+        return true;
+    }
+};
+
+} // namespace Kava
+
+#endif // KAVA_JIT_NATIVE_H
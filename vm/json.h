@@ -0,0 +1,1212 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 KAVA Team
+ *
+ * KAVA 2.5 - JSON
+ * Parser em dois estagios no estilo simdjson: o estagio 1 classifica o
+ * texto em blocos de 64 bytes com SIMD (AVX2 escolhido pelo CPUID, NEON em
+ * AArch64, escalar no resto) e indexa os caracteres estruturais; o estagio 2
+ * percorre o indice montando um DOM compacto numa arena, com strings e
+ * chaves apontando para o proprio texto sempre que nao ha escape. O modo
+ * sob demanda (JsonOnDemand) para no estagio 1 e navega pelo indice,
+ * pulando subarvores inteiras sem monta-las. JsonWriter serializa direto
+ * num buffer.
+ */
+
+#ifndef KAVA_JSON_H
+#define KAVA_JSON_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <charconv>
+#include <cmath>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define KAVA_JSON_AVX2 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define KAVA_JSON_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace Kava {
+
+enum class JsonError : uint8_t {
+    None,
+    Empty,           // so espacos
+    UnclosedString,
+    Syntax,          // estrutura invalida (token inesperado, colchetes trocados)
+    Number,
+    Literal,         // true/false/null mal escrito
+    Escape,          // \x invalido ou \u incompleto
+    Control,         // caractere de controle cru dentro de string
+    Depth,           // aninhamento acima de JSON_MAX_DEPTH
+    Trailing,        // conteudo depois do valor raiz
+    TooLarge,        // indices de 32 bits: ate 4 GiB
+};
+
+inline const char* jsonErrorName(JsonError e) {
+    switch (e) {
+        case JsonError::None: return "ok";
+        case JsonError::Empty: return "documento vazio";
+        case JsonError::UnclosedString: return "string sem fechar";
+        case JsonError::Syntax: return "erro de sintaxe";
+        case JsonError::Number: return "numero invalido";
+        case JsonError::Literal: return "literal invalido";
+        case JsonError::Escape: return "escape invalido";
+        case JsonError::Control: return "caractere de controle em string";
+        case JsonError::Depth: return "aninhamento profundo demais";
+        case JsonError::Trailing: return "conteudo depois do valor";
+        case JsonError::TooLarge: return "documento grande demais";
+    }
+    return "?";
+}
+
+static constexpr int JSON_MAX_DEPTH = 1024;
+
+// ============================================================
+// ESTAGIO 1 - CLASSIFICACAO EM BLOCOS DE 64 BYTES
+// ============================================================
+// Cada kernel devolve, para 64 bytes, as mascaras (bit i = byte i) de aspas,
+// barras invertidas, operadores ({}[]:,) e espacos. O resto do estagio 1 e
+// aritmetica de bits comum aos tres.
+namespace JsonSimd {
+
+struct BlockMasks {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t op;
+    uint64_t whitespace;
+};
+
+using ClassifyFn = BlockMasks (*)(const uint8_t* block);
+
+namespace Scalar {
+
+inline BlockMasks classify(const uint8_t* p) {
+    BlockMasks m{0, 0, 0, 0};
+    for (int i = 0; i < 64; i++) {
+        const uint64_t bit = 1ULL << i;
+        switch (p[i]) {
+            case '"': m.quote |= bit; break;
+            case '\\': m.backslash |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',': m.op |= bit; break;
+            case ' ': case '\t': case '\n': case '\r': m.whitespace |= bit; break;
+            default: break;
+        }
+    }
+    return m;
+}
+
+// Primeiro byte em [p, end) que e aspas, barra ou controle (< 0x20)
+inline const uint8_t* findStringSpecial(const uint8_t* p, const uint8_t* end) {
+    while (p < end && *p != '"' && *p != '\\' && *p >= 0x20) p++;
+    return p;
+}
+
+} // namespace Scalar
+
+#if defined(KAVA_JSON_AVX2)
+namespace Avx2 {
+
+#define KAVA_JSON_TARGET __attribute__((target("avx2")))
+
+KAVA_JSON_TARGET inline uint64_t eqMask(__m256i lo, __m256i hi, char c) {
+    const __m256i v = _mm256_set1_epi8(c);
+    const uint32_t a = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, v)));
+    const uint32_t b = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, v)));
+    return a | (static_cast<uint64_t>(b) << 32);
+}
+
+// Operadores e espacos pela tabela de nibbles (vpshufb): os 8 bytes
+// interessantes caem em classes pelo nibble baixo e alto
+KAVA_JSON_TARGET inline BlockMasks classify(const uint8_t* p) {
+    const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+    BlockMasks m;
+    m.quote = eqMask(lo, hi, '"');
+    m.backslash = eqMask(lo, hi, '\\');
+    m.op = eqMask(lo, hi, '{') | eqMask(lo, hi, '}') | eqMask(lo, hi, '[') | eqMask(lo, hi, ']') |
+           eqMask(lo, hi, ':') | eqMask(lo, hi, ',');
+    m.whitespace = eqMask(lo, hi, ' ') | eqMask(lo, hi, '\t') | eqMask(lo, hi, '\n') | eqMask(lo, hi, '\r');
+    return m;
+}
+
+KAVA_JSON_TARGET inline const uint8_t* findStringSpecial(const uint8_t* p, const uint8_t* end) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i slash = _mm256_set1_epi8('\\');
+    const __m256i ctrl = _mm256_set1_epi8(0x1F);
+    for (; p + 32 <= end; p += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        // max(v, 0x1F) == 0x1F  <=>  v <= 0x1F (sem sinal)
+        const __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, slash)),
+            _mm256_cmpeq_epi8(_mm256_max_epu8(v, ctrl), ctrl));
+        const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(special));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return Scalar::findStringSpecial(p, end);
+}
+
+#undef KAVA_JSON_TARGET
+
+} // namespace Avx2
+#endif // KAVA_JSON_AVX2
+
+#if defined(KAVA_JSON_NEON)
+namespace Neon {
+
+// movemask de 16 bytes (0x00/0xFF) em 16 bits
+inline uint16_t movemask(uint8x16_t v) {
+    static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t bits = vandq_u8(v, vld1q_u8(weights));
+    const uint8x8_t sum = vpadd_u8(vpadd_u8(vpadd_u8(vget_low_u8(bits), vget_high_u8(bits)), vdup_n_u8(0)), vdup_n_u8(0));
+    // sum[0] = byte baixo (lanes 0..7), sum[1] = byte alto (lanes 8..15)
+    return static_cast<uint16_t>(vget_lane_u8(sum, 0) | (vget_lane_u8(sum, 1) << 8));
+}
+
+inline uint64_t eqMask(const uint8x16_t* v, uint8_t c) {
+    const uint8x16_t k = vdupq_n_u8(c);
+    uint64_t m = 0;
+    for (int i = 0; i < 4; i++) m |= static_cast<uint64_t>(movemask(vceqq_u8(v[i], k))) << (16 * i);
+    return m;
+}
+
+inline BlockMasks classify(const uint8_t* p) {
+    const uint8x16_t v[4] = {vld1q_u8(p), vld1q_u8(p + 16), vld1q_u8(p + 32), vld1q_u8(p + 48)};
+    BlockMasks m;
+    m.quote = eqMask(v, '"');
+    m.backslash = eqMask(v, '\\');
+    m.op = eqMask(v, '{') | eqMask(v, '}') | eqMask(v, '[') | eqMask(v, ']') | eqMask(v, ':') | eqMask(v, ',');
+    m.whitespace = eqMask(v, ' ') | eqMask(v, '\t') | eqMask(v, '\n') | eqMask(v, '\r');
+    return m;
+}
+
+inline const uint8_t* findStringSpecial(const uint8_t* p, const uint8_t* end) {
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t slash = vdupq_n_u8('\\');
+    const uint8x16_t space = vdupq_n_u8(0x20);
+    for (; p + 16 <= end; p += 16) {
+        const uint8x16_t v = vld1q_u8(p);
+        const uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, slash)), vcltq_u8(v, space));
+        if (vmaxvq_u8(special)) return p + __builtin_ctz(movemask(special));
+    }
+    return Scalar::findStringSpecial(p, end);
+}
+
+} // namespace Neon
+#endif // KAVA_JSON_NEON
+
+struct Kernels {
+    const char* name;
+    ClassifyFn classify;
+    const uint8_t* (*findStringSpecial)(const uint8_t* p, const uint8_t* end);
+};
+
+inline const Kernels& scalar() {
+    static const Kernels table{"scalar", Scalar::classify, Scalar::findStringSpecial};
+    return table;
+}
+
+// Melhor conjunto suportado pela CPU atual (detectado uma vez)
+inline const Kernels& best() {
+#if defined(KAVA_JSON_AVX2)
+    static const Kernels avx2{"avx2", Avx2::classify, Avx2::findStringSpecial};
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    return hasAvx2 ? avx2 : scalar();
+#elif defined(KAVA_JSON_NEON)
+    static const Kernels neon{"neon", Neon::classify, Neon::findStringSpecial};
+    return neon;
+#else
+    return scalar();
+#endif
+}
+
+// Bit i = paridade das aspas em [0, i]: 1 dentro de string
+inline uint64_t prefixXor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// Bytes escapados (precedidos por uma sequencia impar de barras).
+// carry: o bloco anterior terminou numa barra que escapa o primeiro byte.
+inline uint64_t escapedMask(uint64_t backslash, uint64_t& carry) {
+    if (!backslash) {
+        const uint64_t escaped = carry;
+        carry = 0;
+        return escaped;
+    }
+    backslash &= ~carry;
+    const uint64_t followsEscape = (backslash << 1) | carry;
+    const uint64_t evenBits = 0x5555555555555555ULL;
+    const uint64_t oddStarts = backslash & ~evenBits & ~followsEscape;
+    uint64_t evenSequences;
+    carry = __builtin_add_overflow(oddStarts, backslash, &evenSequences) ? 1 : 0;
+    const uint64_t invert = evenSequences << 1;
+    return (evenBits ^ invert) & followsEscape;
+}
+
+} // namespace JsonSimd
+
+// Estruturais: operadores fora de string, aspas de abertura e o primeiro
+// byte de cada escalar (numero/literal). O indice termina com json.size().
+inline JsonError jsonIndex(std::string_view json, std::vector<uint32_t>& out,
+                           const JsonSimd::Kernels& k = JsonSimd::best()) {
+    using namespace JsonSimd;
+    out.clear();
+    if (json.size() >= UINT32_MAX) return JsonError::TooLarge;
+    out.reserve(json.size() / 4 + 16);
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(json.data());
+    const size_t n = json.size();
+
+    uint64_t escapeCarry = 0, prevInString = 0, prevScalar = 0;
+    uint8_t tail[64];
+    for (size_t base = 0; base < n; base += 64) {
+        const uint8_t* block = data + base;
+        if (n - base < 64) {
+            // Ultimo bloco: completa com espacos (nao geram estruturais)
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, block, n - base);
+            block = tail;
+        }
+        const BlockMasks m = k.classify(block);
+        const uint64_t escaped = escapedMask(m.backslash, escapeCarry);
+        const uint64_t quote = m.quote & ~escaped;
+        const uint64_t inString = prefixXor(quote) ^ prevInString;
+        prevInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+        const uint64_t stringTail = inString ^ quote;
+
+        const uint64_t scalar = ~(m.op | m.whitespace);
+        const uint64_t nonQuoteScalar = scalar & ~quote;
+        const uint64_t followsScalar = (nonQuoteScalar << 1) | prevScalar;
+        prevScalar = nonQuoteScalar >> 63;
+        uint64_t structural = (m.op | (scalar & ~followsScalar)) & ~stringTail;
+
+        while (structural) {
+            out.push_back(static_cast<uint32_t>(base + __builtin_ctzll(structural)));
+            structural &= structural - 1;
+        }
+    }
+    if (prevInString) return JsonError::UnclosedString;
+    if (out.empty()) return JsonError::Empty;
+    out.push_back(static_cast<uint32_t>(n));
+    return JsonError::None;
+}
+
+// ============================================================
+// ESCALARES (compartilhados pelo DOM e pelo modo sob demanda)
+// ============================================================
+namespace JsonScalar {
+
+// Fim de token: espaco, operador ou fim do texto
+inline bool isDelimiter(std::string_view json, size_t pos) {
+    if (pos >= json.size()) return true;
+    switch (json[pos]) {
+        case ' ': case '\t': case '\n': case '\r':
+        case '{': case '}': case '[': case ']': case ':': case ',':
+            return true;
+        default:
+            return false;
+    }
+}
+
+inline JsonError literal(std::string_view json, size_t pos, std::string_view word) {
+    if (json.compare(pos, word.size(), word) != 0 || !isDelimiter(json, pos + word.size())) return JsonError::Literal;
+    return JsonError::None;
+}
+
+// Numero JSON em pos. isInt fica true quando cabe em int64 sem fracao nem
+// expoente; senao o valor vai para asDouble.
+inline JsonError number(std::string_view json, size_t pos, bool& isInt, int64_t& asInt, double& asDouble) {
+    const char* begin = json.data() + pos;
+    const char* end = json.data() + json.size();
+    const char* p = begin;
+    const bool negative = p < end && *p == '-';
+    if (negative) p++;
+    if (p >= end || *p < '0' || *p > '9') return JsonError::Number;
+
+    uint64_t magnitude = 0;
+    bool overflow = false;
+    const char* digits = p;
+    if (*p == '0') {
+        p++;
+    } else {
+        for (; p < end && *p >= '0' && *p <= '9'; p++) {
+            const uint64_t d = static_cast<uint64_t>(*p - '0');
+            if (magnitude > (UINT64_MAX - d) / 10) overflow = true;
+            magnitude = magnitude * 10 + d;
+        }
+    }
+    bool integral = true;
+    if (p < end && *p == '.') {
+        integral = false;
+        p++;
+        if (p >= end || *p < '0' || *p > '9') return JsonError::Number;
+        while (p < end && *p >= '0' && *p <= '9') p++;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        integral = false;
+        p++;
+        if (p < end && (*p == '+' || *p == '-')) p++;
+        if (p >= end || *p < '0' || *p > '9') return JsonError::Number;
+        while (p < end && *p >= '0' && *p <= '9') p++;
+    }
+    if (!isDelimiter(json, static_cast<size_t>(p - json.data()))) return JsonError::Number;
+
+    const uint64_t limit = negative ? (1ULL << 63) : static_cast<uint64_t>(INT64_MAX);
+    if (integral && !overflow && magnitude <= limit && p - digits <= 19) {
+        isInt = true;
+        asInt = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+        return JsonError::None;
+    }
+    isInt = false;
+    const auto r = std::from_chars(begin, p, asDouble);
+    if (r.ec != std::errc() && r.ec != std::errc::result_out_of_range) return JsonError::Number;
+    if (r.ec == std::errc::result_out_of_range) {
+        asDouble = negative ? -HUGE_VAL : HUGE_VAL;
+        // Underflow (expoente muito negativo) vira zero, nao infinito
+        for (const char* e = begin; e < p; e++) {
+            if ((*e == 'e' || *e == 'E') && e + 1 < p && e[1] == '-') asDouble = negative ? -0.0 : 0.0;
+        }
+    }
+    return JsonError::None;
+}
+
+inline int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+inline bool hex4(const char* p, const char* end, uint32_t& out) {
+    if (end - p < 4) return false;
+    out = 0;
+    for (int i = 0; i < 4; i++) {
+        const int d = hexDigit(p[i]);
+        if (d < 0) return false;
+        out = (out << 4) | static_cast<uint32_t>(d);
+    }
+    return true;
+}
+
+inline char* putUtf8(char* dst, uint32_t cp) {
+    if (cp < 0x80) {
+        *dst++ = static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        *dst++ = static_cast<char>(0xC0 | (cp >> 6));
+        *dst++ = static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        *dst++ = static_cast<char>(0xE0 | (cp >> 12));
+        *dst++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *dst++ = static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        *dst++ = static_cast<char>(0xF0 | (cp >> 18));
+        *dst++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        *dst++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *dst++ = static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    return dst;
+}
+
+// Corpo da string cuja aspa de abertura esta em pos. Sem escapes, raw e
+// uma fatia do texto e escapes = false; com escapes, raw vai ate a aspa de
+// fechamento (exclusive) e unescape() decodifica.
+inline JsonError stringSpan(std::string_view json, size_t pos, const JsonSimd::Kernels& k,
+                            std::string_view& raw, bool& escapes) {
+    const uint8_t* begin = reinterpret_cast<const uint8_t*>(json.data()) + pos + 1;
+    const uint8_t* end = reinterpret_cast<const uint8_t*>(json.data()) + json.size();
+    const uint8_t* p = begin;
+    escapes = false;
+    for (;;) {
+        p = k.findStringSpecial(p, end);
+        if (p >= end) return JsonError::UnclosedString;
+        if (*p == '"') break;
+        if (*p < 0x20) return JsonError::Control;
+        escapes = true;
+        p += 2;  // a barra e o byte escapado (\u continua no proprio corpo)
+        if (p > end) return JsonError::UnclosedString;
+    }
+    raw = std::string_view(reinterpret_cast<const char*>(begin), static_cast<size_t>(p - begin));
+    return JsonError::None;
+}
+
+// Decodifica raw em dst (cabe sempre em raw.size() bytes); devolve o fim
+inline char* unescape(std::string_view raw, char* dst, JsonError& err) {
+    const char* p = raw.data();
+    const char* end = p + raw.size();
+    while (p < end) {
+        const char* slash = static_cast<const char*>(std::memchr(p, '\\', static_cast<size_t>(end - p)));
+        if (!slash) slash = end;
+        std::memcpy(dst, p, static_cast<size_t>(slash - p));
+        dst += slash - p;
+        p = slash;
+        if (p >= end) break;
+        if (p + 1 >= end) { err = JsonError::Escape; return dst; }
+        const char c = p[1];
+        p += 2;
+        switch (c) {
+            case '"': *dst++ = '"'; break;
+            case '\\': *dst++ = '\\'; break;
+            case '/': *dst++ = '/'; break;
+            case 'b': *dst++ = '\b'; break;
+            case 'f': *dst++ = '\f'; break;
+            case 'n': *dst++ = '\n'; break;
+            case 'r': *dst++ = '\r'; break;
+            case 't': *dst++ = '\t'; break;
+            case 'u': {
+                uint32_t cp;
+                if (!hex4(p, end, cp)) { err = JsonError::Escape; return dst; }
+                p += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    // Par substituto: \uD8xx\uDCxx (6 bytes de escape -> 4 de UTF-8)
+                    uint32_t low;
+                    if (end - p < 6 || p[0] != '\\' || p[1] != 'u' || !hex4(p + 2, end, low) ||
+                        low < 0xDC00 || low > 0xDFFF) {
+                        err = JsonError::Escape;
+                        return dst;
+                    }
+                    p += 6;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    err = JsonError::Escape;
+                    return dst;
+                }
+                dst = putUtf8(dst, cp);
+                break;
+            }
+            default:
+                err = JsonError::Escape;
+                return dst;
+        }
+    }
+    return dst;
+}
+
+} // namespace JsonScalar
+
+// ============================================================
+// DOM COMPACTO
+// ============================================================
+// 16 bytes por valor; arrays e objetos apontam para blocos contiguos na
+// arena do documento. Strings e chaves sao views: no texto original quando
+// nao tem escape, na arena quando tem.
+struct JsonMember;
+
+struct JsonValue {
+    enum class Type : uint8_t { Null, Bool, Int, Double, String, Array, Object };
+
+    Type type = Type::Null;
+    uint32_t length = 0;  // bytes da string, elementos do array ou membros do objeto
+    union {
+        bool boolean;
+        int64_t integer;
+        double real;
+        const char* chars;
+        const JsonValue* items;
+        const JsonMember* members;
+    };
+
+    JsonValue() : integer(0) {}
+
+    bool isNull() const { return type == Type::Null; }
+    bool isBool() const { return type == Type::Bool; }
+    bool isInt() const { return type == Type::Int; }
+    bool isNumber() const { return type == Type::Int || type == Type::Double; }
+    bool isString() const { return type == Type::String; }
+    bool isArray() const { return type == Type::Array; }
+    bool isObject() const { return type == Type::Object; }
+
+    bool asBool() const { return type == Type::Bool && boolean; }
+    int64_t asInt() const {
+        return type == Type::Int ? integer : type == Type::Double ? static_cast<int64_t>(real) : 0;
+    }
+    double asDouble() const {
+        return type == Type::Double ? real : type == Type::Int ? static_cast<double>(integer) : 0.0;
+    }
+    std::string_view asString() const {
+        return type == Type::String ? std::string_view(chars, length) : std::string_view();
+    }
+
+    size_t size() const { return (type == Type::Array || type == Type::Object) ? length : 0; }
+
+    // Elemento do array (null fora do intervalo)
+    const JsonValue& operator[](size_t i) const;
+    // Membro do objeto (null se ausente); busca linear, como no texto
+    const JsonValue& operator[](std::string_view key) const;
+    const JsonValue* find(std::string_view key) const;
+
+    const JsonValue* begin() const { return type == Type::Array ? items : nullptr; }
+    const JsonValue* end() const { return type == Type::Array ? items + length : nullptr; }
+    const JsonMember* memberBegin() const { return type == Type::Object ? members : nullptr; }
+    const JsonMember* memberEnd() const;
+
+    static const JsonValue& null() {
+        static const JsonValue value;
+        return value;
+    }
+};
+
+struct JsonMember {
+    std::string_view key;
+    JsonValue value;
+};
+
+inline const JsonValue& JsonValue::operator[](size_t i) const {
+    return type == Type::Array && i < length ? items[i] : null();
+}
+
+inline const JsonMember* JsonValue::memberEnd() const {
+    return type == Type::Object ? members + length : nullptr;
+}
+
+inline const JsonValue* JsonValue::find(std::string_view key) const {
+    if (type != Type::Object) return nullptr;
+    for (const JsonMember* m = members; m != members + length; m++) {
+        if (m->key == key) return &m->value;
+    }
+    return nullptr;
+}
+
+inline const JsonValue& JsonValue::operator[](std::string_view key) const {
+    const JsonValue* v = find(key);
+    return v ? *v : null();
+}
+
+// Blocos de 64 KiB (ou do tamanho pedido, se maior); so tipos triviais
+class JsonArena {
+public:
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+        size_t offset = (used + align - 1) & ~(align - 1);
+        if (blocks.empty() || offset + bytes > capacity) {
+            // new[] ja alinha em max_align_t
+            capacity = std::max(BLOCK_SIZE, bytes);
+            blocks.push_back(std::make_unique<uint8_t[]>(capacity));
+            offset = 0;
+        }
+        used = offset + bytes;
+        return blocks.back().get() + offset;
+    }
+
+    template <typename T>
+    T* allocateArray(size_t n) {
+        return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    char* allocateChars(size_t n) { return static_cast<char*>(allocate(n, 1)); }
+
+    void clear() {
+        if (blocks.size() > 1) blocks.erase(blocks.begin(), blocks.end() - 1);
+        used = 0;
+    }
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+    std::vector<std::unique_ptr<uint8_t[]>> blocks;
+    size_t capacity = 0;
+    size_t used = 0;
+};
+
+// Documento: arena + raiz. Move-only; os valores apontam para a arena e,
+// no parse sem copia, para o texto de entrada (que precisa viver mais).
+class JsonDocument {
+public:
+    JsonDocument() = default;
+    JsonDocument(JsonDocument&&) = default;
+    JsonDocument& operator=(JsonDocument&&) = default;
+    JsonDocument(const JsonDocument&) = delete;
+    JsonDocument& operator=(const JsonDocument&) = delete;
+
+    // Sem copia: strings sem escape apontam para json
+    static JsonDocument parse(std::string_view json, const JsonSimd::Kernels& k = JsonSimd::best()) {
+        JsonDocument doc;
+        doc.build(json, k);
+        return doc;
+    }
+
+    // Copia o texto uma vez para a arena (para entradas temporarias)
+    static JsonDocument parseCopy(std::string_view json, const JsonSimd::Kernels& k = JsonSimd::best()) {
+        JsonDocument doc;
+        char* copy = doc.arena.allocateChars(json.size() + 1);
+        std::memcpy(copy, json.data(), json.size());
+        doc.build(std::string_view(copy, json.size()), k);
+        return doc;
+    }
+
+    bool ok() const { return err == JsonError::None; }
+    JsonError error() const { return err; }
+    size_t errorOffset() const { return errOffset; }
+    const JsonValue& root() const { return rootValue; }
+
+private:
+    JsonArena arena;
+    JsonValue rootValue;
+    JsonError err = JsonError::Empty;
+    size_t errOffset = 0;
+
+    // Estado do estagio 2 (so durante build)
+    struct Builder {
+        std::string_view json;
+        const std::vector<uint32_t>& index;
+        const JsonSimd::Kernels& k;
+        JsonArena& arena;
+        size_t i = 0;
+        JsonError err = JsonError::None;
+        std::vector<JsonValue> items;     // filhos dos arrays abertos
+        std::vector<JsonMember> members;  // membros dos objetos abertos
+
+        Builder(std::string_view j, const std::vector<uint32_t>& idx, const JsonSimd::Kernels& kernels, JsonArena& a)
+            : json(j), index(idx), k(kernels), arena(a) {}
+
+        char at() const { return index[i] < json.size() ? json[index[i]] : '\0'; }
+
+        bool fail(JsonError e) {
+            if (err == JsonError::None) err = e;
+            return false;
+        }
+
+        bool string(std::string_view& out) {
+            std::string_view raw;
+            bool escapes;
+            JsonError e = JsonScalar::stringSpan(json, index[i], k, raw, escapes);
+            if (e != JsonError::None) return fail(e);
+            if (!escapes) {
+                out = raw;
+            } else {
+                char* dst = arena.allocateChars(raw.size());
+                char* end = JsonScalar::unescape(raw, dst, e);
+                if (e != JsonError::None) return fail(e);
+                out = std::string_view(dst, static_cast<size_t>(end - dst));
+            }
+            i++;
+            return true;
+        }
+
+        bool value(JsonValue& out, int depth) {
+            const size_t pos = index[i];
+            if (pos >= json.size()) return fail(JsonError::Syntax);
+            switch (json[pos]) {
+                case '{': return object(out, depth + 1);
+                case '[': return array(out, depth + 1);
+                case '"': {
+                    std::string_view s;
+                    if (!string(s)) return false;
+                    out.type = JsonValue::Type::String;
+                    out.length = static_cast<uint32_t>(s.size());
+                    out.chars = s.data();
+                    return true;
+                }
+                case 't': case 'f': case 'n': {
+                    const std::string_view word = json[pos] == 't' ? "true" : json[pos] == 'f' ? "false" : "null";
+                    if (JsonScalar::literal(json, pos, word) != JsonError::None) return fail(JsonError::Literal);
+                    out.type = word == "null" ? JsonValue::Type::Null : JsonValue::Type::Bool;
+                    out.boolean = word == "true";
+                    i++;
+                    return true;
+                }
+                default: {
+                    bool isInt;
+                    int64_t n;
+                    double d;
+                    if (JsonScalar::number(json, pos, isInt, n, d) != JsonError::None) return fail(JsonError::Number);
+                    out.type = isInt ? JsonValue::Type::Int : JsonValue::Type::Double;
+                    if (isInt) out.integer = n;
+                    else out.real = d;
+                    i++;
+                    return true;
+                }
+            }
+        }
+
+        bool array(JsonValue& out, int depth) {
+            if (depth > JSON_MAX_DEPTH) return fail(JsonError::Depth);
+            i++;
+            const size_t start = items.size();
+            if (at() != ']') {
+                for (;;) {
+                    JsonValue v;
+                    if (!value(v, depth)) return false;
+                    items.push_back(v);
+                    if (at() == ',') { i++; continue; }
+                    if (at() == ']') break;
+                    return fail(JsonError::Syntax);
+                }
+            }
+            i++;
+            const size_t n = items.size() - start;
+            JsonValue* block = arena.allocateArray<JsonValue>(n);
+            std::copy(items.begin() + static_cast<std::ptrdiff_t>(start), items.end(), block);
+            items.resize(start);
+            out.type = JsonValue::Type::Array;
+            out.length = static_cast<uint32_t>(n);
+            out.items = block;
+            return true;
+        }
+
+        bool object(JsonValue& out, int depth) {
+            if (depth > JSON_MAX_DEPTH) return fail(JsonError::Depth);
+            i++;
+            const size_t start = members.size();
+            if (at() != '}') {
+                for (;;) {
+                    JsonMember m;
+                    if (at() != '"') return fail(JsonError::Syntax);
+                    if (!string(m.key)) return false;
+                    if (at() != ':') return fail(JsonError::Syntax);
+                    i++;
+                    if (!value(m.value, depth)) return false;
+                    members.push_back(m);
+                    if (at() == ',') { i++; continue; }
+                    if (at() == '}') break;
+                    return fail(JsonError::Syntax);
+                }
+            }
+            i++;
+            const size_t n = members.size() - start;
+            JsonMember* block = arena.allocateArray<JsonMember>(n);
+            std::copy(members.begin() + static_cast<std::ptrdiff_t>(start), members.end(), block);
+            members.resize(start);
+            out.type = JsonValue::Type::Object;
+            out.length = static_cast<uint32_t>(n);
+            out.members = block;
+            return true;
+        }
+    };
+
+    void build(std::string_view json, const JsonSimd::Kernels& k) {
+        std::vector<uint32_t> index;
+        err = jsonIndex(json, index, k);
+        if (err != JsonError::None) return;
+        Builder b(json, index, k, arena);
+        // O sentinela (json.size()) no fim do indice para qualquer laco: at()
+        // nele le um byte que nao e operador
+        if (b.value(rootValue, 0) && b.i != index.size() - 1) b.fail(JsonError::Trailing);
+        err = b.err;
+        if (err != JsonError::None) {
+            errOffset = b.i < index.size() ? index[b.i] : json.size();
+            rootValue = JsonValue();
+        }
+    }
+};
+
+// ============================================================
+// MODO SOB DEMANDA
+// ============================================================
+// So o estagio 1 e um par de saltos por colchete: JsonCursor le escalares
+// direto do texto quando pedidos e pula arrays/objetos inteiros em O(1).
+// Serve para pegar poucos campos de documentos grandes. Erros de sintaxe
+// fora do caminho percorrido nao sao detectados (so colchetes e strings).
+class JsonCursor;
+
+class JsonOnDemand {
+public:
+    static JsonOnDemand parse(std::string_view json, const JsonSimd::Kernels& k = JsonSimd::best()) {
+        JsonOnDemand doc;
+        doc.json = json;
+        doc.k = &k;
+        doc.err = jsonIndex(json, doc.index, k);
+        if (doc.err == JsonError::None) doc.matchBrackets();
+        return doc;
+    }
+
+    bool ok() const { return err == JsonError::None; }
+    JsonError error() const { return err; }
+    JsonCursor root() const;
+    // Ponteiro JSON (RFC 6901): "" e a raiz, "/itens/0/nome" desce por
+    // membro ou indice; ~1 e ~0 escapam '/' e '~' nas chaves
+    JsonCursor at(std::string_view pointer) const;
+
+private:
+    friend class JsonCursor;
+    std::string_view json;
+    const JsonSimd::Kernels* k = nullptr;
+    std::vector<uint32_t> index;
+    std::vector<uint32_t> jump;  // jump[i] = indice depois do fechamento de '{'/'[' em i
+    JsonError err = JsonError::Empty;
+
+    char at(uint32_t i) const { return i < index.size() && index[i] < json.size() ? json[index[i]] : '\0'; }
+
+    void matchBrackets() {
+        jump.assign(index.size(), 0);
+        std::vector<uint32_t> open;
+        for (uint32_t i = 0; i + 1 < index.size(); i++) {
+            const char c = json[index[i]];
+            if (c == '{' || c == '[') {
+                if (open.size() >= static_cast<size_t>(JSON_MAX_DEPTH)) { err = JsonError::Depth; return; }
+                open.push_back(i);
+            } else if (c == '}' || c == ']') {
+                if (open.empty() || json[index[open.back()]] != (c == '}' ? '{' : '[')) { err = JsonError::Syntax; return; }
+                jump[open.back()] = i + 1;
+                open.pop_back();
+            }
+        }
+        if (!open.empty()) err = JsonError::Syntax;
+    }
+
+    // Indice do estrutural depois do valor que comeca em i
+    uint32_t skip(uint32_t i) const {
+        const char c = at(i);
+        return (c == '{' || c == '[') ? jump[i] : i + 1;
+    }
+};
+
+class JsonCursor {
+public:
+    JsonCursor() = default;
+
+    bool valid() const { return doc && i != NONE; }
+
+    JsonValue::Type type() const {
+        switch (valid() ? doc->at(i) : 'n') {
+            case '{': return JsonValue::Type::Object;
+            case '[': return JsonValue::Type::Array;
+            case '"': return JsonValue::Type::String;
+            case 't': case 'f': return JsonValue::Type::Bool;
+            case 'n': return JsonValue::Type::Null;
+            default: {
+                bool isInt;
+                int64_t n;
+                double d;
+                JsonScalar::number(doc->json, doc->index[i], isInt, n, d);
+                return isInt ? JsonValue::Type::Int : JsonValue::Type::Double;
+            }
+        }
+    }
+
+    bool isNull() const { return !valid() || doc->at(i) == 'n'; }
+
+    // Membro do objeto (cursor invalido se ausente ou se nao e objeto)
+    JsonCursor operator[](std::string_view key) const {
+        if (!valid() || doc->at(i) != '{') return JsonCursor();
+        uint32_t p = i + 1;
+        while (doc->at(p) == '"') {
+            std::string_view raw;
+            bool escapes;
+            if (JsonScalar::stringSpan(doc->json, doc->index[p], *doc->k, raw, escapes) != JsonError::None) break;
+            bool match = raw == key;
+            if (escapes) {
+                std::string decoded(raw.size(), '\0');
+                JsonError e = JsonError::None;
+                char* end = JsonScalar::unescape(raw, decoded.data(), e);
+                match = e == JsonError::None && std::string_view(decoded.data(), static_cast<size_t>(end - decoded.data())) == key;
+            }
+            if (doc->at(p + 1) != ':') break;
+            if (match) return JsonCursor(doc, p + 2);
+            p = doc->skip(p + 2);
+            if (doc->at(p) != ',') break;
+            p++;
+        }
+        return JsonCursor();
+    }
+
+    // Elemento do array
+    JsonCursor operator[](size_t n) const {
+        JsonCursor c = first();
+        for (; c.valid() && n > 0; n--) c = c.next();
+        return c;
+    }
+
+    // Primeiro elemento do array (ou valor do primeiro membro do objeto)
+    JsonCursor first() const {
+        if (!valid()) return JsonCursor();
+        const char c = doc->at(i);
+        if (c == '[') return doc->at(i + 1) == ']' ? JsonCursor() : JsonCursor(doc, i + 1);
+        if (c == '{') return doc->at(i + 1) == '"' && doc->at(i + 2) == ':' ? JsonCursor(doc, i + 3) : JsonCursor();
+        return JsonCursor();
+    }
+
+    // Irmao seguinte dentro do mesmo array/objeto
+    JsonCursor next() const {
+        if (!valid()) return JsonCursor();
+        const uint32_t p = doc->skip(i);
+        if (doc->at(p) != ',') return JsonCursor();
+        if (doc->at(p + 1) == '"' && doc->at(p + 2) == ':') return JsonCursor(doc, p + 3);
+        return JsonCursor(doc, p + 1);
+    }
+
+    // Chave do membro cujo valor e este cursor (vazia fora de objeto)
+    std::string_view key() const {
+        if (!valid() || i < 2 || doc->at(i - 1) != ':' || doc->at(i - 2) != '"') return std::string_view();
+        std::string_view raw;
+        bool escapes;
+        JsonScalar::stringSpan(doc->json, doc->index[i - 2], *doc->k, raw, escapes);
+        return raw;
+    }
+
+    size_t size() const {
+        size_t n = 0;
+        for (JsonCursor c = first(); c.valid(); c = c.next()) n++;
+        return n;
+    }
+
+    bool getInt(int64_t& out) const {
+        bool isInt;
+        double d;
+        if (!scalarNumber(isInt, out, d)) return false;
+        if (!isInt) out = static_cast<int64_t>(d);
+        return true;
+    }
+
+    bool getDouble(double& out) const {
+        bool isInt;
+        int64_t n;
+        if (!scalarNumber(isInt, n, out)) return false;
+        if (isInt) out = static_cast<double>(n);
+        return true;
+    }
+
+    bool getBool(bool& out) const {
+        if (!valid()) return false;
+        const size_t pos = doc->index[i];
+        if (JsonScalar::literal(doc->json, pos, "true") == JsonError::None) { out = true; return true; }
+        if (JsonScalar::literal(doc->json, pos, "false") == JsonError::None) { out = false; return true; }
+        return false;
+    }
+
+    // Sem escape: view do texto, sem copia. Com escape, decodifica em out.
+    bool getString(std::string& out) const {
+        std::string_view raw;
+        bool escapes;
+        if (!stringSpan(raw, escapes)) return false;
+        if (!escapes) {
+            out.assign(raw);
+            return true;
+        }
+        out.resize(raw.size());
+        JsonError e = JsonError::None;
+        char* end = JsonScalar::unescape(raw, out.data(), e);
+        out.resize(static_cast<size_t>(end - out.data()));
+        return e == JsonError::None;
+    }
+
+    // View do corpo cru; false se nao for string ou se tiver escape
+    bool getRawString(std::string_view& out) const {
+        bool escapes;
+        return stringSpan(out, escapes) && !escapes;
+    }
+
+    // Texto do valor inteiro (para repassar um pedaco sem reserializar)
+    std::string_view raw() const {
+        if (!valid()) return std::string_view();
+        const uint32_t end = doc->skip(i);
+        const size_t from = doc->index[i];
+        size_t to = end < doc->index.size() ? doc->index[end] : doc->json.size();
+        if (doc->at(i) == '"') {
+            std::string_view body;
+            bool escapes;
+            if (stringSpan(body, escapes)) to = static_cast<size_t>(body.data() + body.size() - doc->json.data()) + 1;
+        }
+        while (to > from && (doc->json[to - 1] == ' ' || doc->json[to - 1] == '\n' ||
+                             doc->json[to - 1] == '\r' || doc->json[to - 1] == '\t')) {
+            to--;
+        }
+        return doc->json.substr(from, to - from);
+    }
+
+private:
+    friend class JsonOnDemand;
+    static constexpr uint32_t NONE = UINT32_MAX;
+    const JsonOnDemand* doc = nullptr;
+    uint32_t i = NONE;
+
+    JsonCursor(const JsonOnDemand* d, uint32_t index) : doc(d), i(index + 1 < d->index.size() ? index : NONE) {}
+
+    bool scalarNumber(bool& isInt, int64_t& n, double& d) const {
+        if (!valid()) return false;
+        const char c = doc->at(i);
+        if (c != '-' && (c < '0' || c > '9')) return false;
+        return JsonScalar::number(doc->json, doc->index[i], isInt, n, d) == JsonError::None;
+    }
+
+    bool stringSpan(std::string_view& raw, bool& escapes) const {
+        if (!valid() || doc->at(i) != '"') return false;
+        return JsonScalar::stringSpan(doc->json, doc->index[i], *doc->k, raw, escapes) == JsonError::None;
+    }
+};
+
+inline JsonCursor JsonOnDemand::root() const {
+    return ok() ? JsonCursor(this, 0) : JsonCursor();
+}
+
+inline JsonCursor JsonOnDemand::at(std::string_view pointer) const {
+    JsonCursor c = root();
+    if (!pointer.empty() && pointer[0] != '/') return JsonCursor();
+    std::string token;
+    while (c.valid() && !pointer.empty()) {
+        pointer.remove_prefix(1);
+        const size_t end = std::min(pointer.find('/'), pointer.size());
+        token.clear();
+        for (size_t j = 0; j < end; j++) {
+            if (pointer[j] == '~' && j + 1 < end && (pointer[j + 1] == '0' || pointer[j + 1] == '1')) {
+                token.push_back(pointer[++j] == '0' ? '~' : '/');
+            } else {
+                token.push_back(pointer[j]);
+            }
+        }
+        pointer.remove_prefix(end);
+        if (c.type() == JsonValue::Type::Array) {
+            size_t n = 0;
+            const auto r = std::from_chars(token.data(), token.data() + token.size(), n);
+            if (token.empty() || r.ec != std::errc() || r.ptr != token.data() + token.size()) return JsonCursor();
+            c = c[n];
+        } else {
+            c = c[std::string_view(token)];
+        }
+    }
+    return c;
+}
+
+// ============================================================
+// SERIALIZACAO DIRETO NO BUFFER
+// ============================================================
+// As virgulas saem sozinhas: cada valor ou fechamento liga pendingComma,
+// abrir container ou escrever chave desliga. Com indent > 0 cada item vai
+// numa linha propria, recuado indent espacos por nivel.
+class JsonWriter {
+public:
+    explicit JsonWriter(size_t reserve = 256, int indent = 0) : indent(indent > 0 ? indent : 0) { out.reserve(reserve); }
+
+    JsonWriter& beginObject() { separate(); out.push_back('{'); depth++; pendingComma = false; return *this; }
+    JsonWriter& endObject() { close(); out.push_back('}'); pendingComma = true; return *this; }
+    JsonWriter& beginArray() { separate(); out.push_back('['); depth++; pendingComma = false; return *this; }
+    JsonWriter& endArray() { close(); out.push_back(']'); pendingComma = true; return *this; }
+
+    JsonWriter& key(std::string_view k) {
+        separate();
+        writeString(k);
+        out.push_back(':');
+        if (indent > 0) out.push_back(' ');
+        pendingComma = false;
+        afterKey = true;
+        return *this;
+    }
+
+    JsonWriter& value(std::nullptr_t) { separate(); out.append("null", 4); return done(); }
+    JsonWriter& value(bool b) { separate(); b ? out.append("true", 4) : out.append("false", 5); return done(); }
+    JsonWriter& value(int v) { return value(static_cast<int64_t>(v)); }
+    JsonWriter& value(int64_t v) {
+        separate();
+        char buf[24];
+        const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+        out.append(buf, static_cast<size_t>(r.ptr - buf));
+        return done();
+    }
+    // JSON nao tem NaN/Infinity: viram null
+    JsonWriter& value(double v) {
+        separate();
+        if (!std::isfinite(v)) {
+            out.append("null", 4);
+        } else {
+            char buf[32];
+            const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+            out.append(buf, static_cast<size_t>(r.ptr - buf));
+            // 1500.0 sai "1500.0", nao "1500": o valor relido continua double
+            if (std::find_if(buf, r.ptr, [](char c) { return c == '.' || c == 'e'; }) == r.ptr) out.append(".0", 2);
+        }
+        return done();
+    }
+    JsonWriter& value(std::string_view s) { separate(); writeString(s); return done(); }
+    JsonWriter& value(const char* s) { return value(std::string_view(s)); }
+    JsonWriter& value(const std::string& s) { return value(std::string_view(s)); }
+
+    JsonWriter& value(const JsonValue& v) {
+        switch (v.type) {
+            case JsonValue::Type::Null: return value(nullptr);
+            case JsonValue::Type::Bool: return value(v.boolean);
+            case JsonValue::Type::Int: return value(v.integer);
+            case JsonValue::Type::Double: return value(v.real);
+            case JsonValue::Type::String: return value(v.asString());
+            case JsonValue::Type::Array:
+                beginArray();
+                for (const JsonValue& item : v) value(item);
+                return endArray();
+            case JsonValue::Type::Object:
+                beginObject();
+                for (const JsonMember* m = v.memberBegin(); m != v.memberEnd(); m++) key(m->key).value(m->value);
+                return endObject();
+        }
+        return *this;
+    }
+
+    // Texto JSON ja pronto (ex.: JsonCursor::raw), sem validar
+    JsonWriter& rawValue(std::string_view json) { separate(); out.append(json); return done(); }
+
+    const std::string& str() const { return out; }
+    std::string take() { pendingComma = afterKey = false; depth = 0; return std::move(out); }
+    void clear() { out.clear(); pendingComma = afterKey = false; depth = 0; }
+
+private:
+    std::string out;
+    int indent;
+    int depth = 0;
+    bool pendingComma = false;
+    bool afterKey = false;  // o valor segue a chave na mesma linha
+
+    void separate() {
+        if (pendingComma) out.push_back(',');
+        if (indent > 0 && depth > 0 && !afterKey) newline();
+        afterKey = false;
+    }
+
+    // Container vazio fecha na mesma linha: "[]", "{}"
+    void close() {
+        depth--;
+        if (indent > 0 && pendingComma) newline();
+    }
+
+    void newline() {
+        out.push_back('\n');
+        out.append(static_cast<size_t>(depth) * static_cast<size_t>(indent), ' ');
+    }
+
+    JsonWriter& done() {
+        pendingComma = true;
+        return *this;
+    }
+
+    // Trechos sem escape vao de uma vez; so ", \ e controles sao escapados
+    void writeString(std::string_view s) {
+        static const char hex[] = "0123456789abcdef";
+        out.push_back('"');
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(s.data());
+        const uint8_t* end = p + s.size();
+        const JsonSimd::Kernels& k = JsonSimd::best();
+        while (p < end) {
+            const uint8_t* special = k.findStringSpecial(p, end);
+            out.append(reinterpret_cast<const char*>(p), static_cast<size_t>(special - p));
+            if (special >= end) break;
+            const uint8_t c = *special;
+            switch (c) {
+                case '"': out.append("\\\"", 2); break;
+                case '\\': out.append("\\\\", 2); break;
+                case '\n': out.append("\\n", 2); break;
+                case '\r': out.append("\\r", 2); break;
+                case '\t': out.append("\\t", 2); break;
+                case '\b': out.append("\\b", 2); break;
+                case '\f': out.append("\\f", 2); break;
+                default: {
+                    const char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 15]};
+                    out.append(esc, 6);
+                    break;
+                }
+            }
+            p = special + 1;
+        }
+        out.push_back('"');
+    }
+};
+
+} // namespace Kava
+
+#endif // KAVA_JSON_H
@@ -0,0 +1,295 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 KAVA Team
+ *
+ * KAVA 2.5 - Formato binario .kvb
+ * Arquivo em secoes com cabecalho versionado; codigo e metadados em
+ * palavras de tamanho variavel. O kavac grava com encodeKvb e a VM le a
+ * imagem mapeada (mmap) com KvbImage, decodificando direto das paginas.
+ */
+
+#ifndef KAVA_KVB_H
+#define KAVA_KVB_H
+
+#include "bytecode.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+
+namespace Kava {
+
+// ============================================================
+// LAYOUT
+// ============================================================
+// Cabecalho (little-endian):
+//   uint32 KAVA_BYTECODE_MAGIC, uint16 major, uint16 minor, uint32 secoes
+//   secoes x {uint32 tipo, uint32 offset, uint32 bytes, uint32 count}
+// Secoes (todas opcionais, na ordem abaixo):
+//   POOL     count strings {varint len, bytes}: a tabela de simbolos
+//            (nomes e literais de string do PUSH_STRING)
+//   PROGRAM  o bloco de metadados de bytecode.h sem os simbolos, em varints
+//   CODE     instrucoes: opcode em 1 byte (0xFF + varint para opcodes
+//            >= 0xFF) e os opcodeOperandCount operandos em varints;
+//            count = palavras decodificadas
+//   LINES    count pares {varint delta do pc, varint delta da linha}
+// Varint: LEB128 do zigzag da palavra, entao operandos pequenos (indices,
+// slots, saltos curtos) ocupam 1 byte em vez de 4. Qualquer sequencia de
+// palavras volta identica: enderecos de salto nao mudam.
+// Um .kvb sem esse cabecalho continua sendo lido como palavras int32 cruas.
+//
+// Snapshot da VM (kavavm --snapshot): mesmo container, com IMAGE no lugar
+// de CODE e LINES ja relocada pelas superinstrucoes:
+//   IMAGE    o codigo pronto para executar (fundido), int32 crus; count = palavras
+//   ENTRIES  count varints: codeOffset de cada fn e depois de cada metodo,
+//            na ordem do PROGRAM
+//   LOOPS    count loops {varint startPC, endPC, backEdgePC, contado}
+//   PROFILE  count {varint pc, varint execucoes, varint flags KVB_PROFILE_*}
+enum KvbSection : uint32_t {
+    KVB_SECTION_POOL    = 1,
+    KVB_SECTION_PROGRAM = 2,
+    KVB_SECTION_CODE    = 3,
+    KVB_SECTION_LINES   = 4,
+    KVB_SECTION_IMAGE   = 5,
+    KVB_SECTION_ENTRIES = 6,
+    KVB_SECTION_LOOPS   = 7,
+    KVB_SECTION_PROFILE = 8,
+};
+static constexpr uint32_t KVB_SECTION_COUNT = 8;
+
+enum KvbProfileFlags : int32_t {
+    KVB_PROFILE_HOT      = 1,
+    KVB_PROFILE_REJECTED = 2,  // regiao que o JIT nativo nao aceita
+};
+
+struct KvbHeader {
+    uint32_t magic;
+    uint16_t versionMajor;
+    uint16_t versionMinor;
+    uint32_t sectionCount;
+};
+
+struct KvbSectionEntry {
+    uint32_t kind;
+    uint32_t offset;
+    uint32_t bytes;
+    uint32_t count;
+};
+
+// Inicio de statement: pc (palavra do codigo) e linha do fonte
+struct KvbLine {
+    int32_t pc;
+    int32_t line;
+};
+
+inline void kvbPutVarint(std::vector<uint8_t>& out, int32_t word) {
+    uint32_t v = (static_cast<uint32_t>(word) << 1) ^ static_cast<uint32_t>(word >> 31);
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+inline void kvbPutInstruction(std::vector<uint8_t>& out, int32_t opcode) {
+    if (opcode >= 0 && opcode < 0xFF) {
+        out.push_back(static_cast<uint8_t>(opcode));
+    } else {
+        out.push_back(0xFF);
+        kvbPutVarint(out, opcode);
+    }
+}
+
+// Cursor sobre uma secao; ok fica false ao passar do fim ou num varint longo demais
+struct KvbReader {
+    const uint8_t* pos;
+    const uint8_t* end;
+    bool ok = true;
+
+    int32_t varint() {
+        uint32_t v = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (pos >= end) break;
+            uint8_t b = *pos++;
+            v |= static_cast<uint32_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return static_cast<int32_t>((v >> 1) ^ (0u - (v & 1)));
+        }
+        ok = false;
+        return 0;
+    }
+
+    std::string bytes(size_t n) {
+        if (static_cast<size_t>(end - pos) < n) { ok = false; return std::string(); }
+        std::string s(reinterpret_cast<const char*>(pos), n);
+        pos += n;
+        return s;
+    }
+
+    size_t remaining() const { return static_cast<size_t>(end - pos); }
+
+    // Todo elemento ocupa ao menos um byte: um count maior que o resto da
+    // secao vem de um cabecalho corrompido e nao pode dimensionar alocacoes
+    bool fits(uint32_t count) {
+        if (count > remaining()) ok = false;
+        return ok;
+    }
+
+    // Decodifica count palavras de uma vez (reserva antes: uma unica alocacao)
+    std::vector<int32_t> words(uint32_t count) {
+        std::vector<int32_t> out;
+        if (!fits(count)) return out;
+        out.reserve(count);
+        for (uint32_t i = 0; i < count && ok; i++) out.push_back(varint());
+        return out;
+    }
+
+    std::vector<int32_t> code(uint32_t count) {
+        std::vector<int32_t> out;
+        if (!fits(count)) return out;
+        out.reserve(count);
+        while (out.size() < count && ok) {
+            if (pos >= end) { ok = false; break; }
+            uint8_t b = *pos++;
+            const int32_t opcode = b == 0xFF ? varint() : b;
+            out.push_back(opcode);
+            for (int n = opcodeOperandCount(opcode); n > 0 && out.size() < count; n--) out.push_back(varint());
+        }
+        return out;
+    }
+};
+
+// ============================================================
+// ESCRITA (kavac)
+// ============================================================
+struct KvbSectionData {
+    uint32_t kind;
+    uint32_t count;
+    std::vector<uint8_t> data;
+};
+
+// Cabecalho + tabela + secoes, na ordem dada
+inline std::vector<uint8_t> kvbAssemble(const std::vector<KvbSectionData>& sections) {
+    KvbHeader header{KAVA_BYTECODE_MAGIC, KAVA_VERSION_MAJOR, KAVA_VERSION_MINOR,
+                     static_cast<uint32_t>(sections.size())};
+    std::vector<KvbSectionEntry> entries;
+    uint32_t offset = static_cast<uint32_t>(sizeof(KvbHeader) + sections.size() * sizeof(KvbSectionEntry));
+    for (const KvbSectionData& s : sections) {
+        entries.push_back({s.kind, offset, static_cast<uint32_t>(s.data.size()), s.count});
+        offset += static_cast<uint32_t>(s.data.size());
+    }
+
+    std::vector<uint8_t> out(sizeof(KvbHeader) + entries.size() * sizeof(KvbSectionEntry));
+    std::memcpy(out.data(), &header, sizeof(header));
+    std::memcpy(out.data() + sizeof(header), entries.data(), entries.size() * sizeof(KvbSectionEntry));
+    for (const KvbSectionData& s : sections) out.insert(out.end(), s.data.begin(), s.data.end());
+    return out;
+}
+
+inline KvbSectionData kvbPoolSection(const std::vector<std::string>& strings) {
+    KvbSectionData pool{KVB_SECTION_POOL, static_cast<uint32_t>(strings.size()), {}};
+    kvbPutVarint(pool.data, static_cast<int32_t>(strings.size()));
+    for (const std::string& str : strings) {
+        kvbPutVarint(pool.data, static_cast<int32_t>(str.size()));
+        pool.data.insert(pool.data.end(), str.begin(), str.end());
+    }
+    return pool;
+}
+
+inline KvbSectionData kvbLinesSection(const std::vector<KvbLine>& lines) {
+    KvbSectionData table{KVB_SECTION_LINES, static_cast<uint32_t>(lines.size()), {}};
+    KvbLine prev{0, 0};
+    for (const KvbLine& l : lines) {
+        kvbPutVarint(table.data, l.pc - prev.pc);
+        kvbPutVarint(table.data, l.line - prev.line);
+        prev = l;
+    }
+    return table;
+}
+
+// image e a saida do Codegen: so codigo, ou KAVA_BYTECODE_MAGIC, n, bloco, codigo
+inline std::vector<uint8_t> encodeKvb(const std::vector<int32_t>& image, const std::vector<KvbLine>& lines) {
+    using Section = KvbSectionData;
+    std::vector<Section> sections;
+
+    size_t codeStart = 0;
+    if (image.size() >= 2 && image[0] == static_cast<int32_t>(KAVA_BYTECODE_MAGIC)) {
+        const size_t blockEnd = 2 + static_cast<uint32_t>(image[1]);
+        size_t pos = 2;
+        std::vector<std::string> symbols(static_cast<uint32_t>(image[pos++]));
+        for (std::string& name : symbols) {
+            const int32_t len = image[pos++];
+            name.assign(reinterpret_cast<const char*>(image.data() + pos), len);
+            pos += (len + 3) / 4;
+        }
+        Section program{KVB_SECTION_PROGRAM, static_cast<uint32_t>(blockEnd - pos), {}};
+        for (; pos < blockEnd; pos++) kvbPutVarint(program.data, image[pos]);
+        sections.push_back(kvbPoolSection(symbols));
+        sections.push_back(std::move(program));
+        codeStart = blockEnd;
+    }
+
+    Section code{KVB_SECTION_CODE, static_cast<uint32_t>(image.size() - codeStart), {}};
+    code.data.reserve(code.count * 2);
+    for (size_t i = codeStart; i < image.size();) {
+        const int32_t opcode = image[i++];
+        kvbPutInstruction(code.data, opcode);
+        for (int n = opcodeOperandCount(opcode); n > 0 && i < image.size(); n--) kvbPutVarint(code.data, image[i++]);
+    }
+    sections.push_back(std::move(code));
+
+    sections.push_back(kvbLinesSection(lines));
+    return kvbAssemble(sections);
+}
+
+// ============================================================
+// LEITURA (VM)
+// ============================================================
+// Valida o cabecalho e localiza as secoes; os dados continuam na imagem
+// (mapeada pelo chamador), nada e copiado aqui.
+struct KvbImage {
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+    KvbSectionEntry sections[KVB_SECTION_COUNT] = {};  // indexado por tipo - 1 (bytes = 0: ausente)
+
+    // false: nao e um .kvb em secoes (ou e de outra versao maior)
+    bool parse(const uint8_t* image, size_t size) {
+        KvbHeader header;
+        if (size < sizeof(header)) return false;
+        std::memcpy(&header, image, sizeof(header));
+        if (header.magic != KAVA_BYTECODE_MAGIC || header.versionMajor != KAVA_VERSION_MAJOR ||
+            header.versionMinor > KAVA_VERSION_MINOR) {
+            return false;
+        }
+        if (header.sectionCount > (size - sizeof(header)) / sizeof(KvbSectionEntry)) return false;
+        for (uint32_t i = 0; i < header.sectionCount; i++) {
+            KvbSectionEntry e;
+            std::memcpy(&e, image + sizeof(header) + i * sizeof(e), sizeof(e));
+            if (e.offset > size || e.bytes > size - e.offset) return false;
+            if (e.kind >= 1 && e.kind <= KVB_SECTION_COUNT) sections[e.kind - 1] = e;
+        }
+        data = image;
+        length = size;
+        return true;
+    }
+
+    bool has(KvbSection kind) const { return sections[kind - 1].bytes > 0; }
+    uint32_t count(KvbSection kind) const { return sections[kind - 1].count; }
+
+    KvbReader reader(KvbSection kind) const {
+        const KvbSectionEntry& e = sections[kind - 1];
+        return KvbReader{data + e.offset, data + e.offset + e.bytes};
+    }
+
+    // Secao de int32 crus (IMAGE): copia unica para o vetor de execucao
+    bool rawWords(KvbSection kind, std::vector<int32_t>& out) const {
+        const KvbSectionEntry& e = sections[kind - 1];
+        if (static_cast<size_t>(e.count) * sizeof(int32_t) != e.bytes) return false;
+        out.resize(e.count);
+        if (e.count) std::memcpy(out.data(), data + e.offset, e.bytes);
+        return true;
+    }
+};
+
+} // namespace Kava
+
+#endif // KAVA_KVB_H
@@ -0,0 +1,465 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 KAVA Team
+ *
+ * KAVA 2.5 - Profiler (kavavm --profile)
+ * Amostragem por sinal: um timer de CPU da propria thread da VM dispara
+ * SIGPROF e o handler copia a pilha de frames (metodo + pc de cada nivel)
+ * para buffers pre-alocados, sem alocar nem travar. O interpretador so
+ * publica o pc e conta o opcode quando o perfil esta ligado. Alocacoes por
+ * site e pausas do GC chegam pelos hooks da VM. No fim vira pilhas dobradas
+ * (flamegraph.pl / speedscope), trace JSON do Chrome (chrome://tracing,
+ * Perfetto) e um resumo em texto.
+ */
+
+#ifndef KAVA_PROFILER_H
+#define KAVA_PROFILER_H
+
+#include "bytecode.h"
+#include "jit.h"
+#include "json.h"
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include <fstream>
+#include <ostream>
+#include <iomanip>
+#include <cstdint>
+#include <csignal>
+#include <ctime>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+#define KAVA_PROFILER_SAMPLING 1
+#endif
+
+namespace Kava {
+
+struct MethodInfo;
+struct ClassInfo;
+
+// Um nivel da pilha amostrada, da raiz (nivel superior do script) para a
+// folha. pc e a instrucao em execucao naquele nivel: na folha a atual, nos
+// callers a propria chamada.
+struct ProfileFrame {
+    const MethodInfo* method;   // null = nivel superior
+    const ClassInfo* cls;
+    int32_t pc;
+};
+
+// Nomes para o relatorio, fornecidos pela VM (tabela de linhas, classes)
+struct ProfileSymbols {
+    std::function<std::string(const ProfileFrame&)> function;  // "Classe.metodo" ou "<script>"
+    std::function<int(int32_t pc)> line;                        // 0 = desconhecida
+};
+
+class Profiler {
+public:
+    // O que a VM fazia fora do interpretador quando a amostra caiu
+    enum State : uint8_t { INTERPRETER, GC, NATIVE, COMPILE };
+
+    static constexpr int MAX_DEPTH = 256;            // frames por amostra (os mais internos)
+    static constexpr size_t MAX_SAMPLES = 1 << 16;
+    static constexpr size_t MAX_FRAMES = 1 << 19;
+    static constexpr int OPCODE_SLOTS = 0x220;       // OpCode + SuperOp, como a tabela do threaded
+
+    struct Sample {
+        uint64_t ns;        // desde start()
+        uint32_t first;     // em frameBuffer
+        uint16_t depth;
+        uint8_t state;
+        uint8_t weight;     // periodos que a amostra representa (timer coalescido)
+    };
+
+    struct GCPause {
+        const char* kind;
+        uint64_t startNs;
+        uint64_t durationNs;
+    };
+
+    struct AllocationSite {
+        uint64_t count = 0;
+        uint64_t bytes = 0;
+    };
+
+    // Publicados pelo interpretador (lidos pelo handler na mesma thread)
+    volatile int32_t pc = 0;
+    volatile uint8_t state = INTERPRETER;
+
+    std::vector<uint64_t> opcodeCounts = std::vector<uint64_t>(OPCODE_SLOTS + 1, 0);
+    std::unordered_map<int32_t, AllocationSite> allocations;  // pc -> site
+    std::vector<GCPause> gcPauses;
+
+    ~Profiler() { stop(); }
+
+    void countOpcode(int32_t pcValue, int32_t op) {
+        pc = pcValue;
+        opcodeCounts[(op >= 0 && op < OPCODE_SLOTS) ? op : OPCODE_SLOTS]++;
+    }
+
+    void uncountOpcode(int32_t op) {
+        opcodeCounts[(op >= 0 && op < OPCODE_SLOTS) ? op : OPCODE_SLOTS]--;
+    }
+
+    void recordAllocation(size_t bytes) {
+        AllocationSite& site = allocations[static_cast<int32_t>(pc)];
+        site.count++;
+        site.bytes += bytes;
+    }
+
+    // Chamado logo depois da pausa: o inicio e reconstruido pela duracao
+    void recordGCPause(const char* kind, double ms) {
+        const uint64_t dur = static_cast<uint64_t>(ms * 1e6);
+        const uint64_t now = nowNs();
+        gcPauses.push_back({kind, now > dur ? now - dur : 0, dur});
+    }
+
+    // Walker copia a pilha da VM com reserve(); roda dentro do handler
+    using Walker = void (*)(Profiler& profiler, void* context);
+
+    // Liga o timer de CPU da thread chamadora. false se a plataforma nao tem
+    // timer por thread (os contadores continuam valendo).
+    bool start(int intervalUs, Walker stackWalker, void* context) {
+        stop();
+        samples.assign(MAX_SAMPLES, Sample{0, 0, 0, 0, 1});
+        frameBuffer.assign(MAX_FRAMES, ProfileFrame{nullptr, nullptr, 0});
+        sampleCount = 0;
+        frameCount = 0;
+        dropped = 0;
+        interval = intervalUs > 0 ? intervalUs : 1000;
+        walker = stackWalker;
+        walkerContext = context;
+        startNs = 0;
+        startNs = nowNs();
+#ifdef KAVA_PROFILER_SAMPLING
+        struct sigaction sa {};
+        sa.sa_handler = &Profiler::onSignal;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        if (sigaction(SIGPROF, &sa, &previousAction) != 0) return false;
+
+        struct sigevent sev {};
+        sev.sigev_notify = SIGEV_THREAD_ID;
+        sev.sigev_signo = SIGPROF;
+        sev.sigev_notify_thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+        if (timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &timer) != 0) {
+            sigaction(SIGPROF, &previousAction, nullptr);
+            return false;
+        }
+        active() = this;
+        struct itimerspec spec {};
+        spec.it_interval.tv_sec = interval / 1000000;
+        spec.it_interval.tv_nsec = static_cast<long>(interval % 1000000) * 1000;
+        spec.it_value = spec.it_interval;
+        timer_settime(timer, 0, &spec, nullptr);
+        sampling = true;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // O handler fica instalado: um SIGPROF ainda pendente com a acao
+    // padrao mataria o processo (sem profiler ativo ele nao faz nada)
+    void stop() {
+#ifdef KAVA_PROFILER_SAMPLING
+        if (!sampling) return;
+        timer_delete(timer);
+        active() = nullptr;
+        sampling = false;
+#endif
+    }
+
+    bool isSampling() const { return sampling; }
+    size_t sampleTotal() const { return sampleCount; }
+    uint64_t weightTotal() const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < sampleCount; i++) total += samples[i].weight;
+        return total;
+    }
+    uint64_t droppedSamples() const { return dropped; }
+
+    // Espaco para uma amostra de depth frames (null com os buffers cheios)
+    ProfileFrame* reserve(int depth) {
+        if (sampleCount >= samples.size() || frameCount + depth > frameBuffer.size()) {
+            dropped++;
+            return nullptr;
+        }
+        Sample& s = samples[sampleCount];
+        s.ns = nowNs();
+        s.first = static_cast<uint32_t>(frameCount);
+        s.depth = static_cast<uint16_t>(depth);
+        s.state = state;
+        s.weight = 1;
+#ifdef KAVA_PROFILER_SAMPLING
+        // Relogio de CPU anda no tick do kernel: expiracoes perdidas viram peso
+        const int overrun = timer_getoverrun(timer);
+        if (overrun > 0) s.weight = static_cast<uint8_t>(std::min(overrun + 1, 255));
+#endif
+        frameCount += depth;
+        sampleCount++;
+        return &frameBuffer[s.first];
+    }
+
+    // ========================================
+    // SAIDA
+    // ========================================
+
+    // Uma linha por pilha distinta: "raiz;...;folha contagem"
+    bool writeFolded(const std::string& path, const ProfileSymbols& sym) const {
+        std::map<std::string, uint64_t> stacks;
+        std::string key;
+        for (size_t i = 0; i < sampleCount; i++) {
+            const Sample& s = samples[i];
+            key.clear();
+            for (int d = 0; d < s.depth; d++) {
+                if (d) key += ';';
+                key += frameLabel(frameBuffer[s.first + d], sym);
+            }
+            if (s.state != INTERPRETER) {
+                key += ';';
+                key += stateLabel(s.state);
+            }
+            stacks[key] += s.weight;
+        }
+        std::ofstream out(path);
+        if (!out) return false;
+        for (const auto& [stack, count] : stacks) out << stack << ' ' << count << '\n';
+        return static_cast<bool>(out);
+    }
+
+    // Trace Event Format: as amostras consecutivas viram fatias B/E aninhadas
+    // por funcao na thread do interpretador; as pausas do GC sao eventos X
+    // numa trilha propria
+    bool writeTrace(const std::string& path, const ProfileSymbols& sym) const {
+        JsonWriter w(64 * 1024);
+        w.beginObject().key("traceEvents").beginArray();
+        metadata(w, "process_name", 0, "kavavm");
+        metadata(w, "thread_name", 1, "interpreter");
+        metadata(w, "thread_name", 2, "gc");
+
+        std::vector<std::string> open;
+        std::vector<std::string> next;
+        uint64_t lastNs = 0;
+        for (size_t i = 0; i < sampleCount; i++) {
+            const Sample& s = samples[i];
+            next.clear();
+            for (int d = 0; d < s.depth; d++) next.push_back(sym.function(frameBuffer[s.first + d]));
+            if (s.state != INTERPRETER) next.push_back(stateLabel(s.state));
+            size_t common = 0;
+            while (common < open.size() && common < next.size() && open[common] == next[common]) common++;
+            for (size_t d = open.size(); d > common; d--) event(w, "E", open[d - 1], s.ns);
+            for (size_t d = common; d < next.size(); d++) event(w, "B", next[d], s.ns);
+            open.swap(next);
+            lastNs = s.ns;
+        }
+        for (size_t d = open.size(); d > 0; d--) event(w, "E", open[d - 1], lastNs + interval * 1000ULL);
+
+        for (const GCPause& p : gcPauses) {
+            w.beginObject()
+                .key("name").value(std::string("GC ") + p.kind)
+                .key("cat").value("gc")
+                .key("ph").value("X")
+                .key("pid").value(0)
+                .key("tid").value(2)
+                .key("ts").value(static_cast<double>(p.startNs) / 1000.0)
+                .key("dur").value(static_cast<double>(p.durationNs) / 1000.0)
+                .endObject();
+        }
+        w.endArray().key("displayTimeUnit").value("ms").endObject();
+
+        std::ofstream out(path, std::ios::binary);
+        if (!out) return false;
+        out << w.str();
+        return static_cast<bool>(out);
+    }
+
+    void printSummary(std::ostream& out, const ProfileSymbols& sym, size_t top = 15) const {
+        const uint64_t weight = weightTotal();
+        out << "\n=== KAVA Profile ===" << std::endl;
+        out << "Samples: " << sampleCount << " (" << weight << " x " << interval << "us de CPU";
+        if (dropped) out << ", " << dropped << " descartadas com o buffer cheio";
+        out << ")" << std::endl;
+
+        // Self = amostras na folha; total = amostras com a funcao na pilha
+        std::map<std::string, std::pair<uint64_t, uint64_t>> functions;
+        std::map<std::string, uint64_t> lines;
+        std::vector<std::string> seen;
+        for (size_t i = 0; i < sampleCount; i++) {
+            const Sample& s = samples[i];
+            if (!s.depth) continue;
+            seen.clear();
+            for (int d = 0; d < s.depth; d++) {
+                std::string name = sym.function(frameBuffer[s.first + d]);
+                if (std::find(seen.begin(), seen.end(), name) == seen.end()) {
+                    functions[name].second += s.weight;
+                    seen.push_back(std::move(name));
+                }
+            }
+            const ProfileFrame& leaf = frameBuffer[s.first + s.depth - 1];
+            functions[sym.function(leaf)].first += s.weight;
+            lines[s.state != INTERPRETER ? stateLabel(s.state) : frameLabel(leaf, sym)] += s.weight;
+        }
+        if (sampleCount) {
+            out << "\nFuncoes (self / total):" << std::endl;
+            std::vector<std::pair<std::string, std::pair<uint64_t, uint64_t>>> byFn(functions.begin(), functions.end());
+            std::sort(byFn.begin(), byFn.end(), [](const auto& a, const auto& b) { return a.second.first > b.second.first; });
+            for (size_t i = 0; i < byFn.size() && i < top; i++) {
+                out << "  " << percent(byFn[i].second.first, weight) << "  "
+                    << percent(byFn[i].second.second, weight) << "  " << byFn[i].first << std::endl;
+            }
+            out << "\nLinhas (self):" << std::endl;
+            for (const auto& [label, count] : sortedByCount(lines, top)) {
+                out << "  " << percent(count, weight) << "  " << label << std::endl;
+            }
+        }
+
+        uint64_t instructions = 0;
+        std::map<std::string, uint64_t> opcodes;
+        for (int op = 0; op <= OPCODE_SLOTS; op++) {
+            if (!opcodeCounts[op]) continue;
+            instructions += opcodeCounts[op];
+            opcodes[op < OPCODE_SLOTS ? instructionName(op) : "UNKNOWN"] += opcodeCounts[op];
+        }
+        if (instructions) {
+            out << "\nOpcodes (" << instructions << " instrucoes):" << std::endl;
+            for (const auto& [name, count] : sortedByCount(opcodes, top)) {
+                out << "  " << percent(count, instructions) << "  " << std::setw(12) << count << "  " << name << std::endl;
+            }
+        }
+
+        if (!allocations.empty()) {
+            std::map<std::string, AllocationSite> sites;
+            uint64_t total = 0;
+            for (const auto& [sitePc, site] : allocations) {
+                const int line = sym.line(sitePc);
+                AllocationSite& s = sites[line > 0 ? "linha " + std::to_string(line) : "pc " + std::to_string(sitePc)];
+                s.count += site.count;
+                s.bytes += site.bytes;
+                total += site.count;
+            }
+            std::vector<std::pair<std::string, AllocationSite>> bySite(sites.begin(), sites.end());
+            std::sort(bySite.begin(), bySite.end(), [](const auto& a, const auto& b) { return a.second.count > b.second.count; });
+            out << "\nAlocacoes (" << total << " objetos):" << std::endl;
+            for (size_t i = 0; i < bySite.size() && i < top; i++) {
+                out << "  " << percent(bySite[i].second.count, total) << "  " << std::setw(10) << bySite[i].second.count
+                    << " objs  " << std::setw(12) << bySite[i].second.bytes << " bytes  " << bySite[i].first << std::endl;
+            }
+        }
+
+        if (!gcPauses.empty()) {
+            double totalMs = 0, maxMs = 0;
+            std::map<std::string, uint64_t> kinds;
+            for (const GCPause& p : gcPauses) {
+                const double ms = static_cast<double>(p.durationNs) / 1e6;
+                totalMs += ms;
+                maxMs = std::max(maxMs, ms);
+                kinds[p.kind]++;
+            }
+            out << "\nPausas do GC: " << gcPauses.size() << " (";
+            bool first = true;
+            for (const auto& [kind, count] : kinds) {
+                out << (first ? "" : ", ") << count << " " << kind;
+                first = false;
+            }
+            out << "), total " << std::fixed << std::setprecision(3) << totalMs << " ms, max " << maxMs << " ms"
+                << std::defaultfloat << std::endl;
+        }
+    }
+
+private:
+    std::vector<Sample> samples;
+    std::vector<ProfileFrame> frameBuffer;
+    volatile size_t sampleCount = 0;
+    volatile size_t frameCount = 0;
+    volatile uint64_t dropped = 0;
+    int interval = 1000;
+    uint64_t startNs = 0;
+    Walker walker = nullptr;
+    void* walkerContext = nullptr;
+    bool sampling = false;
+#ifdef KAVA_PROFILER_SAMPLING
+    timer_t timer{};
+    struct sigaction previousAction {};
+#endif
+
+    // Um profiler ativo por processo (o sinal nao carrega contexto)
+    static Profiler*& active() {
+        static Profiler* current = nullptr;
+        return current;
+    }
+
+    static void onSignal(int) {
+        Profiler* p = active();
+        if (p && p->walker) p->walker(*p, p->walkerContext);
+    }
+
+    // clock_gettime e async-signal-safe
+    uint64_t nowNs() const {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        const uint64_t ns = static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+        return ns - startNs;
+    }
+
+    static const char* stateLabel(uint8_t s) {
+        switch (s) {
+            case GC: return "[gc]";
+            case NATIVE: return "[native]";
+            case COMPILE: return "[jit-compile]";
+            default: return "[interpreter]";
+        }
+    }
+
+    static std::string frameLabel(const ProfileFrame& f, const ProfileSymbols& sym) {
+        std::string label = sym.function(f);
+        const int line = sym.line(f.pc);
+        if (line > 0) label += ":" + std::to_string(line);
+        return label;
+    }
+
+    static std::string percent(uint64_t part, uint64_t total) {
+        char buf[16];
+        std::snprintf(buf, sizeof(buf), "%6.2f%%", total ? 100.0 * static_cast<double>(part) / static_cast<double>(total) : 0.0);
+        return buf;
+    }
+
+    template <typename Map>
+    static std::vector<std::pair<std::string, uint64_t>> sortedByCount(const Map& m, size_t top) {
+        std::vector<std::pair<std::string, uint64_t>> v(m.begin(), m.end());
+        std::sort(v.begin(), v.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+        if (v.size() > top) v.resize(top);
+        return v;
+    }
+
+    static void metadata(JsonWriter& w, const char* name, int tid, const char* value) {
+        w.beginObject()
+            .key("name").value(name)
+            .key("ph").value("M")
+            .key("pid").value(0)
+            .key("tid").value(tid)
+            .key("args").beginObject().key("name").value(value).endObject()
+            .endObject();
+    }
+
+    static void event(JsonWriter& w, const char* ph, const std::string& name, uint64_t ns) {
+        w.beginObject()
+            .key("name").value(name)
+            .key("ph").value(ph)
+            .key("pid").value(0)
+            .key("tid").value(1)
+            .key("ts").value(static_cast<double>(ns) / 1000.0)
+            .endObject();
+    }
+};
+
+} // namespace Kava
+
+#endif // KAVA_PROFILER_H
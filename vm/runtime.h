@@ -7,6 +7,8 @@
 #define KAVA_RUNTIME_H
 
 #include "async.h"
+#include "json.h"
+#include "files.h"
 #include <string>
 #include <vector>
 #include <map>
@@ -16,7 +18,6 @@
 #include <thread>
 #include <mutex>
 #include <atomic>
-#include <fstream>
 #include <chrono>
 #include <cstdio>
 #include <sys/socket.h>
@@ -25,189 +26,18 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <poll.h>
+#include <string_view>
+#include <memory>
+#include <cerrno>
+#include <strings.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+#include <sys/sendfile.h>
+#include <random>
 
 namespace Kava {
 
-// ============================================================
-// JSON PARSER/SERIALIZER (Fast, simple)
-// ============================================================
-class JSON {
-public:
-    enum class Type { Null, Bool, Int, Double, String, Array, Object };
-    
-    Type type = Type::Null;
-    bool boolVal = false;
-    int64_t intVal = 0;
-    double doubleVal = 0;
-    std::string strVal;
-    std::vector<JSON> arrayVal;
-    std::map<std::string, JSON> objectVal;
-    
-    JSON() : type(Type::Null) {}
-    JSON(bool v) : type(Type::Bool), boolVal(v) {}
-    JSON(int v) : type(Type::Int), intVal(v) {}
-    JSON(int64_t v) : type(Type::Int), intVal(v) {}
-    JSON(double v) : type(Type::Double), doubleVal(v) {}
-    JSON(const std::string& v) : type(Type::String), strVal(v) {}
-    JSON(const char* v) : type(Type::String), strVal(v) {}
-    
-    static JSON object() { JSON j; j.type = Type::Object; return j; }
-    static JSON array() { JSON j; j.type = Type::Array; return j; }
-    static JSON null() { return JSON(); }
-    
-    JSON& operator[](const std::string& key) {
-        if (type != Type::Object) type = Type::Object;
-        return objectVal[key];
-    }
-    
-    void push(const JSON& val) {
-        if (type != Type::Array) type = Type::Array;
-        arrayVal.push_back(val);
-    }
-    
-    std::string stringify() const {
-        std::ostringstream ss;
-        writeJSON(ss);
-        return ss.str();
-    }
-    
-    static JSON parse(const std::string& input) {
-        size_t pos = 0;
-        return parseValue(input, pos);
-    }
-
-private:
-    void writeJSON(std::ostringstream& ss) const {
-        switch (type) {
-            case Type::Null: ss << "null"; break;
-            case Type::Bool: ss << (boolVal ? "true" : "false"); break;
-            case Type::Int: ss << intVal; break;
-            case Type::Double: ss << doubleVal; break;
-            case Type::String: 
-                ss << '"';
-                for (char c : strVal) {
-                    if (c == '"') ss << "\\\"";
-                    else if (c == '\\') ss << "\\\\";
-                    else if (c == '\n') ss << "\\n";
-                    else if (c == '\t') ss << "\\t";
-                    else ss << c;
-                }
-                ss << '"';
-                break;
-            case Type::Array:
-                ss << '[';
-                for (size_t i = 0; i < arrayVal.size(); i++) {
-                    if (i > 0) ss << ',';
-                    arrayVal[i].writeJSON(ss);
-                }
-                ss << ']';
-                break;
-            case Type::Object:
-                ss << '{';
-                { bool first = true;
-                  for (auto& [k, v] : objectVal) {
-                      if (!first) ss << ',';
-                      first = false;
-                      ss << '"' << k << "\":";
-                      v.writeJSON(ss);
-                  }
-                }
-                ss << '}';
-                break;
-        }
-    }
-    
-    static void skipWhitespace(const std::string& s, size_t& pos) {
-        while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\n' || s[pos] == '\r' || s[pos] == '\t'))
-            pos++;
-    }
-    
-    static JSON parseValue(const std::string& s, size_t& pos) {
-        skipWhitespace(s, pos);
-        if (pos >= s.size()) return JSON();
-        
-        char c = s[pos];
-        if (c == '"') return parseString(s, pos);
-        if (c == '{') return parseObject(s, pos);
-        if (c == '[') return parseArray(s, pos);
-        if (c == 't') { pos += 4; return JSON(true); }
-        if (c == 'f') { pos += 5; return JSON(false); }
-        if (c == 'n') { pos += 4; return JSON(); }
-        return parseNumber(s, pos);
-    }
-    
-    static JSON parseString(const std::string& s, size_t& pos) {
-        pos++; // skip opening "
-        std::string result;
-        while (pos < s.size() && s[pos] != '"') {
-            if (s[pos] == '\\' && pos + 1 < s.size()) {
-                pos++;
-                switch (s[pos]) {
-                    case '"': result += '"'; break;
-                    case '\\': result += '\\'; break;
-                    case 'n': result += '\n'; break;
-                    case 't': result += '\t'; break;
-                    default: result += s[pos]; break;
-                }
-            } else {
-                result += s[pos];
-            }
-            pos++;
-        }
-        if (pos < s.size()) pos++; // skip closing "
-        return JSON(result);
-    }
-    
-    static JSON parseNumber(const std::string& s, size_t& pos) {
-        size_t start = pos;
-        bool isDouble = false;
-        if (s[pos] == '-') pos++;
-        while (pos < s.size() && s[pos] >= '0' && s[pos] <= '9') pos++;
-        if (pos < s.size() && s[pos] == '.') { isDouble = true; pos++; }
-        while (pos < s.size() && s[pos] >= '0' && s[pos] <= '9') pos++;
-        
-        std::string num = s.substr(start, pos - start);
-        if (isDouble) return JSON(std::stod(num));
-        return JSON(std::stoll(num));
-    }
-    
-    static JSON parseArray(const std::string& s, size_t& pos) {
-        JSON arr = JSON::array();
-        pos++; // skip [
-        skipWhitespace(s, pos);
-        if (pos < s.size() && s[pos] == ']') { pos++; return arr; }
-        
-        while (pos < s.size()) {
-            arr.push(parseValue(s, pos));
-            skipWhitespace(s, pos);
-            if (pos < s.size() && s[pos] == ',') pos++;
-            else break;
-        }
-        if (pos < s.size() && s[pos] == ']') pos++;
-        return arr;
-    }
-    
-    static JSON parseObject(const std::string& s, size_t& pos) {
-        JSON obj = JSON::object();
-        pos++; // skip {
-        skipWhitespace(s, pos);
-        if (pos < s.size() && s[pos] == '}') { pos++; return obj; }
-        
-        while (pos < s.size()) {
-            skipWhitespace(s, pos);
-            JSON key = parseString(s, pos);
-            skipWhitespace(s, pos);
-            if (pos < s.size() && s[pos] == ':') pos++;
-            obj[key.strVal] = parseValue(s, pos);
-            skipWhitespace(s, pos);
-            if (pos < s.size() && s[pos] == ',') pos++;
-            else break;
-        }
-        if (pos < s.size() && s[pos] == '}') pos++;
-        return obj;
-    }
-};
-
 // ============================================================
 // HTTP REQUEST/RESPONSE
 // ============================================================
@@ -218,53 +48,97 @@ struct HttpRequest {
     std::map<std::string, std::string> headers;
     std::string body;
     std::map<std::string, std::string> queryParams;
+    std::map<std::string, std::string> params;   // segmentos ":nome" da rota
     
-    static HttpRequest parse(const std::string& raw) {
-        HttpRequest req;
-        std::istringstream stream(raw);
-        std::string line;
+    static constexpr size_t MAX_HEAD = 64 * 1024;
+    static constexpr size_t MAX_BODY = 8 * 1024 * 1024;
+    static constexpr size_t INCOMPLETE = 0;
+    static constexpr size_t MALFORMED = static_cast<size_t>(-1);
+    
+    // Cabecalho sem diferenciar maiusculas (HTTP); "" se ausente
+    const std::string& header(const std::string& name) const {
+        static const std::string empty;
+        for (auto& [k, v] : headers) {
+            if (k.size() == name.size() && strncasecmp(k.c_str(), name.c_str(), k.size()) == 0) return v;
+        }
+        return empty;
+    }
+    
+    // HTTP/1.1 mantem a conexao salvo "close"; HTTP/1.0 so com "keep-alive"
+    bool keepAlive() const {
+        const std::string& conn = header("Connection");
+        if (version == "HTTP/1.0") return strcasecmp(conn.c_str(), "keep-alive") == 0;
+        return strcasecmp(conn.c_str(), "close") != 0;
+    }
+    
+    // Parse incremental: consome uma requisicao do inicio de data e devolve
+    // quantos bytes usou, INCOMPLETE se ainda faltam bytes ou MALFORMED.
+    // Os campos de req sao reaproveitados (strings mantem a capacidade).
+    static size_t parseFrom(std::string_view data, HttpRequest& req) {
+        size_t headEnd = data.find("\r\n\r\n");
+        if (headEnd == std::string_view::npos) return data.size() > MAX_HEAD ? MALFORMED : INCOMPLETE;
+        std::string_view head = data.substr(0, headEnd);
+        
+        req.headers.clear();
+        req.queryParams.clear();
+        req.params.clear();
+        req.body.clear();
         
         // Request line
-        if (std::getline(stream, line)) {
-            std::istringstream reqLine(line);
-            reqLine >> req.method >> req.path >> req.version;
-            
-            // Parse query params
-            auto qpos = req.path.find('?');
-            if (qpos != std::string::npos) {
-                std::string query = req.path.substr(qpos + 1);
-                req.path = req.path.substr(0, qpos);
-                // Simple query parse
-                std::istringstream qs(query);
-                std::string pair;
-                while (std::getline(qs, pair, '&')) {
-                    auto eq = pair.find('=');
-                    if (eq != std::string::npos) {
-                        req.queryParams[pair.substr(0, eq)] = pair.substr(eq + 1);
-                    }
+        size_t lineEnd = head.find("\r\n");
+        std::string_view line = head.substr(0, lineEnd);
+        size_t sp1 = line.find(' ');
+        size_t sp2 = sp1 == std::string_view::npos ? sp1 : line.find(' ', sp1 + 1);
+        if (sp2 == std::string_view::npos) return MALFORMED;
+        req.method.assign(line.substr(0, sp1));
+        std::string_view target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+        req.version.assign(line.substr(sp2 + 1));
+        
+        auto qpos = target.find('?');
+        req.path.assign(target.substr(0, qpos));
+        if (qpos != std::string_view::npos) {
+            std::string_view query = target.substr(qpos + 1);
+            while (!query.empty()) {
+                size_t amp = query.find('&');
+                std::string_view pair = query.substr(0, amp);
+                auto eq = pair.find('=');
+                if (eq != std::string_view::npos) {
+                    req.queryParams[std::string(pair.substr(0, eq))] = std::string(pair.substr(eq + 1));
                 }
+                query = amp == std::string_view::npos ? std::string_view() : query.substr(amp + 1);
             }
         }
         
         // Headers
-        while (std::getline(stream, line) && line != "\r" && !line.empty()) {
-            if (line.back() == '\r') line.pop_back();
+        while (lineEnd != std::string_view::npos) {
+            size_t next = head.find("\r\n", lineEnd + 2);
+            line = head.substr(lineEnd + 2, next == std::string_view::npos ? std::string_view::npos : next - lineEnd - 2);
+            lineEnd = next;
             auto colon = line.find(':');
-            if (colon != std::string::npos) {
-                std::string key = line.substr(0, colon);
-                std::string val = line.substr(colon + 1);
-                while (!val.empty() && val[0] == ' ') val.erase(0, 1);
-                req.headers[key] = val;
-            }
+            if (colon == std::string_view::npos) continue;
+            std::string_view val = line.substr(colon + 1);
+            while (!val.empty() && val.front() == ' ') val.remove_prefix(1);
+            req.headers[std::string(line.substr(0, colon))] = std::string(val);
         }
         
-        // Body
-        std::string bodyData;
-        while (std::getline(stream, line)) {
-            bodyData += line + "\n";
+        // Body (Content-Length; sem chunked)
+        size_t bodyLen = 0;
+        const std::string& cl = req.header("Content-Length");
+        if (!cl.empty()) {
+            char* end = nullptr;
+            unsigned long long n = strtoull(cl.c_str(), &end, 10);
+            if (*end != '\0' || n > MAX_BODY) return MALFORMED;
+            bodyLen = static_cast<size_t>(n);
         }
-        if (!bodyData.empty()) req.body = bodyData;
-        
+        size_t total = headEnd + 4 + bodyLen;
+        if (data.size() < total) return INCOMPLETE;
+        req.body.assign(data.substr(headEnd + 4, bodyLen));
+        return total;
+    }
+    
+    static HttpRequest parse(const std::string& raw) {
+        HttpRequest req;
+        parseFrom(raw, req);
         return req;
     }
 };
@@ -274,11 +148,11 @@ struct HttpResponse {
     std::string statusText = "OK";
     std::map<std::string, std::string> headers;
     std::string body;
+    std::shared_ptr<const OpenFile> bodyFile;  // file(): corpo enviado com sendfile
     
     HttpResponse() {
         headers["Content-Type"] = "text/plain";
         headers["Server"] = "KAVA/2.5";
-        headers["Connection"] = "close";
     }
     
     HttpResponse& status(int code, const std::string& text = "") {
@@ -287,9 +161,16 @@ struct HttpResponse {
         return *this;
     }
     
-    HttpResponse& json(const JSON& data) {
+    HttpResponse& json(const JsonValue& data) {
+        JsonWriter w;
+        w.value(data);
+        return json(w);
+    }
+    
+    // Corpo montado direto no buffer do writer, sem copia
+    HttpResponse& json(JsonWriter& writer) {
         headers["Content-Type"] = "application/json";
-        body = data.stringify();
+        body = writer.take();
         return *this;
     }
     
@@ -305,16 +186,55 @@ struct HttpResponse {
         return *this;
     }
     
-    std::string serialize() const {
-        std::ostringstream ss;
-        ss << "HTTP/1.1 " << statusCode << " " << statusText << "\r\n";
+    // Corpo direto do arquivo: o reator o envia com sendfile (page cache ->
+    // socket, sem passar pela memoria do processo). 404 se nao abrir.
+    HttpResponse& file(const std::string& path, const std::string& contentType = "application/octet-stream") {
+        auto f = std::make_shared<OpenFile>(path);
+        if (!f->isOpen()) return status(404).text("Not Found");
+        headers["Content-Type"] = contentType;
+        body.clear();
+        bodyFile = std::move(f);
+        return *this;
+    }
+    
+    size_t contentLength() const { return bodyFile ? bodyFile->size() : body.size(); }
+    
+    // Status line + headers; o corpo vai num iovec separado (writev)
+    void serializeHead(std::string& out) const {
+        out += "HTTP/1.1 ";
+        out += std::to_string(statusCode);
+        out += ' ';
+        out += statusText;
+        out += "\r\n";
         for (auto& [k, v] : headers) {
-            ss << k << ": " << v << "\r\n";
+            out += k;
+            out += ": ";
+            out += v;
+            out += "\r\n";
         }
-        ss << "Content-Length: " << body.size() << "\r\n";
-        ss << "\r\n";
-        ss << body;
-        return ss.str();
+        out += "Content-Length: ";
+        out += std::to_string(contentLength());
+        out += "\r\n\r\n";
+    }
+    
+    std::string serialize() const {
+        std::string out;
+        serializeHead(out);
+        if (bodyFile) {
+            size_t at = out.size();
+            out.resize(at + bodyFile->size());
+            size_t got = 0;
+            while (got < bodyFile->size()) {
+                ssize_t r = pread(bodyFile->fd(), &out[at + got], bodyFile->size() - got, static_cast<off_t>(got));
+                if (r < 0 && errno == EINTR) continue;
+                if (r <= 0) break;
+                got += static_cast<size_t>(r);
+            }
+            out.resize(at + got);
+        } else {
+            out += body;
+        }
+        return out;
     }
     
     static std::string getStatusText(int code) {
@@ -345,132 +265,412 @@ struct Route {
     RouteHandler handler;
 };
 
+// ============================================================
+// HTTP ROUTER (radix tree)
+// ============================================================
+// Arvore de prefixos comprimida sobre os caminhos. "/api/*" registra um
+// curinga no no do prefixo "/api/" e "*" na raiz; "/users/:id" casa um
+// segmento qualquer e o guarda em params["id"]. A busca desce pelo caminho
+// preferindo o trecho literal ao parametro: rota exata ganha, senao o
+// curinga mais longo.
+class HttpRouter {
+public:
+    using Params = std::map<std::string, std::string>;
+    
+    void add(const std::string& method, const std::string& pattern, RouteHandler handler) {
+        bool wildcard = !pattern.empty() && pattern.back() == '*';
+        std::string_view path(pattern);
+        if (wildcard) path.remove_suffix(1);
+        Node* n = &root;
+        size_t colon;
+        while ((colon = path.find(':')) != std::string_view::npos) {
+            n = insert(n, path.substr(0, colon));
+            size_t end = path.find('/', colon);
+            std::string_view name = path.substr(colon + 1, end == std::string_view::npos ? std::string_view::npos : end - colon - 1);
+            if (!n->param) {
+                n->param = std::make_unique<Node>();
+                n->paramName = std::string(name);
+            }
+            n = n->param.get();
+            path = end == std::string_view::npos ? std::string_view() : path.substr(end);
+        }
+        n = insert(n, path);
+        (wildcard ? n->wildcard : n->exact)[method] = std::move(handler);
+    }
+    
+    // params (opcional) recebe os segmentos ":nome" da rota encontrada
+    const RouteHandler* find(const std::string& method, std::string_view path, Params* params = nullptr) const {
+        std::vector<std::pair<const std::string*, std::string_view>> captures;
+        const RouteHandler* h = match(&root, method, path, captures);
+        if (h && params) {
+            for (auto& [name, value] : captures) (*params)[*name] = std::string(value);
+        }
+        return h;
+    }
+
+private:
+    struct Node {
+        std::string prefix;
+        std::vector<std::unique_ptr<Node>> children;
+        std::unique_ptr<Node> param;   // filho ":nome": consome ate a proxima '/'
+        std::string paramName;
+        std::map<std::string, RouteHandler> exact;
+        std::map<std::string, RouteHandler> wildcard;
+    };
+    Node root;
+    
+    static const RouteHandler* handlerFor(const std::map<std::string, RouteHandler>& handlers, const std::string& method) {
+        auto it = handlers.find(method);
+        return it != handlers.end() ? &it->second : nullptr;
+    }
+    
+    // So volta atras quando um trecho literal casa mas nao leva a rota alguma
+    static const RouteHandler* match(const Node* n, const std::string& method, std::string_view path,
+                                     std::vector<std::pair<const std::string*, std::string_view>>& captures) {
+        if (path.empty()) {
+            if (auto h = handlerFor(n->exact, method)) return h;
+            return handlerFor(n->wildcard, method);
+        }
+        for (auto& child : n->children) {
+            if (child->prefix[0] != path[0]) continue;
+            if (path.compare(0, child->prefix.size(), child->prefix) == 0) {
+                if (auto h = match(child.get(), method, path.substr(child->prefix.size()), captures)) return h;
+            }
+            break;
+        }
+        if (n->param) {
+            size_t end = std::min(path.find('/'), path.size());
+            if (end > 0) {
+                captures.emplace_back(&n->paramName, path.substr(0, end));
+                if (auto h = match(n->param.get(), method, path.substr(end), captures)) return h;
+                captures.pop_back();
+            }
+        }
+        return handlerFor(n->wildcard, method);
+    }
+    
+    static Node* insert(Node* n, std::string_view path) {
+        while (!path.empty()) {
+            Node* child = nullptr;
+            for (auto& c : n->children) {
+                if (c->prefix[0] == path[0]) { child = c.get(); break; }
+            }
+            if (!child) {
+                n->children.push_back(std::make_unique<Node>());
+                n->children.back()->prefix = std::string(path);
+                return n->children.back().get();
+            }
+            size_t common = 0;
+            while (common < child->prefix.size() && common < path.size() && child->prefix[common] == path[common]) common++;
+            if (common < child->prefix.size()) {
+                // Divide o no: o prefixo comum vira pai do resto
+                auto rest = std::make_unique<Node>();
+                rest->prefix = child->prefix.substr(common);
+                rest->children = std::move(child->children);
+                rest->param = std::move(child->param);
+                rest->paramName = std::move(child->paramName);
+                rest->exact = std::move(child->exact);
+                rest->wildcard = std::move(child->wildcard);
+                child->prefix.resize(common);
+                child->children.clear();
+                child->paramName.clear();
+                child->exact.clear();
+                child->wildcard.clear();
+                child->children.push_back(std::move(rest));
+            }
+            path.remove_prefix(common);
+            n = child;
+        }
+        return n;
+    }
+};
+
 // ============================================================
 // HTTP SERVER (Nativo)
 // ============================================================
+// Um reator epoll edge-triggered por thread, cada um com o seu socket de
+// escuta (SO_REUSEPORT: o kernel distribui as conexoes). Conexoes HTTP/1.1
+// ficam abertas (keep-alive); requisicoes em pipeline sao lidas de um
+// buffer reaproveitado e as respostas saem juntas num writev. Handlers
+// rodam nas threads do servidor: registre rotas antes de serve().
 class HttpServer {
 public:
     int port;
+    int threads;
     std::vector<Route> routes;
     std::atomic<bool> running{false};
     int serverFd = -1;
     
-    HttpServer(int p = 8080) : port(p) {}
+    HttpServer(int p = 8080, int t = 0)
+        : port(p), threads(t > 0 ? t : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))) {}
     
-    ~HttpServer() { stop(); }
+    ~HttpServer() {
+        stop();
+        while (serving) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        closeListeners();
+    }
+    
+    void get(const std::string& path, RouteHandler handler) { addRoute("GET", path, std::move(handler)); }
+    void post(const std::string& path, RouteHandler handler) { addRoute("POST", path, std::move(handler)); }
+    void put(const std::string& path, RouteHandler handler) { addRoute("PUT", path, std::move(handler)); }
+    void del(const std::string& path, RouteHandler handler) { addRoute("DELETE", path, std::move(handler)); }
     
-    void get(const std::string& path, RouteHandler handler) {
-        routes.push_back({"GET", path, handler});
+    bool listen() {
+        for (int i = 0; i < threads; i++) {
+            int fd = openListener();
+            if (fd < 0) {
+                closeListeners();
+                return false;
+            }
+            listenFds.push_back(fd);
+        }
+        serverFd = listenFds[0];
+        running = true;
+        return true;
     }
     
-    void post(const std::string& path, RouteHandler handler) {
-        routes.push_back({"POST", path, handler});
+    // Bloqueia ate stop(): a thread chamadora e um dos reatores
+    void serve() {
+        serving = true;
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < listenFds.size(); i++) {
+            workers.emplace_back([this, fd = listenFds[i]] { reactor(fd); });
+        }
+        if (!listenFds.empty()) reactor(listenFds[0]);
+        for (auto& t : workers) t.join();
+        closeListeners();
+        serving = false;
     }
     
-    void put(const std::string& path, RouteHandler handler) {
-        routes.push_back({"PUT", path, handler});
+    void serveAsync(EventLoop& loop) {
+        loop.queueIO([this]() {
+            serve();
+        });
     }
     
-    void del(const std::string& path, RouteHandler handler) {
-        routes.push_back({"DELETE", path, handler});
+    // Os reatores percebem em ate 100ms e fecham os sockets ao sair
+    void stop() {
+        running = false;
     }
+
+private:
+    HttpRouter router;
+    std::vector<int> listenFds;
+    std::atomic<bool> serving{false};
     
-    bool listen() {
-        serverFd = socket(AF_INET, SOCK_STREAM, 0);
-        if (serverFd < 0) return false;
+    static constexpr size_t READ_CHUNK = 16 * 1024;
+    static constexpr int MAX_EVENTS = 256;
+    
+    // Trecho de saida: bytes em memoria ou um arquivo inteiro (sendfile)
+    struct Outgoing {
+        std::string data;
+        std::shared_ptr<const OpenFile> file;
+        
+        size_t size() const { return file ? file->size() : data.size(); }
+    };
+    
+    struct Connection {
+        int fd;
+        std::string in;                 // bytes recebidos ainda nao consumidos
+        std::vector<Outgoing> out;      // heads e corpos pendentes, na ordem
+        size_t outOffset = 0;           // bytes ja enviados de out[0]
+        bool closeAfterFlush = false;
+        bool wantWrite = false;
+        HttpRequest req;                // reaproveitado entre requisicoes
+    };
+    
+    void addRoute(const char* method, const std::string& path, RouteHandler handler) {
+        routes.push_back({method, path, handler});
+        router.add(method, path, std::move(handler));
+    }
+    
+    int openListener() {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
         
         int opt = 1;
-        setsockopt(serverFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt));
         
         struct sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
         addr.sin_family = AF_INET;
         addr.sin_addr.s_addr = INADDR_ANY;
         addr.sin_port = htons(port);
         
-        if (bind(serverFd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-            close(serverFd);
-            return false;
+        if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(fd, SOMAXCONN) < 0) {
+            close(fd);
+            return -1;
         }
+        return fd;
+    }
+    
+    void closeListeners() {
+        for (int fd : listenFds) close(fd);
+        listenFds.clear();
+        serverFd = -1;
+    }
+    
+    void reactor(int listenFd) {
+        int ep = epoll_create1(EPOLL_CLOEXEC);
+        if (ep < 0) return;
         
-        if (::listen(serverFd, 128) < 0) {
-            close(serverFd);
-            return false;
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.ptr = nullptr;  // nullptr = socket de escuta
+        epoll_ctl(ep, EPOLL_CTL_ADD, listenFd, &ev);
+        
+        std::map<int, std::unique_ptr<Connection>> conns;
+        struct epoll_event events[MAX_EVENTS];
+        
+        while (running) {
+            int n = epoll_wait(ep, events, MAX_EVENTS, 100);
+            for (int i = 0; i < n; i++) {
+                if (!events[i].data.ptr) {
+                    acceptAll(ep, listenFd, conns);
+                    continue;
+                }
+                Connection* c = static_cast<Connection*>(events[i].data.ptr);
+                bool alive = !(events[i].events & (EPOLLERR | EPOLLHUP));
+                if (alive && (events[i].events & EPOLLIN)) alive = readAll(*c);
+                if (alive) alive = flush(ep, *c);
+                if (!alive) {
+                    close(c->fd);  // close tambem remove do epoll
+                    conns.erase(c->fd);
+                }
+            }
         }
         
-        running = true;
-        return true;
+        for (auto& [fd, c] : conns) close(fd);
+        close(ep);
     }
     
-    void serve() {
-        while (running) {
-            struct pollfd pfd;
-            pfd.fd = serverFd;
-            pfd.events = POLLIN;
-            
-            int ret = poll(&pfd, 1, 100);  // 100ms timeout
-            if (ret <= 0) continue;
+    void acceptAll(int ep, int listenFd, std::map<int, std::unique_ptr<Connection>>& conns) {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;  // EAGAIN: fila vazia (edge-triggered)
             
-            struct sockaddr_in clientAddr;
-            socklen_t clientLen = sizeof(clientAddr);
-            int clientFd = accept(serverFd, (struct sockaddr*)&clientAddr, &clientLen);
-            if (clientFd < 0) continue;
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
             
-            handleConnection(clientFd);
+            auto c = std::make_unique<Connection>();
+            c->fd = fd;
+            c->in.reserve(READ_CHUNK);
+            struct epoll_event ev;
+            ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+            ev.data.ptr = c.get();
+            if (epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev) < 0) {
+                close(fd);
+                continue;
+            }
+            conns[fd] = std::move(c);
         }
     }
     
-    void serveAsync(EventLoop& loop) {
-        loop.queueIO([this]() {
-            serve();
-        });
-    }
-    
-    void stop() {
-        running = false;
-        if (serverFd >= 0) {
-            close(serverFd);
-            serverFd = -1;
-        }
-    }
-
-private:
-    void handleConnection(int clientFd) {
-        char buffer[8192];
-        ssize_t bytesRead = read(clientFd, buffer, sizeof(buffer) - 1);
-        if (bytesRead <= 0) {
-            close(clientFd);
-            return;
+    // Le ate EAGAIN e atende toda requisicao completa no buffer (pipelining)
+    bool readAll(Connection& c) {
+        bool peerClosed = false;
+        while (true) {
+            size_t old = c.in.size();
+            c.in.resize(old + READ_CHUNK);
+            ssize_t r = read(c.fd, &c.in[old], READ_CHUNK);
+            c.in.resize(old + (r > 0 ? r : 0));
+            if (c.in.size() > HttpRequest::MAX_HEAD + HttpRequest::MAX_BODY) return false;
+            if (r > 0) continue;
+            if (r == 0) peerClosed = true;
+            else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return false;
+            if (r < 0 && errno == EINTR) continue;
+            break;
         }
-        buffer[bytesRead] = '\0';
-        
-        HttpRequest req = HttpRequest::parse(std::string(buffer, bytesRead));
-        HttpResponse resp = route(req);
         
-        std::string response = resp.serialize();
-        write(clientFd, response.c_str(), response.size());
-        close(clientFd);
-    }
-    
-    HttpResponse route(const HttpRequest& req) {
-        for (auto& r : routes) {
-            if (r.method == req.method && matchPath(r.path, req.path)) {
-                return r.handler(req);
+        size_t consumed = 0;
+        while (!c.closeAfterFlush) {
+            size_t used = HttpRequest::parseFrom(std::string_view(c.in).substr(consumed), c.req);
+            if (used == HttpRequest::INCOMPLETE) break;
+            if (used == HttpRequest::MALFORMED) {
+                HttpResponse resp;
+                resp.status(400).text("Bad Request");
+                queue(c, resp, false);
+                break;
             }
+            consumed += used;
+            queue(c, dispatch(c.req), c.req.keepAlive());
         }
+        c.in.erase(0, consumed);
         
+        if (peerClosed && c.out.empty()) return false;
+        if (peerClosed) c.closeAfterFlush = true;
+        return true;
+    }
+    
+    HttpResponse dispatch(HttpRequest& req) {
+        if (const RouteHandler* h = router.find(req.method, req.path, &req.params)) return (*h)(req);
         HttpResponse resp;
         resp.status(404).text("Not Found: " + req.path);
         return resp;
     }
     
-    bool matchPath(const std::string& pattern, const std::string& path) {
-        if (pattern == path) return true;
-        if (pattern == "*") return true;
-        // Simple wildcard: /api/* matches /api/anything
-        if (pattern.back() == '*') {
-            return path.substr(0, pattern.size() - 1) == pattern.substr(0, pattern.size() - 1);
+    void queue(Connection& c, HttpResponse resp, bool keepAlive) {
+        resp.headers["Connection"] = keepAlive ? "keep-alive" : "close";
+        std::string head;
+        resp.serializeHead(head);
+        c.out.push_back({std::move(head), nullptr});
+        if (resp.bodyFile) {
+            if (resp.bodyFile->size() > 0) c.out.push_back({std::string(), std::move(resp.bodyFile)});
+        } else if (!resp.body.empty()) {
+            c.out.push_back({std::move(resp.body), nullptr});
+        }
+        if (!keepAlive) c.closeAfterFlush = true;
+    }
+    
+    // writev dos trechos em memoria ate o proximo arquivo, sendfile do
+    // arquivo; sem espaco no socket, espera EPOLLOUT
+    bool flush(int ep, Connection& c) {
+        while (!c.out.empty()) {
+            ssize_t w;
+            if (const OpenFile* f = c.out.front().file.get()) {
+                off_t offset = static_cast<off_t>(c.outOffset);
+                w = sendfile(c.fd, f->fd(), &offset, f->size() - c.outOffset);
+                if (w == 0) return false;  // arquivo encolheu depois do Content-Length
+            } else {
+                struct iovec iov[64];
+                int cnt = 0;
+                for (size_t i = 0; i < c.out.size() && cnt < 64 && !c.out[i].file; i++, cnt++) {
+                    size_t skip = i == 0 ? c.outOffset : 0;
+                    iov[cnt].iov_base = const_cast<char*>(c.out[i].data.data()) + skip;
+                    iov[cnt].iov_len = c.out[i].data.size() - skip;
+                }
+                w = writev(c.fd, iov, cnt);
+            }
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+                return watchWrite(ep, c, true);
+            }
+            size_t left = static_cast<size_t>(w);
+            while (left > 0 && !c.out.empty()) {
+                size_t avail = c.out.front().size() - c.outOffset;
+                if (left < avail) {
+                    c.outOffset += left;
+                    left = 0;
+                } else {
+                    left -= avail;
+                    c.out.erase(c.out.begin());
+                    c.outOffset = 0;
+                }
+            }
         }
-        return false;
+        if (c.closeAfterFlush) return false;
+        return watchWrite(ep, c, false);
+    }
+    
+    bool watchWrite(int ep, Connection& c, bool on) {
+        if (c.wantWrite == on) return true;
+        c.wantWrite = on;
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET | (on ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+        ev.data.ptr = &c;
+        return epoll_ctl(ep, EPOLL_CTL_MOD, c.fd, &ev) == 0;
     }
 };
 
@@ -479,32 +679,115 @@ private:
 // ============================================================
 class FileSystem {
 public:
+    // Um fstat e um read para o tamanho exato, sem stringstream
     static std::string readFileSync(const std::string& path) {
-        std::ifstream file(path);
-        if (!file) return "";
-        std::stringstream ss;
-        ss << file.rdbuf();
-        return ss.str();
+        OpenFile file(path);
+        if (!file.isOpen()) return "";
+        std::string content(file.size(), '\0');
+        size_t got = 0;
+        while (got < content.size()) {
+            ssize_t r = ::read(file.fd(), &content[got], content.size() - got);
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) break;
+            got += static_cast<size_t>(r);
+        }
+        content.resize(got);
+        return content;
     }
     
-    static bool writeFileSync(const std::string& path, const std::string& content) {
-        std::ofstream file(path);
-        if (!file) return false;
-        file << content;
-        return true;
+    static bool writeFileSync(const std::string& path, std::string_view content) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+        size_t done = 0;
+        while (done < content.size()) {
+            ssize_t w = ::write(fd, content.data() + done, content.size() - done);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) break;
+            done += static_cast<size_t>(w);
+        }
+        return ::close(fd) == 0 && done == content.size();
     }
     
     static bool existsSync(const std::string& path) {
-        std::ifstream file(path);
-        return file.good();
+        return access(path.c_str(), F_OK) == 0;
+    }
+    
+    // -1 se nao for um arquivo regular legivel
+    static int64_t sizeSync(const std::string& path) {
+        OpenFile file(path);
+        return file.isOpen() ? static_cast<int64_t>(file.size()) : -1;
+    }
+    
+    // Visao mmap somente leitura; isOpen() false se nao mapeou
+    static MappedFile mapSync(const std::string& path) {
+        return MappedFile(path);
+    }
+    
+    // Linha a linha em memoria constante; false se nao abriu ou se onLine
+    // devolveu false (parada antecipada). A view so vale durante o callback.
+    static bool forEachLine(const std::string& path, const std::function<bool(std::string_view)>& onLine) {
+        FileReader reader(path);
+        if (!reader.isOpen()) return false;
+        std::string_view line;
+        while (reader.nextLine(line)) {
+            if (!onLine(line)) return false;
+        }
+        return !reader.error();
+    }
+    
+    static bool forEachChunk(const std::string& path, const std::function<bool(std::string_view)>& onChunk) {
+        FileReader reader(path);
+        if (!reader.isOpen()) return false;
+        std::string_view chunk;
+        while (reader.nextChunk(chunk)) {
+            if (!onChunk(chunk)) return false;
+        }
+        return !reader.error();
     }
     
     static void readFile(const std::string& path, EventLoop& loop,
                          std::function<void(const std::string&)> callback) {
         loop.queueIO([path, &loop, callback]() {
-            std::string content = readFileSync(path);
+            auto content = std::make_shared<std::string>(readFileSync(path));
             loop.completeIO([callback, content]() {
-                callback(content);
+                callback(*content);
+            });
+        });
+    }
+    
+    // open/mmap e o readahead rodam no pool de IO; o callback recebe a
+    // visao ja mapeada na thread do loop (nullptr se falhou)
+    static void mapFile(const std::string& path, EventLoop& loop,
+                        std::function<void(std::shared_ptr<const MappedFile>)> callback) {
+        loop.queueIO([path, &loop, callback]() {
+            auto file = std::make_shared<MappedFile>(path);
+            if (file->isOpen()) file->prefetch();
+            else file.reset();
+            loop.completeIO([callback, file]() {
+                callback(file);
+            });
+        });
+    }
+    
+    // Leitura no pool de IO, bloco a bloco entregue na thread do loop, e
+    // done(ok) ao final. Cada bloco e copiado uma vez (a view do reader nao
+    // sobrevive a troca de thread) e liberado depois do seu callback.
+    static void readChunks(const std::string& path, EventLoop& loop,
+                           std::function<void(const std::string&)> onChunk,
+                           std::function<void(bool)> done) {
+        loop.queueIO([path, &loop, onChunk, done]() {
+            FileReader reader(path);
+            bool ok = reader.isOpen();
+            std::string_view chunk;
+            while (ok && reader.nextChunk(chunk)) {
+                auto copy = std::make_shared<std::string>(chunk);
+                loop.completeIO([onChunk, copy]() {
+                    onChunk(*copy);
+                });
+            }
+            ok = ok && !reader.error();
+            loop.completeIO([done, ok]() {
+                done(ok);
             });
         });
     }
@@ -0,0 +1,609 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 KAVA Team
+ *
+ * KAVA 2.5 - SIMD Kernels
+ * Reducoes (sum/min/max) e operacoes em bloco (fill/mismatch) sobre os
+ * arrays primitivos do heap. Versao escalar portavel, AVX2 em x86-64
+ * (escolhida em tempo de execucao pelo CPUID) e NEON em AArch64.
+ */
+
+#ifndef KAVA_SIMD_H
+#define KAVA_SIMD_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define KAVA_SIMD_AVX2 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define KAVA_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace Kava {
+namespace Simd {
+
+// ============================================================
+// TABELA DE KERNELS
+// ============================================================
+// Todos os kernels aceitam ponteiros sem alinhamento. Somas inteiras sao
+// exatas (wrap em 64 bits); float e somado em double. Somas de ponto
+// flutuante usam 8 acumuladores (elemento i -> acumulador i % 8) combinados
+// sempre na mesma ordem, entao escalar, AVX2 e NEON dao o mesmo resultado.
+// min/max exigem n >= 1 e propagam NaN (como Math.min/Math.max).
+template<typename T>
+struct MinMax {
+    T min;
+    T max;
+};
+
+struct Kernels {
+    const char* name;
+    int64_t (*sumI32)(const int32_t* a, size_t n);
+    int64_t (*sumI64)(const int64_t* a, size_t n);
+    int64_t (*sumI8)(const int8_t* a, size_t n);
+    double (*sumF32)(const float* a, size_t n);
+    double (*sumF64)(const double* a, size_t n);
+    MinMax<int32_t> (*minMaxI32)(const int32_t* a, size_t n);
+    MinMax<int64_t> (*minMaxI64)(const int64_t* a, size_t n);
+    MinMax<int8_t> (*minMaxI8)(const int8_t* a, size_t n);
+    MinMax<float> (*minMaxF32)(const float* a, size_t n);
+    MinMax<double> (*minMaxF64)(const double* a, size_t n);
+    // Grava count elementos de elemSize (1, 2, 4 ou 8) bytes com os bits de pattern
+    void (*fill)(void* dst, size_t count, size_t elemSize, uint64_t pattern);
+    // Indice do primeiro byte diferente, ou -1 se os blocos forem iguais
+    int64_t (*mismatch)(const void* a, const void* b, size_t bytes);
+};
+
+constexpr size_t FLOAT_LANES = 8;
+
+// Padrao de 8 bytes com o elemento repetido
+inline uint64_t splatPattern(uint64_t pattern, size_t elemSize) {
+    switch (elemSize) {
+        case 1: return (pattern & 0xFFull) * 0x0101010101010101ull;
+        case 2: return (pattern & 0xFFFFull) * 0x0001000100010001ull;
+        case 4: return (pattern & 0xFFFFFFFFull) * 0x0000000100000001ull;
+        default: return pattern;
+    }
+}
+
+inline double combineLanes(const double* lanes) {
+    // v[j] = lanes[j] + lanes[j + 4], depois ((v0 + v1) + v2) + v3
+    double v[4];
+    for (size_t j = 0; j < 4; j++) v[j] = lanes[j] + lanes[j + 4];
+    return ((v[0] + v[1]) + v[2]) + v[3];
+}
+
+// ============================================================
+// ESCALAR
+// ============================================================
+namespace Scalar {
+
+template<typename T>
+inline int64_t sumInt(const T* a, size_t n) {
+    uint64_t s = 0;
+    for (size_t i = 0; i < n; i++) s += static_cast<uint64_t>(static_cast<int64_t>(a[i]));
+    return static_cast<int64_t>(s);
+}
+
+template<typename T>
+inline double sumFloat(const T* a, size_t n) {
+    double lanes[FLOAT_LANES] = {};
+    size_t i = 0;
+    for (; i + FLOAT_LANES <= n; i += FLOAT_LANES) {
+        for (size_t j = 0; j < FLOAT_LANES; j++) lanes[j] += static_cast<double>(a[i + j]);
+    }
+    double s = combineLanes(lanes);
+    for (; i < n; i++) s += static_cast<double>(a[i]);
+    return s;
+}
+
+template<typename T>
+inline MinMax<T> minMaxInt(const T* a, size_t n) {
+    MinMax<T> r{a[0], a[0]};
+    for (size_t i = 1; i < n; i++) {
+        if (a[i] < r.min) r.min = a[i];
+        if (a[i] > r.max) r.max = a[i];
+    }
+    return r;
+}
+
+template<typename T>
+inline MinMax<T> minMaxFloat(const T* a, size_t n) {
+    MinMax<T> r{a[0], a[0]};
+    for (size_t i = 0; i < n; i++) {
+        if (a[i] != a[i]) return {a[i], a[i]};
+        if (a[i] < r.min) r.min = a[i];
+        if (a[i] > r.max) r.max = a[i];
+    }
+    return r;
+}
+
+inline int64_t sumI32(const int32_t* a, size_t n) { return sumInt(a, n); }
+inline int64_t sumI64(const int64_t* a, size_t n) { return sumInt(a, n); }
+inline int64_t sumI8(const int8_t* a, size_t n) { return sumInt(a, n); }
+inline double sumF32(const float* a, size_t n) { return sumFloat(a, n); }
+inline double sumF64(const double* a, size_t n) { return sumFloat(a, n); }
+inline MinMax<int32_t> minMaxI32(const int32_t* a, size_t n) { return minMaxInt(a, n); }
+inline MinMax<int64_t> minMaxI64(const int64_t* a, size_t n) { return minMaxInt(a, n); }
+inline MinMax<int8_t> minMaxI8(const int8_t* a, size_t n) { return minMaxInt(a, n); }
+inline MinMax<float> minMaxF32(const float* a, size_t n) { return minMaxFloat(a, n); }
+inline MinMax<double> minMaxF64(const double* a, size_t n) { return minMaxFloat(a, n); }
+
+// bytes e multiplo do elemento, entao o resto (< 8) e um prefixo de word
+inline void fillWords(uint8_t* p, size_t bytes, uint64_t word) {
+    for (; bytes >= 8; bytes -= 8, p += 8) std::memcpy(p, &word, 8);
+    std::memcpy(p, &word, bytes);
+}
+
+inline void fill(void* dst, size_t count, size_t elemSize, uint64_t pattern) {
+    fillWords(static_cast<uint8_t*>(dst), count * elemSize, splatPattern(pattern, elemSize));
+}
+
+inline int64_t mismatchTail(const uint8_t* a, const uint8_t* b, size_t from, size_t bytes) {
+    for (size_t i = from; i < bytes; i++) {
+        if (a[i] != b[i]) return static_cast<int64_t>(i);
+    }
+    return -1;
+}
+
+inline int64_t mismatch(const void* pa, const void* pb, size_t bytes) {
+    const uint8_t* a = static_cast<const uint8_t*>(pa);
+    const uint8_t* b = static_cast<const uint8_t*>(pb);
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        uint64_t x, y;
+        std::memcpy(&x, a + i, 8);
+        std::memcpy(&y, b + i, 8);
+        if (x != y) break;
+    }
+    return mismatchTail(a, b, i, bytes);
+}
+
+} // namespace Scalar
+
+// ============================================================
+// AVX2 (x86-64)
+// ============================================================
+#ifdef KAVA_SIMD_AVX2
+namespace Avx2 {
+
+#define KAVA_AVX2 __attribute__((target("avx2")))
+
+KAVA_AVX2 inline int64_t hsumI64(__m256i v) {
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return _mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1);
+}
+
+KAVA_AVX2 inline int64_t sumI32(const int32_t* a, size_t n) {
+    __m256i lo = _mm256_setzero_si256(), hi = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        lo = _mm256_add_epi64(lo, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        hi = _mm256_add_epi64(hi, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+    uint64_t s = static_cast<uint64_t>(hsumI64(_mm256_add_epi64(lo, hi)));
+    return static_cast<int64_t>(s + static_cast<uint64_t>(Scalar::sumInt(a + i, n - i)));
+}
+
+KAVA_AVX2 inline int64_t sumI64(const int64_t* a, size_t n) {
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_epi64(acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 4)));
+    }
+    uint64_t s = static_cast<uint64_t>(hsumI64(_mm256_add_epi64(acc0, acc1)));
+    return static_cast<int64_t>(s + static_cast<uint64_t>(Scalar::sumInt(a + i, n - i)));
+}
+
+KAVA_AVX2 inline int64_t sumI8(const int8_t* a, size_t n) {
+    // Bytes com sinal viram sem sinal (x ^ 0x80 = x + 128); sad_epu8 soma
+    // grupos de 8 em 4 lanes de 64 bits e o deslocamento sai no fim
+    const __m256i bias = _mm256_set1_epi8(static_cast<char>(0x80));
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = zero;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)), bias);
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(v, zero));
+    }
+    int64_t s = hsumI64(acc) - 128 * static_cast<int64_t>(i);
+    return s + Scalar::sumInt(a + i, n - i);
+}
+
+KAVA_AVX2 inline double sumF32(const float* a, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + FLOAT_LANES <= n; i += FLOAT_LANES) {
+        __m256 v = _mm256_loadu_ps(a + i);
+        acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+        acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+    }
+    double lanes[FLOAT_LANES];
+    _mm256_storeu_pd(lanes, acc0);
+    _mm256_storeu_pd(lanes + 4, acc1);
+    double s = combineLanes(lanes);
+    for (; i < n; i++) s += static_cast<double>(a[i]);
+    return s;
+}
+
+KAVA_AVX2 inline double sumF64(const double* a, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + FLOAT_LANES <= n; i += FLOAT_LANES) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(a + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(a + i + 4));
+    }
+    double lanes[FLOAT_LANES];
+    _mm256_storeu_pd(lanes, acc0);
+    _mm256_storeu_pd(lanes + 4, acc1);
+    double s = combineLanes(lanes);
+    for (; i < n; i++) s += a[i];
+    return s;
+}
+
+KAVA_AVX2 inline MinMax<int32_t> minMaxI32(const int32_t* a, size_t n) {
+    if (n < 8) return Scalar::minMaxInt(a, n);
+    __m256i mn = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a)), mx = mn;
+    size_t i = 8;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        mn = _mm256_min_epi32(mn, v);
+        mx = _mm256_max_epi32(mx, v);
+    }
+    int32_t lo[8], hi[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lo), mn);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(hi), mx);
+    MinMax<int32_t> r = Scalar::minMaxInt(lo, 8);
+    r.max = Scalar::minMaxInt(hi, 8).max;
+    for (; i < n; i++) {
+        if (a[i] < r.min) r.min = a[i];
+        if (a[i] > r.max) r.max = a[i];
+    }
+    return r;
+}
+
+KAVA_AVX2 inline MinMax<int64_t> minMaxI64(const int64_t* a, size_t n) {
+    if (n < 4) return Scalar::minMaxInt(a, n);
+    __m256i mn = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a)), mx = mn;
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        mn = _mm256_blendv_epi8(mn, v, _mm256_cmpgt_epi64(mn, v));
+        mx = _mm256_blendv_epi8(mx, v, _mm256_cmpgt_epi64(v, mx));
+    }
+    int64_t lo[4], hi[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lo), mn);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(hi), mx);
+    MinMax<int64_t> r = Scalar::minMaxInt(lo, 4);
+    r.max = Scalar::minMaxInt(hi, 4).max;
+    for (; i < n; i++) {
+        if (a[i] < r.min) r.min = a[i];
+        if (a[i] > r.max) r.max = a[i];
+    }
+    return r;
+}
+
+KAVA_AVX2 inline MinMax<int8_t> minMaxI8(const int8_t* a, size_t n) {
+    if (n < 32) return Scalar::minMaxInt(a, n);
+    __m256i mn = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a)), mx = mn;
+    size_t i = 32;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        mn = _mm256_min_epi8(mn, v);
+        mx = _mm256_max_epi8(mx, v);
+    }
+    int8_t lo[32], hi[32];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lo), mn);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(hi), mx);
+    MinMax<int8_t> r = Scalar::minMaxInt(lo, 32);
+    r.max = Scalar::minMaxInt(hi, 32).max;
+    for (; i < n; i++) {
+        if (a[i] < r.min) r.min = a[i];
+        if (a[i] > r.max) r.max = a[i];
+    }
+    return r;
+}
+
+// min_ps/max_ps nao propagam NaN de forma simetrica: os NaN sao contados a
+// parte (_CMP_UNORD_Q) e, se houver algum, o resultado e NaN
+KAVA_AVX2 inline MinMax<float> minMaxF32(const float* a, size_t n) {
+    if (n < 8) return Scalar::minMaxFloat(a, n);
+    __m256 mn = _mm256_loadu_ps(a), mx = mn;
+    __m256 nan = _mm256_cmp_ps(mn, mn, _CMP_UNORD_Q);
+    size_t i = 8;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(a + i);
+        nan = _mm256_or_ps(nan, _mm256_cmp_ps(v, v, _CMP_UNORD_Q));
+        mn = _mm256_min_ps(mn, v);
+        mx = _mm256_max_ps(mx, v);
+    }
+    if (_mm256_movemask_ps(nan)) return {std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::quiet_NaN()};
+    float lo[8], hi[8];
+    _mm256_storeu_ps(lo, mn);
+    _mm256_storeu_ps(hi, mx);
+    MinMax<float> r = Scalar::minMaxFloat(lo, 8);
+    r.max = Scalar::minMaxFloat(hi, 8).max;
+    MinMax<float> tail = i < n ? Scalar::minMaxFloat(a + i, n - i) : r;
+    if (tail.min != tail.min) return tail;
+    if (tail.min < r.min) r.min = tail.min;
+    if (tail.max > r.max) r.max = tail.max;
+    return r;
+}
+
+KAVA_AVX2 inline MinMax<double> minMaxF64(const double* a, size_t n) {
+    if (n < 4) return Scalar::minMaxFloat(a, n);
+    __m256d mn = _mm256_loadu_pd(a), mx = mn;
+    __m256d nan = _mm256_cmp_pd(mn, mn, _CMP_UNORD_Q);
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(a + i);
+        nan = _mm256_or_pd(nan, _mm256_cmp_pd(v, v, _CMP_UNORD_Q));
+        mn = _mm256_min_pd(mn, v);
+        mx = _mm256_max_pd(mx, v);
+    }
+    if (_mm256_movemask_pd(nan)) return {std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN()};
+    double lo[4], hi[4];
+    _mm256_storeu_pd(lo, mn);
+    _mm256_storeu_pd(hi, mx);
+    MinMax<double> r = Scalar::minMaxFloat(lo, 4);
+    r.max = Scalar::minMaxFloat(hi, 4).max;
+    MinMax<double> tail = i < n ? Scalar::minMaxFloat(a + i, n - i) : r;
+    if (tail.min != tail.min) return tail;
+    if (tail.min < r.min) r.min = tail.min;
+    if (tail.max > r.max) r.max = tail.max;
+    return r;
+}
+
+KAVA_AVX2 inline void fill(void* dst, size_t count, size_t elemSize, uint64_t pattern) {
+    const uint64_t word = splatPattern(pattern, elemSize);
+    const __m256i v = _mm256_set1_epi64x(static_cast<long long>(word));
+    uint8_t* p = static_cast<uint8_t*>(dst);
+    size_t bytes = count * elemSize;
+    for (; bytes >= 32; bytes -= 32, p += 32) _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    Scalar::fillWords(p, bytes, word);
+}
+
+KAVA_AVX2 inline int64_t mismatch(const void* pa, const void* pb, size_t bytes) {
+    const uint8_t* a = static_cast<const uint8_t*>(pa);
+    const uint8_t* b = static_cast<const uint8_t*>(pb);
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        uint32_t eq = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+        if (eq != 0xFFFFFFFFu) return static_cast<int64_t>(i + __builtin_ctz(~eq));
+    }
+    return Scalar::mismatchTail(a, b, i, bytes);
+}
+
+#undef KAVA_AVX2
+
+} // namespace Avx2
+#endif // KAVA_SIMD_AVX2
+
+// ============================================================
+// NEON (AArch64)
+// ============================================================
+#ifdef KAVA_SIMD_NEON
+namespace Neon {
+
+inline int64_t sumI32(const int32_t* a, size_t n) {
+    int64x2_t acc = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) acc = vpadalq_s32(acc, vld1q_s32(a + i));
+    uint64_t s = static_cast<uint64_t>(vgetq_lane_s64(acc, 0)) + static_cast<uint64_t>(vgetq_lane_s64(acc, 1));
+    return static_cast<int64_t>(s + static_cast<uint64_t>(Scalar::sumInt(a + i, n - i)));
+}
+
+inline int64_t sumI64(const int64_t* a, size_t n) {
+    int64x2_t acc0 = vdupq_n_s64(0), acc1 = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = vaddq_s64(acc0, vld1q_s64(a + i));
+        acc1 = vaddq_s64(acc1, vld1q_s64(a + i + 2));
+    }
+    int64x2_t acc = vaddq_s64(acc0, acc1);
+    uint64_t s = static_cast<uint64_t>(vgetq_lane_s64(acc, 0)) + static_cast<uint64_t>(vgetq_lane_s64(acc, 1));
+    return static_cast<int64_t>(s + static_cast<uint64_t>(Scalar::sumInt(a + i, n - i)));
+}
+
+inline int64_t sumI8(const int8_t* a, size_t n) {
+    int64x2_t acc = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc = vpadalq_s32(acc, vpaddlq_s16(vpaddlq_s8(vld1q_s8(a + i))));
+    }
+    return vgetq_lane_s64(acc, 0) + vgetq_lane_s64(acc, 1) + Scalar::sumInt(a + i, n - i);
+}
+
+inline double combine(float64x2_t l0, float64x2_t l1, float64x2_t l2, float64x2_t l3) {
+    double lanes[FLOAT_LANES];
+    vst1q_f64(lanes, l0);
+    vst1q_f64(lanes + 2, l1);
+    vst1q_f64(lanes + 4, l2);
+    vst1q_f64(lanes + 6, l3);
+    return combineLanes(lanes);
+}
+
+inline double sumF32(const float* a, size_t n) {
+    float64x2_t l0 = vdupq_n_f64(0), l1 = l0, l2 = l0, l3 = l0;
+    size_t i = 0;
+    for (; i + FLOAT_LANES <= n; i += FLOAT_LANES) {
+        float32x4_t x = vld1q_f32(a + i), y = vld1q_f32(a + i + 4);
+        l0 = vaddq_f64(l0, vcvt_f64_f32(vget_low_f32(x)));
+        l1 = vaddq_f64(l1, vcvt_high_f64_f32(x));
+        l2 = vaddq_f64(l2, vcvt_f64_f32(vget_low_f32(y)));
+        l3 = vaddq_f64(l3, vcvt_high_f64_f32(y));
+    }
+    double s = combine(l0, l1, l2, l3);
+    for (; i < n; i++) s += static_cast<double>(a[i]);
+    return s;
+}
+
+inline double sumF64(const double* a, size_t n) {
+    float64x2_t l0 = vdupq_n_f64(0), l1 = l0, l2 = l0, l3 = l0;
+    size_t i = 0;
+    for (; i + FLOAT_LANES <= n; i += FLOAT_LANES) {
+        l0 = vaddq_f64(l0, vld1q_f64(a + i));
+        l1 = vaddq_f64(l1, vld1q_f64(a + i + 2));
+        l2 = vaddq_f64(l2, vld1q_f64(a + i + 4));
+        l3 = vaddq_f64(l3, vld1q_f64(a + i + 6));
+    }
+    double s = combine(l0, l1, l2, l3);
+    for (; i < n; i++) s += a[i];
+    return s;
+}
+
+inline MinMax<int32_t> minMaxI32(const int32_t* a, size_t n) {
+    if (n < 4) return Scalar::minMaxInt(a, n);
+    int32x4_t mn = vld1q_s32(a), mx = mn;
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        int32x4_t v = vld1q_s32(a + i);
+        mn = vminq_s32(mn, v);
+        mx = vmaxq_s32(mx, v);
+    }
+    MinMax<int32_t> r{vminvq_s32(mn), vmaxvq_s32(mx)};
+    for (; i < n; i++) {
+        if (a[i] < r.min) r.min = a[i];
+        if (a[i] > r.max) r.max = a[i];
+    }
+    return r;
+}
+
+inline MinMax<int64_t> minMaxI64(const int64_t* a, size_t n) {
+    if (n < 2) return Scalar::minMaxInt(a, n);
+    int64x2_t mn = vld1q_s64(a), mx = mn;
+    size_t i = 2;
+    for (; i + 2 <= n; i += 2) {
+        int64x2_t v = vld1q_s64(a + i);
+        mn = vbslq_s64(vcgtq_s64(mn, v), v, mn);
+        mx = vbslq_s64(vcgtq_s64(v, mx), v, mx);
+    }
+    int64_t lo[2], hi[2];
+    vst1q_s64(lo, mn);
+    vst1q_s64(hi, mx);
+    MinMax<int64_t> r{lo[0] < lo[1] ? lo[0] : lo[1], hi[0] > hi[1] ? hi[0] : hi[1]};
+    for (; i < n; i++) {
+        if (a[i] < r.min) r.min = a[i];
+        if (a[i] > r.max) r.max = a[i];
+    }
+    return r;
+}
+
+inline MinMax<int8_t> minMaxI8(const int8_t* a, size_t n) {
+    if (n < 16) return Scalar::minMaxInt(a, n);
+    int8x16_t mn = vld1q_s8(a), mx = mn;
+    size_t i = 16;
+    for (; i + 16 <= n; i += 16) {
+        int8x16_t v = vld1q_s8(a + i);
+        mn = vminq_s8(mn, v);
+        mx = vmaxq_s8(mx, v);
+    }
+    MinMax<int8_t> r{vminvq_s8(mn), vmaxvq_s8(mx)};
+    for (; i < n; i++) {
+        if (a[i] < r.min) r.min = a[i];
+        if (a[i] > r.max) r.max = a[i];
+    }
+    return r;
+}
+
+// vminq/vmaxq (FMIN/FMAX) ja propagam NaN
+inline MinMax<float> minMaxF32(const float* a, size_t n) {
+    if (n < 4) return Scalar::minMaxFloat(a, n);
+    float32x4_t mn = vld1q_f32(a), mx = mn;
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vld1q_f32(a + i);
+        mn = vminq_f32(mn, v);
+        mx = vmaxq_f32(mx, v);
+    }
+    MinMax<float> r{vminvq_f32(mn), vmaxvq_f32(mx)};
+    if (r.min != r.min || r.max != r.max) return {std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::quiet_NaN()};
+    MinMax<float> tail = i < n ? Scalar::minMaxFloat(a + i, n - i) : r;
+    if (tail.min != tail.min) return tail;
+    if (tail.min < r.min) r.min = tail.min;
+    if (tail.max > r.max) r.max = tail.max;
+    return r;
+}
+
+inline MinMax<double> minMaxF64(const double* a, size_t n) {
+    if (n < 2) return Scalar::minMaxFloat(a, n);
+    float64x2_t mn = vld1q_f64(a), mx = mn;
+    size_t i = 2;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t v = vld1q_f64(a + i);
+        mn = vminq_f64(mn, v);
+        mx = vmaxq_f64(mx, v);
+    }
+    MinMax<double> r{vminvq_f64(mn), vmaxvq_f64(mx)};
+    if (r.min != r.min || r.max != r.max) return {std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN()};
+    MinMax<double> tail = i < n ? Scalar::minMaxFloat(a + i, n - i) : r;
+    if (tail.min != tail.min) return tail;
+    if (tail.min < r.min) r.min = tail.min;
+    if (tail.max > r.max) r.max = tail.max;
+    return r;
+}
+
+inline void fill(void* dst, size_t count, size_t elemSize, uint64_t pattern) {
+    const uint64_t word = splatPattern(pattern, elemSize);
+    const uint8x16_t v = vreinterpretq_u8_u64(vdupq_n_u64(word));
+    uint8_t* p = static_cast<uint8_t*>(dst);
+    size_t bytes = count * elemSize;
+    for (; bytes >= 16; bytes -= 16, p += 16) vst1q_u8(p, v);
+    Scalar::fillWords(p, bytes, word);
+}
+
+inline int64_t mismatch(const void* pa, const void* pb, size_t bytes) {
+    const uint8_t* a = static_cast<const uint8_t*>(pa);
+    const uint8_t* b = static_cast<const uint8_t*>(pb);
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        if (vminvq_u8(vceqq_u8(vld1q_u8(a + i), vld1q_u8(b + i))) != 0xFF) break;
+    }
+    return Scalar::mismatchTail(a, b, i, bytes);
+}
+
+} // namespace Neon
+#endif // KAVA_SIMD_NEON
+
+// ============================================================
+// DISPATCH
+// ============================================================
+#define KAVA_SIMD_TABLE(ns, label) \
+    Kernels{label, ns::sumI32, ns::sumI64, ns::sumI8, ns::sumF32, ns::sumF64, \
+            ns::minMaxI32, ns::minMaxI64, ns::minMaxI8, ns::minMaxF32, ns::minMaxF64, \
+            ns::fill, ns::mismatch}
+
+inline const Kernels& scalar() {
+    static const Kernels table = KAVA_SIMD_TABLE(Scalar, "scalar");
+    return table;
+}
+
+// Melhor conjunto suportado pela CPU atual (detectado uma vez)
+inline const Kernels& best() {
+#if defined(KAVA_SIMD_AVX2)
+    static const Kernels avx2 = KAVA_SIMD_TABLE(Avx2, "avx2");
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    return hasAvx2 ? avx2 : scalar();
+#elif defined(KAVA_SIMD_NEON)
+    static const Kernels neon = KAVA_SIMD_TABLE(Neon, "neon");
+    return neon;
+#else
+    return scalar();
+#endif
+}
+
+#undef KAVA_SIMD_TABLE
+
+} // namespace Simd
+} // namespace Kava
+
+#endif // KAVA_SIMD_H
@@ -0,0 +1,297 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 KAVA Team
+ *
+ * KAVA 2.5 - Superinstruction Pass
+ * Reescrita em tempo de carga (entre o Codegen e a VM) que funde os
+ * padroes mais comuns do bytecode gerado pelo kavac em superinstrucoes,
+ * com tabela de relocacao para que os alvos de salto continuem validos.
+ */
+
+#ifndef KAVA_SUPERINST_H
+#define KAVA_SUPERINST_H
+
+#include "bytecode.h"
+#include "jit.h"
+#include <vector>
+#include <cstdint>
+#include <climits>
+
+namespace Kava {
+
+// ============================================================
+// SUPERINSTRUCTION PASS
+// ============================================================
+// Padroes fundidos (todas as variaveis sao globais no kavac atual):
+//   LOAD a; LOAD b; IADD|ISUB|IMUL; [DUP;] STORE c; [POP]  -> SUPER_GLOBAL_op c a b
+//   LOAD a; CONST k; IADD|ISUB; [DUP;] STORE a; [POP]      -> IINC a +-k
+//   LOAD a; CONST k; icmp; JZ t                           -> SUPER_LOAD_CMP_JZ a k icmp t
+//   LOAD a; LOAD b; icmp; JZ t                            -> SUPER_LOAD_LOAD_CMP_JZ a b icmp t
+//   icmp; JZ t                                            -> SUPER_CMP_JZ icmp t
+//   IINC a k; JMP head   (head = SUPER_LOAD_CMP_JZ v c icmp exit)
+//                        -> SUPER_INC_CMP_JNZ a k v c icmp body; JMP exit
+// Um padrao so e fundido se nenhuma instrucao interna for alvo de salto.
+class SuperinstructionPass {
+public:
+    struct Stats {
+        uint64_t globalArith = 0;
+        uint64_t increments = 0;
+        uint64_t compareBranches = 0;
+        uint64_t loopBackEdges = 0;
+        size_t originalWords = 0;
+        size_t rewrittenWords = 0;
+    };
+
+    Stats stats;
+
+    // PC antigo -> PC novo (-1 = palavra de operando ou instrucao fundida)
+    std::vector<int32_t> relocation;
+
+    std::vector<int32_t> run(const std::vector<int32_t>& code) {
+        stats = Stats();
+        stats.originalWords = code.size();
+
+        std::vector<Instr> instrs;
+        std::vector<bool> isTarget;
+        if (!decode(code, instrs, isTarget)) {
+            // Stream malformado: mantem o bytecode original intacto
+            relocation.assign(code.size() + 1, -1);
+            for (size_t i = 0; i <= code.size(); i++) relocation[i] = static_cast<int32_t>(i);
+            stats.rewrittenWords = code.size();
+            return code;
+        }
+
+        std::vector<Instr> fused = fuse(instrs, isTarget);
+        rotateLoops(fused, isTarget);
+        return layout(fused, code.size());
+    }
+
+private:
+    static constexpr int MAX_OPERANDS = 6;
+
+    struct Instr {
+        int32_t oldPC;
+        int32_t op;
+        int32_t nargs;
+        int32_t args[MAX_OPERANDS];
+    };
+
+    static Instr make(int32_t oldPC, int32_t op, std::initializer_list<int32_t> args) {
+        Instr in;
+        in.oldPC = oldPC;
+        in.op = op;
+        in.nargs = 0;
+        for (int32_t a : args) in.args[in.nargs++] = a;
+        return in;
+    }
+
+    // ========================================
+    // DECODE
+    // ========================================
+    static bool decode(const std::vector<int32_t>& code, std::vector<Instr>& instrs,
+                       std::vector<bool>& isTarget) {
+        const size_t size = code.size();
+        std::vector<bool> isStart(size + 1, false);
+        isTarget.assign(size + 1, false);
+        isStart[size] = true;
+
+        size_t pc = 0;
+        while (pc < size) {
+            Instr in;
+            in.oldPC = static_cast<int32_t>(pc);
+            in.op = code[pc];
+            in.nargs = instructionOperandCount(in.op);
+            if (in.nargs > MAX_OPERANDS || pc + 1 + in.nargs > size) {
+                return false;
+            }
+            for (int i = 0; i < in.nargs; i++) in.args[i] = code[pc + 1 + i];
+            isStart[pc] = true;
+            instrs.push_back(in);
+            pc += 1 + in.nargs;
+        }
+
+        for (const Instr& in : instrs) {
+            int j = jumpOperandIndex(in.op);
+            if (j < 0) continue;
+            int32_t t = in.args[j];
+            // Alvo fora de uma fronteira de instrucao: nao ha como relocar com seguranca
+            if (t < 0 || t > static_cast<int32_t>(size) || !isStart[t]) return false;
+            isTarget[t] = true;
+        }
+        return true;
+    }
+
+    // ========================================
+    // FUSION
+    // ========================================
+    static bool constValue(const Instr& in, int32_t& k) {
+        if (in.op == OP_PUSH_INT) { k = in.args[0]; return true; }
+        if (in.op == OP_ICONST_M1) { k = -1; return true; }
+        if (in.op >= OP_ICONST_0 && in.op <= OP_ICONST_5) { k = in.op - OP_ICONST_0; return true; }
+        return false;
+    }
+
+    // Nenhuma instrucao em (i, i + n) pode ser alvo de salto
+    static bool straightLine(const std::vector<Instr>& in, const std::vector<bool>& isTarget,
+                             size_t i, size_t n) {
+        if (i + n > in.size()) return false;
+        for (size_t k = i + 1; k < i + n; k++) {
+            if (isTarget[in[k].oldPC]) return false;
+        }
+        return true;
+    }
+
+    // [DUP;] STORE_GLOBAL c; [POP] a partir de in[i]; devolve o tamanho ou 0
+    static size_t storeTail(const std::vector<Instr>& in, size_t i, int32_t& dst) {
+        if (i + 2 < in.size() && in[i].op == OP_DUP && in[i + 1].op == OP_STORE_GLOBAL &&
+            in[i + 2].op == OP_POP) {
+            dst = in[i + 1].args[0];
+            return 3;
+        }
+        if (i < in.size() && in[i].op == OP_STORE_GLOBAL) {
+            dst = in[i].args[0];
+            return 1;
+        }
+        return 0;
+    }
+
+    std::vector<Instr> fuse(const std::vector<Instr>& in, const std::vector<bool>& isTarget) {
+        std::vector<Instr> out;
+        out.reserve(in.size());
+
+        size_t i = 0;
+        while (i < in.size()) {
+            const Instr& a = in[i];
+            int32_t pc = a.oldPC;
+
+            if (a.op == OP_LOAD_GLOBAL && i + 2 < in.size()) {
+                const Instr& b = in[i + 1];
+                const Instr& op = in[i + 2];
+                int32_t k = 0;
+                int32_t dst = 0;
+
+                // c = a op b
+                if (b.op == OP_LOAD_GLOBAL &&
+                    (op.op == OP_IADD || op.op == OP_ISUB || op.op == OP_IMUL)) {
+                    size_t tail = storeTail(in, i + 3, dst);
+                    if (tail && straightLine(in, isTarget, i, 3 + tail)) {
+                        int32_t sop = op.op == OP_IADD ? SUPER_GLOBAL_ADD :
+                                      op.op == OP_ISUB ? SUPER_GLOBAL_SUB : SUPER_GLOBAL_MUL;
+                        out.push_back(make(pc, sop, {dst, a.args[0], b.args[0]}));
+                        stats.globalArith++;
+                        i += 3 + tail;
+                        continue;
+                    }
+                }
+
+                // a = a +- k
+                if (constValue(b, k) && (op.op == OP_IADD || op.op == OP_ISUB) &&
+                    !(op.op == OP_ISUB && k == INT_MIN)) {
+                    size_t tail = storeTail(in, i + 3, dst);
+                    if (tail && dst == a.args[0] && straightLine(in, isTarget, i, 3 + tail)) {
+                        out.push_back(make(pc, OP_IINC, {dst, op.op == OP_IADD ? k : -k}));
+                        stats.increments++;
+                        i += 3 + tail;
+                        continue;
+                    }
+                }
+
+                // if (a icmp k) / if (a icmp b)
+                if (isIntCompareOp(op.op) && i + 3 < in.size() && in[i + 3].op == OP_JZ &&
+                    straightLine(in, isTarget, i, 4)) {
+                    int32_t target = in[i + 3].args[0];
+                    if (constValue(b, k)) {
+                        out.push_back(make(pc, SUPER_LOAD_CMP_JZ, {a.args[0], k, op.op, target}));
+                        stats.compareBranches++;
+                        i += 4;
+                        continue;
+                    }
+                    if (b.op == OP_LOAD_GLOBAL) {
+                        out.push_back(make(pc, SUPER_LOAD_LOAD_CMP_JZ,
+                                           {a.args[0], b.args[0], op.op, target}));
+                        stats.compareBranches++;
+                        i += 4;
+                        continue;
+                    }
+                }
+            }
+
+            if (isIntCompareOp(a.op) && i + 1 < in.size() && in[i + 1].op == OP_JZ &&
+                straightLine(in, isTarget, i, 2)) {
+                out.push_back(make(pc, SUPER_CMP_JZ, {a.op, in[i + 1].args[0]}));
+                stats.compareBranches++;
+                i += 2;
+                continue;
+            }
+
+            out.push_back(a);
+            i++;
+        }
+        return out;
+    }
+
+    // ========================================
+    // LOOP ROTATION (IINC + back-edge)
+    // ========================================
+    // O teste do cabecalho e duplicado no back-edge, entao cada iteracao
+    // executa uma unica instrucao de controle em vez de JMP + teste.
+    void rotateLoops(std::vector<Instr>& out, const std::vector<bool>& isTarget) {
+        std::vector<int32_t> indexOf(isTarget.size(), -1);
+        for (size_t i = 0; i < out.size(); i++) indexOf[out[i].oldPC] = static_cast<int32_t>(i);
+
+        for (size_t i = 0; i + 1 < out.size(); i++) {
+            Instr& inc = out[i];
+            Instr& jmp = out[i + 1];
+            if (inc.op != OP_IINC || jmp.op != OP_JMP || isTarget[jmp.oldPC]) continue;
+
+            int32_t head = jmp.args[0];
+            if (head >= jmp.oldPC) continue;
+            int32_t h = indexOf[head];
+            if (h < 0 || out[h].op != SUPER_LOAD_CMP_JZ ||
+                static_cast<size_t>(h) + 1 >= out.size()) continue;
+
+            const Instr& test = out[h];
+            int32_t body = out[h + 1].oldPC;
+            int32_t exitPC = test.args[3];
+            inc = make(inc.oldPC, SUPER_INC_CMP_JNZ,
+                       {inc.args[0], inc.args[1], test.args[0], test.args[1], test.args[2], body});
+            jmp.args[0] = exitPC;
+            stats.loopBackEdges++;
+        }
+    }
+
+    // ========================================
+    // LAYOUT + RELOCATION
+    // ========================================
+    std::vector<int32_t> layout(const std::vector<Instr>& out, size_t oldSize) {
+        relocation.assign(oldSize + 1, -1);
+        int32_t newPC = 0;
+        for (const Instr& in : out) {
+            relocation[in.oldPC] = newPC;
+            newPC += 1 + in.nargs;
+        }
+        relocation[oldSize] = newPC;
+
+        std::vector<int32_t> result;
+        result.reserve(newPC);
+        for (const Instr& in : out) {
+            result.push_back(in.op);
+            int j = jumpOperandIndex(in.op);
+            for (int k = 0; k < in.nargs; k++) {
+                int32_t word = in.args[k];
+                if (k == j) {
+                    // Alvos validados no decode sempre caem em inicio de instrucao mantida
+                    int32_t moved = relocation[word];
+                    word = moved >= 0 ? moved : newPC;
+                }
+                result.push_back(word);
+            }
+        }
+        stats.rewrittenWords = result.size();
+        return result;
+    }
+};
+
+} // namespace Kava
+
+#endif // KAVA_SUPERINST_H
@@ -0,0 +1,50 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 KAVA Team
+ *
+ * KAVA 2.5 - Tabela de simbolos da VM
+ * Nomes de classes, metodos e campos sao internados em ids densos (int32)
+ * na carga do programa; dai em diante despacho, campos e nativos comparam
+ * inteiros e indexam vetores em vez de comparar strings.
+ */
+
+#ifndef KAVA_SYMBOLS_H
+#define KAVA_SYMBOLS_H
+
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
+
+namespace Kava {
+
+class SymbolTable {
+public:
+    // Id do nome, criando na primeira vez
+    int32_t intern(const std::string& name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+        const int32_t id = static_cast<int32_t>(names.size());
+        names.push_back(name);
+        ids.emplace(name, id);
+        return id;
+    }
+
+    // -1 quando o nome nunca foi internado
+    int32_t find(const std::string& name) const {
+        auto it = ids.find(name);
+        return it != ids.end() ? it->second : -1;
+    }
+
+    // deque: referencias continuam validas enquanto a tabela cresce
+    const std::string& name(int32_t id) const { return names[static_cast<size_t>(id)]; }
+    int32_t size() const { return static_cast<int32_t>(names.size()); }
+
+private:
+    std::unordered_map<std::string, int32_t> ids;
+    std::deque<std::string> names;
+};
+
+} // namespace Kava
+
+#endif // KAVA_SYMBOLS_H
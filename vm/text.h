@@ -0,0 +1,200 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 KAVA Team
+ *
+ * KAVA 2.5 - Strings do heap
+ * Tres formas de texto no heap:
+ *   STRING          [int32 len][bytes][\0]; o hash fica em cache no classId
+ *                   do header (0 = ainda nao calculado)
+ *   STRING_ROPE     [2][esq][dir][int32 len]: concatenacao preguicosa. O
+ *                   primeiro acesso indexado achata: esq vira a String
+ *                   plana e dir fica null.
+ *   STRING_BUILDER  [1][byte[] buffer][int32 len]: append com crescimento
+ *                   amortizado (a capacidade e o tamanho do buffer)
+ * Ropes e builders usam o layout [n][n referencias][primitivos] das
+ * instancias, entao o GC os percorre sem caso especial.
+ */
+
+#ifndef KAVA_TEXT_H
+#define KAVA_TEXT_H
+
+#include "../gc/gc.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+namespace Kava {
+
+namespace StringObjects {
+
+// Concatenacoes ate este tamanho copiam na hora: um no de rope (e o
+// achatamento depois) custa mais que copiar poucos bytes
+constexpr int32_t ROPE_MIN_LENGTH = 64;
+
+constexpr size_t ROPE_DATA_SIZE = sizeof(int32_t) + 2 * sizeof(GCObject*) + sizeof(int32_t);
+constexpr size_t BUILDER_DATA_SIZE = sizeof(int32_t) + sizeof(GCObject*) + sizeof(int32_t);
+
+inline bool isFlat(const GCObject* obj) { return obj && obj->header.type == GCObjectType::STRING; }
+inline bool isRope(const GCObject* obj) { return obj && obj->header.type == GCObjectType::STRING_ROPE; }
+inline bool isBuilder(const GCObject* obj) { return obj && obj->header.type == GCObjectType::STRING_BUILDER; }
+inline bool isText(const GCObject* obj) { return isFlat(obj) || isRope(obj) || isBuilder(obj); }
+
+// ---------- STRING ----------
+inline int32_t flatLength(const GCObject* s) { return *reinterpret_cast<const int32_t*>(s->data); }
+inline const char* flatChars(const GCObject* s) { return reinterpret_cast<const char*>(s->data + sizeof(int32_t)); }
+inline char* flatChars(GCObject* s) { return reinterpret_cast<char*>(s->data + sizeof(int32_t)); }
+inline std::string_view flatView(const GCObject* s) { return std::string_view(flatChars(s), static_cast<size_t>(flatLength(s))); }
+
+// FNV-1a; 0 fica reservado para "sem hash em cache"
+inline uint32_t hashBytes(const char* p, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; i++) {
+        h ^= static_cast<uint8_t>(p[i]);
+        h *= 16777619u;
+    }
+    return h ? h : 1;
+}
+
+inline uint32_t hash(GCObject* flat) {
+    uint32_t& cached = flat->header.classId;
+    if (!cached) cached = hashBytes(flatChars(flat), static_cast<size_t>(flatLength(flat)));
+    return cached;
+}
+
+// ---------- STRING_ROPE ----------
+inline GCObject** ropeLeft(GCObject* r) { return &r->arrayElement<GCObject*>(0); }
+inline GCObject** ropeRight(GCObject* r) { return &r->arrayElement<GCObject*>(1); }
+inline int32_t& ropeLength(GCObject* r) {
+    return *reinterpret_cast<int32_t*>(r->data + sizeof(int32_t) + 2 * sizeof(GCObject*));
+}
+// String plana de um rope ja achatado, ou null
+inline GCObject* flattened(GCObject* r) { return *ropeRight(r) ? nullptr : *ropeLeft(r); }
+
+// ---------- STRING_BUILDER ----------
+inline GCObject** builderBuffer(GCObject* b) { return &b->arrayElement<GCObject*>(0); }
+inline int32_t& builderLength(GCObject* b) {
+    return *reinterpret_cast<int32_t*>(b->data + sizeof(int32_t) + sizeof(GCObject*));
+}
+inline int32_t builderCapacity(GCObject* b) {
+    GCObject* buf = *builderBuffer(b);
+    return buf ? buf->arrayLength() : 0;
+}
+inline char* builderChars(GCObject* b) {
+    GCObject* buf = *builderBuffer(b);
+    return buf ? reinterpret_cast<char*>(buf->data + sizeof(int32_t)) : nullptr;
+}
+
+inline int32_t length(GCObject* s) {
+    switch (s->header.type) {
+        case GCObjectType::STRING: return flatLength(s);
+        case GCObjectType::STRING_ROPE: return ropeLength(s);
+        case GCObjectType::STRING_BUILDER: return builderLength(s);
+        default: return 0;
+    }
+}
+
+// Visita os pedacos do texto em ordem, sink(ptr, n). Nao aloca no heap (o
+// GC nao roda durante a visita); stack e so a pilha de trabalho da descida
+// pelos ropes, reaproveitada entre chamadas.
+template<typename Sink>
+inline void forEachPiece(GCObject* s, std::vector<GCObject*>& stack, Sink&& sink) {
+    if (isBuilder(s)) {
+        if (builderLength(s) > 0) sink(builderChars(s), static_cast<size_t>(builderLength(s)));
+        return;
+    }
+    const size_t base = stack.size();
+    stack.push_back(s);
+    while (stack.size() > base) {
+        GCObject* node = stack.back();
+        stack.pop_back();
+        if (isRope(node)) {
+            if (GCObject* flat = flattened(node)) {
+                node = flat;
+            } else {
+                stack.push_back(*ropeRight(node));
+                stack.push_back(*ropeLeft(node));
+                continue;
+            }
+        }
+        if (isFlat(node) && flatLength(node) > 0) sink(flatChars(node), static_cast<size_t>(flatLength(node)));
+    }
+}
+
+inline void appendTo(std::string& out, GCObject* s, std::vector<GCObject*>& stack) {
+    forEachPiece(s, stack, [&](const char* p, size_t n) { out.append(p, n); });
+}
+
+// Copia o texto para dest (length(s) bytes)
+inline void copyTo(char* dest, GCObject* s, std::vector<GCObject*>& stack) {
+    forEachPiece(s, stack, [&](const char* p, size_t n) {
+        std::memcpy(dest, p, n);
+        dest += n;
+    });
+}
+
+} // namespace StringObjects
+
+// ============================================================
+// STRINGS INTERNADAS
+// ============================================================
+// Enderecamento aberto com sondagem linear sobre o hash em cache das
+// Strings: a busca compara hash e tamanho antes dos bytes, e o GC mover os
+// objetos nao muda a posicao de nenhuma entrada (os slots sao roots).
+class StringInternTable {
+public:
+    GCObject* find(std::string_view text, uint32_t hash) const {
+        if (slots.empty()) return nullptr;
+        const size_t mask = slots.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            const Slot& s = slots[i];
+            if (!s.object) return nullptr;
+            if (s.hash == hash && StringObjects::flatView(s.object) == text) return s.object;
+        }
+    }
+
+    // flat ainda nao pode estar na tabela
+    void insert(GCObject* flat, uint32_t hash) {
+        if ((count + 1) * 2 > slots.size()) grow();
+        place(flat, hash);
+        count++;
+    }
+
+    template<typename Visit>
+    void forEach(Visit&& visit) {
+        for (Slot& s : slots) {
+            if (s.object) visit(s.object);
+        }
+    }
+
+    size_t size() const { return count; }
+
+private:
+    struct Slot {
+        uint32_t hash = 0;
+        GCObject* object = nullptr;
+    };
+    std::vector<Slot> slots;
+    size_t count = 0;
+
+    void place(GCObject* flat, uint32_t hash) {
+        const size_t mask = slots.size() - 1;
+        size_t i = hash & mask;
+        while (slots[i].object) i = (i + 1) & mask;
+        slots[i] = {hash, flat};
+    }
+
+    void grow() {
+        std::vector<Slot> old;
+        old.swap(slots);
+        slots.resize(old.empty() ? 64 : old.size() * 2);
+        for (const Slot& s : old) {
+            if (s.object) place(s.object, s.hash);
+        }
+    }
+};
+
+} // namespace Kava
+
+#endif // KAVA_TEXT_H
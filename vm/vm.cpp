@@ -2,14 +2,61 @@
 
 int main(int argc, char** argv) {
     if (argc < 2) {
-        std::cerr << "Uso: kavavm <arquivo.kvb>" << std::endl;
+        std::cerr << "Uso: kavavm [--dispatch=switch|threaded] [--no-superinst] [--no-native-jit] [--no-stream-kernels] [--no-simd] [--gc-threads=N] [--concurrent-gc] [--no-biased-locking] [--io-threads=N] [--snapshot=imagem] [--profile[=prefixo]] [--profile-interval=us] <arquivo.kvb>" << std::endl;
         return 1;
     }
     Kava::VM vm;
-    if (!vm.loadBytecodeFile(argv[1])) {
-        std::cerr << "Erro ao carregar: " << argv[1] << std::endl;
+    const char* file = nullptr;
+    std::string snapshot;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--dispatch=switch") {
+            vm.config.dispatch = Kava::DispatchMode::Switch;
+        } else if (arg == "--dispatch=threaded") {
+            vm.config.dispatch = Kava::DispatchMode::Threaded;
+        } else if (arg == "--no-superinst") {
+            vm.config.enableSuperinstructions = false;
+        } else if (arg == "--no-native-jit") {
+            vm.config.enableNativeJIT = false;
+        } else if (arg == "--no-stream-kernels") {
+            vm.config.enableStreamKernels = false;
+        } else if (arg == "--no-simd") {
+            vm.config.enableSimd = false;
+        } else if (arg.rfind("--gc-threads=", 0) == 0) {
+            vm.config.gcThreads = std::atoi(arg.c_str() + 13);
+        } else if (arg.rfind("--io-threads=", 0) == 0) {
+            vm.config.ioThreads = std::atoi(arg.c_str() + 13);
+        } else if (arg == "--concurrent-gc") {
+            vm.config.concurrentGC = true;
+        } else if (arg == "--no-biased-locking") {
+            vm.config.biasedLocking = false;
+        } else if (arg == "--profile") {
+            vm.config.profilePath = "kava-profile";
+        } else if (arg.rfind("--profile=", 0) == 0) {
+            vm.config.profilePath = arg.substr(10);
+        } else if (arg.rfind("--profile-interval=", 0) == 0) {
+            vm.config.profileIntervalUs = std::atoi(arg.c_str() + 19);
+        } else if (arg.rfind("--snapshot=", 0) == 0) {
+            snapshot = arg.substr(11);
+        } else {
+            file = argv[i];
+        }
+    }
+    if (!file) {
+        std::cerr << "Uso: kavavm [--dispatch=switch|threaded] [--no-superinst] [--no-native-jit] [--no-stream-kernels] [--no-simd] [--gc-threads=N] [--concurrent-gc] [--no-biased-locking] [--io-threads=N] [--snapshot=imagem] [--profile[=prefixo]] [--profile-interval=us] <arquivo.kvb>" << std::endl;
+        return 1;
+    }
+    if (!vm.loadBytecodeFile(file)) {
+        std::cerr << "Erro ao carregar: " << file;
+        if (!vm.loadError.empty()) std::cerr << " (" << vm.loadError << ")";
+        std::cerr << std::endl;
         return 1;
     }
     vm.run();
+    // Execucao de aquecimento: a imagem leva o perfil dos loops junto
+    if (!snapshot.empty() && !vm.writeSnapshot(snapshot)) {
+        std::cerr << "Erro ao gravar snapshot: " << snapshot << std::endl;
+        return 1;
+    }
     return 0;
 }
@@ -11,22 +11,45 @@
 
 #include "bytecode.h"
 #include "jit.h"
+#include "superinst.h"
+#include "kvb.h"
+#include "jit_native.h"
 #include "async.h"
+#include "simd.h"
+#include "profiler.h"
+#include "symbols.h"
+#include "files.h"
+#include "json.h"
+#include "text.h"
+#include "gfx.h"
 #include "../gc/gc.h"
 #include "../threads/threads.h"
 #include "../collections/collections.h"
 #include <vector>
 #include <string>
 #include <map>
+#include <deque>
 #include <functional>
 #include <chrono>
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <atomic>
 #include <sstream>
 #include <algorithm>
 #include <numeric>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #ifdef USE_SDL
 #include <SDL2/SDL.h>
@@ -42,77 +65,203 @@ class MethodInfo;
 // ============================================================
 // VALUE
 // ============================================================
-union ValueData {
-    int32_t i32;
-    int64_t i64;
-    float f32;
-    double f64;
-    GCObject* obj;
-    void* ptr;
-};
-
+// NaN-boxing em 8 bytes: os 16 bits altos decidem o tipo
+//   0x0000          GCObject* cru (Object, inclusive null) - o slot do Value
+//                   e o proprio GCObject**, entao o GC pode usa-lo como root
+//   0x0001          imediato: bits 32..47 = subtipo, bits 0..31 = payload
+//                   (Null, Int, Float, Lambda, Stream, Promise)
+//   0x0002..0xFFF2  double + DOUBLE_OFFSET (NaN canonicalizado)
+//   0xFFF3          Long boxeado: ponteiro para um ARRAY_LONG de 1 elemento
+//   0xFFF8..0xFFFF  Long inline de 51 bits com sinal
 struct Value {
     enum class Type : uint8_t {
-        Null, Int, Long, Float, Double, Object, Lambda
+        Null, Int, Long, Float, Double, Object, Lambda, Stream, Promise
+    };
+    
+    static constexpr uint64_t TAG_IMMEDIATE = 0x0001ULL << 48;
+    static constexpr uint64_t TAG_NULL      = TAG_IMMEDIATE | (0ULL << 32);
+    static constexpr uint64_t TAG_INT       = TAG_IMMEDIATE | (1ULL << 32);
+    static constexpr uint64_t TAG_FLOAT     = TAG_IMMEDIATE | (2ULL << 32);
+    static constexpr uint64_t TAG_LAMBDA    = TAG_IMMEDIATE | (3ULL << 32);
+    static constexpr uint64_t TAG_STREAM    = TAG_IMMEDIATE | (4ULL << 32);
+    static constexpr uint64_t TAG_PROMISE   = TAG_IMMEDIATE | (5ULL << 32);
+    static constexpr uint64_t DOUBLE_OFFSET = 0x0002ULL << 48;
+    static constexpr uint64_t TAG_LONG_BOX  = 0xFFF3ULL << 48;
+    static constexpr uint64_t TAG_LONG      = 0xFFF8ULL << 48;
+    static constexpr uint64_t POINTER_MASK  = (1ULL << 48) - 1;
+    static constexpr uint64_t LONG_MASK     = (1ULL << 51) - 1;
+    static constexpr int64_t LONG_INLINE_MIN = -(1LL << 50);
+    static constexpr int64_t LONG_INLINE_MAX = (1LL << 50) - 1;
+    static constexpr uint64_t CANONICAL_NAN = 0x7FF8000000000000ULL;
+    
+    // Payload Int/Float/Lambda/Stream/Promise = 32 bits baixos (little-endian: offset 0)
+    static constexpr int INT_PAYLOAD_OFFSET = 0;
+    
+    // Longs fora do alcance inline sao boxeados neste heap (a VM ativa o registra)
+    static inline Heap* longBoxHeap = nullptr;
+    
+    union {
+        uint64_t bits;
+        GCObject* obj;
     };
     
-    Type type;
-    ValueData data;
-    
-    Value() : type(Type::Null) { data.i64 = 0; }
-    Value(int32_t v) : type(Type::Int) { data.i32 = v; }
-    Value(int64_t v) : type(Type::Long) { data.i64 = v; }
-    Value(float v) : type(Type::Float) { data.f32 = v; }
-    Value(double v) : type(Type::Double) { data.f64 = v; }
-    Value(GCObject* v) : type(Type::Object) { data.obj = v; }
-    
-    bool isNull() const { return type == Type::Null || (type == Type::Object && data.obj == nullptr); }
-    bool isInt() const { return type == Type::Int; }
-    bool isLong() const { return type == Type::Long; }
-    bool isFloat() const { return type == Type::Float; }
-    bool isDouble() const { return type == Type::Double; }
-    bool isObject() const { return type == Type::Object; }
-    bool isLambda() const { return type == Type::Lambda; }
-    
-    int32_t asInt() const { return data.i32; }
-    int64_t asLong() const { return data.i64; }
-    float asFloat() const { return data.f32; }
-    double asDouble() const { return data.f64; }
-    GCObject* asObject() const { return data.obj; }
+    Value() : bits(TAG_NULL) {}
+    Value(int32_t v) : bits(TAG_INT | static_cast<uint32_t>(v)) {}
+    Value(int64_t v) : bits(encodeLong(v)) {}
+    Value(float v) : bits(TAG_FLOAT) {
+        uint32_t raw;
+        std::memcpy(&raw, &v, sizeof(raw));
+        bits |= raw;
+    }
+    Value(double v) {
+        uint64_t raw = CANONICAL_NAN;
+        if (v == v) std::memcpy(&raw, &v, sizeof(raw));
+        bits = raw + DOUBLE_OFFSET;
+    }
+    Value(GCObject* v) : bits(reinterpret_cast<uintptr_t>(v)) {}
+    
+    static Value lambda(int32_t index) {
+        Value v;
+        v.bits = TAG_LAMBDA | static_cast<uint32_t>(index);
+        return v;
+    }
+    
+    // Handle de um pipeline em VM::streams
+    static Value stream(int32_t index) {
+        Value v;
+        v.bits = TAG_STREAM | static_cast<uint32_t>(index);
+        return v;
+    }
+    
+    // Handle de uma promise do EventLoop (id checado por geracao)
+    static Value promise(int32_t id) {
+        Value v;
+        v.bits = TAG_PROMISE | static_cast<uint32_t>(id);
+        return v;
+    }
+    
+    bool isNull() const { return bits == TAG_NULL || bits == 0; }
+    bool isInt() const { return (bits >> 32) == (TAG_INT >> 32); }
+    bool isLong() const { return bits >= TAG_LONG || (bits >> 48) == (TAG_LONG_BOX >> 48); }
+    bool isFloat() const { return (bits >> 32) == (TAG_FLOAT >> 32); }
+    bool isDouble() const { return bits >= DOUBLE_OFFSET && bits < TAG_LONG_BOX; }
+    bool isObject() const { return (bits >> 48) == 0; }
+    bool isLambda() const { return (bits >> 32) == (TAG_LAMBDA >> 32); }
+    bool isStream() const { return (bits >> 32) == (TAG_STREAM >> 32); }
+    bool isPromise() const { return (bits >> 32) == (TAG_PROMISE >> 32); }
+    bool isBoxedLong() const { return (bits >> 48) == (TAG_LONG_BOX >> 48); }
+    
+    Type type() const {
+        if (isObject()) return Type::Object;
+        if (isDouble()) return Type::Double;
+        if (isLong()) return Type::Long;
+        switch (bits >> 32) {
+            case TAG_INT >> 32: return Type::Int;
+            case TAG_FLOAT >> 32: return Type::Float;
+            case TAG_LAMBDA >> 32: return Type::Lambda;
+            case TAG_STREAM >> 32: return Type::Stream;
+            case TAG_PROMISE >> 32: return Type::Promise;
+            default: return Type::Null;
+        }
+    }
+    
+    // asX() assume o tipo (sem checar a tag, como no caminho rapido do interpretador).
+    // Excecao: num Long boxeado os 32 bits baixos sao do ponteiro da celula,
+    // entao asInt le o valor pela celula (mesmo truncamento de toInt).
+    int32_t asInt() const {
+        if (__builtin_expect(isBoxedLong(), 0)) return static_cast<int32_t>(asLong());
+        return static_cast<int32_t>(static_cast<uint32_t>(bits));
+    }
+    int32_t asLambda() const { return asInt(); }
+    int32_t asStream() const { return asInt(); }
+    int32_t asPromise() const { return asInt(); }
+    float asFloat() const {
+        uint32_t raw = static_cast<uint32_t>(bits);
+        float f;
+        std::memcpy(&f, &raw, sizeof(f));
+        return f;
+    }
+    double asDouble() const {
+        uint64_t raw = bits - DOUBLE_OFFSET;
+        double d;
+        std::memcpy(&d, &raw, sizeof(d));
+        return d;
+    }
+    int64_t asLong() const {
+        if (bits >= TAG_LONG) return static_cast<int64_t>(bits << 13) >> 13;
+        if (isBoxedLong()) {
+            int64_t v;
+            std::memcpy(&v, boxedLongCell()->data + sizeof(int32_t), sizeof(v));
+            return v;
+        }
+        return toLong();
+    }
+    GCObject* asObject() const { return isObject() ? obj : nullptr; }
+    
+    // Slot de referencia para o root scanner (so valido se isObject())
+    GCObject** objectSlot() { return &obj; }
+    GCObject* boxedLongCell() const {
+        return reinterpret_cast<GCObject*>(static_cast<uintptr_t>(bits & POINTER_MASK));
+    }
     
     int32_t toInt() const {
-        switch (type) {
-            case Type::Int: return data.i32;
-            case Type::Long: return static_cast<int32_t>(data.i64);
-            case Type::Float: return static_cast<int32_t>(data.f32);
-            case Type::Double: return static_cast<int32_t>(data.f64);
+        switch (type()) {
+            case Type::Int: return asInt();
+            case Type::Long: return static_cast<int32_t>(asLong());
+            case Type::Float: return static_cast<int32_t>(asFloat());
+            case Type::Double: return static_cast<int32_t>(asDouble());
             default: return 0;
         }
     }
     
     int64_t toLong() const {
-        switch (type) {
-            case Type::Int: return data.i32;
-            case Type::Long: return data.i64;
-            case Type::Float: return static_cast<int64_t>(data.f32);
-            case Type::Double: return static_cast<int64_t>(data.f64);
+        switch (type()) {
+            case Type::Int: return asInt();
+            case Type::Long: return asLong();
+            case Type::Float: return static_cast<int64_t>(asFloat());
+            case Type::Double: return static_cast<int64_t>(asDouble());
             default: return 0;
         }
     }
     
     double toDouble() const {
-        switch (type) {
-            case Type::Int: return data.i32;
-            case Type::Long: return static_cast<double>(data.i64);
-            case Type::Float: return data.f32;
-            case Type::Double: return data.f64;
+        switch (type()) {
+            case Type::Int: return asInt();
+            case Type::Long: return static_cast<double>(asLong());
+            case Type::Float: return asFloat();
+            case Type::Double: return asDouble();
             default: return 0.0;
         }
     }
     
     bool toBool() const { return toInt() != 0; }
+    
+private:
+    static uint64_t encodeLong(int64_t v) {
+        if (v >= LONG_INLINE_MIN && v <= LONG_INLINE_MAX) {
+            return TAG_LONG | (static_cast<uint64_t>(v) & LONG_MASK);
+        }
+        // Sem safepoint aqui: com eden cheio a celula vai para a old gen e a
+        // coleta fica para o proximo executeInstruction
+        GCObject* cell = longBoxHeap ? longBoxHeap->allocateArrayNoGC(GCObjectType::ARRAY_LONG, 1) : nullptr;
+        if (!cell) longBoxFailure(v);
+        std::memcpy(cell->data + sizeof(int32_t), &v, sizeof(v));
+        return TAG_LONG_BOX | (reinterpret_cast<uintptr_t>(cell) & POINTER_MASK);
+    }
+    
+    // Coletar aqui moveria objetos que o chamador segura em variaveis C++,
+    // e truncar o valor corromperia o resultado sem aviso: aborta
+    [[noreturn]] static void longBoxFailure(int64_t v) {
+        std::fprintf(stderr, "KAVA: OutOfMemoryError: %s para o long %lld\n",
+                     longBoxHeap ? "old gen sem espaco" : "nenhum heap registrado",
+                     static_cast<long long>(v));
+        std::abort();
+    }
 };
 
+static_assert(sizeof(Value) == 8, "Value deve caber em 8 bytes");
+static_assert(std::is_trivially_copyable<Value>::value, "Value e copiado por memcpy/registrador");
+
 // ============================================================
 // CONSTANT POOL ENTRY
 // ============================================================
@@ -140,6 +289,8 @@ struct MethodInfo {
     std::vector<uint8_t> code;
     std::vector<KavaExceptionEntry> exceptionTable;
     int codeOffset;
+    int paramCount;  // sem o this; em script o descritor so carrega a aridade
+    int32_t nameId = -1;  // SymbolTable da VM
     
     bool isStatic() const { return accessFlags & KAVA_ACC_STATIC; }
     bool isNative() const { return accessFlags & KAVA_ACC_NATIVE; }
@@ -153,6 +304,7 @@ struct FieldInfo {
     uint16_t accessFlags;
     int offset;
     Value defaultValue;
+    int32_t nameId = -1;  // SymbolTable da VM
     
     bool isStatic() const { return accessFlags & KAVA_ACC_STATIC; }
 };
@@ -169,22 +321,44 @@ struct ClassInfo {
     std::vector<MethodInfo> methods;
     std::vector<Value> staticFieldValues;
     
+    // Layout da instancia: [int32 n][n referencias][primitivos de 8 bytes],
+    // o mesmo prefixo dos arrays de referencia que o GC ja percorre
     int instanceSize;
+    int32_t referenceFieldCount = 0;
     bool initialized;
+    int32_t nameId = -1;
+    
+    // Montadas no link (VM::layoutClass) e ordenadas pela chave: metodos
+    // proprios e herdados por (simbolo, aridade), ja com os overrides, e
+    // campos por simbolo. O miss do inline cache e uma busca binaria.
+    struct MethodSlot {
+        uint64_t key;
+        MethodInfo* method;
+    };
+    struct FieldSlot {
+        int32_t nameId;
+        const FieldInfo* field;
+    };
+    std::vector<MethodSlot> vtable;
+    std::vector<FieldSlot> fieldTable;
     
     ClassInfo() : classId(-1), superClassId(-1), instanceSize(0), initialized(false), accessFlags(0) {}
     
-    MethodInfo* findMethod(const std::string& name, const std::string& desc) {
-        for (auto& m : methods) {
-            if (m.name == name && (desc.empty() || m.descriptor == desc)) return &m;
-        }
-        return nullptr;
+    static uint64_t methodKey(int32_t nameId, int32_t argc) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(nameId)) << 32 | static_cast<uint32_t>(argc);
+    }
+    
+    MethodInfo* findMethod(int32_t nameId, int32_t argc) const {
+        const uint64_t key = methodKey(nameId, argc);
+        auto it = std::lower_bound(vtable.begin(), vtable.end(), key,
+                                   [](const MethodSlot& slot, uint64_t k) { return slot.key < k; });
+        return it != vtable.end() && it->key == key ? it->method : nullptr;
     }
     
-    FieldInfo* findField(const std::string& name) {
-        for (auto& f : fields) { if (f.name == name) return &f; }
-        for (auto& f : staticFields) { if (f.name == name) return &f; }
-        return nullptr;
+    const FieldInfo* findField(int32_t nameId) const {
+        auto it = std::lower_bound(fieldTable.begin(), fieldTable.end(), nameId,
+                                   [](const FieldSlot& slot, int32_t id) { return slot.nameId < id; });
+        return it != fieldTable.end() && it->nameId == nameId ? it->field : nullptr;
     }
     
     bool isInterface() const { return accessFlags & KAVA_ACC_INTERFACE; }
@@ -194,29 +368,32 @@ struct ClassInfo {
 // ============================================================
 // STACK FRAME
 // ============================================================
+// Os frames ficam num vetor contiguo da VM, alocado uma vez com
+// maxCallDepth entradas: chamar nao aloca. Os locais vivem em execStack a
+// partir de base (os argumentos que o caller empilhou viram os primeiros
+// locais) e os operandos do metodo continuam logo acima deles.
 struct Frame {
-    MethodInfo* method;
-    ClassInfo* classInfo;
-    std::vector<Value> locals;
-    std::vector<Value> operandStack;
-    int pc;
-    int sp;
-    Frame* caller;
-    GCObject* pendingException;
-    
-    Frame(MethodInfo* m, ClassInfo* c, Frame* parent = nullptr)
-        : method(m), classInfo(c), pc(0), sp(0), caller(parent), pendingException(nullptr) {
-        if (m) {
-            locals.resize(m->maxLocals);
-            operandStack.resize(m->maxStack);
-        }
-    }
-    
-    void push(const Value& v) { operandStack[sp++] = v; }
-    Value pop() { return operandStack[--sp]; }
-    Value& peek(int offset = 0) { return operandStack[sp - 1 - offset]; }
-    void setLocal(int index, const Value& v) { locals[index] = v; }
-    Value& getLocal(int index) { return locals[index]; }
+    MethodInfo* method = nullptr;
+    ClassInfo* classInfo = nullptr;   // null nas fn de nivel superior
+    int base = 0;                     // execStack[base] = local 0 (this nos metodos)
+    int returnPC = 0;
+    Frame* caller = nullptr;
+    GCObject* pendingException = nullptr;
+    int promise = 0;                  // fn async: a promise que o retorno resolve (0 = sincrono)
+};
+
+// ============================================================
+// COROUTINE - frame async suspenso num await
+// ============================================================
+// Sem pilha propria: o frame sai de execStack no await e so o que e dele
+// (locais e operandos, slots) fica guardado aqui ate o EventLoop acordar a
+// corrotina. A retomada recoloca os slots no topo da pilha atual.
+struct Coroutine {
+    MethodInfo* method = nullptr;
+    ClassInfo* classInfo = nullptr;
+    int promise = 0;                  // resolvida quando o corpo retornar
+    int pc = 0;                       // instrucao depois do AWAIT
+    std::vector<Value> slots;         // execStack[base..sp) na suspensao
 };
 
 using NativeMethod = std::function<Value(VM*, Frame*, const std::vector<Value>&)>;
@@ -225,14 +402,348 @@ using NativeMethod = std::function<Value(VM*, Frame*, const std::vector<Value>&)
 // LAMBDA CLOSURE
 // ============================================================
 struct LambdaClosure {
-    int codeStart;
+    int codeStart;   // primeira instrucao do corpo (depois do JMP que o pula)
+    int codeEnd;     // alvo do JMP: fim do corpo
     int paramCount;
     std::vector<Value> captures;
 };
 
+// ============================================================
+// LAMBDA KERNEL
+// ============================================================
+// Corpo de lambda que so faz aritmetica int32 sobre os parametros e le
+// globals (sem gravar fora dos proprios slots, sem alocar, sem chamadas),
+// decodificado uma vez para um programa linear. Os estagios de stream
+// avaliam o kernel direto, sem executeInstruction, e por nao tocar no
+// estado da VM ele pode rodar em varias threads ao mesmo tempo.
+class LambdaKernel {
+public:
+    static constexpr int MAX_PARAMS = 2;
+    static constexpr int MAX_STACK = 16;
+    
+    // Aceita o corpo [start, end) gerado pelo kavac (prologo de STORE_GLOBAL
+    // por parametro, do ultimo para o primeiro), inclusive superinstrucoes
+    bool compile(const std::vector<int32_t>& bc, int start, int end, int params) {
+        code.clear();
+        globalReads.clear();
+        paramCount = params;
+        if (params < 1 || params > MAX_PARAMS || start < 0 || end > static_cast<int>(bc.size()) || start >= end) {
+            return false;
+        }
+        int pc = start;
+        for (int i = params - 1; i >= 0; i--) {
+            if (pc + 1 >= end || bc[pc] != OP_STORE_GLOBAL) return false;
+            paramSlots[i] = bc[pc + 1];
+            pc += 2;
+        }
+        
+        std::unordered_map<int32_t, int32_t> insAt;   // PC do bytecode -> indice em code
+        std::vector<std::pair<size_t, int32_t>> fixups;
+        auto jump = [&](int32_t op, int32_t target) {
+            fixups.push_back({code.size(), target});
+            emit(op);
+        };
+        while (pc < end) {
+            int32_t op = bc[pc];
+            int width = 1 + instructionOperandCount(op);
+            if (pc + width > end) return false;
+            const int32_t* arg = &bc[pc + 1];
+            insAt[pc] = static_cast<int32_t>(code.size());
+            switch (op) {
+                case OP_NOP: break;
+                case OP_PUSH_INT: emit(K_CONST, arg[0]); break;
+                case OP_ICONST_M1: emit(K_CONST, -1); break;
+                case OP_ICONST_0: case OP_ICONST_1: case OP_ICONST_2:
+                case OP_ICONST_3: case OP_ICONST_4: case OP_ICONST_5:
+                    emit(K_CONST, op - OP_ICONST_0);
+                    break;
+                case OP_PUSH_TRUE: emit(K_CONST, 1); break;
+                case OP_PUSH_FALSE: emit(K_CONST, 0); break;
+                case OP_LOAD_GLOBAL: case OP_ILOAD: load(arg[0]); break;
+                case OP_STORE_GLOBAL: case OP_ISTORE: {
+                    int local = localOf(arg[0]);
+                    if (local < 0) return false;
+                    emit(K_SET_LOCAL, local);
+                    break;
+                }
+                case OP_IINC: {
+                    int local = localOf(arg[0]);
+                    if (local < 0) return false;
+                    emit(K_LOCAL, local);
+                    emit(K_CONST, arg[1]);
+                    emit(OP_IADD);
+                    emit(K_SET_LOCAL, local);
+                    break;
+                }
+                case OP_IADD: case OP_ISUB: case OP_IMUL: case OP_IDIV: case OP_IMOD:
+                case OP_IAND: case OP_IOR: case OP_IXOR: case OP_ISHL: case OP_ISHR: case OP_IUSHR:
+                case OP_IEQ: case OP_INE: case OP_ILT: case OP_ILE: case OP_IGT: case OP_IGE:
+                case OP_INEG: case OP_NOT: case OP_DUP: case OP_POP: case OP_SWAP:
+                    emit(op);
+                    break;
+                case OP_JMP: case OP_JZ: case OP_JNZ: jump(op, arg[0]); break;
+                case SUPER_LOAD_LOAD_ADD: case SUPER_LOAD_LOAD_MUL:
+                    load(arg[0]);
+                    load(arg[1]);
+                    emit(op == SUPER_LOAD_LOAD_ADD ? OP_IADD : OP_IMUL);
+                    break;
+                case SUPER_LOAD_CMP_JZ:
+                    if (!isCompare(arg[2])) return false;
+                    load(arg[0]);
+                    emit(K_CONST, arg[1]);
+                    emit(arg[2]);
+                    jump(OP_JZ, arg[3]);
+                    break;
+                case SUPER_LOAD_LOAD_CMP_JZ:
+                    if (!isCompare(arg[2])) return false;
+                    load(arg[0]);
+                    load(arg[1]);
+                    emit(arg[2]);
+                    jump(OP_JZ, arg[3]);
+                    break;
+                case SUPER_CMP_JZ:
+                    if (!isCompare(arg[0])) return false;
+                    emit(arg[0]);
+                    jump(OP_JZ, arg[1]);
+                    break;
+                case OP_IRET: emit(K_RETURN); break;
+                case OP_RET: emit(K_RETURN_ZERO); break;
+                default: return false;
+            }
+            pc += width;
+        }
+        insAt[end] = static_cast<int32_t>(code.size());
+        emit(K_RETURN_ZERO);
+        
+        for (auto& fix : fixups) {
+            auto it = insAt.find(fix.second);
+            if (it == insAt.end()) return false;
+            code[fix.first].a = it->second;
+        }
+        std::sort(globalReads.begin(), globalReads.end());
+        globalReads.erase(std::unique(globalReads.begin(), globalReads.end()), globalReads.end());
+        return verify();
+    }
+    
+    // Mesma aritmetica de executeInstruction, inclusive divisao por zero = 0
+    int32_t eval(int32_t a0, int32_t a1, const Value* globals) const {
+        int32_t locals[MAX_PARAMS] = {a0, a1};
+        int32_t stack[MAX_STACK];
+        int sp = 0;
+        size_t pc = 0;
+        for (;;) {
+            const Ins& in = code[pc++];
+            switch (in.op) {
+                case K_CONST: stack[sp++] = in.a; break;
+                case K_LOCAL: stack[sp++] = locals[in.a]; break;
+                case K_GLOBAL: stack[sp++] = globals[in.a].asInt(); break;
+                case K_SET_LOCAL: locals[in.a] = stack[--sp]; break;
+                case K_RETURN: return stack[sp - 1];
+                case K_RETURN_ZERO: return 0;
+                case OP_IADD: sp--; stack[sp - 1] = stack[sp - 1] + stack[sp]; break;
+                case OP_ISUB: sp--; stack[sp - 1] = stack[sp - 1] - stack[sp]; break;
+                case OP_IMUL: sp--; stack[sp - 1] = stack[sp - 1] * stack[sp]; break;
+                case OP_IDIV: sp--; stack[sp - 1] = stack[sp] != 0 ? stack[sp - 1] / stack[sp] : 0; break;
+                case OP_IMOD: sp--; stack[sp - 1] = stack[sp] != 0 ? stack[sp - 1] % stack[sp] : 0; break;
+                case OP_IAND: sp--; stack[sp - 1] = stack[sp - 1] & stack[sp]; break;
+                case OP_IOR:  sp--; stack[sp - 1] = stack[sp - 1] | stack[sp]; break;
+                case OP_IXOR: sp--; stack[sp - 1] = stack[sp - 1] ^ stack[sp]; break;
+                case OP_ISHL: sp--; stack[sp - 1] = stack[sp - 1] << stack[sp]; break;
+                case OP_ISHR: sp--; stack[sp - 1] = stack[sp - 1] >> stack[sp]; break;
+                case OP_IUSHR:
+                    sp--;
+                    stack[sp - 1] = static_cast<int32_t>(static_cast<uint32_t>(stack[sp - 1]) >> stack[sp]);
+                    break;
+                case OP_IEQ: case OP_INE: case OP_ILT: case OP_ILE: case OP_IGT: case OP_IGE:
+                    sp--;
+                    stack[sp - 1] = compareInt(in.op, stack[sp - 1], stack[sp]) ? 1 : 0;
+                    break;
+                case OP_INEG: stack[sp - 1] = -stack[sp - 1]; break;
+                case OP_NOT: stack[sp - 1] = stack[sp - 1] == 0 ? 1 : 0; break;
+                case OP_DUP: stack[sp] = stack[sp - 1]; sp++; break;
+                case OP_POP: sp--; break;
+                case OP_SWAP: std::swap(stack[sp - 1], stack[sp - 2]); break;
+                case OP_JMP: pc = in.a; break;
+                case OP_JZ: if (stack[--sp] == 0) pc = in.a; break;
+                case OP_JNZ: if (stack[--sp] != 0) pc = in.a; break;
+                default: return 0;
+            }
+        }
+    }
+    
+    int getParamCount() const { return paramCount; }
+    
+    // O kernel le globals[i].asInt(); so equivale ao corpo interpretado
+    // se esses globals guardam ints (o resultado pode ser um deles)
+    bool readsOnlyInts(const std::vector<Value>& globals) const {
+        for (int32_t g : globalReads) {
+            if (!globals[g].isInt()) return false;
+        }
+        return true;
+    }
+    
+private:
+    enum : int32_t {
+        K_CONST = -1,
+        K_LOCAL = -2,
+        K_GLOBAL = -3,
+        K_SET_LOCAL = -4,
+        K_RETURN = -5,
+        K_RETURN_ZERO = -6
+    };
+    
+    struct Ins {
+        int32_t op;
+        int32_t a;
+    };
+    
+    std::vector<Ins> code;
+    std::vector<int32_t> globalReads;
+    int32_t paramSlots[MAX_PARAMS] = {-1, -1};
+    int paramCount = 0;
+    
+    void emit(int32_t op, int32_t a = 0) { code.push_back({op, a}); }
+    
+    void load(int32_t slot) {
+        int local = localOf(slot);
+        if (local >= 0) {
+            emit(K_LOCAL, local);
+        } else {
+            emit(K_GLOBAL, slot);
+            globalReads.push_back(slot);
+        }
+    }
+    
+    int localOf(int32_t slot) const {
+        for (int i = 0; i < paramCount; i++) {
+            if (paramSlots[i] == slot) return i;
+        }
+        return -1;
+    }
+    
+    static bool isCompare(int32_t op) {
+        return op == OP_IEQ || op == OP_INE || op == OP_ILT || op == OP_ILE || op == OP_IGT || op == OP_IGE;
+    }
+    
+    static int stackEffect(int32_t op, int& pops) {
+        switch (op) {
+            case K_CONST: case K_LOCAL: case K_GLOBAL: pops = 0; return 1;
+            case OP_DUP: pops = 1; return 2;
+            case K_SET_LOCAL: case OP_POP: case OP_JZ: case OP_JNZ: pops = 1; return 0;
+            case OP_INEG: case OP_NOT: case K_RETURN: pops = 1; return 1;
+            case OP_SWAP: pops = 2; return 2;
+            case OP_JMP: case K_RETURN_ZERO: pops = 0; return 0;
+            default: pops = 2; return 1;  // binarias
+        }
+    }
+    
+    // Profundidade da pilha consistente em todo caminho e dentro de MAX_STACK,
+    // para que eval() nao precise checar limites
+    bool verify() const {
+        std::vector<int> depth(code.size(), -1);
+        std::vector<size_t> work = {0};
+        depth[0] = 0;
+        while (!work.empty()) {
+            size_t pc = work.back();
+            work.pop_back();
+            const Ins& in = code[pc];
+            int pops;
+            int pushes = stackEffect(in.op, pops);
+            int d = depth[pc];
+            if (d < pops) return false;
+            d = d - pops + pushes;
+            if (d > MAX_STACK) return false;
+            if (in.op == K_RETURN || in.op == K_RETURN_ZERO) continue;
+            auto flow = [&](size_t next) {
+                if (next >= code.size()) return false;
+                if (depth[next] < 0) {
+                    depth[next] = d;
+                    work.push_back(next);
+                    return true;
+                }
+                return depth[next] == d;
+            };
+            if (in.op == OP_JMP) {
+                if (!flow(in.a)) return false;
+                continue;
+            }
+            if ((in.op == OP_JZ || in.op == OP_JNZ) && !flow(in.a)) return false;
+            if (!flow(pc + 1)) return false;
+        }
+        return true;
+    }
+};
+
+// ============================================================
+// STREAM PIPELINE
+// ============================================================
+// OP_STREAM_NEW cria o pipeline; as operacoes intermediarias so anotam
+// estagios e a terminal percorre a fonte uma unica vez, empurrando cada
+// elemento por todos os estagios (sem arrays intermediarios). So sorted()
+// e barreira: o que chega nele e bufferizado, ordenado e reinjetado.
+struct StreamStage {
+    enum class Kind : uint8_t { Filter, Map, FlatMap, Skip, Limit, Distinct, Sorted };
+    Kind kind;
+    Value fn;                              // lambda (sorted: comparador opcional)
+    int64_t count = 0;                     // skip/limit
+    const LambdaKernel* kernel = nullptr;  // fn compilado, se for int32 puro
+};
+
+struct StreamPipeline {
+    Value source;
+    std::unique_ptr<FileReader> lines;     // Files.lines: fonte lida sob demanda, uma linha por vez
+    std::vector<StreamStage> stages;
+    bool parallel = false;
+    bool running = false;
+    
+    // Roots enquanto a terminal roda (lambdas interpretados podem alocar e
+    // disparar GC): entrada/saida das barreiras, arrays de flatMap em uso,
+    // acumulador e os elementos coletados por toList
+    std::vector<Value> buffer;
+    std::vector<Value> pending;
+    std::vector<Value> pinned;
+    std::vector<Value> output;
+    Value acc;
+    bool kernels = false;  // passe atual so com LambdaKernels (fonte int, sem lambdas interpretados)
+};
+
+enum class StreamTerminal : uint8_t {
+    Count, Sum, Min, Max, Reduce, ForEach, Collect, AnyMatch, AllMatch, NoneMatch, FindFirst
+};
+
+// Resultado parcial da terminal (um por chunk no modo paralelo)
+struct StreamAccumulator {
+    StreamTerminal op;
+    const StreamStage* fn;    // reduce/forEach/predicado/comparador de min e max
+    Value* value;             // min/max/reduce/findFirst
+    std::vector<Value>* out;  // collect/toList
+    int64_t count = 0;
+    int64_t longSum = 0;
+    double doubleSum = 0;
+    bool anyDouble = false;
+    bool has = false;
+    bool matched = false;     // anyMatch/noneMatch: achou; allMatch: achou contra-exemplo
+    
+    StreamAccumulator(StreamTerminal op, const StreamStage* fn, Value* value, std::vector<Value>* out)
+        : op(op), fn(fn), value(value), out(out) {}
+};
+
+// Estado dos estagios com memoria durante um passe (skip/limit/distinct)
+struct StreamPass {
+    std::vector<int64_t> counters;
+    std::vector<std::unordered_set<uint64_t>> seen;
+    
+    explicit StreamPass(size_t stages) : counters(stages, 0), seen(stages) {}
+};
+
 // ============================================================
 // VM CONFIGURATION
 // ============================================================
+enum class DispatchMode : uint8_t {
+    Switch,    // Interpretador classico: switch por instrucao
+    Threaded   // Direct-threaded code (computed goto quando disponivel)
+};
+
 struct VMConfig {
     size_t maxHeapSize = 256 * 1024 * 1024;
     size_t initialHeapSize = 16 * 1024 * 1024;
@@ -242,10 +753,51 @@ struct VMConfig {
     bool verboseGC = false;
     bool verboseClass = false;
     bool enableJIT = true;
+    bool enableSuperinstructions = true;  // fusao em tempo de carga (superinst.h)
+    bool enableNativeJIT = true;          // loops quentes -> x86-64 via OSR (jit_native.h)
+    bool enableStreamKernels = true;      // lambdas int32 puros dos streams sem o interpretador
+    bool enableSimd = true;               // reducoes e operacoes em bloco com AVX2/NEON (simd.h)
     bool enableAssertions = true;
+    bool enableProfiling = false;   // instructionsExecuted, histograma de opcodes e sites de alocacao
+    std::string profilePath;        // --profile: amostragem + <path>.folded e <path>.trace.json
+    int profileIntervalUs = 1000;   // periodo do sampler em us de CPU
+    int gcThreads = 0;              // workers do full GC paralelo (0 = nucleos da maquina)
+    bool concurrentGC = false;      // marcacao SATB da old gen em background
+    int ioThreads = 4;              // pool de IO do EventLoop (criado no primeiro queueIO)
+    bool biasedLocking = true;      // synchronized sem CAS para a thread que travou o objeto primeiro
+    DispatchMode dispatch = DispatchMode::Threaded;
     OptLevel optLevel = OptLevel::O1;
 };
 
+// ============================================================
+// MONITORES DOS OBJETOS DO HEAP
+// ============================================================
+// A palavra de lock vive no GCHeader de objetos moveis: so mutadoras
+// registradas recebem bias (param nos safepoints), a revogacao para o mundo
+// e quem bloqueia num monitor inflado sai do caminho do GC
+class HeapMonitorRuntime : public MonitorRuntime {
+public:
+    HeapMonitorRuntime(Heap& h, const bool& biasEnabled) : heap(h), bias(biasEnabled) {}
+    
+    bool canBias() override { return bias && MutatorThread::of(heap); }
+    
+    bool atSafepoint(const std::function<void()>& fn) override {
+        if (!heap.stopTheWorld()) return false;
+        fn();
+        heap.resumeTheWorld();
+        return true;
+    }
+    
+    void blocking(const std::function<void()>& wait) override {
+        Heap::BlockingRegion region(heap);
+        wait();
+    }
+    
+private:
+    Heap& heap;
+    const bool& bias;
+};
+
 // ============================================================
 // VIRTUAL MACHINE
 // ============================================================
@@ -255,50 +807,127 @@ public:
     Heap heap;
     GarbageCollector gc;
     JITCompiler jit;
+    SuperinstructionPass superinst;
+    NativeJIT nativeJIT;
     EventLoop eventLoop;
+    MonitorTable monitors;              // Monitores inflados dos objetos deste heap
+    HeapMonitorRuntime monitorRuntime{heap, config.biasedLocking};
     
-    std::map<std::string, ClassInfo*> classes;
-    std::map<int32_t, ClassInfo*> classById;
+    // Nomes internados em ids densos; classByName indexa pelo id do nome
+    SymbolTable symbolTable;
+    std::vector<ClassInfo*> classByName;
     int32_t nextClassId = 1;
     
     std::vector<ConstantPoolEntry> constantPool;
+    // Registro por nome; OP_NATIVE usa nativeTable, resolvida no registro
+    // (um ponteiro por id de NATIVE_SIGNATURES)
     std::map<std::string, NativeMethod> nativeMethods;
+    std::vector<const NativeMethod*> nativeTable = std::vector<const NativeMethod*>(NATIVE_COUNT, nullptr);
+    std::deque<std::vector<Value>> nativeArgs;  // Argumentos de OP_NATIVE por nivel de aninhamento
+    size_t nativeDepth = 0;
     
     std::vector<Value> globals;
-    std::map<std::string, int> globalNames;
     int nextGlobalIndex = 0;
     
-    std::map<std::string, GCObject*> internedStrings;
+    // Strings internadas por conteudo (enderecamento aberto, roots do GC),
+    // pilha de trabalho da descida pelos ropes e texto temporario das
+    // conversoes de valores em String
+    StringInternTable internedStrings;
+    std::vector<GCObject*> ropeStack;
+    std::string textScratch;
+    
+    // Ids (SymbolTable) dos metodos embutidos de String e StringBuilder
+    struct StringSelectors {
+        int32_t length, charAt, isEmpty, equals, hashCode, toString, intern, append, clear;
+    } stringSelectors{};
     
     // Lambda closures
     std::vector<LambdaClosure> lambdaClosures;
     
-    // String constant pool
+    // Programa do bloco de metadados do .kvb: CALL indexa functions,
+    // NEW/INVOKESPEC indexam programClasses e os simbolos nomeiam campos e
+    // metodos (symbolIds leva o indice do .kvb ao id da SymbolTable);
+    // classTable resolve o classId do header em O(1)
+    std::vector<std::string> symbols;
+    std::vector<int32_t> symbolIds;
+    std::vector<MethodInfo> functions;
+    std::vector<std::unique_ptr<ClassInfo>> programClasses;
+    std::vector<ClassInfo*> classTable;
+    
+    // String constant pool; stringConstants guarda a instancia interned de
+    // cada indice (criada no primeiro PUSH_STRING, raiz do GC)
     std::vector<std::string> stringPool;
+    std::vector<GCObject*> stringConstants;
     
+    // Chamadas: currentFrame = &frames[frameCount - 1], ou null no nivel
+    // superior; localsBase e o base do frame atual
+    std::vector<Frame> frames;
+    int frameCount = 0;
+    int localsBase = 0;
     Frame* currentFrame = nullptr;
     bool running = false;
+    
+    // Corrotinas suspensas em await; o id e o indice (livres reaproveitados)
+    std::vector<Coroutine> coroutines;
+    std::vector<int32_t> freeCoroutines;
     GCObject* thrownException = nullptr;
     
     uint64_t instructionsExecuted = 0;
     uint64_t methodCalls = 0;
     uint64_t objectsAllocated = 0;
     std::chrono::high_resolution_clock::time_point startTime;
+    Profiler profiler;
     
 #ifdef USE_SDL
     SDL_Window* window = nullptr;
     SDL_Renderer* renderer = nullptr;
 #endif
+    // Comandos do frame corrente; GFX_PRESENT desenha o lote e zera
+    GfxBatch gfxFrame;
+    bool gfxExplicitPresent = false;  // programa chama GFX_PRESENT
+    std::vector<int32_t> gfxEventScratch;
+    
+    // Threads do full GC paralelo, criadas no primeiro full GC que as usa
+    std::unique_ptr<ForkJoinPool> gcPool;
+    
+    void runGCWorkers(int n, const std::function<void(int)>& body) {
+        if (!gcPool || gcPool->getPoolSize() < n - 1) gcPool = std::make_unique<ForkJoinPool>(n - 1);
+        CountDownLatch latch(n - 1);
+        for (int i = 1; i < n; i++) {
+            gcPool->execute([&body, &latch, i] {
+                body(i);
+                latch.countDown();
+            });
+        }
+        body(0);  // A thread da VM e o worker 0
+        latch.await();
+    }
 
 public:
     VM() : gc(heap) {
         heap.initialize({config.initialHeapSize, config.maxHeapSize});
         globals.resize(4096);
         jit.optLevel = config.optLevel;
+        nativeJIT.layout.stride = sizeof(Value);
+        nativeJIT.layout.payloadOffset = Value::INT_PAYLOAD_OFFSET;
+        nativeJIT.maxGlobals = globals.size();
+        Value::longBoxHeap = &heap;
+        gc.setRootScanner([this](const GarbageCollector::RootVisitor& visit) { scanRoots(visit); });
+        gc.setWorkerRunner([this](int n, const std::function<void(int)>& body) { runGCWorkers(n, body); });
+        eventLoop.setResumeHook([this](int32_t co, int promiseId) { resumeCoroutine(co, promiseId); });
+        eventLoop.setBlockingHook([this](const std::function<void()>& wait) { monitorRuntime.blocking(wait); });
+        gc.setPauseListener([this](const char* kind, double ms) {
+            if (config.enableProfiling) profiler.recordGCPause(kind, ms);
+        });
+        gc.setFullGCListener([this] { sweepMonitors(); });
+        stringSelectors = {symbolTable.intern("length"), symbolTable.intern("charAt"), symbolTable.intern("isEmpty"),
+                           symbolTable.intern("equals"), symbolTable.intern("hashCode"), symbolTable.intern("toString"),
+                           symbolTable.intern("intern"), symbolTable.intern("append"), symbolTable.intern("clear")};
         registerBuiltinNatives();
     }
     
     ~VM() {
+        if (Value::longBoxHeap == &heap) Value::longBoxHeap = nullptr;
 #ifdef USE_SDL
         if (renderer) SDL_DestroyRenderer(renderer);
         if (window) SDL_DestroyWindow(window);
@@ -316,6 +945,12 @@ public:
     bool loadBytecodeFile(const std::string& filename);
     bool loadBytecode(const std::vector<int32_t>& code);
     bool loadBytecode(const uint8_t* data, size_t length);
+    // Motivo da ultima carga recusada (vazio: arquivo ausente ou ilegivel)
+    std::string loadError;
+    bool loadFailed(const char* reason) {
+        loadError = reason;
+        return false;
+    }
     
     // ========================================
     // EXECUÇÃO
@@ -334,8 +969,61 @@ public:
     GCObject* newInstance(ClassInfo* cls);
     GCObject* newArray(int type, int32_t length);
     GCObject* newObjectArray(ClassInfo* elemClass, int32_t length);
-    GCObject* newString(const std::string& str);
-    GCObject* internString(const std::string& str);
+    GCObject* newString(std::string_view str);
+    GCObject* internString(std::string_view str);
+    GCObject* internFlat(GCObject* flat);
+    GCObject* newStringBuilder(int32_t capacity);
+    
+    // Texto de String, rope ou StringBuilder; appendText tambem formata os
+    // demais valores como o print. Nenhum dos dois aloca no heap.
+    void appendText(std::string& out, Value v);
+    std::string textOf(Value v);
+    // Files.read*: open + mmap numa BlockingRegion (o caminho sai do heap antes)
+    MappedFile mapFile(Value path) {
+        const std::string name = textOf(path);
+        Heap::BlockingRegion region(heap);
+        return MappedFile(name);
+    }
+    // Json.stringify: numeros, texto, arrays e instancias (campo a campo)
+    void appendJson(JsonWriter& w, Value v, int depth = 0);
+    
+    // Operam sobre slots da pilha de operandos: o valor continua root
+    // enquanto as alocacoes movem objetos
+    void concatStrings();                                // OP_SCONCAT
+    void addValues();                                    // OP_IADD com referencia de um lado
+    void addToGlobal(int32_t idx, Value a, Value b);     // IINC e SUPER_GLOBAL_ADD
+    static Value intArith(int32_t op, Value a, Value b); // IADD/ISUB/IMUL numericos
+    void presentFrame();                                 // OP_GFX_PRESENT
+    GCObject* drainGfxEvents();                          // OP_GFX_EVENTS
+    GCObject* textAt(int32_t slot);                      // vira String ou rope
+    GCObject* flatAt(int32_t slot);                      // vira String plana (achata ropes)
+    bool textEquals(int32_t a, int32_t b);
+    bool builderAppend(int32_t builderSlot, int32_t valueSlot);
+    bool invokeStringMethod(int32_t selector, int32_t argc);
+    
+    // Toda gravacao de referencia dentro de um objeto do heap passa por aqui
+    // (SATB para a marcacao concorrente, card marking para a minor GC)
+    void storeReference(GCObject* holder, GCObject** slot, GCObject* ref) {
+        gc.preWriteBarrier(*slot);
+        __atomic_store_n(slot, ref, __ATOMIC_RELAXED);
+        gc.writeBarrier(holder, slot, ref);
+    }
+    
+    // Tenta alocar; com o heap cheio coleta e tenta uma segunda vez. A coleta
+    // acontece antes do objeto existir, entao o ponteiro devolvido e valido.
+    template<typename Alloc>
+    GCObject* allocateOrCollect(Alloc&& alloc) {
+        GCObject* obj = alloc();
+        if (!obj && config.enableGC) {
+            collectGarbage();
+            obj = alloc();
+        }
+        if (obj) {
+            objectsAllocated++;
+            if (config.enableProfiling) profiler.recordAllocation(obj->header.size);
+        }
+        return obj;
+    }
     
     // ========================================
     // EXCEÇÕES
@@ -348,6 +1036,7 @@ public:
     // MÉTODOS NATIVOS
     // ========================================
     void registerNative(const std::string& signature, NativeMethod method);
+    const NativeMethod* nativeById(int32_t id);
     void registerBuiltinNatives();
     
     // ========================================
@@ -355,9 +1044,9 @@ public:
     // ========================================
     ClassInfo* getClass(int32_t classId);
     ClassInfo* getClass(const std::string& name);
-    int getGlobalIndex(const std::string& name);
     
     void collectGarbage();
+    void scanRoots(const GarbageCollector::RootVisitor& visit);
     void printStats();
     
     // ========================================
@@ -368,12 +1057,35 @@ public:
         jit.optLevel = level; 
     }
 
+    // Linha do fonte do statement que contem pc (0 = sem tabela de linhas)
+    int sourceLine(int pc) const;
+    
+    // Imagem com o programa carregado e o perfil do JIT; carregada de volta
+    // por loadBytecodeFile como qualquer .kvb
+    bool writeSnapshot(const std::string& filename) const;
+    
+    // Relatorio do --profile: arquivos em config.profilePath e resumo no stderr
+    void writeProfile();
+
 private:
     std::vector<int32_t> scriptBytecode;
     int scriptPC = 0;
     
+    // Secao LINES do .kvb, com os pcs ja relocados pelas superinstrucoes
+    std::vector<KvbLine> lineTable;
+    // Bloco de metadados sem os simbolos, como carregado (para o snapshot)
+    std::vector<int32_t> programWords;
+    
     void executeScriptMode();
+    void executeThreaded();
+    
+    // Handler do SIGPROF (na thread da VM): copia a pilha de frames sem alocar
+    static void sampleStack(Profiler& profiler, void* vm);
+    int osrEnter(int target, ProfileData& profile);
     
+    // Fim do full GC (mundo parado): devolve os monitores de objetos mortos
+    void sweepMonitors();
+
     // Execution stack for script mode
     std::vector<Value> execStack;
     int execSP = 0;
@@ -382,40 +1094,203 @@ private:
     inline Value stackPop() { return execStack[--execSP]; }
     inline Value& stackPeek() { return execStack[execSP - 1]; }
     
+    // Inline cache polimorfico de um site (INVOKE, INVOKESPEC, GETFIELD,
+    // PUTFIELD): ate WAYS classes de receptor, com a via seguinte substituida
+    // em rodizio quando cheio. O slow path (busca binaria na vtable ou na
+    // fieldTable da classe) so roda no miss; o alvo nao encontrado tambem fica
+    // cacheado.
     struct InlineCache {
-        ClassInfo* cachedClass;
-        MethodInfo* cachedMethod;
-        int callSite;
+        static constexpr int WAYS = 4;
+        ClassInfo* classes[WAYS] = {};
+        MethodInfo* methods[WAYS] = {};
+        const FieldInfo* fields[WAYS] = {};
+        uint8_t count = 0;
+        uint8_t victim = 0;
     };
     std::vector<InlineCache> inlineCaches;
     
+    struct InlineCacheStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+    InlineCacheStats icStats;
+    
+    // Folga acima dos locais para os operandos do metodo chamado
+    static constexpr int FRAME_STACK_RESERVE = 256;
+    
+    bool loadProgram(const int32_t* words, size_t count, std::vector<std::string>* pool = nullptr);
+    bool installCode(std::vector<int32_t> code);
+    bool restoreSnapshot(const KvbImage& image, std::vector<KvbLine> lines);
+    void layoutClass(ClassInfo* cls, std::vector<int>& state);
+    bool enterFrame(MethodInfo* method, ClassInfo* cls, int argc);
+    void leaveFrame(Value result);
+    void awaitValue(Value handle);
+    void suspendFrame(int promiseId);
+    void resumeCoroutine(int32_t id, int promiseId);
+    void callFunction(int32_t index, int32_t argc);
+    void invokeVirtual(int32_t selector, int32_t argc, int32_t site);
+    void invokeSpecial(int32_t classIndex, int32_t selector, int32_t argc, int32_t site);
+    ClassInfo* instanceClass(GCObject* obj) const;
+    ClassInfo* programClass(int32_t index) const;
+    int cacheWay(InlineCache& ic, ClassInfo* cls);
+    MethodInfo* lookupMethod(int32_t site, ClassInfo* cls, int32_t selector, int32_t argc);
+    const FieldInfo* lookupField(int32_t site, ClassInfo* cls, int32_t selector);
+    Value loadField(GCObject* obj, const FieldInfo& field);
+    void storeField(GCObject* obj, const FieldInfo& field, Value v);
+    
     // Lambda execution
     Value executeLambda(int lambdaIdx, const std::vector<Value>& args);
+    
+    // Stream pipelines: o handle (Value::stream) indexa streams; o slot volta
+    // para freeStreams quando a terminal termina
+    std::vector<std::unique_ptr<StreamPipeline>> streams;
+    std::vector<int32_t> freeStreams;
+    // Kernels por codeStart do lambda (nullptr = corpo nao compilavel)
+    std::unordered_map<int, std::unique_ptr<LambdaKernel>> lambdaKernels;
+    
+    // Abaixo disso (ou sem workers) o modo paralelo roda sequencial
+    static constexpr int32_t STREAM_PARALLEL_MIN = 8192;
+    static constexpr int32_t STREAM_CHUNK_MIN = 2048;
+    
+    int32_t newStream(Value source);
+    StreamPipeline* streamAt(Value handle);
+    const LambdaKernel* lambdaKernel(Value fn);
+    void addStreamStage(StreamStage::Kind kind, Value fn, int64_t count = 0);
+    void runStreamTerminal(StreamTerminal op, Value fn, Value identity, bool hasIdentity);
+    bool streamUsesKernels(const StreamPipeline& p, StreamTerminal op, const StreamStage& terminal);
+    void streamDrive(StreamPipeline& p, StreamAccumulator& acc);
+    bool streamRunParallel(StreamPipeline& p, StreamAccumulator& acc);
+    template<typename Sink>
+    bool streamPush(StreamPipeline& p, StreamPass& pass, size_t stage, size_t end, Value v, Sink& sink);
+    bool streamAccept(StreamPipeline& p, StreamAccumulator& acc, Value v);
+    bool streamPrefer(StreamPipeline& p, const StreamAccumulator& acc, Value& v);
+    void streamSort(StreamPipeline& p, const StreamStage& s);
+    Value streamCall(StreamPipeline& p, const StreamStage& s, Value& v);
+    Value streamCall2(StreamPipeline& p, const StreamStage& s, Value a, Value b);
+    Value streamResult(StreamAccumulator& acc);
+    GCObject* streamToArray(const std::vector<Value>& items);
+    bool streamReduceArray(StreamPipeline& p, StreamAccumulator& acc);
+    int streamChunkCount(const StreamPipeline& p, int32_t n);
+    template<typename Body>
+    void streamParallelFor(int chunks, Body&& body);
+    
+    // Arrays: elementos tipados e operacoes em bloco dos natives
+    // System.arraycopy/Arrays.*; argumentos invalidos sao ignorados
+    const Simd::Kernels& simd() const { return config.enableSimd ? Simd::best() : Simd::scalar(); }
+    Value arrayLoad(GCObject* arr, int32_t index);
+    void arrayStore(GCObject* arr, int32_t index, Value v);
+    void arrayCopy(GCObject* src, int32_t srcPos, GCObject* dst, int32_t dstPos, int32_t length);
+    void arrayFill(GCObject* arr, int32_t from, int32_t to, Value v);
+    int32_t arrayMismatch(GCObject* a, GCObject* b);
 };
 
 // ============================================================
 // IMPLEMENTATION
 // ============================================================
 
+// O .kvb e mapeado e decodificado direto das paginas (sem ler o arquivo
+// para um buffer intermediario); o mapeamento so vive durante a carga
 inline bool VM::loadBytecodeFile(const std::string& filename) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file) return false;
+    MappedFile image(filename);
+    if (!image.isOpen() || image.size() == 0) return false;
+    return loadBytecode(image.bytes(), image.size());
+}
+
+// .kvb em secoes (kvb.h); sem o cabecalho, palavras int32 cruas
+inline bool VM::loadBytecode(const uint8_t* data, size_t length) {
+    KvbImage kvb;
+    if (!kvb.parse(data, length)) {
+        std::vector<int32_t> words(length / sizeof(int32_t));
+        std::memcpy(words.data(), data, words.size() * sizeof(int32_t));
+        return loadBytecode(words);
+    }
     
-    std::vector<int32_t> code;
-    int32_t op;
-    while (file.read(reinterpret_cast<char*>(&op), sizeof(int32_t))) {
-        code.push_back(op);
+    if (kvb.has(KVB_SECTION_PROGRAM)) {
+        KvbReader pool = kvb.reader(KVB_SECTION_POOL);
+        const int32_t symbols = pool.varint();
+        std::vector<std::string> names;
+        if (pool.fits(static_cast<uint32_t>(std::max(symbols, 0)))) {
+            names.resize(static_cast<size_t>(std::max(symbols, 0)));
+            for (auto& name : names) {
+                int32_t len = pool.varint();
+                name = pool.bytes(static_cast<size_t>(std::max(len, 0)));
+            }
+        }
+        if (!pool.ok) return loadFailed("secao POOL corrompida");
+        KvbReader program = kvb.reader(KVB_SECTION_PROGRAM);
+        std::vector<int32_t> words = program.words(kvb.count(KVB_SECTION_PROGRAM));
+        if (!program.ok) return loadFailed("secao PROGRAM corrompida: contagem maior que a secao");
+        if (!loadProgram(words.data(), words.size(), &names)) return loadFailed("metadados do programa invalidos");
+    }
+    
+    std::vector<KvbLine> lines;
+    KvbReader table = kvb.reader(KVB_SECTION_LINES);
+    KvbLine at{0, 0};
+    for (uint32_t n = kvb.count(KVB_SECTION_LINES); n > 0 && table.fits(n); n--) {
+        at.pc += table.varint();
+        at.line += table.varint();
+        lines.push_back(at);
+    }
+    
+    if (kvb.has(KVB_SECTION_IMAGE)) {
+        return restoreSnapshot(kvb, std::move(lines)) || loadFailed("imagem de snapshot corrompida");
     }
     
-    return loadBytecode(code);
+    KvbReader code = kvb.reader(KVB_SECTION_CODE);
+    std::vector<int32_t> words = code.code(kvb.count(KVB_SECTION_CODE));
+    if (!code.ok) return loadFailed("secao CODE corrompida: contagem maior que a secao");
+    if (!installCode(std::move(words))) return loadFailed("codigo invalido");
+    lineTable = std::move(lines);
+    
+    // Os pcs da tabela contam palavras do codigo original
+    if (config.enableSuperinstructions) {
+        const auto& moved = superinst.relocation;
+        for (auto& l : lineTable) {
+            l.pc = (l.pc >= 0 && l.pc < static_cast<int>(moved.size())) ? moved[l.pc] : -1;
+        }
+        lineTable.erase(std::remove_if(lineTable.begin(), lineTable.end(),
+                                       [](const KvbLine& l) { return l.pc < 0; }),
+                        lineTable.end());
+    }
+    return true;
+}
+
+inline bool VM::loadBytecode(const std::vector<int32_t>& input) {
+    // Funcoes e classes vem num bloco antes do codigo (ver bytecode.h)
+    size_t codeStart = 0;
+    if (input.size() >= 2 && input[0] == static_cast<int32_t>(KAVA_BYTECODE_MAGIC)) {
+        size_t words = static_cast<uint32_t>(input[1]);
+        if (words > input.size() - 2) return loadFailed("metadados maiores que a imagem");
+        if (!loadProgram(input.data() + 2, words)) return loadFailed("metadados do programa invalidos");
+        codeStart = 2 + words;
+    }
+    lineTable.clear();
+    return installCode(std::vector<int32_t>(input.begin() + codeStart, input.end())) || loadFailed("codigo invalido");
 }
 
-inline bool VM::loadBytecode(const std::vector<int32_t>& code) {
-    scriptBytecode = code;
+inline bool VM::installCode(std::vector<int32_t> code) {
     scriptPC = 0;
     
-    // JIT optimization is applied per-loop at runtime, not ahead-of-time
-    // This preserves jump addresses in the original bytecode
+    // Superinstrucoes sao fundidas uma vez aqui; a tabela de relocacao do
+    // passe reescreve todos os alvos de salto, entao o stream resultante e
+    // autocontido. A otimizacao por loop do JIT continua em tempo de execucao.
+    if (config.enableSuperinstructions) {
+        scriptBytecode = superinst.run(code);
+        // Entradas de fn/metodo sempre sao inicio de instrucao mantida
+        auto relocate = [this](MethodInfo& m) {
+            const auto& moved = superinst.relocation;
+            m.codeOffset = (m.codeOffset >= 0 && m.codeOffset < static_cast<int>(moved.size()))
+                ? moved[m.codeOffset] : -1;
+        };
+        for (auto& fn : functions) relocate(fn);
+        for (auto& cls : programClasses) {
+            for (auto& m : cls->methods) relocate(m);
+        }
+    } else {
+        scriptBytecode = std::move(code);
+    }
+    
     if (config.enableJIT) {
         jit.detectLoops(scriptBytecode);
     }
@@ -423,58 +1298,893 @@ inline bool VM::loadBytecode(const std::vector<int32_t>& code) {
     return true;
 }
 
-inline void VM::run() {
-    startTime = std::chrono::high_resolution_clock::now();
-    running = true;
-    
-    if (!scriptBytecode.empty()) {
-        executeScriptMode();
+inline int VM::sourceLine(int pc) const {
+    auto it = std::upper_bound(lineTable.begin(), lineTable.end(), pc,
+                               [](int p, const KvbLine& l) { return p < l.pc; });
+    return it == lineTable.begin() ? 0 : std::prev(it)->line;
+}
+
+// ============================================================
+// PROFILER - kavavm --profile (profiler.h)
+// ============================================================
+// Nivel k da pilha (0 = script) executa no frame k-1; o pc dele e a chamada
+// que abriu o frame k (returnPC - 1 cai dentro dela) ou, na folha, o pc que
+// o interpretador publicou. Fundo demais: ficam os niveis mais internos.
+inline void VM::sampleStack(Profiler& profiler, void* self) {
+    const VM& vm = *static_cast<const VM*>(self);
+    const int calls = vm.frameCount;
+    if (calls < 0 || calls > static_cast<int>(vm.frames.size())) return;
+    const int depth = std::min(calls + 1, Profiler::MAX_DEPTH);
+    ProfileFrame* out = profiler.reserve(depth);
+    if (!out) return;
+    const int skip = calls + 1 - depth;
+    for (int i = 0; i < depth; i++) {
+        const int level = skip + i;
+        const Frame* f = level ? &vm.frames[level - 1] : nullptr;
+        out[i].method = f ? f->method : nullptr;
+        out[i].cls = f ? f->classInfo : nullptr;
+        out[i].pc = level == calls ? profiler.pc : vm.frames[level].returnPC - 1;
     }
-    
-    // Run event loop if there's pending async work
-    if (eventLoop.hasPendingWork()) {
-        eventLoop.runFor(5000);  // max 5s
+}
+
+inline void VM::writeProfile() {
+    ProfileSymbols sym;
+    sym.function = [](const ProfileFrame& f) {
+        if (!f.method) return std::string("<script>");
+        return f.cls ? f.cls->name + "." + f.method->name : f.method->name;
+    };
+    sym.line = [this](int32_t pc) { return sourceLine(pc); };
+
+    const std::string folded = config.profilePath + ".folded";
+    const std::string trace = config.profilePath + ".trace.json";
+    profiler.printSummary(std::cerr, sym);
+
+    // Perfil do JIT: contagem por pc (cabecas de loop no threaded)
+    std::vector<std::pair<int, const ProfileData*>> hot;
+    for (const auto& [pc, data] : jit.profiles) hot.push_back({pc, &data});
+    std::sort(hot.begin(), hot.end(), [](const auto& a, const auto& b) {
+        return a.second->executionCount > b.second->executionCount;
+    });
+    if (!hot.empty()) {
+        std::cerr << "\nPerfil do JIT (pcs mais executados):" << std::endl;
+        for (size_t i = 0; i < hot.size() && i < 10; i++) {
+            const ProfileData& p = *hot[i].second;
+            const int line = sourceLine(hot[i].first);
+            std::cerr << "  " << std::setw(12) << p.executionCount << "  pc " << hot[i].first;
+            if (line > 0) std::cerr << " (linha " << line << ")";
+            std::cerr << (p.nativeLoop >= 0 ? "  nativo" : p.isHot ? "  quente" : "") << std::endl;
+        }
+    }
+
+    const bool ok = profiler.writeFolded(folded, sym) && profiler.writeTrace(trace, sym);
+    if (ok) {
+        std::cerr << "\nPerfil gravado: " << folded << ", " << trace << std::endl;
+    } else {
+        std::cerr << "\nErro ao gravar o perfil em " << config.profilePath << ".*" << std::endl;
+    }
+}
+
+inline void VM::sweepMonitors() {
+    if (monitors.inflatedCount() == 0) return;
+    std::vector<bool> live(monitors.capacity(), false);
+    heap.forEachOldObject([&live](GCObject* obj) {
+        const uint32_t w = obj->header.lockWord;
+        const uint32_t index = LockWord::monitorIndex(w);
+        if (LockWord::state(w) == LockWord::INFLATED && index < live.size()) live[index] = true;
+    });
+    monitors.sweep(live);
+}
+
+// ============================================================
+// SNAPSHOT - imagem da VM aquecida (kavavm --snapshot)
+// ============================================================
+// Guarda o que a carga e o aquecimento custam para refazer: o codigo ja
+// decodificado e fundido, o programa, a tabela de linhas relocada, os loops
+// detectados e o perfil das cabecas de loop (as quentes entram no JIT
+// nativo na primeira passada; as rejeitadas nao sao tentadas de novo).
+// Globais e objetos do heap nao entram: a imagem executa do inicio e o
+// codigo de nivel superior os inicializa de novo.
+inline bool VM::writeSnapshot(const std::string& filename) const {
+    std::vector<KvbSectionData> sections;
+    if (!programWords.empty()) {
+        sections.push_back(kvbPoolSection(symbols));
+        KvbSectionData program{KVB_SECTION_PROGRAM, static_cast<uint32_t>(programWords.size()), {}};
+        for (int32_t w : programWords) kvbPutVarint(program.data, w);
+        sections.push_back(std::move(program));
+        
+        KvbSectionData entries{KVB_SECTION_ENTRIES, 0, {}};
+        auto entry = [&](const MethodInfo& m) {
+            kvbPutVarint(entries.data, m.codeOffset);
+            entries.count++;
+        };
+        for (const auto& fn : functions) entry(fn);
+        for (const auto& cls : programClasses) {
+            for (const auto& m : cls->methods) entry(m);
+        }
+        sections.push_back(std::move(entries));
     }
     
-    auto endTime = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+    KvbSectionData code{KVB_SECTION_IMAGE, static_cast<uint32_t>(scriptBytecode.size()), {}};
+    code.data.resize(scriptBytecode.size() * sizeof(int32_t));
+    if (!scriptBytecode.empty()) std::memcpy(code.data.data(), scriptBytecode.data(), code.data.size());
+    sections.push_back(std::move(code));
+    sections.push_back(kvbLinesSection(lineTable));
     
-    if (config.verboseGC) {
-        printStats();
+    KvbSectionData loops{KVB_SECTION_LOOPS, static_cast<uint32_t>(jit.detectedLoops.size()), {}};
+    KvbSectionData profile{KVB_SECTION_PROFILE, 0, {}};
+    std::unordered_set<int> heads;
+    for (const auto& loop : jit.detectedLoops) {
+        kvbPutVarint(loops.data, loop.startPC);
+        kvbPutVarint(loops.data, loop.endPC);
+        kvbPutVarint(loops.data, loop.backEdgePC);
+        kvbPutVarint(loops.data, loop.isCountedLoop ? 1 : 0);
+        if (!heads.insert(loop.startPC).second) continue;
+        auto it = jit.profiles.find(loop.startPC);
+        if (it == jit.profiles.end()) continue;
+        const ProfileData& p = it->second;
+        kvbPutVarint(profile.data, loop.startPC);
+        kvbPutVarint(profile.data, static_cast<int32_t>(std::min<uint64_t>(p.executionCount, INT32_MAX)));
+        kvbPutVarint(profile.data, (p.isHot ? KVB_PROFILE_HOT : 0) |
+                                   (p.nativeRejected ? KVB_PROFILE_REJECTED : 0));
+        profile.count++;
     }
+    sections.push_back(std::move(loops));
+    sections.push_back(std::move(profile));
+    
+    std::vector<uint8_t> image = kvbAssemble(sections);
+    std::ofstream out(filename, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(image.data()), image.size());
+    return static_cast<bool>(out);
 }
 
-inline void VM::executeScriptMode() {
-    execStack.resize(16384);
-    execSP = 0;
+// O programa (POOL/PROGRAM) e as linhas ja foram lidos; o codigo entra
+// como esta, sem superinstrucoes nem deteccao de loops
+inline bool VM::restoreSnapshot(const KvbImage& image, std::vector<KvbLine> lines) {
+    std::vector<int32_t> code;
+    if (!image.rawWords(KVB_SECTION_IMAGE, code)) return false;
     
-    while (running && scriptPC < static_cast<int>(scriptBytecode.size())) {
-        // JIT profiling
-        if (config.enableJIT) {
-            jit.recordExecution(scriptPC);
-        }
-        executeInstruction();
+    KvbReader entries = image.reader(KVB_SECTION_ENTRIES);
+    uint32_t remaining = image.count(KVB_SECTION_ENTRIES);
+    auto entry = [&](MethodInfo& m) {
+        if (remaining == 0) { entries.ok = false; return; }
+        remaining--;
+        m.codeOffset = entries.varint();
+    };
+    for (auto& fn : functions) entry(fn);
+    for (auto& cls : programClasses) {
+        for (auto& m : cls->methods) entry(m);
+    }
+    if (image.has(KVB_SECTION_PROGRAM) && (!entries.ok || remaining != 0)) return false;
+    
+    KvbReader loops = image.reader(KVB_SECTION_LOOPS);
+    std::vector<JITCompiler::LoopInfo> detected;
+    for (uint32_t n = image.count(KVB_SECTION_LOOPS); n > 0 && loops.ok; n--) {
+        JITCompiler::LoopInfo loop;
+        loop.startPC = loops.varint();
+        loop.endPC = loops.varint();
+        loop.backEdgePC = loops.varint();
+        loop.isCountedLoop = loops.varint() != 0;
+        loop.iterationCount = 0;
+        loop.isCompiled = false;
+        detected.push_back(loop);
+    }
+    KvbReader profile = image.reader(KVB_SECTION_PROFILE);
+    std::unordered_map<int, ProfileData> profiles;
+    for (uint32_t n = image.count(KVB_SECTION_PROFILE); n > 0 && profile.ok; n--) {
+        const int pc = profile.varint();
+        ProfileData& p = profiles[pc];
+        p.executionCount = static_cast<uint32_t>(profile.varint());
+        const int32_t flags = profile.varint();
+        p.isHot = flags & KVB_PROFILE_HOT;
+        p.nativeRejected = flags & KVB_PROFILE_REJECTED;
     }
+    if (!loops.ok || !profile.ok) return false;
+    
+    scriptPC = 0;
+    scriptBytecode = std::move(code);
+    lineTable = std::move(lines);
+    jit.detectedLoops = std::move(detected);
+    jit.profiles = std::move(profiles);
+    return true;
 }
 
-inline void VM::executeInstruction() {
-    if (scriptPC >= static_cast<int>(scriptBytecode.size())) {
-        running = false;
-        return;
+// ============================================================
+// PROGRAMA - bloco de metadados do .kvb
+// ============================================================
+// pool: simbolos ja lidos da secao POOL de um .kvb em secoes (o bloco
+// entao comeca nas funcoes)
+inline bool VM::loadProgram(const int32_t* words, size_t count, std::vector<std::string>* pool) {
+    for (auto& cls : programClasses) {
+        classByName[cls->nameId] = nullptr;
+        classTable[cls->classId] = nullptr;
     }
+    symbols.clear();
+    symbolIds.clear();
+    functions.clear();
+    programClasses.clear();
+    inlineCaches.clear();
+    stringPool.clear();
+    stringConstants.clear();
     
-    int32_t opcode = scriptBytecode[scriptPC++];
-    instructionsExecuted++;
+    size_t pos = 0;
+    bool ok = true;
+    auto next = [&]() -> int32_t {
+        if (pos >= count) { ok = false; return 0; }
+        return words[pos++];
+    };
+    auto name = [&](int32_t sym) -> std::string {
+        if (sym < 0 || sym >= static_cast<int32_t>(symbols.size())) { ok = false; return std::string(); }
+        return symbols[sym];
+    };
+    auto symbolId = [&](int32_t sym) -> int32_t {
+        if (sym < 0 || sym >= static_cast<int32_t>(symbolIds.size())) { ok = false; return -1; }
+        return symbolIds[sym];
+    };
+    auto method = [&](MethodInfo& m, uint16_t flags) {
+        const int32_t sym = next();
+        m.name = name(sym);
+        m.nameId = symbolId(sym);
+        m.paramCount = next();
+        if (m.paramCount & KAVA_FN_ASYNC) {
+            m.paramCount &= ~KAVA_FN_ASYNC;
+            flags = static_cast<uint16_t>(flags | KAVA_ACC_ASYNC);
+        }
+        m.maxLocals = static_cast<uint16_t>(next());
+        m.codeOffset = next();
+        m.descriptor = "(" + std::to_string(m.paramCount) + ")";
+        m.accessFlags = flags;
+        m.maxStack = 0;
+        ok = ok && m.paramCount >= 0 && m.maxLocals >= m.paramCount;
+    };
     
-    switch (opcode) {
-        case OP_HALT:
-            running = false;
-            break;
-            
-        case OP_NOP:
-            break;
-            
-        // ========== CONSTANTES ==========
+    if (pool) symbols = std::move(*pool);
+    for (int32_t n = pool ? 0 : next(); ok && n > 0; n--) {
+        int32_t len = next();
+        size_t packed = (static_cast<size_t>(len) + 3) / 4;
+        if (len < 0 || packed > count - pos) return false;
+        symbols.emplace_back(reinterpret_cast<const char*>(words + pos), len);
+        pos += packed;
+    }
+    for (const auto& sym : symbols) symbolIds.push_back(symbolTable.intern(sym));
+    programWords.assign(words + std::min(pos, count), words + count);
+    for (int32_t n = next(); ok && n > 0; n--) {
+        functions.emplace_back();
+        method(functions.back(), KAVA_ACC_STATIC);
+    }
+    
+    std::vector<int32_t> supers;
+    for (int32_t n = next(); ok && n > 0; n--) {
+        auto cls = std::make_unique<ClassInfo>();
+        const int32_t clsSym = next();
+        cls->name = name(clsSym);
+        cls->nameId = symbolId(clsSym);
+        supers.push_back(next());
+        for (int32_t f = next(); ok && f > 0; f--) {
+            FieldInfo field;
+            const int32_t fieldSym = next();
+            field.name = name(fieldSym);
+            field.nameId = symbolId(fieldSym);
+            switch (next()) {
+                case KAVA_T_LONG: field.descriptor = "J"; break;
+                case KAVA_T_FLOAT: field.descriptor = "F"; break;
+                case KAVA_T_DOUBLE: field.descriptor = "D"; break;
+                case 0: field.descriptor = "L"; break;
+                default: field.descriptor = "I"; break;  // int, boolean, byte, char, short
+            }
+            field.accessFlags = 0;
+            field.offset = 0;
+            cls->fields.push_back(field);
+        }
+        for (int32_t m = next(); ok && m > 0; m--) {
+            cls->methods.emplace_back();
+            method(cls->methods.back(), 0);
+        }
+        cls->classId = nextClassId++;
+        programClasses.push_back(std::move(cls));
+    }
+    int32_t caches = next();
+    if (!ok || caches < 0) return false;
+    inlineCaches.resize(caches);
+    for (int32_t n = next(); ok && n > 0; n--) {
+        stringPool.push_back(name(next()));
+    }
+    if (!ok) return false;
+    stringConstants.assign(stringPool.size(), nullptr);
+    
+    if (classTable.size() < static_cast<size_t>(nextClassId)) classTable.resize(nextClassId, nullptr);
+    if (classByName.size() < static_cast<size_t>(symbolTable.size())) classByName.resize(symbolTable.size(), nullptr);
+    for (size_t i = 0; i < programClasses.size(); i++) {
+        ClassInfo* cls = programClasses[i].get();
+        ClassInfo* super = programClass(supers[i]);
+        cls->superClassId = super ? super->classId : -1;
+        classByName[cls->nameId] = cls;
+        classTable[cls->classId] = cls;
+    }
+    std::vector<int> state(nextClassId, 0);
+    for (auto& cls : programClasses) layoutClass(cls.get(), state);
+    return true;
+}
+
+// Campos herdados primeiro (na ordem da superclasse), depois os proprios;
+// as referencias ficam todas antes dos primitivos. Cada classe calcula os
+// proprios offsets, entao o offset de um campo herdado pode mudar na
+// subclasse: GETFIELD/PUTFIELD resolvem pela classe do receptor (cacheado).
+// A vtable parte da vtable da superclasse; metodo proprio com o mesmo nome
+// e aridade a substitui (o primeiro declarado vence dentro da classe).
+inline void VM::layoutClass(ClassInfo* cls, std::vector<int>& state) {
+    if (state[cls->classId] != 0) return;  // pronta, ou ciclo no extends
+    state[cls->classId] = 1;
+    std::vector<FieldInfo> all;
+    std::vector<ClassInfo::MethodSlot> vtable;
+    if (ClassInfo* super = getClass(cls->superClassId)) {
+        layoutClass(super, state);
+        if (state[super->classId] == 2) {
+            all = super->fields;
+            vtable = super->vtable;
+        }
+    }
+    for (auto& f : cls->fields) {
+        bool shadowed = false;
+        for (auto& inherited : all) shadowed = shadowed || inherited.nameId == f.nameId;
+        if (!shadowed) all.push_back(f);
+    }
+    
+    int32_t refs = 0;
+    for (auto& f : all) refs += f.descriptor == "L";
+    int32_t nextRef = 0, nextPrim = 0;
+    for (auto& f : all) {
+        int slot = f.descriptor == "L" ? nextRef++ : refs + nextPrim++;
+        f.offset = static_cast<int>(sizeof(int32_t) + slot * sizeof(uint64_t));
+    }
+    cls->fields = std::move(all);
+    cls->referenceFieldCount = refs;
+    cls->instanceSize = static_cast<int>(sizeof(int32_t) + cls->fields.size() * sizeof(uint64_t));
+    
+    const auto inherited = static_cast<std::ptrdiff_t>(vtable.size());
+    auto byKey = [](const ClassInfo::MethodSlot& x, const ClassInfo::MethodSlot& y) { return x.key < y.key; };
+    std::unordered_set<uint64_t> declared;
+    for (auto& m : cls->methods) {
+        const ClassInfo::MethodSlot slot{ClassInfo::methodKey(m.nameId, m.paramCount), &m};
+        if (!declared.insert(slot.key).second) continue;
+        auto end = vtable.begin() + inherited;
+        auto it = std::lower_bound(vtable.begin(), end, slot, byKey);
+        if (it != end && it->key == slot.key) it->method = &m;
+        else vtable.push_back(slot);
+    }
+    std::sort(vtable.begin(), vtable.end(), byKey);
+    cls->vtable = std::move(vtable);
+    
+    cls->fieldTable.clear();
+    for (auto* list : {&cls->fields, &cls->staticFields}) {
+        for (const auto& f : *list) {
+            bool seen = false;
+            for (const auto& slot : cls->fieldTable) seen = seen || slot.nameId == f.nameId;
+            if (!seen) cls->fieldTable.push_back({f.nameId, &f});
+        }
+    }
+    std::stable_sort(cls->fieldTable.begin(), cls->fieldTable.end(),
+                     [](const ClassInfo::FieldSlot& a, const ClassInfo::FieldSlot& b) { return a.nameId < b.nameId; });
+    state[cls->classId] = 2;
+}
+
+inline void VM::run() {
+    startTime = std::chrono::high_resolution_clock::now();
+    running = true;
+    if (!config.profilePath.empty()) config.enableProfiling = true;
+    heap.config.parallelGCThreads = config.gcThreads;
+    heap.config.concurrentMark = config.concurrentGC;
+    eventLoop.setIOThreads(config.ioThreads);
+    MutatorThread mutator(heap);  // Interpretador aloca no proprio TLAB
+    
+    if (!scriptBytecode.empty()) {
+        executeScriptMode();
+    }
+    
+    // Run event loop if there's pending async work (o HALT do script parou
+    // a VM; as corrotinas retomadas pelo loop precisam dela rodando)
+    if (eventLoop.hasPendingWork()) {
+        running = true;
+        eventLoop.runFor(5000);  // max 5s
+    }
+    
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+    
+    if (!config.profilePath.empty()) {
+        profiler.stop();
+        writeProfile();
+    }
+    
+    if (config.verboseGC) {
+        printStats();
+    }
+}
+
+inline void VM::executeScriptMode() {
+    execStack.resize(std::max<size_t>(16384, config.maxStackSize / sizeof(Value)));
+    execSP = 0;
+    frames.assign(std::max(config.maxCallDepth, 1), Frame());
+    frameCount = 0;
+    localsBase = 0;
+    currentFrame = nullptr;
+    
+    // Depois do assign: o handler le frames
+    if (!config.profilePath.empty() && !profiler.start(config.profileIntervalUs, &VM::sampleStack, this)) {
+        std::cerr << "Aviso: amostragem indisponivel nesta plataforma; so contadores no perfil" << std::endl;
+    }
+
+    if (config.dispatch == DispatchMode::Threaded) {
+        executeThreaded();
+        return;
+    }
+
+    const bool native = config.enableJIT && config.enableNativeJIT;
+    while (running && scriptPC < static_cast<int>(scriptBytecode.size())) {
+        // JIT profiling
+        if (config.enableJIT) {
+            ProfileData& profile = jit.recordExecution(scriptPC);
+            if (native && profile.isHot) scriptPC = osrEnter(scriptPC, profile);
+            if (scriptPC >= static_cast<int>(scriptBytecode.size())) break;
+        }
+        executeInstruction();
+    }
+}
+
+// ============================================================
+// OSR - entrada no codigo nativo pela cabeca de um loop quente
+// ============================================================
+// Compila na primeira vez que a cabeca fica quente (regioes rejeitadas nao
+// sao tentadas de novo). O codigo nativo so le/escreve globais e devolve o
+// PC onde o interpretador deve continuar; a pilha de operandos da VM nao e
+// tocada. Devolve target quando nao ha codigo nativo para este PC.
+inline int VM::osrEnter(int target, ProfileData& profile) {
+    if (profile.nativeLoop < 0) {
+        if (profile.nativeRejected) return target;
+        profile.nativeRejected = true;
+
+        int end = -1;
+        for (const auto& loop : jit.detectedLoops) {
+            if (loop.startPC == target) end = std::max(end, loop.endPC);
+        }
+        if (end <= target) return target;
+
+        auto t0 = std::chrono::high_resolution_clock::now();
+        profiler.state = Profiler::COMPILE;
+        int idx = nativeJIT.compile(scriptBytecode, target, end);
+        profiler.state = Profiler::INTERPRETER;
+        auto t1 = std::chrono::high_resolution_clock::now();
+        if (idx < 0) return target;
+
+        profile.nativeRejected = false;
+        profile.nativeLoop = idx;
+        profile.isCompiled = true;
+        jit.stats.compilations++;
+        jit.stats.compiledCodeSize += nativeJIT.loops[idx].codeSize;
+        jit.stats.totalCompileTimeUs +=
+            std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+    }
+
+    auto& loop = nativeJIT.loops[profile.nativeLoop];
+    for (int32_t g : loop.globalsUsed) {
+        if (!globals[g].isInt()) {
+            jit.stats.deoptimizations++;
+            return target;
+        }
+    }
+    loop.entries++;
+    profiler.state = Profiler::NATIVE;
+    int exitPC;
+    {
+        // O codigo nativo nao tem safepoint, mas so grava os 32 bits baixos
+        // de globais Int, nunca o heap: roda como bloqueio, entao um
+        // stopTheWorld de outra mutadora nao espera o loop acabar. Na saida
+        // a regiao estaciona se o mundo estiver parado (o chamador sincroniza
+        // execSP: a coleta percorre a pilha enquanto o loop roda).
+        Heap::BlockingRegion region(heap);
+        exitPC = loop.entry(globals.data());
+    }
+    profiler.state = Profiler::INTERPRETER;
+    return exitPC;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define KAVA_COMPUTED_GOTO 1
+#endif
+
+// ============================================================
+// THREADED DISPATCH
+// ============================================================
+// Pre-decodifica scriptBytecode em uma tabela paralela de enderecos de
+// handler (um por palavra, indexada pelo mesmo PC), entao os operandos
+// continuam em scriptBytecode e os alvos de salto nao precisam de
+// relocacao. Opcodes frios caem em executeInstruction() via slow path.
+// O perfil do JIT so e alimentado nos back-edges (cabecas de loop).
+inline void VM::executeThreaded() {
+#ifdef KAVA_COMPUTED_GOTO
+    const int size = static_cast<int>(scriptBytecode.size());
+    if (size == 0) return;
+
+    static constexpr int TABLE_SIZE = 0x220;  // cobre OpCode + SuperOp
+    const void* table[TABLE_SIZE];
+    for (auto& entry : table) entry = &&op_SLOW;
+
+    table[OP_HALT] = &&op_HALT;
+    table[OP_NOP] = &&op_NOP;
+    table[OP_PUSH_NULL] = &&op_PUSH_NULL;
+    table[OP_PUSH_TRUE] = &&op_PUSH_TRUE;
+    table[OP_PUSH_FALSE] = &&op_PUSH_FALSE;
+    table[OP_PUSH_INT] = &&op_PUSH_INT;
+    table[OP_ICONST_M1] = &&op_ICONST;
+    for (int op = OP_ICONST_0; op <= OP_ICONST_5; op++) table[op] = &&op_ICONST;
+    table[OP_POP] = &&op_POP;
+    table[OP_DUP] = &&op_DUP;
+    table[OP_SWAP] = &&op_SWAP;
+    table[OP_IADD] = &&op_IADD;
+    table[OP_ISUB] = &&op_ISUB;
+    table[OP_IMUL] = &&op_IMUL;
+    table[OP_IDIV] = &&op_IDIV;
+    table[OP_IMOD] = &&op_IMOD;
+    table[OP_INEG] = &&op_INEG;
+    table[OP_IINC] = &&op_IINC;
+    table[OP_IEQ] = &&op_IEQ;
+    table[OP_INE] = &&op_INE;
+    table[OP_ILT] = &&op_ILT;
+    table[OP_ILE] = &&op_ILE;
+    table[OP_IGT] = &&op_IGT;
+    table[OP_IGE] = &&op_IGE;
+    table[OP_IAND] = &&op_IAND;
+    table[OP_IOR] = &&op_IOR;
+    table[OP_IXOR] = &&op_IXOR;
+    table[OP_ISHL] = &&op_ISHL;
+    table[OP_ISHR] = &&op_ISHR;
+    table[OP_IUSHR] = &&op_IUSHR;
+    table[OP_NOT] = &&op_NOT;
+    table[OP_ILOAD] = table[OP_ALOAD] = table[OP_FLOAD] = &&op_LOAD;
+    table[OP_DLOAD] = table[OP_LLOAD] = table[OP_LOAD_GLOBAL] = &&op_LOAD;
+    table[OP_ISTORE] = table[OP_ASTORE] = table[OP_FSTORE] = &&op_STORE;
+    table[OP_DSTORE] = table[OP_LSTORE] = table[OP_STORE_GLOBAL] = &&op_STORE;
+    table[OP_LOAD_LOCAL] = &&op_LOAD_LOCAL;
+    table[OP_STORE_LOCAL] = &&op_STORE_LOCAL;
+    table[OP_CALL] = &&op_CALL;
+    table[OP_INVOKE] = &&op_INVOKE;
+    table[OP_RET] = table[OP_IRET] = table[OP_ARET] = &&op_RET;
+    table[OP_JMP] = &&op_JMP;
+    table[OP_JZ] = &&op_JZ;
+    table[OP_JNZ] = &&op_JNZ;
+    table[SUPER_LOAD_LOAD_ADD] = &&op_SUPER_LOAD_LOAD_ADD;
+    table[SUPER_LOAD_LOAD_MUL] = &&op_SUPER_LOAD_LOAD_MUL;
+    table[SUPER_PUSH_STORE] = &&op_SUPER_PUSH_STORE;
+    table[SUPER_LOAD_CMP_JZ] = &&op_SUPER_LOAD_CMP_JZ;
+    table[SUPER_LOAD_LOAD_CMP_JZ] = &&op_SUPER_LOAD_LOAD_CMP_JZ;
+    table[SUPER_CMP_JZ] = &&op_SUPER_CMP_JZ;
+    table[SUPER_INC_CMP_JNZ] = &&op_SUPER_INC_CMP_JNZ;
+    table[SUPER_GLOBAL_ADD] = &&op_SUPER_GLOBAL_ADD;
+    table[SUPER_GLOBAL_SUB] = &&op_SUPER_GLOBAL_SUB;
+    table[SUPER_GLOBAL_MUL] = &&op_SUPER_GLOBAL_MUL;
+
+    // Uma entrada por palavra + sentinela no fim (queda do fim = saida)
+    std::vector<const void*> code(size + 1);
+    for (int i = 0; i < size; i++) {
+        int32_t op = scriptBytecode[i];
+        code[i] = (op >= 0 && op < TABLE_SIZE) ? table[op] : &&op_SLOW;
+    }
+    code[size] = &&op_END;
+
+    const int32_t* bc = scriptBytecode.data();
+    Value* stack = execStack.data();
+    Value* g = globals.data();
+    int pc = scriptPC;
+    int sp = execSP;
+    int base = localsBase;
+    const bool profiling = config.enableProfiling;
+    const bool profileJIT = config.enableJIT;
+    const bool osr = config.enableJIT && config.enableNativeJIT;
+
+    if (pc < 0 || pc > size) pc = size;
+
+#define DISPATCH() do { \
+        if (profiling) { \
+            instructionsExecuted++; \
+            profiler.countOpcode(pc, pc < size ? bc[pc] : OP_HALT); \
+        } \
+        goto *code[pc]; \
+    } while (0)
+#define JUMP_TO(target) do { \
+        int t_ = (target); \
+        if (t_ < 0 || t_ > size) t_ = size; \
+        if (profileJIT && t_ < pc) { \
+            ProfileData& p_ = jit.recordExecution(t_); \
+            if (osr && p_.isHot) { execSP = sp; t_ = osrEnter(t_, p_); } \
+        } \
+        pc = t_; \
+    } while (0)
+#define BINOP_INT(expr) do { \
+        int32_t b = stack[--sp].asInt(); int32_t a = stack[--sp].asInt(); \
+        (void)a; (void)b; \
+        stack[sp++] = Value(static_cast<int32_t>(expr)); pc++; DISPATCH(); \
+    } while (0)
+
+    DISPATCH();
+
+op_HALT:
+    running = false;
+    pc++;
+    goto op_EXIT;
+
+op_NOP:
+    pc++;
+    DISPATCH();
+
+op_PUSH_NULL:
+    stack[sp++] = Value();
+    pc++;
+    DISPATCH();
+
+op_PUSH_TRUE:
+    stack[sp++] = Value(1);
+    pc++;
+    DISPATCH();
+
+op_PUSH_FALSE:
+    stack[sp++] = Value(0);
+    pc++;
+    DISPATCH();
+
+op_PUSH_INT:
+    stack[sp++] = Value(bc[pc + 1]);
+    pc += 2;
+    DISPATCH();
+
+op_ICONST:
+    stack[sp++] = Value(bc[pc] == OP_ICONST_M1 ? -1 : bc[pc] - OP_ICONST_0);
+    pc++;
+    DISPATCH();
+
+op_POP:
+    --sp;
+    pc++;
+    DISPATCH();
+
+op_DUP:
+    stack[sp] = stack[sp - 1];
+    sp++;
+    pc++;
+    DISPATCH();
+
+op_SWAP:
+    std::swap(stack[sp - 1], stack[sp - 2]);
+    pc++;
+    DISPATCH();
+
+// Fora de int+int (referencia concatena, Long vai a 64 bits) o switch resolve
+op_IADD:
+    if (!stack[sp - 1].isInt() || !stack[sp - 2].isInt()) goto op_SLOW;
+    BINOP_INT(a + b);
+op_ISUB:
+    if (!stack[sp - 1].isInt() || !stack[sp - 2].isInt()) goto op_SLOW;
+    BINOP_INT(a - b);
+op_IMUL:
+    if (!stack[sp - 1].isInt() || !stack[sp - 2].isInt()) goto op_SLOW;
+    BINOP_INT(a * b);
+op_IDIV: BINOP_INT(b != 0 ? a / b : 0);
+op_IMOD: BINOP_INT(b != 0 ? a % b : 0);
+op_IEQ:  BINOP_INT(a == b ? 1 : 0);
+op_INE:  BINOP_INT(a != b ? 1 : 0);
+op_ILT:  BINOP_INT(a < b ? 1 : 0);
+op_ILE:  BINOP_INT(a <= b ? 1 : 0);
+op_IGT:  BINOP_INT(a > b ? 1 : 0);
+op_IGE:  BINOP_INT(a >= b ? 1 : 0);
+op_IAND: BINOP_INT(a & b);
+op_IOR:  BINOP_INT(a | b);
+op_IXOR: BINOP_INT(a ^ b);
+op_ISHL: BINOP_INT(a << b);
+op_ISHR: BINOP_INT(a >> b);
+op_IUSHR: BINOP_INT(static_cast<uint32_t>(a) >> b);
+
+op_INEG:
+    stack[sp - 1] = Value(-stack[sp - 1].asInt());
+    pc++;
+    DISPATCH();
+
+op_NOT:
+    stack[sp - 1] = Value(stack[sp - 1].asInt() == 0 ? 1 : 0);
+    pc++;
+    DISPATCH();
+
+op_IINC: {
+    int32_t idx = bc[pc + 1];
+    if (!g[idx].isInt()) goto op_SLOW;
+    g[idx] = Value(g[idx].asInt() + bc[pc + 2]);
+    pc += 3;
+    DISPATCH();
+}
+
+op_LOAD:
+    stack[sp++] = g[bc[pc + 1]];
+    pc += 2;
+    DISPATCH();
+
+op_STORE:
+    g[bc[pc + 1]] = stack[--sp];
+    pc += 2;
+    DISPATCH();
+
+op_LOAD_LOCAL:
+    stack[sp++] = stack[base + bc[pc + 1]];
+    pc += 2;
+    DISPATCH();
+
+op_STORE_LOCAL:
+    stack[base + bc[pc + 1]] = stack[--sp];
+    pc += 2;
+    DISPATCH();
+
+    // Chamadas e retornos trocam de frame fora do loop: sincroniza, chama o
+    // helper e recarrega pc/sp/base
+#define FRAME_SWITCH(width, call) do { \
+        scriptPC = pc + (width); \
+        execSP = sp; \
+        call; \
+        pc = scriptPC; \
+        sp = execSP; \
+        base = localsBase; \
+        if (!running) goto op_EXIT; \
+        if (pc < 0 || pc > size) pc = size; \
+    } while (0)
+
+op_CALL:
+    FRAME_SWITCH(3, callFunction(bc[pc + 1], bc[pc + 2]));
+    DISPATCH();
+
+op_INVOKE:
+    FRAME_SWITCH(4, invokeVirtual(bc[pc + 1], bc[pc + 2], bc[pc + 3]));
+    DISPATCH();
+
+op_RET:
+    if (frameCount == 0) {
+        pc++;  // Nivel superior: segue em frente
+        DISPATCH();
+    }
+    FRAME_SWITCH(1, leaveFrame(bc[pc] == OP_RET ? Value() : stack[sp - 1]));
+    DISPATCH();
+
+#undef FRAME_SWITCH
+
+op_JMP:
+    JUMP_TO(bc[pc + 1]);
+    DISPATCH();
+
+op_JZ:
+    if (stack[--sp].asInt() == 0) JUMP_TO(bc[pc + 1]);
+    else pc += 2;
+    DISPATCH();
+
+op_JNZ:
+    if (stack[--sp].asInt() != 0) JUMP_TO(bc[pc + 1]);
+    else pc += 2;
+    DISPATCH();
+
+op_SUPER_LOAD_LOAD_ADD:
+    if (!g[bc[pc + 1]].isInt() || !g[bc[pc + 2]].isInt()) goto op_SLOW;
+    stack[sp++] = Value(g[bc[pc + 1]].asInt() + g[bc[pc + 2]].asInt());
+    pc += 3;
+    DISPATCH();
+
+op_SUPER_LOAD_LOAD_MUL:
+    if (!g[bc[pc + 1]].isInt() || !g[bc[pc + 2]].isInt()) goto op_SLOW;
+    stack[sp++] = Value(g[bc[pc + 1]].asInt() * g[bc[pc + 2]].asInt());
+    pc += 3;
+    DISPATCH();
+
+op_SUPER_PUSH_STORE:
+    g[bc[pc + 2]] = Value(bc[pc + 1]);
+    pc += 3;
+    DISPATCH();
+
+op_SUPER_LOAD_CMP_JZ:
+    if (!compareInt(bc[pc + 3], g[bc[pc + 1]].asInt(), bc[pc + 2])) JUMP_TO(bc[pc + 4]);
+    else pc += 5;
+    DISPATCH();
+
+op_SUPER_LOAD_LOAD_CMP_JZ:
+    if (!compareInt(bc[pc + 3], g[bc[pc + 1]].asInt(), g[bc[pc + 2]].asInt())) JUMP_TO(bc[pc + 4]);
+    else pc += 5;
+    DISPATCH();
+
+op_SUPER_CMP_JZ: {
+    int32_t b = stack[--sp].asInt();
+    int32_t a = stack[--sp].asInt();
+    if (!compareInt(bc[pc + 1], a, b)) JUMP_TO(bc[pc + 2]);
+    else pc += 3;
+    DISPATCH();
+}
+
+op_SUPER_INC_CMP_JNZ: {
+    int32_t idx = bc[pc + 1];
+    if (!g[idx].isInt()) goto op_SLOW;
+    g[idx] = Value(g[idx].asInt() + bc[pc + 2]);
+    if (compareInt(bc[pc + 5], g[bc[pc + 3]].asInt(), bc[pc + 4])) JUMP_TO(bc[pc + 6]);
+    else pc += 7;
+    DISPATCH();
+}
+
+op_SUPER_GLOBAL_ADD:
+    if (!g[bc[pc + 2]].isInt() || !g[bc[pc + 3]].isInt()) goto op_SLOW;
+    g[bc[pc + 1]] = Value(g[bc[pc + 2]].asInt() + g[bc[pc + 3]].asInt());
+    pc += 4;
+    DISPATCH();
+
+op_SUPER_GLOBAL_SUB:
+    if (!g[bc[pc + 2]].isInt() || !g[bc[pc + 3]].isInt()) goto op_SLOW;
+    g[bc[pc + 1]] = Value(g[bc[pc + 2]].asInt() - g[bc[pc + 3]].asInt());
+    pc += 4;
+    DISPATCH();
+
+op_SUPER_GLOBAL_MUL:
+    if (!g[bc[pc + 2]].isInt() || !g[bc[pc + 3]].isInt()) goto op_SLOW;
+    g[bc[pc + 1]] = Value(g[bc[pc + 2]].asInt() * g[bc[pc + 3]].asInt());
+    pc += 4;
+    DISPATCH();
+
+op_SLOW:
+    // Opcode frio: delega ao interpretador switch com o estado sincronizado
+    scriptPC = pc;
+    execSP = sp;
+    if (profiling) {  // executeInstruction conta de novo
+        instructionsExecuted--;
+        profiler.uncountOpcode(bc[pc]);
+    }
+    executeInstruction();
+    pc = scriptPC;
+    sp = execSP;
+    base = localsBase;
+    g = globals.data();
+    if (!running) goto op_EXIT;
+    if (pc < 0 || pc > size) pc = size;
+    DISPATCH();
+
+op_END:
+op_EXIT:
+    scriptPC = pc;
+    execSP = sp;
+
+#undef BINOP_INT
+#undef JUMP_TO
+#undef DISPATCH
+#else
+    // Sem computed goto: mesmo loop do switch, sem perfil por instrucao
+    while (running && scriptPC < static_cast<int>(scriptBytecode.size())) {
+        executeInstruction();
+    }
+#endif
+}
+
+inline void VM::executeInstruction() {
+    if (scriptPC >= static_cast<int>(scriptBytecode.size())) {
+        running = false;
+        return;
+    }
+
+    // Safepoint: coleta pedida por uma alocacao que nao podia coletar, ou
+    // outra mutadora parando o mundo
+    if (heap.gcRequested && config.enableGC) collectGarbage();
+    heap.safepointPoll();
+    
+    int32_t opcode = scriptBytecode[scriptPC++];
+    if (config.enableProfiling) {
+        instructionsExecuted++;
+        profiler.countOpcode(scriptPC - 1, opcode);
+    }
+    
+    switch (opcode) {
+        case OP_HALT:
+            running = false;
+            break;
+            
+        case OP_NOP:
+            break;
+            
+        // ========== CONSTANTES ==========
         case OP_PUSH_NULL:
             stackPush(Value());
             break;
@@ -536,7 +2246,8 @@ inline void VM::executeInstruction() {
         case OP_PUSH_STRING: {
             int32_t idx = scriptBytecode[scriptPC++];
             if (idx >= 0 && idx < static_cast<int>(stringPool.size())) {
-                GCObject* str = newString(stringPool[idx]);
+                GCObject*& str = stringConstants[idx];
+                if (!str) str = internString(stringPool[idx]);
                 stackPush(Value(str));
             } else {
                 stackPush(Value());
@@ -562,9 +2273,8 @@ inline void VM::executeInstruction() {
         }
         
         // ========== ARITMÉTICA INT ==========
-        case OP_IADD: { Value b = stackPop(); Value a = stackPop(); stackPush(Value(a.asInt() + b.asInt())); break; }
-        case OP_ISUB: { Value b = stackPop(); Value a = stackPop(); stackPush(Value(a.asInt() - b.asInt())); break; }
-        case OP_IMUL: { Value b = stackPop(); Value a = stackPop(); stackPush(Value(a.asInt() * b.asInt())); break; }
+        case OP_IADD: addValues(); break;
+        case OP_ISUB: case OP_IMUL: { Value b = stackPop(); Value a = stackPop(); stackPush(intArith(opcode, a, b)); break; }
         case OP_IDIV: { 
             Value b = stackPop(); Value a = stackPop();
             stackPush(Value(b.asInt() != 0 ? a.asInt() / b.asInt() : 0)); 
@@ -579,7 +2289,7 @@ inline void VM::executeInstruction() {
         case OP_IINC: {
             int32_t idx = scriptBytecode[scriptPC++];
             int32_t amount = scriptBytecode[scriptPC++];
-            globals[idx] = Value(globals[idx].asInt() + amount);
+            addToGlobal(idx, globals[idx], Value(amount));
             break;
         }
         
@@ -675,6 +2385,18 @@ inline void VM::executeInstruction() {
             break;
         }
         
+        case OP_LOAD_LOCAL: {
+            int index = scriptBytecode[scriptPC++];
+            stackPush(execStack[localsBase + index]);
+            break;
+        }
+        
+        case OP_STORE_LOCAL: {
+            int index = scriptBytecode[scriptPC++];
+            execStack[localsBase + index] = stackPop();
+            break;
+        }
+        
         // ========== ARRAYS ==========
         case OP_NEWARRAY: {
             int32_t type = scriptBytecode[scriptPC++];
@@ -697,10 +2419,11 @@ inline void VM::executeInstruction() {
         case OP_IALOAD: {
             Value idx = stackPop();
             Value arr = stackPop();
-            if (arr.asObject()) {
-                stackPush(Value(arr.asObject()->arrayElement<int32_t>(idx.asInt())));
+            GCObject* a = arr.asObject();
+            if (a && a->header.type == GCObjectType::ARRAY_INT) {
+                stackPush(Value(a->arrayElement<int32_t>(idx.asInt())));
             } else {
-                stackPush(Value(0));
+                stackPush(a ? arrayLoad(a, idx.asInt()) : Value(0));
             }
             break;
         }
@@ -709,8 +2432,43 @@ inline void VM::executeInstruction() {
             Value val = stackPop();
             Value idx = stackPop();
             Value arr = stackPop();
-            if (arr.asObject()) {
-                arr.asObject()->arrayElement<int32_t>(idx.asInt()) = val.asInt();
+            GCObject* a = arr.asObject();
+            if (a && a->header.type == GCObjectType::ARRAY_INT) {
+                a->arrayElement<int32_t>(idx.asInt()) = val.asInt();
+            } else if (a) {
+                arrayStore(a, idx.asInt(), val);
+            }
+            break;
+        }
+        
+        case OP_ANEWARRAY: {
+            int32_t classIdx = scriptBytecode[scriptPC++];
+            Value lengthVal = stackPop();
+            stackPush(Value(newObjectArray(programClass(classIdx), lengthVal.asInt())));
+            break;
+        }
+        
+        case OP_AALOAD: {
+            Value idx = stackPop();
+            Value arr = stackPop();
+            GCObject* a = arr.asObject();
+            int32_t i = idx.asInt();
+            if (a && a->header.type == GCObjectType::ARRAY_OBJECT && i >= 0 && i < a->arrayLength()) {
+                stackPush(Value(a->arrayElement<GCObject*>(i)));
+            } else {
+                stackPush(Value());
+            }
+            break;
+        }
+        
+        case OP_AASTORE: {
+            Value val = stackPop();
+            Value idx = stackPop();
+            Value arr = stackPop();
+            GCObject* a = arr.asObject();
+            int32_t i = idx.asInt();
+            if (a && a->header.type == GCObjectType::ARRAY_OBJECT && i >= 0 && i < a->arrayLength()) {
+                storeReference(a, &a->arrayElement<GCObject*>(i), val.asObject());
             }
             break;
         }
@@ -738,54 +2496,86 @@ inline void VM::executeInstruction() {
         
         // ========== CHAMADAS ==========
         case OP_CALL: {
+            int32_t index = scriptBytecode[scriptPC++];
+            int32_t argCount = scriptBytecode[scriptPC++];
+            callFunction(index, argCount);
+            break;
+        }
+        
+        case OP_NATIVE: {
+            int32_t id = scriptBytecode[scriptPC++];
             int32_t argCount = scriptBytecode[scriptPC++];
             methodCalls++;
-            // For now, function calls are handled via native methods
-            (void)argCount;
+            // Os argumentos ficam na pilha (roots) ate o native voltar; o
+            // vetor e reaproveitado por nivel (um native pode chamar outro)
+            if (nativeDepth == nativeArgs.size()) nativeArgs.emplace_back();
+            std::vector<Value>& args = nativeArgs[nativeDepth];
+            args.assign(execStack.begin() + (execSP - argCount), execStack.begin() + execSP);
+            const NativeMethod* method = nativeById(id);
+            nativeDepth++;
+            Value result = method ? (*method)(this, currentFrame, args) : Value();
+            nativeDepth--;
+            execSP -= argCount;
+            stackPush(result);
             break;
         }
         
         case OP_INVOKE: {
+            int32_t selector = scriptBytecode[scriptPC++];
             int32_t argCount = scriptBytecode[scriptPC++];
-            methodCalls++;
-            (void)argCount;
+            int32_t site = scriptBytecode[scriptPC++];
+            invokeVirtual(selector, argCount, site);
             break;
         }
         
         case OP_INVOKESPEC: {
+            int32_t classIdx = scriptBytecode[scriptPC++];
+            int32_t selector = scriptBytecode[scriptPC++];
             int32_t argCount = scriptBytecode[scriptPC++];
-            methodCalls++;
-            (void)argCount;
+            int32_t site = scriptBytecode[scriptPC++];
+            invokeSpecial(classIdx, selector, argCount, site);
             break;
         }
         
         case OP_RET:
         case OP_IRET:
         case OP_ARET:
-            // Return from method - in script mode, just continue
+            // No nivel superior (script, lambda) segue em frente
+            if (frameCount > 0) leaveFrame(opcode == OP_RET ? Value() : stackPeek());
             break;
         
         // ========== OBJETOS ==========
         case OP_NEW: {
             int32_t classIdx = scriptBytecode[scriptPC++];
-            (void)classIdx;
-            stackPush(Value()); // Push null for now
+            ClassInfo* cls = programClass(classIdx);
+            stackPush(cls ? Value(newInstance(cls)) : Value());
             break;
         }
         
         case OP_GETFIELD: {
-            int32_t fieldIdx = scriptBytecode[scriptPC++];
-            stackPop(); // object
-            stackPush(Value(0)); // placeholder
-            (void)fieldIdx;
+            int32_t selector = scriptBytecode[scriptPC++];
+            int32_t site = scriptBytecode[scriptPC++];
+            GCObject* obj = stackPop().asObject();
+            ClassInfo* cls = instanceClass(obj);
+            const FieldInfo* field = cls ? lookupField(site, cls, selector) : nullptr;
+            if (field) {
+                stackPush(loadField(obj, *field));
+            } else if (obj && obj->header.isArray()) {
+                stackPush(Value(obj->arrayLength()));  // arr.length
+            } else {
+                stackPush(Value(0));
+            }
             break;
         }
         
         case OP_PUTFIELD: {
-            int32_t fieldIdx = scriptBytecode[scriptPC++];
-            stackPop(); // value
-            stackPop(); // object
-            (void)fieldIdx;
+            int32_t selector = scriptBytecode[scriptPC++];
+            int32_t site = scriptBytecode[scriptPC++];
+            Value val = stackPop();
+            GCObject* obj = stackPop().asObject();
+            ClassInfo* cls = instanceClass(obj);
+            const FieldInfo* field = cls ? lookupField(site, cls, selector) : nullptr;
+            if (field) storeField(obj, *field, val);
             break;
         }
         
@@ -817,24 +2607,36 @@ inline void VM::executeInstruction() {
             stackPop(); // exception object
             break;
             
-        case OP_MONITORENTER:
-        case OP_MONITOREXIT:
+        case OP_MONITORENTER: {
+            // O objeto so sai da pilha depois de adquirido: revogar um bias
+            // pode ceder a vez a uma coleta que o move
+            Value& lockee = stackPeek();
+            while (GCObject* obj = lockee.asObject()) {
+                if (monitors.enter(obj->header.lockWord, &monitorRuntime)) break;
+            }
             stackPop();
             break;
+        }
+        case OP_MONITOREXIT:
+            if (GCObject* obj = stackPop().asObject()) monitors.exit(obj->header.lockWord);
+            break;
         
         // ========== I/O ==========
         case OP_PRINT: {
             Value v = stackPop();
-            switch (v.type) {
+            switch (v.type()) {
                 case Value::Type::Int: std::cout << v.asInt() << std::endl; break;
                 case Value::Type::Long: std::cout << v.asLong() << std::endl; break;
                 case Value::Type::Float: std::cout << v.asFloat() << std::endl; break;
                 case Value::Type::Double: std::cout << v.asDouble() << std::endl; break;
                 case Value::Type::Object:
                     if (v.asObject()) {
-                        if (v.asObject()->header.type == GCObjectType::STRING) {
-                            char* str = reinterpret_cast<char*>(v.asObject()->data + sizeof(int32_t));
-                            std::cout << str << std::endl;
+                        if (StringObjects::isText(v.asObject())) {
+                            // Ropes sao impressos pedaco a pedaco, sem achatar
+                            StringObjects::forEachPiece(v.asObject(), ropeStack, [](const char* p, size_t n) {
+                                std::cout.write(p, static_cast<std::streamsize>(n));
+                            });
+                            std::cout << std::endl;
                         } else {
                             std::cout << "<object@" << v.asObject() << ">" << std::endl;
                         }
@@ -847,14 +2649,23 @@ inline void VM::executeInstruction() {
             break;
         }
         
+        // ========== KAVA 2.5 - STRINGS ==========
+        case OP_SCONCAT: concatStrings(); break;
+        
         // ========== KAVA 2.5 - LAMBDA ==========
         case OP_LAMBDA_NEW: {
             int32_t lambdaIdx = scriptBytecode[scriptPC++];
             int32_t paramCount = scriptBytecode[scriptPC++];
             
+            // O corpo vem logo depois: JMP fim; <corpo>; fim:
             LambdaClosure closure;
-            closure.codeStart = 0; // Will be set by JMP skip
+            closure.codeStart = -1;
+            closure.codeEnd = -1;
             closure.paramCount = paramCount;
+            if (scriptPC + 1 < static_cast<int>(scriptBytecode.size()) && scriptBytecode[scriptPC] == OP_JMP) {
+                closure.codeStart = scriptPC + 2;
+                closure.codeEnd = scriptBytecode[scriptPC + 1];
+            }
             
             if (lambdaIdx >= static_cast<int>(lambdaClosures.size())) {
                 lambdaClosures.resize(lambdaIdx + 1);
@@ -862,10 +2673,7 @@ inline void VM::executeInstruction() {
             lambdaClosures[lambdaIdx] = closure;
             
             // Push lambda reference (encoded as int)
-            Value lambdaVal;
-            lambdaVal.type = Value::Type::Lambda;
-            lambdaVal.data.i32 = lambdaIdx;
-            stackPush(lambdaVal);
+            stackPush(Value::lambda(lambdaIdx));
             break;
         }
         
@@ -879,7 +2687,7 @@ inline void VM::executeInstruction() {
             Value lambdaRef = stackPop();
             
             if (lambdaRef.isLambda()) {
-                Value result = executeLambda(lambdaRef.data.i32, args);
+                Value result = executeLambda(lambdaRef.asLambda(), args);
                 stackPush(result);
             } else {
                 stackPush(Value(0));
@@ -900,129 +2708,83 @@ inline void VM::executeInstruction() {
         }
         
         // ========== KAVA 2.5 - STREAMS ==========
+        // Intermediarias anotam estagios no pipeline do handle (que fica na
+        // pilha); terminais consomem o handle e empurram o resultado
         case OP_STREAM_NEW: {
-            // Source array/collection is on stack
-            // For now, keep it there for operations
+            Value source = stackPop();
+            stackPush(source.isStream() ? source : Value::stream(newStream(source)));
             break;
         }
         
-        case OP_STREAM_FILTER:
-        case OP_STREAM_MAP:
-        case OP_STREAM_FOREACH:
-        case OP_STREAM_REDUCE:
-        case OP_STREAM_FLATMAP: {
-            // Lambda is on stack, source below
-            stackPop(); // lambda - consumed
-            // Result stays on stack
+        case OP_STREAM_PARALLEL:
+            if (StreamPipeline* p = streamAt(stackPeek())) p->parallel = true;
             break;
-        }
         
-        case OP_STREAM_COUNT: {
-            Value source = stackPop();
-            if (source.asObject()) {
-                stackPush(Value(source.asObject()->arrayLength()));
-            } else {
-                stackPush(Value(0));
-            }
-            break;
-        }
+        case OP_STREAM_FILTER: addStreamStage(StreamStage::Kind::Filter, stackPop()); break;
+        case OP_STREAM_MAP: addStreamStage(StreamStage::Kind::Map, stackPop()); break;
+        case OP_STREAM_FLATMAP: addStreamStage(StreamStage::Kind::FlatMap, stackPop()); break;
+        case OP_STREAM_LIMIT: addStreamStage(StreamStage::Kind::Limit, Value(), stackPop().toLong()); break;
+        case OP_STREAM_SKIP: addStreamStage(StreamStage::Kind::Skip, Value(), stackPop().toLong()); break;
+        case OP_STREAM_DISTINCT: addStreamStage(StreamStage::Kind::Distinct, Value()); break;
         
-        case OP_STREAM_SUM: {
-            Value source = stackPop();
-            if (source.asObject()) {
-                int32_t len = source.asObject()->arrayLength();
-                int64_t sum = 0;
-                for (int32_t i = 0; i < len; i++) {
-                    sum += source.asObject()->arrayElement<int32_t>(i);
-                }
-                stackPush(Value(sum));
-            } else {
-                stackPush(Value((int64_t)0));
-            }
+        case OP_STREAM_SORT: {
+            // sorted() ou sorted(comparador)
+            Value cmp = stackPeek().isLambda() ? stackPop() : Value();
+            addStreamStage(StreamStage::Kind::Sorted, cmp);
             break;
         }
         
-        case OP_STREAM_MIN: {
-            Value source = stackPop();
-            if (source.asObject() && source.asObject()->arrayLength() > 0) {
-                int32_t len = source.asObject()->arrayLength();
-                int32_t minVal = source.asObject()->arrayElement<int32_t>(0);
-                for (int32_t i = 1; i < len; i++) {
-                    int32_t v = source.asObject()->arrayElement<int32_t>(i);
-                    if (v < minVal) minVal = v;
-                }
-                stackPush(Value(minVal));
-            } else {
-                stackPush(Value(0));
-            }
-            break;
-        }
+        case OP_STREAM_COUNT: runStreamTerminal(StreamTerminal::Count, Value(), Value(), false); break;
+        case OP_STREAM_SUM: runStreamTerminal(StreamTerminal::Sum, Value(), Value(), false); break;
+        case OP_STREAM_COLLECT:
+        case OP_STREAM_TOLIST: runStreamTerminal(StreamTerminal::Collect, Value(), Value(), false); break;
+        case OP_STREAM_FINDFIRST: runStreamTerminal(StreamTerminal::FindFirst, Value(), Value(), false); break;
         
+        case OP_STREAM_MIN:
         case OP_STREAM_MAX: {
-            Value source = stackPop();
-            if (source.asObject() && source.asObject()->arrayLength() > 0) {
-                int32_t len = source.asObject()->arrayLength();
-                int32_t maxVal = source.asObject()->arrayElement<int32_t>(0);
-                for (int32_t i = 1; i < len; i++) {
-                    int32_t v = source.asObject()->arrayElement<int32_t>(i);
-                    if (v > maxVal) maxVal = v;
-                }
-                stackPush(Value(maxVal));
-            } else {
-                stackPush(Value(0));
-            }
+            Value cmp = stackPeek().isLambda() ? stackPop() : Value();
+            runStreamTerminal(opcode == OP_STREAM_MIN ? StreamTerminal::Min : StreamTerminal::Max,
+                              cmp, Value(), false);
             break;
         }
         
-        case OP_STREAM_COLLECT:
-        case OP_STREAM_TOLIST:
-        case OP_STREAM_SORT:
-        case OP_STREAM_DISTINCT:
-        case OP_STREAM_LIMIT:
-        case OP_STREAM_SKIP:
-        case OP_STREAM_ANYMATCH:
-        case OP_STREAM_ALLMATCH:
-            break;
+        case OP_STREAM_FOREACH: runStreamTerminal(StreamTerminal::ForEach, stackPop(), Value(), false); break;
+        case OP_STREAM_ANYMATCH: runStreamTerminal(StreamTerminal::AnyMatch, stackPop(), Value(), false); break;
+        case OP_STREAM_ALLMATCH: runStreamTerminal(StreamTerminal::AllMatch, stackPop(), Value(), false); break;
+        case OP_STREAM_NONEMATCH: runStreamTerminal(StreamTerminal::NoneMatch, stackPop(), Value(), false); break;
         
-        // ========== KAVA 2.5 - ASYNC/AWAIT ==========
-        case OP_ASYNC_CALL: {
-            // Create promise for async function call
-            auto promise = eventLoop.createPromise();
-            stackPush(Value(promise->promiseId));
+        case OP_STREAM_REDUCE: {
+            // reduce(op) ou reduce(identidade, op): a identidade fica entre o handle e o lambda
+            Value fn = stackPop();
+            bool hasIdentity = !stackPeek().isStream() && execSP >= 2 && execStack[execSP - 2].isStream();
+            Value identity = hasIdentity ? stackPop() : Value();
+            runStreamTerminal(StreamTerminal::Reduce, fn, identity, hasIdentity);
             break;
         }
         
-        case OP_AWAIT: {
-            Value promiseId = stackPop();
-            auto promise = eventLoop.getPromise(promiseId.asInt());
-            if (promise) {
-                // Spin-wait for settlement (simple approach)
-                while (!promise->isSettled()) {
-                    eventLoop.tick();
-                }
-                stackPush(Value(static_cast<int32_t>(promise->value)));
-            } else {
-                stackPush(Value(0));
-            }
+        // ========== KAVA 2.5 - ASYNC/AWAIT ==========
+        // As fn/metodos async criam a propria promise ao entrar (enterFrame);
+        // ASYNC_CALL e PROMISE_NEW so criam uma promise avulsa
+        case OP_ASYNC_CALL:
+        case OP_PROMISE_NEW:
+            stackPush(Value::promise(eventLoop.createPromise()));
             break;
-        }
         
-        case OP_PROMISE_NEW: {
-            auto promise = eventLoop.createPromise();
-            stackPush(Value(promise->promiseId));
+        case OP_AWAIT:
+            awaitValue(stackPop());
             break;
-        }
         
         case OP_PROMISE_RESOLVE: {
             Value val = stackPop();
-            Value promiseId = stackPop();
-            eventLoop.resolvePromise(promiseId.asInt(), val.toLong());
+            Value handle = stackPop();
+            if (handle.isPromise()) eventLoop.resolvePromise(handle.asPromise(), val.bits);
             break;
         }
         
         case OP_PROMISE_REJECT: {
             stackPop(); // error
-            stackPop(); // promise id
+            Value handle = stackPop();
+            if (handle.isPromise()) eventLoop.rejectPromise(handle.asPromise(), "rejected");
             break;
         }
         
@@ -1044,7 +2806,7 @@ inline void VM::executeInstruction() {
             
             if (func.isLambda()) {
                 std::vector<Value> args = {val};
-                Value result = executeLambda(func.data.i32, args);
+                Value result = executeLambda(func.asLambda(), args);
                 stackPush(result);
             } else {
                 stackPush(val);
@@ -1056,14 +2818,16 @@ inline void VM::executeInstruction() {
         case SUPER_LOAD_LOAD_ADD: {
             int32_t idx1 = scriptBytecode[scriptPC++];
             int32_t idx2 = scriptBytecode[scriptPC++];
-            stackPush(Value(globals[idx1].asInt() + globals[idx2].asInt()));
+            stackPush(globals[idx1]);
+            stackPush(globals[idx2]);
+            addValues();
             break;
         }
         
         case SUPER_LOAD_LOAD_MUL: {
             int32_t idx1 = scriptBytecode[scriptPC++];
             int32_t idx2 = scriptBytecode[scriptPC++];
-            stackPush(Value(globals[idx1].asInt() * globals[idx2].asInt()));
+            stackPush(intArith(OP_IMUL, globals[idx1], globals[idx2]));
             break;
         }
         
@@ -1080,52 +2844,105 @@ inline void VM::executeInstruction() {
             int32_t cmpOp = scriptBytecode[scriptPC++];
             int32_t target = scriptBytecode[scriptPC++];
             
-            int32_t v = globals[varIdx].asInt();
-            bool result = false;
-            switch (cmpOp) {
-                case OP_ILT: result = v < cmpVal; break;
-                case OP_IGT: result = v > cmpVal; break;
-                case OP_ILE: result = v <= cmpVal; break;
-                case OP_IGE: result = v >= cmpVal; break;
-                default: break;
-            }
-            if (!result) scriptPC = target;
+            if (!compareInt(cmpOp, globals[varIdx].asInt(), cmpVal)) scriptPC = target;
             break;
         }
         
-#ifdef USE_SDL
-        case OP_GFX_INIT: {
-            Value h = stackPop(); Value w = stackPop();
-            SDL_Init(SDL_INIT_VIDEO);
-            window = SDL_CreateWindow("KAVA 2.5", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, w.asInt(), h.asInt(), 0);
-            renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+        case SUPER_LOAD_LOAD_CMP_JZ: {
+            int32_t idx1 = scriptBytecode[scriptPC++];
+            int32_t idx2 = scriptBytecode[scriptPC++];
+            int32_t cmpOp = scriptBytecode[scriptPC++];
+            int32_t target = scriptBytecode[scriptPC++];
+            if (!compareInt(cmpOp, globals[idx1].asInt(), globals[idx2].asInt())) scriptPC = target;
             break;
         }
         
-        case OP_GFX_CLEAR: {
-            Value b = stackPop(); Value g = stackPop(); Value r = stackPop();
-            SDL_SetRenderDrawColor(renderer, r.asInt(), g.asInt(), b.asInt(), 255);
-            SDL_RenderClear(renderer);
+        case SUPER_CMP_JZ: {
+            int32_t cmpOp = scriptBytecode[scriptPC++];
+            int32_t target = scriptBytecode[scriptPC++];
+            Value b = stackPop(); Value a = stackPop();
+            if (!compareInt(cmpOp, a.asInt(), b.asInt())) scriptPC = target;
+            break;
+        }
+        
+        case SUPER_INC_CMP_JNZ: {
+            int32_t idx = scriptBytecode[scriptPC++];
+            int32_t amount = scriptBytecode[scriptPC++];
+            int32_t varIdx = scriptBytecode[scriptPC++];
+            int32_t cmpVal = scriptBytecode[scriptPC++];
+            int32_t cmpOp = scriptBytecode[scriptPC++];
+            int32_t target = scriptBytecode[scriptPC++];
+            addToGlobal(idx, globals[idx], Value(amount));
+            if (compareInt(cmpOp, globals[varIdx].asInt(), cmpVal)) scriptPC = target;
+            break;
+        }
+        
+        case SUPER_GLOBAL_ADD: {
+            int32_t dst = scriptBytecode[scriptPC++];
+            Value a = globals[scriptBytecode[scriptPC++]];
+            Value b = globals[scriptBytecode[scriptPC++]];
+            addToGlobal(dst, a, b);
+            break;
+        }
+        case SUPER_GLOBAL_SUB:
+        case SUPER_GLOBAL_MUL: {
+            int32_t dst = scriptBytecode[scriptPC++];
+            Value a = globals[scriptBytecode[scriptPC++]];
+            Value b = globals[scriptBytecode[scriptPC++]];
+            globals[dst] = intArith(opcode == SUPER_GLOBAL_SUB ? OP_ISUB : OP_IMUL, a, b);
+            break;
+        }
+        
+        case OP_GFX_INIT: {
+            Value h = stackPop(); Value w = stackPop();
+            gfxFrame.setViewport(w.asInt(), h.asInt());
+#ifdef USE_SDL
+            SDL_Init(SDL_INIT_VIDEO);
+            window = SDL_CreateWindow("KAVA 2.5", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, w.asInt(), h.asInt(), 0);
+            renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+#endif
+            break;
+        }
+        
+        case OP_GFX_CLEAR: {
+            Value b = stackPop(); Value g = stackPop(); Value r = stackPop();
+            gfxFrame.clear(r.asInt(), g.asInt(), b.asInt());
+            break;
+        }
+        
+        case OP_GFX_COLOR: {
+            Value b = stackPop(); Value g = stackPop(); Value r = stackPop();
+            gfxFrame.setColor(r.asInt(), g.asInt(), b.asInt());
             break;
         }
         
         case OP_GFX_DRAW: {
             Value h = stackPop(); Value w = stackPop(); Value y = stackPop(); Value x = stackPop();
-            SDL_Rect rect = {x.asInt(), y.asInt(), w.asInt(), h.asInt()};
-            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-            SDL_RenderFillRect(renderer, &rect);
-            SDL_RenderPresent(renderer);
+            gfxFrame.fillRect(x.asInt(), y.asInt(), w.asInt(), h.asInt());
             break;
         }
         
+        case OP_GFX_PRESENT:
+            gfxExplicitPresent = true;
+            presentFrame();
+            break;
+        
         case OP_GFX_EVENT: {
+            // Programas sem GFX_PRESENT: o poll do laco principal fecha o frame
+            if (!gfxExplicitPresent && !gfxFrame.empty()) presentFrame();
+            int hasEvent = 0;
+#ifdef USE_SDL
             SDL_Event event;
-            int hasEvent = SDL_PollEvent(&event);
+            hasEvent = SDL_PollEvent(&event);
             if (hasEvent && event.type == SDL_QUIT) running = false;
+#endif
             stackPush(Value(hasEvent != 0 ? 1 : 0));
             break;
         }
-#endif
+        
+        case OP_GFX_EVENTS:
+            stackPush(Value(drainGfxEvents()));
+            break;
         
         default:
             // Unknown opcode - skip
@@ -1138,48 +2955,1338 @@ inline Value VM::executeLambda(int lambdaIdx, const std::vector<Value>& args) {
         return Value(0);
     }
     
-    auto& closure = lambdaClosures[lambdaIdx];
-    
-    // Save VM state
-    auto savedGlobals = std::vector<Value>(globals.begin(), globals.begin() + std::min((int)args.size() + 10, (int)globals.size()));
+    const int codeStart = lambdaClosures[lambdaIdx].codeStart;
+    const int paramCount = lambdaClosures[lambdaIdx].paramCount;
+    if (codeStart < 0) return Value(0);
     
-    // Set parameters as globals
-    for (size_t i = 0; i < args.size(); i++) {
-        globals[i] = args[i];
+    // Argumentos vao para a pilha (exatamente paramCount, completando com
+    // null); o prologo do corpo os guarda nos slots dos parametros
+    const int baseSP = execSP;
+    for (int i = 0; i < paramCount; i++) {
+        stackPush(i < static_cast<int>(args.size()) ? args[i] : Value());
     }
     
-    // Execute lambda code
     int savedPC = scriptPC;
-    scriptPC = closure.codeStart;
+    scriptPC = codeStart;
     
-    // Execute until RET
+    // Executa ate o RET do proprio corpo (os RET de fn chamadas por ele
+    // fecham os frames que elas abriram)
+    const int depth = frameCount;
     while (running && scriptPC < static_cast<int>(scriptBytecode.size())) {
         int32_t op = scriptBytecode[scriptPC];
-        if (op == OP_RET || op == OP_IRET) {
+        if ((op == OP_RET || op == OP_IRET) && frameCount == depth) {
             scriptPC++;
             break;
         }
         executeInstruction();
     }
     
-    // Restore state
     scriptPC = savedPC;
-    Value result = (execSP > 0) ? stackPop() : Value(0);
+    Value result = (execSP > baseSP) ? stackPop() : Value(0);
+    execSP = baseSP;
+    return result;
+}
+
+// ============================================================
+// CHAMADAS E INLINE CACHES
+// ============================================================
+// Os argumentos (e o receptor) ja empilhados viram os primeiros locais do
+// frame; o resto dos locais e zerado (o GC percorre execStack ate execSP).
+inline bool VM::enterFrame(MethodInfo* method, ClassInfo* cls, int argc) {
+    const int base = execSP - argc;
+    if (method->codeOffset < 0 || method->codeOffset >= static_cast<int>(scriptBytecode.size())) {
+        execSP = base;
+        stackPush(Value());
+        return false;
+    }
+    if (frameCount >= static_cast<int>(frames.size()) ||
+        base + method->maxLocals + FRAME_STACK_RESERVE > static_cast<int>(execStack.size())) {
+        const int line = sourceLine(scriptPC - 1);
+        std::cerr << "StackOverflowError: " << (cls ? cls->name + "." : std::string()) << method->name
+                  << " (profundidade " << frameCount;
+        if (line > 0) std::cerr << ", linha " << line;
+        std::cerr << ")" << std::endl;
+        running = false;
+        return false;
+    }
+    for (int i = argc; i < method->maxLocals; i++) execStack[base + i] = Value();
+    execSP = base + std::max<int>(argc, method->maxLocals);
+    
+    Frame& f = frames[frameCount++];
+    f.method = method;
+    f.classInfo = cls;
+    f.base = base;
+    f.returnPC = scriptPC;
+    f.caller = currentFrame;
+    f.pendingException = nullptr;
+    f.promise = (method->accessFlags & KAVA_ACC_ASYNC) ? eventLoop.createPromise() : 0;
+    currentFrame = &f;
+    localsBase = base;
+    scriptPC = method->codeOffset;
+    methodCalls++;
+    return true;
+}
+
+// Desempilha o frame inteiro (receptor, locais e operandos) e deixa o
+// resultado no lugar dele; o de uma fn async resolve a promise do frame e
+// o caller recebe o handle dela
+inline void VM::leaveFrame(Value result) {
+    Frame& f = frames[--frameCount];
+    if (f.promise) {
+        eventLoop.resolvePromise(f.promise, result.bits);
+        result = Value::promise(f.promise);
+    }
+    execSP = f.base;
+    scriptPC = f.returnPC;
+    currentFrame = f.caller;
+    localsBase = currentFrame ? currentFrame->base : 0;
+    stackPush(result);
+}
+
+// ============================================================
+// ASYNC/AWAIT - corrotinas sem pilha
+// ============================================================
+// await de algo que nao e promise devolve o proprio valor; de uma promise
+// assentada, o valor dela (o primeiro await consome a promise e devolve o
+// slot ao slab; um handle ja consumido da null). Pendente dentro de uma fn
+// async, o frame e suspenso e o caller segue com a promise da fn. Fora
+// dela (nivel superior ou fn sincrona) nao ha para onde ceder: o event
+// loop roda, dormindo entre os eventos, ate a promise assentar.
+inline void VM::awaitValue(Value handle) {
+    if (!handle.isPromise()) {
+        stackPush(handle);
+        return;
+    }
+    const int id = handle.asPromise();
+    Promise* p = eventLoop.getPromise(id);
+    if (p && !p->isSettled()) {
+        if (currentFrame && currentFrame->promise) {
+            suspendFrame(id);
+            return;
+        }
+        eventLoop.runUntilSettled(id);
+        p = eventLoop.getPromise(id);
+    }
+    Value result;
+    if (p && p->state == PromiseState::FULFILLED) result.bits = p->value;
+    eventLoop.releasePromise(id);
+    stackPush(result);
+}
+
+// Tira o frame atual de execStack guardando locais, operandos e o pc de
+// retomada; o caller recebe o handle da promise do frame, como num retorno
+inline void VM::suspendFrame(int promiseId) {
+    Frame& f = frames[frameCount - 1];
+    int32_t id;
+    if (!freeCoroutines.empty()) {
+        id = freeCoroutines.back();
+        freeCoroutines.pop_back();
+    } else {
+        id = static_cast<int32_t>(coroutines.size());
+        coroutines.emplace_back();
+    }
+    Coroutine& co = coroutines[id];
+    co.method = f.method;
+    co.classInfo = f.classInfo;
+    co.promise = f.promise;
+    co.pc = scriptPC;
+    co.slots.assign(execStack.begin() + f.base, execStack.begin() + execSP);
+    eventLoop.awaitPromise(promiseId, id);
+    
+    const int ownPromise = f.promise;
+    f.promise = 0;
+    leaveFrame(Value::promise(ownPromise));
+}
+
+// Chamado pelo EventLoop quando a promise que a corrotina esperava assentou:
+// recoloca o frame no topo da pilha atual com o valor do await empilhado e
+// executa ate ele retornar ou suspender de novo (os dois deixam um handle
+// no lugar do frame, descartado aqui)
+inline void VM::resumeCoroutine(int32_t id, int promiseId) {
+    if (id < 0 || id >= static_cast<int32_t>(coroutines.size()) || !coroutines[id].method) return;
+    Coroutine co = std::move(coroutines[id]);
+    coroutines[id] = Coroutine();
+    freeCoroutines.push_back(id);
+    
+    const int base = execSP;
+    if (frameCount >= static_cast<int>(frames.size()) ||
+        base + static_cast<int>(co.slots.size()) + FRAME_STACK_RESERVE > static_cast<int>(execStack.size())) {
+        std::cerr << "StackOverflowError: retomando " << co.method->name << std::endl;
+        running = false;
+        return;
+    }
+    std::copy(co.slots.begin(), co.slots.end(), execStack.begin() + base);
+    execSP = base + static_cast<int>(co.slots.size());
+    
+    const int savedPC = scriptPC;
+    const int depth = frameCount;
+    Frame& f = frames[frameCount++];
+    f.method = co.method;
+    f.classInfo = co.classInfo;
+    f.base = base;
+    f.returnPC = savedPC;
+    f.caller = currentFrame;
+    f.pendingException = nullptr;
+    f.promise = co.promise;
+    currentFrame = &f;
+    localsBase = base;
+    scriptPC = co.pc;
+    awaitValue(Value::promise(promiseId));
+    
+    while (running && frameCount > depth && scriptPC < static_cast<int>(scriptBytecode.size())) {
+        executeInstruction();
+    }
+    execSP = base;
+    scriptPC = savedPC;
+}
+
+// CALL: fn de nivel superior ou metodo estatico; argumentos a mais sao
+// descartados e os que faltam viram null
+inline void VM::callFunction(int32_t index, int32_t argc) {
+    if (index < 0 || index >= static_cast<int32_t>(functions.size())) {
+        execSP -= argc;
+        stackPush(Value());
+        return;
+    }
+    MethodInfo* fn = &functions[index];
+    for (; argc > fn->paramCount; argc--) execSP--;
+    for (; argc < fn->paramCount; argc++) stackPush(Value());
+    enterFrame(fn, nullptr, argc);
+}
+
+// INVOKE: despacho pela classe do receptor; String e StringBuilder tem
+// metodos embutidos. Outro receptor que nao e instancia (ou metodo
+// inexistente) consome os argumentos e devolve null
+inline void VM::invokeVirtual(int32_t selector, int32_t argc, int32_t site) {
+    GCObject* receiver = execStack[execSP - argc - 1].asObject();
+    ClassInfo* cls = instanceClass(receiver);
+    if (!cls && invokeStringMethod(selector, argc)) return;
+    MethodInfo* method = cls ? lookupMethod(site, cls, selector, argc) : nullptr;
+    if (method) {
+        enterFrame(method, cls, argc + 1);
+    } else {
+        execSP -= argc + 1;
+        stackPush(Value());
+    }
+}
+
+// INVOKESPEC: construtor ou super.metodo, resolvido na classe do operando
+inline void VM::invokeSpecial(int32_t classIndex, int32_t selector, int32_t argc, int32_t site) {
+    ClassInfo* cls = programClass(classIndex);
+    GCObject* receiver = execStack[execSP - argc - 1].asObject();
+    MethodInfo* method = cls && receiver ? lookupMethod(site, cls, selector, argc) : nullptr;
+    if (method) {
+        enterFrame(method, cls, argc + 1);
+    } else {
+        execSP -= argc + 1;
+        stackPush(Value());
+    }
+}
+
+inline ClassInfo* VM::instanceClass(GCObject* obj) const {
+    if (!obj || obj->header.type != GCObjectType::INSTANCE) return nullptr;
+    uint32_t id = obj->header.classId;
+    return id < classTable.size() ? classTable[id] : nullptr;
+}
+
+inline ClassInfo* VM::programClass(int32_t index) const {
+    return index >= 0 && index < static_cast<int32_t>(programClasses.size()) ? programClasses[index].get() : nullptr;
+}
+
+// Via de cls no cache: hit devolve o indice da via; miss ocupa uma via
+// livre (ou a proxima do rodizio com o cache cheio) e devolve ~indice para
+// o chamador resolver e preencher
+inline int VM::cacheWay(InlineCache& ic, ClassInfo* cls) {
+    for (int i = 0; i < ic.count; i++) {
+        if (ic.classes[i] == cls) {
+            icStats.hits++;
+            return i;
+        }
+    }
+    icStats.misses++;
+    int way;
+    if (ic.count < InlineCache::WAYS) {
+        way = ic.count++;
+    } else {
+        way = ic.victim;
+        ic.victim = static_cast<uint8_t>((ic.victim + 1) % InlineCache::WAYS);
+        icStats.evictions++;
+    }
+    ic.classes[way] = cls;
+    return ~way;
+}
+
+inline MethodInfo* VM::lookupMethod(int32_t site, ClassInfo* cls, int32_t selector, int32_t argc) {
+    if (selector < 0 || selector >= static_cast<int32_t>(symbols.size())) return nullptr;
+    if (site < 0 || site >= static_cast<int32_t>(inlineCaches.size())) {
+        return cls->findMethod(symbolIds[selector], argc);
+    }
+    InlineCache& ic = inlineCaches[site];
+    int way = cacheWay(ic, cls);
+    if (way >= 0) return ic.methods[way];
+    return ic.methods[~way] = cls->findMethod(symbolIds[selector], argc);
+}
+
+inline const FieldInfo* VM::lookupField(int32_t site, ClassInfo* cls, int32_t selector) {
+    if (selector < 0 || selector >= static_cast<int32_t>(symbols.size())) return nullptr;
+    if (site < 0 || site >= static_cast<int32_t>(inlineCaches.size())) {
+        return cls->findField(symbolIds[selector]);
+    }
+    InlineCache& ic = inlineCaches[site];
+    int way = cacheWay(ic, cls);
+    if (way >= 0) return ic.fields[way];
+    return ic.fields[~way] = cls->findField(symbolIds[selector]);
+}
+
+inline Value VM::loadField(GCObject* obj, const FieldInfo& field) {
+    switch (field.descriptor[0]) {
+        case 'L': return Value(obj->fieldAt<GCObject*>(field.offset));
+        case 'J': return Value(obj->fieldAt<int64_t>(field.offset));
+        case 'F': return Value(obj->fieldAt<float>(field.offset));
+        case 'D': return Value(obj->fieldAt<double>(field.offset));
+        default: return Value(obj->fieldAt<int32_t>(field.offset));
+    }
+}
+
+inline void VM::storeField(GCObject* obj, const FieldInfo& field, Value v) {
+    switch (field.descriptor[0]) {
+        case 'L': storeReference(obj, &obj->fieldAt<GCObject*>(field.offset), v.asObject()); break;
+        case 'J': obj->fieldAt<int64_t>(field.offset) = v.toLong(); break;
+        case 'F': obj->fieldAt<float>(field.offset) = static_cast<float>(v.toDouble()); break;
+        case 'D': obj->fieldAt<double>(field.offset) = v.toDouble(); break;
+        default: obj->fieldAt<int32_t>(field.offset) = v.asInt(); break;
+    }
+}
+
+// ============================================================
+// STRINGS, ROPES E STRINGBUILDER
+// ============================================================
+
+inline void VM::appendText(std::string& out, Value v) {
+    char buf[32];
+    switch (v.type()) {
+        case Value::Type::Int: out += std::to_string(v.asInt()); break;
+        case Value::Type::Long: out += std::to_string(v.asLong()); break;
+        case Value::Type::Float:
+        case Value::Type::Double:
+            // %g: mesmo formato do print (ostream com precisao padrao)
+            out.append(buf, static_cast<size_t>(std::snprintf(buf, sizeof(buf), "%g", v.toDouble())));
+            break;
+        case Value::Type::Object: {
+            GCObject* obj = v.asObject();
+            if (!obj) {
+                out += "null";
+            } else if (StringObjects::isText(obj)) {
+                StringObjects::appendTo(out, obj, ropeStack);
+            } else {
+                out.append(buf, static_cast<size_t>(std::snprintf(buf, sizeof(buf), "<object@%p>", static_cast<void*>(obj))));
+            }
+            break;
+        }
+        default: out += "null"; break;
+    }
+}
+
+inline std::string VM::textOf(Value v) {
+    std::string out;
+    if (StringObjects::isText(v.asObject())) StringObjects::appendTo(out, v.asObject(), ropeStack);
+    return out;
+}
+
+inline GCObject* VM::newStringBuilder(int32_t capacity) {
+    GCObject* builder = allocateOrCollect([&] {
+        GCObject* b = heap.allocate(0, GCObjectType::STRING_BUILDER, StringObjects::BUILDER_DATA_SIZE);
+        if (b) *reinterpret_cast<int32_t*>(b->data) = 1;
+        return b;
+    });
+    if (!builder || capacity <= 0) return builder;
+    stackPush(Value(builder));
+    GCObject* buffer = newArray(KAVA_T_BYTE, capacity);
+    builder = stackPop().asObject();
+    if (buffer) storeReference(builder, StringObjects::builderBuffer(builder), buffer);
+    return builder;
+}
+
+// Valores que nao sao String nem rope viram uma String com o texto do print
+// (StringBuilder: copia do conteudo atual)
+inline GCObject* VM::textAt(int32_t slot) {
+    GCObject* obj = execStack[slot].asObject();
+    if (StringObjects::isFlat(obj) || StringObjects::isRope(obj)) return obj;
+    textScratch.clear();
+    appendText(textScratch, execStack[slot]);
+    obj = newString(textScratch);
+    execStack[slot] = Value(obj);
+    return obj;
+}
+
+// O rope guarda a String plana no lugar dos filhos: o achatamento acontece
+// uma vez e os filhos podem ser coletados
+inline GCObject* VM::flatAt(int32_t slot) {
+    using namespace StringObjects;
+    GCObject* obj = textAt(slot);
+    if (!isRope(obj)) return obj;
+    if (GCObject* flat = flattened(obj)) return flat;
+    const int32_t len = ropeLength(obj);
+    GCObject* flat = allocateOrCollect([&] { return heap.allocateString(nullptr, static_cast<size_t>(len)); });
+    if (!flat) return nullptr;
+    GCObject* rope = execStack[slot].asObject();
+    copyTo(flatChars(flat), rope, ropeStack);
+    storeReference(rope, ropeLeft(rope), flat);
+    storeReference(rope, ropeRight(rope), nullptr);
+    return flat;
+}
+
+// OP_SCONCAT: a + b com algum lado String. Resultados curtos sao copiados;
+// longos viram um no de rope (O(1), sem copiar os operandos), entao montar
+// uma String em laco e linear e so o primeiro acesso indexado copia.
+inline void VM::concatStrings() {
+    using namespace StringObjects;
+    const int32_t a = execSP - 2;
+    const int32_t b = execSP - 1;
+    GCObject* result = nullptr;
+    if (textAt(a) && textAt(b)) {
+        const int64_t la = length(execStack[a].asObject());
+        const int64_t lb = length(execStack[b].asObject());
+        if (la == 0) {
+            result = execStack[b].asObject();
+        } else if (lb == 0) {
+            result = execStack[a].asObject();
+        } else if (la + lb <= ROPE_MIN_LENGTH) {
+            result = allocateOrCollect([&] { return heap.allocateString(nullptr, static_cast<size_t>(la + lb)); });
+            if (result) {
+                copyTo(flatChars(result), execStack[a].asObject(), ropeStack);
+                copyTo(flatChars(result) + la, execStack[b].asObject(), ropeStack);
+            }
+        } else if (la + lb <= INT32_MAX) {
+            result = allocateOrCollect([&] {
+                GCObject* r = heap.allocate(0, GCObjectType::STRING_ROPE, ROPE_DATA_SIZE);
+                if (r) *reinterpret_cast<int32_t*>(r->data) = 2;
+                return r;
+            });
+            if (result) {
+                storeReference(result, ropeLeft(result), execStack[a].asObject());
+                storeReference(result, ropeRight(result), execStack[b].asObject());
+                ropeLength(result) = static_cast<int32_t>(la + lb);
+            }
+        }
+    }
+    execSP -= 2;
+    stackPush(Value(result));
+}
+
+// OP_IADD: o compilador so emite SCONCAT quando prova uma String, entao
+// parametros e resultados sem tipo chegam aqui. Referencia de qualquer lado
+// concatena (texto como o do print); numeros seguem intArith.
+// Os dois operandos estao no topo de execStack.
+inline void VM::addValues() {
+    if (execStack[execSP - 2].isObject() || execStack[execSP - 1].isObject()) {
+        concatStrings();
+        return;
+    }
+    Value b = stackPop();
+    Value a = stackPop();
+    stackPush(intArith(OP_IADD, a, b));
+}
+
+// globals[idx] = a + b pelo mesmo caminho do OP_IADD
+inline void VM::addToGlobal(int32_t idx, Value a, Value b) {
+    if (!a.isObject() && !b.isObject()) {
+        globals[idx] = intArith(OP_IADD, a, b);
+        return;
+    }
+    stackPush(a);
+    stackPush(b);
+    addValues();
+    globals[idx] = stackPop();
+}
+
+// Sem tipo estatico o compilador emite IADD/ISUB/IMUL tambem para Longs:
+// com um Long de qualquer lado o resultado e de 64 bits (como LADD, com
+// wrap em complemento de 2); so entre ints fica o wrap de 32 bits.
+inline Value VM::intArith(int32_t op, Value a, Value b) {
+    if (a.isLong() || b.isLong()) {
+        const uint64_t x = static_cast<uint64_t>(a.toLong());
+        const uint64_t y = static_cast<uint64_t>(b.toLong());
+        const uint64_t r = op == OP_ISUB ? x - y : (op == OP_IMUL ? x * y : x + y);
+        return Value(static_cast<int64_t>(r));
+    }
+    const uint32_t x = static_cast<uint32_t>(a.asInt());
+    const uint32_t y = static_cast<uint32_t>(b.asInt());
+    const uint32_t r = op == OP_ISUB ? x - y : (op == OP_IMUL ? x * y : x + y);
+    return Value(static_cast<int32_t>(r));
+}
+
+// Conteudo igual (String.equals); compara o hash em cache antes dos bytes
+inline bool VM::textEquals(int32_t a, int32_t b) {
+    using namespace StringObjects;
+    GCObject* other = execStack[b].asObject();
+    if (!isFlat(other) && !isRope(other)) return false;
+    if (execStack[a].asObject() == other) return true;
+    if (length(execStack[a].asObject()) != length(other)) return false;
+    GCObject* y = flatAt(b);
+    GCObject* x = flatAt(a);  // achatar b pode ter movido a
+    if (!x || !y) return false;
+    return hash(x) == hash(y) && flatView(x) == flatView(y);
+}
+
+// append(v): Strings, ropes e builders sao copiados direto para o buffer;
+// outros valores passam pelo texto do print. Sem espaco, a capacidade dobra.
+inline bool VM::builderAppend(int32_t builderSlot, int32_t valueSlot) {
+    using namespace StringObjects;
+    GCObject* value = execStack[valueSlot].asObject();
+    const bool direct = isText(value);
+    size_t n;
+    if (direct) {
+        n = static_cast<size_t>(length(value));
+    } else {
+        textScratch.clear();
+        appendText(textScratch, execStack[valueSlot]);
+        n = textScratch.size();
+    }
+    GCObject* builder = execStack[builderSlot].asObject();
+    const int64_t used = builderLength(builder);
+    const int64_t needed = used + static_cast<int64_t>(n);
+    if (needed > INT32_MAX) return false;
+    if (needed > builderCapacity(builder)) {
+        const int64_t capacity = std::min<int64_t>(INT32_MAX, std::max<int64_t>({16, int64_t(builderCapacity(builder)) * 2, needed}));
+        GCObject* buffer = newArray(KAVA_T_BYTE, static_cast<int32_t>(capacity));
+        if (!buffer) return false;
+        builder = execStack[builderSlot].asObject();
+        if (used > 0) std::memcpy(buffer->data + sizeof(int32_t), builderChars(builder), static_cast<size_t>(used));
+        storeReference(builder, builderBuffer(builder), buffer);
+    }
+    char* dest = builderChars(builder) + used;
+    if (direct) copyTo(dest, execStack[valueSlot].asObject(), ropeStack);
+    else if (n > 0) std::memcpy(dest, textScratch.data(), n);
+    builderLength(builder) = static_cast<int32_t>(needed);
+    return true;
+}
+
+// Metodos embutidos. Receptor e argumentos ficam na pilha ate o fim (roots)
+// e o resultado toma o lugar deles; false deixa o INVOKE seguir o caminho
+// de receptor sem classe.
+inline bool VM::invokeStringMethod(int32_t selector, int32_t argc) {
+    using namespace StringObjects;
+    const int32_t self = execSP - argc - 1;
+    GCObject* obj = execStack[self].asObject();
+    if (!isText(obj) || selector < 0 || selector >= static_cast<int32_t>(symbolIds.size())) return false;
+    const int32_t name = symbolIds[selector];
+    const StringSelectors& sel = stringSelectors;
+    auto charAt = [](const char* chars, int32_t len, int32_t i) {
+        return i >= 0 && i < len ? Value(static_cast<int32_t>(static_cast<uint8_t>(chars[i]))) : Value();
+    };
+    
+    Value result;
+    if (name == sel.length && argc == 0) {
+        result = Value(length(obj));
+    } else if (name == sel.isEmpty && argc == 0) {
+        result = Value(length(obj) == 0 ? 1 : 0);
+    } else if (name == sel.charAt && argc == 1) {
+        const int32_t i = execStack[self + 1].toInt();
+        if (isBuilder(obj)) {
+            result = charAt(builderChars(obj), builderLength(obj), i);
+        } else if (GCObject* flat = flatAt(self)) {
+            result = charAt(flatChars(flat), flatLength(flat), i);
+        }
+    } else if (isBuilder(obj)) {
+        if (name == sel.append && argc == 1) {
+            if (builderAppend(self, self + 1)) result = execStack[self];
+        } else if (name == sel.toString && argc == 0) {
+            const int32_t len = builderLength(obj);
+            GCObject* str = allocateOrCollect([&] { return heap.allocateString(nullptr, static_cast<size_t>(len)); });
+            if (str && len > 0) std::memcpy(flatChars(str), builderChars(execStack[self].asObject()), static_cast<size_t>(len));
+            result = Value(str);
+        } else if (name == sel.clear && argc == 0) {
+            builderLength(obj) = 0;
+            result = execStack[self];
+        } else {
+            return false;
+        }
+    } else if (name == sel.toString && argc == 0) {
+        result = execStack[self];
+    } else if (name == sel.hashCode && argc == 0) {
+        if (GCObject* flat = flatAt(self)) result = Value(static_cast<int32_t>(hash(flat)));
+    } else if (name == sel.equals && argc == 1) {
+        result = Value(textEquals(self, self + 1) ? 1 : 0);
+    } else if (name == sel.intern && argc == 0) {
+        if (GCObject* flat = flatAt(self)) result = Value(internFlat(flat));
+    } else {
+        return false;
+    }
+    execSP = self;
+    stackPush(result);
+    return true;
+}
+
+// ============================================================
+// GRAFICOS
+// ============================================================
+
+// Um SetRenderDrawColor + FillRects por sequencia de mesma cor e um unico
+// RenderPresent por frame (antes: um present por retangulo)
+inline void VM::presentFrame() {
+#ifdef USE_SDL
+    static_assert(sizeof(GfxRect) == sizeof(SDL_Rect), "GfxRect deve ter o layout de SDL_Rect");
+    if (renderer) {
+        for (const GfxCommand& cmd : gfxFrame.frameCommands()) {
+            SDL_SetRenderDrawColor(renderer, cmd.r, cmd.g, cmd.b, cmd.a);
+            if (cmd.kind == GfxCommand::CLEAR) {
+                SDL_RenderClear(renderer);
+            } else {
+                SDL_RenderFillRects(renderer, reinterpret_cast<const SDL_Rect*>(gfxFrame.rectsAt(cmd.first)),
+                                    static_cast<int>(cmd.count));
+            }
+        }
+        SDL_RenderPresent(renderer);
+    }
+#endif
+    gfxFrame.reset();
+}
+
+// Esvazia a fila de eventos de uma vez: int[] com triplas {tipo, a, b}
+// (GfxEventKind). Sem SDL a fila esta sempre vazia.
+inline GCObject* VM::drainGfxEvents() {
+    gfxEventScratch.clear();
+#ifdef USE_SDL
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        int32_t kind = 0, a = 0, b = 0;
+        switch (event.type) {
+            case SDL_QUIT: kind = GFX_EVENT_QUIT; break;
+            case SDL_KEYDOWN: kind = GFX_EVENT_KEY_DOWN; a = event.key.keysym.sym; break;
+            case SDL_KEYUP: kind = GFX_EVENT_KEY_UP; a = event.key.keysym.sym; break;
+            case SDL_MOUSEBUTTONDOWN: kind = GFX_EVENT_MOUSE_DOWN; a = event.button.x; b = event.button.y; break;
+            case SDL_MOUSEBUTTONUP: kind = GFX_EVENT_MOUSE_UP; a = event.button.x; b = event.button.y; break;
+            case SDL_MOUSEMOTION: kind = GFX_EVENT_MOUSE_MOVE; a = event.motion.x; b = event.motion.y; break;
+            default: continue;
+        }
+        gfxEventScratch.insert(gfxEventScratch.end(), {kind, a, b});
+    }
+#endif
+    const int32_t n = static_cast<int32_t>(gfxEventScratch.size());
+    GCObject* arr = newArray(KAVA_T_INT, n);
+    if (!arr) return nullptr;
+    for (int32_t i = 0; i < n; i++) arr->arrayElement<int32_t>(i) = gfxEventScratch[i];
+    return arr;
+}
+
+// ============================================================
+// STREAM PIPELINE
+// ============================================================
+
+namespace StreamElements {
+
+inline bool isArray(const GCObject* obj) {
+    if (!obj) return false;
+    switch (obj->header.type) {
+        case GCObjectType::ARRAY_INT: case GCObjectType::ARRAY_LONG:
+        case GCObjectType::ARRAY_FLOAT: case GCObjectType::ARRAY_DOUBLE:
+        case GCObjectType::ARRAY_BYTE: case GCObjectType::ARRAY_CHAR:
+        case GCObjectType::ARRAY_SHORT: case GCObjectType::ARRAY_OBJECT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Arrays cujos elementos viram Value int (fonte aceita pelos kernels)
+inline bool isIntArray(const GCObject* obj) {
+    if (!obj) return false;
+    switch (obj->header.type) {
+        case GCObjectType::ARRAY_INT: case GCObjectType::ARRAY_BYTE:
+        case GCObjectType::ARRAY_CHAR: case GCObjectType::ARRAY_SHORT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+inline int32_t length(const GCObject* obj) {
+    return isArray(obj) ? obj->arrayLength() : 0;
+}
+
+inline size_t elementSize(const GCObject* arr) {
+    return Heap::arrayDataSize(arr->header.type, 1) - sizeof(int32_t);
+}
+
+inline uint8_t* address(GCObject* arr, int32_t i) {
+    return arr->dataAs<uint8_t>() + sizeof(int32_t) + static_cast<size_t>(i) * elementSize(arr);
+}
+
+inline Value at(GCObject* arr, int32_t i) {
+    switch (arr->header.type) {
+        case GCObjectType::ARRAY_INT: return Value(arr->arrayElement<int32_t>(i));
+        case GCObjectType::ARRAY_LONG: return Value(arr->arrayElement<int64_t>(i));
+        case GCObjectType::ARRAY_FLOAT: return Value(arr->arrayElement<float>(i));
+        case GCObjectType::ARRAY_DOUBLE: return Value(arr->arrayElement<double>(i));
+        case GCObjectType::ARRAY_BYTE: return Value(static_cast<int32_t>(arr->arrayElement<int8_t>(i)));
+        case GCObjectType::ARRAY_CHAR: return Value(static_cast<int32_t>(arr->arrayElement<uint16_t>(i)));
+        case GCObjectType::ARRAY_SHORT: return Value(static_cast<int32_t>(arr->arrayElement<int16_t>(i)));
+        case GCObjectType::ARRAY_OBJECT: return Value(arr->arrayElement<GCObject*>(i));
+        default: return Value();
+    }
+}
+
+inline bool isNumber(const Value& v) {
+    return v.isInt() || v.isLong() || v.isFloat() || v.isDouble();
+}
+
+// Ordem natural: numeros por valor (antes das referencias), referencias por identidade
+inline int compare(const Value& a, const Value& b) {
+    if (a.isInt() && b.isInt()) return a.asInt() < b.asInt() ? -1 : (a.asInt() > b.asInt() ? 1 : 0);
+    bool an = isNumber(a), bn = isNumber(b);
+    if (an && bn) {
+        if (a.isDouble() || a.isFloat() || b.isDouble() || b.isFloat()) {
+            double x = a.toDouble(), y = b.toDouble();
+            return x < y ? -1 : (x > y ? 1 : 0);
+        }
+        int64_t x = a.toLong(), y = b.toLong();
+        return x < y ? -1 : (x > y ? 1 : 0);
+    }
+    if (an != bn) return an ? -1 : 1;
+    return a.bits < b.bits ? -1 : (a.bits > b.bits ? 1 : 0);
+}
+
+// Chave do distinct: int e long pelo valor, o resto pelos bits (objetos por identidade)
+inline uint64_t key(const Value& v) {
+    if (v.isInt() || v.isLong()) return static_cast<uint64_t>(v.toLong());
+    return v.bits;
+}
+
+} // namespace StreamElements
+
+inline int32_t VM::newStream(Value source) {
+    int32_t index;
+    if (!freeStreams.empty()) {
+        index = freeStreams.back();
+        freeStreams.pop_back();
+    } else {
+        index = static_cast<int32_t>(streams.size());
+        streams.emplace_back();
+    }
+    streams[index] = std::make_unique<StreamPipeline>();
+    streams[index]->source = source;
+    return index;
+}
+
+inline StreamPipeline* VM::streamAt(Value handle) {
+    if (!handle.isStream()) return nullptr;
+    int32_t index = handle.asStream();
+    if (index < 0 || index >= static_cast<int32_t>(streams.size())) return nullptr;
+    return streams[index].get();
+}
+
+inline const LambdaKernel* VM::lambdaKernel(Value fn) {
+    if (!config.enableStreamKernels || !fn.isLambda()) return nullptr;
+    int32_t idx = fn.asLambda();
+    if (idx < 0 || idx >= static_cast<int32_t>(lambdaClosures.size())) return nullptr;
+    const LambdaClosure& closure = lambdaClosures[idx];
+    if (closure.codeStart < 0) return nullptr;
     
-    // Restore globals
-    for (size_t i = 0; i < savedGlobals.size(); i++) {
-        globals[i] = savedGlobals[i];
+    auto it = lambdaKernels.find(closure.codeStart);
+    if (it != lambdaKernels.end()) return it->second.get();
+    auto kernel = std::make_unique<LambdaKernel>();
+    if (!kernel->compile(scriptBytecode, closure.codeStart, closure.codeEnd, closure.paramCount)) {
+        kernel.reset();
+    }
+    return (lambdaKernels[closure.codeStart] = std::move(kernel)).get();
+}
+
+inline void VM::addStreamStage(StreamStage::Kind kind, Value fn, int64_t count) {
+    // Sem handle na pilha (bytecode anterior ao pipeline) a operacao nao tem efeito
+    StreamPipeline* p = streamAt(stackPeek());
+    if (!p) return;
+    StreamStage stage;
+    stage.kind = kind;
+    stage.fn = fn;
+    stage.count = count;
+    stage.kernel = lambdaKernel(fn);
+    p->stages.push_back(stage);
+}
+
+inline void VM::runStreamTerminal(StreamTerminal op, Value fn, Value identity, bool hasIdentity) {
+    Value handle = stackPop();
+    int32_t index = handle.isStream() ? handle.asStream() : newStream(handle);
+    StreamPipeline* p = streamAt(Value::stream(index));
+    if (!p || p->running) {
+        // Handle invalido ou terminal reentrante no mesmo pipeline
+        stackPush(Value());
+        return;
     }
+    p->running = true;
+    p->acc = identity;
+    
+    StreamStage terminal;
+    terminal.kind = StreamStage::Kind::Map;
+    terminal.fn = fn;
+    terminal.kernel = lambdaKernel(fn);
+    p->kernels = streamUsesKernels(*p, op, terminal);
     
+    StreamAccumulator acc(op, fn.isLambda() ? &terminal : nullptr, &p->acc, &p->output);
+    acc.has = hasIdentity;
+    if (!streamReduceArray(*p, acc) && !streamRunParallel(*p, acc)) streamDrive(*p, acc);
+    
+    Value result = streamResult(acc);
+    streams[index].reset();
+    freeStreams.push_back(index);
+    stackPush(result);
+}
+
+// Kernels so valem quando todo elemento do passe e int: fonte int e todos
+// os lambdas compilados (nenhum lambda interpretado grava globals no meio)
+inline bool VM::streamUsesKernels(const StreamPipeline& p, StreamTerminal op, const StreamStage& terminal) {
+    if (op == StreamTerminal::ForEach || !StreamElements::isIntArray(p.source.asObject())) return false;
+    auto compiled = [&](const StreamStage& s) {
+        return s.kernel && s.kernel->readsOnlyInts(globals);
+    };
+    for (const StreamStage& s : p.stages) {
+        switch (s.kind) {
+            case StreamStage::Kind::Filter:
+            case StreamStage::Kind::Map:
+                if (!compiled(s)) return false;
+                break;
+            case StreamStage::Kind::Sorted:
+                if (s.fn.isLambda() && !compiled(s)) return false;
+                break;
+            case StreamStage::Kind::FlatMap:
+                return false;
+            default:
+                break;
+        }
+    }
+    switch (op) {
+        case StreamTerminal::Reduce: case StreamTerminal::AnyMatch:
+        case StreamTerminal::AllMatch: case StreamTerminal::NoneMatch:
+            return compiled(terminal);
+        case StreamTerminal::Min: case StreamTerminal::Max:
+            return !terminal.fn.isLambda() || compiled(terminal);
+        default:
+            return true;
+    }
+}
+
+inline Value VM::streamCall(StreamPipeline& p, const StreamStage& s, Value& v) {
+    if (p.kernels) return Value(s.kernel->eval(v.asInt(), 0, globals.data()));
+    if (!s.fn.isLambda()) return Value();
+    // O lambda interpretado pode alocar: v fica como root durante a chamada
+    p.pinned.push_back(v);
+    Value result = executeLambda(s.fn.asLambda(), {v});
+    v = p.pinned.back();
+    p.pinned.pop_back();
     return result;
 }
 
+inline Value VM::streamCall2(StreamPipeline& p, const StreamStage& s, Value a, Value b) {
+    if (p.kernels) return Value(s.kernel->eval(a.asInt(), b.asInt(), globals.data()));
+    if (!s.fn.isLambda()) return Value();
+    return executeLambda(s.fn.asLambda(), {a, b});
+}
+
+template<typename Sink>
+inline bool VM::streamPush(StreamPipeline& p, StreamPass& pass, size_t stage, size_t end, Value v, Sink& sink) {
+    // false = nenhum elemento a mais e necessario (limit/anyMatch/findFirst)
+    for (; stage < end; stage++) {
+        const StreamStage& s = p.stages[stage];
+        switch (s.kind) {
+            case StreamStage::Kind::Filter:
+                if (!streamCall(p, s, v).toBool()) return true;
+                break;
+            case StreamStage::Kind::Map:
+                v = streamCall(p, s, v);
+                break;
+            case StreamStage::Kind::Skip:
+                if (pass.counters[stage] < s.count) {
+                    pass.counters[stage]++;
+                    return true;
+                }
+                break;
+            case StreamStage::Kind::Limit: {
+                if (pass.counters[stage] >= s.count) return false;
+                pass.counters[stage]++;
+                bool more = streamPush(p, pass, stage + 1, end, v, sink);
+                return more && pass.counters[stage] < s.count;
+            }
+            case StreamStage::Kind::Distinct:
+                if (!pass.seen[stage].insert(StreamElements::key(v)).second) return true;
+                break;
+            case StreamStage::Kind::FlatMap: {
+                Value inner = streamCall(p, s, v);
+                if (!StreamElements::isArray(inner.asObject())) return true;
+                // Array devolvido fica como root enquanto seus elementos descem
+                p.pinned.push_back(inner);
+                size_t slot = p.pinned.size() - 1;
+                bool more = true;
+                for (int32_t i = 0; more && i < StreamElements::length(p.pinned[slot].asObject()); i++) {
+                    more = streamPush(p, pass, stage + 1, end, StreamElements::at(p.pinned[slot].asObject(), i), sink);
+                }
+                p.pinned.pop_back();
+                return more;
+            }
+            case StreamStage::Kind::Sorted:
+                break;  // barreira: tratada por streamDrive
+        }
+    }
+    return sink(v);
+}
+
+inline void VM::streamDrive(StreamPipeline& p, StreamAccumulator& acc) {
+    // Cada sorted() fecha um segmento: o que chega nele vai para p.pending,
+    // e ordenado e vira a fonte (p.buffer) do segmento seguinte
+    size_t begin = 0;
+    bool fromBuffer = false;
+    for (;;) {
+        size_t barrier = begin;
+        while (barrier < p.stages.size() && p.stages[barrier].kind != StreamStage::Kind::Sorted) barrier++;
+        const bool last = barrier == p.stages.size();
+        
+        StreamPass pass(p.stages.size());
+        auto sink = [&](Value v) {
+            if (last) return streamAccept(p, acc, v);
+            p.pending.push_back(v);
+            return true;
+        };
+        if (fromBuffer) {
+            for (size_t i = 0; i < p.buffer.size(); i++) {
+                if (!streamPush(p, pass, begin, barrier, p.buffer[i], sink)) break;
+            }
+        } else if (p.lines) {
+            // Files.lines: so a linha atual vira String; o buffer do reader e fixo
+            std::string_view line;
+            while (p.lines->nextLine(line)) {
+                if (!streamPush(p, pass, begin, barrier, Value(newString(line)), sink)) break;
+            }
+        } else {
+            // A fonte e relida a cada elemento: o GC pode move-la
+            int32_t n = StreamElements::length(p.source.asObject());
+            for (int32_t i = 0; i < n; i++) {
+                if (!streamPush(p, pass, begin, barrier, StreamElements::at(p.source.asObject(), i), sink)) break;
+            }
+        }
+        if (last) return;
+        
+        streamSort(p, p.stages[barrier]);
+        begin = barrier + 1;
+        fromBuffer = true;
+    }
+}
+
+inline void VM::streamSort(StreamPipeline& p, const StreamStage& s) {
+    // Estavel como no Java. Ordena indices: o comparador interpretado pode
+    // disparar GC, que atualiza p.pending mas nao copias fora dele
+    std::vector<int32_t> order(p.pending.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (s.fn.isLambda()) {
+        std::stable_sort(order.begin(), order.end(), [&](int32_t x, int32_t y) {
+            return streamCall2(p, s, p.pending[x], p.pending[y]).toInt() < 0;
+        });
+    } else {
+        std::stable_sort(order.begin(), order.end(), [&](int32_t x, int32_t y) {
+            return StreamElements::compare(p.pending[x], p.pending[y]) < 0;
+        });
+    }
+    p.buffer.clear();
+    for (int32_t i : order) p.buffer.push_back(p.pending[i]);
+    p.pending.clear();
+}
+
+inline bool VM::streamPrefer(StreamPipeline& p, const StreamAccumulator& acc, Value& v) {
+    int c;
+    if (acc.fn) {
+        if (!p.kernels) p.pinned.push_back(v);
+        c = streamCall2(p, *acc.fn, v, *acc.value).toInt();
+        if (!p.kernels) {
+            v = p.pinned.back();
+            p.pinned.pop_back();
+        }
+    } else {
+        c = StreamElements::compare(v, *acc.value);
+    }
+    return acc.op == StreamTerminal::Min ? c < 0 : c > 0;
+}
+
+inline bool VM::streamAccept(StreamPipeline& p, StreamAccumulator& acc, Value v) {
+    acc.count++;
+    switch (acc.op) {
+        case StreamTerminal::Count:
+            return true;
+        case StreamTerminal::Sum:
+            if (v.isDouble() || v.isFloat()) {
+                acc.anyDouble = true;
+                acc.doubleSum += v.toDouble();
+            } else {
+                acc.longSum += v.toLong();
+            }
+            return true;
+        case StreamTerminal::Min:
+        case StreamTerminal::Max:
+            if (!acc.has || streamPrefer(p, acc, v)) {
+                *acc.value = v;
+                acc.has = true;
+            }
+            return true;
+        case StreamTerminal::Reduce:
+            if (!acc.has) {
+                *acc.value = v;
+                acc.has = true;
+            } else if (acc.fn) {
+                Value next = streamCall2(p, *acc.fn, *acc.value, v);
+                *acc.value = next;
+            }
+            return true;
+        case StreamTerminal::ForEach:
+            if (acc.fn) streamCall(p, *acc.fn, v);
+            return true;
+        case StreamTerminal::Collect:
+            acc.out->push_back(v);
+            return true;
+        case StreamTerminal::AnyMatch:
+        case StreamTerminal::NoneMatch:
+            if (acc.fn && streamCall(p, *acc.fn, v).toBool()) {
+                acc.matched = true;
+                return false;
+            }
+            return true;
+        case StreamTerminal::AllMatch:
+            if (!acc.fn || !streamCall(p, *acc.fn, v).toBool()) {
+                acc.matched = true;
+                return false;
+            }
+            return true;
+        case StreamTerminal::FindFirst:
+            *acc.value = v;
+            acc.has = true;
+            return false;
+    }
+    return true;
+}
+
+// parallel(): fonte int e so filter/map com kernels. A fonte e dividida em
+// chunks consumidos pelo commonPool e pela thread da VM; os parciais sao
+// combinados na ordem dos chunks (reduce exige operador associativo, como
+// no Java). Sem alocacao nem lambdas interpretados, o GC nao roda no meio.
+inline bool VM::streamRunParallel(StreamPipeline& p, StreamAccumulator& acc) {
+    if (!p.parallel || !p.kernels) return false;
+    for (const StreamStage& s : p.stages) {
+        if (s.kind != StreamStage::Kind::Filter && s.kind != StreamStage::Kind::Map) return false;
+    }
+    GCObject* src = p.source.asObject();
+    const int32_t n = StreamElements::length(src);
+    const int chunks = streamChunkCount(p, n);
+    if (chunks <= 1) return false;
+    const int32_t chunkSize = (n + chunks - 1) / chunks;
+    std::vector<Value> values(chunks);
+    std::vector<std::vector<Value>> outs(chunks);
+    std::vector<StreamAccumulator> parts;
+    parts.reserve(chunks);
+    for (int c = 0; c < chunks; c++) parts.emplace_back(acc.op, acc.fn, &values[c], &outs[c]);
+    
+    // anyMatch/allMatch/noneMatch: o primeiro resultado decide para todos
+    const bool globalStop = acc.op == StreamTerminal::AnyMatch || acc.op == StreamTerminal::AllMatch ||
+                            acc.op == StreamTerminal::NoneMatch;
+    std::atomic<bool> stop{false};
+    streamParallelFor(chunks, [&](int c) {
+        if (stop.load(std::memory_order_relaxed)) return;
+        StreamAccumulator& part = parts[c];
+        StreamPass pass(p.stages.size());
+        auto sink = [&](Value v) { return streamAccept(p, part, v); };
+        const int32_t hi = std::min(n, (c + 1) * chunkSize);
+        for (int32_t i = c * chunkSize; i < hi; i++) {
+            if (!streamPush(p, pass, 0, p.stages.size(), StreamElements::at(src, i), sink)) {
+                if (globalStop) stop.store(true, std::memory_order_relaxed);
+                break;
+            }
+            if ((i & 1023) == 0 && stop.load(std::memory_order_relaxed)) break;
+        }
+    });
+    
+    for (int c = 0; c < chunks; c++) {
+        StreamAccumulator& part = parts[c];
+        acc.count += part.count;
+        acc.longSum += part.longSum;
+        acc.doubleSum += part.doubleSum;
+        acc.anyDouble = acc.anyDouble || part.anyDouble;
+        acc.matched = acc.matched || part.matched;
+        if (acc.op == StreamTerminal::Collect) acc.out->insert(acc.out->end(), outs[c].begin(), outs[c].end());
+        if (!part.has) continue;
+        Value v = *part.value;
+        switch (acc.op) {
+            case StreamTerminal::Min:
+            case StreamTerminal::Max:
+                if (!acc.has || streamPrefer(p, acc, v)) *acc.value = v;
+                break;
+            case StreamTerminal::Reduce:
+                *acc.value = acc.has ? streamCall2(p, *acc.fn, *acc.value, v) : v;
+                break;
+            case StreamTerminal::FindFirst:
+                if (!acc.has) *acc.value = v;
+                break;
+            default:
+                break;
+        }
+        acc.has = true;
+    }
+    return true;
+}
+
+// Chunks de um terminal paralelo com n elementos (1 = roda sequencial)
+inline int VM::streamChunkCount(const StreamPipeline& p, int32_t n) {
+    if (!p.parallel || n < STREAM_PARALLEL_MIN) return 1;
+    const int helpers = ForkJoinPool::commonPool().getParallelism();
+    if (helpers < 1) return 1;
+    return std::min((helpers + 1) * 4, (n + STREAM_CHUNK_MIN - 1) / STREAM_CHUNK_MIN);
+}
+
+// body(c) roda uma vez para cada chunk, no commonPool e na thread da VM
+template<typename Body>
+inline void VM::streamParallelFor(int chunks, Body&& body) {
+    ForkJoinPool& pool = ForkJoinPool::commonPool();
+    std::atomic<int> next{0};
+    auto drain = [&] {
+        for (int c = next.fetch_add(1); c < chunks; c = next.fetch_add(1)) body(c);
+    };
+    const int tasks = std::min(pool.getParallelism(), chunks - 1);
+    CountDownLatch latch(tasks);
+    for (int t = 0; t < tasks; t++) {
+        pool.execute([&drain, &latch] {
+            drain();
+            latch.countDown();
+        });
+    }
+    drain();
+    latch.await();
+}
+
+// Fonte primitiva (int/long/float/double/byte) so com skip/limit e
+// count/sum/min/max sem comparador: a terminal roda direto sobre o bloco
+// de elementos com os kernels de simd.h, em chunks se o stream for paralelo.
+// Os kernels nao alocam, entao o GC nao move a fonte no meio.
+inline bool VM::streamReduceArray(StreamPipeline& p, StreamAccumulator& acc) {
+    if (acc.fn) return false;
+    if (acc.op != StreamTerminal::Count && acc.op != StreamTerminal::Sum &&
+        acc.op != StreamTerminal::Min && acc.op != StreamTerminal::Max) return false;
+    GCObject* src = p.source.asObject();
+    if (!StreamElements::isArray(src)) return false;
+    switch (src->header.type) {
+        case GCObjectType::ARRAY_INT: case GCObjectType::ARRAY_LONG:
+        case GCObjectType::ARRAY_FLOAT: case GCObjectType::ARRAY_DOUBLE:
+        case GCObjectType::ARRAY_BYTE:
+            break;
+        default:
+            return false;
+    }
+    int64_t lo = 0, hi = src->arrayLength();
+    for (const StreamStage& s : p.stages) {
+        if (s.kind == StreamStage::Kind::Skip) lo = std::min(hi, lo + std::max<int64_t>(0, s.count));
+        else if (s.kind == StreamStage::Kind::Limit) hi = std::min(hi, lo + std::max<int64_t>(0, s.count));
+        else return false;
+    }
+    const int32_t n = static_cast<int32_t>(hi - lo);
+    acc.count = n;
+    if (acc.op == StreamTerminal::Count || n == 0) return true;
+    
+    const Simd::Kernels& k = simd();
+    const int chunks = streamChunkCount(p, n);
+    const int32_t chunkSize = (n + chunks - 1) / chunks;
+    auto reduce = [&](const auto* data, auto sum, auto minMax) {
+        using T = std::remove_cv_t<std::remove_pointer_t<decltype(data)>>;
+        const T* base = data + lo;
+        auto range = [&](int c, auto kernel) {
+            const int32_t from = c * chunkSize;
+            return kernel(base + from, static_cast<size_t>(std::min(n, from + chunkSize) - from));
+        };
+        if (acc.op == StreamTerminal::Sum) {
+            std::vector<decltype(sum(base, 0))> parts(chunks);
+            if (chunks == 1) parts[0] = sum(base, n);
+            else streamParallelFor(chunks, [&](int c) { parts[c] = range(c, sum); });
+            for (auto part : parts) {
+                if constexpr (std::is_floating_point<T>::value) acc.doubleSum += part;
+                else acc.longSum += part;
+            }
+            acc.anyDouble = std::is_floating_point<T>::value;
+            return;
+        }
+        std::vector<Simd::MinMax<T>> parts(chunks);
+        if (chunks == 1) parts[0] = minMax(base, n);
+        else streamParallelFor(chunks, [&](int c) { parts[c] = range(c, minMax); });
+        // Combinacao na ordem dos chunks; NaN de qualquer chunk vence
+        const bool min = acc.op == StreamTerminal::Min;
+        T best = min ? parts[0].min : parts[0].max;
+        for (const auto& part : parts) {
+            T v = min ? part.min : part.max;
+            if (best != best) break;
+            if (v != v || (min ? v < best : v > best)) best = v;
+        }
+        *acc.value = Value(best);
+        acc.has = true;
+    };
+    switch (src->header.type) {
+        case GCObjectType::ARRAY_INT: reduce(&src->arrayElement<int32_t>(0), k.sumI32, k.minMaxI32); break;
+        case GCObjectType::ARRAY_LONG: reduce(&src->arrayElement<int64_t>(0), k.sumI64, k.minMaxI64); break;
+        case GCObjectType::ARRAY_FLOAT: reduce(&src->arrayElement<float>(0), k.sumF32, k.minMaxF32); break;
+        case GCObjectType::ARRAY_DOUBLE: reduce(&src->arrayElement<double>(0), k.sumF64, k.minMaxF64); break;
+        case GCObjectType::ARRAY_BYTE: reduce(&src->arrayElement<int8_t>(0), k.sumI8, k.minMaxI8); break;
+        default: break;
+    }
+    return true;
+}
+
+inline Value VM::streamResult(StreamAccumulator& acc) {
+    switch (acc.op) {
+        case StreamTerminal::Count:
+            return Value(static_cast<int32_t>(acc.count));
+        case StreamTerminal::Sum:
+            if (acc.anyDouble) return Value(acc.doubleSum + static_cast<double>(acc.longSum));
+            return Value(acc.longSum);
+        case StreamTerminal::Min:
+        case StreamTerminal::Max:
+        case StreamTerminal::Reduce:
+        case StreamTerminal::FindFirst:
+            return acc.has ? *acc.value : Value();
+        case StreamTerminal::Collect:
+            return Value(streamToArray(*acc.out));
+        case StreamTerminal::AnyMatch:
+            return Value(acc.matched ? 1 : 0);
+        case StreamTerminal::AllMatch:
+        case StreamTerminal::NoneMatch:
+            return Value(acc.matched ? 0 : 1);
+        case StreamTerminal::ForEach:
+            break;
+    }
+    return Value();
+}
+
+inline GCObject* VM::streamToArray(const std::vector<Value>& items) {
+    // Array primitivo do tipo mais largo presente (int -> long -> double);
+    // so referencias -> array de objetos. items e root durante a alocacao.
+    bool anyNumber = false, anyLong = false, anyDouble = false;
+    for (const Value& v : items) {
+        if (v.isDouble() || v.isFloat()) anyDouble = true;
+        else if (v.isLong()) anyLong = true;
+        anyNumber = anyNumber || StreamElements::isNumber(v);
+    }
+    const int32_t n = static_cast<int32_t>(items.size());
+    if (n > 0 && !anyNumber) {
+        GCObject* arr = newObjectArray(nullptr, n);
+        if (!arr) return nullptr;
+        for (int32_t i = 0; i < n; i++) {
+            storeReference(arr, &arr->arrayElement<GCObject*>(i), items[i].asObject());
+        }
+        return arr;
+    }
+    GCObject* arr = newArray(anyDouble ? KAVA_T_DOUBLE : (anyLong ? KAVA_T_LONG : KAVA_T_INT), n);
+    if (!arr) return nullptr;
+    for (int32_t i = 0; i < n; i++) {
+        if (anyDouble) arr->arrayElement<double>(i) = items[i].toDouble();
+        else if (anyLong) arr->arrayElement<int64_t>(i) = items[i].toLong();
+        else arr->arrayElement<int32_t>(i) = items[i].toInt();
+    }
+    return arr;
+}
+
+// ============================================================
+// ARRAYS
+// ============================================================
+
+inline Value VM::arrayLoad(GCObject* arr, int32_t index) {
+    if (!StreamElements::isArray(arr)) return Value(0);
+    return StreamElements::at(arr, index);
+}
+
+inline void VM::arrayStore(GCObject* arr, int32_t index, Value v) {
+    if (!StreamElements::isArray(arr)) return;
+    switch (arr->header.type) {
+        case GCObjectType::ARRAY_INT: arr->arrayElement<int32_t>(index) = v.toInt(); break;
+        case GCObjectType::ARRAY_LONG: arr->arrayElement<int64_t>(index) = v.toLong(); break;
+        case GCObjectType::ARRAY_FLOAT: arr->arrayElement<float>(index) = static_cast<float>(v.toDouble()); break;
+        case GCObjectType::ARRAY_DOUBLE: arr->arrayElement<double>(index) = v.toDouble(); break;
+        case GCObjectType::ARRAY_BYTE: arr->arrayElement<int8_t>(index) = static_cast<int8_t>(v.toInt()); break;
+        case GCObjectType::ARRAY_CHAR: arr->arrayElement<uint16_t>(index) = static_cast<uint16_t>(v.toInt()); break;
+        case GCObjectType::ARRAY_SHORT: arr->arrayElement<int16_t>(index) = static_cast<int16_t>(v.toInt()); break;
+        case GCObjectType::ARRAY_OBJECT:
+            storeReference(arr, &arr->arrayElement<GCObject*>(index), v.asObject());
+            break;
+        default: break;
+    }
+}
+
+inline void VM::arrayCopy(GCObject* src, int32_t srcPos, GCObject* dst, int32_t dstPos, int32_t length) {
+    if (!StreamElements::isArray(src) || !StreamElements::isArray(dst)) return;
+    if (src->header.type != dst->header.type || length <= 0 || srcPos < 0 || dstPos < 0) return;
+    if (static_cast<int64_t>(srcPos) + length > src->arrayLength() ||
+        static_cast<int64_t>(dstPos) + length > dst->arrayLength()) return;
+    if (src->header.type != GCObjectType::ARRAY_OBJECT) {
+        // memmove da libc ja e vetorizada e trata sobreposicao
+        std::memmove(StreamElements::address(dst, dstPos), StreamElements::address(src, srcPos),
+                     static_cast<size_t>(length) * StreamElements::elementSize(src));
+        return;
+    }
+    // Referencias passam pela barreira; copia de tras para frente quando o
+    // destino sobrepoe o fim da origem no mesmo array
+    if (src == dst && srcPos < dstPos) {
+        for (int32_t i = length - 1; i >= 0; i--) {
+            storeReference(dst, &dst->arrayElement<GCObject*>(dstPos + i), src->arrayElement<GCObject*>(srcPos + i));
+        }
+    } else {
+        for (int32_t i = 0; i < length; i++) {
+            storeReference(dst, &dst->arrayElement<GCObject*>(dstPos + i), src->arrayElement<GCObject*>(srcPos + i));
+        }
+    }
+}
+
+inline void VM::arrayFill(GCObject* arr, int32_t from, int32_t to, Value v) {
+    if (!StreamElements::isArray(arr) || from < 0 || from >= to || to > arr->arrayLength()) return;
+    uint64_t pattern = 0;
+    switch (arr->header.type) {
+        case GCObjectType::ARRAY_OBJECT:
+            for (int32_t i = from; i < to; i++) storeReference(arr, &arr->arrayElement<GCObject*>(i), v.asObject());
+            return;
+        case GCObjectType::ARRAY_LONG:
+            pattern = static_cast<uint64_t>(v.toLong());
+            break;
+        case GCObjectType::ARRAY_FLOAT: {
+            float f = static_cast<float>(v.toDouble());
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            pattern = bits;
+            break;
+        }
+        case GCObjectType::ARRAY_DOUBLE: {
+            double d = v.toDouble();
+            std::memcpy(&pattern, &d, sizeof(pattern));
+            break;
+        }
+        default:
+            // int/byte/char/short: o kernel usa so os bytes baixos
+            pattern = static_cast<uint32_t>(v.toInt());
+            break;
+    }
+    simd().fill(StreamElements::address(arr, from), static_cast<size_t>(to - from),
+                StreamElements::elementSize(arr), pattern);
+}
+
+// Indice do primeiro elemento diferente; o tamanho menor se um array for
+// prefixo do outro; -1 se forem iguais. Tipos diferentes diferem no indice 0.
+// Comparacao por bits (float/double como floatToRawIntBits, objetos por identidade).
+inline int32_t VM::arrayMismatch(GCObject* a, GCObject* b) {
+    if (a == b) return -1;
+    if (!StreamElements::isArray(a) || !StreamElements::isArray(b) || a->header.type != b->header.type) return 0;
+    const int32_t n = std::min(a->arrayLength(), b->arrayLength());
+    const size_t elem = StreamElements::elementSize(a);
+    int64_t byte = n > 0 ? simd().mismatch(StreamElements::address(a, 0), StreamElements::address(b, 0),
+                                           static_cast<size_t>(n) * elem) : -1;
+    if (byte >= 0) return static_cast<int32_t>(byte / static_cast<int64_t>(elem));
+    return a->arrayLength() == b->arrayLength() ? -1 : n;
+}
+
 inline GCObject* VM::newInstance(ClassInfo* cls) {
     if (!cls) return nullptr;
-    GCObject* obj = heap.allocate(cls->classId, GCObjectType::INSTANCE, cls->instanceSize);
-    if (obj) objectsAllocated++;
-    if (heap.needsGC() && config.enableGC) collectGarbage();
-    return obj;
+    // Campos zerados pelo heap; a contagem de referencias guia o GC
+    const size_t size = std::max<size_t>(cls->instanceSize, sizeof(int32_t));
+    return allocateOrCollect([&] {
+        GCObject* obj = heap.allocate(cls->classId, GCObjectType::INSTANCE, size);
+        if (obj) *reinterpret_cast<int32_t*>(obj->data) = cls->referenceFieldCount;
+        return obj;
+    });
 }
 
 inline GCObject* VM::newArray(int type, int32_t length) {
@@ -1194,35 +4301,129 @@ inline GCObject* VM::newArray(int type, int32_t length) {
         case KAVA_T_DOUBLE: objType = GCObjectType::ARRAY_DOUBLE; break;
         default: objType = GCObjectType::ARRAY_INT; break;
     }
-    GCObject* obj = heap.allocateArray(objType, length);
-    if (obj) objectsAllocated++;
-    return obj;
+    return allocateOrCollect([&] { return heap.allocateArray(objType, length); });
 }
 
-inline GCObject* VM::newString(const std::string& str) {
-    GCObject* obj = heap.allocateString(str.c_str(), str.length());
-    if (obj) objectsAllocated++;
-    return obj;
+inline GCObject* VM::newObjectArray(ClassInfo* elemClass, int32_t length) {
+    uint32_t classId = elemClass ? static_cast<uint32_t>(elemClass->classId) : 0;
+    return allocateOrCollect([&] {
+        GCObject* arr = heap.allocateArray(GCObjectType::ARRAY_OBJECT, length);
+        if (arr) arr->header.classId = classId;
+        return arr;
+    });
 }
 
-inline GCObject* VM::internString(const std::string& str) {
-    auto it = internedStrings.find(str);
-    if (it != internedStrings.end()) return it->second;
+inline GCObject* VM::newString(std::string_view str) {
+    return allocateOrCollect([&] { return heap.allocateString(str.data(), str.size()); });
+}
+
+inline GCObject* VM::internString(std::string_view str) {
+    const uint32_t hash = StringObjects::hashBytes(str.data(), str.size());
+    if (GCObject* found = internedStrings.find(str, hash)) return found;
     GCObject* obj = newString(str);
-    if (obj) internedStrings[str] = obj;
+    if (obj) {
+        obj->header.classId = hash;
+        internedStrings.insert(obj, hash);
+    }
     return obj;
 }
 
+// A propria String entra na tabela quando o conteudo ainda nao esta la
+inline GCObject* VM::internFlat(GCObject* flat) {
+    const uint32_t hash = StringObjects::hash(flat);
+    if (GCObject* found = internedStrings.find(StringObjects::flatView(flat), hash)) return found;
+    internedStrings.insert(flat, hash);
+    return flat;
+}
+
 inline void VM::collectGarbage() {
-    gc.setRootScanner([this](GCObject*&) {
-        for (auto& g : globals) {
-            if (g.isObject() && g.asObject()) gc.addRoot(&g.data.obj);
-        }
-        for (auto& pair : internedStrings) {
-            if (pair.second) gc.addRoot(&pair.second);
+    const uint8_t previous = profiler.state;
+    profiler.state = Profiler::GC;
+    gc.collect();
+    profiler.state = previous;
+}
+
+inline void VM::scanRoots(const GarbageCollector::RootVisitor& visit) {
+    // Object guarda o GCObject* cru, entao o proprio slot e atualizado pelo
+    // coletor; Long boxeado tem tag nos bits altos e e regravado aqui
+    auto visitValue = [&](Value& v) {
+        if (v.isObject()) {
+            if (v.asObject()) visit(*v.objectSlot());
+        } else if (v.isBoxedLong()) {
+            GCObject* cell = v.boxedLongCell();
+            visit(cell);
+            v.bits = Value::TAG_LONG_BOX | (reinterpret_cast<uintptr_t>(cell) & Value::POINTER_MASK);
         }
+    };
+    for (auto& g : globals) visitValue(g);
+    for (int i = 0; i < execSP; i++) visitValue(execStack[i]);
+    for (auto& closure : lambdaClosures) {
+        for (auto& v : closure.captures) visitValue(v);
+    }
+    for (auto& p : streams) {
+        if (!p) continue;
+        visitValue(p->source);
+        visitValue(p->acc);
+        for (auto& v : p->buffer) visitValue(v);
+        for (auto& v : p->pending) visitValue(v);
+        for (auto& v : p->pinned) visitValue(v);
+        for (auto& v : p->output) visitValue(v);
+    }
+    for (auto& cls : programClasses) {
+        for (auto& v : cls->staticFieldValues) visitValue(v);
+    }
+    // Locais e operandos dos frames moram em execStack; os das corrotinas
+    // suspensas e os valores das promises ficam fora dela
+    for (int i = 0; i < frameCount; i++) {
+        if (frames[i].pendingException) visit(frames[i].pendingException);
+    }
+    for (auto& co : coroutines) {
+        for (auto& v : co.slots) visitValue(v);
+    }
+    eventLoop.forEachPromiseValue([&](uint64_t& bits) {
+        Value v;
+        v.bits = bits;
+        visitValue(v);
+        bits = v.bits;
     });
-    gc.collect();
+    internedStrings.forEach(visit);
+    for (auto& str : stringConstants) {
+        if (str) visit(str);
+    }
+    if (thrownException) visit(thrownException);
+}
+
+// Referencias ciclicas param em JSON_MAX_DEPTH (o resto sai como null)
+inline void VM::appendJson(JsonWriter& w, Value v, int depth) {
+    switch (v.type()) {
+        case Value::Type::Int: w.value(static_cast<int64_t>(v.asInt())); return;
+        case Value::Type::Long: w.value(v.asLong()); return;
+        case Value::Type::Float:
+        case Value::Type::Double: w.value(v.toDouble()); return;
+        case Value::Type::Object: break;
+        default: w.value(nullptr); return;
+    }
+    GCObject* obj = v.asObject();
+    if (!obj || depth >= JSON_MAX_DEPTH) {
+        w.value(nullptr);
+    } else if (StringObjects::isText(obj)) {
+        textScratch.clear();
+        StringObjects::appendTo(textScratch, obj, ropeStack);
+        w.value(std::string_view(textScratch));
+    } else if (StreamElements::isArray(obj)) {
+        w.beginArray();
+        for (int32_t i = 0; i < StreamElements::length(obj); i++) appendJson(w, StreamElements::at(obj, i), depth + 1);
+        w.endArray();
+    } else if (ClassInfo* cls = instanceClass(obj)) {
+        w.beginObject();
+        for (const FieldInfo& field : cls->fields) {
+            w.key(field.name);
+            appendJson(w, loadField(obj, field), depth + 1);
+        }
+        w.endObject();
+    } else {
+        w.value(nullptr);
+    }
 }
 
 inline void VM::registerBuiltinNatives() {
@@ -1262,14 +4463,196 @@ inline void VM::registerBuiltinNatives() {
         return Value(std::log(args[0].toDouble()));
     });
     
-    registerNative("Thread.sleep", [](VM*, Frame*, const std::vector<Value>& args) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(args[0].toLong()));
+    // Natives que bloqueiam sem tocar no heap ficam numa BlockingRegion:
+    // contam como paradas e nao seguram o stopTheWorld de outra mutadora
+    registerNative("Thread.sleep", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        const int64_t ms = args[0].toLong();
+        Heap::BlockingRegion region(vm->heap);
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
         return Value();
     });
+    
+    registerNative("System.arraycopy", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        vm->arrayCopy(args[0].asObject(), args[1].toInt(), args[2].asObject(), args[3].toInt(), args[4].toInt());
+        return Value();
+    });
+    registerNative("Arrays.fill", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        GCObject* arr = args[0].asObject();
+        if (args.size() >= 4) vm->arrayFill(arr, args[1].toInt(), args[2].toInt(), args[3]);
+        else vm->arrayFill(arr, 0, StreamElements::length(arr), args[1]);
+        return Value();
+    });
+    registerNative("Arrays.equals", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        GCObject* a = args[0].asObject();
+        GCObject* b = args[1].asObject();
+        bool same = a == b || (StreamElements::length(a) == StreamElements::length(b) && vm->arrayMismatch(a, b) < 0);
+        return Value(same ? 1 : 0);
+    });
+    registerNative("Arrays.mismatch", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        return Value(vm->arrayMismatch(args[0].asObject(), args[1].asObject()));
+    });
+    
+    // Files.*: arquivo do disco sem iostreams (files.h). lines() e um
+    // pipeline cuja fonte le uma linha por vez: arquivos maiores que o heap
+    // passam pelo stream sem serem carregados.
+    registerNative("Files.lines", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        const std::string path = vm->textOf(args[0]);
+        auto reader = std::make_unique<FileReader>();
+        {
+            Heap::BlockingRegion region(vm->heap);
+            reader->open(path);
+        }
+        if (!reader->isOpen()) return Value();
+        const int32_t index = vm->newStream(Value());
+        vm->streams[index]->lines = std::move(reader);
+        return Value::stream(index);
+    });
+    registerNative("Files.size", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        const std::string path = vm->textOf(args[0]);
+        int64_t size = -1;
+        {
+            Heap::BlockingRegion region(vm->heap);
+            OpenFile file{path};
+            if (file.isOpen()) size = static_cast<int64_t>(file.size());
+        }
+        return Value(size);
+    });
+    // Conteudo inteiro: mmap + uma copia direto para o objeto do heap
+    registerNative("Files.readString", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        MappedFile file = vm->mapFile(args[0]);
+        if (!file.isOpen() || file.size() > static_cast<size_t>(INT32_MAX)) return Value();
+        return Value(vm->newString(file.view()));
+    });
+    registerNative("Files.readBytes", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        MappedFile file = vm->mapFile(args[0]);
+        if (!file.isOpen() || file.size() > static_cast<size_t>(INT32_MAX)) return Value();
+        GCObject* arr = vm->newArray(KAVA_T_BYTE, static_cast<int32_t>(file.size()));
+        if (arr && file.size() > 0) std::memcpy(StreamElements::address(arr, 0), file.data(), file.size());
+        return Value(arr);
+    });
+    
+    // Json.*: a VM nao tem tipo mapa, entao valores JSON circulam como String
+    // com o texto. parse monta o DOM na arena (json.h) e devolve o texto
+    // normalizado; as consultas por ponteiro ("/itens/0/nome") usam o modo
+    // sob demanda: so o estagio 1 roda e as subarvores fora do caminho sao
+    // puladas sem montar nada. Ausente, de outro tipo ou malformado: null.
+    registerNative("Json.parse", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        const std::string text = vm->textOf(args[0]);
+        JsonDocument doc = JsonDocument::parse(text);
+        if (!doc.ok()) return Value();
+        JsonWriter w(text.size());
+        w.value(doc.root());
+        return Value(vm->newString(w.str()));
+    });
+    registerNative("Json.error", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        const std::string text = vm->textOf(args[0]);
+        JsonDocument doc = JsonDocument::parse(text);
+        if (doc.ok()) return Value(vm->newString("ok"));
+        return Value(vm->newString(std::string(jsonErrorName(doc.error())) + " (byte " + std::to_string(doc.errorOffset()) + ")"));
+    });
+    registerNative("Json.stringify", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        JsonWriter w;
+        vm->appendJson(w, args[0]);
+        return Value(vm->newString(w.str()));
+    });
+    registerNative("Json.prettyPrint", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        const std::string text = vm->textOf(args[0]);
+        JsonDocument doc = JsonDocument::parse(text);
+        if (!doc.ok()) return Value();
+        JsonWriter w(text.size() * 2, args.size() > 1 ? args[1].toInt() : 2);
+        w.value(doc.root());
+        return Value(vm->newString(w.str()));
+    });
+    registerNative("Json.query", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        const std::string text = vm->textOf(args[0]);
+        JsonOnDemand doc = JsonOnDemand::parse(text);
+        JsonCursor c = doc.at(vm->textOf(args[1]));
+        return c.valid() ? Value(vm->newString(c.raw())) : Value();
+    });
+    registerNative("Json.type", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        static const char* const names[] = {"null", "boolean", "int", "double", "string", "array", "object"};
+        const std::string text = vm->textOf(args[0]);
+        JsonOnDemand doc = JsonOnDemand::parse(text);
+        JsonCursor c = doc.at(vm->textOf(args[1]));
+        return c.valid() ? Value(vm->newString(names[static_cast<int>(c.type())])) : Value();
+    });
+    registerNative("Json.getString", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        const std::string text = vm->textOf(args[0]);
+        JsonOnDemand doc = JsonOnDemand::parse(text);
+        std::string out;
+        return doc.at(vm->textOf(args[1])).getString(out) ? Value(vm->newString(out)) : Value();
+    });
+    registerNative("Json.getLong", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        const std::string text = vm->textOf(args[0]);
+        JsonOnDemand doc = JsonOnDemand::parse(text);
+        int64_t n;
+        return doc.at(vm->textOf(args[1])).getInt(n) ? Value(n) : Value();
+    });
+    registerNative("Json.getDouble", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        const std::string text = vm->textOf(args[0]);
+        JsonOnDemand doc = JsonOnDemand::parse(text);
+        double d;
+        return doc.at(vm->textOf(args[1])).getDouble(d) ? Value(d) : Value();
+    });
+    // Elementos do array ou membros do objeto; -1 se nao for nenhum dos dois
+    registerNative("Json.size", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        const std::string text = vm->textOf(args[0]);
+        JsonOnDemand doc = JsonOnDemand::parse(text);
+        JsonCursor c = doc.at(vm->textOf(args[1]));
+        const JsonValue::Type t = c.type();
+        if (!c.valid() || (t != JsonValue::Type::Array && t != JsonValue::Type::Object)) return Value(-1);
+        return Value(static_cast<int32_t>(c.size()));
+    });
+    
+    // new StringBuilder(), (capacidade) ou (texto inicial)
+    registerNative("StringBuilder.<init>", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        if (args.empty() || !StringObjects::isText(args[0].asObject())) {
+            return Value(vm->newStringBuilder(args.empty() ? 0 : std::max(0, args[0].toInt())));
+        }
+        const std::string text = vm->textOf(args[0]);
+        GCObject* builder = vm->newStringBuilder(static_cast<int32_t>(std::max<size_t>(text.size(), 16)));
+        if (builder && StringObjects::builderCapacity(builder) > 0) {
+            std::memcpy(StringObjects::builderChars(builder), text.data(), text.size());
+            StringObjects::builderLength(builder) = static_cast<int32_t>(text.size());
+        }
+        return Value(builder);
+    });
+    
+    // Promise.delay(ms[, v]): promise que assenta com v (null) depois de ms;
+    // v fica guardado na propria promise ate la (raiz do GC)
+    registerNative("Promise.delay", [](VM* vm, Frame*, const std::vector<Value>& args) {
+        EventLoop& loop = vm->eventLoop;
+        const int id = loop.createPromise();
+        Promise* p = loop.getPromise(id);
+        if (!p) return Value();
+        p->value = args.size() > 1 ? args[1].bits : Value().bits;
+        loop.setTimeout([&loop, id] {
+            if (Promise* pending = loop.getPromise(id)) loop.resolvePromise(id, pending->value);
+        }, std::max<int64_t>(0, args[0].toLong()));
+        return Value::promise(id);
+    });
 }
 
+// Os nos do std::map nao se movem: o ponteiro em nativeTable vale ate o
+// proximo registerNative com o mesmo nome, que grava no mesmo no
 inline void VM::registerNative(const std::string& signature, NativeMethod method) {
-    nativeMethods[signature] = std::move(method);
+    NativeMethod& slot = nativeMethods[signature];
+    slot = std::move(method);
+    const int32_t id = nativeId(signature.c_str());
+    if (id >= 0) nativeTable[id] = &slot;
+}
+
+inline const NativeMethod* VM::nativeById(int32_t id) {
+    return id >= 0 && id < NATIVE_COUNT ? nativeTable[id] : nullptr;
+}
+
+inline ClassInfo* VM::getClass(int32_t classId) {
+    return classId >= 0 && classId < static_cast<int32_t>(classTable.size()) ? classTable[classId] : nullptr;
+}
+
+inline ClassInfo* VM::getClass(const std::string& name) {
+    const int32_t id = symbolTable.find(name);
+    return id >= 0 && id < static_cast<int32_t>(classByName.size()) ? classByName[id] : nullptr;
 }
 
 inline void VM::printStats() {
@@ -1280,8 +4663,15 @@ inline void VM::printStats() {
     std::cout << "Heap used: " << heap.totalUsed() << " bytes" << std::endl;
     std::cout << "GC collections: " << heap.stats.totalCollections << std::endl;
     std::cout << "GC time: " << heap.stats.totalTimeMs << " ms" << std::endl;
+    std::cout << "GC max pause: " << heap.stats.maxPauseMs << " ms" << std::endl;
     std::cout << "JIT opt level: -O" << static_cast<int>(jit.optLevel) << std::endl;
+    std::cout << "JIT native loops: " << jit.stats.compilations
+              << " (" << jit.stats.compiledCodeSize << " bytes, "
+              << jit.stats.deoptimizations << " guard failures)" << std::endl;
     std::cout << "Lambda closures: " << lambdaClosures.size() << std::endl;
+    std::cout << "Inline caches: " << inlineCaches.size() << " sites (" << icStats.hits << " hits, "
+              << icStats.misses << " misses, " << icStats.evictions << " evictions)" << std::endl;
+    std::cout << "SIMD kernels: " << simd().name << std::endl;
 }
 
 } // namespace Kava